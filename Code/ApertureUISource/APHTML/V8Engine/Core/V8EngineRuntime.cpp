@@ -1,8 +1,11 @@
 #include "V8EngineRuntime.h"
 #include <APHTML/APEngine.h>
 #include <APHTML/V8Engine/Core/V8EngineMain.h>
+#include <APHTML/dom/events/DOMEventQueue.h>
+#include <APHTML/dom/events/DOMInputQueue.h>
 #include <APHTML/V8Engine/Core/V8EngineRuntime.h>
 #include <APHTML/V8Engine/System/Internal/V8Helpers.h>
+#include <Foundation/Profiling/Profiling.h>
 #include <Foundation/Utilities/Compression.h>
 #include "../../Types/Delegate.h"
 
@@ -56,10 +59,32 @@ nsResult aperture::v8::V8EEngineRuntime::ProcessAndTickEngine()
       m_bPopLatestIsolate = false;
     }
   }
+
+  // Events dispatched with DOMEventTarget::dispatchEventAsync() are delivered here, on the thread that owns the isolates.
+  // The input of this frame goes first, coalesced into one batch.
+  aperture::dom::DOMEventQueue& scriptQueue = aperture::dom::DOMEventQueue::GetScriptThreadQueue();
+  aperture::dom::DOMInputQueue::GetGlobalInputQueue().Flush(scriptQueue);
+  scriptQueue.Flush();
   return NS_SUCCESS;
 }
 
 
+void aperture::v8::V8EEngineRuntime::DispatchEventBatch(nsArrayPtr<aperture::dom::DOMEventQueue::BatchedEvent> in_batch)
+{
+  NS_PROFILE_SCOPE("V8EEngineRuntime::DispatchEventBatch");
+  if (m_Isolates.IsEmpty())
+  {
+    aperture::dom::DOMEventQueue::DispatchBatch(in_batch);
+    return;
+  }
+
+  // One crossing into the isolate for the whole batch, the listeners of every event run inside of it.
+  ::v8::Isolate* pIsolate = m_Isolates.PeekBack();
+  ::v8::Isolate::Scope isolateScope(pIsolate);
+  ::v8::HandleScope handleScope(pIsolate);
+  aperture::dom::DOMEventQueue::DispatchBatch(in_batch);
+}
+
 void aperture::v8::V8ErrorCallback(const char* location, const char* message)
 {
   nsLog::Error("FATAL JavaScript(V8) Error: {0} - {1}", location, message);
@@ -86,6 +111,9 @@ void aperture::v8::V8EEngineRuntime::InitializeRuntime(V8EEngineMain* pEngineMai
   }
   m_pV8EngineMain = pEngineMain;
   im_RuntimeStatus = NS_SUCCESS;
+
+  aperture::dom::DOMEventQueue::GetScriptThreadQueue().SetBatchDispatcher([this](nsArrayPtr<aperture::dom::DOMEventQueue::BatchedEvent> in_batch)
+    { DispatchEventBatch(in_batch); });
 }
 
 void aperture::v8::V8EEngineRuntime::SetScriptPath(const char* in_pScriptPath, aperture::core::IAPCFileSystem::EFileType in_eFileType)
@@ -101,6 +129,7 @@ aperture::v8::V8EEngineMain* aperture::v8::V8EEngineRuntime::GetV8EngineMain()
 
 void aperture::v8::V8EEngineRuntime::ShutdownRuntime()
 {
+  aperture::dom::DOMEventQueue::GetScriptThreadQueue().SetBatchDispatcher(nullptr);
   Cleanup_TaskGroups();
   Cleanup_Isolates();
   Cleanup_Snapshots();
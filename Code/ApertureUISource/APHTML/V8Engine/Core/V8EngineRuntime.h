@@ -39,6 +39,7 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <APHTML/V8Engine/System/Internal/V8Helpers.h>
 #include <APHTML/V8Engine/Core/V8EngineMain.h>
 #include <APHTML/V8Engine/V8EngineDLL.h>
+#include <APHTML/dom/events/DOMEventQueue.h>
 #include <Foundation/Threading/TaskSystem.h>
 #include <v8-isolate.h>
 
@@ -146,6 +147,9 @@ namespace aperture::v8
 
     void Cleanup_Scripts();
 
+    /// @brief Dispatches a batch of the script thread queue, entering the isolate once for all of its events.
+    void DispatchEventBatch(nsArrayPtr<dom::DOMEventQueue::BatchedEvent> in_batch);
+
   private:
   
     bool m_bPopLatestIsolate = false;
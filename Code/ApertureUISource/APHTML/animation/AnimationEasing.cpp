@@ -0,0 +1,139 @@
+#include <APHTML/animation/AnimationEasing.h>
+#include <Foundation/Tracks/Curve1D.h>
+
+using namespace aperture;
+using namespace aperture::animation;
+
+EasingTable::EasingTable()
+{
+  Add(TimingFunction::MakeLinear());
+}
+
+nsUInt16 EasingTable::Add(const TimingFunction& in_function)
+{
+  for (nsUInt32 i = 0; i < m_Functions.GetCount(); ++i)
+  {
+    if (m_Functions[i].m_Function == in_function)
+      return static_cast<nsUInt16>(i);
+  }
+
+  NS_ASSERT_DEV(m_Functions.GetCount() < 0xFFFF, "Too many distinct easing functions.");
+
+  Entry& entry = m_Functions.ExpandAndGetRef();
+  entry.m_Function = in_function;
+  entry.m_uiFirstSample = m_Samples.GetCount();
+
+  if (in_function.m_Type == TimingFunctionType::Linear)
+  {
+    for (nsUInt32 i = 0; i <= SampleCount; ++i)
+    {
+      m_Samples.PushBack(static_cast<float>(i) / SampleCount);
+    }
+  }
+  else if (in_function.m_Type == TimingFunctionType::CubicBezier)
+  {
+    // P0 = (0, 0) and P3 = (1, 1), P1 and P2 are the tangents of the two control points.
+    nsCurve1D curve;
+    {
+      nsCurve1D::ControlPoint& start = curve.AddControlPoint(0.0);
+      start.m_Position.y = 0.0;
+      start.m_RightTangent.Set(in_function.m_fX1, in_function.m_fY1);
+      start.m_TangentModeLeft = nsCurveTangentMode::Bnsier;
+      start.m_TangentModeRight = nsCurveTangentMode::Bnsier;
+    }
+    {
+      nsCurve1D::ControlPoint& end = curve.AddControlPoint(1.0);
+      end.m_Position.y = 1.0;
+      end.m_LeftTangent.Set(in_function.m_fX2 - 1.0f, in_function.m_fY2 - 1.0f);
+      end.m_TangentModeLeft = nsCurveTangentMode::Bnsier;
+      end.m_TangentModeRight = nsCurveTangentMode::Bnsier;
+    }
+    curve.SortControlPoints();
+    curve.CreateLinearApproximation(0.0005, 12);
+
+    for (nsUInt32 i = 0; i <= SampleCount; ++i)
+    {
+      m_Samples.PushBack(static_cast<float>(curve.Evaluate(static_cast<double>(i) / SampleCount)));
+    }
+  }
+  else
+  {
+    // Only read by the branch free loop of EvaluateBatch(), the exact values replace them afterwards.
+    for (nsUInt32 i = 0; i <= SampleCount; ++i)
+    {
+      m_Samples.PushBack(EvaluateSteps(in_function, static_cast<float>(i) / SampleCount));
+    }
+  }
+
+  return static_cast<nsUInt16>(m_Functions.GetCount() - 1);
+}
+
+float EasingTable::EvaluateSteps(const TimingFunction& in_function, float in_fProgress)
+{
+  // https://www.w3.org/TR/css-easing-1/#step-easing-algo
+  const float fSteps = in_function.m_uiSteps;
+  float fStep = nsMath::Floor(in_fProgress * fSteps);
+  float fJumps = fSteps;
+  switch (in_function.m_StepPosition)
+  {
+    case StepPosition::JumpStart:
+      fStep += 1.0f;
+      break;
+    case StepPosition::JumpBoth:
+      fStep += 1.0f;
+      fJumps += 1.0f;
+      break;
+    case StepPosition::JumpNone:
+      fJumps -= 1.0f;
+      break;
+    default:
+      break;
+  }
+  return nsMath::Min(fStep, fJumps) / fJumps;
+}
+
+float EasingTable::Evaluate(nsUInt16 in_uiFunction, float in_fProgress) const
+{
+  const Entry& entry = m_Functions[in_uiFunction];
+  const float fProgress = nsMath::Clamp(in_fProgress, 0.0f, 1.0f);
+  if (entry.m_Function.m_Type == TimingFunctionType::Steps)
+    return EvaluateSteps(entry.m_Function, fProgress);
+
+  const float fPosition = fProgress * SampleCount;
+  const nsUInt32 uiIndex = nsMath::Min(static_cast<nsUInt32>(fPosition), SampleCount - 1);
+  const float* pSamples = m_Samples.GetData() + entry.m_uiFirstSample + uiIndex;
+  return nsMath::Lerp(pSamples[0], pSamples[1], fPosition - static_cast<float>(uiIndex));
+}
+
+void EasingTable::EvaluateBatch(nsArrayPtr<const nsUInt16> in_functions, nsArrayPtr<const float> in_progress, nsArrayPtr<float> out_values) const
+{
+  NS_ASSERT_DEBUG(in_functions.GetCount() == in_progress.GetCount() && in_progress.GetCount() == out_values.GetCount(), "Array sizes don't match.");
+
+  const Entry* pFunctions = m_Functions.GetData();
+  const float* pSamples = m_Samples.GetData();
+  const nsUInt16* pIndices = in_functions.GetPtr();
+  const float* pProgress = in_progress.GetPtr();
+  float* pOut = out_values.GetPtr();
+  const nsUInt32 uiCount = out_values.GetCount();
+
+  // Table lookups first, one loop without branches. steps() functions are fixed up afterwards, they are rare.
+  bool bHasSteps = false;
+  for (nsUInt32 i = 0; i < uiCount; ++i)
+  {
+    const float fPosition = nsMath::Clamp(pProgress[i], 0.0f, 1.0f) * SampleCount;
+    const nsUInt32 uiIndex = nsMath::Min(static_cast<nsUInt32>(fPosition), SampleCount - 1);
+    const float* pEntry = pSamples + pFunctions[pIndices[i]].m_uiFirstSample + uiIndex;
+    pOut[i] = pEntry[0] + (pEntry[1] - pEntry[0]) * (fPosition - static_cast<float>(uiIndex));
+    bHasSteps |= pFunctions[pIndices[i]].m_Function.m_Type == TimingFunctionType::Steps;
+  }
+
+  if (!bHasSteps)
+    return;
+
+  for (nsUInt32 i = 0; i < uiCount; ++i)
+  {
+    const TimingFunction& function = pFunctions[pIndices[i]].m_Function;
+    if (function.m_Type == TimingFunctionType::Steps)
+      pOut[i] = EvaluateSteps(function, nsMath::Clamp(pProgress[i], 0.0f, 1.0f));
+  }
+}
@@ -0,0 +1,86 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/animation/AnimationTypes.h>
+#include <Foundation/Types/ArrayPtr.h>
+
+namespace aperture::animation
+{
+  /*
+   * @brief Easing functions baked into lookup tables, evaluated for many tracks at once.
+   *
+   * cubic-bezier() functions are built as a nsCurve1D and sampled into SampleCount + 1 uniformly spaced values when they
+   * are added, so evaluating one is a lookup and a lerp instead of solving the bezier for x. The tables of all functions
+   * live in one array and are addressed by offset, EvaluateBatch() runs the same loop for every function.
+   * steps() functions are evaluated exactly, a table would smear their jumps.
+   *
+   * Index 0 is always the linear function.
+   */
+  class NS_APERTURE_DLL EasingTable
+  {
+  public:
+    static constexpr nsUInt32 SampleCount = 128;
+
+    EasingTable();
+
+    /// @brief Returns the index of the function, adding it if it isn't part of the table yet.
+    nsUInt16 Add(const TimingFunction& in_function);
+
+    /// @brief Evaluates a single function, in_fProgress is clamped to [0, 1].
+    float Evaluate(nsUInt16 in_uiFunction, float in_fProgress) const;
+
+    /// @brief Evaluates out_values[i] = function in_functions[i] at in_progress[i]. All three arrays must have the same size.
+    void EvaluateBatch(nsArrayPtr<const nsUInt16> in_functions, nsArrayPtr<const float> in_progress, nsArrayPtr<float> out_values) const;
+
+    nsUInt32 GetCount() const { return m_Functions.GetCount(); }
+    const TimingFunction& GetFunction(nsUInt16 in_uiFunction) const { return m_Functions[in_uiFunction].m_Function; }
+
+  private:
+    struct Entry
+    {
+      NS_DECLARE_POD_TYPE();
+
+      TimingFunction m_Function;
+      /// @brief The first value of the table.
+      nsUInt32 m_uiFirstSample;
+    };
+
+    static float EvaluateSteps(const TimingFunction& in_function, float in_fProgress);
+
+    nsDynamicArray<Entry> m_Functions;
+    nsDynamicArray<float> m_Samples;
+  };
+} // namespace aperture::animation
@@ -0,0 +1,649 @@
+#include <APHTML/animation/AnimationManager.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/dom/events/DOMAnimationEvent.h>
+#include <Foundation/Profiling/Profiling.h>
+
+using namespace aperture;
+using namespace aperture::animation;
+
+namespace
+{
+  std::string_view GetAtomText(core::Atom in_atom)
+  {
+    const nsStringView text = core::AtomTable::Get().GetString(in_atom);
+    return std::string_view(text.GetStartPointer(), text.GetElementCount());
+  }
+
+  bool HasAnimations(const css::ComputedStyle& in_style)
+  {
+    const css::ComputedStyle& initial = css::ComputedStyle::GetInitialStyle();
+    return !in_style.HasSameValue(PropertyId::Transition, initial) || !in_style.HasSameValue(PropertyId::Animation, initial);
+  }
+
+  /// STRING values index different string tables, they are equal if their text is.
+  bool IsSameValue(const css::CSSValue& in_a, std::string_view in_aText, const css::CSSValue& in_b, std::string_view in_bText)
+  {
+    if (in_a.m_Unit == core::Unit::STRING && in_b.m_Unit == core::Unit::STRING)
+      return in_aText == in_bText;
+    return in_a == in_b;
+  }
+
+  /// Opacity and transform don't affect layout, their tracks run on the compositor.
+  bool IsCompositedProperty(PropertyId in_id)
+  {
+    return in_id == PropertyId::Opacity || in_id == PropertyId::Transform;
+  }
+
+  /// Transitions override animations, as they do in the cascade.
+  constexpr nsUInt16 TransitionPriority = 0xFFFF;
+
+  /// Computes a keyframe value against the style of the element, like the resolver computes declared values.
+  /// The text of STRING values points into the sheet, the base style or the initial values.
+  AnimationTrackList::Keyframe ComputeKeyframeValue(
+    PropertyId in_id, const css::CSSDeclaration& in_declaration, const css::CSSStyleSheet& in_sheet, const css::ComputedStyle& in_base, float in_fRootFontSize)
+  {
+    AnimationTrackList::Keyframe keyframe;
+    switch (in_declaration.m_WideKeyword)
+    {
+      case css::CSSWideKeyword::Initial:
+        keyframe.m_Value = css::CSSPropertyTable::GetInitialValue(in_id);
+        if (keyframe.m_Value.m_Unit == core::Unit::STRING)
+          keyframe.m_Text = css::CSSPropertyTable::GetInitialStrings().Get(keyframe.m_Value.m_uiData);
+        return keyframe;
+      case css::CSSWideKeyword::Inherit:
+      case css::CSSWideKeyword::Unset:
+        // The parent isn't known here, the value of the element is the inherited one for inherited properties.
+        keyframe.m_Value = in_base.Get(in_id);
+        keyframe.m_Text = in_base.GetString(in_id);
+        return keyframe;
+      default:
+        break;
+    }
+
+    const css::CSSValue& value = in_declaration.m_Value;
+    if (value.m_Unit == core::Unit::EM)
+      keyframe.m_Value = css::CSSValue::MakeNumeric(value.m_fNumber * in_base.Get(PropertyId::FontSize).m_fNumber, core::Unit::PX);
+    else if (value.m_Unit == core::Unit::REM)
+      keyframe.m_Value = css::CSSValue::MakeNumeric(value.m_fNumber * in_fRootFontSize, core::Unit::PX);
+    else if (value.IsKeyword(css::CSSPropertyTable::GetKeywords().m_CurrentColor))
+      keyframe.m_Value = in_base.Get(PropertyId::Color);
+    else
+      keyframe.m_Value = value;
+    keyframe.m_Text = in_sheet.GetString(value);
+    return keyframe;
+  }
+
+  /// Transforms only run on the compositor if every keyframe parses, the compositor can't show discrete values.
+  bool CanComposite(PropertyId in_id, nsArrayPtr<const AnimationTrackList::Keyframe> in_keyframes)
+  {
+    if (!IsCompositedProperty(in_id))
+      return false;
+
+    for (const AnimationTrackList::Keyframe& keyframe : in_keyframes)
+    {
+      if (in_id == PropertyId::Opacity && !keyframe.m_Value.IsNumeric())
+        return false;
+
+      TransformValue transform;
+      if (in_id == PropertyId::Transform &&
+          (keyframe.m_Value.m_Unit != core::Unit::STRING || TransformValue::Parse(keyframe.m_Text, transform).Failed()))
+        return false;
+    }
+    return true;
+  }
+} // namespace
+
+AnimationManager::AnimationManager(css::StyleResolver& in_resolver)
+  : m_Resolver(in_resolver)
+{
+  m_Resolver.SetStyleAnimator(this);
+}
+
+AnimationManager::~AnimationManager()
+{
+  if (m_Resolver.GetStyleAnimator() == this)
+    m_Resolver.SetStyleAnimator(nullptr);
+}
+
+void AnimationManager::Tick(nsTime in_now)
+{
+  NS_PROFILE_SCOPE("AnimationManager::Tick");
+
+  {
+    NS_LOCK(m_Mutex);
+    m_fTime = in_now.GetSeconds();
+
+    // Retire what ended. Both only change the overrides, the next UpdateStyles() picks them up.
+    nsHybridArray<const dom::DOMElement*, 16> expired;
+    for (auto it = m_Elements.GetIterator(); it.IsValid(); ++it)
+    {
+      ElementAnimations& entry = it.Value();
+      if (entry.m_pElement.expired())
+      {
+        for (const RunningAnimation& animation : entry.m_Animations)
+        {
+          for (const TrackRef& track : animation.m_Tracks)
+          {
+            RemoveTrack(track);
+          }
+        }
+        for (const RunningTransition& transition : entry.m_Transitions)
+        {
+          RemoveTrack(transition.m_Track);
+        }
+        expired.PushBack(it.Key());
+        continue;
+      }
+
+      for (nsUInt32 i = entry.m_Transitions.GetCount(); i-- > 0;)
+      {
+        const RunningTransition& transition = entry.m_Transitions[i];
+        if (transition.m_fEndTime > m_fTime)
+          continue;
+
+        FinishedEvent& event = m_FinishedEvents.ExpandAndGetRef();
+        event.m_pTarget = entry.m_pElement;
+        event.m_pEvent = std::make_shared<dom::DOMAnimationEvent>(
+          EventId::TransitionEnd, std::string(), std::string(css::CSSPropertyTable::GetInfo(transition.m_Track.m_Property).m_szName), transition.m_Duration);
+
+        RemoveTrack(transition.m_Track);
+        entry.m_Transitions.RemoveAtAndCopy(i);
+      }
+
+      for (RunningAnimation& animation : entry.m_Animations)
+      {
+        if (animation.m_bFinished || animation.m_Desc.m_bPaused || animation.m_fEndTime > m_fTime)
+          continue;
+
+        const AnimationFillMode fill = animation.m_Desc.m_FillMode;
+        for (const TrackRef& track : animation.m_Tracks)
+        {
+          css::CSSValue value;
+          std::string text;
+          if ((fill == AnimationFillMode::Forwards || fill == AnimationFillMode::Both) && SampleTrack(track, animation.m_fEndTime, value, text))
+            animation.m_HeldValues.PushBack({track.m_Property, animation.m_uiPriority, value, std::move(text)});
+          RemoveTrack(track);
+        }
+        animation.m_Tracks.Clear();
+        animation.m_bFinished = true;
+
+        const nsTime duration = animation.m_Desc.m_Duration;
+        FinishedEvent& event = m_FinishedEvents.ExpandAndGetRef();
+        event.m_pTarget = entry.m_pElement;
+        event.m_pEvent = std::make_shared<dom::DOMAnimationEvent>(EventId::AnimationEnd, std::string(GetAtomText(animation.m_Desc.m_Name)), std::string(),
+          duration > nsTime::MakeZero() ? duration * animation.m_Desc.m_fIterationCount : nsTime::MakeZero());
+      }
+    }
+
+    for (const dom::DOMElement* pElement : expired)
+    {
+      m_Elements.Remove(pElement);
+    }
+
+    // The main thread tracks of all elements in one batch.
+    m_MainThreadTracks.Sample(m_fTime, m_Samples);
+
+    nsHybridArray<Override, 8> overrides;
+    for (auto it = m_Elements.GetIterator(); it.IsValid(); ++it)
+    {
+      ElementAnimations& entry = it.Value();
+      overrides.Clear();
+      CollectOverrides(entry, &m_Samples, overrides);
+      if (SetOverrides(entry, overrides))
+      {
+        if (std::shared_ptr<dom::DOMElement> pElement = entry.m_pElement.lock())
+          pElement->markStyleDirty(dom::StyleDirty::Animation);
+      }
+    }
+  }
+
+  CommitToCompositor();
+}
+
+void AnimationManager::CommitToCompositor()
+{
+  NS_LOCK(m_Mutex);
+  if (!m_bCompositedTracksChanged)
+    return;
+
+  // The compositor keeps sampling the previous snapshot until it picks up this one.
+  m_bCompositedTracksChanged = false;
+  m_Compositor.Publish(nsSharedPtr<const AnimationTrackList>(NS_DEFAULT_NEW(AnimationTrackList, m_CompositedTracks)));
+}
+
+void AnimationManager::TakeFinishedEvents(nsDynamicArray<FinishedEvent>& out_events)
+{
+  NS_LOCK(m_Mutex);
+  for (FinishedEvent& event : m_FinishedEvents)
+  {
+    out_events.PushBack(std::move(event));
+  }
+  m_FinishedEvents.Clear();
+}
+
+nsUInt32 AnimationManager::GetAnimatedElementCount() const
+{
+  NS_LOCK(m_Mutex);
+  return m_Elements.GetCount();
+}
+
+nsUInt32 AnimationManager::GetMainThreadTrackCount() const
+{
+  NS_LOCK(m_Mutex);
+  return m_MainThreadTracks.GetTrackCount();
+}
+
+nsUInt32 AnimationManager::GetCompositedTrackCount() const
+{
+  NS_LOCK(m_Mutex);
+  return m_CompositedTracks.GetTrackCount();
+}
+
+nsSharedPtr<const css::ComputedStyle> AnimationManager::OnStyleResolved(
+  dom::DOMElement& in_element, const css::ComputedStyle* in_pOldStyle, nsSharedPtr<const css::ComputedStyle> in_pNewStyle)
+{
+  NS_LOCK(m_Mutex);
+
+  ElementAnimations* pEntry = nullptr;
+  if (!m_Elements.TryGetValue(&in_element, pEntry))
+  {
+    if (!HasAnimations(*in_pNewStyle))
+      return in_pNewStyle;
+
+    pEntry = &m_Elements.FindOrAdd(&in_element);
+    pEntry->m_pElement = in_element.weak_from_this();
+  }
+
+  // Without a entry nothing ran, the style the element had is the one without animated values.
+  ElementAnimations& entry = *pEntry;
+  const nsSharedPtr<const css::ComputedStyle> pOldBase = entry.m_pBaseStyle != nullptr ? entry.m_pBaseStyle : in_element.getComputedStyleRef();
+  if (pOldBase != nullptr)
+    UpdateTransitions(in_element, entry, *pOldBase, in_pOldStyle, *in_pNewStyle);
+  UpdateAnimations(in_element, entry, *in_pNewStyle);
+  entry.m_pBaseStyle = in_pNewStyle;
+
+  // Values as of the last Tick(), so the style is complete before the next one.
+  nsHybridArray<Override, 8> overrides;
+  CollectOverrides(entry, nullptr, overrides);
+  SetOverrides(entry, overrides);
+
+  nsSharedPtr<const css::ComputedStyle> pStyle = MakeAnimatedStyle(entry);
+  if (IsEmpty(entry))
+    m_Elements.Remove(&in_element);
+  return pStyle;
+}
+
+nsSharedPtr<const css::ComputedStyle> AnimationManager::ApplyAnimatedValues(dom::DOMElement& in_element)
+{
+  NS_LOCK(m_Mutex);
+
+  ElementAnimations* pEntry = nullptr;
+  if (!m_Elements.TryGetValue(&in_element, pEntry))
+    return in_element.getComputedStyleRef();
+
+  nsSharedPtr<const css::ComputedStyle> pStyle = MakeAnimatedStyle(*pEntry);
+  if (IsEmpty(*pEntry))
+    m_Elements.Remove(&in_element);
+  return pStyle;
+}
+
+void AnimationManager::UpdateTransitions(const dom::DOMElement& in_element, ElementAnimations& inout_entry, const css::ComputedStyle& in_oldBase,
+  const css::ComputedStyle* in_pOldStyle, const css::ComputedStyle& in_newBase)
+{
+  nsHybridArray<TransitionDesc, 4> transitions;
+  if (in_newBase.Get(PropertyId::Transition).m_Unit == core::Unit::STRING)
+    ParseTransitionList(in_newBase.GetString(PropertyId::Transition), transitions).IgnoreResult();
+
+  // Later entries of the list win.
+  auto FindTransition = [&](PropertyId in_id) -> const TransitionDesc* {
+    for (nsUInt32 i = transitions.GetCount(); i-- > 0;)
+    {
+      if (transitions[i].m_bAllProperties || transitions[i].m_Property == in_id)
+        return &transitions[i];
+    }
+    return nullptr;
+  };
+
+  // Transitions of properties that are no longer transitioned are cancelled.
+  for (nsUInt32 i = inout_entry.m_Transitions.GetCount(); i-- > 0;)
+  {
+    if (FindTransition(inout_entry.m_Transitions[i].m_Track.m_Property) == nullptr)
+    {
+      RemoveTrack(inout_entry.m_Transitions[i].m_Track);
+      inout_entry.m_Transitions.RemoveAtAndCopy(i);
+    }
+  }
+
+  if (transitions.IsEmpty())
+    return;
+
+  for (nsUInt32 uiId = 1; uiId < css::ComputedStyle::PropertyCount; ++uiId)
+  {
+    const PropertyId id = static_cast<PropertyId>(uiId);
+    if (id == PropertyId::Transition || id == PropertyId::Animation || in_newBase.HasSameValue(id, in_oldBase))
+      continue;
+
+    const css::CSSValue& to = in_newBase.Get(id);
+    const std::string_view toText = in_newBase.GetString(id);
+    RunningTransition* pRunning = nullptr;
+    for (RunningTransition& transition : inout_entry.m_Transitions)
+    {
+      if (transition.m_Track.m_Property == id)
+        pRunning = &transition;
+    }
+    if (pRunning != nullptr && IsSameValue(pRunning->m_To, pRunning->m_ToText, to, toText))
+      continue;
+
+    // Start from what is displayed right now, which is somewhere in the middle if the property was transitioning already.
+    const css::ComputedStyle& oldStyle = in_pOldStyle != nullptr ? *in_pOldStyle : in_oldBase;
+    css::CSSValue from = oldStyle.Get(id);
+    std::string fromText(oldStyle.GetString(id));
+    if (pRunning != nullptr)
+    {
+      SampleTrack(pRunning->m_Track, m_fTime, from, fromText);
+      RemoveTrack(pRunning->m_Track);
+      inout_entry.m_Transitions.RemoveAtAndCopy(static_cast<nsUInt32>(pRunning - inout_entry.m_Transitions.GetData()));
+    }
+
+    const TransitionDesc* pDesc = FindTransition(id);
+    if (pDesc == nullptr || nsMath::Max(pDesc->m_Duration, nsTime::MakeZero()) + pDesc->m_Delay <= nsTime::MakeZero() || IsSameValue(from, fromText, to, toText))
+      continue;
+
+    // Discrete values don't transition.
+    if (GetInterpolationType(id, from, fromText, to, toText) == InterpolationType::Discrete)
+      continue;
+
+    const AnimationTrackList::Keyframe keyframes[] = {{0.0f, from, fromText}, {1.0f, to, toText}};
+    AnimationTrackList::TrackDesc track;
+    track.m_pOwner = &in_element;
+    track.m_Property = id;
+    track.m_uiPriority = TransitionPriority;
+    track.m_fStartTime = m_fTime;
+    track.m_Delay = pDesc->m_Delay;
+    track.m_Duration = pDesc->m_Duration;
+    track.m_FillMode = AnimationFillMode::Backwards;
+    track.m_TimingFunction = pDesc->m_TimingFunction;
+
+    RunningTransition& transition = inout_entry.m_Transitions.ExpandAndGetRef();
+    transition.m_Track.m_Property = id;
+    transition.m_Track.m_bComposited = CanComposite(id, keyframes);
+    transition.m_Track.m_Id = (transition.m_Track.m_bComposited ? m_CompositedTracks : m_MainThreadTracks).AddTrack(track, keyframes);
+    transition.m_To = to;
+    transition.m_ToText = toText;
+    transition.m_Duration = pDesc->m_Duration;
+    transition.m_fEndTime = m_fTime + (pDesc->m_Delay + pDesc->m_Duration).GetSeconds();
+    m_bCompositedTracksChanged |= transition.m_Track.m_bComposited;
+  }
+}
+
+void AnimationManager::UpdateAnimations(const dom::DOMElement& in_element, ElementAnimations& inout_entry, const css::ComputedStyle& in_newBase)
+{
+  nsHybridArray<AnimationDesc, 4> animations;
+  if (in_newBase.Get(PropertyId::Animation).m_Unit == core::Unit::STRING)
+    ParseAnimationList(in_newBase.GetString(PropertyId::Animation), animations).IgnoreResult();
+
+  // Animations are identified by their name. The ones that are no longer listed stop, including their held values.
+  for (nsUInt32 i = inout_entry.m_Animations.GetCount(); i-- > 0;)
+  {
+    const RunningAnimation& running = inout_entry.m_Animations[i];
+    bool bListed = false;
+    for (const AnimationDesc& desc : animations)
+    {
+      bListed |= desc.m_Name == running.m_Desc.m_Name;
+    }
+    if (bListed)
+      continue;
+
+    for (const TrackRef& track : running.m_Tracks)
+    {
+      RemoveTrack(track);
+    }
+    inout_entry.m_Animations.RemoveAtAndCopy(i);
+  }
+
+  for (nsUInt32 i = 0; i < animations.GetCount(); ++i)
+  {
+    const AnimationDesc& desc = animations[i];
+    if (desc.m_Name == core::InvalidAtom)
+      continue;
+
+    RunningAnimation* pRunning = nullptr;
+    for (RunningAnimation& running : inout_entry.m_Animations)
+    {
+      if (running.m_Desc.m_Name == desc.m_Name)
+        pRunning = &running;
+    }
+
+    if (pRunning == nullptr)
+    {
+      RunningAnimation& animation = inout_entry.m_Animations.ExpandAndGetRef();
+      animation.m_Desc = desc;
+      animation.m_uiPriority = static_cast<nsUInt16>(nsMath::Min(i + 1, TransitionPriority - 1u));
+      StartAnimation(in_element, animation, in_newBase);
+      continue;
+    }
+
+    // Running animations keep their timing, only the play state follows the style.
+    if (!pRunning->m_bFinished && pRunning->m_Desc.m_bPaused != desc.m_bPaused)
+    {
+      for (const TrackRef& track : pRunning->m_Tracks)
+      {
+        (track.m_bComposited ? m_CompositedTracks : m_MainThreadTracks).SetPaused(track.m_Id, desc.m_bPaused, m_fTime);
+        m_bCompositedTracksChanged |= track.m_bComposited;
+      }
+
+      if (desc.m_bPaused)
+        pRunning->m_fPausedTime = m_fTime;
+      else
+        pRunning->m_fEndTime += m_fTime - pRunning->m_fPausedTime;
+    }
+    pRunning->m_Desc.m_bPaused = desc.m_bPaused;
+  }
+}
+
+void AnimationManager::StartAnimation(const dom::DOMElement& in_element, RunningAnimation& inout_animation, const css::ComputedStyle& in_base)
+{
+  const AnimationDesc& desc = inout_animation.m_Desc;
+  const double fActiveDuration = desc.m_Duration > nsTime::MakeZero() ? desc.m_Duration.GetSeconds() * desc.m_fIterationCount : 0.0;
+  inout_animation.m_fEndTime = m_fTime + desc.m_Delay.GetSeconds() + fActiveDuration;
+  inout_animation.m_fPausedTime = m_fTime;
+
+  // Animations without @keyframes still run, they just don't animate anything.
+  const css::CSSStyleSheet* pStyleSheet = m_Resolver.FindKeyframesStyleSheet(desc.m_Name);
+  if (pStyleSheet == nullptr)
+    return;
+
+  const nsArrayPtr<const css::CSSStyleSheet::Keyframe> keyframes = pStyleSheet->GetKeyframes(*pStyleSheet->FindKeyframesRule(desc.m_Name));
+
+  // Every animated property gets a track, in the order the properties first appear.
+  nsHybridArray<nsUInt8, 8> properties;
+  for (const css::CSSStyleSheet::Keyframe& keyframe : keyframes)
+  {
+    for (const css::CSSDeclaration& declaration : pStyleSheet->GetDeclarations(keyframe))
+    {
+      const nsUInt8 uiId = static_cast<nsUInt8>(declaration.m_Property);
+      if (declaration.m_Property != PropertyId::Invalid && !properties.Contains(uiId))
+        properties.PushBack(uiId);
+    }
+  }
+
+  const float fRootFontSize = m_Resolver.GetRootFontSize();
+  nsHybridArray<AnimationTrackList::Keyframe, 8> values;
+  for (nsUInt8 uiId : properties)
+  {
+    const PropertyId id = static_cast<PropertyId>(uiId);
+    values.Clear();
+    for (const css::CSSStyleSheet::Keyframe& keyframe : keyframes)
+    {
+      const css::CSSDeclaration* pDeclaration = nullptr;
+      for (const css::CSSDeclaration& declaration : pStyleSheet->GetDeclarations(keyframe))
+      {
+        if (declaration.m_Property == id)
+          pDeclaration = &declaration;
+      }
+      if (pDeclaration == nullptr)
+        continue;
+
+      // Keyframes with the same offset merge, the later one wins.
+      AnimationTrackList::Keyframe value = ComputeKeyframeValue(id, *pDeclaration, *pStyleSheet, in_base, fRootFontSize);
+      value.m_fOffset = keyframe.m_fOffset;
+      if (!values.IsEmpty() && values.PeekBack().m_fOffset == keyframe.m_fOffset)
+        values.PeekBack() = value;
+      else
+        values.PushBack(value);
+    }
+
+    // Missing 0% and 100% keyframes take the value of the element.
+    if (values[0].m_fOffset != 0.0f)
+      values.InsertAt(0, {0.0f, in_base.Get(id), in_base.GetString(id)});
+    if (values.PeekBack().m_fOffset != 1.0f)
+      values.PushBack({1.0f, in_base.Get(id), in_base.GetString(id)});
+
+    AnimationTrackList::TrackDesc track;
+    track.m_pOwner = &in_element;
+    track.m_Property = id;
+    track.m_uiPriority = inout_animation.m_uiPriority;
+    track.m_fStartTime = m_fTime;
+    track.m_Delay = desc.m_Delay;
+    track.m_Duration = desc.m_Duration;
+    track.m_fIterationCount = desc.m_fIterationCount;
+    track.m_Direction = desc.m_Direction;
+    track.m_FillMode = desc.m_FillMode;
+    track.m_TimingFunction = desc.m_TimingFunction;
+
+    TrackRef& ref = inout_animation.m_Tracks.ExpandAndGetRef();
+    ref.m_Property = id;
+    ref.m_bComposited = CanComposite(id, values);
+    AnimationTrackList& list = ref.m_bComposited ? m_CompositedTracks : m_MainThreadTracks;
+    ref.m_Id = list.AddTrack(track, values);
+    if (desc.m_bPaused)
+      list.SetPaused(ref.m_Id, true, m_fTime);
+    m_bCompositedTracksChanged |= ref.m_bComposited;
+  }
+}
+
+bool AnimationManager::SampleTrack(const TrackRef& in_track, double in_fTime, css::CSSValue& out_value, std::string& out_text) const
+{
+  const AnimationTrackList& list = in_track.m_bComposited ? m_CompositedTracks : m_MainThreadTracks;
+  InterpolationType type;
+  TransformValue transform;
+  if (!list.SampleTrack(in_track.m_Id, in_fTime, type, out_value, transform))
+    return false;
+
+  if (type == InterpolationType::Transform)
+  {
+    out_value = css::CSSValue::MakeString(0);
+    out_text = transform.ToString();
+  }
+  else
+  {
+    out_text = list.GetString(out_value);
+  }
+  return true;
+}
+
+void AnimationManager::RemoveTrack(const TrackRef& in_track)
+{
+  (in_track.m_bComposited ? m_CompositedTracks : m_MainThreadTracks).RemoveTrack(in_track.m_Id);
+  m_bCompositedTracksChanged |= in_track.m_bComposited;
+}
+
+void AnimationManager::CollectOverrides(const ElementAnimations& in_entry, const AnimationTrackList::Samples* in_pSamples, nsDynamicArray<Override>& out_overrides) const
+{
+  auto AddOverride = [&](PropertyId in_id, nsUInt16 in_uiPriority, const css::CSSValue& in_value, std::string_view in_text) {
+    for (Override& existing : out_overrides)
+    {
+      if (existing.m_Property == in_id)
+      {
+        if (in_uiPriority >= existing.m_uiPriority)
+        {
+          existing.m_uiPriority = in_uiPriority;
+          existing.m_Value = in_value;
+          existing.m_Text = in_text;
+        }
+        return;
+      }
+    }
+    out_overrides.PushBack({in_id, in_uiPriority, in_value, std::string(in_text)});
+  };
+
+  std::string text;
+  auto AddTrack = [&](const TrackRef& in_track, nsUInt16 in_uiPriority) {
+    // Composited tracks are applied by the compositor.
+    if (in_track.m_bComposited)
+      return;
+
+    css::CSSValue value;
+    if (in_pSamples != nullptr)
+    {
+      const nsUInt32 uiIndex = m_MainThreadTracks.GetTrackIndex(in_track.m_Id);
+      if (in_pSamples->m_Active[uiIndex] == 0)
+        return;
+      if (static_cast<InterpolationType>(in_pSamples->m_Types[uiIndex]) == InterpolationType::Transform)
+      {
+        value = css::CSSValue::MakeString(0);
+        text = in_pSamples->m_Transforms[uiIndex].ToString();
+      }
+      else
+      {
+        value = in_pSamples->m_Values[uiIndex];
+        text = m_MainThreadTracks.GetString(value);
+      }
+    }
+    else if (!SampleTrack(in_track, m_fTime, value, text))
+    {
+      return;
+    }
+    AddOverride(in_track.m_Property, in_uiPriority, value, text);
+  };
+
+  for (const RunningAnimation& animation : in_entry.m_Animations)
+  {
+    for (const Override& held : animation.m_HeldValues)
+    {
+      AddOverride(held.m_Property, held.m_uiPriority, held.m_Value, held.m_Text);
+    }
+    for (const TrackRef& track : animation.m_Tracks)
+    {
+      AddTrack(track, animation.m_uiPriority);
+    }
+  }
+
+  for (const RunningTransition& transition : in_entry.m_Transitions)
+  {
+    AddTrack(transition.m_Track, TransitionPriority);
+  }
+}
+
+bool AnimationManager::SetOverrides(ElementAnimations& inout_entry, nsArrayPtr<const Override> in_overrides)
+{
+  bool bChanged = inout_entry.m_Overrides.GetCount() != in_overrides.GetCount();
+  for (nsUInt32 i = 0; !bChanged && i < in_overrides.GetCount(); ++i)
+  {
+    const Override& current = inout_entry.m_Overrides[i];
+    bChanged = current.m_Property != in_overrides[i].m_Property ||
+               !IsSameValue(current.m_Value, current.m_Text, in_overrides[i].m_Value, in_overrides[i].m_Text);
+  }
+
+  if (bChanged)
+    inout_entry.m_Overrides = in_overrides;
+  return bChanged;
+}
+
+nsSharedPtr<const css::ComputedStyle> AnimationManager::MakeAnimatedStyle(const ElementAnimations& in_entry) const
+{
+  if (in_entry.m_Overrides.IsEmpty())
+    return in_entry.m_pBaseStyle;
+
+  css::ComputedStyle style(*in_entry.m_pBaseStyle);
+  for (const Override& override : in_entry.m_Overrides)
+  {
+    if (override.m_Value.m_Unit == core::Unit::STRING)
+      style.SetString(override.m_Property, override.m_Text);
+    else
+      style.Set(override.m_Property, override.m_Value);
+  }
+  return m_Resolver.GetStyleCache().GetOrAdd(style);
+}
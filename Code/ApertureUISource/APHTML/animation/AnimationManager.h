@@ -34,24 +34,168 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #pragma once
 
-#include <Foundation/Basics.h>
-#include <Foundation/Reflection/Reflection.h>
-#include <Foundation/SimdMath/SimdMath.h>
+#include <APHTML/animation/AnimationTrackList.h>
+#include <APHTML/animation/CompositorTimeline.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Threading/Mutex.h>
 /// NOTE: The DLL/PCH Header should always be included last.
 #include <APHTML/APEngineDLL.h>
 
 #include <Foundation/Types/RefCounted.h>
+#include <memory>
+
+namespace aperture::dom
+{
+  class DOMAnimationEvent;
+} // namespace aperture::dom
 
 namespace aperture::animation
 {
-    /// @brief Core class for the Animation system.
-    class NS_APERTURE_DLL AnimationManager : public nsRefCounted
+  /*
+   * @brief Runs the CSS transitions and keyframe animations of a document.
+   *
+   * The manager is the css::StyleAnimator of a StyleResolver. Whenever the resolver computes a new style for a element
+   * that declares transitions or animations, the manager compares it with the previous one: changed transitioned
+   * properties start a transition from the value that is currently displayed, new animation names start the
+   * @keyframes rule of that name. Keyframe values are computed against the style of the element when the animation
+   * starts (em, rem and currentcolor), var() references inside keyframes are not supported.
+   *
+   * Tracks of opacity and transform run on the CompositorTimeline, the compositor samples them every frame without
+   * any style or layout work. All other properties run on the main thread: Tick() samples them in one batch and flags
+   * the elements whose values changed with dom::StyleDirty::Animation, StyleResolver::UpdateStyles() then refreshes
+   * them without running the cascade. Computed styles report the values of composited properties as they are without
+   * the running animation, like a browser's animations on the compositor.
+   *
+   * Per frame:
+   *
+   *   manager.Tick(now);              // Samples, retires finished tracks, publishes to the compositor.
+   *   resolver.UpdateStyles(root);    // Applies the animated values and starts new transitions.
+   *   manager.CommitToCompositor();   // Hands tracks started by the style update to the compositor.
+   *   manager.TakeFinishedEvents(events);
+   *
+   * @note Elements must be owned by a std::shared_ptr, the manager keeps a weak reference and forgets elements that were destroyed.
+   */
+  class NS_APERTURE_DLL AnimationManager : public nsRefCounted, public css::StyleAnimator
+  {
+  public:
+    /// @brief Registers the manager as the animator of the resolver, the destructor unregisters it.
+    explicit AnimationManager(css::StyleResolver& in_resolver);
+    ~AnimationManager();
+
+    /// @brief Advances all animations and transitions to in_now, on the same clock the compositor samples with.
+    void Tick(nsTime in_now);
+
+    /// @brief Publishes the composited tracks if they changed since the last call. Tick() calls it as well.
+    void CommitToCompositor();
+
+    CompositorTimeline& GetCompositorTimeline() { return m_Compositor; }
+    const CompositorTimeline& GetCompositorTimeline() const { return m_Compositor; }
+
+    /// @brief A animationend or transitionend event that is ready to be dispatched.
+    struct FinishedEvent
+    {
+      std::weak_ptr<dom::DOMElement> m_pTarget;
+      std::shared_ptr<dom::DOMAnimationEvent> m_pEvent;
+    };
+
+    /// @brief Moves the events of the animations and transitions that ended so far into out_events.
+    void TakeFinishedEvents(nsDynamicArray<FinishedEvent>& out_events);
+
+    /// @brief Elements that have running or filling animations or transitions.
+    nsUInt32 GetAnimatedElementCount() const;
+    /// @brief Running tracks, one per animated property of a animation or transition.
+    nsUInt32 GetMainThreadTrackCount() const;
+    nsUInt32 GetCompositedTrackCount() const;
+
+    // css::StyleAnimator
+    nsSharedPtr<const css::ComputedStyle> OnStyleResolved(
+      dom::DOMElement& in_element, const css::ComputedStyle* in_pOldStyle, nsSharedPtr<const css::ComputedStyle> in_pNewStyle) override;
+    nsSharedPtr<const css::ComputedStyle> ApplyAnimatedValues(dom::DOMElement& in_element) override;
+
+  private:
+    struct TrackRef
     {
-        public:
-                explicit AnimationManager()
-                {
-                    /* code */
-                }   
-        private:
+      NS_DECLARE_POD_TYPE();
+
+      AnimationTrackList::TrackId m_Id;
+      PropertyId m_Property;
+      bool m_bComposited;
     };
-} // namespace aperture::animation
\ No newline at end of file
+
+    /// @brief A value that replaces the one of the computed style.
+    struct Override
+    {
+      PropertyId m_Property;
+      /// @brief Overrides of the same property replace each other, the highest priority wins.
+      nsUInt16 m_uiPriority;
+      css::CSSValue m_Value;
+      /// @brief The text of a STRING value, the index of m_Value is meaningless outside of the track list it came from.
+      std::string m_Text;
+    };
+
+    struct RunningAnimation
+    {
+      AnimationDesc m_Desc;
+      nsUInt16 m_uiPriority = 0;
+      double m_fEndTime = 0.0;
+      /// @brief When the animation was paused, valid while m_Desc.m_bPaused is set.
+      double m_fPausedTime = 0.0;
+      bool m_bFinished = false;
+      nsHybridArray<TrackRef, 4> m_Tracks;
+      /// @brief The final values of a finished animation that fills forwards.
+      nsHybridArray<Override, 4> m_HeldValues;
+    };
+
+    struct RunningTransition
+    {
+      TrackRef m_Track;
+      css::CSSValue m_To;
+      std::string m_ToText;
+      nsTime m_Duration;
+      double m_fEndTime = 0.0;
+    };
+
+    struct ElementAnimations
+    {
+      std::weak_ptr<dom::DOMElement> m_pElement;
+      /// @brief The last style computed by the resolver, without animated values.
+      nsSharedPtr<const css::ComputedStyle> m_pBaseStyle;
+      nsDynamicArray<RunningAnimation> m_Animations;
+      nsDynamicArray<RunningTransition> m_Transitions;
+      /// @brief The values of the main thread tracks and held values at the last Tick().
+      nsHybridArray<Override, 4> m_Overrides;
+    };
+
+    void UpdateTransitions(const dom::DOMElement& in_element, ElementAnimations& inout_entry, const css::ComputedStyle& in_oldBase,
+      const css::ComputedStyle* in_pOldStyle, const css::ComputedStyle& in_newBase);
+    void UpdateAnimations(const dom::DOMElement& in_element, ElementAnimations& inout_entry, const css::ComputedStyle& in_newBase);
+    /// @brief Starts the tracks of a animation, from the @keyframes rule of its name.
+    void StartAnimation(const dom::DOMElement& in_element, RunningAnimation& inout_animation, const css::ComputedStyle& in_base);
+    /// @brief Returns the value the track currently shows, false if it has no effect.
+    /// @param out_text Receives the text of STRING values.
+    bool SampleTrack(const TrackRef& in_track, double in_fTime, css::CSSValue& out_value, std::string& out_text) const;
+    void RemoveTrack(const TrackRef& in_track);
+    /// @brief Collects the held values and the current values of the main thread tracks of the element.
+    /// @param in_pSamples The batch sampled at m_fTime, the tracks are sampled one by one if null.
+    void CollectOverrides(const ElementAnimations& in_entry, const AnimationTrackList::Samples* in_pSamples, nsDynamicArray<Override>& out_overrides) const;
+    /// @brief Returns whether the overrides differ from the ones the element has.
+    static bool SetOverrides(ElementAnimations& inout_entry, nsArrayPtr<const Override> in_overrides);
+    nsSharedPtr<const css::ComputedStyle> MakeAnimatedStyle(const ElementAnimations& in_entry) const;
+    static bool IsEmpty(const ElementAnimations& in_entry) { return in_entry.m_Animations.IsEmpty() && in_entry.m_Transitions.IsEmpty(); }
+
+  private:
+    css::StyleResolver& m_Resolver;
+    /// @brief Guards everything below, the resolver calls in from several threads during parallel resolution.
+    mutable nsMutex m_Mutex;
+    nsHashTable<const dom::DOMElement*, ElementAnimations> m_Elements;
+    AnimationTrackList m_MainThreadTracks;
+    AnimationTrackList m_CompositedTracks;
+    bool m_bCompositedTracksChanged = false;
+    CompositorTimeline m_Compositor;
+    /// @brief The time of the last Tick() in seconds, new tracks start at it.
+    double m_fTime = 0.0;
+    AnimationTrackList::Samples m_Samples;
+    nsDynamicArray<FinishedEvent> m_FinishedEvents;
+  };
+} // namespace aperture::animation
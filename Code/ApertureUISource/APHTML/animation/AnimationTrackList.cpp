@@ -0,0 +1,317 @@
+#include <APHTML/animation/AnimationTrackList.h>
+
+using namespace aperture;
+using namespace aperture::animation;
+
+namespace
+{
+  constexpr nsUInt32 MinKeyframesToCompact = 64;
+} // namespace
+
+AnimationTrackList::TrackId AnimationTrackList::AddTrack(const TrackDesc& in_desc, nsArrayPtr<const Keyframe> in_keyframes)
+{
+  NS_ASSERT_DEV(in_keyframes.GetCount() >= 2 && in_keyframes[0].m_fOffset == 0.0f && in_keyframes[in_keyframes.GetCount() - 1].m_fOffset == 1.0f,
+    "A track needs keyframes at 0 and 1.");
+
+  TrackId id;
+  if (!m_FreeIds.IsEmpty())
+  {
+    id = m_FreeIds.PeekBack();
+    m_FreeIds.PopBack();
+  }
+  else
+  {
+    id = m_IdToIndex.GetCount();
+    m_IdToIndex.PushBack(InvalidIndex);
+  }
+  m_IdToIndex[id] = m_Ids.GetCount();
+
+  m_Ids.PushBack(id);
+  m_Owners.PushBack(in_desc.m_pOwner);
+  m_Properties.PushBack(static_cast<nsUInt8>(in_desc.m_Property));
+  m_Priorities.PushBack(in_desc.m_uiPriority);
+  m_StartTimes.PushBack(in_desc.m_fStartTime);
+  m_PausedTimes.PushBack(nsMath::Infinity<double>());
+  m_Delays.PushBack(static_cast<float>(in_desc.m_Delay.GetSeconds()));
+  m_Durations.PushBack(static_cast<float>(nsMath::Max(in_desc.m_Duration.GetSeconds(), 0.0)));
+  m_IterationCounts.PushBack(nsMath::Max(in_desc.m_fIterationCount, 0.0f));
+  m_Directions.PushBack(static_cast<nsUInt8>(in_desc.m_Direction));
+  m_FillModes.PushBack(static_cast<nsUInt8>(in_desc.m_FillMode));
+  m_EasingFunctions.PushBack(m_Easing.Add(in_desc.m_TimingFunction));
+  m_FirstKeyframes.PushBack(m_KeyframeOffsets.GetCount());
+  m_KeyframeCounts.PushBack(in_keyframes.GetCount());
+
+  const bool bTransform = in_desc.m_Property == PropertyId::Transform;
+  for (nsUInt32 k = 0; k < in_keyframes.GetCount(); ++k)
+  {
+    const Keyframe& keyframe = in_keyframes[k];
+    const bool bString = keyframe.m_Value.m_Unit == core::Unit::STRING;
+    m_KeyframeOffsets.PushBack(keyframe.m_fOffset);
+    m_KeyframeValues.PushBack(bString ? css::CSSValue::MakeString(m_KeyframeStrings.Add(keyframe.m_Text)) : keyframe.m_Value);
+
+    TransformValue& transform = m_KeyframeTransforms.ExpandAndGetRef();
+    transform = TransformValue();
+    if (bTransform && bString)
+      TransformValue::Parse(keyframe.m_Text, transform).IgnoreResult();
+
+    const bool bLast = k + 1 == in_keyframes.GetCount();
+    const InterpolationType type =
+      bLast ? InterpolationType::Discrete
+            : GetInterpolationType(in_desc.m_Property, keyframe.m_Value, keyframe.m_Text, in_keyframes[k + 1].m_Value, in_keyframes[k + 1].m_Text);
+    m_SegmentTypes.PushBack(static_cast<nsUInt8>(type));
+  }
+
+  return id;
+}
+
+void AnimationTrackList::RemoveTrack(TrackId in_id)
+{
+  if (!IsValidTrack(in_id))
+    return;
+
+  const nsUInt32 uiIndex = m_IdToIndex[in_id];
+  m_uiUnusedKeyframes += m_KeyframeCounts[uiIndex];
+
+  m_Ids.RemoveAtAndSwap(uiIndex);
+  m_Owners.RemoveAtAndSwap(uiIndex);
+  m_Properties.RemoveAtAndSwap(uiIndex);
+  m_Priorities.RemoveAtAndSwap(uiIndex);
+  m_StartTimes.RemoveAtAndSwap(uiIndex);
+  m_PausedTimes.RemoveAtAndSwap(uiIndex);
+  m_Delays.RemoveAtAndSwap(uiIndex);
+  m_Durations.RemoveAtAndSwap(uiIndex);
+  m_IterationCounts.RemoveAtAndSwap(uiIndex);
+  m_Directions.RemoveAtAndSwap(uiIndex);
+  m_FillModes.RemoveAtAndSwap(uiIndex);
+  m_EasingFunctions.RemoveAtAndSwap(uiIndex);
+  m_FirstKeyframes.RemoveAtAndSwap(uiIndex);
+  m_KeyframeCounts.RemoveAtAndSwap(uiIndex);
+
+  if (uiIndex < m_Ids.GetCount())
+    m_IdToIndex[m_Ids[uiIndex]] = uiIndex;
+  m_IdToIndex[in_id] = InvalidIndex;
+  m_FreeIds.PushBack(in_id);
+
+  if (m_Ids.IsEmpty())
+  {
+    m_KeyframeOffsets.Clear();
+    m_KeyframeValues.Clear();
+    m_KeyframeTransforms.Clear();
+    m_SegmentTypes.Clear();
+    m_KeyframeStrings.Clear();
+    m_uiUnusedKeyframes = 0;
+  }
+  else if (m_uiUnusedKeyframes >= MinKeyframesToCompact && m_uiUnusedKeyframes * 2 > m_KeyframeOffsets.GetCount())
+  {
+    CompactKeyframes();
+  }
+}
+
+void AnimationTrackList::Clear()
+{
+  *this = AnimationTrackList();
+}
+
+void AnimationTrackList::SetPaused(TrackId in_id, bool in_bPaused, double in_fTime)
+{
+  if (!IsValidTrack(in_id))
+    return;
+
+  const nsUInt32 uiIndex = m_IdToIndex[in_id];
+  const bool bIsPaused = m_PausedTimes[uiIndex] != nsMath::Infinity<double>();
+  if (in_bPaused && !bIsPaused)
+  {
+    m_PausedTimes[uiIndex] = in_fTime;
+  }
+  else if (!in_bPaused && bIsPaused)
+  {
+    // Continue where the track was frozen.
+    m_StartTimes[uiIndex] += in_fTime - m_PausedTimes[uiIndex];
+    m_PausedTimes[uiIndex] = nsMath::Infinity<double>();
+  }
+}
+
+double AnimationTrackList::GetEndTime(TrackId in_id) const
+{
+  const nsUInt32 uiIndex = m_IdToIndex[in_id];
+  if (m_PausedTimes[uiIndex] != nsMath::Infinity<double>())
+    return nsMath::Infinity<double>();
+
+  const float fIterations = m_IterationCounts[uiIndex];
+  const double fActiveDuration = m_Durations[uiIndex] == 0.0f ? 0.0 : static_cast<double>(m_Durations[uiIndex]) * fIterations;
+  return m_StartTimes[uiIndex] + m_Delays[uiIndex] + fActiveDuration;
+}
+
+bool AnimationTrackList::ComputeProgress(nsUInt32 in_uiIndex, double in_fTime, float& out_fProgress) const
+{
+  // https://www.w3.org/TR/web-animations-1/#calculating-the-active-time and the following sections.
+  const double fLocalTime = nsMath::Min(in_fTime, m_PausedTimes[in_uiIndex]) - m_StartTimes[in_uiIndex] - m_Delays[in_uiIndex];
+  const float fDuration = m_Durations[in_uiIndex];
+  const float fIterations = m_IterationCounts[in_uiIndex];
+  const AnimationFillMode fill = static_cast<AnimationFillMode>(m_FillModes[in_uiIndex]);
+  const double fActiveDuration = fDuration == 0.0f ? 0.0 : static_cast<double>(fDuration) * fIterations;
+
+  float fOverallProgress;
+  float fIterationProgress;
+  if (fLocalTime < 0.0)
+  {
+    if (fill != AnimationFillMode::Backwards && fill != AnimationFillMode::Both)
+      return false;
+    fOverallProgress = 0.0f;
+    fIterationProgress = 0.0f;
+  }
+  else if (fLocalTime >= fActiveDuration)
+  {
+    if (fill != AnimationFillMode::Forwards && fill != AnimationFillMode::Both)
+      return false;
+    // Ends at the end of a iteration, unless the count has a fraction.
+    fOverallProgress = fIterations;
+    fIterationProgress = nsMath::IsFinite(fIterations) ? fIterations - nsMath::Floor(fIterations) : 1.0f;
+    if (fIterationProgress == 0.0f && fIterations > 0.0f)
+      fIterationProgress = 1.0f;
+  }
+  else
+  {
+    fOverallProgress = static_cast<float>(fLocalTime / fDuration);
+    fIterationProgress = fOverallProgress - nsMath::Floor(fOverallProgress);
+  }
+
+  nsUInt32 uiIteration = static_cast<nsUInt32>(nsMath::Clamp(fOverallProgress, 0.0f, 1.0e9f));
+  if (fIterationProgress == 1.0f && uiIteration > 0)
+    --uiIteration;
+
+  bool bReverse = false;
+  switch (static_cast<AnimationDirection>(m_Directions[in_uiIndex]))
+  {
+    case AnimationDirection::Reverse:
+      bReverse = true;
+      break;
+    case AnimationDirection::Alternate:
+      bReverse = (uiIteration & 1) != 0;
+      break;
+    case AnimationDirection::AlternateReverse:
+      bReverse = (uiIteration & 1) == 0;
+      break;
+    default:
+      break;
+  }
+
+  out_fProgress = bReverse ? 1.0f - fIterationProgress : fIterationProgress;
+  return true;
+}
+
+nsUInt32 AnimationTrackList::FindSegment(nsUInt32 in_uiIndex, float in_fProgress, float& out_fLocalProgress) const
+{
+  // Keyframe lists are short, a linear search beats a binary one.
+  const nsUInt32 uiFirst = m_FirstKeyframes[in_uiIndex];
+  const nsUInt32 uiLast = uiFirst + m_KeyframeCounts[in_uiIndex] - 1;
+  const float* pOffsets = m_KeyframeOffsets.GetData();
+
+  nsUInt32 uiSegment = uiFirst;
+  while (uiSegment + 1 < uiLast && pOffsets[uiSegment + 1] <= in_fProgress)
+  {
+    ++uiSegment;
+  }
+
+  const float fLength = pOffsets[uiSegment + 1] - pOffsets[uiSegment];
+  out_fLocalProgress = fLength > 0.0f ? (in_fProgress - pOffsets[uiSegment]) / fLength : 1.0f;
+  return uiSegment;
+}
+
+void AnimationTrackList::Interpolate(
+  nsUInt32 in_uiIndex, nsUInt32 in_uiSegment, float in_fEased, nsUInt8& out_uiType, css::CSSValue& out_value, TransformValue& out_transform) const
+{
+  out_uiType = m_SegmentTypes[in_uiSegment];
+  const InterpolationType type = static_cast<InterpolationType>(out_uiType);
+  if (type == InterpolationType::Transform)
+    out_transform = TransformValue::Interpolate(m_KeyframeTransforms[in_uiSegment], m_KeyframeTransforms[in_uiSegment + 1], in_fEased);
+  else
+    out_value = InterpolateValue(static_cast<PropertyId>(m_Properties[in_uiIndex]), type, m_KeyframeValues[in_uiSegment], m_KeyframeValues[in_uiSegment + 1], in_fEased);
+}
+
+void AnimationTrackList::Sample(double in_fTime, Samples& out_samples) const
+{
+  const nsUInt32 uiCount = m_Ids.GetCount();
+  out_samples.m_Active.SetCountUninitialized(uiCount);
+  out_samples.m_Types.SetCountUninitialized(uiCount);
+  out_samples.m_Values.SetCountUninitialized(uiCount);
+  out_samples.m_Transforms.SetCountUninitialized(uiCount);
+  out_samples.m_Progress.SetCountUninitialized(uiCount);
+  out_samples.m_Easing.SetCountUninitialized(uiCount);
+  out_samples.m_Segments.SetCountUninitialized(uiCount);
+  out_samples.m_Eased.SetCountUninitialized(uiCount);
+
+  // Timing and segments. Inactive tracks get a dummy segment, they run through the easing pass like all others.
+  for (nsUInt32 i = 0; i < uiCount; ++i)
+  {
+    float fProgress = 0.0f;
+    const bool bActive = ComputeProgress(i, in_fTime, fProgress);
+    out_samples.m_Active[i] = bActive ? 1 : 0;
+    out_samples.m_Segments[i] = FindSegment(i, fProgress, out_samples.m_Progress[i]);
+    out_samples.m_Easing[i] = m_EasingFunctions[i];
+  }
+
+  m_Easing.EvaluateBatch(out_samples.m_Easing, out_samples.m_Progress, out_samples.m_Eased);
+
+  for (nsUInt32 i = 0; i < uiCount; ++i)
+  {
+    if (out_samples.m_Active[i] != 0)
+      Interpolate(i, out_samples.m_Segments[i], out_samples.m_Eased[i], out_samples.m_Types[i], out_samples.m_Values[i], out_samples.m_Transforms[i]);
+  }
+}
+
+bool AnimationTrackList::SampleTrack(TrackId in_id, double in_fTime, InterpolationType& out_type, css::CSSValue& out_value, TransformValue& out_transform) const
+{
+  if (!IsValidTrack(in_id))
+    return false;
+
+  const nsUInt32 uiIndex = m_IdToIndex[in_id];
+  float fProgress = 0.0f;
+  if (!ComputeProgress(uiIndex, in_fTime, fProgress))
+    return false;
+
+  float fLocalProgress = 0.0f;
+  const nsUInt32 uiSegment = FindSegment(uiIndex, fProgress, fLocalProgress);
+  nsUInt8 uiType = 0;
+  Interpolate(uiIndex, uiSegment, m_Easing.Evaluate(m_EasingFunctions[uiIndex], fLocalProgress), uiType, out_value, out_transform);
+  out_type = static_cast<InterpolationType>(uiType);
+  return true;
+}
+
+void AnimationTrackList::CompactKeyframes()
+{
+  nsDynamicArray<float> offsets;
+  nsDynamicArray<css::CSSValue> values;
+  nsDynamicArray<TransformValue> transforms;
+  nsDynamicArray<nsUInt8> types;
+  const nsUInt32 uiUsed = m_KeyframeOffsets.GetCount() - m_uiUnusedKeyframes;
+  offsets.Reserve(uiUsed);
+  values.Reserve(uiUsed);
+  transforms.Reserve(uiUsed);
+  types.Reserve(uiUsed);
+
+  for (nsUInt32 i = 0; i < m_Ids.GetCount(); ++i)
+  {
+    const nsUInt32 uiFirst = m_FirstKeyframes[i];
+    m_FirstKeyframes[i] = offsets.GetCount();
+    offsets.PushBackRange(m_KeyframeOffsets.GetArrayPtr().GetSubArray(uiFirst, m_KeyframeCounts[i]));
+    values.PushBackRange(m_KeyframeValues.GetArrayPtr().GetSubArray(uiFirst, m_KeyframeCounts[i]));
+    transforms.PushBackRange(m_KeyframeTransforms.GetArrayPtr().GetSubArray(uiFirst, m_KeyframeCounts[i]));
+    types.PushBackRange(m_SegmentTypes.GetArrayPtr().GetSubArray(uiFirst, m_KeyframeCounts[i]));
+  }
+
+  // The text of removed keyframes goes with them.
+  css::CSSStringTable strings;
+  for (css::CSSValue& value : values)
+  {
+    if (value.m_Unit == core::Unit::STRING)
+      value = css::CSSValue::MakeString(strings.Add(m_KeyframeStrings.Get(value.m_uiData)));
+  }
+  m_KeyframeStrings = std::move(strings);
+
+  m_KeyframeOffsets.Swap(offsets);
+  m_KeyframeValues.Swap(values);
+  m_KeyframeTransforms.Swap(transforms);
+  m_SegmentTypes.Swap(types);
+  m_uiUnusedKeyframes = 0;
+}
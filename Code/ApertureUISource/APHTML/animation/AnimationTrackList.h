@@ -0,0 +1,190 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/animation/AnimationEasing.h>
+#include <APHTML/animation/AnimationValue.h>
+#include <APHTML/css/Style/CSSStringTable.h>
+#include <Foundation/Types/RefCounted.h>
+
+namespace aperture::animation
+{
+  /*
+   * @brief The keyframe tracks of running animations and transitions, stored as structure of arrays and sampled in batches.
+   *
+   * A track animates one property of one owner (an element, the list only uses it as a key) through two or more
+   * keyframes. Sample() evaluates every track in four passes over flat arrays: the timing of the track, the keyframe
+   * segment the progress falls into, the easing of all tracks in one EasingTable::EvaluateBatch() call and the
+   * interpolation. None of the passes allocate once the scratch arrays have grown.
+   *
+   * Tracks are addressed by a TrackId that stays valid until the track is removed. Removing swaps the last track into
+   * the gap, the keyframes of removed tracks are compacted once they make up most of the keyframe arrays.
+   *
+   * The list is reference counted and copyable, a copy is the snapshot CompositorTimeline samples on another thread.
+   */
+  class NS_APERTURE_DLL AnimationTrackList : public nsRefCounted
+  {
+  public:
+    using TrackId = nsUInt32;
+    static constexpr TrackId InvalidTrackId = 0xFFFFFFFF;
+
+    struct TrackDesc
+    {
+      /// @brief Identifies what the track animates, never dereferenced.
+      const void* m_pOwner = nullptr;
+      PropertyId m_Property = PropertyId::Invalid;
+      /// @brief Tracks of the same owner and property override each other, the active one with the highest priority wins.
+      nsUInt16 m_uiPriority = 0;
+      /// @brief In seconds, on the clock that is passed to Sample().
+      double m_fStartTime = 0.0;
+      nsTime m_Delay;
+      nsTime m_Duration;
+      /// @brief Infinity repeats forever.
+      float m_fIterationCount = 1.0f;
+      AnimationDirection m_Direction = AnimationDirection::Normal;
+      AnimationFillMode m_FillMode = AnimationFillMode::None;
+      /// @brief Applied to every segment between two keyframes.
+      TimingFunction m_TimingFunction;
+    };
+
+    struct Keyframe
+    {
+      NS_DECLARE_POD_TYPE();
+
+      /// @brief In [0, 1].
+      float m_fOffset = 0.0f;
+      /// @brief A computed value, font relative lengths and currentcolor must already be resolved.
+      css::CSSValue m_Value;
+      /// @brief The text of a STRING value, AddTrack() copies it into the list.
+      std::string_view m_Text;
+    };
+
+    /// @brief The results of Sample(), indexed like the tracks (see GetTrackIdAt()). Reuse it to avoid allocations.
+    struct Samples
+    {
+      /// @brief Zero for tracks that have no effect at the sampled time (before the delay or after the end, without fill).
+      nsDynamicArray<nsUInt8> m_Active;
+      /// @brief The InterpolationType of the segment each track is in.
+      nsDynamicArray<nsUInt8> m_Types;
+      /// @brief The values of tracks that are not of type InterpolationType::Transform. The text of STRING values is GetString().
+      nsDynamicArray<css::CSSValue> m_Values;
+      /// @brief The values of tracks of type InterpolationType::Transform.
+      nsDynamicArray<TransformValue> m_Transforms;
+
+      // Scratch arrays of the passes.
+      nsDynamicArray<float> m_Progress;
+      nsDynamicArray<nsUInt16> m_Easing;
+      nsDynamicArray<nsUInt32> m_Segments;
+      nsDynamicArray<float> m_Eased;
+    };
+
+    /// @brief Adds a track. The keyframes must be sorted by offset and start at 0 and end at 1.
+    TrackId AddTrack(const TrackDesc& in_desc, nsArrayPtr<const Keyframe> in_keyframes);
+    void RemoveTrack(TrackId in_id);
+    void Clear();
+
+    bool IsValidTrack(TrackId in_id) const { return in_id < m_IdToIndex.GetCount() && m_IdToIndex[in_id] != InvalidIndex; }
+    nsUInt32 GetTrackCount() const { return m_Ids.GetCount(); }
+
+    /// @brief Freezes the track at in_fTime, or lets it continue from where it was frozen.
+    void SetPaused(TrackId in_id, bool in_bPaused, double in_fTime);
+
+    /// @brief The time after which the track doesn't change anymore, infinity for infinite iteration counts.
+    double GetEndTime(TrackId in_id) const;
+
+    /// @brief The index of the track in the arrays of Samples. Changes when other tracks are removed.
+    nsUInt32 GetTrackIndex(TrackId in_id) const { return m_IdToIndex[in_id]; }
+    TrackId GetTrackIdAt(nsUInt32 in_uiIndex) const { return m_Ids[in_uiIndex]; }
+    const void* GetOwnerAt(nsUInt32 in_uiIndex) const { return m_Owners[in_uiIndex]; }
+    PropertyId GetPropertyAt(nsUInt32 in_uiIndex) const { return static_cast<PropertyId>(m_Properties[in_uiIndex]); }
+    nsUInt16 GetPriorityAt(nsUInt32 in_uiIndex) const { return m_Priorities[in_uiIndex]; }
+
+    /// @brief Samples every track at in_fTime (in seconds).
+    void Sample(double in_fTime, Samples& out_samples) const;
+
+    /// @brief Samples a single track, returns false if it has no effect at in_fTime.
+    /// @param out_transform Receives the value instead of out_value if the returned type is InterpolationType::Transform.
+    bool SampleTrack(TrackId in_id, double in_fTime, InterpolationType& out_type, css::CSSValue& out_value, TransformValue& out_transform) const;
+
+    /// @brief The text of a STRING value sampled from this list, empty for other values.
+    std::string_view GetString(const css::CSSValue& in_value) const
+    {
+      return in_value.m_Unit == core::Unit::STRING ? m_KeyframeStrings.Get(in_value.m_uiData) : std::string_view();
+    }
+
+  private:
+    static constexpr nsUInt32 InvalidIndex = 0xFFFFFFFF;
+
+    /// @brief Returns false if the track has no effect, otherwise the directed progress of the current iteration.
+    bool ComputeProgress(nsUInt32 in_uiIndex, double in_fTime, float& out_fProgress) const;
+    /// @brief Returns the first keyframe of the segment the progress falls into and the progress within it.
+    nsUInt32 FindSegment(nsUInt32 in_uiIndex, float in_fProgress, float& out_fLocalProgress) const;
+    void Interpolate(nsUInt32 in_uiIndex, nsUInt32 in_uiSegment, float in_fEased, nsUInt8& out_uiType, css::CSSValue& out_value, TransformValue& out_transform) const;
+    void CompactKeyframes();
+
+    EasingTable m_Easing;
+
+    // Per track. Enums are stored as their underlying type.
+    nsDynamicArray<TrackId> m_Ids;
+    nsDynamicArray<const void*> m_Owners;
+    nsDynamicArray<nsUInt8> m_Properties;
+    nsDynamicArray<nsUInt16> m_Priorities;
+    nsDynamicArray<double> m_StartTimes;
+    /// @brief Infinity while the track runs.
+    nsDynamicArray<double> m_PausedTimes;
+    nsDynamicArray<float> m_Delays;
+    nsDynamicArray<float> m_Durations;
+    nsDynamicArray<float> m_IterationCounts;
+    nsDynamicArray<nsUInt8> m_Directions;
+    nsDynamicArray<nsUInt8> m_FillModes;
+    nsDynamicArray<nsUInt16> m_EasingFunctions;
+    nsDynamicArray<nsUInt32> m_FirstKeyframes;
+    nsDynamicArray<nsUInt32> m_KeyframeCounts;
+
+    // Per keyframe.
+    nsDynamicArray<float> m_KeyframeOffsets;
+    nsDynamicArray<css::CSSValue> m_KeyframeValues;
+    /// @brief The parsed transforms of Transform tracks, identity for other properties.
+    nsDynamicArray<TransformValue> m_KeyframeTransforms;
+    /// @brief How the segment from this keyframe to the next one is interpolated.
+    nsDynamicArray<nsUInt8> m_SegmentTypes;
+    /// @brief The text of the STRING keyframe values, rebuilt with the keyframes.
+    css::CSSStringTable m_KeyframeStrings;
+    nsUInt32 m_uiUnusedKeyframes = 0;
+
+    nsDynamicArray<nsUInt32> m_IdToIndex;
+    nsDynamicArray<TrackId> m_FreeIds;
+  };
+} // namespace aperture::animation
@@ -0,0 +1,418 @@
+#include <APHTML/animation/AnimationTypes.h>
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
+
+using namespace aperture;
+using namespace aperture::animation;
+using namespace aperture::css::parser;
+
+namespace
+{
+  bool IsEqualNoCase(std::string_view in_a, std::string_view in_b)
+  {
+    if (in_a.size() != in_b.size())
+      return false;
+    for (size_t i = 0; i < in_a.size(); ++i)
+    {
+      if (nsStringUtils::ToLowerChar(in_a[i]) != nsStringUtils::ToLowerChar(in_b[i]))
+        return false;
+    }
+    return true;
+  }
+
+  /// The tokens of one comma separated entry of a shorthand list, without whitespace.
+  using TokenRange = nsArrayPtr<const CSSToken>;
+
+  /// Splits the tokens at the commas outside of functions.
+  void SplitList(const nsDynamicArray<CSSToken>& in_tokens, nsDynamicArray<TokenRange>& out_entries)
+  {
+    nsUInt32 uiDepth = 0;
+    nsUInt32 uiStart = 0;
+    for (nsUInt32 i = 0; i <= in_tokens.GetCount(); ++i)
+    {
+      if (i < in_tokens.GetCount())
+      {
+        const CSSTokenType type = in_tokens[i].m_Type;
+        if (type == CSSTokenType::Function || type == CSSTokenType::OpenParen)
+          ++uiDepth;
+        else if (type == CSSTokenType::CloseParen && uiDepth > 0)
+          --uiDepth;
+
+        if (type != CSSTokenType::Comma || uiDepth > 0)
+          continue;
+      }
+      out_entries.PushBack(in_tokens.GetArrayPtr().GetSubArray(uiStart, i - uiStart));
+      uiStart = i + 1;
+    }
+  }
+
+  bool ParseTime(const CSSToken& in_token, nsTime& out_time)
+  {
+    if (in_token.m_Type == CSSTokenType::Dimension && IsEqualNoCase(in_token.m_Unit, "s"))
+      out_time = nsTime::MakeFromSeconds(in_token.m_fNumber);
+    else if (in_token.m_Type == CSSTokenType::Dimension && IsEqualNoCase(in_token.m_Unit, "ms"))
+      out_time = nsTime::MakeFromMilliseconds(in_token.m_fNumber);
+    else if (in_token.m_Type == CSSTokenType::Number && in_token.m_fNumber == 0.0)
+      out_time = nsTime::MakeZero();
+    else
+      return false;
+    return true;
+  }
+
+  /// Parses the easing function starting at inout_uiIndex and advances past it.
+  nsResult ParseTimingFunctionAt(TokenRange in_tokens, nsUInt32& inout_uiIndex, TimingFunction& out_function)
+  {
+    const CSSToken& token = in_tokens[inout_uiIndex];
+    if (token.m_Type == CSSTokenType::Ident)
+    {
+      struct NamedFunction
+      {
+        const char* m_szName;
+        TimingFunction m_Function;
+      };
+      static const NamedFunction s_Named[] = {
+        {"linear", TimingFunction::MakeLinear()},
+        {"ease", TimingFunction::MakeCubicBezier(0.25f, 0.1f, 0.25f, 1.0f)},
+        {"ease-in", TimingFunction::MakeCubicBezier(0.42f, 0.0f, 1.0f, 1.0f)},
+        {"ease-out", TimingFunction::MakeCubicBezier(0.0f, 0.0f, 0.58f, 1.0f)},
+        {"ease-in-out", TimingFunction::MakeCubicBezier(0.42f, 0.0f, 0.58f, 1.0f)},
+        {"step-start", TimingFunction::MakeSteps(1, StepPosition::JumpStart)},
+        {"step-end", TimingFunction::MakeSteps(1, StepPosition::JumpEnd)},
+      };
+      for (const NamedFunction& named : s_Named)
+      {
+        if (IsEqualNoCase(token.m_Value, named.m_szName))
+        {
+          out_function = named.m_Function;
+          ++inout_uiIndex;
+          return NS_SUCCESS;
+        }
+      }
+      return NS_FAILURE;
+    }
+
+    if (token.m_Type != CSSTokenType::Function)
+      return NS_FAILURE;
+
+    // Arguments up to the closing parenthesis, commas are optional separators here.
+    nsHybridArray<const CSSToken*, 4> arguments;
+    nsUInt32 i = inout_uiIndex + 1;
+    for (; i < in_tokens.GetCount() && in_tokens[i].m_Type != CSSTokenType::CloseParen; ++i)
+    {
+      if (in_tokens[i].m_Type != CSSTokenType::Comma)
+        arguments.PushBack(&in_tokens[i]);
+    }
+    if (i >= in_tokens.GetCount())
+      return NS_FAILURE;
+    inout_uiIndex = i + 1;
+
+    if (IsEqualNoCase(token.m_Value, "cubic-bezier"))
+    {
+      if (arguments.GetCount() != 4)
+        return NS_FAILURE;
+
+      float values[4];
+      for (nsUInt32 a = 0; a < 4; ++a)
+      {
+        if (arguments[a]->m_Type != CSSTokenType::Number)
+          return NS_FAILURE;
+        values[a] = static_cast<float>(arguments[a]->m_fNumber);
+      }
+
+      // The x coordinates must stay in [0, 1], otherwise the curve isn't a function of time.
+      if (values[0] < 0.0f || values[0] > 1.0f || values[2] < 0.0f || values[2] > 1.0f)
+        return NS_FAILURE;
+
+      out_function = TimingFunction::MakeCubicBezier(values[0], values[1], values[2], values[3]);
+      return NS_SUCCESS;
+    }
+
+    if (IsEqualNoCase(token.m_Value, "steps"))
+    {
+      if (arguments.IsEmpty() || arguments.GetCount() > 2 || arguments[0]->m_Type != CSSTokenType::Number || !arguments[0]->HasFlag(CSSToken::IsInteger))
+        return NS_FAILURE;
+
+      StepPosition position = StepPosition::JumpEnd;
+      if (arguments.GetCount() == 2)
+      {
+        const std::string_view name = arguments[1]->m_Type == CSSTokenType::Ident ? arguments[1]->m_Value : std::string_view();
+        if (IsEqualNoCase(name, "jump-start") || IsEqualNoCase(name, "start"))
+          position = StepPosition::JumpStart;
+        else if (IsEqualNoCase(name, "jump-end") || IsEqualNoCase(name, "end"))
+          position = StepPosition::JumpEnd;
+        else if (IsEqualNoCase(name, "jump-none"))
+          position = StepPosition::JumpNone;
+        else if (IsEqualNoCase(name, "jump-both"))
+          position = StepPosition::JumpBoth;
+        else
+          return NS_FAILURE;
+      }
+
+      const double fSteps = arguments[0]->m_fNumber;
+      if (fSteps < (position == StepPosition::JumpNone ? 2.0 : 1.0) || fSteps > 0xFFFF)
+        return NS_FAILURE;
+
+      out_function = TimingFunction::MakeSteps(static_cast<nsUInt16>(fSteps), position);
+      return NS_SUCCESS;
+    }
+
+    return NS_FAILURE;
+  }
+
+  void Tokenize(std::string_view in_value, nsDynamicArray<CSSToken>& out_tokens)
+  {
+    CSSTokenizer::TokenizeAll(in_value, out_tokens, true);
+  }
+
+  bool IsNone(const nsDynamicArray<CSSToken>& in_tokens)
+  {
+    return in_tokens.GetCount() == 1 && in_tokens[0].m_Type == CSSTokenType::Ident && IsEqualNoCase(in_tokens[0].m_Value, "none");
+  }
+} // namespace
+
+TimingFunction TimingFunction::MakeLinear()
+{
+  TimingFunction function;
+  function.m_Type = TimingFunctionType::Linear;
+  function.m_fX1 = 0.0f;
+  function.m_fY1 = 0.0f;
+  function.m_fX2 = 1.0f;
+  function.m_fY2 = 1.0f;
+  return function;
+}
+
+TimingFunction TimingFunction::MakeCubicBezier(float in_fX1, float in_fY1, float in_fX2, float in_fY2)
+{
+  TimingFunction function;
+  function.m_Type = TimingFunctionType::CubicBezier;
+  function.m_fX1 = in_fX1;
+  function.m_fY1 = in_fY1;
+  function.m_fX2 = in_fX2;
+  function.m_fY2 = in_fY2;
+  return function;
+}
+
+TimingFunction TimingFunction::MakeSteps(nsUInt16 in_uiSteps, StepPosition in_position)
+{
+  TimingFunction function;
+  function.m_Type = TimingFunctionType::Steps;
+  function.m_uiSteps = in_uiSteps;
+  function.m_StepPosition = in_position;
+  return function;
+}
+
+bool TimingFunction::operator==(const TimingFunction& other) const
+{
+  if (m_Type != other.m_Type)
+    return false;
+  if (m_Type == TimingFunctionType::Steps)
+    return m_uiSteps == other.m_uiSteps && m_StepPosition == other.m_StepPosition;
+  return m_fX1 == other.m_fX1 && m_fY1 == other.m_fY1 && m_fX2 == other.m_fX2 && m_fY2 == other.m_fY2;
+}
+
+nsResult aperture::animation::ParseTimingFunction(std::string_view in_value, TimingFunction& out_function)
+{
+  nsDynamicArray<CSSToken> tokens;
+  Tokenize(in_value, tokens);
+  if (tokens.IsEmpty())
+    return NS_FAILURE;
+
+  nsUInt32 i = 0;
+  NS_SUCCEED_OR_RETURN(ParseTimingFunctionAt(tokens.GetArrayPtr(), i, out_function));
+  return i == tokens.GetCount() ? NS_SUCCESS : NS_FAILURE;
+}
+
+nsResult aperture::animation::ParseTransitionList(std::string_view in_value, nsDynamicArray<TransitionDesc>& out_transitions)
+{
+  out_transitions.Clear();
+
+  nsDynamicArray<CSSToken> tokens;
+  Tokenize(in_value, tokens);
+  if (IsNone(tokens))
+    return NS_SUCCESS;
+
+  // Invalid values leave the output empty.
+  nsHybridArray<TransitionDesc, 4> transitions;
+
+  nsHybridArray<TokenRange, 4> entries;
+  SplitList(tokens, entries);
+  for (TokenRange entry : entries)
+  {
+    if (entry.IsEmpty())
+      return NS_FAILURE;
+
+    TransitionDesc desc;
+    desc.m_bAllProperties = true;
+    bool bHasProperty = false;
+    bool bHasTimingFunction = false;
+    bool bKnownProperty = true;
+    nsUInt32 uiTimes = 0;
+
+    for (nsUInt32 i = 0; i < entry.GetCount();)
+    {
+      const CSSToken& token = entry[i];
+      nsTime time;
+      if (ParseTime(token, time))
+      {
+        if (uiTimes == 2)
+          return NS_FAILURE;
+        (uiTimes++ == 0 ? desc.m_Duration : desc.m_Delay) = time;
+        ++i;
+        continue;
+      }
+
+      if (!bHasTimingFunction && ParseTimingFunctionAt(entry, i, desc.m_TimingFunction).Succeeded())
+      {
+        bHasTimingFunction = true;
+        continue;
+      }
+
+      if (token.m_Type != CSSTokenType::Ident || bHasProperty)
+        return NS_FAILURE;
+
+      bHasProperty = true;
+      if (IsEqualNoCase(token.m_Value, "all"))
+      {
+        desc.m_bAllProperties = true;
+      }
+      else if (IsEqualNoCase(token.m_Value, "none"))
+      {
+        // "none" is only valid as the single entry.
+        if (entries.GetCount() > 1)
+          return NS_FAILURE;
+        bKnownProperty = false;
+      }
+      else
+      {
+        desc.m_bAllProperties = false;
+        desc.m_Property = css::CSSPropertyTable::FindProperty(token.m_Value);
+        bKnownProperty = desc.m_Property != PropertyId::Invalid;
+      }
+      ++i;
+    }
+
+    if (bKnownProperty)
+      transitions.PushBack(desc);
+  }
+
+  out_transitions = transitions;
+  return NS_SUCCESS;
+}
+
+nsResult aperture::animation::ParseAnimationList(std::string_view in_value, nsDynamicArray<AnimationDesc>& out_animations)
+{
+  out_animations.Clear();
+
+  nsDynamicArray<CSSToken> tokens;
+  Tokenize(in_value, tokens);
+
+  // Invalid values leave the output empty.
+  nsHybridArray<AnimationDesc, 4> animations;
+  nsHybridArray<TokenRange, 4> entries;
+  SplitList(tokens, entries);
+  for (TokenRange entry : entries)
+  {
+    if (entry.IsEmpty())
+      return NS_FAILURE;
+
+    AnimationDesc& desc = animations.ExpandAndGetRef();
+    bool bHasName = false;
+    bool bHasTimingFunction = false;
+    bool bHasIterationCount = false;
+    bool bHasDirection = false;
+    bool bHasFillMode = false;
+    bool bHasPlayState = false;
+    nsUInt32 uiTimes = 0;
+
+    for (nsUInt32 i = 0; i < entry.GetCount();)
+    {
+      const CSSToken& token = entry[i];
+      nsTime time;
+      if (ParseTime(token, time) && token.m_Type != CSSTokenType::Number)
+      {
+        if (uiTimes == 2)
+          return NS_FAILURE;
+        (uiTimes++ == 0 ? desc.m_Duration : desc.m_Delay) = time;
+        ++i;
+        continue;
+      }
+
+      if (token.m_Type == CSSTokenType::Number && !bHasIterationCount && token.m_fNumber >= 0.0)
+      {
+        desc.m_fIterationCount = static_cast<float>(token.m_fNumber);
+        bHasIterationCount = true;
+        ++i;
+        continue;
+      }
+
+      if (!bHasTimingFunction && ParseTimingFunctionAt(entry, i, desc.m_TimingFunction).Succeeded())
+      {
+        bHasTimingFunction = true;
+        continue;
+      }
+
+      // Keywords take precedence over the name, in the order of the longhands. "none" is a name as well.
+      const std::string_view name = token.m_Type == CSSTokenType::Ident ? token.m_Value : std::string_view();
+      ++i;
+      if (!bHasIterationCount && IsEqualNoCase(name, "infinite"))
+      {
+        desc.m_fIterationCount = nsMath::Infinity<float>();
+        bHasIterationCount = true;
+      }
+      else if (!bHasDirection && IsEqualNoCase(name, "normal"))
+        bHasDirection = true;
+      else if (!bHasDirection && IsEqualNoCase(name, "reverse"))
+      {
+        desc.m_Direction = AnimationDirection::Reverse;
+        bHasDirection = true;
+      }
+      else if (!bHasDirection && IsEqualNoCase(name, "alternate"))
+      {
+        desc.m_Direction = AnimationDirection::Alternate;
+        bHasDirection = true;
+      }
+      else if (!bHasDirection && IsEqualNoCase(name, "alternate-reverse"))
+      {
+        desc.m_Direction = AnimationDirection::AlternateReverse;
+        bHasDirection = true;
+      }
+      else if (!bHasFillMode && IsEqualNoCase(name, "forwards"))
+      {
+        desc.m_FillMode = AnimationFillMode::Forwards;
+        bHasFillMode = true;
+      }
+      else if (!bHasFillMode && IsEqualNoCase(name, "backwards"))
+      {
+        desc.m_FillMode = AnimationFillMode::Backwards;
+        bHasFillMode = true;
+      }
+      else if (!bHasFillMode && IsEqualNoCase(name, "both"))
+      {
+        desc.m_FillMode = AnimationFillMode::Both;
+        bHasFillMode = true;
+      }
+      else if (!bHasPlayState && (IsEqualNoCase(name, "running") || IsEqualNoCase(name, "paused")))
+      {
+        desc.m_bPaused = IsEqualNoCase(name, "paused");
+        bHasPlayState = true;
+      }
+      else if (!bHasName && token.m_Type == CSSTokenType::Ident)
+      {
+        desc.m_Name = IsEqualNoCase(name, "none") ? core::InvalidAtom : core::MakeAtom(name);
+        bHasName = true;
+      }
+      else if (!bHasName && token.m_Type == CSSTokenType::String)
+      {
+        desc.m_Name = core::MakeAtom(token.m_Value);
+        bHasName = true;
+      }
+      else
+      {
+        return NS_FAILURE;
+      }
+    }
+  }
+
+  out_animations = animations;
+  return NS_SUCCESS;
+}
@@ -32,14 +32,107 @@ STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
 ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
 EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
-
 #pragma once
-#include <Foundation/Basics.h>
-#include <cmath>
-/// NOTE: The DLL/PCH Header should always be included last.
-#include <APHTML/APEngineDLL.h>
+
+#include <APHTML/core/Atom.h>
+#include <APHTML/core/ID.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Time/Time.h>
+#include <string_view>
 
 namespace aperture::animation
 {
-    
-} // namespace aperture::animation
\ No newline at end of file
+  enum class TimingFunctionType : nsUInt8
+  {
+    Linear,
+    CubicBezier,
+    Steps
+  };
+
+  /// @brief Where the jumps of a steps() function are, see https://www.w3.org/TR/css-easing-1/#step-position.
+  enum class StepPosition : nsUInt8
+  {
+    JumpStart,
+    JumpEnd,
+    JumpNone,
+    JumpBoth
+  };
+
+  /*
+   * @brief A CSS easing function: linear, cubic-bezier() or steps().
+   *
+   * The keywords ease, ease-in, ease-out and ease-in-out are the predefined cubic-bezier() curves, step-start and
+   * step-end the predefined steps() functions. A default constructed function is "ease", the initial value.
+   */
+  struct TimingFunction
+  {
+    NS_DECLARE_POD_TYPE();
+
+    TimingFunctionType m_Type = TimingFunctionType::CubicBezier;
+    StepPosition m_StepPosition = StepPosition::JumpEnd;
+    nsUInt16 m_uiSteps = 1;
+    float m_fX1 = 0.25f;
+    float m_fY1 = 0.1f;
+    float m_fX2 = 0.25f;
+    float m_fY2 = 1.0f;
+
+    static TimingFunction MakeLinear();
+    static TimingFunction MakeCubicBezier(float in_fX1, float in_fY1, float in_fX2, float in_fY2);
+    static TimingFunction MakeSteps(nsUInt16 in_uiSteps, StepPosition in_position);
+
+    bool operator==(const TimingFunction& other) const;
+    bool operator!=(const TimingFunction& other) const { return !(*this == other); }
+  };
+
+  enum class AnimationDirection : nsUInt8
+  {
+    Normal,
+    Reverse,
+    Alternate,
+    AlternateReverse
+  };
+
+  enum class AnimationFillMode : nsUInt8
+  {
+    None,
+    Forwards,
+    Backwards,
+    Both
+  };
+
+  /// @brief One entry of the transition shorthand.
+  struct TransitionDesc
+  {
+    /// @brief The transitioned longhand, ignored if m_bAllProperties is set.
+    PropertyId m_Property = PropertyId::Invalid;
+    bool m_bAllProperties = false;
+    nsTime m_Duration;
+    nsTime m_Delay;
+    TimingFunction m_TimingFunction;
+  };
+
+  /// @brief One entry of the animation shorthand.
+  struct AnimationDesc
+  {
+    /// @brief The name of the @keyframes rule, InvalidAtom for "none".
+    core::Atom m_Name = core::InvalidAtom;
+    nsTime m_Duration;
+    nsTime m_Delay;
+    TimingFunction m_TimingFunction;
+    /// @brief Infinity for "infinite".
+    float m_fIterationCount = 1.0f;
+    AnimationDirection m_Direction = AnimationDirection::Normal;
+    AnimationFillMode m_FillMode = AnimationFillMode::None;
+    bool m_bPaused = false;
+  };
+
+  /// @brief Parses a single easing function, e.g. "ease-out" or "cubic-bezier(0.2, 0, 0, 1)".
+  NS_APERTURE_DLL nsResult ParseTimingFunction(std::string_view in_value, TimingFunction& out_function);
+
+  /// @brief Parses the value of the transition shorthand. "none" results in an empty list.
+  /// Entries that name a unknown or shorthand property are dropped, as they can't be transitioned.
+  NS_APERTURE_DLL nsResult ParseTransitionList(std::string_view in_value, nsDynamicArray<TransitionDesc>& out_transitions);
+
+  /// @brief Parses the value of the animation shorthand. Entries named "none" are kept, they still take up a position in the list.
+  NS_APERTURE_DLL nsResult ParseAnimationList(std::string_view in_value, nsDynamicArray<AnimationDesc>& out_animations);
+} // namespace aperture::animation
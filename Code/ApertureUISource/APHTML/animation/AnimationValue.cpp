@@ -0,0 +1,430 @@
+#include <APHTML/animation/AnimationValue.h>
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <Foundation/Strings/StringBuilder.h>
+
+using namespace aperture;
+using namespace aperture::animation;
+using namespace aperture::css::parser;
+
+namespace
+{
+  bool IsEqualNoCase(std::string_view in_a, std::string_view in_b)
+  {
+    if (in_a.size() != in_b.size())
+      return false;
+    for (size_t i = 0; i < in_a.size(); ++i)
+    {
+      if (nsStringUtils::ToLowerChar(in_a[i]) != nsStringUtils::ToLowerChar(in_b[i]))
+        return false;
+    }
+    return true;
+  }
+
+  /// The matrix [a c e; b d f] as {a, b, c, d, e, f}.
+  struct Matrix
+  {
+    float m[6] = {1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f};
+
+    /// this = this * other, the transform functions of a list apply from right to left.
+    void Multiply(const Matrix& other)
+    {
+      const float* a = m;
+      const float* b = other.m;
+      Matrix result;
+      result.m[0] = a[0] * b[0] + a[2] * b[1];
+      result.m[1] = a[1] * b[0] + a[3] * b[1];
+      result.m[2] = a[0] * b[2] + a[2] * b[3];
+      result.m[3] = a[1] * b[2] + a[3] * b[3];
+      result.m[4] = a[0] * b[4] + a[2] * b[5] + a[4];
+      result.m[5] = a[1] * b[4] + a[3] * b[5] + a[5];
+      *this = result;
+    }
+  };
+
+  bool ParseLength(const CSSToken& in_token, float& out_fPx)
+  {
+    if (in_token.m_Type == CSSTokenType::Dimension && IsEqualNoCase(in_token.m_Unit, "px"))
+      out_fPx = static_cast<float>(in_token.m_fNumber);
+    else if (in_token.m_Type == CSSTokenType::Number && in_token.m_fNumber == 0.0)
+      out_fPx = 0.0f;
+    else
+      return false;
+    return true;
+  }
+
+  bool ParseAngle(const CSSToken& in_token, float& out_fRadian)
+  {
+    const float fNumber = static_cast<float>(in_token.m_fNumber);
+    if (in_token.m_Type == CSSTokenType::Number && in_token.m_fNumber == 0.0)
+      out_fRadian = 0.0f;
+    else if (in_token.m_Type != CSSTokenType::Dimension)
+      return false;
+    else if (IsEqualNoCase(in_token.m_Unit, "deg"))
+      out_fRadian = fNumber * nsMath::Pi<float>() / 180.0f;
+    else if (IsEqualNoCase(in_token.m_Unit, "rad"))
+      out_fRadian = fNumber;
+    else if (IsEqualNoCase(in_token.m_Unit, "grad"))
+      out_fRadian = fNumber * nsMath::Pi<float>() / 200.0f;
+    else if (IsEqualNoCase(in_token.m_Unit, "turn"))
+      out_fRadian = fNumber * 2.0f * nsMath::Pi<float>();
+    else
+      return false;
+    return true;
+  }
+
+  bool ParseNumber(const CSSToken& in_token, float& out_fNumber)
+  {
+    if (in_token.m_Type != CSSTokenType::Number)
+      return false;
+    out_fNumber = static_cast<float>(in_token.m_fNumber);
+    return true;
+  }
+
+  /// Builds the matrix of one transform function from its arguments.
+  nsResult MakeFunctionMatrix(std::string_view in_name, nsArrayPtr<const CSSToken* const> in_args, Matrix& out_matrix)
+  {
+    const nsUInt32 uiArgs = in_args.GetCount();
+    float* m = out_matrix.m;
+
+    if (IsEqualNoCase(in_name, "translate") || IsEqualNoCase(in_name, "translateX") || IsEqualNoCase(in_name, "translateY"))
+    {
+      const bool bBoth = IsEqualNoCase(in_name, "translate");
+      if (uiArgs == 0 || uiArgs > (bBoth ? 2u : 1u))
+        return NS_FAILURE;
+
+      float fX = 0.0f;
+      float fY = 0.0f;
+      if (!ParseLength(*in_args[0], IsEqualNoCase(in_name, "translateY") ? fY : fX))
+        return NS_FAILURE;
+      if (uiArgs == 2 && !ParseLength(*in_args[1], fY))
+        return NS_FAILURE;
+      m[4] = fX;
+      m[5] = fY;
+      return NS_SUCCESS;
+    }
+
+    if (IsEqualNoCase(in_name, "scale") || IsEqualNoCase(in_name, "scaleX") || IsEqualNoCase(in_name, "scaleY"))
+    {
+      const bool bBoth = IsEqualNoCase(in_name, "scale");
+      if (uiArgs == 0 || uiArgs > (bBoth ? 2u : 1u))
+        return NS_FAILURE;
+
+      float fFirst = 1.0f;
+      if (!ParseNumber(*in_args[0], fFirst))
+        return NS_FAILURE;
+      float fSecond = bBoth ? fFirst : 1.0f;
+      if (uiArgs == 2 && !ParseNumber(*in_args[1], fSecond))
+        return NS_FAILURE;
+
+      if (IsEqualNoCase(in_name, "scaleY"))
+        nsMath::Swap(fFirst, fSecond);
+      m[0] = fFirst;
+      m[3] = fSecond;
+      return NS_SUCCESS;
+    }
+
+    if (IsEqualNoCase(in_name, "rotate"))
+    {
+      float fAngle = 0.0f;
+      if (uiArgs != 1 || !ParseAngle(*in_args[0], fAngle))
+        return NS_FAILURE;
+      const nsAngle angle = nsAngle::MakeFromRadian(fAngle);
+      m[0] = nsMath::Cos(angle);
+      m[1] = nsMath::Sin(angle);
+      m[2] = -m[1];
+      m[3] = m[0];
+      return NS_SUCCESS;
+    }
+
+    if (IsEqualNoCase(in_name, "skew") || IsEqualNoCase(in_name, "skewX") || IsEqualNoCase(in_name, "skewY"))
+    {
+      const bool bBoth = IsEqualNoCase(in_name, "skew");
+      if (uiArgs == 0 || uiArgs > (bBoth ? 2u : 1u))
+        return NS_FAILURE;
+
+      float fX = 0.0f;
+      float fY = 0.0f;
+      if (!ParseAngle(*in_args[0], IsEqualNoCase(in_name, "skewY") ? fY : fX))
+        return NS_FAILURE;
+      if (uiArgs == 2 && !ParseAngle(*in_args[1], fY))
+        return NS_FAILURE;
+      m[1] = nsMath::Tan(nsAngle::MakeFromRadian(fY));
+      m[2] = nsMath::Tan(nsAngle::MakeFromRadian(fX));
+      return NS_SUCCESS;
+    }
+
+    if (IsEqualNoCase(in_name, "matrix"))
+    {
+      if (uiArgs != 6)
+        return NS_FAILURE;
+      for (nsUInt32 i = 0; i < 6; ++i)
+      {
+        if (!ParseNumber(*in_args[i], m[i]))
+          return NS_FAILURE;
+      }
+      return NS_SUCCESS;
+    }
+
+    return NS_FAILURE;
+  }
+
+  /// Premultiplied lerp of two RGBA8 colors, as CSS interpolates colors.
+  nsUInt32 InterpolateColor(nsUInt32 in_uiFrom, nsUInt32 in_uiTo, float in_fT)
+  {
+    float from[4];
+    float to[4];
+    for (nsUInt32 c = 0; c < 4; ++c)
+    {
+      from[c] = static_cast<float>((in_uiFrom >> (c * 8)) & 0xFF) / 255.0f;
+      to[c] = static_cast<float>((in_uiTo >> (c * 8)) & 0xFF) / 255.0f;
+    }
+
+    const float fAlpha = nsMath::Clamp(nsMath::Lerp(from[3], to[3], in_fT), 0.0f, 1.0f);
+    nsUInt32 uiResult = static_cast<nsUInt32>(fAlpha * 255.0f + 0.5f) << 24;
+    if (fAlpha <= 0.0f)
+      return uiResult;
+
+    for (nsUInt32 c = 0; c < 3; ++c)
+    {
+      const float fPremultiplied = nsMath::Lerp(from[c] * from[3], to[c] * to[3], in_fT);
+      const float fChannel = nsMath::Clamp(fPremultiplied / fAlpha, 0.0f, 1.0f);
+      uiResult |= static_cast<nsUInt32>(fChannel * 255.0f + 0.5f) << (c * 8);
+    }
+    return uiResult;
+  }
+} // namespace
+
+nsResult TransformValue::Parse(std::string_view in_value, TransformValue& out_transform)
+{
+  nsDynamicArray<CSSToken> tokens;
+  CSSTokenizer::TokenizeAll(in_value, tokens, true);
+  if (tokens.IsEmpty())
+    return NS_FAILURE;
+
+  if (tokens.GetCount() == 1 && tokens[0].m_Type == CSSTokenType::Ident && IsEqualNoCase(tokens[0].m_Value, "none"))
+  {
+    out_transform = TransformValue();
+    return NS_SUCCESS;
+  }
+
+  Matrix matrix;
+  nsHybridArray<const CSSToken*, 6> arguments;
+  for (nsUInt32 i = 0; i < tokens.GetCount();)
+  {
+    const CSSToken& function = tokens[i];
+    if (function.m_Type != CSSTokenType::Function)
+      return NS_FAILURE;
+
+    arguments.Clear();
+    for (++i; i < tokens.GetCount() && tokens[i].m_Type != CSSTokenType::CloseParen; ++i)
+    {
+      if (tokens[i].m_Type != CSSTokenType::Comma)
+        arguments.PushBack(&tokens[i]);
+    }
+    if (i >= tokens.GetCount())
+      return NS_FAILURE;
+    ++i;
+
+    Matrix functionMatrix;
+    NS_SUCCEED_OR_RETURN(MakeFunctionMatrix(function.m_Value, arguments.GetArrayPtr(), functionMatrix));
+    matrix.Multiply(functionMatrix);
+  }
+
+  out_transform = FromMatrix(matrix.m);
+  return NS_SUCCESS;
+}
+
+TransformValue TransformValue::FromMatrix(const float in_matrix[6])
+{
+  // https://www.w3.org/TR/css-transforms-1/#decomposing-a-2d-matrix
+  TransformValue result;
+  result.m_fTranslateX = in_matrix[4];
+  result.m_fTranslateY = in_matrix[5];
+
+  float row0x = in_matrix[0];
+  float row0y = in_matrix[1];
+  float row1x = in_matrix[2];
+  float row1y = in_matrix[3];
+
+  result.m_fScaleX = nsMath::Sqrt(row0x * row0x + row0y * row0y);
+  result.m_fScaleY = nsMath::Sqrt(row1x * row1x + row1y * row1y);
+
+  // A negative determinant is a flip, which becomes a negative scale of one axis.
+  if (row0x * row1y - row0y * row1x < 0.0f)
+  {
+    if (row0x < row1y)
+      result.m_fScaleX = -result.m_fScaleX;
+    else
+      result.m_fScaleY = -result.m_fScaleY;
+  }
+
+  if (result.m_fScaleX != 0.0f)
+  {
+    row0x /= result.m_fScaleX;
+    row0y /= result.m_fScaleX;
+  }
+  if (result.m_fScaleY != 0.0f)
+  {
+    row1x /= result.m_fScaleY;
+    row1y /= result.m_fScaleY;
+  }
+
+  result.m_fRotation = nsMath::ATan2(row0y, row0x).GetRadian();
+  if (result.m_fRotation != 0.0f)
+  {
+    // Rotate the rows back, what is left is the skew.
+    const float fSin = -row0y;
+    const float fCos = row0x;
+    const float m11 = row0x;
+    const float m12 = row0y;
+    const float m21 = row1x;
+    const float m22 = row1y;
+    row0x = fCos * m11 + fSin * m21;
+    row0y = fCos * m12 + fSin * m22;
+    row1x = -fSin * m11 + fCos * m21;
+    row1y = -fSin * m12 + fCos * m22;
+  }
+
+  result.m_fM11 = row0x;
+  result.m_fM12 = row0y;
+  result.m_fM21 = row1x;
+  result.m_fM22 = row1y;
+  return result;
+}
+
+void TransformValue::GetMatrix(float out_matrix[6]) const
+{
+  // translate * remainder * rotate * scale, the inverse of FromMatrix().
+  Matrix matrix;
+  matrix.m[4] = m_fTranslateX;
+  matrix.m[5] = m_fTranslateY;
+
+  Matrix remainder;
+  remainder.m[0] = m_fM11;
+  remainder.m[1] = m_fM12;
+  remainder.m[2] = m_fM21;
+  remainder.m[3] = m_fM22;
+  matrix.Multiply(remainder);
+
+  const nsAngle angle = nsAngle::MakeFromRadian(m_fRotation);
+  Matrix rotation;
+  rotation.m[0] = nsMath::Cos(angle);
+  rotation.m[1] = nsMath::Sin(angle);
+  rotation.m[2] = -rotation.m[1];
+  rotation.m[3] = rotation.m[0];
+  matrix.Multiply(rotation);
+
+  Matrix scale;
+  scale.m[0] = m_fScaleX;
+  scale.m[3] = m_fScaleY;
+  matrix.Multiply(scale);
+
+  for (nsUInt32 i = 0; i < 6; ++i)
+  {
+    out_matrix[i] = matrix.m[i];
+  }
+}
+
+TransformValue TransformValue::Interpolate(const TransformValue& in_from, const TransformValue& in_to, float in_fT)
+{
+  // https://www.w3.org/TR/css-transforms-1/#interpolation-of-decomposed-2d-matrix-values
+  TransformValue from = in_from;
+  TransformValue to = in_to;
+  const float fPi = nsMath::Pi<float>();
+
+  // A flip on both axes is a rotation by 180 degrees, interpolate it as one.
+  if ((from.m_fScaleX < 0.0f && to.m_fScaleY < 0.0f) || (from.m_fScaleY < 0.0f && to.m_fScaleX < 0.0f))
+  {
+    from.m_fScaleX = -from.m_fScaleX;
+    from.m_fScaleY = -from.m_fScaleY;
+    from.m_fRotation += from.m_fRotation < 0.0f ? fPi : -fPi;
+  }
+
+  // Take the shorter way around.
+  if (from.m_fRotation == 0.0f)
+    from.m_fRotation = 2.0f * fPi;
+  if (to.m_fRotation == 0.0f)
+    to.m_fRotation = 2.0f * fPi;
+  if (nsMath::Abs(from.m_fRotation - to.m_fRotation) > fPi)
+  {
+    if (from.m_fRotation > to.m_fRotation)
+      from.m_fRotation -= 2.0f * fPi;
+    else
+      to.m_fRotation -= 2.0f * fPi;
+  }
+
+  TransformValue result;
+  result.m_fTranslateX = nsMath::Lerp(from.m_fTranslateX, to.m_fTranslateX, in_fT);
+  result.m_fTranslateY = nsMath::Lerp(from.m_fTranslateY, to.m_fTranslateY, in_fT);
+  result.m_fScaleX = nsMath::Lerp(from.m_fScaleX, to.m_fScaleX, in_fT);
+  result.m_fScaleY = nsMath::Lerp(from.m_fScaleY, to.m_fScaleY, in_fT);
+  result.m_fRotation = nsMath::Lerp(from.m_fRotation, to.m_fRotation, in_fT);
+  result.m_fM11 = nsMath::Lerp(from.m_fM11, to.m_fM11, in_fT);
+  result.m_fM12 = nsMath::Lerp(from.m_fM12, to.m_fM12, in_fT);
+  result.m_fM21 = nsMath::Lerp(from.m_fM21, to.m_fM21, in_fT);
+  result.m_fM22 = nsMath::Lerp(from.m_fM22, to.m_fM22, in_fT);
+  return result;
+}
+
+std::string TransformValue::ToString() const
+{
+  if (IsIdentity())
+    return "none";
+
+  float m[6];
+  GetMatrix(m);
+  nsStringBuilder text;
+  text.SetFormat("matrix({}, {}, {}, {}, {}, {})", m[0], m[1], m[2], m[3], m[4], m[5]);
+  return std::string(text.GetData(), text.GetElementCount());
+}
+
+bool TransformValue::IsIdentity() const
+{
+  float m[6];
+  GetMatrix(m);
+  constexpr float fEpsilon = 1e-6f;
+  return nsMath::IsEqual(m[0], 1.0f, fEpsilon) && nsMath::IsEqual(m[1], 0.0f, fEpsilon) && nsMath::IsEqual(m[2], 0.0f, fEpsilon) &&
+         nsMath::IsEqual(m[3], 1.0f, fEpsilon) && nsMath::IsEqual(m[4], 0.0f, fEpsilon) && nsMath::IsEqual(m[5], 0.0f, fEpsilon);
+}
+
+InterpolationType aperture::animation::GetInterpolationType(
+  PropertyId in_id, const css::CSSValue& in_from, std::string_view in_fromText, const css::CSSValue& in_to, std::string_view in_toText)
+{
+  if (in_from.IsNumeric() && in_to.IsNumeric())
+    return in_from.m_Unit == in_to.m_Unit ? InterpolationType::Number : InterpolationType::Discrete;
+
+  if (in_from.m_Unit == core::Unit::COLOUR && in_to.m_Unit == core::Unit::COLOUR)
+    return InterpolationType::Color;
+
+  if (in_id == PropertyId::Transform && in_from.m_Unit == core::Unit::STRING && in_to.m_Unit == core::Unit::STRING)
+  {
+    TransformValue from;
+    TransformValue to;
+    if (TransformValue::Parse(in_fromText, from).Succeeded() && TransformValue::Parse(in_toText, to).Succeeded())
+      return InterpolationType::Transform;
+  }
+
+  return InterpolationType::Discrete;
+}
+
+css::CSSValue aperture::animation::InterpolateValue(PropertyId in_id, InterpolationType in_type, const css::CSSValue& in_from, const css::CSSValue& in_to, float in_fT)
+{
+  switch (in_type)
+  {
+    case InterpolationType::Number:
+    {
+      float fNumber = nsMath::Lerp(in_from.m_fNumber, in_to.m_fNumber, in_fT);
+      if (in_id == PropertyId::Opacity)
+        fNumber = nsMath::Clamp(fNumber, 0.0f, 1.0f);
+      return css::CSSValue::MakeNumeric(fNumber, in_from.m_Unit);
+    }
+
+    case InterpolationType::Color:
+      return css::CSSValue::MakeColor(InterpolateColor(in_from.m_uiData, in_to.m_uiData, in_fT));
+
+    default:
+      NS_ASSERT_DEBUG(in_type != InterpolationType::Transform, "Transforms are interpolated with TransformValue::Interpolate().");
+      return in_fT < 0.5f ? in_from : in_to;
+  }
+}
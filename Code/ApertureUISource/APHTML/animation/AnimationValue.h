@@ -0,0 +1,104 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/css/Style/CSSValue.h>
+#include <string>
+#include <string_view>
+
+namespace aperture::animation
+{
+  /*
+   * @brief A 2D transform, decomposed into the components transforms are interpolated in.
+   *
+   * Transform lists are multiplied into one matrix when they are parsed, which is then decomposed as described in
+   * https://www.w3.org/TR/css-transforms-1/#decomposing-a-2d-matrix. Two transforms therefore always interpolate,
+   * even if their function lists don't match. Full turns are lost, rotate(0deg) to rotate(360deg) doesn't spin.
+   *
+   * @note Translations are in px. Percentages depend on the size of the box and are not supported.
+   */
+  struct TransformValue
+  {
+    NS_DECLARE_POD_TYPE();
+
+    float m_fTranslateX = 0.0f;
+    float m_fTranslateY = 0.0f;
+    float m_fScaleX = 1.0f;
+    float m_fScaleY = 1.0f;
+    /// @brief In radians.
+    float m_fRotation = 0.0f;
+    /// @brief What is left of the 2x2 part after rotation and scale were taken out, identity unless the transform skews.
+    float m_fM11 = 1.0f;
+    float m_fM12 = 0.0f;
+    float m_fM21 = 0.0f;
+    float m_fM22 = 1.0f;
+
+    /// @brief Parses a transform list, e.g. "translate(10px, 4px) rotate(45deg)". "none" is the identity.
+    static nsResult Parse(std::string_view in_value, TransformValue& out_transform);
+
+    /// @brief Decomposes the matrix [a c e; b d f], the components of CSS matrix(a, b, c, d, e, f).
+    static TransformValue FromMatrix(const float in_matrix[6]);
+
+    /// @brief Composes the matrix [a c e; b d f] again.
+    void GetMatrix(float out_matrix[6]) const;
+
+    /// @brief Interpolates the components, in_fT may be outside of [0, 1] for easing functions that overshoot.
+    static TransformValue Interpolate(const TransformValue& in_from, const TransformValue& in_to, float in_fT);
+
+    /// @brief The transform as the text of a STRING value: "none" or "matrix(...)".
+    std::string ToString() const;
+
+    bool IsIdentity() const;
+  };
+
+  /// @brief How the values of a property are interpolated.
+  enum class InterpolationType : nsUInt8
+  {
+    /// @brief The values switch at the middle of the interval.
+    Discrete,
+    Number,
+    Color,
+    Transform,
+  };
+
+  /// @brief Returns how the two computed values of the property are interpolated.
+  /// @param in_fromText, in_toText The text of STRING values, ignored for all others.
+  NS_APERTURE_DLL InterpolationType GetInterpolationType(
+    PropertyId in_id, const css::CSSValue& in_from, std::string_view in_fromText, const css::CSSValue& in_to, std::string_view in_toText);
+
+  /// @brief Interpolates two computed values of the property. Transform values must be interpolated with TransformValue.
+  /// @param in_fT The eased progress, may be outside of [0, 1]. The result is clamped to the valid range where the property has one.
+  NS_APERTURE_DLL css::CSSValue InterpolateValue(PropertyId in_id, InterpolationType in_type, const css::CSSValue& in_from, const css::CSSValue& in_to, float in_fT);
+} // namespace aperture::animation
@@ -0,0 +1,66 @@
+#include <APHTML/animation/CompositorTimeline.h>
+
+using namespace aperture;
+using namespace aperture::animation;
+
+void CompositorTimeline::Publish(nsSharedPtr<const AnimationTrackList> in_pTracks)
+{
+  NS_LOCK(m_Mutex);
+  m_pTracks = std::move(in_pTracks);
+}
+
+bool CompositorTimeline::HasTracks() const
+{
+  NS_LOCK(m_Mutex);
+  return m_pTracks != nullptr && m_pTracks->GetTrackCount() > 0;
+}
+
+void CompositorTimeline::Sample(nsTime in_time, nsDynamicArray<LayerValues>& out_layers, AnimationTrackList::Samples& inout_scratch) const
+{
+  out_layers.Clear();
+
+  // The snapshot is immutable, only taking the reference needs the lock.
+  nsSharedPtr<const AnimationTrackList> pTracks;
+  {
+    NS_LOCK(m_Mutex);
+    pTracks = m_pTracks;
+  }
+  if (pTracks == nullptr || pTracks->GetTrackCount() == 0)
+    return;
+
+  pTracks->Sample(in_time.GetSeconds(), inout_scratch);
+
+  m_Layers.Clear();
+
+  for (nsUInt32 i = 0; i < pTracks->GetTrackCount(); ++i)
+  {
+    if (inout_scratch.m_Active[i] == 0)
+      continue;
+
+    const void* pElement = pTracks->GetOwnerAt(i);
+    LayerEntry* pEntry = nullptr;
+    if (!m_Layers.TryGetValue(pElement, pEntry))
+    {
+      LayerEntry entry = {out_layers.GetCount(), -1, -1};
+      m_Layers.Insert(pElement, entry);
+      m_Layers.TryGetValue(pElement, pEntry);
+      out_layers.ExpandAndGetRef().m_pElement = pElement;
+    }
+
+    LayerValues& layer = out_layers[pEntry->m_uiIndex];
+    const nsInt32 iPriority = pTracks->GetPriorityAt(i);
+    const InterpolationType type = static_cast<InterpolationType>(inout_scratch.m_Types[i]);
+    if (pTracks->GetPropertyAt(i) == PropertyId::Opacity && iPriority > pEntry->m_iOpacityPriority && inout_scratch.m_Values[i].IsNumeric())
+    {
+      pEntry->m_iOpacityPriority = iPriority;
+      layer.m_bHasOpacity = true;
+      layer.m_fOpacity = inout_scratch.m_Values[i].m_fNumber;
+    }
+    else if (pTracks->GetPropertyAt(i) == PropertyId::Transform && iPriority > pEntry->m_iTransformPriority && type == InterpolationType::Transform)
+    {
+      pEntry->m_iTransformPriority = iPriority;
+      layer.m_bHasTransform = true;
+      inout_scratch.m_Transforms[i].GetMatrix(layer.m_Transform);
+    }
+  }
+}
@@ -0,0 +1,97 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/animation/AnimationTrackList.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Types/SharedPtr.h>
+
+namespace aperture::animation
+{
+  /*
+   * @brief The opacity and transform animations of a document, sampled on the thread that composites the layers.
+   *
+   * Opacity and transform don't affect style or layout of other elements, so their animations don't have to go
+   * through the main thread every frame. The AnimationManager publishes a snapshot of their tracks whenever tracks
+   * start or end, the compositor samples the latest snapshot at its own frame rate, even while the main thread is
+   * busy with script or layout.
+   *
+   * @note Publish() and Sample() may be called from different threads at the same time. Sample() reuses its lookup
+   * table between frames and is only called from one thread, the compositor's.
+   */
+  class NS_APERTURE_DLL CompositorTimeline
+  {
+  public:
+    /// @brief The animated values of one layer, the element is an opaque key.
+    struct LayerValues
+    {
+      NS_DECLARE_POD_TYPE();
+
+      const void* m_pElement = nullptr;
+      bool m_bHasOpacity = false;
+      bool m_bHasTransform = false;
+      float m_fOpacity = 1.0f;
+      /// @brief The matrix [a c e; b d f] as CSS matrix(a, b, c, d, e, f), relative to the transform origin.
+      float m_Transform[6] = {1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f};
+    };
+
+    /// @brief Replaces the tracks that are sampled. The list must not be modified afterwards.
+    void Publish(nsSharedPtr<const AnimationTrackList> in_pTracks);
+
+    /// @brief Whether there is anything to sample, the compositor can skip animation work otherwise.
+    bool HasTracks() const;
+
+    /// @brief Samples every track at in_time and writes one entry per animated layer.
+    /// @param inout_scratch Reused between frames to avoid allocations.
+    void Sample(nsTime in_time, nsDynamicArray<LayerValues>& out_layers, AnimationTrackList::Samples& inout_scratch) const;
+
+  private:
+    /// @brief The layer of an element in out_layers, and the priority of the tracks that wrote its values.
+    struct LayerEntry
+    {
+      NS_DECLARE_POD_TYPE();
+
+      nsUInt32 m_uiIndex;
+      nsInt32 m_iOpacityPriority;
+      nsInt32 m_iTransformPriority;
+    };
+
+    mutable nsMutex m_Mutex;
+    nsSharedPtr<const AnimationTrackList> m_pTracks;
+    /// @brief Only used by Sample(), cleared every frame but keeps its memory.
+    mutable nsHashTable<const void*, LayerEntry> m_Layers;
+  };
+} // namespace aperture::animation
@@ -0,0 +1,69 @@
+#include <APHTML/core/Atom.h>
+#include <Foundation/Strings/StringBuilder.h>
+
+using namespace aperture::core;
+
+AtomTable& AtomTable::Get()
+{
+  static AtomTable s_AtomTable;
+  return s_AtomTable;
+}
+
+AtomTable::AtomTable()
+{
+  // Atom 0 is reserved for InvalidAtom and maps to the empty string.
+  m_AtomToString.PushBack(NS_DEFAULT_NEW(nsString));
+}
+
+Atom AtomTable::Intern(std::string_view in_string)
+{
+  if (in_string.empty())
+    return InvalidAtom;
+
+  const nsStringView sView(in_string.data(), static_cast<nsUInt32>(in_string.size()));
+
+  NS_LOCK(m_Mutex);
+  Atom atom = InvalidAtom;
+  if (m_StringToAtom.TryGetValue(sView, atom))
+    return atom;
+
+  atom = m_AtomToString.GetCount();
+  m_AtomToString.PushBack(NS_DEFAULT_NEW(nsString, sView));
+  m_StringToAtom.Insert(sView, atom);
+  return atom;
+}
+
+Atom AtomTable::InternLowercase(std::string_view in_string)
+{
+  nsHybridArray<char, 64> lowercase;
+  lowercase.SetCountUninitialized(static_cast<nsUInt32>(in_string.size()));
+  for (nsUInt32 i = 0; i < lowercase.GetCount(); ++i)
+  {
+    const char c = in_string[i];
+    lowercase[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+  }
+  return Intern(std::string_view(lowercase.GetData(), lowercase.GetCount()));
+}
+
+Atom AtomTable::Find(std::string_view in_string) const
+{
+  if (in_string.empty())
+    return InvalidAtom;
+
+  NS_LOCK(m_Mutex);
+  Atom atom = InvalidAtom;
+  m_StringToAtom.TryGetValue(nsStringView(in_string.data(), static_cast<nsUInt32>(in_string.size())), atom);
+  return atom;
+}
+
+nsStringView AtomTable::GetString(Atom in_atom) const
+{
+  NS_LOCK(m_Mutex);
+  return in_atom < m_AtomToString.GetCount() ? m_AtomToString[in_atom]->GetView() : nsStringView();
+}
+
+nsUInt32 AtomTable::GetCount() const
+{
+  NS_LOCK(m_Mutex);
+  return m_AtomToString.GetCount() - 1;
+}
@@ -0,0 +1,93 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Types/UniquePtr.h>
+#include <string_view>
+
+namespace aperture::core
+{
+  /// @brief A interned string, compared by value. 0 is the empty/invalid atom.
+  using Atom = nsUInt32;
+  constexpr Atom InvalidAtom = 0;
+
+  /*
+   * @brief Global table of interned strings (tag names, ids, classes, attribute names, ...).
+   *
+   * Interning happens once when a string enters the DOM or a stylesheet, after that everything that compares names
+   * (selector matching, style invalidation, rule buckets) compares and hashes 32 bit integers.
+   *
+   * @note Atoms are never released, the table only grows. Only strings that are part of documents and stylesheets should be interned.
+   * @note Thread-safe. Lookups of already interned strings still take the lock, callers on hot paths should cache atoms.
+   */
+  class NS_APERTURE_DLL AtomTable
+  {
+  public:
+    static AtomTable& Get();
+
+    /// @brief Returns the atom for the string, interning it if needed.
+    Atom Intern(std::string_view in_string);
+
+    /// @brief Same as Intern(), but lowercases ASCII letters first. Used for case-insensitive names (tags, attribute names).
+    Atom InternLowercase(std::string_view in_string);
+
+    /// @brief Returns the atom for the string, or InvalidAtom if the string was never interned.
+    /// @note A string that was never interned can't match anything that was, so callers can use this to reject early.
+    Atom Find(std::string_view in_string) const;
+
+    /// @brief Returns the string of a atom. The view stays valid for the lifetime of the table.
+    nsStringView GetString(Atom in_atom) const;
+
+    nsUInt32 GetCount() const;
+
+  private:
+    AtomTable();
+
+    mutable nsMutex m_Mutex;
+    nsHashTable<nsString, Atom> m_StringToAtom;
+    /// @brief Indexed by atom. The strings live on the heap, so views into them stay valid when the array grows.
+    nsDynamicArray<nsUniquePtr<nsString>> m_AtomToString;
+  };
+
+  /// @brief Shorthand for AtomTable::Get().Intern().
+  NS_ALWAYS_INLINE Atom MakeAtom(std::string_view in_string)
+  {
+    return AtomTable::Get().Intern(in_string);
+  }
+} // namespace aperture::core
@@ -0,0 +1,9 @@
+#include <APHTML/core/CSSController.h>
+
+using namespace aperture;
+
+css::CSSErrorDatabase& CSSController::GetErrorDatabase()
+{
+  static css::CSSErrorDatabase s_errorDB;
+  return s_errorDB;
+}
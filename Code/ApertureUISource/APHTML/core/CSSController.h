@@ -32,6 +32,8 @@ STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
 ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
 EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
+#pragma once
+
 #include <APHTML/css/CSSErrorDB.h>
 
 namespace aperture
@@ -41,10 +43,8 @@ namespace aperture
   class NS_APERTURE_DLL CSSController
   {
   public:
-    inline static css::CSSErrorDatabase& GetErrorDatabase() { return m_errorDB; }
+    /// @brief The error database for the CSS controller. Created on first use, so that it registers after Foundation started up.
+    static css::CSSErrorDatabase& GetErrorDatabase();
     // TODO: Add CSSAST Tree here.
-  private:
-    /// @brief The error database for the CSS controller.
-    inline static css::CSSErrorDatabase m_errorDB;
   };
 } // namespace aperture
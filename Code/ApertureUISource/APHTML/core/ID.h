@@ -1,3 +1,4 @@
+#pragma once
 #include <APHTML/APEngineCommonIncludes.h>
 namespace aperture
 {
@@ -86,6 +87,7 @@ namespace aperture
     VerticalAlign,
     OverflowX,
     OverflowY,
+    Contain,
     Clip,
     Visibility,
     BackgroundColor,
@@ -145,6 +147,16 @@ namespace aperture
     FlexWrap,
     JustifyContent,
 
+    GridTemplateColumns,
+    GridTemplateRows,
+    GridAutoColumns,
+    GridAutoRows,
+    GridAutoFlow,
+    GridColumnStart,
+    GridColumnEnd,
+    GridRowStart,
+    GridRowEnd,
+
     NavUp,
     NavRight,
     NavDown,
@@ -1,6 +1,175 @@
 #include <APHTML/Interfaces/APCPlatform.h>
+#include <APHTML/core/CSSController.h>
 #include <APHTML/css/CSSErrorDB.h>
+#include <Foundation/Strings/StringBuilder.h>
 
 NS_IMPLEMENT_SINGLETON(aperture::css::CSSErrorDatabase);
 
+using namespace aperture;
+using namespace aperture::css;
 
+namespace
+{
+  struct DiagnosticInfo
+  {
+    const char* m_szMessage;
+    CSSErrorDatabase::CSSErrorType m_Type;
+  };
+
+  constexpr DiagnosticInfo s_Diagnostics[] = {
+    {"Rule without a block", CSSErrorDatabase::CSS_ERROR_SYNTAX},
+    {"Invalid selector", CSSErrorDatabase::CSS_ERROR_SYNTAX},
+    {"Invalid declaration", CSSErrorDatabase::CSS_ERROR_SYNTAX},
+    {"Unknown property", CSSErrorDatabase::CSS_ERROR_SEMANTIC},
+    {"Invalid value", CSSErrorDatabase::CSS_ERROR_SEMANTIC},
+    {"Unsupported at-rule", CSSErrorDatabase::CSS_ERROR_SEMANTIC},
+    {"Invalid media query", CSSErrorDatabase::CSS_ERROR_SYNTAX},
+    {"Invalid @keyframes rule", CSSErrorDatabase::CSS_ERROR_SYNTAX},
+    {"Expected", CSSErrorDatabase::CSS_ERROR_SYNTAX},
+  };
+  static_assert(NS_ARRAY_SIZE(s_Diagnostics) == static_cast<nsUInt32>(CSSDiagnostic::Count));
+} // namespace
+
+CSSErrorDatabase::CSSErrorDatabase()
+  : m_SingletonRegistrar(this)
+{
+#if NS_ENABLED(NS_COMPILE_FOR_DEVELOPMENT)
+  m_Mode = Mode::Record;
+#else
+  m_Mode = Mode::Count;
+#endif
+}
+
+void CSSErrorDatabase::Report(CSSDiagnostic in_id, std::string_view in_argument, std::string_view in_source, nsUInt32 in_uiOffset)
+{
+  if (m_Mode == Mode::Disabled)
+    return;
+
+  m_Counts[static_cast<nsUInt32>(in_id)].Increment();
+  if (m_Mode != Mode::Record)
+    return;
+
+  // The entry is filled in place, the text is cut to the fixed size of the entry.
+  const nsUInt32 uiArgumentLength = static_cast<nsUInt32>(in_argument.size());
+  const nsUInt32 uiSourceLength = static_cast<nsUInt32>(in_source.size());
+  const nsUInt32 uiStoredSource = nsMath::Min(uiSourceLength, Diagnostic::MaxSourceLength);
+
+  NS_LOCK(m_Mutex);
+  Diagnostic& diagnostic = m_Ring[m_uiRecorded % RingSize];
+  diagnostic.m_Id = in_id;
+  diagnostic.m_uiOffset = in_uiOffset;
+  diagnostic.m_uiArgumentLength = uiArgumentLength;
+  diagnostic.m_uiSourceLength = uiSourceLength;
+  nsMemoryUtils::Copy(diagnostic.m_szArgument, in_argument.data(), nsMath::Min(uiArgumentLength, Diagnostic::MaxArgumentLength));
+  nsMemoryUtils::Copy(diagnostic.m_szSource, in_source.data() + (uiSourceLength - uiStoredSource), uiStoredSource);
+  ++m_uiRecorded;
+}
+
+nsUInt32 CSSErrorDatabase::GetTotalCount() const
+{
+  nsUInt32 uiTotal = 0;
+  for (const nsAtomicInteger32& count : m_Counts)
+  {
+    uiTotal += static_cast<nsUInt32>(count);
+  }
+  return uiTotal;
+}
+
+nsUInt32 CSSErrorDatabase::GetRecordedCount() const
+{
+  NS_LOCK(m_Mutex);
+  return nsMath::Min(m_uiRecorded, RingSize);
+}
+
+nsUInt32 CSSErrorDatabase::GetDroppedCount() const
+{
+  NS_LOCK(m_Mutex);
+  return m_uiRecorded > RingSize ? m_uiRecorded - RingSize : 0;
+}
+
+CSSErrorDatabase::Diagnostic CSSErrorDatabase::GetRecorded(nsUInt32 in_uiIndex) const
+{
+  NS_LOCK(m_Mutex);
+  NS_ASSERT_DEBUG(in_uiIndex < nsMath::Min(m_uiRecorded, RingSize), "Index out of range");
+  const nsUInt32 uiOldest = m_uiRecorded > RingSize ? m_uiRecorded - RingSize : 0;
+  return m_Ring[(uiOldest + in_uiIndex) % RingSize];
+}
+
+void CSSErrorDatabase::FormatDiagnostic(const Diagnostic& in_diagnostic, nsStringBuilder& out_message, std::string_view in_sourceText)
+{
+  const std::string_view argument = in_diagnostic.GetArgument();
+  const std::string_view source = in_diagnostic.GetSource();
+  out_message.SetFormat("{0}: {1}", ErrorTypeToString(GetErrorType(in_diagnostic.m_Id)), GetMessage(in_diagnostic.m_Id));
+  if (!argument.empty())
+    out_message.Append(" '", nsStringView(argument.data(), argument.data() + argument.size()), in_diagnostic.IsArgumentTruncated() ? "...'" : "'");
+
+  if (source.empty())
+    out_message.Append(" in inline style");
+  else
+    out_message.Append(in_diagnostic.IsSourceTruncated() ? " in ..." : " in ", nsStringView(source.data(), source.data() + source.size()));
+
+  if (!in_sourceText.empty() && in_diagnostic.m_uiOffset <= in_sourceText.size())
+  {
+    // Lines and columns are only needed here, so they are counted here.
+    nsUInt32 uiLine = 1;
+    nsUInt32 uiLineStart = 0;
+    for (nsUInt32 i = 0; i < in_diagnostic.m_uiOffset; ++i)
+    {
+      if (in_sourceText[i] == '\n')
+      {
+        ++uiLine;
+        uiLineStart = i + 1;
+      }
+    }
+    out_message.AppendFormat(" at line {0}, column {1}", uiLine, in_diagnostic.m_uiOffset - uiLineStart + 1);
+  }
+  else
+  {
+    out_message.AppendFormat(" at offset {0}", in_diagnostic.m_uiOffset);
+  }
+}
+
+const char* CSSErrorDatabase::GetMessage(CSSDiagnostic in_id)
+{
+  return s_Diagnostics[static_cast<nsUInt32>(in_id)].m_szMessage;
+}
+
+CSSErrorDatabase::CSSErrorType CSSErrorDatabase::GetErrorType(CSSDiagnostic in_id)
+{
+  return s_Diagnostics[static_cast<nsUInt32>(in_id)].m_Type;
+}
+
+void CSSErrorDatabase::ClearErrors()
+{
+  NS_LOCK(m_Mutex);
+  for (nsAtomicInteger32& count : m_Counts)
+  {
+    count = 0;
+  }
+  m_uiRecorded = 0;
+}
+
+void CSSErrorDatabase::PrintErrors() const
+{
+  nsStringBuilder sMessage;
+  const nsUInt32 uiCount = GetRecordedCount();
+  for (nsUInt32 i = 0; i < uiCount; ++i)
+  {
+    FormatDiagnostic(GetRecorded(i), sMessage);
+    nsLog::Info("CSS Error: {0}", sMessage);
+  }
+
+  if (const nsUInt32 uiDropped = GetDroppedCount(); uiDropped > 0)
+    nsLog::Info("{0} older CSS errors were dropped", uiDropped);
+}
+
+void CSSDiagnosticSource::Report(CSSDiagnostic in_id, std::string_view in_argument) const
+{
+  CSSErrorDatabase& database = CSSController::GetErrorDatabase();
+  if (database.GetMode() == CSSErrorDatabase::Mode::Disabled)
+    return;
+
+  const bool bInSource = in_argument.data() >= m_Text.data() && in_argument.data() <= m_Text.data() + m_Text.size();
+  const nsUInt32 uiOffset = bInSource ? static_cast<nsUInt32>(in_argument.data() - m_Text.data()) : 0;
+  database.Report(in_id, in_argument, m_Name, uiOffset);
+}
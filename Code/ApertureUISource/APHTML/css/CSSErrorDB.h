@@ -6,25 +6,48 @@
 #pragma once
 
 #include <APHTML/APEngineCommonIncludes.h>
+#include <Foundation/Math/Math.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Mutex.h>
+#include <string_view>
 
 namespace aperture::css
 {
-  struct NS_APERTURE_DLL CSSParsedFileData
+  /// @brief What went wrong, the message of each id is a static string (see CSSErrorDatabase::GetMessage()).
+  enum class CSSDiagnostic : nsUInt8
   {
-  public:
-    std::size_t m_fileSize;
-    /// @brief Absolute or relative (or VFS) file path to the CSS file.
-    nsStringView m_filePath;
+    RuleWithoutBlock,
+    InvalidSelector,
+    InvalidDeclaration,
+    UnknownProperty,
+    InvalidValue,
+    UnsupportedAtRule,
+    InvalidMediaQuery,
+    InvalidKeyframes,
+    /// @brief Reported by the Boost.Parser based parsers, the argument is the expectation that failed.
+    ParserExpectation,
+    Count
   };
 
+  /*
+   * @brief Collects the diagnostics of the CSS parsers.
+   *
+   * Shipped stylesheets are full of declarations the engine doesn't know (vendor prefixes, properties of other
+   * browsers), so reporting has to be close to free. A diagnostic is an id plus the offending text and where it was
+   * found, nothing is formatted when it is reported:
+   * - Mode::Count only bumps a counter per id, the default for non-development builds.
+   * - Mode::Record also keeps the last RingSize diagnostics in a fixed ring buffer. Each entry holds a short copy of its
+   *   text, nothing is allocated or interned, no matter how many distinct errors a stylesheet has.
+   *
+   * FormatDiagnostic() turns a recorded diagnostic into a message, which only happens when someone (DevTools, a log
+   * dump) asks for it. Reporting is thread-safe.
+   */
   class NS_APERTURE_DLL CSSErrorDatabase
   {
     NS_DECLARE_SINGLETON(CSSErrorDatabase);
-  public:
-    
-    friend class css_logger_error_handler;
 
-    CSSErrorDatabase() : m_SingletonRegistrar(this) {}
+  public:
+    CSSErrorDatabase();
 
     enum CSSErrorType
     {
@@ -34,50 +57,73 @@ namespace aperture::css
       CSS_ERROR_UNKNOWN      // Unknown Error.
     };
 
-    struct CSSErrorData
+    enum class Mode : nsUInt8
     {
-    public:
-      CSSErrorType m_errorType;
-      CSSParsedFileData m_fileData;
-      nsString m_errorMessage;
-      int m_lineNumber;
-      int m_columnNumber;
+      Disabled,
+      Count,
+      Record
     };
 
-    // Adds an error to the database with detailed information.
-    void AddError(CSSErrorType in_errorType, const CSSParsedFileData& in_fileData, const std::string& in_errorMessage, int in_lineNumber, int in_columnNumber)
+    struct Diagnostic
     {
-      m_errorData.PushBack(CSSErrorData{in_errorType, in_fileData, in_errorMessage.c_str(), in_lineNumber, in_columnNumber});
-    }
+      NS_DECLARE_POD_TYPE();
 
-    // Clears all stored errors.
-    void ClearErrors()
-    {
-      m_errorData.Clear();
-    }
+      static constexpr nsUInt32 MaxArgumentLength = 63;
+      static constexpr nsUInt32 MaxSourceLength = 95;
 
-    // Prints all errors in a user-friendly format.
-    void PrintErrors()
-    {
-      for (const auto& error : m_errorData)
-      {
-        nsLog::Info("CSS Error: {0}\nFile: {1}\nLine: {2}\nColumn: {3}", error.m_errorMessage.GetData(), error.m_fileData.m_filePath.GetStartPointer(), error.m_lineNumber, error.m_columnNumber);
-      }
-    }
+      /// @brief The offending text, e.g. the name of an unknown property. Empty if there is none, cut after MaxArgumentLength.
+      std::string_view GetArgument() const { return std::string_view(m_szArgument, nsMath::Min(m_uiArgumentLength, MaxArgumentLength)); }
+      /// @brief The name of the stylesheet, empty for inline styles. Long names keep their end, which has the file name.
+      std::string_view GetSource() const { return std::string_view(m_szSource, nsMath::Min(m_uiSourceLength, MaxSourceLength)); }
+      bool IsArgumentTruncated() const { return m_uiArgumentLength > MaxArgumentLength; }
+      bool IsSourceTruncated() const { return m_uiSourceLength > MaxSourceLength; }
 
-    void PrintErrorsUnstructured()
-    {
-      for (const auto& error : m_errorDataRaw)
-      {
-        nsLog::Info("CSS Error: {0}", error);
-      }
-    }
+      CSSDiagnostic m_Id;
+      /// @brief Byte offset of the argument in the source text.
+      nsUInt32 m_uiOffset;
+      /// @brief The full lengths, only the first MaxArgumentLength and the last MaxSourceLength characters are stored.
+      nsUInt32 m_uiArgumentLength;
+      nsUInt32 m_uiSourceLength;
+      char m_szArgument[MaxArgumentLength];
+      char m_szSource[MaxSourceLength];
+    };
+
+    static constexpr nsUInt32 RingSize = 256;
+
+    /// @brief Not synchronized with reporting, set it before parsing starts.
+    void SetMode(Mode in_mode) { m_Mode = in_mode; }
+    Mode GetMode() const { return m_Mode; }
+    bool IsRecording() const { return m_Mode == Mode::Record; }
+
+    void Report(CSSDiagnostic in_id, std::string_view in_argument = {}, std::string_view in_source = {}, nsUInt32 in_uiOffset = 0);
+
+    /// @brief How often the diagnostic was reported since the last ClearErrors(), in Count and Record mode.
+    nsUInt32 GetCount(CSSDiagnostic in_id) const { return static_cast<nsUInt32>(m_Counts[static_cast<nsUInt32>(in_id)]); }
+    nsUInt32 GetTotalCount() const;
+
+    /// @brief The number of diagnostics in the ring buffer, at most RingSize.
+    nsUInt32 GetRecordedCount() const;
+    /// @brief Recorded diagnostics that were overwritten by newer ones.
+    nsUInt32 GetDroppedCount() const;
+    /// @brief Index 0 is the oldest diagnostic still in the ring buffer.
+    Diagnostic GetRecorded(nsUInt32 in_uiIndex) const;
+
+    /// @brief Formats the message of a recorded diagnostic.
+    /// @param in_sourceText The text of the stylesheet, if given the offset is turned into a line and column.
+    static void FormatDiagnostic(const Diagnostic& in_diagnostic, nsStringBuilder& out_message, std::string_view in_sourceText = {});
+
+    static const char* GetMessage(CSSDiagnostic in_id);
+    static CSSErrorType GetErrorType(CSSDiagnostic in_id);
+
+    // Clears all counters and recorded diagnostics.
+    void ClearErrors();
+
+    // Prints all recorded diagnostics in a user-friendly format.
+    void PrintErrors() const;
 
   private:
-    nsDynamicArray<CSSErrorData> m_errorData;
-    nsDynamicArray<const char*> m_errorDataRaw;
     // Converts error type to a string representation for user-friendly output.
-    const char* ErrorTypeToString(CSSErrorType type) const
+    static const char* ErrorTypeToString(CSSErrorType type)
     {
       switch (type)
       {
@@ -93,5 +139,23 @@ namespace aperture::css
           return "Invalid Error Type";
       }
     }
+
+    Mode m_Mode;
+    nsAtomicInteger32 m_Counts[static_cast<nsUInt32>(CSSDiagnostic::Count)];
+
+    mutable nsMutex m_Mutex;
+    Diagnostic m_Ring[RingSize];
+    /// @brief Recorded since the last ClearErrors(), the next one goes to m_Ring[m_uiRecorded % RingSize].
+    nsUInt32 m_uiRecorded = 0;
+  };
+
+  /// @brief The text a parser reports diagnostics for. Arguments point into m_Text, which gives their offset.
+  struct CSSDiagnosticSource
+  {
+    std::string_view m_Text;
+    /// @brief The file name or path of the stylesheet, empty for inline styles.
+    std::string_view m_Name;
+
+    void Report(CSSDiagnostic in_id, std::string_view in_argument) const;
   };
 } // namespace aperture::css
@@ -1,12 +1,216 @@
-#include <APHTML/Interfaces/APCPlatform.h>
-#include <APHTML/Interfaces/APCUtils.h>
-#include <APHTML/core/CSSController.h>
-#include <APHTML/CSS/Function/CSSVarFunction.h>
+#include <APHTML/css/Function/CSSVarFunction.h>
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
 
-void aperture::css::CSSVarFunction::RegisterFunction(const char* in_function, bool is_evaluatable)
+using namespace aperture;
+using namespace aperture::css;
+using namespace aperture::css::parser;
+
+namespace
+{
+  /// @brief Fallbacks can nest var() references, this only guards against absurd input.
+  constexpr nsUInt32 MaxFallbackDepth = 32;
+
+  bool IsEqualNoCase(std::string_view in_a, std::string_view in_b)
+  {
+    if (in_a.size() != in_b.size())
+      return false;
+    for (size_t i = 0; i < in_a.size(); ++i)
+    {
+      if (nsStringUtils::ToLowerChar(in_a[i]) != nsStringUtils::ToLowerChar(in_b[i]))
+        return false;
+    }
+    return true;
+  }
+
+  bool EndsWithNoCase(std::string_view in_text, std::string_view in_suffix)
+  {
+    return in_text.size() >= in_suffix.size() && IsEqualNoCase(in_text.substr(in_text.size() - in_suffix.size()), in_suffix);
+  }
+
+  bool IsVarFunction(const CSSToken& in_token)
+  {
+    return in_token.m_Type == CSSTokenType::Function && IsEqualNoCase(in_token.m_Value, "var");
+  }
+
+  bool IsCustomPropertyName(const CSSToken& in_token)
+  {
+    return in_token.m_Type == CSSTokenType::Ident && in_token.m_Value.size() > 2 && in_token.m_Value[0] == '-' && in_token.m_Value[1] == '-';
+  }
+
+  /// Returns the index of the token that closes the function or block opened right before in_uiStart, or the token count.
+  nsUInt32 FindClosingToken(const nsDynamicArray<CSSToken>& in_tokens, nsUInt32 in_uiStart)
+  {
+    nsUInt32 uiDepth = 0;
+    for (nsUInt32 i = in_uiStart; i < in_tokens.GetCount(); ++i)
+    {
+      switch (in_tokens[i].m_Type)
+      {
+        case CSSTokenType::Function:
+        case CSSTokenType::OpenParen:
+        case CSSTokenType::OpenSquare:
+        case CSSTokenType::OpenCurly:
+          ++uiDepth;
+          break;
+        case CSSTokenType::CloseParen:
+        case CSSTokenType::CloseSquare:
+        case CSSTokenType::CloseCurly:
+          if (uiDepth == 0)
+            return i;
+          --uiDepth;
+          break;
+        default:
+          break;
+      }
+    }
+    return in_tokens.GetCount();
+  }
+
+  nsUInt32 SkipWhitespace(const nsDynamicArray<CSSToken>& in_tokens, nsUInt32 in_uiIndex, nsUInt32 in_uiEnd)
+  {
+    while (in_uiIndex < in_uiEnd && in_tokens[in_uiIndex].m_Type == CSSTokenType::Whitespace)
+      ++in_uiIndex;
+    return in_uiIndex;
+  }
+} // namespace
+
+bool CSSVarFunction::ContainsVariables(std::string_view in_value)
+{
+  for (size_t uiPos = in_value.find('('); uiPos != std::string_view::npos; uiPos = in_value.find('(', uiPos + 1))
+  {
+    if (uiPos >= 3 && IsEqualNoCase(in_value.substr(uiPos - 3, 3), "var"))
+      return true;
+  }
+  return false;
+}
+
+void CSSVarFunction::CollectReferences(std::string_view in_value, nsDynamicArray<core::Atom>& out_names)
+{
+  nsDynamicArray<CSSToken> tokens;
+  CSSTokenizer::TokenizeAll(in_value, tokens, true);
+
+  for (nsUInt32 i = 0; i + 1 < tokens.GetCount(); ++i)
+  {
+    if (IsVarFunction(tokens[i]) && IsCustomPropertyName(tokens[i + 1]))
+      out_names.PushBack(core::MakeAtom(tokens[i + 1].m_Value));
+  }
+}
+
+nsResult CSSVarFunction::Substitute(std::string_view in_value, std::string& out_result) const
+{
+  out_result.clear();
+  return AppendSubstituted(in_value, out_result, 0);
+}
+
+nsResult CSSVarFunction::AppendSubstituted(std::string_view in_value, std::string& inout_result, nsUInt32 in_uiDepth) const
 {
+  if (in_uiDepth > MaxFallbackDepth)
+    return NS_FAILURE;
+
+  nsDynamicArray<CSSToken> tokens;
+  CSSTokenizer::TokenizeAll(in_value, tokens);
+
+  // Everything between references is copied as is.
+  size_t uiCopyFrom = 0;
+  nsUInt32 i = 0;
+  while (i < tokens.GetCount())
+  {
+    if (!IsVarFunction(tokens[i]))
+    {
+      ++i;
+      continue;
+    }
+
+    inout_result.append(in_value.substr(uiCopyFrom, tokens[i].m_uiOffset - uiCopyFrom));
+
+    const nsUInt32 uiClose = FindClosingToken(tokens, i + 1);
+    const nsUInt32 uiName = SkipWhitespace(tokens, i + 1, uiClose);
+    if (uiName >= uiClose || !IsCustomPropertyName(tokens[uiName]))
+      return NS_FAILURE;
+
+    const nsUInt32 uiAfterName = SkipWhitespace(tokens, uiName + 1, uiClose);
+    const bool bHasFallback = uiAfterName < uiClose && tokens[uiAfterName].m_Type == CSSTokenType::Comma;
+    if (uiAfterName < uiClose && !bHasFallback)
+      return NS_FAILURE;
+
+    std::string_view value;
+    if (m_pProperties != nullptr && m_pProperties->TryGet(core::AtomTable::Get().Find(tokens[uiName].m_Value), value))
+    {
+      inout_result.append(value);
+    }
+    else if (bHasFallback)
+    {
+      const size_t uiFallbackStart = tokens[uiAfterName].m_uiOffset + 1;
+      const size_t uiFallbackEnd = uiClose < tokens.GetCount() ? tokens[uiClose].m_uiOffset : in_value.size();
+      NS_SUCCEED_OR_RETURN(AppendSubstituted(in_value.substr(uiFallbackStart, uiFallbackEnd - uiFallbackStart), inout_result, in_uiDepth + 1));
+    }
+    else
+    {
+      return NS_FAILURE;
+    }
+
+    uiCopyFrom = uiClose < tokens.GetCount() ? tokens[uiClose].m_uiOffset + 1 : in_value.size();
+    i = uiClose + 1;
+  }
+
+  inout_result.append(in_value.substr(uiCopyFrom));
+  return NS_SUCCESS;
 }
 
-void aperture::css::CSSVarFunction::EvaluateVariable(const char* in_variable, CSSVarVariant& out_var)
+nsResult CSSVarFunction::EvaluateVariable(std::string_view in_variable, CSSVarVariant& out_var) const
 {
+  const core::Atom name = core::AtomTable::Get().Find(in_variable);
+  std::string_view text;
+  if (m_pProperties == nullptr || name == core::InvalidAtom || !m_pProperties->TryGet(name, text))
+    return NS_FAILURE;
+
+  out_var.m_unit = core::Unit::UNKNOWN;
+
+  CSSValue numeric;
+  nsUInt32 uiRGBA = 0;
+  if (CSSPropertyTable::ParseNumeric(text, numeric).Succeeded())
+  {
+    out_var.m_type = CSSVarVariant::UniqueType::Number;
+    out_var.m_unit = numeric.m_Unit;
+    out_var.m_internalvariant = numeric.m_fNumber;
+    return NS_SUCCESS;
+  }
+
+  if (CSSPropertyTable::ParseColor(text, uiRGBA).Succeeded())
+  {
+    out_var.m_type = CSSVarVariant::UniqueType::Color;
+    out_var.m_internalvariant = uiRGBA;
+    return NS_SUCCESS;
+  }
+
+  nsDynamicArray<CSSToken> tokens;
+  CSSTokenizer::TokenizeAll(text, tokens, true);
+
+  out_var.m_type = CSSVarVariant::UniqueType::Raw;
+  if (!tokens.IsEmpty())
+  {
+    const CSSToken& first = tokens[0];
+    const nsUInt32 uiClose = first.m_Type == CSSTokenType::Function ? FindClosingToken(tokens, 1) : 0;
+    const bool bSingleFunction = first.m_Type == CSSTokenType::Function && uiClose + 1 == tokens.GetCount();
+
+    if (tokens.GetCount() == 1 && first.m_Type == CSSTokenType::Url)
+    {
+      out_var.m_type = CSSVarVariant::UniqueType::URL;
+      out_var.m_internalvariant = nsString(nsStringView(first.m_Value.data(), first.m_Value.data() + first.m_Value.size()));
+      return NS_SUCCESS;
+    }
+    if (bSingleFunction && IsEqualNoCase(first.m_Value, "url") && tokens.GetCount() == 3 && tokens[1].m_Type == CSSTokenType::String)
+    {
+      out_var.m_type = CSSVarVariant::UniqueType::URL;
+      out_var.m_internalvariant = nsString(nsStringView(tokens[1].m_Value.data(), tokens[1].m_Value.data() + tokens[1].m_Value.size()));
+      return NS_SUCCESS;
+    }
+    if (bSingleFunction && EndsWithNoCase(first.m_Value, "gradient"))
+      out_var.m_type = CSSVarVariant::UniqueType::Gradient;
+    else if (bSingleFunction && IsEqualNoCase(first.m_Value, "cubic-bezier"))
+      out_var.m_type = CSSVarVariant::UniqueType::Bezier;
+  }
+
+  out_var.m_internalvariant = nsString(nsStringView(text.data(), text.data() + text.size()));
+  return NS_SUCCESS;
 }
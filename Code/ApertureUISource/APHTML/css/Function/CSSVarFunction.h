@@ -34,18 +34,50 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #pragma once
 
-#include <APHTML/CSS/Function/CSSVarVariant.h>
-#include <APHTML/CSS/Function/CSSIFunction.h>
+#include <APHTML/css/Function/CSSVarVariant.h>
+#include <APHTML/css/Style/CSSCustomProperties.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <string>
+#include <string_view>
 
 namespace aperture::css
 {
-  class NS_APERTURE_DLL CSSVarFunction : public CSSIFunction
+  /*
+   * @brief Evaluates var() references against a set of computed custom properties.
+   *
+   * Substitution works on tokens: every var(--name) or var(--name, fallback) is replaced by the value of the property,
+   * or by the (recursively substituted) fallback if the property has the guaranteed-invalid value. All other text is
+   * copied unchanged, so the result can be parsed like a value without references.
+   *
+   * Dependencies between custom properties of one element (--a: var(--b)) are resolved by the StyleResolver, which
+   * substitutes them in dependency order and drops properties that are part of a cycle.
+   */
+  class NS_APERTURE_DLL CSSVarFunction
   {
   public:
-    virtual void RegisterFunction(const char* in_function, bool is_evaluatable) override;
+    /// @param in_pProperties The properties to substitute, may be null.
+    explicit CSSVarFunction(const CSSCustomProperties* in_pProperties)
+      : m_pProperties(in_pProperties)
+    {
+    }
+
+    /// @brief Cheap check for "var(", may return true for values that only mention it in a string.
+    static bool ContainsVariables(std::string_view in_value);
+
+    /// @brief Appends the names of all properties the value references, including the ones in fallbacks.
+    static void CollectReferences(std::string_view in_value, nsDynamicArray<core::Atom>& out_names);
+
+    /// @brief Replaces all var() references of the value.
+    /// @return NS_FAILURE if a reference is malformed, or has no value and no fallback. The value is invalid at computed-value time then.
+    nsResult Substitute(std::string_view in_value, std::string& out_result) const;
+
+    /// @brief Returns the value of a single custom property, classified by type.
+    /// @param in_variable The name including the leading dashes.
+    nsResult EvaluateVariable(std::string_view in_variable, CSSVarVariant& out_var) const;
 
-    virtual void EvaluateVariable(const char* in_variable, CSSVarVariant& out_var);
   private:
-    CSSVarVariant m_var;
+    nsResult AppendSubstituted(std::string_view in_value, std::string& inout_result, nsUInt32 in_uiDepth) const;
+
+    const CSSCustomProperties* m_pProperties = nullptr;
   };
 } // namespace aperture::css
@@ -34,10 +34,20 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #pragma once
 #include <APHTML/APEngineCommonIncludes.h>
+#include <APHTML/core/Unit.h>
+#include <Foundation/Types/Variant.h>
 
 namespace aperture::css
 {
-  // TODO: Implement CSSVarVariant
+  /*
+   * @brief The value of a custom property, classified by what it can be used as.
+   *
+   * Returned by CSSVarFunction::EvaluateVariable(). The variant holds:
+   *  - Number: the number as float, m_unit is its unit,
+   *  - Color: the color as RGBA8 (nsUInt32), red in the lowest byte,
+   *  - URL: the URL as nsString, without url() and quotes,
+   *  - Gradient, Bezier, Raw: the value text as nsString.
+   */
   class NS_APERTURE_DLL CSSVarVariant
   {
   public:
@@ -48,8 +58,11 @@ namespace aperture::css
       Gradient,
       Bezier,
       Color,
+      /// @brief Anything else, e.g. keywords or lists of values.
+      Raw,
     };
-    UniqueType m_type = UniqueType::URL;
+    UniqueType m_type = UniqueType::Raw;
+    core::Unit m_unit = core::Unit::UNKNOWN;
     nsVariant m_internalvariant;
   };
 } // namespace aperture::css
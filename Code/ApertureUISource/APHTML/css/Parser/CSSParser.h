@@ -34,6 +34,7 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #pragma once
 #include <APHTML/APEngineCommonIncludes.h>
+#include <APHTML/core/CSSController.h>
 #include <boost/parser/parser.hpp>
 #include <fstream>
 #include <ostream>
@@ -45,7 +46,8 @@ namespace aperture::css::parser
   using foundation_interation = nsStringIterator;
 
   
-  /// @brief CSS Parser Error Handler, modified to store log messages in a buffer instead of a file.
+  /// @brief CSS Parser Error Handler, reports to the CSSErrorDatabase of the CSSController.
+  /// Only the failed expectation and its offset are reported, the message is formatted when the database is inspected.
   struct css_logging_error_handler
   {
     css_logging_error_handler() = default;
@@ -54,13 +56,11 @@ namespace aperture::css::parser
     {
       filename = in_filename;
     }
-    // Store error messages in a buffer instead of a file
+
     template <typename Iter, typename Sentinel>
     bp::error_handler_result operator()(Iter first, Sentinel last, bp::parse_error<Iter> const& e) const
     {
-      std::ostringstream oss;
-      bp::write_formatted_expectation_failure_error_message(oss, "buffer", first, last, e);
-      log_message(oss.str());
+      report(e.what(), static_cast<nsUInt32>(std::distance(first, e.iter)));
       return bp::error_handler_result::fail;
     }
 
@@ -71,9 +71,7 @@ namespace aperture::css::parser
       Context const& context,
       Iter it) const
     {
-      std::ostringstream oss;
-      bp::write_formatted_message(oss, "buffer", bp::_begin(context), it, bp::_end(context), message);
-      log_message(oss.str());
+      report(message, static_cast<nsUInt32>(std::distance(bp::_begin(context), it)));
     }
 
     template <typename Context>
@@ -85,20 +83,12 @@ namespace aperture::css::parser
       diagnose(kind, message, context, bp::_where(context).begin());
     }
 
-    // Add a new log message to the buffer
-    void log_message(const std::string& message) const
-    {
-      log_buffer.push_back(message);
-    }
-
-    // Access log messages for inspection
-    const std::vector<std::string>& get_log() const
+    void report(std::string_view in_message, nsUInt32 in_uiOffset) const
     {
-      return log_buffer;
+      CSSController::GetErrorDatabase().Report(CSSDiagnostic::ParserExpectation, in_message, filename != nullptr ? filename : "", in_uiOffset);
     }
 
   private:
-    const char* filename;
-    mutable std::vector<std::string> log_buffer; // Store log messages
+    const char* filename = nullptr;
   };
 } // namespace aperture::css::parser
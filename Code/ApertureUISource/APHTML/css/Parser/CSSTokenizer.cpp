@@ -0,0 +1,632 @@
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <Foundation/Profiling/Profiling.h>
+
+using namespace aperture;
+using namespace aperture::css::parser;
+
+namespace
+{
+  NS_ALWAYS_INLINE bool IsNewline(char c)
+  {
+    return c == '\n' || c == '\r' || c == '\f';
+  }
+
+  NS_ALWAYS_INLINE bool IsWhitespace(char c)
+  {
+    return c == ' ' || c == '\t' || IsNewline(c);
+  }
+
+  NS_ALWAYS_INLINE bool IsDigit(char c)
+  {
+    return c >= '0' && c <= '9';
+  }
+
+  NS_ALWAYS_INLINE bool IsHexDigit(char c)
+  {
+    return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+  }
+
+  NS_ALWAYS_INLINE nsUInt32 HexValue(char c)
+  {
+    if (IsDigit(c))
+      return static_cast<nsUInt32>(c - '0');
+    if (c >= 'a' && c <= 'f')
+      return static_cast<nsUInt32>(c - 'a' + 10);
+    return static_cast<nsUInt32>(c - 'A' + 10);
+  }
+
+  /// Every non-ASCII byte counts as a ident code point, so UTF-8 sequences pass through byte by byte.
+  NS_ALWAYS_INLINE bool IsIdentStart(char c)
+  {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || static_cast<unsigned char>(c) >= 0x80;
+  }
+
+  NS_ALWAYS_INLINE bool IsIdentChar(char c)
+  {
+    return IsIdentStart(c) || IsDigit(c) || c == '-';
+  }
+
+  NS_ALWAYS_INLINE bool IsNonPrintable(char c)
+  {
+    return (c >= 0x00 && c <= 0x08) || c == 0x0B || (c >= 0x0E && c <= 0x1F) || c == 0x7F;
+  }
+
+  NS_ALWAYS_INLINE bool EqualsIgnoreCase(std::string_view a, const char* b)
+  {
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+      if (b[i] == '\0' || (a[i] | 0x20) != b[i])
+        return false;
+    }
+    return b[a.size()] == '\0';
+  }
+} // namespace
+
+CSSTokenizer::CSSTokenizer(std::string_view in_source)
+  : m_Source(in_source)
+{
+}
+
+CSSTokenizer::CSSTokenizer(const core::CoreBuffer<nsUInt8>& in_source)
+  : m_Source(reinterpret_cast<const char*>(in_source.begin()), in_source.size())
+{
+}
+
+CSSToken CSSTokenizer::Peek() const
+{
+  CSSTokenizer copy = *this;
+  return copy.Next();
+}
+
+void CSSTokenizer::TokenizeAll(std::string_view in_source, nsDynamicArray<CSSToken>& out_tokens, bool in_bSkipWhitespace)
+{
+  NS_PROFILE_SCOPE("CSSTokenizer::TokenizeAll");
+
+  CSSTokenizer tokenizer(in_source);
+  while (true)
+  {
+    const CSSToken token = tokenizer.Next();
+    if (token.m_Type == CSSTokenType::EndOfFile)
+      break;
+    if (in_bSkipWhitespace && token.m_Type == CSSTokenType::Whitespace)
+      continue;
+    out_tokens.PushBack(token);
+  }
+}
+
+CSSToken CSSTokenizer::Next()
+{
+  ConsumeComments();
+
+  CSSToken token;
+  token.m_uiOffset = static_cast<nsUInt32>(m_uiPos);
+  if (!HasChar())
+  {
+    token.m_Type = CSSTokenType::EndOfFile;
+    return token;
+  }
+
+  const char c = m_Source[m_uiPos];
+
+  if (IsWhitespace(c))
+  {
+    while (HasChar() && IsWhitespace(m_Source[m_uiPos]))
+      ++m_uiPos;
+    token.m_Type = CSSTokenType::Whitespace;
+    token.m_Value = m_Source.substr(token.m_uiOffset, m_uiPos - token.m_uiOffset);
+    return token;
+  }
+
+  if (IsDigit(c))
+  {
+    ConsumeNumeric(token);
+    return token;
+  }
+
+  if (IsIdentStart(c))
+  {
+    ConsumeIdentLike(token);
+    return token;
+  }
+
+  auto MakeSimple = [&](CSSTokenType in_type) {
+    ++m_uiPos;
+    token.m_Type = in_type;
+    return token;
+  };
+
+  switch (c)
+  {
+    case '"':
+    case '\'':
+      ++m_uiPos;
+      ConsumeString(token, c);
+      return token;
+
+    case '#':
+      if (HasChar(1) && (IsIdentChar(PeekChar(1)) || IsValidEscape(1)))
+      {
+        ++m_uiPos;
+        token.m_Type = CSSTokenType::Hash;
+        if (WouldStartIdent(0))
+          token.m_uiFlags |= CSSToken::HashIsId;
+        bool bHasEscapes = false;
+        token.m_Value = ConsumeName(bHasEscapes);
+        if (bHasEscapes)
+          token.m_uiFlags |= CSSToken::HasEscapes;
+        return token;
+      }
+      break;
+
+    case '(':
+      return MakeSimple(CSSTokenType::OpenParen);
+    case ')':
+      return MakeSimple(CSSTokenType::CloseParen);
+    case '[':
+      return MakeSimple(CSSTokenType::OpenSquare);
+    case ']':
+      return MakeSimple(CSSTokenType::CloseSquare);
+    case '{':
+      return MakeSimple(CSSTokenType::OpenCurly);
+    case '}':
+      return MakeSimple(CSSTokenType::CloseCurly);
+    case ',':
+      return MakeSimple(CSSTokenType::Comma);
+    case ':':
+      return MakeSimple(CSSTokenType::Colon);
+    case ';':
+      return MakeSimple(CSSTokenType::Semicolon);
+
+    case '+':
+    case '.':
+      if (WouldStartNumber(0))
+      {
+        ConsumeNumeric(token);
+        return token;
+      }
+      break;
+
+    case '-':
+      if (WouldStartNumber(0))
+      {
+        ConsumeNumeric(token);
+        return token;
+      }
+      if (PeekChar(1) == '-' && PeekChar(2) == '>')
+      {
+        m_uiPos += 3;
+        token.m_Type = CSSTokenType::CDC;
+        return token;
+      }
+      if (WouldStartIdent(0))
+      {
+        ConsumeIdentLike(token);
+        return token;
+      }
+      break;
+
+    case '<':
+      if (PeekChar(1) == '!' && PeekChar(2) == '-' && PeekChar(3) == '-')
+      {
+        m_uiPos += 4;
+        token.m_Type = CSSTokenType::CDO;
+        return token;
+      }
+      break;
+
+    case '@':
+      if (WouldStartIdent(1))
+      {
+        ++m_uiPos;
+        token.m_Type = CSSTokenType::AtKeyword;
+        bool bHasEscapes = false;
+        token.m_Value = ConsumeName(bHasEscapes);
+        if (bHasEscapes)
+          token.m_uiFlags |= CSSToken::HasEscapes;
+        return token;
+      }
+      break;
+
+    case '\\':
+      if (IsValidEscape(0))
+      {
+        ConsumeIdentLike(token);
+        return token;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  token.m_Type = CSSTokenType::Delim;
+  token.m_Delim = c;
+  token.m_Value = m_Source.substr(m_uiPos, 1);
+  ++m_uiPos;
+  return token;
+}
+
+void CSSTokenizer::ConsumeComments()
+{
+  while (PeekChar(0) == '/' && PeekChar(1) == '*')
+  {
+    const size_t uiEnd = m_Source.find("*/", m_uiPos + 2);
+    m_uiPos = uiEnd == std::string_view::npos ? m_Source.size() : uiEnd + 2;
+  }
+}
+
+bool CSSTokenizer::IsValidEscape(size_t in_uiOffset) const
+{
+  return PeekChar(in_uiOffset) == '\\' && HasChar(in_uiOffset + 1) && !IsNewline(PeekChar(in_uiOffset + 1));
+}
+
+bool CSSTokenizer::WouldStartIdent(size_t in_uiOffset) const
+{
+  const char c = PeekChar(in_uiOffset);
+  if (c == '-')
+  {
+    const char next = PeekChar(in_uiOffset + 1);
+    return IsIdentStart(next) || next == '-' || IsValidEscape(in_uiOffset + 1);
+  }
+  if (IsIdentStart(c))
+    return true;
+  return IsValidEscape(in_uiOffset);
+}
+
+bool CSSTokenizer::WouldStartNumber(size_t in_uiOffset) const
+{
+  char c = PeekChar(in_uiOffset);
+  if (c == '+' || c == '-')
+  {
+    c = PeekChar(++in_uiOffset);
+  }
+  if (IsDigit(c))
+    return true;
+  return c == '.' && IsDigit(PeekChar(in_uiOffset + 1));
+}
+
+void CSSTokenizer::ConsumeEscape()
+{
+  // Assumes the backslash was already consumed and the escape is valid.
+  if (!HasChar())
+    return;
+
+  if (IsHexDigit(m_Source[m_uiPos]))
+  {
+    for (nsUInt32 i = 0; i < 6 && HasChar() && IsHexDigit(m_Source[m_uiPos]); ++i)
+      ++m_uiPos;
+    // A single whitespace after a hex escape belongs to the escape.
+    if (PeekChar() == '\r' && PeekChar(1) == '\n')
+      m_uiPos += 2;
+    else if (HasChar() && IsWhitespace(m_Source[m_uiPos]))
+      ++m_uiPos;
+    return;
+  }
+
+  // Any other code point, including all bytes of a UTF-8 sequence.
+  ++m_uiPos;
+  while (HasChar() && (static_cast<unsigned char>(m_Source[m_uiPos]) & 0xC0) == 0x80)
+    ++m_uiPos;
+}
+
+std::string_view CSSTokenizer::ConsumeName(bool& out_bHasEscapes)
+{
+  const size_t uiStart = m_uiPos;
+  while (HasChar())
+  {
+    const char c = m_Source[m_uiPos];
+    if (IsIdentChar(c))
+    {
+      ++m_uiPos;
+    }
+    else if (IsValidEscape(0))
+    {
+      out_bHasEscapes = true;
+      ++m_uiPos;
+      ConsumeEscape();
+    }
+    else
+    {
+      break;
+    }
+  }
+  return m_Source.substr(uiStart, m_uiPos - uiStart);
+}
+
+double CSSTokenizer::ConsumeNumber(bool& out_bIsInteger)
+{
+  out_bIsInteger = true;
+
+  double fSign = 1.0;
+  if (PeekChar() == '+' || PeekChar() == '-')
+  {
+    fSign = PeekChar() == '-' ? -1.0 : 1.0;
+    ++m_uiPos;
+  }
+
+  double fValue = 0.0;
+  while (HasChar() && IsDigit(m_Source[m_uiPos]))
+  {
+    fValue = fValue * 10.0 + (m_Source[m_uiPos] - '0');
+    ++m_uiPos;
+  }
+
+  if (PeekChar() == '.' && IsDigit(PeekChar(1)))
+  {
+    out_bIsInteger = false;
+    ++m_uiPos;
+    double fScale = 0.1;
+    while (HasChar() && IsDigit(m_Source[m_uiPos]))
+    {
+      fValue += (m_Source[m_uiPos] - '0') * fScale;
+      fScale *= 0.1;
+      ++m_uiPos;
+    }
+  }
+
+  const char e = PeekChar();
+  if (e == 'e' || e == 'E')
+  {
+    size_t uiDigitOffset = 1;
+    const char sign = PeekChar(1);
+    if (sign == '+' || sign == '-')
+      uiDigitOffset = 2;
+
+    if (IsDigit(PeekChar(uiDigitOffset)))
+    {
+      out_bIsInteger = false;
+      m_uiPos += uiDigitOffset;
+      int iExponent = 0;
+      while (HasChar() && IsDigit(m_Source[m_uiPos]))
+      {
+        iExponent = nsMath::Min(iExponent * 10 + (m_Source[m_uiPos] - '0'), 1000);
+        ++m_uiPos;
+      }
+      fValue *= nsMath::Pow(10.0, sign == '-' ? -static_cast<double>(iExponent) : static_cast<double>(iExponent));
+    }
+  }
+
+  return fSign * fValue;
+}
+
+void CSSTokenizer::ConsumeNumeric(CSSToken& inout_token)
+{
+  const size_t uiStart = m_uiPos;
+  bool bIsInteger = true;
+  inout_token.m_fNumber = ConsumeNumber(bIsInteger);
+  inout_token.m_Value = m_Source.substr(uiStart, m_uiPos - uiStart);
+  if (bIsInteger)
+    inout_token.m_uiFlags |= CSSToken::IsInteger;
+
+  if (WouldStartIdent(0))
+  {
+    inout_token.m_Type = CSSTokenType::Dimension;
+    bool bHasEscapes = false;
+    inout_token.m_Unit = ConsumeName(bHasEscapes);
+    if (bHasEscapes)
+      inout_token.m_uiFlags |= CSSToken::HasEscapes;
+  }
+  else if (PeekChar() == '%')
+  {
+    ++m_uiPos;
+    inout_token.m_Type = CSSTokenType::Percentage;
+  }
+  else
+  {
+    inout_token.m_Type = CSSTokenType::Number;
+  }
+}
+
+void CSSTokenizer::ConsumeIdentLike(CSSToken& inout_token)
+{
+  bool bHasEscapes = false;
+  inout_token.m_Value = ConsumeName(bHasEscapes);
+  if (bHasEscapes)
+    inout_token.m_uiFlags |= CSSToken::HasEscapes;
+
+  if (PeekChar() != '(')
+  {
+    inout_token.m_Type = CSSTokenType::Ident;
+    return;
+  }
+
+  ++m_uiPos;
+  if (!bHasEscapes && EqualsIgnoreCase(inout_token.m_Value, "url"))
+  {
+    // url( followed by a quote is a regular function, the string is tokenized on its own.
+    size_t uiLookahead = 0;
+    while (IsWhitespace(PeekChar(uiLookahead)) && HasChar(uiLookahead))
+      ++uiLookahead;
+    const char next = PeekChar(uiLookahead);
+    if (next != '"' && next != '\'')
+    {
+      ConsumeUrl(inout_token);
+      return;
+    }
+  }
+
+  inout_token.m_Type = CSSTokenType::Function;
+}
+
+void CSSTokenizer::ConsumeString(CSSToken& inout_token, char in_endingChar)
+{
+  // The opening quote was already consumed.
+  inout_token.m_Type = CSSTokenType::String;
+  const size_t uiStart = m_uiPos;
+
+  while (HasChar())
+  {
+    const char c = m_Source[m_uiPos];
+    if (c == in_endingChar)
+    {
+      inout_token.m_Value = m_Source.substr(uiStart, m_uiPos - uiStart);
+      ++m_uiPos;
+      return;
+    }
+    if (IsNewline(c))
+    {
+      // Parse error, the newline is not consumed.
+      inout_token.m_Type = CSSTokenType::BadString;
+      inout_token.m_Value = m_Source.substr(uiStart, m_uiPos - uiStart);
+      return;
+    }
+    if (c == '\\')
+    {
+      inout_token.m_uiFlags |= CSSToken::HasEscapes;
+      ++m_uiPos;
+      if (!HasChar())
+        break;
+      if (PeekChar() == '\r' && PeekChar(1) == '\n')
+        m_uiPos += 2;
+      else if (IsNewline(PeekChar()))
+        ++m_uiPos;
+      else
+        ConsumeEscape();
+      continue;
+    }
+    ++m_uiPos;
+  }
+
+  // EOF inside of a string is a parse error, but still returns the string.
+  inout_token.m_Value = m_Source.substr(uiStart, m_uiPos - uiStart);
+}
+
+void CSSTokenizer::ConsumeUrl(CSSToken& inout_token)
+{
+  inout_token.m_Type = CSSTokenType::Url;
+  inout_token.m_uiFlags &= ~CSSToken::HasEscapes;
+
+  while (HasChar() && IsWhitespace(m_Source[m_uiPos]))
+    ++m_uiPos;
+
+  const size_t uiStart = m_uiPos;
+  while (HasChar())
+  {
+    const char c = m_Source[m_uiPos];
+    if (c == ')')
+    {
+      inout_token.m_Value = m_Source.substr(uiStart, m_uiPos - uiStart);
+      ++m_uiPos;
+      return;
+    }
+    if (IsWhitespace(c))
+    {
+      const size_t uiContentEnd = m_uiPos;
+      while (HasChar() && IsWhitespace(m_Source[m_uiPos]))
+        ++m_uiPos;
+      if (!HasChar() || PeekChar() == ')')
+      {
+        inout_token.m_Value = m_Source.substr(uiStart, uiContentEnd - uiStart);
+        if (HasChar())
+          ++m_uiPos;
+        return;
+      }
+      ConsumeBadUrlRemnants();
+      inout_token.m_Type = CSSTokenType::BadUrl;
+      return;
+    }
+    if (c == '"' || c == '\'' || c == '(' || IsNonPrintable(c))
+    {
+      ConsumeBadUrlRemnants();
+      inout_token.m_Type = CSSTokenType::BadUrl;
+      return;
+    }
+    if (c == '\\')
+    {
+      if (!IsValidEscape(0))
+      {
+        ConsumeBadUrlRemnants();
+        inout_token.m_Type = CSSTokenType::BadUrl;
+        return;
+      }
+      inout_token.m_uiFlags |= CSSToken::HasEscapes;
+      ++m_uiPos;
+      ConsumeEscape();
+      continue;
+    }
+    ++m_uiPos;
+  }
+
+  // EOF inside of a url is a parse error, but still returns the url.
+  inout_token.m_Value = m_Source.substr(uiStart, m_uiPos - uiStart);
+}
+
+void CSSTokenizer::ConsumeBadUrlRemnants()
+{
+  while (HasChar())
+  {
+    const char c = m_Source[m_uiPos];
+    if (c == ')')
+    {
+      ++m_uiPos;
+      return;
+    }
+    if (IsValidEscape(0))
+    {
+      ++m_uiPos;
+      ConsumeEscape();
+      continue;
+    }
+    ++m_uiPos;
+  }
+}
+
+void CSSTokenizer::Unescape(std::string_view in_raw, nsStringBuilder& out_value)
+{
+  out_value.Clear();
+
+  size_t uiRunStart = 0;
+  size_t i = 0;
+  while (i < in_raw.size())
+  {
+    if (in_raw[i] != '\\')
+    {
+      ++i;
+      continue;
+    }
+
+    out_value.Append(nsStringView(in_raw.data() + uiRunStart, static_cast<nsUInt32>(i - uiRunStart)));
+    ++i;
+    if (i >= in_raw.size())
+    {
+      // A trailing backslash is a parse error, it is dropped.
+      uiRunStart = i;
+      break;
+    }
+
+    if (IsHexDigit(in_raw[i]))
+    {
+      nsUInt32 uiCodePoint = 0;
+      for (nsUInt32 n = 0; n < 6 && i < in_raw.size() && IsHexDigit(in_raw[i]); ++n, ++i)
+        uiCodePoint = uiCodePoint * 16 + HexValue(in_raw[i]);
+      if (i < in_raw.size() && in_raw[i] == '\r' && i + 1 < in_raw.size() && in_raw[i + 1] == '\n')
+        i += 2;
+      else if (i < in_raw.size() && IsWhitespace(in_raw[i]))
+        ++i;
+
+      if (uiCodePoint == 0 || uiCodePoint > 0x10FFFF || (uiCodePoint >= 0xD800 && uiCodePoint <= 0xDFFF))
+        uiCodePoint = 0xFFFD;
+      out_value.Append(uiCodePoint);
+    }
+    else if (in_raw[i] == '\r' && i + 1 < in_raw.size() && in_raw[i + 1] == '\n')
+    {
+      // Escaped newline inside of a string, it is removed.
+      i += 2;
+    }
+    else if (IsNewline(in_raw[i]))
+    {
+      ++i;
+    }
+    else
+    {
+      // The escaped code point is taken as-is, including all bytes of a UTF-8 sequence.
+      const size_t uiStart = i++;
+      while (i < in_raw.size() && (static_cast<unsigned char>(in_raw[i]) & 0xC0) == 0x80)
+        ++i;
+      out_value.Append(nsStringView(in_raw.data() + uiStart, static_cast<nsUInt32>(i - uiStart)));
+    }
+    uiRunStart = i;
+  }
+
+  out_value.Append(nsStringView(in_raw.data() + uiRunStart, static_cast<nsUInt32>(in_raw.size() - uiRunStart)));
+}
@@ -0,0 +1,162 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <APHTML/Interfaces/Internal/APCBuffer.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <string_view>
+
+namespace aperture::css::parser
+{
+  /// @brief Token types of the CSS Syntax Module Level 3 tokenizer (https://www.w3.org/TR/css-syntax-3/#tokenization).
+  enum class CSSTokenType : nsUInt8
+  {
+    Ident,
+    Function,
+    AtKeyword,
+    Hash,
+    String,
+    BadString,
+    Url,
+    BadUrl,
+    Delim,
+    Number,
+    Percentage,
+    Dimension,
+    Whitespace,
+    CDO,
+    CDC,
+    Colon,
+    Semicolon,
+    Comma,
+    OpenSquare,
+    CloseSquare,
+    OpenParen,
+    CloseParen,
+    OpenCurly,
+    CloseCurly,
+    EndOfFile
+  };
+
+  /// @brief A single token. All views point into the source buffer, nothing is copied.
+  struct CSSToken
+  {
+    enum Flags : nsUInt8
+    {
+      None = 0,
+      /// @brief Hash token whose name would start an ident (type flag "id").
+      HashIsId = NS_BIT(0),
+      /// @brief Numeric token without fraction or exponent (type flag "integer").
+      IsInteger = NS_BIT(1),
+      /// @brief m_Value (or m_Unit) contains escape sequences, use CSSTokenizer::Unescape() to get the actual value.
+      HasEscapes = NS_BIT(2),
+    };
+
+    CSSTokenType m_Type = CSSTokenType::EndOfFile;
+    nsUInt8 m_uiFlags = None;
+    /// @brief Delim code point, only valid for Delim tokens.
+    char m_Delim = 0;
+    /// @brief Byte offset of the token in the source.
+    nsUInt32 m_uiOffset = 0;
+    /// @brief Ident/Function/AtKeyword/Hash name without sigils, String/Url contents without quotes, or the numeric text.
+    std::string_view m_Value;
+    /// @brief The unit of a Dimension token.
+    std::string_view m_Unit;
+    /// @brief The numeric value of Number, Percentage and Dimension tokens.
+    double m_fNumber = 0.0;
+
+    bool HasFlag(Flags in_flag) const { return (m_uiFlags & in_flag) != 0; }
+  };
+
+  /**
+   * @brief Hand-written, zero-copy tokenizer for CSS Syntax Level 3.
+   *
+   * The tokenizer walks the source once and never allocates: every token is a set of std::string_views into the source
+   * buffer, which therefore has to outlive the tokens. Escape sequences are not resolved while tokenizing, tokens that
+   * contain them are flagged with CSSToken::HasEscapes and can be decoded on demand with Unescape().
+   *
+   * Input preprocessing (https://www.w3.org/TR/css-syntax-3/#input-preprocessing) is folded into the tokenizer:
+   * "\r\n", "\r" and "\f" are treated as newlines. Comments are skipped and never produce tokens.
+   *
+   * @note This is the fast path for large stylesheets, the Boost.Parser based rule bank is kept for grammar level checks.
+   */
+  class NS_APERTURE_DLL CSSTokenizer
+  {
+  public:
+    explicit CSSTokenizer(std::string_view in_source);
+    explicit CSSTokenizer(const core::CoreBuffer<nsUInt8>& in_source);
+
+    /// @brief Consumes and returns the next token. Returns EndOfFile tokens once the source is exhausted.
+    CSSToken Next();
+
+    /// @brief Returns the next token without consuming it.
+    CSSToken Peek() const;
+
+    bool IsAtEnd() const { return m_uiPos >= m_Source.size(); }
+    nsUInt32 GetOffset() const { return static_cast<nsUInt32>(m_uiPos); }
+    std::string_view GetSource() const { return m_Source; }
+
+    /// @brief Tokenizes the whole source. The EndOfFile token is not added.
+    /// @note The only allocation is the growth of out_tokens, reuse the array to avoid it.
+    static void TokenizeAll(std::string_view in_source, nsDynamicArray<CSSToken>& out_tokens, bool in_bSkipWhitespace = false);
+
+    /// @brief Resolves the escape sequences of a raw token value.
+    static void Unescape(std::string_view in_raw, nsStringBuilder& out_value);
+
+  private:
+    char PeekChar(size_t in_uiOffset = 0) const { return m_uiPos + in_uiOffset < m_Source.size() ? m_Source[m_uiPos + in_uiOffset] : '\0'; }
+    bool HasChar(size_t in_uiOffset = 0) const { return m_uiPos + in_uiOffset < m_Source.size(); }
+
+    void ConsumeComments();
+    bool IsValidEscape(size_t in_uiOffset) const;
+    bool WouldStartIdent(size_t in_uiOffset) const;
+    bool WouldStartNumber(size_t in_uiOffset) const;
+
+    void ConsumeEscape();
+    /// @brief Consumes a name and returns its raw view. Sets bHasEscapes if the name contains escapes.
+    std::string_view ConsumeName(bool& out_bHasEscapes);
+    double ConsumeNumber(bool& out_bIsInteger);
+    void ConsumeNumeric(CSSToken& inout_token);
+    void ConsumeIdentLike(CSSToken& inout_token);
+    void ConsumeString(CSSToken& inout_token, char in_endingChar);
+    void ConsumeUrl(CSSToken& inout_token);
+    void ConsumeBadUrlRemnants();
+
+  private:
+    std::string_view m_Source;
+    size_t m_uiPos = 0;
+  };
+} // namespace aperture::css::parser
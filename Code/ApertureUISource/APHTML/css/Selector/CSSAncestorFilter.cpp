@@ -0,0 +1,117 @@
+#include <APHTML/css/Selector/CSSAncestorFilter.h>
+#include <APHTML/dom/DOMElement.h>
+
+using namespace aperture;
+using namespace aperture::css;
+
+namespace
+{
+  enum class AtomKind : nsUInt32
+  {
+    Tag = 1,
+    Id = 2,
+    Class = 3
+  };
+
+  /// Integer finalizer from MurmurHash3, cheap and spreads consecutive atoms over the whole table.
+  NS_ALWAYS_INLINE nsUInt32 MixHash(core::Atom in_atom, AtomKind in_kind)
+  {
+    nsUInt32 h = in_atom * 4 + static_cast<nsUInt32>(in_kind);
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+  }
+} // namespace
+
+CSSAncestorFilter::CSSAncestorFilter()
+{
+  m_Counters.SetCount(TableSize);
+  Clear();
+}
+
+nsUInt32 CSSAncestorFilter::GetTagHash(core::Atom in_tag)
+{
+  return MixHash(in_tag, AtomKind::Tag);
+}
+
+nsUInt32 CSSAncestorFilter::GetIdHash(core::Atom in_id)
+{
+  return MixHash(in_id, AtomKind::Id);
+}
+
+nsUInt32 CSSAncestorFilter::GetClassHash(core::Atom in_class)
+{
+  return MixHash(in_class, AtomKind::Class);
+}
+
+void CSSAncestorFilter::PushElement(const dom::DOMElement& in_element)
+{
+  const nsUInt32 uiFirst = m_PushedHashes.GetCount();
+
+  m_PushedHashes.PushBack(GetTagHash(in_element.getTagAtom()));
+  if (in_element.getIdAtom() != core::InvalidAtom)
+  {
+    m_PushedHashes.PushBack(GetIdHash(in_element.getIdAtom()));
+  }
+  for (core::Atom classAtom : in_element.getClassAtoms())
+  {
+    m_PushedHashes.PushBack(GetClassHash(classAtom));
+  }
+
+  for (nsUInt32 i = uiFirst; i < m_PushedHashes.GetCount(); ++i)
+  {
+    Add(m_PushedHashes[i]);
+  }
+  m_FrameSizes.PushBack(m_PushedHashes.GetCount() - uiFirst);
+}
+
+void CSSAncestorFilter::PopElement()
+{
+  NS_ASSERT_DEV(!m_FrameSizes.IsEmpty(), "CSSAncestorFilter: PopElement() without PushElement().");
+
+  const nsUInt32 uiCount = m_FrameSizes.PeekBack();
+  m_FrameSizes.PopBack();
+  for (nsUInt32 i = 0; i < uiCount; ++i)
+  {
+    Remove(m_PushedHashes.PeekBack());
+    m_PushedHashes.PopBack();
+  }
+}
+
+void CSSAncestorFilter::Clear()
+{
+  nsMemoryUtils::ZeroFill(m_Counters.GetData(), TableSize);
+  m_PushedHashes.Clear();
+  m_FrameSizes.Clear();
+  m_uiSaturated = 0;
+}
+
+void CSSAncestorFilter::Add(nsUInt32 in_uiHash)
+{
+  const nsUInt32 uiKeys[2] = {in_uiHash & KeyMask, (in_uiHash >> KeyBits) & KeyMask};
+  for (nsUInt32 uiKey : uiKeys)
+  {
+    if (m_Counters[uiKey] == 0xFF)
+    {
+      ++m_uiSaturated;
+      continue;
+    }
+    ++m_Counters[uiKey];
+  }
+}
+
+void CSSAncestorFilter::Remove(nsUInt32 in_uiHash)
+{
+  const nsUInt32 uiKeys[2] = {in_uiHash & KeyMask, (in_uiHash >> KeyBits) & KeyMask};
+  for (nsUInt32 uiKey : uiKeys)
+  {
+    // Saturated counters are left alone, they only cause false positives.
+    if (m_Counters[uiKey] != 0xFF)
+    {
+      --m_Counters[uiKey];
+    }
+  }
+}
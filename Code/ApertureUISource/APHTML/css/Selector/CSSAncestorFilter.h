@@ -0,0 +1,96 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/core/Atom.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/StaticArray.h>
+
+namespace aperture::dom
+{
+  class DOMElement;
+} // namespace aperture::dom
+
+namespace aperture::css
+{
+  /*
+   * @brief Counting bloom filter over the tag, id and class atoms of the ancestors of the element that is currently styled.
+   *
+   * A style traversal pushes every element before descending into its children and pops it afterwards. Selectors
+   * precompute the hashes of the atoms their ancestor compounds require (see CSSSelector::GetAncestorHashes()), so a
+   * rule like ".menu .item" is rejected with two array lookups when no ancestor has the class "menu".
+   *
+   * @note The filter may report false positives, never false negatives. A positive always runs the full match.
+   * @note One filter per traversal (and thread), it is not thread-safe.
+   */
+  class NS_APERTURE_DLL CSSAncestorFilter
+  {
+  public:
+    static constexpr nsUInt32 KeyBits = 12;
+    static constexpr nsUInt32 TableSize = 1u << KeyBits;
+    static constexpr nsUInt32 KeyMask = TableSize - 1;
+
+    CSSAncestorFilter();
+
+    static nsUInt32 GetTagHash(core::Atom in_tag);
+    static nsUInt32 GetIdHash(core::Atom in_id);
+    static nsUInt32 GetClassHash(core::Atom in_class);
+
+    /// @brief Adds the atoms of a element, call before styling its children.
+    void PushElement(const dom::DOMElement& in_element);
+    /// @brief Removes the atoms of the last pushed element.
+    void PopElement();
+
+    /// @brief Returns false if no ancestor can have the atom the hash was built from.
+    bool MayContain(nsUInt32 in_uiHash) const
+    {
+      return m_Counters[in_uiHash & KeyMask] != 0 && m_Counters[(in_uiHash >> KeyBits) & KeyMask] != 0;
+    }
+
+    nsUInt32 GetDepth() const { return m_FrameSizes.GetCount(); }
+    void Clear();
+
+  private:
+    void Add(nsUInt32 in_uiHash);
+    void Remove(nsUInt32 in_uiHash);
+
+    nsStaticArray<nsUInt8, TableSize> m_Counters;
+    /// @brief Hashes added per pushed element, so popping doesn't depend on the element still having the same atoms.
+    nsDynamicArray<nsUInt32> m_PushedHashes;
+    nsDynamicArray<nsUInt32> m_FrameSizes;
+    /// @brief Counters that saturated can't be decremented reliably anymore, they stay set until Clear().
+    nsUInt32 m_uiSaturated = 0;
+  };
+} // namespace aperture::css
@@ -0,0 +1,74 @@
+#include <APHTML/css/Selector/CSSInvalidationMap.h>
+
+using namespace aperture;
+using namespace aperture::css;
+
+CSSInvalidationMap::CSSInvalidationMap() = default;
+CSSInvalidationMap::~CSSInvalidationMap() = default;
+
+void CSSInvalidationMap::AddSelector(const CSSSelector& in_selector, nsUInt32 in_uiRuleIndex)
+{
+  CSSInvalidationScope::StorageType uiScope = CSSInvalidationScope::Self;
+  for (nsUInt32 c = 0; c < in_selector.GetCompoundCount(); ++c)
+  {
+    const CSSCompoundSelector& compound = in_selector.GetCompound(c);
+
+    for (nsUInt32 i = compound.m_uiFirst; i < compound.m_uiFirst + compound.m_uiCount; ++i)
+    {
+      const CSSSimpleSelector& simple = in_selector.GetSimpleSelector(i);
+      switch (simple.m_Type)
+      {
+        case CSSSimpleSelectorType::Class:
+          AddDependency(m_ClassDependencies, simple.m_Atom, uiScope, in_uiRuleIndex);
+          break;
+        case CSSSimpleSelectorType::Id:
+          AddDependency(m_IdDependencies, simple.m_Atom, uiScope, in_uiRuleIndex);
+          break;
+        case CSSSimpleSelectorType::Attribute:
+          AddDependency(m_AttributeDependencies, simple.m_Atom, uiScope, in_uiRuleIndex);
+          break;
+        case CSSSimpleSelectorType::State:
+          for (nsUInt32 uiBit = 0; uiBit < 32; ++uiBit)
+          {
+            if ((simple.m_uiStateMask & NS_BIT(uiBit)) != 0)
+              m_StateScopes[uiBit] |= uiScope;
+          }
+          break;
+        default:
+          break;
+      }
+    }
+
+    // The combinator to the compound on the left decides where the elements matched by the rest of the chain are:
+    // for "x .a y" they are below the element with .a, for "x .a ~ y" below or at its later siblings.
+    const bool bSibling = compound.m_Combinator == CSSCombinator::NextSibling || compound.m_Combinator == CSSCombinator::SubsequentSibling;
+    uiScope = bSibling ? CSSInvalidationScope::Siblings : CSSInvalidationScope::Descendants;
+  }
+}
+
+void CSSInvalidationMap::Clear()
+{
+  m_ClassDependencies.Clear();
+  m_IdDependencies.Clear();
+  m_AttributeDependencies.Clear();
+  nsMemoryUtils::ZeroFill(m_StateScopes, NS_ARRAY_SIZE(m_StateScopes));
+}
+
+CSSInvalidationScope::StorageType CSSInvalidationMap::GetStateScope(nsUInt32 in_uiStateMask) const
+{
+  CSSInvalidationScope::StorageType uiScope = CSSInvalidationScope::None;
+  for (nsUInt32 uiBit = 0; in_uiStateMask != 0; ++uiBit, in_uiStateMask >>= 1)
+  {
+    if ((in_uiStateMask & 1) != 0)
+      uiScope |= m_StateScopes[uiBit];
+  }
+  return uiScope;
+}
+
+void CSSInvalidationMap::AddDependency(nsHashTable<core::Atom, Dependency>& inout_table, core::Atom in_atom, CSSInvalidationScope::StorageType in_uiScope, nsUInt32 in_uiRuleIndex)
+{
+  Dependency& dependency = inout_table[in_atom];
+  dependency.m_uiScope |= in_uiScope;
+  if (dependency.m_Rules.IsEmpty() || dependency.m_Rules.PeekBack() != in_uiRuleIndex)
+    dependency.m_Rules.PushBack(in_uiRuleIndex);
+}
@@ -0,0 +1,99 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/css/Selector/CSSSelector.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Containers/HybridArray.h>
+
+namespace aperture::css
+{
+  /// @brief Which elements a change of a class, id, attribute or state can affect.
+  struct CSSInvalidationScope
+  {
+    using StorageType = nsUInt8;
+
+    enum Enum : StorageType
+    {
+      None = 0,
+      Self = NS_BIT(0),        ///< Used by the subject compound, ".a"
+      Descendants = NS_BIT(1), ///< Used left of a descendant or child combinator, ".a .b"
+      Siblings = NS_BIT(2),    ///< Used left of a sibling combinator, ".a ~ .b". Covers the subtrees of the later siblings.
+    };
+  };
+
+  /*
+   * @brief Maps the classes, ids, attribute names and element states used by selectors to the rules that use them.
+   *
+   * Built next to the CSSRuleMap. When a element changes, only the features that actually changed are looked up,
+   * and the scope tells which elements have to be restyled: "li:hover" only needs the hovered element, while
+   * ".menu:hover .item" needs its descendants. Changes no selector cares about cost a hash lookup.
+   *
+   * @note Structural changes (adding/removing children) are not covered, they restyle the affected parent.
+   */
+  class NS_APERTURE_DLL CSSInvalidationMap
+  {
+  public:
+    struct Dependency
+    {
+      CSSInvalidationScope::StorageType m_uiScope = CSSInvalidationScope::None;
+      /// @brief The rule indices (as passed to AddSelector()) of the selectors that use the feature.
+      nsHybridArray<nsUInt32, 2> m_Rules;
+    };
+
+    CSSInvalidationMap();
+    ~CSSInvalidationMap();
+
+    void AddSelector(const CSSSelector& in_selector, nsUInt32 in_uiRuleIndex);
+    void Clear();
+
+    const Dependency* FindClass(core::Atom in_class) const { return m_ClassDependencies.GetValue(in_class); }
+    const Dependency* FindId(core::Atom in_id) const { return m_IdDependencies.GetValue(in_id); }
+    /// @param in_name Lowercase attribute name.
+    const Dependency* FindAttribute(core::Atom in_name) const { return m_AttributeDependencies.GetValue(in_name); }
+
+    /// @brief The combined scope of all ElementState bits in the mask.
+    CSSInvalidationScope::StorageType GetStateScope(nsUInt32 in_uiStateMask) const;
+
+  private:
+    static void AddDependency(nsHashTable<core::Atom, Dependency>& inout_table, core::Atom in_atom, CSSInvalidationScope::StorageType in_uiScope, nsUInt32 in_uiRuleIndex);
+
+  private:
+    nsHashTable<core::Atom, Dependency> m_ClassDependencies;
+    nsHashTable<core::Atom, Dependency> m_IdDependencies;
+    nsHashTable<core::Atom, Dependency> m_AttributeDependencies;
+    CSSInvalidationScope::StorageType m_StateScopes[32] = {};
+  };
+} // namespace aperture::css
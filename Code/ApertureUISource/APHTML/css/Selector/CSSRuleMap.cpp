@@ -0,0 +1,130 @@
+#include <APHTML/css/Selector/CSSAncestorFilter.h>
+#include <APHTML/css/Selector/CSSRuleMap.h>
+#include <APHTML/dom/DOMElement.h>
+#include <Foundation/Algorithm/Sorting.h>
+
+using namespace aperture;
+using namespace aperture::css;
+
+namespace
+{
+  struct CascadeOrderComparer
+  {
+    NS_ALWAYS_INLINE bool Less(const CSSMatchedRule& a, const CSSMatchedRule& b) const
+    {
+      if (a.m_uiSpecificity != b.m_uiSpecificity)
+        return a.m_uiSpecificity < b.m_uiSpecificity;
+      return a.m_uiSourceOrder < b.m_uiSourceOrder;
+    }
+    NS_ALWAYS_INLINE bool Equal(const CSSMatchedRule& a, const CSSMatchedRule& b) const
+    {
+      return a.m_uiSpecificity == b.m_uiSpecificity && a.m_uiSourceOrder == b.m_uiSourceOrder;
+    }
+  };
+} // namespace
+
+CSSRuleMap::CSSRuleMap() = default;
+CSSRuleMap::~CSSRuleMap() = default;
+
+void CSSRuleMap::AddSelector(const CSSSelector* in_pSelector, nsUInt32 in_uiRuleIndex, nsUInt32 in_uiSourceOrder)
+{
+  if (in_pSelector == nullptr || in_pSelector->GetCompoundCount() == 0)
+    return;
+
+  Entry entry;
+  entry.m_pSelector = in_pSelector;
+  entry.m_uiRuleIndex = in_uiRuleIndex;
+  entry.m_uiSourceOrder = in_uiSourceOrder;
+  entry.m_uiSpecificity = in_pSelector->GetSpecificity();
+  entry.m_PseudoElement = in_pSelector->GetPseudoElement();
+  nsMemoryUtils::Copy(entry.m_AncestorHashes, in_pSelector->GetAncestorHashes(), CSSSelector::MaxAncestorHashes);
+
+  switch (in_pSelector->GetKeyType())
+  {
+    case CSSSelectorKeyType::Id:
+      m_IdRules[in_pSelector->GetKeyAtom()].PushBack(entry);
+      break;
+    case CSSSelectorKeyType::Class:
+      m_ClassRules[in_pSelector->GetKeyAtom()].PushBack(entry);
+      break;
+    case CSSSelectorKeyType::Tag:
+      m_TagRules[in_pSelector->GetKeyAtom()].PushBack(entry);
+      break;
+    case CSSSelectorKeyType::Universal:
+      m_UniversalRules.PushBack(entry);
+      break;
+  }
+  ++m_uiRuleCount;
+}
+
+void CSSRuleMap::CollectMatchingRules(
+  const dom::DOMElement& in_element, const CSSAncestorFilter* in_pAncestorFilter, nsDynamicArray<CSSMatchedRule>& out_rules, CSSPseudoElement in_pseudoElement) const
+{
+  const nsUInt32 uiFirstNew = out_rules.GetCount();
+
+  if (in_element.getIdAtom() != core::InvalidAtom)
+  {
+    if (const nsDynamicArray<Entry>* pBucket = m_IdRules.GetValue(in_element.getIdAtom()))
+      CollectFromBucket(*pBucket, in_element, in_pAncestorFilter, in_pseudoElement, out_rules);
+  }
+
+  // Class atoms are unique per element, so a rule is never collected twice.
+  for (core::Atom classAtom : in_element.getClassAtoms())
+  {
+    if (const nsDynamicArray<Entry>* pBucket = m_ClassRules.GetValue(classAtom))
+      CollectFromBucket(*pBucket, in_element, in_pAncestorFilter, in_pseudoElement, out_rules);
+  }
+
+  if (const nsDynamicArray<Entry>* pBucket = m_TagRules.GetValue(in_element.getTagAtom()))
+    CollectFromBucket(*pBucket, in_element, in_pAncestorFilter, in_pseudoElement, out_rules);
+
+  CollectFromBucket(m_UniversalRules, in_element, in_pAncestorFilter, in_pseudoElement, out_rules);
+
+  if (out_rules.GetCount() - uiFirstNew > 1)
+  {
+    nsArrayPtr<CSSMatchedRule> newRules = out_rules.GetArrayPtr().GetSubArray(uiFirstNew);
+    nsSorting::QuickSort(newRules, CascadeOrderComparer());
+  }
+}
+
+void CSSRuleMap::Clear()
+{
+  m_IdRules.Clear();
+  m_ClassRules.Clear();
+  m_TagRules.Clear();
+  m_UniversalRules.Clear();
+  m_uiRuleCount = 0;
+}
+
+void CSSRuleMap::CollectFromBucket(const nsDynamicArray<Entry>& in_bucket, const dom::DOMElement& in_element, const CSSAncestorFilter* in_pAncestorFilter,
+  CSSPseudoElement in_pseudoElement, nsDynamicArray<CSSMatchedRule>& out_rules) const
+{
+  for (const Entry& entry : in_bucket)
+  {
+    if (entry.m_PseudoElement != in_pseudoElement)
+      continue;
+
+    if (in_pAncestorFilter != nullptr)
+    {
+      bool bRejected = false;
+      for (nsUInt32 i = 0; i < CSSSelector::MaxAncestorHashes && entry.m_AncestorHashes[i] != 0; ++i)
+      {
+        if (!in_pAncestorFilter->MayContain(entry.m_AncestorHashes[i]))
+        {
+          bRejected = true;
+          break;
+        }
+      }
+      if (bRejected)
+        continue;
+    }
+
+    if (!entry.m_pSelector->Matches(in_element))
+      continue;
+
+    CSSMatchedRule& matched = out_rules.ExpandAndGetRef();
+    matched.m_uiRuleIndex = entry.m_uiRuleIndex;
+    matched.m_uiSpecificity = entry.m_uiSpecificity;
+    matched.m_uiSourceOrder = entry.m_uiSourceOrder;
+  }
+}
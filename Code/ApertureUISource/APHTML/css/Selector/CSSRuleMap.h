@@ -0,0 +1,114 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/css/Selector/CSSSelector.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+
+namespace aperture::dom
+{
+  class DOMElement;
+} // namespace aperture::dom
+
+namespace aperture::css
+{
+  class CSSAncestorFilter;
+
+  /// @brief A rule that matched a element, as returned by CSSRuleMap::CollectMatchingRules().
+  struct CSSMatchedRule
+  {
+    NS_DECLARE_POD_TYPE();
+
+    /// @brief The index the rule was added with, opaque to the rule map (e.g. the index in the stylesheet).
+    nsUInt32 m_uiRuleIndex;
+    nsUInt32 m_uiSpecificity;
+    nsUInt32 m_uiSourceOrder;
+  };
+
+  /*
+   * @brief Buckets selectors by the most selective atom of their subject compound (id, class, tag, or universal).
+   *
+   * Collecting the rules for a element only looks at the buckets of its id, its classes and its tag, plus the universal
+   * bucket, instead of every rule of every stylesheet. Each candidate is then checked against the ancestor bloom filter
+   * before the full right-to-left match runs.
+   *
+   * @note The rule map references the selectors it was given, their owner (the stylesheet) has to keep them alive and in place.
+   * @note Lookups are read-only and can run from multiple threads, as long as every thread uses its own CSSAncestorFilter.
+   */
+  class NS_APERTURE_DLL CSSRuleMap
+  {
+  public:
+    CSSRuleMap();
+    ~CSSRuleMap();
+
+    /// @brief Adds a selector. Rules that apply to a pseudo-element are only returned when asking for that pseudo-element.
+    /// @param in_uiRuleIndex Returned in CSSMatchedRule::m_uiRuleIndex.
+    /// @param in_uiSourceOrder Used to order rules of equal specificity, later rules win.
+    void AddSelector(const CSSSelector* in_pSelector, nsUInt32 in_uiRuleIndex, nsUInt32 in_uiSourceOrder);
+
+    /// @brief Appends the rules that match the element, sorted by ascending cascade order (specificity, then source order).
+    /// @param in_pAncestorFilter Filter containing the ancestors of the element, or null to always run the full match.
+    void CollectMatchingRules(const dom::DOMElement& in_element, const CSSAncestorFilter* in_pAncestorFilter, nsDynamicArray<CSSMatchedRule>& out_rules,
+      CSSPseudoElement in_pseudoElement = CSSPseudoElement::None) const;
+
+    void Clear();
+    nsUInt32 GetRuleCount() const { return m_uiRuleCount; }
+
+  private:
+    struct Entry
+    {
+      NS_DECLARE_POD_TYPE();
+
+      const CSSSelector* m_pSelector;
+      nsUInt32 m_uiRuleIndex;
+      nsUInt32 m_uiSourceOrder;
+      nsUInt32 m_uiSpecificity;
+      /// @brief Copied from the selector, so the fast reject doesn't touch the selector memory.
+      nsUInt32 m_AncestorHashes[CSSSelector::MaxAncestorHashes];
+      CSSPseudoElement m_PseudoElement;
+    };
+
+    void CollectFromBucket(const nsDynamicArray<Entry>& in_bucket, const dom::DOMElement& in_element, const CSSAncestorFilter* in_pAncestorFilter,
+      CSSPseudoElement in_pseudoElement, nsDynamicArray<CSSMatchedRule>& out_rules) const;
+
+  private:
+    nsHashTable<core::Atom, nsDynamicArray<Entry>> m_IdRules;
+    nsHashTable<core::Atom, nsDynamicArray<Entry>> m_ClassRules;
+    nsHashTable<core::Atom, nsDynamicArray<Entry>> m_TagRules;
+    nsDynamicArray<Entry> m_UniversalRules;
+    nsUInt32 m_uiRuleCount = 0;
+  };
+} // namespace aperture::css
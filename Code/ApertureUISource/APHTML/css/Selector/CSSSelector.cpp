@@ -0,0 +1,349 @@
+#include <APHTML/css/Selector/CSSAncestorFilter.h>
+#include <APHTML/css/Selector/CSSSelector.h>
+#include <APHTML/dom/DOMElement.h>
+
+using namespace aperture;
+using namespace aperture::css;
+
+namespace
+{
+  NS_ALWAYS_INLINE bool IsElement(const std::shared_ptr<dom::DOMNode>& in_node)
+  {
+    return in_node != nullptr && in_node->getNodeType() == dom::DOMNodeType::ELEMENT_NODE;
+  }
+
+  NS_ALWAYS_INLINE const dom::DOMElement& AsElement(const std::shared_ptr<dom::DOMNode>& in_node)
+  {
+    // Element nodes are always DOMElements, see DOMElement::DOMElement().
+    return static_cast<const dom::DOMElement&>(*in_node);
+  }
+
+  /// Returns the index of the element in the child list of its parent, or -1 if it has no parent element.
+  nsInt32 FindIndexInParent(const dom::DOMElement& in_element, const std::vector<std::shared_ptr<dom::DOMNode>>*& out_pSiblings)
+  {
+    const dom::DOMElement* pParent = in_element.getParentElementPtr();
+    if (pParent == nullptr)
+    {
+      out_pSiblings = nullptr;
+      return -1;
+    }
+
+    out_pSiblings = &pParent->getChildNodes();
+    const dom::DOMNode* pNode = &in_element;
+    for (nsUInt32 i = 0; i < out_pSiblings->size(); ++i)
+    {
+      if ((*out_pSiblings)[i].get() == pNode)
+        return static_cast<nsInt32>(i);
+    }
+    return -1;
+  }
+
+  bool MatchesNth(nsInt32 in_iA, nsInt32 in_iB, nsInt32 in_iPosition)
+  {
+    if (in_iA == 0)
+      return in_iPosition == in_iB;
+
+    const nsInt32 iDiff = in_iPosition - in_iB;
+    return (iDiff / in_iA) >= 0 && (iDiff % in_iA) == 0;
+  }
+
+  bool EqualsIgnoreCase(std::string_view in_a, std::string_view in_b)
+  {
+    if (in_a.size() != in_b.size())
+      return false;
+    for (size_t i = 0; i < in_a.size(); ++i)
+    {
+      if (nsStringUtils::ToLowerChar(in_a[i]) != nsStringUtils::ToLowerChar(in_b[i]))
+        return false;
+    }
+    return true;
+  }
+
+  bool MatchesAttributeValue(const CSSSimpleSelector& in_simple, std::string_view in_value)
+  {
+    const std::string_view expected = in_simple.m_sValue;
+    auto equals = [&](std::string_view a, std::string_view b) { return in_simple.m_bCaseInsensitive ? EqualsIgnoreCase(a, b) : a == b; };
+
+    switch (in_simple.m_AttributeOp)
+    {
+      case CSSAttributeOperator::Exists:
+        return true;
+      case CSSAttributeOperator::Equals:
+        return equals(in_value, expected);
+      case CSSAttributeOperator::Includes:
+      {
+        if (expected.empty() || expected.find_first_of(" \t\n\r\f") != std::string_view::npos)
+          return false;
+        size_t uiStart = 0;
+        while (uiStart < in_value.size())
+        {
+          const size_t uiEnd = std::min(in_value.find_first_of(" \t\n\r\f", uiStart), in_value.size());
+          if (uiEnd > uiStart && equals(in_value.substr(uiStart, uiEnd - uiStart), expected))
+            return true;
+          uiStart = uiEnd + 1;
+        }
+        return false;
+      }
+      case CSSAttributeOperator::DashMatch:
+        return equals(in_value, expected) ||
+               (in_value.size() > expected.size() && in_value[expected.size()] == '-' && equals(in_value.substr(0, expected.size()), expected));
+      case CSSAttributeOperator::Prefix:
+        return !expected.empty() && in_value.size() >= expected.size() && equals(in_value.substr(0, expected.size()), expected);
+      case CSSAttributeOperator::Suffix:
+        return !expected.empty() && in_value.size() >= expected.size() && equals(in_value.substr(in_value.size() - expected.size()), expected);
+      case CSSAttributeOperator::Substring:
+      {
+        if (expected.empty() || in_value.size() < expected.size())
+          return false;
+        for (size_t i = 0; i + expected.size() <= in_value.size(); ++i)
+        {
+          if (equals(in_value.substr(i, expected.size()), expected))
+            return true;
+        }
+        return false;
+      }
+    }
+    return false;
+  }
+} // namespace
+
+bool CSSSelector::Matches(const dom::DOMElement& in_element) const
+{
+  if (m_Compounds.IsEmpty())
+    return false;
+  return MatchesFrom(0, in_element);
+}
+
+bool CSSSelector::MatchesFrom(nsUInt32 in_uiCompound, const dom::DOMElement& in_element) const
+{
+  const CSSCompoundSelector& compound = m_Compounds[in_uiCompound];
+  if (!MatchesCompound(compound, in_element))
+    return false;
+
+  const nsUInt32 uiNext = in_uiCompound + 1;
+  if (uiNext >= m_Compounds.GetCount())
+    return true;
+
+  switch (compound.m_Combinator)
+  {
+    case CSSCombinator::Child:
+    {
+      const dom::DOMElement* pParent = in_element.getParentElementPtr();
+      return pParent != nullptr && MatchesFrom(uiNext, *pParent);
+    }
+    case CSSCombinator::Descendant:
+    {
+      for (const dom::DOMElement* pAncestor = in_element.getParentElementPtr(); pAncestor != nullptr; pAncestor = pAncestor->getParentElementPtr())
+      {
+        if (MatchesFrom(uiNext, *pAncestor))
+          return true;
+      }
+      return false;
+    }
+    case CSSCombinator::NextSibling:
+    case CSSCombinator::SubsequentSibling:
+    {
+      const std::vector<std::shared_ptr<dom::DOMNode>>* pSiblings = nullptr;
+      const nsInt32 iIndex = FindIndexInParent(in_element, pSiblings);
+      for (nsInt32 i = iIndex - 1; i >= 0; --i)
+      {
+        if (!IsElement((*pSiblings)[i]))
+          continue;
+        if (MatchesFrom(uiNext, AsElement((*pSiblings)[i])))
+          return true;
+        if (compound.m_Combinator == CSSCombinator::NextSibling)
+          return false;
+      }
+      return false;
+    }
+    case CSSCombinator::None:
+      break;
+  }
+  return false;
+}
+
+bool CSSSelector::MatchesCompound(const CSSCompoundSelector& in_compound, const dom::DOMElement& in_element) const
+{
+  for (nsUInt32 i = in_compound.m_uiFirst; i < nsUInt32(in_compound.m_uiFirst + in_compound.m_uiCount); ++i)
+  {
+    const CSSSimpleSelector& simple = m_Simple[i];
+    if (MatchesSimple(simple, in_element) == simple.m_bNegated)
+      return false;
+  }
+  return true;
+}
+
+bool CSSSelector::MatchesSimple(const CSSSimpleSelector& in_simple, const dom::DOMElement& in_element) const
+{
+  switch (in_simple.m_Type)
+  {
+    case CSSSimpleSelectorType::Universal:
+      return true;
+    case CSSSimpleSelectorType::Tag:
+      return in_element.getTagAtom() == in_simple.m_Atom;
+    case CSSSimpleSelectorType::Id:
+      return in_element.getIdAtom() == in_simple.m_Atom;
+    case CSSSimpleSelectorType::Class:
+      return in_element.hasClass(in_simple.m_Atom);
+    case CSSSimpleSelectorType::Attribute:
+    {
+      const auto& attributes = in_element.getAttributes();
+      auto it = attributes.find(in_simple.m_sName);
+      return it != attributes.end() && MatchesAttributeValue(in_simple, it->second);
+    }
+    case CSSSimpleSelectorType::State:
+      return (in_element.getStateFlags() & in_simple.m_uiStateMask) == in_simple.m_uiStateMask;
+    case CSSSimpleSelectorType::Root:
+      return in_element.getParentElementPtr() == nullptr;
+    case CSSSimpleSelectorType::Empty:
+    {
+      for (const std::shared_ptr<dom::DOMNode>& child : in_element.getChildNodes())
+      {
+        if (child == nullptr)
+          continue;
+        if (child->getNodeType() == dom::DOMNodeType::ELEMENT_NODE)
+          return false;
+        if ((child->getNodeType() == dom::DOMNodeType::TEXT_NODE || child->getNodeType() == dom::DOMNodeType::CDATA_SECTION_NODE) && !child->getNodeValue().empty())
+          return false;
+      }
+      return true;
+    }
+    case CSSSimpleSelectorType::NthChild:
+    case CSSSimpleSelectorType::NthLastChild:
+    case CSSSimpleSelectorType::NthOfType:
+    case CSSSimpleSelectorType::NthLastOfType:
+    case CSSSimpleSelectorType::OnlyChild:
+    case CSSSimpleSelectorType::OnlyOfType:
+    {
+      const std::vector<std::shared_ptr<dom::DOMNode>>* pSiblings = nullptr;
+      const nsInt32 iIndex = FindIndexInParent(in_element, pSiblings);
+      if (iIndex < 0)
+      {
+        // Elements without a parent element are the first and only of their kind.
+        return in_simple.m_Type == CSSSimpleSelectorType::OnlyChild || in_simple.m_Type == CSSSimpleSelectorType::OnlyOfType || MatchesNth(in_simple.m_iNthA, in_simple.m_iNthB, 1);
+      }
+
+      const bool bOfType = in_simple.m_Type == CSSSimpleSelectorType::NthOfType || in_simple.m_Type == CSSSimpleSelectorType::NthLastOfType ||
+                           in_simple.m_Type == CSSSimpleSelectorType::OnlyOfType;
+      const core::Atom tag = in_element.getTagAtom();
+
+      nsInt32 iBefore = 0;
+      nsInt32 iAfter = 0;
+      for (nsInt32 i = 0; i < static_cast<nsInt32>(pSiblings->size()); ++i)
+      {
+        const std::shared_ptr<dom::DOMNode>& sibling = (*pSiblings)[i];
+        if (i == iIndex || !IsElement(sibling) || (bOfType && AsElement(sibling).getTagAtom() != tag))
+          continue;
+        (i < iIndex ? iBefore : iAfter) += 1;
+      }
+
+      switch (in_simple.m_Type)
+      {
+        case CSSSimpleSelectorType::NthChild:
+        case CSSSimpleSelectorType::NthOfType:
+          return MatchesNth(in_simple.m_iNthA, in_simple.m_iNthB, iBefore + 1);
+        case CSSSimpleSelectorType::NthLastChild:
+        case CSSSimpleSelectorType::NthLastOfType:
+          return MatchesNth(in_simple.m_iNthA, in_simple.m_iNthB, iAfter + 1);
+        default:
+          return iBefore == 0 && iAfter == 0;
+      }
+    }
+  }
+  return false;
+}
+
+void CSSSelector::Finalize()
+{
+  nsUInt32 uiIds = 0;
+  nsUInt32 uiClasses = 0;
+  nsUInt32 uiTags = m_PseudoElement != CSSPseudoElement::None ? 1 : 0;
+  m_bDependsOnSiblings = false;
+  for (const CSSCompoundSelector& compound : m_Compounds)
+  {
+    m_bDependsOnSiblings |= compound.m_Combinator == CSSCombinator::NextSibling || compound.m_Combinator == CSSCombinator::SubsequentSibling;
+  }
+
+  for (const CSSSimpleSelector& simple : m_Simple)
+  {
+    m_bDependsOnSiblings |= simple.m_Type >= CSSSimpleSelectorType::Empty;
+    // :not() has the specificity of its argument.
+    switch (simple.m_Type)
+    {
+      case CSSSimpleSelectorType::Universal:
+        break;
+      case CSSSimpleSelectorType::Id:
+        ++uiIds;
+        break;
+      case CSSSimpleSelectorType::Tag:
+        ++uiTags;
+        break;
+      default:
+        ++uiClasses;
+        break;
+    }
+  }
+  m_uiSpecificity = MakeSpecificity(uiIds, uiClasses, uiTags);
+
+  // The rule map key is the most selective atom of the subject, only plain (not negated) selectors qualify.
+  m_KeyType = CSSSelectorKeyType::Universal;
+  m_KeyAtom = core::InvalidAtom;
+  if (!m_Compounds.IsEmpty())
+  {
+    const CSSCompoundSelector& subject = m_Compounds[0];
+    for (nsUInt32 i = subject.m_uiFirst; i < nsUInt32(subject.m_uiFirst + subject.m_uiCount); ++i)
+    {
+      const CSSSimpleSelector& simple = m_Simple[i];
+      if (simple.m_bNegated)
+        continue;
+
+      if (simple.m_Type == CSSSimpleSelectorType::Id)
+      {
+        m_KeyType = CSSSelectorKeyType::Id;
+        m_KeyAtom = simple.m_Atom;
+        break;
+      }
+      if (simple.m_Type == CSSSimpleSelectorType::Class && m_KeyType != CSSSelectorKeyType::Class)
+      {
+        m_KeyType = CSSSelectorKeyType::Class;
+        m_KeyAtom = simple.m_Atom;
+      }
+      else if (simple.m_Type == CSSSimpleSelectorType::Tag && m_KeyType == CSSSelectorKeyType::Universal)
+      {
+        m_KeyType = CSSSelectorKeyType::Tag;
+        m_KeyAtom = simple.m_Atom;
+      }
+    }
+  }
+
+  // Every compound reached through a child or descendant combinator is a ancestor of the subject: siblings share
+  // their parent, so even "a > b + c" requires "a" to be a ancestor of "c".
+  nsUInt32 uiHashCount = 0;
+  nsMemoryUtils::ZeroFill(m_AncestorHashes, MaxAncestorHashes);
+  for (nsUInt32 c = 1; c < m_Compounds.GetCount() && uiHashCount < MaxAncestorHashes; ++c)
+  {
+    const CSSCombinator combinator = m_Compounds[c - 1].m_Combinator;
+    if (combinator != CSSCombinator::Child && combinator != CSSCombinator::Descendant)
+      continue;
+
+    const CSSCompoundSelector& compound = m_Compounds[c];
+    for (nsUInt32 i = compound.m_uiFirst; i < nsUInt32(compound.m_uiFirst + compound.m_uiCount) && uiHashCount < MaxAncestorHashes; ++i)
+    {
+      const CSSSimpleSelector& simple = m_Simple[i];
+      if (simple.m_bNegated)
+        continue;
+
+      nsUInt32 uiHash = 0;
+      if (simple.m_Type == CSSSimpleSelectorType::Id)
+        uiHash = CSSAncestorFilter::GetIdHash(simple.m_Atom);
+      else if (simple.m_Type == CSSSimpleSelectorType::Class)
+        uiHash = CSSAncestorFilter::GetClassHash(simple.m_Atom);
+      else if (simple.m_Type == CSSSimpleSelectorType::Tag)
+        uiHash = CSSAncestorFilter::GetTagHash(simple.m_Atom);
+
+      // A hash of 0 terminates the list, the odds of a real hash being 0 are negligible and it only costs the fast reject.
+      if (uiHash != 0)
+        m_AncestorHashes[uiHashCount++] = uiHash;
+    }
+  }
+}
@@ -0,0 +1,203 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/core/Atom.h>
+#include <Foundation/Containers/HybridArray.h>
+#include <string>
+
+namespace aperture::dom
+{
+  class DOMElement;
+} // namespace aperture::dom
+
+namespace aperture::css
+{
+  /// @brief How a compound relates to the compound on its left.
+  enum class CSSCombinator : nsUInt8
+  {
+    None,             ///< Leftmost compound.
+    Descendant,       ///< "a b"
+    Child,            ///< "a > b"
+    NextSibling,      ///< "a + b"
+    SubsequentSibling ///< "a ~ b"
+  };
+
+  enum class CSSSimpleSelectorType : nsUInt8
+  {
+    Universal,
+    Tag,
+    Id,
+    Class,
+    Attribute,
+    /// @brief Matches if all bits of m_uiStateMask are set in the ElementState flags of the element.
+    State,
+    Root,
+    // NOTE: Every type from here on depends on the siblings or children of the element, see CSSSelector::DependsOnSiblings().
+    Empty,
+    /// @brief :nth-child() and the :first-child/:last-child/:only-child shorthands, see m_iNthA/m_iNthB.
+    NthChild,
+    NthLastChild,
+    NthOfType,
+    NthLastOfType,
+    OnlyChild,
+    OnlyOfType,
+  };
+
+  enum class CSSAttributeOperator : nsUInt8
+  {
+    Exists,    ///< [a]
+    Equals,    ///< [a=v]
+    Includes,  ///< [a~=v]
+    DashMatch, ///< [a|=v]
+    Prefix,    ///< [a^=v]
+    Suffix,    ///< [a$=v]
+    Substring  ///< [a*=v]
+  };
+
+  enum class CSSPseudoElement : nsUInt8
+  {
+    None,
+    Before,
+    After,
+    FirstLine,
+    FirstLetter,
+    Selection,
+    Placeholder,
+    Marker
+  };
+
+  struct CSSSimpleSelector
+  {
+    CSSSimpleSelectorType m_Type = CSSSimpleSelectorType::Universal;
+    CSSAttributeOperator m_AttributeOp = CSSAttributeOperator::Exists;
+    /// @brief Set for the argument of :not().
+    bool m_bNegated = false;
+    /// @brief [a=v i]
+    bool m_bCaseInsensitive = false;
+    /// @brief Tag, id, class or attribute name.
+    core::Atom m_Atom = core::InvalidAtom;
+    nsUInt32 m_uiStateMask = 0;
+    /// @brief An+B of the structural pseudo-classes.
+    nsInt32 m_iNthA = 0;
+    nsInt32 m_iNthB = 0;
+    /// @brief The attribute name as string, so matching doesn't have to look up the atom table.
+    std::string m_sName;
+    std::string m_sValue;
+  };
+
+  /// @brief A run of simple selectors without combinators, stored as a range in CSSSelector::m_Simple.
+  struct CSSCompoundSelector
+  {
+    nsUInt16 m_uiFirst = 0;
+    nsUInt16 m_uiCount = 0;
+    CSSCombinator m_Combinator = CSSCombinator::None;
+  };
+
+  /// @brief Which bucket of a CSSRuleMap a selector is stored in.
+  enum class CSSSelectorKeyType : nsUInt8
+  {
+    Id,
+    Class,
+    Tag,
+    Universal
+  };
+
+  /*
+   * @brief A compiled complex selector (e.g. "nav.menu > li:hover a").
+   *
+   * Compounds are stored right to left: m_Compounds[0] is the subject, each compound stores the combinator that links
+   * it to the next one (to its left). Matching starts at the subject and walks up the tree, so most candidates are
+   * rejected by the first compound without touching any other element.
+   *
+   * The parser also precomputes:
+   *  - the specificity, packed as (a << 20 | b << 10 | c) so it can be compared as a integer,
+   *  - the rule map key, the most selective atom of the subject compound (id > class > tag),
+   *  - up to MaxAncestorHashes CSSAncestorFilter hashes of atoms that ancestor compounds require.
+   *
+   * @note Pseudo-elements can only appear at the end, they are not part of matching but returned by GetPseudoElement().
+   */
+  class NS_APERTURE_DLL CSSSelector
+  {
+    friend class CSSSelectorParser;
+    friend class CSSStyleSheet;
+
+  public:
+    static constexpr nsUInt32 MaxAncestorHashes = 4;
+
+    /// @brief Full right-to-left match against the element.
+    bool Matches(const dom::DOMElement& in_element) const;
+
+    nsUInt32 GetSpecificity() const { return m_uiSpecificity; }
+    CSSPseudoElement GetPseudoElement() const { return m_PseudoElement; }
+
+    CSSSelectorKeyType GetKeyType() const { return m_KeyType; }
+    core::Atom GetKeyAtom() const { return m_KeyAtom; }
+
+    /// @brief Hashes of atoms that must be present on some ancestor, zero terminated if less than MaxAncestorHashes are used.
+    const nsUInt32* GetAncestorHashes() const { return m_AncestorHashes; }
+
+    /// @brief True if matching depends on the siblings or children of a element (sibling combinators, :nth-child(), :empty, ...).
+    bool DependsOnSiblings() const { return m_bDependsOnSiblings; }
+
+    nsUInt32 GetCompoundCount() const { return m_Compounds.GetCount(); }
+    const CSSCompoundSelector& GetCompound(nsUInt32 in_uiIndex) const { return m_Compounds[in_uiIndex]; }
+    const CSSSimpleSelector& GetSimpleSelector(nsUInt32 in_uiIndex) const { return m_Simple[in_uiIndex]; }
+
+    /// @brief Specificity helpers.
+    static constexpr nsUInt32 MakeSpecificity(nsUInt32 in_uiIds, nsUInt32 in_uiClasses, nsUInt32 in_uiTags)
+    {
+      return (nsMath::Min(in_uiIds, 1023u) << 20) | (nsMath::Min(in_uiClasses, 1023u) << 10) | nsMath::Min(in_uiTags, 1023u);
+    }
+
+  private:
+    bool MatchesFrom(nsUInt32 in_uiCompound, const dom::DOMElement& in_element) const;
+    bool MatchesCompound(const CSSCompoundSelector& in_compound, const dom::DOMElement& in_element) const;
+    bool MatchesSimple(const CSSSimpleSelector& in_simple, const dom::DOMElement& in_element) const;
+
+    /// @brief Fills the specificity, key and ancestor hashes, called by the parser once the selector is complete.
+    void Finalize();
+
+  private:
+    nsHybridArray<CSSSimpleSelector, 4> m_Simple;
+    nsHybridArray<CSSCompoundSelector, 2> m_Compounds;
+    nsUInt32 m_uiSpecificity = 0;
+    nsUInt32 m_AncestorHashes[MaxAncestorHashes] = {};
+    core::Atom m_KeyAtom = core::InvalidAtom;
+    CSSSelectorKeyType m_KeyType = CSSSelectorKeyType::Universal;
+    CSSPseudoElement m_PseudoElement = CSSPseudoElement::None;
+    bool m_bDependsOnSiblings = false;
+  };
+} // namespace aperture::css
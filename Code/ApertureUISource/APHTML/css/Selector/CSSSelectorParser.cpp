@@ -0,0 +1,565 @@
+#include <APHTML/css/Selector/CSSSelectorParser.h>
+#include <APHTML/dom/DOMElement.h>
+
+using namespace aperture;
+using namespace aperture::css;
+using namespace aperture::css::parser;
+
+namespace
+{
+  struct PseudoClassEntry
+  {
+    const char* m_szName;
+    CSSSimpleSelectorType m_Type;
+    nsUInt32 m_uiStateMask;
+    bool m_bNegated;
+    nsInt32 m_iNthA;
+    nsInt32 m_iNthB;
+  };
+
+  // clang-format off
+  constexpr PseudoClassEntry s_PseudoClasses[] = {
+    {"hover",             CSSSimpleSelectorType::State,        dom::ElementState::Hover,            false, 0, 0},
+    {"active",            CSSSimpleSelectorType::State,        dom::ElementState::Active,           false, 0, 0},
+    {"focus",             CSSSimpleSelectorType::State,        dom::ElementState::Focus,            false, 0, 0},
+    {"checked",           CSSSimpleSelectorType::State,        dom::ElementState::Checked,          false, 0, 0},
+    {"disabled",          CSSSimpleSelectorType::State,        dom::ElementState::Disabled,         false, 0, 0},
+    {"enabled",           CSSSimpleSelectorType::State,        dom::ElementState::Disabled,         true,  0, 0},
+    {"visited",           CSSSimpleSelectorType::State,        dom::ElementState::Visited,          false, 0, 0},
+    {"link",              CSSSimpleSelectorType::State,        dom::ElementState::Link,             false, 0, 0},
+    {"any-link",          CSSSimpleSelectorType::State,        dom::ElementState::Link,             false, 0, 0},
+    {"target",            CSSSimpleSelectorType::State,        dom::ElementState::Target,           false, 0, 0},
+    {"default",           CSSSimpleSelectorType::State,        dom::ElementState::Default,          false, 0, 0},
+    {"indeterminate",     CSSSimpleSelectorType::State,        dom::ElementState::Indeterminate,    false, 0, 0},
+    {"invalid",           CSSSimpleSelectorType::State,        dom::ElementState::Invalid,          false, 0, 0},
+    {"valid",             CSSSimpleSelectorType::State,        dom::ElementState::Invalid,          true,  0, 0},
+    {"read-only",         CSSSimpleSelectorType::State,        dom::ElementState::ReadOnly,         false, 0, 0},
+    {"read-write",        CSSSimpleSelectorType::State,        dom::ElementState::ReadOnly,         true,  0, 0},
+    {"required",          CSSSimpleSelectorType::State,        dom::ElementState::Required,         false, 0, 0},
+    {"optional",          CSSSimpleSelectorType::State,        dom::ElementState::Required,         true,  0, 0},
+    {"in-range",          CSSSimpleSelectorType::State,        dom::ElementState::InRange,          false, 0, 0},
+    {"out-of-range",      CSSSimpleSelectorType::State,        dom::ElementState::OutOfRange,       false, 0, 0},
+    {"placeholder-shown", CSSSimpleSelectorType::State,        dom::ElementState::PlaceholderShown, false, 0, 0},
+    {"root",              CSSSimpleSelectorType::Root,         0,                                   false, 0, 0},
+    {"empty",             CSSSimpleSelectorType::Empty,        0,                                   false, 0, 0},
+    {"first-child",       CSSSimpleSelectorType::NthChild,     0,                                   false, 0, 1},
+    {"last-child",        CSSSimpleSelectorType::NthLastChild, 0,                                   false, 0, 1},
+    {"only-child",        CSSSimpleSelectorType::OnlyChild,    0,                                   false, 0, 0},
+    {"first-of-type",     CSSSimpleSelectorType::NthOfType,    0,                                   false, 0, 1},
+    {"last-of-type",      CSSSimpleSelectorType::NthLastOfType,0,                                   false, 0, 1},
+    {"only-of-type",      CSSSimpleSelectorType::OnlyOfType,   0,                                   false, 0, 0},
+  };
+
+  struct PseudoElementEntry
+  {
+    const char* m_szName;
+    CSSPseudoElement m_Element;
+    /// CSS 2 pseudo-elements may also be written with a single colon.
+    bool m_bLegacySyntax;
+  };
+
+  constexpr PseudoElementEntry s_PseudoElements[] = {
+    {"before",       CSSPseudoElement::Before,      true},
+    {"after",        CSSPseudoElement::After,       true},
+    {"first-line",   CSSPseudoElement::FirstLine,   true},
+    {"first-letter", CSSPseudoElement::FirstLetter, true},
+    {"selection",    CSSPseudoElement::Selection,   false},
+    {"placeholder",  CSSPseudoElement::Placeholder, false},
+    {"marker",       CSSPseudoElement::Marker,      false},
+  };
+  // clang-format on
+
+  bool IsEqualNoCase(std::string_view in_a, const char* in_szB)
+  {
+    const size_t uiLength = nsStringUtils::GetStringElementCount(in_szB);
+    if (in_a.size() != uiLength)
+      return false;
+    for (size_t i = 0; i < uiLength; ++i)
+    {
+      if (nsStringUtils::ToLowerChar(static_cast<unsigned char>(in_a[i])) != static_cast<unsigned char>(in_szB[i]))
+        return false;
+    }
+    return true;
+  }
+
+  bool ParseInteger(std::string_view in_text, nsInt32& out_iValue)
+  {
+    if (in_text.empty())
+      return false;
+
+    size_t i = 0;
+    bool bNegative = false;
+    if (in_text[0] == '+' || in_text[0] == '-')
+    {
+      bNegative = in_text[0] == '-';
+      ++i;
+    }
+    if (i >= in_text.size())
+      return false;
+
+    nsInt64 iValue = 0;
+    for (; i < in_text.size(); ++i)
+    {
+      if (in_text[i] < '0' || in_text[i] > '9')
+        return false;
+      iValue = nsMath::Min<nsInt64>(iValue * 10 + (in_text[i] - '0'), nsMath::MaxValue<nsInt32>());
+    }
+    out_iValue = static_cast<nsInt32>(bNegative ? -iValue : iValue);
+    return true;
+  }
+} // namespace
+
+CSSSelectorParser::CSSSelectorParser(std::string_view in_source)
+  : m_Source(in_source)
+{
+  CSSTokenizer::TokenizeAll(in_source, m_Tokens);
+  m_EndOfFile.m_Type = CSSTokenType::EndOfFile;
+  m_EndOfFile.m_uiOffset = static_cast<nsUInt32>(in_source.size());
+}
+
+nsResult CSSSelectorParser::ParseSelectorList(std::string_view in_source, nsDynamicArray<CSSSelector>& out_selectors)
+{
+  CSSSelectorParser parser(in_source);
+  const nsUInt32 uiInitialCount = out_selectors.GetCount();
+
+  while (true)
+  {
+    if (!parser.ParseComplex(out_selectors.ExpandAndGetRef()))
+    {
+      out_selectors.SetCount(uiInitialCount);
+      return NS_FAILURE;
+    }
+
+    const CSSToken& token = parser.Consume();
+    if (token.m_Type == CSSTokenType::EndOfFile)
+      return NS_SUCCESS;
+
+    // ParseComplex() only stops at commas and the end of the input.
+    NS_ASSERT_DEBUG(token.m_Type == CSSTokenType::Comma, "CSSSelectorParser: Unexpected token after selector.");
+  }
+}
+
+nsResult CSSSelectorParser::ParseSelector(std::string_view in_source, CSSSelector& out_selector)
+{
+  CSSSelectorParser parser(in_source);
+  if (!parser.ParseComplex(out_selector) || parser.Peek().m_Type != CSSTokenType::EndOfFile)
+    return NS_FAILURE;
+  return NS_SUCCESS;
+}
+
+nsResult CSSSelectorParser::ParseNth(std::string_view in_argument, nsInt32& out_iA, nsInt32& out_iB)
+{
+  // An+B is awkward to parse from tokens ("2n+1" is a dimension, "n-1" a ident), so it is parsed from the raw text.
+  nsStringBuilder text;
+  for (char c : in_argument)
+  {
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '\f')
+      text.Append(static_cast<char>(nsStringUtils::ToLowerChar(c)));
+  }
+  const std::string_view compact(text.GetData(), text.GetElementCount());
+
+  if (compact == "odd")
+  {
+    out_iA = 2;
+    out_iB = 1;
+    return NS_SUCCESS;
+  }
+  if (compact == "even")
+  {
+    out_iA = 2;
+    out_iB = 0;
+    return NS_SUCCESS;
+  }
+
+  const size_t uiN = compact.find('n');
+  if (uiN == std::string_view::npos)
+  {
+    out_iA = 0;
+    return ParseInteger(compact, out_iB) ? NS_SUCCESS : NS_FAILURE;
+  }
+
+  const std::string_view a = compact.substr(0, uiN);
+  if (a.empty() || a == "+")
+    out_iA = 1;
+  else if (a == "-")
+    out_iA = -1;
+  else if (!ParseInteger(a, out_iA))
+    return NS_FAILURE;
+
+  const std::string_view b = compact.substr(uiN + 1);
+  if (b.empty())
+  {
+    out_iB = 0;
+    return NS_SUCCESS;
+  }
+  // The sign of B is mandatory ("2n1" is invalid).
+  if (b[0] != '+' && b[0] != '-')
+    return NS_FAILURE;
+  return ParseInteger(b, out_iB) ? NS_SUCCESS : NS_FAILURE;
+}
+
+bool CSSSelectorParser::ParseComplex(CSSSelector& out_selector)
+{
+  struct ParsedCompound
+  {
+    nsHybridArray<CSSSimpleSelector, 4> m_Simple;
+    /// Combinator between this compound and the one on its right.
+    CSSCombinator m_Combinator = CSSCombinator::None;
+  };
+
+  out_selector = CSSSelector();
+  nsHybridArray<ParsedCompound, 4> compounds;
+
+  SkipWhitespace();
+  while (true)
+  {
+    // Pseudo-elements have to be the last part of the selector.
+    if (out_selector.m_PseudoElement != CSSPseudoElement::None)
+      return false;
+
+    ParsedCompound& compound = compounds.ExpandAndGetRef();
+    if (!ParseCompound(compound.m_Simple, out_selector.m_PseudoElement))
+      return false;
+
+    const bool bHadWhitespace = SkipWhitespace();
+    const CSSToken& token = Peek();
+    if (token.m_Type == CSSTokenType::EndOfFile || token.m_Type == CSSTokenType::Comma)
+      break;
+
+    if (token.m_Type == CSSTokenType::Delim && (token.m_Delim == '>' || token.m_Delim == '+' || token.m_Delim == '~'))
+    {
+      compound.m_Combinator = token.m_Delim == '>' ? CSSCombinator::Child : (token.m_Delim == '+' ? CSSCombinator::NextSibling : CSSCombinator::SubsequentSibling);
+      Consume();
+      SkipWhitespace();
+    }
+    else if (bHadWhitespace)
+    {
+      compound.m_Combinator = CSSCombinator::Descendant;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  // Store right to left, each compound keeps the combinator to the compound on its left.
+  for (nsUInt32 i = compounds.GetCount(); i-- > 0;)
+  {
+    CSSCompoundSelector& compiled = out_selector.m_Compounds.ExpandAndGetRef();
+    compiled.m_uiFirst = static_cast<nsUInt16>(out_selector.m_Simple.GetCount());
+    compiled.m_uiCount = static_cast<nsUInt16>(compounds[i].m_Simple.GetCount());
+    compiled.m_Combinator = i > 0 ? compounds[i - 1].m_Combinator : CSSCombinator::None;
+    out_selector.m_Simple.PushBackRange(compounds[i].m_Simple);
+  }
+
+  out_selector.Finalize();
+  return true;
+}
+
+bool CSSSelectorParser::ParseCompound(nsHybridArray<CSSSimpleSelector, 4>& out_simple, CSSPseudoElement& out_pseudoElement)
+{
+  bool bHasUniversal = false;
+
+  // Type or universal selector first.
+  const CSSToken& first = Peek();
+  if (first.m_Type == CSSTokenType::Ident)
+  {
+    CSSSimpleSelector& simple = out_simple.ExpandAndGetRef();
+    simple.m_Type = CSSSimpleSelectorType::Tag;
+    simple.m_Atom = core::AtomTable::Get().InternLowercase(GetTokenText(Consume()));
+  }
+  else if (first.m_Type == CSSTokenType::Delim && first.m_Delim == '*')
+  {
+    Consume();
+    bHasUniversal = true;
+  }
+
+  while (true)
+  {
+    const CSSToken& token = Peek();
+    if (token.m_Type == CSSTokenType::Hash && token.HasFlag(CSSToken::HashIsId))
+    {
+      CSSSimpleSelector& simple = out_simple.ExpandAndGetRef();
+      simple.m_Type = CSSSimpleSelectorType::Id;
+      simple.m_Atom = core::MakeAtom(GetTokenText(Consume()));
+    }
+    else if (token.m_Type == CSSTokenType::Delim && token.m_Delim == '.')
+    {
+      Consume();
+      if (Peek().m_Type != CSSTokenType::Ident)
+        return false;
+      CSSSimpleSelector& simple = out_simple.ExpandAndGetRef();
+      simple.m_Type = CSSSimpleSelectorType::Class;
+      simple.m_Atom = core::MakeAtom(GetTokenText(Consume()));
+    }
+    else if (token.m_Type == CSSTokenType::OpenSquare)
+    {
+      Consume();
+      if (!ParseAttribute(out_simple.ExpandAndGetRef()))
+        return false;
+    }
+    else if (token.m_Type == CSSTokenType::Colon)
+    {
+      Consume();
+      const bool bDoubleColon = Peek().m_Type == CSSTokenType::Colon;
+      if (bDoubleColon)
+        Consume();
+
+      const CSSToken& name = Consume();
+      if (name.m_Type == CSSTokenType::Ident)
+      {
+        bool bIsPseudoElement = false;
+        for (const PseudoElementEntry& entry : s_PseudoElements)
+        {
+          if ((bDoubleColon || entry.m_bLegacySyntax) && IsEqualNoCase(name.m_Value, entry.m_szName))
+          {
+            out_pseudoElement = entry.m_Element;
+            bIsPseudoElement = true;
+            break;
+          }
+        }
+
+        if (bIsPseudoElement)
+          break;
+        if (bDoubleColon || !ParsePseudoClass(name, out_simple.ExpandAndGetRef()))
+          return false;
+      }
+      else if (name.m_Type == CSSTokenType::Function && !bDoubleColon)
+      {
+        if (!ParsePseudoFunction(name, out_simple.ExpandAndGetRef()))
+          return false;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if (out_simple.IsEmpty())
+  {
+    // "*" on its own, or a lone pseudo-element ("::before" is "*::before").
+    if (!bHasUniversal && out_pseudoElement == CSSPseudoElement::None)
+      return false;
+    out_simple.ExpandAndGetRef().m_Type = CSSSimpleSelectorType::Universal;
+  }
+  return true;
+}
+
+bool CSSSelectorParser::ParseAttribute(CSSSimpleSelector& out_simple)
+{
+  SkipWhitespace();
+  if (Peek().m_Type != CSSTokenType::Ident)
+    return false;
+
+  std::string name = GetTokenText(Consume());
+  for (char& c : name)
+  {
+    c = static_cast<char>(nsStringUtils::ToLowerChar(c));
+  }
+  out_simple.m_Type = CSSSimpleSelectorType::Attribute;
+  out_simple.m_Atom = core::MakeAtom(name);
+  out_simple.m_sName = std::move(name);
+  out_simple.m_AttributeOp = CSSAttributeOperator::Exists;
+
+  SkipWhitespace();
+  const CSSToken& opToken = Consume();
+  if (opToken.m_Type == CSSTokenType::CloseSquare)
+    return true;
+  if (opToken.m_Type != CSSTokenType::Delim)
+    return false;
+
+  switch (opToken.m_Delim)
+  {
+    case '=':
+      out_simple.m_AttributeOp = CSSAttributeOperator::Equals;
+      break;
+    case '~':
+    case '|':
+    case '^':
+    case '$':
+    case '*':
+    {
+      const CSSToken& equals = Consume();
+      if (equals.m_Type != CSSTokenType::Delim || equals.m_Delim != '=')
+        return false;
+
+      constexpr CSSAttributeOperator ops[] = {CSSAttributeOperator::Includes, CSSAttributeOperator::DashMatch, CSSAttributeOperator::Prefix,
+        CSSAttributeOperator::Suffix, CSSAttributeOperator::Substring};
+      out_simple.m_AttributeOp = ops[std::string_view("~|^$*").find(opToken.m_Delim)];
+      break;
+    }
+    default:
+      return false;
+  }
+
+  SkipWhitespace();
+  const CSSToken& value = Consume();
+  if (value.m_Type != CSSTokenType::Ident && value.m_Type != CSSTokenType::String)
+    return false;
+  out_simple.m_sValue = GetTokenText(value);
+
+  SkipWhitespace();
+  if (Peek().m_Type == CSSTokenType::Ident)
+  {
+    const CSSToken& modifier = Consume();
+    if (IsEqualNoCase(modifier.m_Value, "i"))
+      out_simple.m_bCaseInsensitive = true;
+    else if (!IsEqualNoCase(modifier.m_Value, "s"))
+      return false;
+    SkipWhitespace();
+  }
+
+  return Consume().m_Type == CSSTokenType::CloseSquare;
+}
+
+bool CSSSelectorParser::ParsePseudoClass(const CSSToken& in_nameToken, CSSSimpleSelector& out_simple)
+{
+  for (const PseudoClassEntry& entry : s_PseudoClasses)
+  {
+    if (IsEqualNoCase(in_nameToken.m_Value, entry.m_szName))
+    {
+      out_simple.m_Type = entry.m_Type;
+      out_simple.m_uiStateMask = entry.m_uiStateMask;
+      out_simple.m_bNegated = entry.m_bNegated;
+      out_simple.m_iNthA = entry.m_iNthA;
+      out_simple.m_iNthB = entry.m_iNthB;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CSSSelectorParser::ParsePseudoFunction(const CSSToken& in_functionToken, CSSSimpleSelector& out_simple)
+{
+  const std::string_view name = in_functionToken.m_Value;
+
+  constexpr struct
+  {
+    const char* m_szName;
+    CSSSimpleSelectorType m_Type;
+  } nthFunctions[] = {
+    {"nth-child", CSSSimpleSelectorType::NthChild},
+    {"nth-last-child", CSSSimpleSelectorType::NthLastChild},
+    {"nth-of-type", CSSSimpleSelectorType::NthOfType},
+    {"nth-last-of-type", CSSSimpleSelectorType::NthLastOfType},
+  };
+
+  for (const auto& nth : nthFunctions)
+  {
+    if (IsEqualNoCase(name, nth.m_szName))
+    {
+      std::string_view argument;
+      out_simple.m_Type = nth.m_Type;
+      return ConsumeFunctionArgument(argument) && ParseNth(argument, out_simple.m_iNthA, out_simple.m_iNthB).Succeeded();
+    }
+  }
+
+  if (IsEqualNoCase(name, "not"))
+  {
+    // Selectors Level 3: a single simple selector, which can't be :not() itself.
+    SkipWhitespace();
+    nsHybridArray<CSSSimpleSelector, 4> argument;
+    CSSPseudoElement pseudoElement = CSSPseudoElement::None;
+    if (!ParseCompound(argument, pseudoElement) || argument.GetCount() != 1 || pseudoElement != CSSPseudoElement::None)
+      return false;
+    // Nested :not() is invalid. ":not(:enabled)" is fine, :enabled is only stored as a negated state.
+    if (argument[0].m_bNegated && argument[0].m_Type != CSSSimpleSelectorType::State)
+      return false;
+    SkipWhitespace();
+    if (Consume().m_Type != CSSTokenType::CloseParen)
+      return false;
+
+    out_simple = std::move(argument[0]);
+    out_simple.m_bNegated = !out_simple.m_bNegated;
+    return true;
+  }
+
+  if (IsEqualNoCase(name, "lang"))
+  {
+    // Approximated by the lang attribute of the element itself, inheritance from ancestors is not taken into account.
+    SkipWhitespace();
+    const CSSToken& language = Consume();
+    if (language.m_Type != CSSTokenType::Ident && language.m_Type != CSSTokenType::String)
+      return false;
+    SkipWhitespace();
+    if (Consume().m_Type != CSSTokenType::CloseParen)
+      return false;
+
+    out_simple.m_Type = CSSSimpleSelectorType::Attribute;
+    out_simple.m_AttributeOp = CSSAttributeOperator::DashMatch;
+    out_simple.m_bCaseInsensitive = true;
+    out_simple.m_sName = "lang";
+    out_simple.m_Atom = core::MakeAtom("lang");
+    out_simple.m_sValue = GetTokenText(language);
+    return true;
+  }
+
+  return false;
+}
+
+bool CSSSelectorParser::ConsumeFunctionArgument(std::string_view& out_argument)
+{
+  const nsUInt32 uiStart = Peek().m_uiOffset;
+  nsUInt32 uiDepth = 1;
+  while (true)
+  {
+    const CSSToken& token = Consume();
+    switch (token.m_Type)
+    {
+      case CSSTokenType::EndOfFile:
+        return false;
+      case CSSTokenType::Function:
+      case CSSTokenType::OpenParen:
+        ++uiDepth;
+        break;
+      case CSSTokenType::CloseParen:
+        if (--uiDepth == 0)
+        {
+          out_argument = m_Source.substr(uiStart, token.m_uiOffset - uiStart);
+          return true;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+const CSSToken& CSSSelectorParser::Peek() const
+{
+  return m_uiPos < m_Tokens.GetCount() ? m_Tokens[m_uiPos] : m_EndOfFile;
+}
+
+const CSSToken& CSSSelectorParser::Consume()
+{
+  const CSSToken& token = Peek();
+  if (m_uiPos < m_Tokens.GetCount())
+    ++m_uiPos;
+  return token;
+}
+
+bool CSSSelectorParser::SkipWhitespace()
+{
+  bool bSkipped = false;
+  while (Peek().m_Type == CSSTokenType::Whitespace)
+  {
+    Consume();
+    bSkipped = true;
+  }
+  return bSkipped;
+}
+
+std::string CSSSelectorParser::GetTokenText(const CSSToken& in_token)
+{
+  if (!in_token.HasFlag(CSSToken::HasEscapes))
+    return std::string(in_token.m_Value);
+
+  nsStringBuilder unescaped;
+  CSSTokenizer::Unescape(in_token.m_Value, unescaped);
+  return std::string(unescaped.GetData(), unescaped.GetElementCount());
+}
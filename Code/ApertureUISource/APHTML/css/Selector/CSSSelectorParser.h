@@ -0,0 +1,87 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <APHTML/css/Selector/CSSSelector.h>
+
+namespace aperture::css
+{
+  /*
+   * @brief Compiles selector text into CSSSelectors, on top of the CSS tokenizer.
+   *
+   * Supported: type, universal, #id, .class, all attribute operators (including the "i" flag), the four combinators,
+   * the state pseudo-classes (:hover, :focus, :checked, ...), the structural pseudo-classes (:root, :empty, :nth-*(An+B), ...),
+   * :not() with a single simple selector, :lang() and the pseudo-elements.
+   *
+   * @note As per spec, a selector list with one invalid selector is invalid as a whole.
+   * @note Namespaces and :not() with complex selectors (Selectors Level 4) are not supported.
+   */
+  class NS_APERTURE_DLL CSSSelectorParser
+  {
+  public:
+    /// @brief Parses a comma separated selector list and appends the compiled selectors.
+    /// @return NS_FAILURE if the list is invalid, in which case nothing is appended.
+    static nsResult ParseSelectorList(std::string_view in_source, nsDynamicArray<CSSSelector>& out_selectors);
+
+    /// @brief Parses a single complex selector.
+    static nsResult ParseSelector(std::string_view in_source, CSSSelector& out_selector);
+
+    /// @brief Parses the argument of the :nth-*() pseudo-classes ("odd", "even", "3", "-n+2", "2n + 1", ...).
+    static nsResult ParseNth(std::string_view in_argument, nsInt32& out_iA, nsInt32& out_iB);
+
+  private:
+    explicit CSSSelectorParser(std::string_view in_source);
+
+    bool ParseComplex(CSSSelector& out_selector);
+    bool ParseCompound(nsHybridArray<CSSSimpleSelector, 4>& out_simple, CSSPseudoElement& out_pseudoElement);
+    bool ParseAttribute(CSSSimpleSelector& out_simple);
+    bool ParsePseudoClass(const parser::CSSToken& in_nameToken, CSSSimpleSelector& out_simple);
+    bool ParsePseudoFunction(const parser::CSSToken& in_functionToken, CSSSimpleSelector& out_simple);
+    /// @brief Returns the raw source text up to the closing parenthesis of a function and consumes it.
+    bool ConsumeFunctionArgument(std::string_view& out_argument);
+
+    const parser::CSSToken& Peek() const;
+    const parser::CSSToken& Consume();
+    bool SkipWhitespace();
+    static std::string GetTokenText(const parser::CSSToken& in_token);
+
+  private:
+    std::string_view m_Source;
+    nsDynamicArray<parser::CSSToken> m_Tokens;
+    nsUInt32 m_uiPos = 0;
+    parser::CSSToken m_EndOfFile;
+  };
+} // namespace aperture::css
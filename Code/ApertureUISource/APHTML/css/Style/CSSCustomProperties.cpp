@@ -0,0 +1,135 @@
+#include <APHTML/css/Style/CSSCustomProperties.h>
+#include <Foundation/Algorithm/HashingUtils.h>
+
+using namespace aperture;
+using namespace aperture::css;
+
+bool CSSCustomProperties::TryGet(core::Atom in_name, std::string_view& out_value) const
+{
+  const nsUInt32 uiIndex = LowerBound(in_name);
+  if (!Contains(uiIndex, in_name))
+    return false;
+
+  out_value = GetValue(m_Entries[uiIndex]);
+  return true;
+}
+
+std::string_view CSSCustomProperties::Get(core::Atom in_name) const
+{
+  std::string_view value;
+  TryGet(in_name, value);
+  return value;
+}
+
+void CSSCustomProperties::Set(core::Atom in_name, std::string_view in_value)
+{
+  // Replaced values are garbage, drop them once they outnumber the live ones.
+  if (m_Values.GetCount() >= 2 * m_Entries.GetCount() + 8)
+  {
+    CSSStringTable values;
+    for (Entry& entry : m_Entries)
+    {
+      entry.m_uiValue = values.Add(m_Values.Get(entry.m_uiValue));
+    }
+    m_Values = std::move(values);
+  }
+
+  const nsUInt32 uiIndex = LowerBound(in_name);
+  const nsUInt32 uiValue = m_Values.Add(in_value);
+  if (Contains(uiIndex, in_name))
+    m_Entries[uiIndex].m_uiValue = uiValue;
+  else
+    m_Entries.InsertAt(uiIndex, {in_name, uiValue});
+  m_uiHash = 0;
+}
+
+void CSSCustomProperties::Remove(core::Atom in_name)
+{
+  const nsUInt32 uiIndex = LowerBound(in_name);
+  if (Contains(uiIndex, in_name))
+  {
+    m_Entries.RemoveAtAndCopy(uiIndex);
+    m_uiHash = 0;
+  }
+}
+
+nsUInt64 CSSCustomProperties::GetHash() const
+{
+  nsUInt64 uiHash = m_uiHash;
+  if (uiHash == 0)
+  {
+    // The indices depend on the order the values were set in, only the names and the text count.
+    for (const Entry& entry : m_Entries)
+    {
+      const std::string_view value = GetValue(entry);
+      uiHash = nsHashingUtils::xxHash64(&entry.m_Name, sizeof(entry.m_Name), uiHash);
+      uiHash = nsHashingUtils::xxHash64(value.data(), value.size(), uiHash);
+    }
+    uiHash = uiHash != 0 ? uiHash : 1;
+    m_uiHash = uiHash;
+  }
+  return uiHash;
+}
+
+bool CSSCustomProperties::IsEqual(const CSSCustomProperties& in_other) const
+{
+  if (this == &in_other)
+    return true;
+  if (GetHash() != in_other.GetHash() || m_Entries.GetCount() != in_other.m_Entries.GetCount())
+    return false;
+
+  for (nsUInt32 i = 0; i < m_Entries.GetCount(); ++i)
+  {
+    if (m_Entries[i].m_Name != in_other.m_Entries[i].m_Name || GetValue(m_Entries[i]) != in_other.GetValue(in_other.m_Entries[i]))
+      return false;
+  }
+  return true;
+}
+
+nsUInt64 CSSCustomProperties::GetChangedNames(const CSSCustomProperties* in_pOld, const CSSCustomProperties* in_pNew)
+{
+  if (in_pOld == in_pNew)
+    return 0;
+
+  const nsArrayPtr<const Entry> oldEntries = in_pOld != nullptr ? in_pOld->GetEntries() : nsArrayPtr<const Entry>();
+  const nsArrayPtr<const Entry> newEntries = in_pNew != nullptr ? in_pNew->GetEntries() : nsArrayPtr<const Entry>();
+
+  // Both are sorted by name, walk them side by side.
+  nsUInt64 uiChanged = 0;
+  nsUInt32 o = 0;
+  nsUInt32 n = 0;
+  while (o < oldEntries.GetCount() || n < newEntries.GetCount())
+  {
+    if (n >= newEntries.GetCount() || (o < oldEntries.GetCount() && oldEntries[o].m_Name < newEntries[n].m_Name))
+    {
+      uiChanged |= GetNameBit(oldEntries[o++].m_Name);
+    }
+    else if (o >= oldEntries.GetCount() || newEntries[n].m_Name < oldEntries[o].m_Name)
+    {
+      uiChanged |= GetNameBit(newEntries[n++].m_Name);
+    }
+    else
+    {
+      if (in_pOld->GetValue(oldEntries[o]) != in_pNew->GetValue(newEntries[n]))
+        uiChanged |= GetNameBit(newEntries[n].m_Name);
+      ++o;
+      ++n;
+    }
+  }
+  return uiChanged;
+}
+
+nsUInt32 CSSCustomProperties::LowerBound(core::Atom in_name) const
+{
+  nsUInt32 uiLow = 0;
+  nsUInt32 uiHigh = m_Entries.GetCount();
+  while (uiLow < uiHigh)
+  {
+    const nsUInt32 uiMid = (uiLow + uiHigh) / 2;
+    if (m_Entries[uiMid].m_Name < in_name)
+      uiLow = uiMid + 1;
+    else
+      uiHigh = uiMid;
+  }
+  return uiLow;
+}
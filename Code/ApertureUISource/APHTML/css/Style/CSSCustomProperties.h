@@ -0,0 +1,103 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/core/Atom.h>
+#include <APHTML/css/Style/CSSStringTable.h>
+#include <Foundation/Containers/HybridArray.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <Foundation/Types/RefCounted.h>
+
+namespace aperture::css
+{
+  /*
+   * @brief The computed custom properties ("--name: value") of a element.
+   *
+   * Values are kept as source text with all var() references already substituted, in a string table owned by the set.
+   * Only the names are atoms. A name that is not in the set has the guaranteed-invalid value.
+   *
+   * Custom properties are inherited, so elements that declare none share the set of their parent. Sets handed out by
+   * the StyleCache are interned and must not be modified.
+   */
+  class NS_APERTURE_DLL CSSCustomProperties : public nsRefCounted
+  {
+  public:
+    struct Entry
+    {
+      NS_DECLARE_POD_TYPE();
+
+      core::Atom m_Name;
+      /// @brief The index of the text in the string table of the set, see GetValue().
+      nsUInt32 m_uiValue;
+    };
+
+    /// @brief Returns false if the property isn't set.
+    bool TryGet(core::Atom in_name, std::string_view& out_value) const;
+
+    /// @brief Returns the value of the property, empty if it isn't set.
+    std::string_view Get(core::Atom in_name) const;
+
+    /// @brief Sets the value, the set keeps its own copy of the text.
+    void Set(core::Atom in_name, std::string_view in_value);
+
+    /// @brief Removes the property, it has the guaranteed-invalid value afterwards.
+    void Remove(core::Atom in_name);
+
+    /// @brief The entries, sorted by name.
+    nsArrayPtr<const Entry> GetEntries() const { return m_Entries; }
+    std::string_view GetValue(const Entry& in_entry) const { return m_Values.Get(in_entry.m_uiValue); }
+    bool IsEmpty() const { return m_Entries.IsEmpty(); }
+
+    nsUInt64 GetHash() const;
+    bool IsEqual(const CSSCustomProperties& in_other) const;
+
+    /// @brief Maps a name to one of 64 bits. Styles keep a mask of the names they depend on, see ComputedStyle::GetVariableMask().
+    static nsUInt64 GetNameBit(core::Atom in_name) { return nsUInt64(1) << ((in_name * 0x9E3779B1u) >> 26); }
+
+    /// @brief Returns the name bits of all properties that differ between the two sets. Either may be null.
+    static nsUInt64 GetChangedNames(const CSSCustomProperties* in_pOld, const CSSCustomProperties* in_pNew);
+
+  private:
+    nsUInt32 LowerBound(core::Atom in_name) const;
+    bool Contains(nsUInt32 in_uiIndex, core::Atom in_name) const { return in_uiIndex < m_Entries.GetCount() && m_Entries[in_uiIndex].m_Name == in_name; }
+
+    nsHybridArray<Entry, 8> m_Entries;
+    /// @brief Replaced values stay in the table until it is compacted.
+    CSSStringTable m_Values;
+    /// @brief Computed on first use. Interned sets are shared between threads, which may all compute it at once.
+    mutable nsAtomicInteger<nsUInt64> m_uiHash;
+  };
+} // namespace aperture::css
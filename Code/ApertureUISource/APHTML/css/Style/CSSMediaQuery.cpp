@@ -0,0 +1,498 @@
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <APHTML/css/Style/CSSMediaQuery.h>
+
+using namespace aperture;
+using namespace aperture::css;
+using namespace aperture::css::parser;
+
+namespace
+{
+  bool IsEqualNoCase(std::string_view in_a, std::string_view in_b)
+  {
+    if (in_a.size() != in_b.size())
+      return false;
+    for (size_t i = 0; i < in_a.size(); ++i)
+    {
+      if (nsStringUtils::ToLowerChar(in_a[i]) != nsStringUtils::ToLowerChar(in_b[i]))
+        return false;
+    }
+    return true;
+  }
+
+  /// Reads a bool written with operator<<, without asserting when the stream ends early.
+  bool ReadBool(nsStreamReader& inout_stream, bool& out_bValue)
+  {
+    nsUInt8 uiValue = 0;
+    const bool bRead = inout_stream.ReadBytes(&uiValue, sizeof(nsUInt8)) == sizeof(nsUInt8);
+    out_bValue = uiValue != 0;
+    return bRead;
+  }
+
+  enum class ValueType : nsUInt8
+  {
+    Length,
+    Ratio,
+    Resolution,
+    Orientation,
+    Theme
+  };
+
+  struct FeatureInfo
+  {
+    const char* m_szName;
+    MediaQueryId m_Id;
+    ValueType m_Type;
+  };
+
+  constexpr FeatureInfo s_Features[] = {
+    {"width", MediaQueryId::Width, ValueType::Length},
+    {"min-width", MediaQueryId::MinWidth, ValueType::Length},
+    {"max-width", MediaQueryId::MaxWidth, ValueType::Length},
+    {"height", MediaQueryId::Height, ValueType::Length},
+    {"min-height", MediaQueryId::MinHeight, ValueType::Length},
+    {"max-height", MediaQueryId::MaxHeight, ValueType::Length},
+    {"aspect-ratio", MediaQueryId::AspectRatio, ValueType::Ratio},
+    {"min-aspect-ratio", MediaQueryId::MinAspectRatio, ValueType::Ratio},
+    {"max-aspect-ratio", MediaQueryId::MaxAspectRatio, ValueType::Ratio},
+    {"resolution", MediaQueryId::Resolution, ValueType::Resolution},
+    {"min-resolution", MediaQueryId::MinResolution, ValueType::Resolution},
+    {"max-resolution", MediaQueryId::MaxResolution, ValueType::Resolution},
+    {"orientation", MediaQueryId::Orientation, ValueType::Orientation},
+    {"prefers-color-scheme", MediaQueryId::Theme, ValueType::Theme},
+  };
+
+  const FeatureInfo* FindFeature(std::string_view in_name)
+  {
+    for (const FeatureInfo& info : s_Features)
+    {
+      if (IsEqualNoCase(in_name, info.m_szName))
+        return &info;
+    }
+    return nullptr;
+  }
+
+  /// Boolean features can't have a min- or max- prefix.
+  bool IsRangePrefixed(MediaQueryId in_id)
+  {
+    switch (in_id)
+    {
+      case MediaQueryId::MinWidth:
+      case MediaQueryId::MaxWidth:
+      case MediaQueryId::MinHeight:
+      case MediaQueryId::MaxHeight:
+      case MediaQueryId::MinAspectRatio:
+      case MediaQueryId::MaxAspectRatio:
+      case MediaQueryId::MinResolution:
+      case MediaQueryId::MaxResolution:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /// Parses the value tokens of a feature (whitespace is already skipped).
+  bool ParseFeatureValue(ValueType in_type, nsArrayPtr<const CSSToken> in_tokens, float& out_fValue)
+  {
+    if (in_tokens.IsEmpty())
+      return false;
+
+    const CSSToken& token = in_tokens[0];
+    switch (in_type)
+    {
+      case ValueType::Length:
+      {
+        if (in_tokens.GetCount() != 1)
+          return false;
+        if (token.m_Type == CSSTokenType::Number && token.m_fNumber == 0.0)
+        {
+          out_fValue = 0.0f;
+          return true;
+        }
+        if (token.m_Type != CSSTokenType::Dimension)
+          return false;
+        if (IsEqualNoCase(token.m_Unit, "px"))
+          out_fValue = static_cast<float>(token.m_fNumber);
+        else if (IsEqualNoCase(token.m_Unit, "em") || IsEqualNoCase(token.m_Unit, "rem"))
+          out_fValue = static_cast<float>(token.m_fNumber * 16.0);
+        else if (IsEqualNoCase(token.m_Unit, "pt"))
+          out_fValue = static_cast<float>(token.m_fNumber * 96.0 / 72.0);
+        else
+          return false;
+        return true;
+      }
+
+      case ValueType::Ratio:
+      {
+        // <number> or <number> / <number>.
+        if (token.m_Type != CSSTokenType::Number || token.m_fNumber < 0.0)
+          return false;
+        if (in_tokens.GetCount() == 1)
+        {
+          out_fValue = static_cast<float>(token.m_fNumber);
+          return true;
+        }
+        if (in_tokens.GetCount() != 3 || in_tokens[1].m_Type != CSSTokenType::Delim || in_tokens[1].m_Delim != '/' ||
+            in_tokens[2].m_Type != CSSTokenType::Number || in_tokens[2].m_fNumber <= 0.0)
+          return false;
+        out_fValue = static_cast<float>(token.m_fNumber / in_tokens[2].m_fNumber);
+        return true;
+      }
+
+      case ValueType::Resolution:
+      {
+        if (in_tokens.GetCount() != 1 || token.m_Type != CSSTokenType::Dimension || token.m_fNumber < 0.0)
+          return false;
+        if (IsEqualNoCase(token.m_Unit, "dppx") || IsEqualNoCase(token.m_Unit, "x"))
+          out_fValue = static_cast<float>(token.m_fNumber);
+        else if (IsEqualNoCase(token.m_Unit, "dpi"))
+          out_fValue = static_cast<float>(token.m_fNumber / 96.0);
+        else if (IsEqualNoCase(token.m_Unit, "dpcm"))
+          out_fValue = static_cast<float>(token.m_fNumber * 2.54 / 96.0);
+        else
+          return false;
+        return true;
+      }
+
+      case ValueType::Orientation:
+        if (in_tokens.GetCount() != 1 || token.m_Type != CSSTokenType::Ident)
+          return false;
+        if (IsEqualNoCase(token.m_Value, "portrait"))
+          out_fValue = 0.0f;
+        else if (IsEqualNoCase(token.m_Value, "landscape"))
+          out_fValue = 1.0f;
+        else
+          return false;
+        return true;
+
+      case ValueType::Theme:
+        if (in_tokens.GetCount() != 1 || token.m_Type != CSSTokenType::Ident)
+          return false;
+        if (IsEqualNoCase(token.m_Value, "light"))
+          out_fValue = static_cast<float>(MediaTheme::Light);
+        else if (IsEqualNoCase(token.m_Value, "dark"))
+          out_fValue = static_cast<float>(MediaTheme::Dark);
+        else
+          return false;
+        return true;
+    }
+    return false;
+  }
+} // namespace
+
+nsUInt32 CSSMediaQueryList::Parse(std::string_view in_source)
+{
+  m_Queries.Clear();
+  m_Features.Clear();
+
+  nsDynamicArray<CSSToken> tokens;
+  CSSTokenizer::TokenizeAll(in_source, tokens, true);
+  if (tokens.IsEmpty())
+    return 0;
+
+  nsUInt32 uiErrors = 0;
+  nsUInt32 i = 0;
+  while (i <= tokens.GetCount())
+  {
+    // One query per comma separated entry, a comma inside parentheses doesn't split.
+    nsUInt32 uiEnd = i;
+    for (nsUInt32 uiDepth = 0; uiEnd < tokens.GetCount(); ++uiEnd)
+    {
+      const CSSTokenType type = tokens[uiEnd].m_Type;
+      if (type == CSSTokenType::Comma && uiDepth == 0)
+        break;
+      if (type == CSSTokenType::OpenParen || type == CSSTokenType::Function)
+        ++uiDepth;
+      else if (type == CSSTokenType::CloseParen && uiDepth > 0)
+        --uiDepth;
+    }
+
+    Query query = {};
+    query.m_uiFirstFeature = static_cast<nsUInt16>(m_Features.GetCount());
+
+    bool bValid = uiEnd > i;
+    bool bExpectAnd = false;
+    nsUInt32 t = i;
+    if (bValid && tokens[t].m_Type == CSSTokenType::Ident && (IsEqualNoCase(tokens[t].m_Value, "not") || IsEqualNoCase(tokens[t].m_Value, "only")))
+    {
+      query.m_bNegated = IsEqualNoCase(tokens[t].m_Value, "not");
+      ++t;
+      bValid = t < uiEnd;
+    }
+
+    // An optional media type, then "and" separated features.
+    if (bValid && tokens[t].m_Type == CSSTokenType::Ident)
+    {
+      const std::string_view type = tokens[t].m_Value;
+      if (IsEqualNoCase(type, "and") || IsEqualNoCase(type, "or") || IsEqualNoCase(type, "not") || IsEqualNoCase(type, "only"))
+        bValid = false;
+      else
+        query.m_bNeverMatches = !IsEqualNoCase(type, "all") && !IsEqualNoCase(type, "screen");
+      bExpectAnd = true;
+      ++t;
+    }
+
+    while (bValid && t < uiEnd)
+    {
+      if (bExpectAnd)
+      {
+        bValid = tokens[t].m_Type == CSSTokenType::Ident && IsEqualNoCase(tokens[t].m_Value, "and") && t + 1 < uiEnd;
+        ++t;
+        bExpectAnd = false;
+        continue;
+      }
+
+      // (name) or (name: value)
+      nsUInt32 uiClose = t + 1;
+      while (uiClose < uiEnd && tokens[uiClose].m_Type != CSSTokenType::CloseParen)
+        ++uiClose;
+      if (tokens[t].m_Type != CSSTokenType::OpenParen || uiClose >= uiEnd || uiClose == t + 1 || tokens[t + 1].m_Type != CSSTokenType::Ident)
+      {
+        bValid = false;
+        break;
+      }
+
+      const FeatureInfo* pInfo = FindFeature(tokens[t + 1].m_Value);
+      Feature feature = {};
+      if (pInfo != nullptr)
+      {
+        feature.m_uiId = static_cast<nsUInt8>(pInfo->m_Id);
+        if (uiClose == t + 2)
+        {
+          feature.m_bBoolean = true;
+          bValid = !IsRangePrefixed(pInfo->m_Id);
+        }
+        else
+        {
+          bValid = tokens[t + 2].m_Type == CSSTokenType::Colon &&
+                   ParseFeatureValue(pInfo->m_Type, tokens.GetArrayPtr().GetSubArray(t + 3, uiClose - t - 3), feature.m_fValue);
+        }
+      }
+      bValid &= pInfo != nullptr;
+
+      if (bValid)
+        m_Features.PushBack(feature);
+      t = uiClose + 1;
+      bExpectAnd = true;
+    }
+
+    if (!bValid)
+    {
+      // Invalid queries are "not all", they never match.
+      m_Features.SetCount(query.m_uiFirstFeature);
+      query.m_bNegated = false;
+      query.m_bNeverMatches = true;
+      ++uiErrors;
+    }
+    query.m_uiFeatureCount = static_cast<nsUInt16>(m_Features.GetCount() - query.m_uiFirstFeature);
+    m_Queries.PushBack(query);
+
+    i = uiEnd + 1;
+  }
+  return uiErrors;
+}
+
+bool CSSMediaQueryList::Evaluate(const MediaEnvironment& in_environment) const
+{
+  if (m_Queries.IsEmpty())
+    return true;
+
+  for (const Query& query : m_Queries)
+  {
+    bool bMatches = !query.m_bNeverMatches;
+    for (nsUInt32 f = 0; f < query.m_uiFeatureCount && bMatches; ++f)
+    {
+      bMatches = EvaluateFeature(m_Features[query.m_uiFirstFeature + f], in_environment);
+    }
+    if (bMatches != query.m_bNegated)
+      return true;
+  }
+  return false;
+}
+
+bool CSSMediaQueryList::EvaluateFeature(const Feature& in_feature, const MediaEnvironment& in_environment)
+{
+  const float fAspectRatio = in_environment.m_fHeight > 0.0f ? in_environment.m_fWidth / in_environment.m_fHeight : 0.0f;
+  const float fValue = in_feature.m_fValue;
+
+  switch (static_cast<MediaQueryId>(in_feature.m_uiId))
+  {
+    case MediaQueryId::Width:
+      return in_feature.m_bBoolean ? in_environment.m_fWidth != 0.0f : in_environment.m_fWidth == fValue;
+    case MediaQueryId::MinWidth:
+      return in_environment.m_fWidth >= fValue;
+    case MediaQueryId::MaxWidth:
+      return in_environment.m_fWidth <= fValue;
+    case MediaQueryId::Height:
+      return in_feature.m_bBoolean ? in_environment.m_fHeight != 0.0f : in_environment.m_fHeight == fValue;
+    case MediaQueryId::MinHeight:
+      return in_environment.m_fHeight >= fValue;
+    case MediaQueryId::MaxHeight:
+      return in_environment.m_fHeight <= fValue;
+    case MediaQueryId::AspectRatio:
+      return in_feature.m_bBoolean ? fAspectRatio != 0.0f : nsMath::IsEqual(fAspectRatio, fValue, 0.0001f);
+    case MediaQueryId::MinAspectRatio:
+      return fAspectRatio >= fValue - 0.0001f;
+    case MediaQueryId::MaxAspectRatio:
+      return fAspectRatio <= fValue + 0.0001f;
+    case MediaQueryId::Resolution:
+      return in_feature.m_bBoolean ? in_environment.m_fResolution != 0.0f : in_environment.m_fResolution == fValue;
+    case MediaQueryId::MinResolution:
+      return in_environment.m_fResolution >= fValue;
+    case MediaQueryId::MaxResolution:
+      return in_environment.m_fResolution <= fValue;
+    case MediaQueryId::Orientation:
+      // Square viewports are portrait.
+      return in_feature.m_bBoolean || (in_environment.m_fWidth > in_environment.m_fHeight) == (fValue != 0.0f);
+    case MediaQueryId::Theme:
+      return in_feature.m_bBoolean || static_cast<float>(in_environment.m_Theme) == fValue;
+    default:
+      return false;
+  }
+}
+
+void CSSMediaQueryList::Write(nsStreamWriter& inout_stream) const
+{
+  inout_stream << m_Queries.GetCount();
+  for (const Query& query : m_Queries)
+  {
+    inout_stream << query.m_bNegated;
+    inout_stream << query.m_bNeverMatches;
+    inout_stream << query.m_uiFirstFeature;
+    inout_stream << query.m_uiFeatureCount;
+  }
+  inout_stream << m_Features.GetCount();
+  for (const Feature& feature : m_Features)
+  {
+    inout_stream << feature.m_uiId;
+    inout_stream << feature.m_bBoolean;
+    inout_stream << feature.m_fValue;
+  }
+}
+
+nsResult CSSMediaQueryList::Read(nsStreamReader& inout_stream)
+{
+  // Lists are read from precompiled sheets, which are untrusted. A stream that ends early fails the read instead of
+  // asserting, and the counts are bounded by the 16 bit feature indices before anything is allocated for them.
+  m_Queries.Clear();
+  m_Features.Clear();
+  bool bCorrupted = false;
+
+  nsUInt32 uiQueryCount = 0;
+  NS_SUCCEED_OR_RETURN(inout_stream.ReadDWordValue(&uiQueryCount));
+  if (uiQueryCount > nsMath::MaxValue<nsUInt16>())
+    return NS_FAILURE;
+
+  m_Queries.SetCountUninitialized(uiQueryCount);
+  for (Query& query : m_Queries)
+  {
+    bCorrupted |= !ReadBool(inout_stream, query.m_bNegated) || !ReadBool(inout_stream, query.m_bNeverMatches);
+    bCorrupted |= inout_stream.ReadWordValue(&query.m_uiFirstFeature).Failed();
+    bCorrupted |= inout_stream.ReadWordValue(&query.m_uiFeatureCount).Failed();
+  }
+
+  nsUInt32 uiFeatureCount = 0;
+  bCorrupted |= inout_stream.ReadDWordValue(&uiFeatureCount).Failed() || uiFeatureCount > nsMath::MaxValue<nsUInt16>();
+  if (!bCorrupted)
+  {
+    m_Features.SetCountUninitialized(uiFeatureCount);
+    for (Feature& feature : m_Features)
+    {
+      bCorrupted |= inout_stream.ReadBytes(&feature.m_uiId, sizeof(nsUInt8)) != sizeof(nsUInt8);
+      bCorrupted |= !ReadBool(inout_stream, feature.m_bBoolean);
+      bCorrupted |= inout_stream.ReadDWordValue(&feature.m_fValue).Failed();
+      bCorrupted |= feature.m_uiId == 0 || feature.m_uiId >= static_cast<nsUInt8>(MediaQueryId::NumDefinedIds);
+    }
+  }
+  for (const Query& query : m_Queries)
+  {
+    bCorrupted |= nsUInt32(query.m_uiFirstFeature) + query.m_uiFeatureCount > uiFeatureCount;
+  }
+
+  if (bCorrupted)
+  {
+    m_Queries.Clear();
+    m_Features.Clear();
+    return NS_FAILURE;
+  }
+  return NS_SUCCESS;
+}
+
+bool CSSMediaQueryList::operator==(const CSSMediaQueryList& other) const
+{
+  if (m_Queries.GetCount() != other.m_Queries.GetCount() || m_Features.GetCount() != other.m_Features.GetCount())
+    return false;
+  for (nsUInt32 i = 0; i < m_Queries.GetCount(); ++i)
+  {
+    const Query& a = m_Queries[i];
+    const Query& b = other.m_Queries[i];
+    if (a.m_bNegated != b.m_bNegated || a.m_bNeverMatches != b.m_bNeverMatches || a.m_uiFirstFeature != b.m_uiFirstFeature || a.m_uiFeatureCount != b.m_uiFeatureCount)
+      return false;
+  }
+  for (nsUInt32 i = 0; i < m_Features.GetCount(); ++i)
+  {
+    const Feature& a = m_Features[i];
+    const Feature& b = other.m_Features[i];
+    if (a.m_uiId != b.m_uiId || a.m_bBoolean != b.m_bBoolean || a.m_fValue != b.m_fValue)
+      return false;
+  }
+  return true;
+}
+
+nsUInt32 CSSMediaQueryCache::AddBlock(const CSSMediaQueryList* in_pQueries, nsUInt32 in_uiParent)
+{
+  NS_ASSERT_DEV(in_uiParent == NoParent || in_uiParent < m_Blocks.GetCount(), "Parents have to be added before the blocks nested in them.");
+
+  // The cached bitsets don't cover the new block.
+  m_Entries.Clear();
+  m_Blocks.PushBack({in_pQueries, in_uiParent});
+  return m_Blocks.GetCount() - 1;
+}
+
+void CSSMediaQueryCache::Clear()
+{
+  m_Blocks.Clear();
+  m_Entries.Clear();
+}
+
+const nsDynamicBitfield& CSSMediaQueryCache::Evaluate(const MediaEnvironment& in_environment)
+{
+  ++m_uiUseCounter;
+  for (Entry& entry : m_Entries)
+  {
+    if (entry.m_Environment == in_environment)
+    {
+      entry.m_uiLastUse = m_uiUseCounter;
+      return entry.m_Results;
+    }
+  }
+
+  // Replace the least recently used entry once the cache is full.
+  Entry* pEntry = nullptr;
+  if (m_Entries.GetCount() < CacheSize)
+  {
+    pEntry = &m_Entries.ExpandAndGetRef();
+  }
+  else
+  {
+    pEntry = &m_Entries[0];
+    for (Entry& entry : m_Entries)
+    {
+      if (entry.m_uiLastUse < pEntry->m_uiLastUse)
+        pEntry = &entry;
+    }
+  }
+
+  ++m_uiEvaluations;
+  pEntry->m_Environment = in_environment;
+  pEntry->m_uiLastUse = m_uiUseCounter;
+  pEntry->m_Results.SetCount(m_Blocks.GetCount());
+
+  // Parents come first, their bit is final when a nested block looks at it.
+  for (nsUInt32 b = 0; b < m_Blocks.GetCount(); ++b)
+  {
+    const Block& block = m_Blocks[b];
+    const bool bParentMatches = block.m_uiParent == NoParent || pEntry->m_Results.IsBitSet(block.m_uiParent);
+    pEntry->m_Results.SetBitValue(b, bParentMatches && block.m_pQueries->Evaluate(in_environment));
+  }
+  return pEntry->m_Results;
+}
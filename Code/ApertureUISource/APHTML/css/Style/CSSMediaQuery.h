@@ -0,0 +1,176 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/core/ID.h>
+#include <Foundation/Containers/Bitfield.h>
+#include <Foundation/Containers/HybridArray.h>
+#include <Foundation/IO/Stream.h>
+#include <string_view>
+
+namespace aperture::css
+{
+  enum class MediaTheme : nsUInt8
+  {
+    Light,
+    Dark
+  };
+
+  /// @brief The state of the viewport media queries are evaluated against.
+  struct MediaEnvironment
+  {
+    NS_DECLARE_POD_TYPE();
+
+    /// @brief In CSS px.
+    float m_fWidth = 1920.0f;
+    float m_fHeight = 1080.0f;
+    /// @brief Device pixels per CSS px (dppx).
+    float m_fResolution = 1.0f;
+    MediaTheme m_Theme = MediaTheme::Light;
+
+    bool operator==(const MediaEnvironment& other) const
+    {
+      return m_fWidth == other.m_fWidth && m_fHeight == other.m_fHeight && m_fResolution == other.m_fResolution && m_Theme == other.m_Theme;
+    }
+    bool operator!=(const MediaEnvironment& other) const { return !(*this == other); }
+  };
+
+  /*
+   * @brief A compiled media query list, e.g. the prelude of "@media screen and (min-width: 800px), (orientation: portrait)".
+   *
+   * Every query is a media type and a conjunction of features, the list matches if any of its queries does.
+   * The features are the ones of MediaQueryId: width, height, aspect-ratio and resolution (each with min- and max-),
+   * orientation and prefers-color-scheme (the theme). Lengths are converted to px when the list is parsed, em and rem
+   * are relative to the initial font size (16px) as per spec.
+   *
+   * Queries that don't parse match nothing, the other queries of the list are kept. Media types other than all and
+   * screen never match. The range syntax ("width >= 800px") and "or" are not supported.
+   */
+  class NS_APERTURE_DLL CSSMediaQueryList
+  {
+  public:
+    /// @brief Replaces the list with the parsed source. An empty source matches everything.
+    /// @return The number of queries that were invalid.
+    nsUInt32 Parse(std::string_view in_source);
+
+    bool Evaluate(const MediaEnvironment& in_environment) const;
+
+    nsUInt32 GetQueryCount() const { return m_Queries.GetCount(); }
+
+    void Write(nsStreamWriter& inout_stream) const;
+    nsResult Read(nsStreamReader& inout_stream);
+
+    bool operator==(const CSSMediaQueryList& other) const;
+    bool operator!=(const CSSMediaQueryList& other) const { return !(*this == other); }
+
+  private:
+    struct Feature
+    {
+      NS_DECLARE_POD_TYPE();
+
+      /// @brief A MediaQueryId.
+      nsUInt8 m_uiId;
+      /// @brief Used without a value, e.g. "(orientation)".
+      bool m_bBoolean;
+      /// @brief px, dppx or the ratio width / height. The MediaTheme or 0 = portrait, 1 = landscape for keyword features.
+      float m_fValue;
+    };
+
+    struct Query
+    {
+      NS_DECLARE_POD_TYPE();
+
+      bool m_bNegated;
+      /// @brief The query was invalid or is for a media type other than all or screen.
+      bool m_bNeverMatches;
+      nsUInt16 m_uiFirstFeature;
+      nsUInt16 m_uiFeatureCount;
+    };
+
+    static bool EvaluateFeature(const Feature& in_feature, const MediaEnvironment& in_environment);
+
+    nsHybridArray<Query, 1> m_Queries;
+    nsHybridArray<Feature, 2> m_Features;
+  };
+
+  /*
+   * @brief Evaluates the @media blocks of all stylesheets of a StyleResolver into one bitset per MediaEnvironment.
+   *
+   * Blocks are added once, when a stylesheet is added. Evaluate() computes one bit per block, a block only applies if
+   * its own queries and the ones of the blocks it is nested in match. Games switch between a handful of viewport states
+   * (windowed and fullscreen, two DPI scales, light and dark theme), so the bitsets of the last CacheSize environments
+   * are kept and switching back to one of them doesn't evaluate anything.
+   */
+  class NS_APERTURE_DLL CSSMediaQueryCache
+  {
+  public:
+    static constexpr nsUInt32 CacheSize = 4;
+    static constexpr nsUInt32 NoParent = 0xFFFFFFFF;
+
+    /// @brief Adds a block and returns its bit. The list is referenced, its owner has to keep it alive.
+    /// @param in_uiParent The bit of the block this one is nested in, or NoParent.
+    nsUInt32 AddBlock(const CSSMediaQueryList* in_pQueries, nsUInt32 in_uiParent);
+    void Clear();
+
+    nsUInt32 GetBlockCount() const { return m_Blocks.GetCount(); }
+
+    /// @brief Returns which blocks apply in the environment. The reference is valid until the next call.
+    const nsDynamicBitfield& Evaluate(const MediaEnvironment& in_environment);
+
+    /// @brief How often the blocks were actually evaluated, as opposed to taken from the cache.
+    nsUInt32 GetEvaluationCount() const { return m_uiEvaluations; }
+
+  private:
+    struct Block
+    {
+      NS_DECLARE_POD_TYPE();
+
+      const CSSMediaQueryList* m_pQueries;
+      nsUInt32 m_uiParent;
+    };
+
+    struct Entry
+    {
+      MediaEnvironment m_Environment;
+      nsDynamicBitfield m_Results;
+      nsUInt64 m_uiLastUse = 0;
+    };
+
+    nsDynamicArray<Block> m_Blocks;
+    nsHybridArray<Entry, CacheSize> m_Entries;
+    nsUInt64 m_uiUseCounter = 0;
+    nsUInt32 m_uiEvaluations = 0;
+  };
+} // namespace aperture::css
@@ -0,0 +1,822 @@
+#include <APHTML/css/Function/CSSVarFunction.h>
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <Foundation/Containers/HashTable.h>
+
+using namespace aperture;
+using namespace aperture::css;
+using namespace aperture::css::parser;
+
+namespace
+{
+  constexpr CSSValueKind::StorageType LP = CSSValueKind::LengthPercent;
+  constexpr CSSValueKind::StorageType LPK = CSSValueKind::LengthPercent | CSSValueKind::Keyword;
+  constexpr CSSValueKind::StorageType L = CSSValueKind::Length;
+  constexpr CSSValueKind::StorageType LK = CSSValueKind::Length | CSSValueKind::Keyword;
+  constexpr CSSValueKind::StorageType N = CSSValueKind::Number;
+  constexpr CSSValueKind::StorageType NK = CSSValueKind::Number | CSSValueKind::Keyword;
+  constexpr CSSValueKind::StorageType C = CSSValueKind::Color;
+  constexpr CSSValueKind::StorageType CK = CSSValueKind::Color | CSSValueKind::Keyword;
+  constexpr CSSValueKind::StorageType K = CSSValueKind::Keyword;
+  constexpr CSSValueKind::StorageType R = CSSValueKind::Raw;
+
+  // NOTE: Must stay in the same order as aperture::PropertyId.
+  // clang-format off
+  constexpr CSSPropertyInfo s_Properties[] = {
+    {"",                            PropertyId::Invalid,                 0,   false, ""},
+    {"margin-top",                  PropertyId::MarginTop,               LPK, false, "0px"},
+    {"margin-right",                PropertyId::MarginRight,             LPK, false, "0px"},
+    {"margin-bottom",               PropertyId::MarginBottom,            LPK, false, "0px"},
+    {"margin-left",                 PropertyId::MarginLeft,              LPK, false, "0px"},
+    {"padding-top",                 PropertyId::PaddingTop,              LP,  false, "0px"},
+    {"padding-right",               PropertyId::PaddingRight,            LP,  false, "0px"},
+    {"padding-bottom",              PropertyId::PaddingBottom,           LP,  false, "0px"},
+    {"padding-left",                PropertyId::PaddingLeft,             LP,  false, "0px"},
+    {"border-top-width",            PropertyId::BorderTopWidth,          L,   false, "0px"},
+    {"border-right-width",          PropertyId::BorderRightWidth,        L,   false, "0px"},
+    {"border-bottom-width",         PropertyId::BorderBottomWidth,       L,   false, "0px"},
+    {"border-left-width",           PropertyId::BorderLeftWidth,         L,   false, "0px"},
+    {"border-top-color",            PropertyId::BorderTopColor,          CK,  false, "currentcolor"},
+    {"border-right-color",          PropertyId::BorderRightColor,        CK,  false, "currentcolor"},
+    {"border-bottom-color",         PropertyId::BorderBottomColor,       CK,  false, "currentcolor"},
+    {"border-left-color",           PropertyId::BorderLeftColor,         CK,  false, "currentcolor"},
+    {"border-top-left-radius",      PropertyId::BorderTopLeftRadius,     LP,  false, "0px"},
+    {"border-top-right-radius",     PropertyId::BorderTopRightRadius,    LP,  false, "0px"},
+    {"border-bottom-right-radius",  PropertyId::BorderBottomRightRadius, LP,  false, "0px"},
+    {"border-bottom-left-radius",   PropertyId::BorderBottomLeftRadius,  LP,  false, "0px"},
+    {"display",                     PropertyId::Display,                 K,   false, "inline"},
+    {"position",                    PropertyId::Position,                K,   false, "static"},
+    {"top",                         PropertyId::Top,                     LPK, false, "auto"},
+    {"right",                       PropertyId::Right,                   LPK, false, "auto"},
+    {"bottom",                      PropertyId::Bottom,                  LPK, false, "auto"},
+    {"left",                        PropertyId::Left,                    LPK, false, "auto"},
+    {"float",                       PropertyId::Float,                   K,   false, "none"},
+    {"clear",                       PropertyId::Clear,                   K,   false, "none"},
+    {"box-sizing",                  PropertyId::BoxSizing,               K,   false, "content-box"},
+    {"z-index",                     PropertyId::ZIndex,                  NK,  false, "auto"},
+    {"width",                       PropertyId::Width,                   LPK, false, "auto"},
+    {"min-width",                   PropertyId::MinWidth,                LP,  false, "0px"},
+    {"max-width",                   PropertyId::MaxWidth,                LPK, false, "none"},
+    {"height",                      PropertyId::Height,                  LPK, false, "auto"},
+    {"min-height",                  PropertyId::MinHeight,               LP,  false, "0px"},
+    {"max-height",                  PropertyId::MaxHeight,               LPK, false, "none"},
+    {"line-height",                 PropertyId::LineHeight,              LP | NK, true, "normal"},
+    {"vertical-align",              PropertyId::VerticalAlign,           LPK, false, "baseline"},
+    {"overflow-x",                  PropertyId::OverflowX,               K,   false, "visible"},
+    {"overflow-y",                  PropertyId::OverflowY,               K,   false, "visible"},
+    {"contain",                     PropertyId::Contain,                 R,   false, "none"},
+    {"clip",                        PropertyId::Clip,                    NK,  false, "auto"},
+    {"visibility",                  PropertyId::Visibility,              K,   true,  "visible"},
+    {"background-color",            PropertyId::BackgroundColor,         CK,  false, "transparent"},
+    {"color",                       PropertyId::Color,                   C,   true,  "#000000"},
+    {"caret-color",                 PropertyId::CaretColor,              CK,  true,  "auto"},
+    {"image-color",                 PropertyId::ImageColor,              C,   false, "#ffffff"},
+    {"font-family",                 PropertyId::FontFamily,              R,   true,  ""},
+    {"font-style",                  PropertyId::FontStyle,               K,   true,  "normal"},
+    {"font-weight",                 PropertyId::FontWeight,              NK,  true,  "normal"},
+    {"font-size",                   PropertyId::FontSize,                LPK, true,  "16px"},
+    {"letter-spacing",              PropertyId::LetterSpacing,           LK,  true,  "normal"},
+    {"text-align",                  PropertyId::TextAlign,               K,   true,  "left"},
+    {"text-decoration",             PropertyId::TextDecoration,          K,   false, "none"},
+    {"text-transform",              PropertyId::TextTransform,           K,   true,  "none"},
+    {"white-space",                 PropertyId::WhiteSpace,              K,   true,  "normal"},
+    {"word-break",                  PropertyId::WordBreak,               K,   true,  "normal"},
+    {"row-gap",                     PropertyId::RowGap,                  LP,  false, "0px"},
+    {"column-gap",                  PropertyId::ColumnGap,               LP,  false, "0px"},
+    {"cursor",                      PropertyId::Cursor,                  R,   true,  "auto"},
+    {"drag",                        PropertyId::Drag,                    K,   false, "none"},
+    {"tab-index",                   PropertyId::TabIndex,                K,   false, "none"},
+    {"scrollbar-margin",            PropertyId::ScrollbarMargin,         L,   false, "0px"},
+    {"overscroll-behavior",         PropertyId::OverscrollBehavior,      K,   false, "auto"},
+    {"perspective",                 PropertyId::Perspective,             LK,  false, "none"},
+    {"perspective-origin-x",        PropertyId::PerspectiveOriginX,      LP,  false, "50%"},
+    {"perspective-origin-y",        PropertyId::PerspectiveOriginY,      LP,  false, "50%"},
+    {"transform",                   PropertyId::Transform,               R,   false, "none"},
+    {"transform-origin-x",          PropertyId::TransformOriginX,        LP,  false, "50%"},
+    {"transform-origin-y",          PropertyId::TransformOriginY,        LP,  false, "50%"},
+    {"transform-origin-z",          PropertyId::TransformOriginZ,        L,   false, "0px"},
+    {"transition",                  PropertyId::Transition,              R,   false, "none"},
+    {"animation",                   PropertyId::Animation,               R,   false, "none"},
+    {"opacity",                     PropertyId::Opacity,                 N,   false, "1"},
+    {"pointer-events",              PropertyId::PointerEvents,           K,   true,  "auto"},
+    {"focus",                       PropertyId::Focus,                   K,   true,  "auto"},
+    {"decorator",                   PropertyId::Decorator,               R,   false, "none"},
+    {"mask-image",                  PropertyId::MaskImage,               R,   false, "none"},
+    {"font-effect",                 PropertyId::FontEffect,              R,   true,  "none"},
+    {"filter",                      PropertyId::Filter,                  R,   false, "none"},
+    {"backdrop-filter",             PropertyId::BackdropFilter,          R,   false, "none"},
+    {"box-shadow",                  PropertyId::BoxShadow,               R,   false, "none"},
+    {"fill-image",                  PropertyId::FillImage,               R,   false, "none"},
+    {"align-content",               PropertyId::AlignContent,            K,   false, "stretch"},
+    {"align-items",                 PropertyId::AlignItems,              K,   false, "stretch"},
+    {"align-self",                  PropertyId::AlignSelf,               K,   false, "auto"},
+    {"flex-basis",                  PropertyId::FlexBasis,               LPK, false, "auto"},
+    {"flex-direction",              PropertyId::FlexDirection,           K,   false, "row"},
+    {"flex-grow",                   PropertyId::FlexGrow,                N,   false, "0"},
+    {"flex-shrink",                 PropertyId::FlexShrink,              N,   false, "1"},
+    {"flex-wrap",                   PropertyId::FlexWrap,                K,   false, "nowrap"},
+    {"justify-content",             PropertyId::JustifyContent,          K,   false, "flex-start"},
+    {"grid-template-columns",       PropertyId::GridTemplateColumns,     R,   false, "none"},
+    {"grid-template-rows",          PropertyId::GridTemplateRows,        R,   false, "none"},
+    {"grid-auto-columns",           PropertyId::GridAutoColumns,         R,   false, "auto"},
+    {"grid-auto-rows",              PropertyId::GridAutoRows,            R,   false, "auto"},
+    {"grid-auto-flow",              PropertyId::GridAutoFlow,            R,   false, "row"},
+    {"grid-column-start",           PropertyId::GridColumnStart,         R,   false, "auto"},
+    {"grid-column-end",             PropertyId::GridColumnEnd,           R,   false, "auto"},
+    {"grid-row-start",              PropertyId::GridRowStart,            R,   false, "auto"},
+    {"grid-row-end",                PropertyId::GridRowEnd,              R,   false, "auto"},
+    {"nav-up",                      PropertyId::NavUp,                   R,   false, "none"},
+    {"nav-right",                   PropertyId::NavRight,                R,   false, "none"},
+    {"nav-down",                    PropertyId::NavDown,                 R,   false, "none"},
+    {"nav-left",                    PropertyId::NavLeft,                 R,   false, "none"},
+    {"lang",                        PropertyId::Language,                R,   true,  ""},
+    {"direction",                   PropertyId::Direction,               K,   true,  "ltr"},
+  };
+  // clang-format on
+  static_assert(NS_ARRAY_SIZE(s_Properties) == static_cast<size_t>(PropertyId::NumDefinedIds), "Property table is out of sync with PropertyId.");
+
+  struct NamedColor
+  {
+    const char* m_szName;
+    nsUInt32 m_uiRGBA;
+  };
+
+  // RGBA8 with red in the lowest byte.
+  constexpr NamedColor s_NamedColors[] = {
+    {"transparent", 0x00000000},
+    {"black", 0xFF000000},
+    {"silver", 0xFFC0C0C0},
+    {"gray", 0xFF808080},
+    {"grey", 0xFF808080},
+    {"white", 0xFFFFFFFF},
+    {"maroon", 0xFF000080},
+    {"red", 0xFF0000FF},
+    {"purple", 0xFF800080},
+    {"fuchsia", 0xFFFF00FF},
+    {"magenta", 0xFFFF00FF},
+    {"green", 0xFF008000},
+    {"lime", 0xFF00FF00},
+    {"olive", 0xFF008080},
+    {"yellow", 0xFF00FFFF},
+    {"navy", 0xFF800000},
+    {"blue", 0xFFFF0000},
+    {"teal", 0xFF808000},
+    {"aqua", 0xFFFFFF00},
+    {"cyan", 0xFFFFFF00},
+    {"orange", 0xFF00A5FF},
+  };
+
+  struct UnitEntry
+  {
+    const char* m_szName;
+    core::Unit m_Unit;
+  };
+
+  constexpr UnitEntry s_Units[] = {
+    {"px", core::Unit::PX},
+    {"dp", core::Unit::DP},
+    {"vw", core::Unit::VW},
+    {"vh", core::Unit::VH},
+    {"x", core::Unit::X},
+    {"em", core::Unit::EM},
+    {"rem", core::Unit::REM},
+    {"in", core::Unit::INCH},
+    {"cm", core::Unit::CM},
+    {"mm", core::Unit::MM},
+    {"pt", core::Unit::PT},
+    {"pc", core::Unit::PC},
+    {"deg", core::Unit::DEG},
+    {"rad", core::Unit::RAD},
+  };
+
+  bool IsEqualNoCase(std::string_view in_a, std::string_view in_b)
+  {
+    if (in_a.size() != in_b.size())
+      return false;
+    for (size_t i = 0; i < in_a.size(); ++i)
+    {
+      if (nsStringUtils::ToLowerChar(in_a[i]) != nsStringUtils::ToLowerChar(in_b[i]))
+        return false;
+    }
+    return true;
+  }
+
+  std::string_view Trim(std::string_view in_text)
+  {
+    const size_t uiFirst = in_text.find_first_not_of(" \t\r\n\f");
+    if (uiFirst == std::string_view::npos)
+      return {};
+    const size_t uiLast = in_text.find_last_not_of(" \t\r\n\f");
+    return in_text.substr(uiFirst, uiLast - uiFirst + 1);
+  }
+
+  struct PropertyNameTable
+  {
+    PropertyNameTable()
+    {
+      for (const CSSPropertyInfo& info : s_Properties)
+      {
+        if (info.m_Id != PropertyId::Invalid)
+          m_NameToId.Insert(info.m_szName, static_cast<nsUInt8>(info.m_Id));
+      }
+
+      for (const CSSPropertyInfo& info : s_Properties)
+      {
+        CSSValue& initial = m_InitialValues.ExpandAndGetRef();
+        if (info.m_Id != PropertyId::Invalid && CSSPropertyTable::ParseValue(info.m_Id, info.m_szInitialValue, initial, m_InitialStrings).Failed())
+        {
+          // Raw properties with an empty initial value end up here.
+          initial = CSSValue::MakeString(m_InitialStrings.Add(info.m_szInitialValue));
+        }
+      }
+    }
+
+    nsHashTable<nsString, nsUInt8> m_NameToId;
+    nsDynamicArray<CSSValue> m_InitialValues;
+    CSSStringTable m_InitialStrings;
+  };
+
+  const PropertyNameTable& GetPropertyNameTable()
+  {
+    static PropertyNameTable s_Table;
+    return s_Table;
+  }
+
+  /// A whitespace separated part of a declaration value, e.g. "1px", "rgb(0, 0, 0)" or "solid".
+  struct ValueComponent
+  {
+    std::string_view m_Text;
+    CSSToken m_FirstToken;
+    nsUInt32 m_uiTokenCount = 0;
+  };
+
+  void SplitComponents(std::string_view in_value, nsHybridArray<ValueComponent, 4>& out_components)
+  {
+    CSSTokenizer tokenizer(in_value);
+    ValueComponent* pCurrent = nullptr;
+    nsUInt32 uiDepth = 0;
+
+    for (CSSToken token = tokenizer.Next(); token.m_Type != CSSTokenType::EndOfFile; token = tokenizer.Next())
+    {
+      if (token.m_Type == CSSTokenType::Whitespace && uiDepth == 0)
+      {
+        pCurrent = nullptr;
+        continue;
+      }
+
+      if (pCurrent == nullptr)
+      {
+        pCurrent = &out_components.ExpandAndGetRef();
+        pCurrent->m_FirstToken = token;
+        pCurrent->m_Text = in_value.substr(token.m_uiOffset, 0);
+      }
+      ++pCurrent->m_uiTokenCount;
+
+      if (token.m_Type == CSSTokenType::Function || token.m_Type == CSSTokenType::OpenParen)
+        ++uiDepth;
+      else if (token.m_Type == CSSTokenType::CloseParen && uiDepth > 0)
+        --uiDepth;
+
+      const size_t uiStart = pCurrent->m_FirstToken.m_uiOffset;
+      pCurrent->m_Text = in_value.substr(uiStart, tokenizer.GetOffset() - uiStart);
+    }
+  }
+
+  nsUInt8 ClampColorChannel(double in_fValue)
+  {
+    return static_cast<nsUInt8>(nsMath::Clamp(in_fValue, 0.0, 255.0) + 0.5);
+  }
+
+  nsResult ParseRGBFunction(std::string_view in_value, nsUInt32& out_uiRGBA)
+  {
+    nsDynamicArray<CSSToken> tokens;
+    CSSTokenizer::TokenizeAll(in_value, tokens, true);
+
+    nsHybridArray<double, 4> channels;
+    for (nsUInt32 i = 1; i < tokens.GetCount(); ++i)
+    {
+      const CSSToken& token = tokens[i];
+      if (token.m_Type == CSSTokenType::Number)
+      {
+        channels.PushBack(channels.GetCount() < 3 ? token.m_fNumber : token.m_fNumber * 255.0);
+      }
+      else if (token.m_Type == CSSTokenType::Percentage)
+      {
+        channels.PushBack(token.m_fNumber * 2.55);
+      }
+      else if (token.m_Type != CSSTokenType::Comma && token.m_Type != CSSTokenType::CloseParen && !(token.m_Type == CSSTokenType::Delim && token.m_Delim == '/'))
+      {
+        return NS_FAILURE;
+      }
+    }
+    if (channels.GetCount() != 3 && channels.GetCount() != 4)
+      return NS_FAILURE;
+
+    const nsUInt8 uiAlpha = channels.GetCount() == 4 ? ClampColorChannel(channels[3]) : 255;
+    out_uiRGBA = ClampColorChannel(channels[0]) | (ClampColorChannel(channels[1]) << 8) | (ClampColorChannel(channels[2]) << 16) | (nsUInt32(uiAlpha) << 24);
+    return NS_SUCCESS;
+  }
+
+  nsResult ParseComponent(const CSSPropertyInfo& in_info, const ValueComponent& in_component, CSSValue& out_value)
+  {
+    const CSSToken& token = in_component.m_FirstToken;
+    const CSSValueKind::StorageType uiKinds = in_info.m_uiKinds;
+
+    if ((uiKinds & CSSValueKind::Color) != 0)
+    {
+      nsUInt32 uiRGBA = 0;
+      if (CSSPropertyTable::ParseColor(in_component.m_Text, uiRGBA).Succeeded())
+      {
+        out_value = CSSValue::MakeColor(uiRGBA);
+        return NS_SUCCESS;
+      }
+    }
+
+    if (in_component.m_uiTokenCount != 1)
+      return NS_FAILURE;
+
+    switch (token.m_Type)
+    {
+      case CSSTokenType::Number:
+        if ((uiKinds & CSSValueKind::Number) != 0)
+        {
+          out_value = CSSValue::MakeNumeric(static_cast<float>(token.m_fNumber), core::Unit::NUMBER);
+          return NS_SUCCESS;
+        }
+        // Unitless zero is a valid length.
+        if ((uiKinds & CSSValueKind::Length) != 0 && token.m_fNumber == 0.0)
+        {
+          out_value = CSSValue::MakeNumeric(0.0f, core::Unit::PX);
+          return NS_SUCCESS;
+        }
+        return NS_FAILURE;
+
+      case CSSTokenType::Percentage:
+        if ((uiKinds & CSSValueKind::Percent) == 0)
+          return NS_FAILURE;
+        out_value = CSSValue::MakeNumeric(static_cast<float>(token.m_fNumber), core::Unit::PERCENT);
+        return NS_SUCCESS;
+
+      case CSSTokenType::Dimension:
+        if ((uiKinds & CSSValueKind::Length) == 0)
+          return NS_FAILURE;
+        for (const UnitEntry& unit : s_Units)
+        {
+          if (IsEqualNoCase(token.m_Unit, unit.m_szName))
+          {
+            out_value = CSSValue::MakeNumeric(static_cast<float>(token.m_fNumber), unit.m_Unit);
+            return NS_SUCCESS;
+          }
+        }
+        return NS_FAILURE;
+
+      case CSSTokenType::Ident:
+        if ((uiKinds & CSSValueKind::Keyword) == 0)
+          return NS_FAILURE;
+        out_value = CSSValue::MakeKeyword(core::AtomTable::Get().InternLowercase(token.m_Value));
+        return NS_SUCCESS;
+
+      default:
+        return NS_FAILURE;
+    }
+  }
+
+  /// Maps the keywords of transform-origin and perspective-origin to percentages.
+  bool ParseOriginKeyword(std::string_view in_text, CSSValue& out_value)
+  {
+    constexpr struct
+    {
+      const char* m_szName;
+      float m_fPercent;
+    } keywords[] = {{"left", 0.0f}, {"top", 0.0f}, {"center", 50.0f}, {"right", 100.0f}, {"bottom", 100.0f}};
+
+    for (const auto& keyword : keywords)
+    {
+      if (IsEqualNoCase(in_text, keyword.m_szName))
+      {
+        out_value = CSSValue::MakeNumeric(keyword.m_fPercent, core::Unit::PERCENT);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  enum class ShorthandType : nsUInt8
+  {
+    /// 1 to 4 values, top/right/bottom/left expansion.
+    Box,
+    /// 1 or 2 values, the second defaults to the first.
+    Pair,
+    /// x, y and optionally z, with position keywords.
+    Origin,
+    Flex,
+    Border,
+    Background,
+    /// <start> [/ <end>], the end defaults to auto. Both are kept as raw text.
+    GridLine,
+  };
+
+  struct ShorthandInfo
+  {
+    const char* m_szName;
+    ShorthandType m_Type;
+    PropertyId m_Longhands[8];
+  };
+
+  // clang-format off
+  const ShorthandInfo s_Shorthands[] = {
+    {"margin",             ShorthandType::Box,        {PropertyId::MarginTop, PropertyId::MarginRight, PropertyId::MarginBottom, PropertyId::MarginLeft}},
+    {"padding",            ShorthandType::Box,        {PropertyId::PaddingTop, PropertyId::PaddingRight, PropertyId::PaddingBottom, PropertyId::PaddingLeft}},
+    {"border-width",       ShorthandType::Box,        {PropertyId::BorderTopWidth, PropertyId::BorderRightWidth, PropertyId::BorderBottomWidth, PropertyId::BorderLeftWidth}},
+    {"border-color",       ShorthandType::Box,        {PropertyId::BorderTopColor, PropertyId::BorderRightColor, PropertyId::BorderBottomColor, PropertyId::BorderLeftColor}},
+    {"border-radius",      ShorthandType::Box,        {PropertyId::BorderTopLeftRadius, PropertyId::BorderTopRightRadius, PropertyId::BorderBottomRightRadius, PropertyId::BorderBottomLeftRadius}},
+    {"overflow",           ShorthandType::Pair,       {PropertyId::OverflowX, PropertyId::OverflowY}},
+    {"gap",                ShorthandType::Pair,       {PropertyId::RowGap, PropertyId::ColumnGap}},
+    {"perspective-origin", ShorthandType::Origin,     {PropertyId::PerspectiveOriginX, PropertyId::PerspectiveOriginY}},
+    {"transform-origin",   ShorthandType::Origin,     {PropertyId::TransformOriginX, PropertyId::TransformOriginY, PropertyId::TransformOriginZ}},
+    {"flex",               ShorthandType::Flex,       {PropertyId::FlexGrow, PropertyId::FlexShrink, PropertyId::FlexBasis}},
+    {"border",             ShorthandType::Border,     {PropertyId::BorderTopWidth, PropertyId::BorderRightWidth, PropertyId::BorderBottomWidth, PropertyId::BorderLeftWidth,
+                                                       PropertyId::BorderTopColor, PropertyId::BorderRightColor, PropertyId::BorderBottomColor, PropertyId::BorderLeftColor}},
+    {"background",         ShorthandType::Background, {PropertyId::BackgroundColor}},
+    {"grid-column",        ShorthandType::GridLine,   {PropertyId::GridColumnStart, PropertyId::GridColumnEnd}},
+    {"grid-row",           ShorthandType::GridLine,   {PropertyId::GridRowStart, PropertyId::GridRowEnd}},
+  };
+  // clang-format on
+
+  nsUInt32 GetLonghandCount(const ShorthandInfo& in_shorthand)
+  {
+    nsUInt32 uiCount = 0;
+    while (uiCount < NS_ARRAY_SIZE(in_shorthand.m_Longhands) && in_shorthand.m_Longhands[uiCount] != PropertyId::Invalid)
+      ++uiCount;
+    return uiCount;
+  }
+
+  nsResult ExpandShorthand(
+    const ShorthandInfo& in_shorthand, std::string_view in_value, const nsHybridArray<ValueComponent, 4>& in_components, CSSValue* out_pValues, CSSStringTable& inout_strings)
+  {
+    const nsUInt32 uiCount = in_components.GetCount();
+    auto parse = [&](PropertyId id, const ValueComponent& component, CSSValue& out) {
+      return ParseComponent(CSSPropertyTable::GetInfo(id), component, out);
+    };
+
+    switch (in_shorthand.m_Type)
+    {
+      case ShorthandType::Box:
+      {
+        if (uiCount < 1 || uiCount > 4)
+          return NS_FAILURE;
+        // top, right = top, bottom = top, left = right
+        constexpr nsUInt32 sourceIndex[4][4] = {{0, 0, 0, 0}, {0, 1, 0, 1}, {0, 1, 2, 1}, {0, 1, 2, 3}};
+        for (nsUInt32 i = 0; i < 4; ++i)
+        {
+          NS_SUCCEED_OR_RETURN(parse(in_shorthand.m_Longhands[i], in_components[sourceIndex[uiCount - 1][i]], out_pValues[i]));
+        }
+        return NS_SUCCESS;
+      }
+
+      case ShorthandType::Pair:
+      {
+        if (uiCount < 1 || uiCount > 2)
+          return NS_FAILURE;
+        NS_SUCCEED_OR_RETURN(parse(in_shorthand.m_Longhands[0], in_components[0], out_pValues[0]));
+        return parse(in_shorthand.m_Longhands[1], in_components[uiCount - 1], out_pValues[1]);
+      }
+
+      case ShorthandType::Origin:
+      {
+        const nsUInt32 uiLonghands = GetLonghandCount(in_shorthand);
+        if (uiCount < 1 || uiCount > uiLonghands)
+          return NS_FAILURE;
+        for (nsUInt32 i = 0; i < uiLonghands; ++i)
+        {
+          if (i >= uiCount)
+          {
+            out_pValues[i] = i < 2 ? CSSValue::MakeNumeric(50.0f, core::Unit::PERCENT) : CSSValue::MakeNumeric(0.0f, core::Unit::PX);
+            continue;
+          }
+          if (i < 2 && ParseOriginKeyword(in_components[i].m_Text, out_pValues[i]))
+            continue;
+          NS_SUCCEED_OR_RETURN(parse(in_shorthand.m_Longhands[i], in_components[i], out_pValues[i]));
+        }
+        return NS_SUCCESS;
+      }
+
+      case ShorthandType::Flex:
+      {
+        // none = 0 0 auto, auto = 1 1 auto, <grow> [<shrink>] [<basis>] with basis defaulting to 0%.
+        if (uiCount == 1 && in_components[0].m_FirstToken.m_Type == CSSTokenType::Ident)
+        {
+          const bool bNone = IsEqualNoCase(in_components[0].m_Text, "none");
+          if (!bNone && !IsEqualNoCase(in_components[0].m_Text, "auto"))
+            return NS_FAILURE;
+          out_pValues[0] = CSSValue::MakeNumeric(bNone ? 0.0f : 1.0f, core::Unit::NUMBER);
+          out_pValues[1] = CSSValue::MakeNumeric(bNone ? 0.0f : 1.0f, core::Unit::NUMBER);
+          out_pValues[2] = CSSValue::MakeKeyword(CSSPropertyTable::GetKeywords().m_Auto);
+          return NS_SUCCESS;
+        }
+
+        out_pValues[0] = CSSValue::MakeNumeric(1.0f, core::Unit::NUMBER);
+        out_pValues[1] = CSSValue::MakeNumeric(1.0f, core::Unit::NUMBER);
+        out_pValues[2] = CSSValue::MakeNumeric(0.0f, core::Unit::PERCENT);
+
+        nsUInt32 uiNumbers = 0;
+        bool bHasBasis = false;
+        for (const ValueComponent& component : in_components)
+        {
+          if (component.m_FirstToken.m_Type == CSSTokenType::Number && component.m_uiTokenCount == 1 && uiNumbers < 2)
+          {
+            out_pValues[uiNumbers++] = CSSValue::MakeNumeric(static_cast<float>(component.m_FirstToken.m_fNumber), core::Unit::NUMBER);
+          }
+          else if (!bHasBasis)
+          {
+            NS_SUCCEED_OR_RETURN(parse(PropertyId::FlexBasis, component, out_pValues[2]));
+            bHasBasis = true;
+          }
+          else
+          {
+            return NS_FAILURE;
+          }
+        }
+        return uiCount > 0 ? NS_SUCCESS : NS_FAILURE;
+      }
+
+      case ShorthandType::Border:
+      {
+        // <width> || <style> || <color>. Border styles are not supported, they are accepted and ignored.
+        CSSValue width = CSSValue::MakeNumeric(0.0f, core::Unit::PX);
+        CSSValue color = CSSValue::MakeKeyword(CSSPropertyTable::GetKeywords().m_CurrentColor);
+        if (uiCount < 1 || uiCount > 3)
+          return NS_FAILURE;
+
+        for (const ValueComponent& component : in_components)
+        {
+          if (parse(PropertyId::BorderTopWidth, component, width).Succeeded())
+            continue;
+          nsUInt32 uiRGBA = 0;
+          if (CSSPropertyTable::ParseColor(component.m_Text, uiRGBA).Succeeded())
+          {
+            color = CSSValue::MakeColor(uiRGBA);
+            continue;
+          }
+          if (component.m_FirstToken.m_Type != CSSTokenType::Ident || component.m_uiTokenCount != 1)
+            return NS_FAILURE;
+          if (IsEqualNoCase(component.m_Text, "none") || IsEqualNoCase(component.m_Text, "hidden"))
+            width = CSSValue::MakeNumeric(0.0f, core::Unit::PX);
+        }
+
+        for (nsUInt32 i = 0; i < 4; ++i)
+        {
+          out_pValues[i] = width;
+          out_pValues[i + 4] = color;
+        }
+        return NS_SUCCESS;
+      }
+
+      case ShorthandType::Background:
+      {
+        // Only the color layer is supported.
+        if (uiCount != 1)
+          return NS_FAILURE;
+        return parse(PropertyId::BackgroundColor, in_components[0], out_pValues[0]);
+      }
+
+      case ShorthandType::GridLine:
+      {
+        const size_t uiSlash = in_value.find('/');
+        const std::string_view start = Trim(in_value.substr(0, uiSlash));
+        const std::string_view end = uiSlash == std::string_view::npos ? std::string_view("auto") : Trim(in_value.substr(uiSlash + 1));
+        if (start.empty() || end.empty())
+          return NS_FAILURE;
+        out_pValues[0] = CSSValue::MakeString(inout_strings.Add(start));
+        out_pValues[1] = CSSValue::MakeString(inout_strings.Add(end));
+        return NS_SUCCESS;
+      }
+    }
+    return NS_FAILURE;
+  }
+} // namespace
+
+PropertyId CSSPropertyTable::FindProperty(std::string_view in_name)
+{
+  nsStringBuilder sLowerName;
+  sLowerName.Append(nsStringView(in_name.data(), in_name.data() + in_name.size()));
+  sLowerName.ToLower();
+
+  nsUInt8 uiId = 0;
+  if (GetPropertyNameTable().m_NameToId.TryGetValue(sLowerName, uiId))
+    return static_cast<PropertyId>(uiId);
+  return PropertyId::Invalid;
+}
+
+bool CSSPropertyTable::IsKnownProperty(std::string_view in_name)
+{
+  if (in_name.size() > 2 && in_name[0] == '-' && in_name[1] == '-')
+    return true;
+  if (FindProperty(in_name) != PropertyId::Invalid)
+    return true;
+
+  for (const ShorthandInfo& shorthand : s_Shorthands)
+  {
+    if (IsEqualNoCase(in_name, shorthand.m_szName))
+      return true;
+  }
+  return false;
+}
+
+const CSSPropertyInfo& CSSPropertyTable::GetInfo(PropertyId in_id)
+{
+  const nsUInt32 uiIndex = static_cast<nsUInt32>(in_id);
+  return uiIndex < NS_ARRAY_SIZE(s_Properties) ? s_Properties[uiIndex] : s_Properties[0];
+}
+
+const CSSValue& CSSPropertyTable::GetInitialValue(PropertyId in_id)
+{
+  const PropertyNameTable& table = GetPropertyNameTable();
+  const nsUInt32 uiIndex = static_cast<nsUInt32>(in_id);
+  return table.m_InitialValues[uiIndex < table.m_InitialValues.GetCount() ? uiIndex : 0];
+}
+
+const CSSStringTable& CSSPropertyTable::GetInitialStrings()
+{
+  return GetPropertyNameTable().m_InitialStrings;
+}
+
+nsResult CSSPropertyTable::ParseDeclaration(
+  std::string_view in_name, std::string_view in_value, bool in_bImportant, nsDynamicArray<CSSDeclaration>& out_declarations, CSSStringTable& inout_strings)
+{
+  const std::string_view value = Trim(in_value);
+  if (value.empty())
+    return NS_FAILURE;
+
+  CSSWideKeyword wideKeyword = CSSWideKeyword::None;
+  if (IsEqualNoCase(value, "inherit"))
+    wideKeyword = CSSWideKeyword::Inherit;
+  else if (IsEqualNoCase(value, "initial"))
+    wideKeyword = CSSWideKeyword::Initial;
+  else if (IsEqualNoCase(value, "unset"))
+    wideKeyword = CSSWideKeyword::Unset;
+
+  // Values with var() references can only be parsed once the custom properties are known, they are kept as text.
+  const bool bHasVariables = wideKeyword == CSSWideKeyword::None && CSSVarFunction::ContainsVariables(value);
+  const core::Atom pendingName = bHasVariables ? core::AtomTable::Get().InternLowercase(in_name) : core::InvalidAtom;
+
+  // The longhands of a shorthand share the text, it is only added once the name turned out to be valid.
+  nsUInt32 uiPendingText = 0xFFFFFFFF;
+
+  auto append = [&](PropertyId id, const CSSValue& parsed) {
+    if (bHasVariables && uiPendingText == 0xFFFFFFFF)
+      uiPendingText = inout_strings.Add(value);
+
+    CSSDeclaration declaration;
+    declaration.m_Property = id;
+    declaration.m_WideKeyword = wideKeyword;
+    declaration.m_bImportant = in_bImportant;
+    declaration.m_bHasVariables = bHasVariables;
+    declaration.m_Value = bHasVariables ? CSSValue::MakeString(uiPendingText) : parsed;
+    declaration.m_Name = pendingName;
+    out_declarations.PushBack(declaration);
+  };
+
+  // Custom properties take any value. The name is case-sensitive.
+  if (in_name.size() > 2 && in_name[0] == '-' && in_name[1] == '-')
+  {
+    CSSDeclaration declaration;
+    declaration.m_WideKeyword = wideKeyword;
+    declaration.m_bImportant = in_bImportant;
+    declaration.m_bHasVariables = bHasVariables;
+    declaration.m_Value = CSSValue::MakeString(inout_strings.Add(value));
+    declaration.m_Name = core::MakeAtom(in_name);
+    out_declarations.PushBack(declaration);
+    return NS_SUCCESS;
+  }
+
+  const PropertyId id = FindProperty(in_name);
+  if (id != PropertyId::Invalid)
+  {
+    CSSValue parsed;
+    if (wideKeyword == CSSWideKeyword::None && !bHasVariables)
+      NS_SUCCEED_OR_RETURN(ParseValue(id, value, parsed, inout_strings));
+    append(id, parsed);
+    return NS_SUCCESS;
+  }
+
+  for (const ShorthandInfo& shorthand : s_Shorthands)
+  {
+    if (!IsEqualNoCase(in_name, shorthand.m_szName))
+      continue;
+
+    CSSValue values[NS_ARRAY_SIZE(shorthand.m_Longhands)];
+    if (wideKeyword == CSSWideKeyword::None && !bHasVariables)
+    {
+      nsHybridArray<ValueComponent, 4> components;
+      SplitComponents(value, components);
+      NS_SUCCEED_OR_RETURN(ExpandShorthand(shorthand, value, components, values, inout_strings));
+    }
+
+    const nsUInt32 uiLonghands = GetLonghandCount(shorthand);
+    for (nsUInt32 i = 0; i < uiLonghands; ++i)
+    {
+      append(shorthand.m_Longhands[i], values[i]);
+    }
+    return NS_SUCCESS;
+  }
+
+  return NS_FAILURE;
+}
+
+nsResult CSSPropertyTable::ParseValue(PropertyId in_id, std::string_view in_value, CSSValue& out_value, CSSStringTable& inout_strings)
+{
+  const CSSPropertyInfo& info = GetInfo(in_id);
+  const std::string_view value = Trim(in_value);
+  if (info.m_Id == PropertyId::Invalid || value.empty())
+    return NS_FAILURE;
+
+  if ((info.m_uiKinds & CSSValueKind::Raw) != 0)
+  {
+    out_value = CSSValue::MakeString(inout_strings.Add(value));
+    return NS_SUCCESS;
+  }
+
+  nsHybridArray<ValueComponent, 4> components;
+  SplitComponents(value, components);
+  if (components.GetCount() != 1)
+    return NS_FAILURE;
+
+  if ((in_id == PropertyId::TransformOriginX || in_id == PropertyId::TransformOriginY || in_id == PropertyId::PerspectiveOriginX ||
+        in_id == PropertyId::PerspectiveOriginY) &&
+      ParseOriginKeyword(value, out_value))
+  {
+    return NS_SUCCESS;
+  }
+
+  return ParseComponent(info, components[0], out_value);
+}
+
+nsResult CSSPropertyTable::ParseNumeric(std::string_view in_value, CSSValue& out_value)
+{
+  static constexpr CSSPropertyInfo s_NumericInfo = {"", PropertyId::Invalid, CSSValueKind::Length | CSSValueKind::Percent | CSSValueKind::Number, false, ""};
+
+  nsHybridArray<ValueComponent, 4> components;
+  SplitComponents(Trim(in_value), components);
+  if (components.GetCount() != 1)
+    return NS_FAILURE;
+
+  return ParseComponent(s_NumericInfo, components[0], out_value);
+}
+
+nsResult CSSPropertyTable::ParseColor(std::string_view in_value, nsUInt32& out_uiRGBA)
+{
+  const std::string_view value = Trim(in_value);
+  if (value.empty())
+    return NS_FAILURE;
+
+  if (value[0] == '#')
+  {
+    const std::string_view hex = value.substr(1);
+    if (hex.size() != 3 && hex.size() != 4 && hex.size() != 6 && hex.size() != 8)
+      return NS_FAILURE;
+
+    nsUInt32 digits[8] = {};
+    for (size_t i = 0; i < hex.size(); ++i)
+    {
+      const char c = static_cast<char>(nsStringUtils::ToLowerChar(hex[i]));
+      if (c >= '0' && c <= '9')
+        digits[i] = c - '0';
+      else if (c >= 'a' && c <= 'f')
+        digits[i] = c - 'a' + 10;
+      else
+        return NS_FAILURE;
+    }
+
+    nsUInt32 channels[4] = {0, 0, 0, 255};
+    const bool bShort = hex.size() <= 4;
+    const size_t uiChannels = bShort ? hex.size() : hex.size() / 2;
+    for (size_t i = 0; i < uiChannels; ++i)
+    {
+      channels[i] = bShort ? digits[i] * 17 : digits[i * 2] * 16 + digits[i * 2 + 1];
+    }
+    out_uiRGBA = channels[0] | (channels[1] << 8) | (channels[2] << 16) | (channels[3] << 24);
+    return NS_SUCCESS;
+  }
+
+  if (value.size() > 4 && (IsEqualNoCase(value.substr(0, 4), "rgb(") || IsEqualNoCase(value.substr(0, 5), "rgba(")))
+  {
+    return ParseRGBFunction(value, out_uiRGBA);
+  }
+
+  for (const NamedColor& color : s_NamedColors)
+  {
+    if (IsEqualNoCase(value, color.m_szName))
+    {
+      out_uiRGBA = color.m_uiRGBA;
+      return NS_SUCCESS;
+    }
+  }
+  return NS_FAILURE;
+}
+
+const CSSPropertyTable::Keywords& CSSPropertyTable::GetKeywords()
+{
+  static const Keywords s_Keywords = {core::MakeAtom("auto"), core::MakeAtom("none"), core::MakeAtom("normal"), core::MakeAtom("currentcolor")};
+  return s_Keywords;
+}
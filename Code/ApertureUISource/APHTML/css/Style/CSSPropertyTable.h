@@ -0,0 +1,122 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/css/Style/CSSStringTable.h>
+#include <APHTML/css/Style/CSSValue.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <string_view>
+
+namespace aperture::css
+{
+  /// @brief Value types a property accepts, combined as bit flags.
+  struct CSSValueKind
+  {
+    using StorageType = nsUInt8;
+
+    enum Enum : StorageType
+    {
+      Length = NS_BIT(0),
+      Percent = NS_BIT(1),
+      Number = NS_BIT(2),
+      Color = NS_BIT(3),
+      Keyword = NS_BIT(4),
+      /// @brief The value is kept as text, for properties whose values are not parsed yet.
+      Raw = NS_BIT(5),
+
+      LengthPercent = Length | Percent,
+    };
+  };
+
+  struct CSSPropertyInfo
+  {
+    const char* m_szName;
+    PropertyId m_Id;
+    CSSValueKind::StorageType m_uiKinds;
+    bool m_bInherited;
+    const char* m_szInitialValue;
+  };
+
+  /*
+   * @brief Static description of the properties in aperture::PropertyId, and parsing of declaration values.
+   *
+   * Shorthands (margin, padding, border, flex, ...) only exist at parse time, ParseDeclaration() expands them into longhands.
+   */
+  class NS_APERTURE_DLL CSSPropertyTable
+  {
+  public:
+    /// @brief Returns the longhand property with the name, or PropertyId::Invalid.
+    static PropertyId FindProperty(std::string_view in_name);
+
+    /// @brief Whether the name is a longhand, a shorthand or a custom property, i.e. ParseDeclaration() only fails on its value.
+    static bool IsKnownProperty(std::string_view in_name);
+
+    static const CSSPropertyInfo& GetInfo(PropertyId in_id);
+    static bool IsInherited(PropertyId in_id) { return GetInfo(in_id).m_bInherited; }
+
+    /// @brief The parsed initial value of a property.
+    static const CSSValue& GetInitialValue(PropertyId in_id);
+
+    /// @brief The text of initial values that are STRING values.
+    static const CSSStringTable& GetInitialStrings();
+
+    /// @brief Parses a declaration and appends the resulting longhand declarations.
+    /// Custom properties and values with var() references are appended unparsed, see CSSDeclaration.
+    /// @param in_value The value without the "!important" flag.
+    /// @param inout_strings Receives the text of STRING values, the declarations store indices into it.
+    /// @return NS_FAILURE for unknown properties or invalid values, in which case nothing is appended.
+    static nsResult ParseDeclaration(
+      std::string_view in_name, std::string_view in_value, bool in_bImportant, nsDynamicArray<CSSDeclaration>& out_declarations, CSSStringTable& inout_strings);
+
+    /// @brief Parses the value of a single longhand. The text of a STRING value is added to inout_strings.
+    static nsResult ParseValue(PropertyId in_id, std::string_view in_value, CSSValue& out_value, CSSStringTable& inout_strings);
+
+    /// @brief Parses a single number, percentage or dimension with a known unit.
+    static nsResult ParseNumeric(std::string_view in_value, CSSValue& out_value);
+
+    /// @brief Parses hex, named and rgb()/rgba() colors into RGBA8.
+    static nsResult ParseColor(std::string_view in_value, nsUInt32& out_uiRGBA);
+
+    /// @brief Frequently compared keywords, interned once.
+    struct Keywords
+    {
+      core::Atom m_Auto;
+      core::Atom m_None;
+      core::Atom m_Normal;
+      core::Atom m_CurrentColor;
+    };
+    static const Keywords& GetKeywords();
+  };
+} // namespace aperture::css
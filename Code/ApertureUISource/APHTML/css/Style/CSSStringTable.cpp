@@ -0,0 +1,53 @@
+#include <APHTML/css/Style/CSSStringTable.h>
+#include <Foundation/Algorithm/HashingUtils.h>
+
+using namespace aperture;
+using namespace aperture::css;
+
+nsUInt32 CSSStringTable::Add(std::string_view in_text)
+{
+  Entry& entry = m_Entries.ExpandAndGetRef();
+  entry.m_uiOffset = m_Text.GetCount();
+  entry.m_uiLength = static_cast<nsUInt32>(in_text.size());
+
+  // The text may be a entry of this table, growing the buffer would move it.
+  const char* pText = in_text.data();
+  if (!m_Text.IsEmpty() && pText >= m_Text.GetData() && pText < m_Text.GetData() + m_Text.GetCount())
+  {
+    const nsUInt32 uiOffset = static_cast<nsUInt32>(pText - m_Text.GetData());
+    m_Text.Reserve(m_Text.GetCount() + entry.m_uiLength);
+    pText = m_Text.GetData() + uiOffset;
+  }
+  m_Text.PushBackRange(nsArrayPtr<const char>(pText, entry.m_uiLength));
+  return m_Entries.GetCount() - 1;
+}
+
+void CSSStringTable::Clear()
+{
+  m_Entries.Clear();
+  m_Text.Clear();
+}
+
+nsUInt64 CSSStringTable::GetHash(nsUInt64 in_uiSeed) const
+{
+  // The lengths separate the texts, "ab" + "c" must not hash like "a" + "bc".
+  nsUInt64 uiHash = in_uiSeed;
+  for (const Entry& entry : m_Entries)
+  {
+    uiHash = nsHashingUtils::xxHash64(&entry.m_uiLength, sizeof(entry.m_uiLength), uiHash);
+  }
+  return nsHashingUtils::xxHash64(m_Text.GetData(), m_Text.GetCount(), uiHash);
+}
+
+bool CSSStringTable::operator==(const CSSStringTable& in_other) const
+{
+  if (m_Entries.GetCount() != in_other.m_Entries.GetCount())
+    return false;
+
+  for (nsUInt32 i = 0; i < m_Entries.GetCount(); ++i)
+  {
+    if (Get(i) != in_other.Get(i))
+      return false;
+  }
+  return true;
+}
@@ -32,85 +32,56 @@ STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
 ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
 EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
-
 #pragma once
 
 #include <APHTML/APEngineCommonIncludes.h>
-#include <APHTML/layout/Core/LayoutNode.h>
-#include <vector>
-#include <yoga/Yoga.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <string_view>
 
-namespace aperture::layout
+namespace aperture::css
 {
-  /**
-   * @class InlineContainer
-   * @brief Manages a collection of inline items, handling layout calculations.
+  /*
+   * @brief The text of STRING values (see CSSValue), owned by whatever holds the values.
+   *
+   * Raw values, var() references and custom properties are arbitrary author text. Interning them as atoms would keep
+   * every value ever parsed or substituted alive for the lifetime of the process, so the sheet, computed style or
+   * animation that holds such values keeps their text in a table of its own and the value only stores the index.
+   * An index is only meaningful together with the table it came from, the text is released with the table.
    *
-   * The InlineContainer class provides functionality to add items with specific dimensions and margins,
-   * set container dimensions and padding.
+   * Entries are never deduplicated or removed individually, owners that replace values rebuild their table.
    */
-  class NS_APERTURE_DLL InlineContainer : public LayoutNode
+  class NS_APERTURE_DLL CSSStringTable
   {
   public:
-    InlineContainer(const Style& style)
-      : LayoutNode(style)
+    /// @brief Appends a copy of the text and returns its index.
+    nsUInt32 Add(std::string_view in_text);
+
+    std::string_view Get(nsUInt32 in_uiIndex) const
     {
+      const Entry& entry = m_Entries[in_uiIndex];
+      return std::string_view(m_Text.GetData() + entry.m_uiOffset, entry.m_uiLength);
     }
 
-    InlineContainer() {}
+    nsUInt32 GetCount() const { return m_Entries.GetCount(); }
+    bool IsEmpty() const { return m_Entries.IsEmpty(); }
+    void Clear();
 
-    void addChild(std::shared_ptr<LayoutNode> child) override
-    {
-      children_.push_back(child);
-    }
+    /// @brief Hashes the texts in order, tables with the same texts at the same indices hash the same.
+    nsUInt64 GetHash(nsUInt64 in_uiSeed = 0) const;
 
-    void calculateLayout(float width, float height) override
-    {
-      size_.width = width;
-      size_.height = height;
-      calculateInlineLayout(width);
-    }
+    bool operator==(const CSSStringTable& in_other) const;
+    bool operator!=(const CSSStringTable& in_other) const { return !(*this == in_other); }
 
   private:
-    void calculateInlineLayout(float containerWidth)
+    struct Entry
     {
-      float xOffset = 0.0f;
-      float yOffset = 0.0f;
-      float lineHeight = 0.0f;
-
-      for (auto& child : children_)
-      {
-        if (xOffset + child->size_.width > containerWidth)
-        {
-          xOffset = 0.0f; // Move to the next line
-          yOffset += lineHeight;
-          lineHeight = 0.0f;
-        }
+      NS_DECLARE_POD_TYPE();
 
-        child->position_ = {xOffset, yOffset};
-        xOffset += child->size_.width;
-        lineHeight = std::max(lineHeight, child->size_.height);
-      }
+      nsUInt32 m_uiOffset;
+      nsUInt32 m_uiLength;
+    };
 
-      size_.height = yOffset + lineHeight; // Adjust container height
-    }
-
-  public:
-    void layout(float width, float height)
-    {
-      calculateLayout(width, height);
-    }
-
-    void printLayout()
-    {
-      for (const auto& child : children_)
-      {
-        nsLog::Info("Child: Left={0}, Top={1}, Width={3}, Height={4}",
-          child->position_.x,
-          child->position_.y,
-          child->size_.width,
-          child->size_.height);
-      }
-    }
+    nsDynamicArray<Entry> m_Entries;
+    nsDynamicArray<char> m_Text;
   };
-} // namespace aperture::layout
\ No newline at end of file
+} // namespace aperture::css
@@ -0,0 +1,965 @@
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <APHTML/css/Selector/CSSSelectorParser.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/IO/ChunkStream.h>
+#include <Foundation/IO/FileSystem/FileReader.h>
+#include <Foundation/IO/MemoryMappedFile.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/IO/StringDeduplicationContext.h>
+#include <Foundation/Profiling/Profiling.h>
+
+using namespace aperture;
+using namespace aperture::css;
+using namespace aperture::css::parser;
+
+namespace
+{
+  bool IsOpeningToken(CSSTokenType in_type)
+  {
+    return in_type == CSSTokenType::Function || in_type == CSSTokenType::OpenParen || in_type == CSSTokenType::OpenSquare || in_type == CSSTokenType::OpenCurly;
+  }
+
+  bool IsClosingToken(CSSTokenType in_type)
+  {
+    return in_type == CSSTokenType::CloseParen || in_type == CSSTokenType::CloseSquare || in_type == CSSTokenType::CloseCurly;
+  }
+
+  /// Returns the index of the first token of the given type at nesting depth 0, starting at in_uiStart, or the token count.
+  nsUInt32 FindAtDepthZero(const nsDynamicArray<CSSToken>& in_tokens, nsUInt32 in_uiStart, CSSTokenType in_type, CSSTokenType in_stopType = CSSTokenType::EndOfFile)
+  {
+    nsUInt32 uiDepth = 0;
+    for (nsUInt32 i = in_uiStart; i < in_tokens.GetCount(); ++i)
+    {
+      const CSSTokenType type = in_tokens[i].m_Type;
+      if (uiDepth == 0 && (type == in_type || type == in_stopType))
+        return i;
+      if (IsOpeningToken(type))
+        ++uiDepth;
+      else if (IsClosingToken(type) && uiDepth > 0)
+        --uiDepth;
+    }
+    return in_tokens.GetCount();
+  }
+
+  nsUInt32 GetTokenEnd(const nsDynamicArray<CSSToken>& in_tokens, nsUInt32 in_uiIndex, std::string_view in_source)
+  {
+    return in_uiIndex < in_tokens.GetCount() ? in_tokens[in_uiIndex].m_uiOffset : static_cast<nsUInt32>(in_source.size());
+  }
+
+  /// The source text of a token, unlike its value this points into the source.
+  std::string_view GetTokenText(const nsDynamicArray<CSSToken>& in_tokens, nsUInt32 in_uiIndex, std::string_view in_source)
+  {
+    const nsUInt32 uiStart = in_tokens[in_uiIndex].m_uiOffset;
+    return in_source.substr(uiStart, GetTokenEnd(in_tokens, in_uiIndex + 1, in_source) - uiStart);
+  }
+
+  bool IsEqualNoCase(std::string_view in_a, std::string_view in_b)
+  {
+    if (in_a.size() != in_b.size())
+      return false;
+    for (size_t i = 0; i < in_a.size(); ++i)
+    {
+      if (nsStringUtils::ToLowerChar(in_a[i]) != nsStringUtils::ToLowerChar(in_b[i]))
+        return false;
+    }
+    return true;
+  }
+
+  constexpr const char* AtomsChunkName = "Atoms";
+  constexpr nsUInt32 AtomsChunkVersion = 1;
+  constexpr const char* RulesChunkName = "Rules";
+  constexpr nsUInt32 RulesChunkVersion = 2;
+  constexpr const char* SelectorsChunkName = "Selectors";
+  constexpr nsUInt32 SelectorsChunkVersion = 1;
+  constexpr const char* DeclarationsChunkName = "Declarations";
+  constexpr nsUInt32 DeclarationsChunkVersion = 2;
+  constexpr const char* MediaBlocksChunkName = "MediaBlocks";
+  constexpr nsUInt32 MediaBlocksChunkVersion = 1;
+  constexpr const char* KeyframesChunkName = "Keyframes";
+  constexpr nsUInt32 KeyframesChunkVersion = 1;
+  constexpr const char* StringsChunkName = "Strings";
+  constexpr nsUInt32 StringsChunkVersion = 1;
+
+  constexpr nsUInt32 PropertyCount = static_cast<nsUInt32>(PropertyId::NumDefinedIds);
+
+  /// Declarations store PropertyId values, they only mean the same thing with the property table the sheet was compiled
+  /// against. Properties that are renamed, reordered, added or removed all change the hash.
+  nsUInt64 GetPropertyTableHash()
+  {
+    static const nsUInt64 s_uiHash = []() {
+      nsUInt64 uiHash = 0;
+      for (nsUInt32 i = 0; i < PropertyCount; ++i)
+      {
+        // The terminator separates the names, "a" + "bc" must not hash like "ab" + "c".
+        const char* szName = CSSPropertyTable::GetInfo(static_cast<PropertyId>(i)).m_szName;
+        uiHash = nsHashingUtils::xxHash64(szName, nsStringUtils::GetStringElementCount(szName) + 1, uiHash);
+      }
+      return uiHash;
+    }();
+    return s_uiHash;
+  }
+
+  /// No sheet comes anywhere near this many elements of any kind, a larger count is a corrupted file.
+  constexpr nsUInt32 MaxElementCount = 1u << 24;
+
+  /// The smallest number of bytes each element takes in its chunk, counts are validated against these.
+  constexpr nsUInt32 StringBytes = sizeof(nsUInt32);
+  constexpr nsUInt32 RuleBytes = 5 * sizeof(nsUInt32);
+  constexpr nsUInt32 MediaBlockBytes = 3 * sizeof(nsUInt32);
+  constexpr nsUInt32 SelectorBytes = 1 + 2 * sizeof(nsUInt32);
+  constexpr nsUInt32 CompoundBytes = 2 * sizeof(nsUInt16) + 1;
+  constexpr nsUInt32 SimpleSelectorBytes = 4 + 4 * sizeof(nsUInt32) + 2 * StringBytes;
+  constexpr nsUInt32 DeclarationBytes = 4 + 4 * sizeof(nsUInt32);
+  constexpr nsUInt32 KeyframesRuleBytes = 3 * sizeof(nsUInt32);
+  constexpr nsUInt32 KeyframeBytes = 3 * sizeof(nsUInt32);
+
+  /// Reads the fields of one chunk of a precompiled sheet. Sheets are untrusted input, so the chunk is read up front and
+  /// reading past its end marks the reader as failed where operator>> would assert.
+  class ChunkDataReader
+  {
+  public:
+    /// @brief Reads the rest of the current chunk, fails if the stream ends before the chunk does.
+    nsResult Begin(nsChunkStreamReader& inout_chunks)
+    {
+      // The size in the chunk header isn't trusted either, the buffer only grows with data that is actually there.
+      constexpr nsUInt32 BlockBytes = 64 * 1024;
+      nsUInt32 uiRemaining = inout_chunks.GetCurrentChunk().m_uiUnreadChunkBytes;
+      m_Data.Clear();
+      m_bFailed = false;
+      while (uiRemaining > 0 && !m_bFailed)
+      {
+        const nsUInt32 uiBlock = nsMath::Min(uiRemaining, BlockBytes);
+        const nsUInt32 uiOffset = m_Data.GetCount();
+        m_Data.SetCountUninitialized(uiOffset + uiBlock);
+        m_bFailed = inout_chunks.ReadBytes(m_Data.GetData() + uiOffset, uiBlock) != uiBlock;
+        uiRemaining -= uiBlock;
+      }
+      m_Reader.Reset(m_Data.GetData(), m_Data.GetCount());
+      return m_bFailed ? NS_FAILURE : NS_SUCCESS;
+    }
+
+    template <typename T>
+    ChunkDataReader& operator>>(T& out_value)
+    {
+      static_assert(std::is_arithmetic_v<T>);
+      if constexpr (std::is_same_v<T, bool>)
+      {
+        nsUInt8 uiValue = 0;
+        m_bFailed |= m_Reader.ReadBytes(&uiValue, sizeof(nsUInt8)) != sizeof(nsUInt8);
+        out_value = uiValue != 0;
+      }
+      else if constexpr (sizeof(T) == 1)
+        m_bFailed |= m_Reader.ReadBytes(&out_value, sizeof(T)) != sizeof(T);
+      else if constexpr (sizeof(T) == 2)
+        m_bFailed |= m_Reader.ReadWordValue(&out_value).Failed();
+      else if constexpr (sizeof(T) == 4)
+        m_bFailed |= m_Reader.ReadDWordValue(&out_value).Failed();
+      else
+        m_bFailed |= m_Reader.ReadQWordValue(&out_value).Failed();
+      return *this;
+    }
+
+    void ReadString(nsStringBuilder& out_sValue)
+    {
+      // Deduplicated or not, a string starts with a 32 bit index or length.
+      m_bFailed |= GetRemainingBytes() < StringBytes || m_Reader.ReadString(out_sValue).Failed();
+    }
+
+    /// @brief Whether in_uiCount elements of at least in_uiElementBytes each can be in the rest of the chunk.
+    bool IsValidCount(nsUInt32 in_uiCount, nsUInt32 in_uiElementBytes) const
+    {
+      return in_uiCount <= MaxElementCount && nsUInt64(in_uiCount) * in_uiElementBytes <= GetRemainingBytes();
+    }
+
+    nsUInt64 GetRemainingBytes() const { return m_Reader.GetByteCount() - m_Reader.GetReadPosition(); }
+    nsStreamReader& GetStream() { return m_Reader; }
+    bool HasFailed() const { return m_bFailed; }
+
+  private:
+    nsDynamicArray<nsUInt8> m_Data;
+    nsRawMemoryStreamReader m_Reader;
+    bool m_bFailed = false;
+  };
+
+  /// Only keyword values store an atom, string values store an index into the string table of the sheet. See CSSValue.
+  bool HasAtomData(core::Unit in_unit)
+  {
+    return in_unit == core::Unit::KEYWORD;
+  }
+
+  /// Assigns the atoms of a sheet their index in the string table of the binary form. Index 0 is InvalidAtom.
+  struct AtomWriteTable
+  {
+    nsUInt32 Add(core::Atom in_atom)
+    {
+      if (in_atom == core::InvalidAtom)
+        return 0;
+
+      nsUInt32 uiIndex = 0;
+      if (!m_Indices.TryGetValue(in_atom, uiIndex))
+      {
+        m_Atoms.PushBack(in_atom);
+        uiIndex = m_Atoms.GetCount();
+        m_Indices.Insert(in_atom, uiIndex);
+      }
+      return uiIndex;
+    }
+
+    nsHashTable<core::Atom, nsUInt32> m_Indices;
+    nsDynamicArray<core::Atom> m_Atoms;
+  };
+
+  /// Maps string table indices back to atoms of this process, filled once per load.
+  struct AtomReadTable
+  {
+    nsResult Get(nsUInt32 in_uiIndex, core::Atom& out_atom) const
+    {
+      if (in_uiIndex > m_Atoms.GetCount())
+        return NS_FAILURE;
+      out_atom = in_uiIndex == 0 ? core::InvalidAtom : m_Atoms[in_uiIndex - 1];
+      return NS_SUCCESS;
+    }
+
+    nsDynamicArray<core::Atom> m_Atoms;
+  };
+
+  nsStringView ToStringView(const std::string& in_string)
+  {
+    return nsStringView(in_string.data(), static_cast<nsUInt32>(in_string.size()));
+  }
+} // namespace
+
+void CSSStyleSheet::ParseFromString(std::string_view in_source, std::string_view in_sourceName)
+{
+  ParseRuleList(in_source, NoMediaBlock, CSSDiagnosticSource{in_source, in_sourceName});
+}
+
+void CSSStyleSheet::ParseRuleList(std::string_view in_source, nsUInt32 in_uiMediaBlock, const CSSDiagnosticSource& in_diagnostics)
+{
+  nsDynamicArray<CSSToken> tokens;
+  CSSTokenizer::TokenizeAll(in_source, tokens);
+
+  nsUInt32 i = 0;
+  while (i < tokens.GetCount())
+  {
+    const CSSToken& token = tokens[i];
+    if (token.m_Type == CSSTokenType::Whitespace || token.m_Type == CSSTokenType::CDO || token.m_Type == CSSTokenType::CDC)
+    {
+      ++i;
+      continue;
+    }
+
+    if (token.m_Type == CSSTokenType::AtKeyword)
+    {
+      // At-rules end at the first semicolon or after their block.
+      const nsUInt32 uiEnd = FindAtDepthZero(tokens, i + 1, CSSTokenType::Semicolon, CSSTokenType::OpenCurly);
+      if (uiEnd >= tokens.GetCount() || tokens[uiEnd].m_Type != CSSTokenType::OpenCurly)
+      {
+        in_diagnostics.Report(CSSDiagnostic::UnsupportedAtRule, GetTokenText(tokens, i, in_source));
+        i = uiEnd + 1;
+        continue;
+      }
+
+      const nsUInt32 uiClose = FindAtDepthZero(tokens, uiEnd + 1, CSSTokenType::CloseCurly);
+      const nsUInt32 uiPreludeStart = i + 1 < tokens.GetCount() ? tokens[i + 1].m_uiOffset : static_cast<nsUInt32>(in_source.size());
+      const nsUInt32 uiBlockStart = tokens[uiEnd].m_uiOffset + 1;
+      const std::string_view prelude = in_source.substr(uiPreludeStart, tokens[uiEnd].m_uiOffset - uiPreludeStart);
+      const std::string_view block = in_source.substr(uiBlockStart, GetTokenEnd(tokens, uiClose, in_source) - uiBlockStart);
+      if (IsEqualNoCase(token.m_Value, "keyframes") || IsEqualNoCase(token.m_Value, "-webkit-keyframes"))
+      {
+        ParseKeyframes(prelude, block, in_diagnostics);
+      }
+      else if (IsEqualNoCase(token.m_Value, "media"))
+      {
+        // The query list is compiled once here, the resolver only evaluates it.
+        const nsUInt32 uiMediaBlock = m_MediaBlocks.GetCount();
+        MediaBlock& mediaBlock = m_MediaBlocks.ExpandAndGetRef();
+        mediaBlock.m_uiParent = in_uiMediaBlock;
+        const nsUInt32 uiInvalidQueries = mediaBlock.m_Queries.Parse(prelude);
+        if (uiInvalidQueries != 0)
+        {
+          m_uiParseErrors += uiInvalidQueries;
+          in_diagnostics.Report(CSSDiagnostic::InvalidMediaQuery, prelude);
+        }
+        ParseRuleList(block, uiMediaBlock, in_diagnostics);
+      }
+      else
+      {
+        in_diagnostics.Report(CSSDiagnostic::UnsupportedAtRule, GetTokenText(tokens, i, in_source));
+      }
+      i = uiClose + 1;
+      continue;
+    }
+
+    // Qualified rule: prelude up to the block, then the block.
+    const nsUInt32 uiOpen = FindAtDepthZero(tokens, i, CSSTokenType::OpenCurly);
+    if (uiOpen >= tokens.GetCount())
+    {
+      ++m_uiParseErrors;
+      in_diagnostics.Report(CSSDiagnostic::RuleWithoutBlock, in_source.substr(token.m_uiOffset));
+      break;
+    }
+    const nsUInt32 uiClose = FindAtDepthZero(tokens, uiOpen + 1, CSSTokenType::CloseCurly);
+
+    const std::string_view prelude = in_source.substr(token.m_uiOffset, tokens[uiOpen].m_uiOffset - token.m_uiOffset);
+    const nsUInt32 uiBlockStart = tokens[uiOpen].m_uiOffset + 1;
+    const std::string_view block = in_source.substr(uiBlockStart, GetTokenEnd(tokens, uiClose, in_source) - uiBlockStart);
+    i = uiClose + 1;
+
+    Rule rule;
+    rule.m_uiFirstSelector = m_Selectors.GetCount();
+    rule.m_uiFirstDeclaration = m_Declarations.GetCount();
+    rule.m_uiMediaBlock = in_uiMediaBlock;
+    if (CSSSelectorParser::ParseSelectorList(prelude, m_Selectors).Failed())
+    {
+      ++m_uiParseErrors;
+      in_diagnostics.Report(CSSDiagnostic::InvalidSelector, prelude);
+      continue;
+    }
+
+    m_uiParseErrors += ParseDeclarationList(block, m_Declarations, m_Strings, &in_diagnostics);
+    rule.m_uiSelectorCount = m_Selectors.GetCount() - rule.m_uiFirstSelector;
+    rule.m_uiDeclarationCount = m_Declarations.GetCount() - rule.m_uiFirstDeclaration;
+
+    // Rules without declarations can't affect anything, don't make the resolver match them.
+    if (rule.m_uiDeclarationCount == 0)
+    {
+      m_Selectors.SetCount(rule.m_uiFirstSelector);
+      continue;
+    }
+    m_Rules.PushBack(rule);
+  }
+}
+
+void CSSStyleSheet::ParseKeyframes(std::string_view in_prelude, std::string_view in_block, const CSSDiagnosticSource& in_diagnostics)
+{
+  nsDynamicArray<CSSToken> tokens;
+  CSSTokenizer::TokenizeAll(in_prelude, tokens, true);
+
+  // The name is a single identifier or string. "none" and the CSS-wide keywords can't be used as identifiers.
+  if (tokens.GetCount() != 1 || (tokens[0].m_Type != CSSTokenType::Ident && tokens[0].m_Type != CSSTokenType::String) || tokens[0].m_Value.empty() ||
+      (tokens[0].m_Type == CSSTokenType::Ident && (IsEqualNoCase(tokens[0].m_Value, "none") || IsEqualNoCase(tokens[0].m_Value, "inherit") ||
+                                                      IsEqualNoCase(tokens[0].m_Value, "initial") || IsEqualNoCase(tokens[0].m_Value, "unset"))))
+  {
+    ++m_uiParseErrors;
+    in_diagnostics.Report(CSSDiagnostic::InvalidKeyframes, in_prelude);
+    return;
+  }
+
+  KeyframesRule rule;
+  rule.m_Name = core::MakeAtom(tokens[0].m_Value);
+  rule.m_uiFirstKeyframe = m_Keyframes.GetCount();
+
+  tokens.Clear();
+  CSSTokenizer::TokenizeAll(in_block, tokens);
+  nsHybridArray<float, 4> offsets;
+  nsUInt32 i = 0;
+  while (i < tokens.GetCount())
+  {
+    if (tokens[i].m_Type == CSSTokenType::Whitespace)
+    {
+      ++i;
+      continue;
+    }
+
+    const nsUInt32 uiOpen = FindAtDepthZero(tokens, i, CSSTokenType::OpenCurly);
+    if (uiOpen >= tokens.GetCount())
+    {
+      ++m_uiParseErrors;
+      in_diagnostics.Report(CSSDiagnostic::RuleWithoutBlock, in_block.substr(tokens[i].m_uiOffset));
+      break;
+    }
+    const nsUInt32 uiClose = FindAtDepthZero(tokens, uiOpen + 1, CSSTokenType::CloseCurly);
+
+    // Keyframe selectors: from, to or percentages, comma separated.
+    offsets.Clear();
+    bool bValid = true;
+    bool bExpectOffset = true;
+    for (nsUInt32 t = i; t < uiOpen && bValid; ++t)
+    {
+      const CSSToken& token = tokens[t];
+      if (token.m_Type == CSSTokenType::Whitespace)
+        continue;
+
+      if (!bExpectOffset)
+      {
+        bValid = token.m_Type == CSSTokenType::Comma;
+        bExpectOffset = true;
+        continue;
+      }
+
+      if (token.m_Type == CSSTokenType::Ident && IsEqualNoCase(token.m_Value, "from"))
+        offsets.PushBack(0.0f);
+      else if (token.m_Type == CSSTokenType::Ident && IsEqualNoCase(token.m_Value, "to"))
+        offsets.PushBack(1.0f);
+      else if (token.m_Type == CSSTokenType::Percentage && token.m_fNumber >= 0.0 && token.m_fNumber <= 100.0)
+        offsets.PushBack(static_cast<float>(token.m_fNumber * 0.01));
+      else
+        bValid = false;
+      bExpectOffset = false;
+    }
+    bValid &= !offsets.IsEmpty() && !bExpectOffset;
+
+    const nsUInt32 uiBlockStart = tokens[uiOpen].m_uiOffset + 1;
+    const std::string_view block = in_block.substr(uiBlockStart, GetTokenEnd(tokens, uiClose, in_block) - uiBlockStart);
+    const std::string_view selectors = in_block.substr(tokens[i].m_uiOffset, tokens[uiOpen].m_uiOffset - tokens[i].m_uiOffset);
+    i = uiClose + 1;
+
+    if (!bValid)
+    {
+      ++m_uiParseErrors;
+      in_diagnostics.Report(CSSDiagnostic::InvalidKeyframes, selectors);
+      continue;
+    }
+
+    // Important declarations are ignored in keyframes, as are the animation properties themselves.
+    // Custom properties and var() references are not supported inside keyframes.
+    const nsUInt32 uiFirstDeclaration = m_Declarations.GetCount();
+    m_uiParseErrors += ParseDeclarationList(block, m_Declarations, m_Strings, &in_diagnostics);
+    for (nsUInt32 d = m_Declarations.GetCount(); d-- > uiFirstDeclaration;)
+    {
+      const CSSDeclaration& declaration = m_Declarations[d];
+      if (declaration.m_bImportant || declaration.m_bHasVariables || declaration.IsCustomProperty() || declaration.m_Property == PropertyId::Transition ||
+          declaration.m_Property == PropertyId::Animation)
+      {
+        m_Declarations.RemoveAtAndCopy(d);
+      }
+    }
+
+    for (float fOffset : offsets)
+    {
+      Keyframe& keyframe = m_Keyframes.ExpandAndGetRef();
+      keyframe.m_fOffset = fOffset;
+      keyframe.m_uiFirstDeclaration = uiFirstDeclaration;
+      keyframe.m_uiDeclarationCount = m_Declarations.GetCount() - uiFirstDeclaration;
+    }
+  }
+
+  // Stable insertion sort, keyframes with the same offset cascade in source order.
+  rule.m_uiKeyframeCount = m_Keyframes.GetCount() - rule.m_uiFirstKeyframe;
+  for (nsUInt32 k = rule.m_uiFirstKeyframe + 1; k < m_Keyframes.GetCount(); ++k)
+  {
+    const Keyframe keyframe = m_Keyframes[k];
+    nsUInt32 uiTarget = k;
+    while (uiTarget > rule.m_uiFirstKeyframe && m_Keyframes[uiTarget - 1].m_fOffset > keyframe.m_fOffset)
+    {
+      m_Keyframes[uiTarget] = m_Keyframes[uiTarget - 1];
+      --uiTarget;
+    }
+    m_Keyframes[uiTarget] = keyframe;
+  }
+
+  m_KeyframesRules.PushBack(rule);
+}
+
+const CSSStyleSheet::KeyframesRule* CSSStyleSheet::FindKeyframesRule(core::Atom in_name) const
+{
+  for (nsUInt32 i = m_KeyframesRules.GetCount(); i-- > 0;)
+  {
+    if (m_KeyframesRules[i].m_Name == in_name)
+      return &m_KeyframesRules[i];
+  }
+  return nullptr;
+}
+
+nsUInt32 CSSStyleSheet::ParseDeclarationList(
+  std::string_view in_source, nsDynamicArray<CSSDeclaration>& out_declarations, CSSStringTable& inout_strings, const CSSDiagnosticSource* in_pDiagnostics)
+{
+  nsDynamicArray<CSSToken> tokens;
+  CSSTokenizer::TokenizeAll(in_source, tokens);
+
+  nsUInt32 uiErrors = 0;
+  nsUInt32 i = 0;
+  while (i < tokens.GetCount())
+  {
+    const CSSToken& token = tokens[i];
+    if (token.m_Type == CSSTokenType::Whitespace || token.m_Type == CSSTokenType::Semicolon)
+    {
+      ++i;
+      continue;
+    }
+
+    const nsUInt32 uiEnd = FindAtDepthZero(tokens, i, CSSTokenType::Semicolon);
+    const nsUInt32 uiNext = uiEnd + 1;
+
+    nsUInt32 uiColon = i + 1;
+    while (uiColon < uiEnd && tokens[uiColon].m_Type == CSSTokenType::Whitespace)
+      ++uiColon;
+
+    if (token.m_Type != CSSTokenType::Ident || uiColon >= uiEnd || tokens[uiColon].m_Type != CSSTokenType::Colon)
+    {
+      ++uiErrors;
+      if (in_pDiagnostics != nullptr)
+        in_pDiagnostics->Report(CSSDiagnostic::InvalidDeclaration, in_source.substr(token.m_uiOffset, GetTokenEnd(tokens, uiEnd, in_source) - token.m_uiOffset));
+      i = uiNext;
+      continue;
+    }
+
+    const nsUInt32 uiValueStart = uiColon + 1 < tokens.GetCount() ? tokens[uiColon + 1].m_uiOffset : static_cast<nsUInt32>(in_source.size());
+    std::string_view value = in_source.substr(uiValueStart, GetTokenEnd(tokens, uiEnd, in_source) - uiValueStart);
+
+    bool bImportant = false;
+    const size_t uiBang = value.rfind('!');
+    if (uiBang != std::string_view::npos)
+    {
+      std::string_view flag = value.substr(uiBang + 1);
+      const size_t uiFirst = flag.find_first_not_of(" \t\r\n\f");
+      const size_t uiLast = flag.find_last_not_of(" \t\r\n\f");
+      flag = uiFirst == std::string_view::npos ? std::string_view() : flag.substr(uiFirst, uiLast - uiFirst + 1);
+      if (IsEqualNoCase(flag, "important"))
+      {
+        bImportant = true;
+        value = value.substr(0, uiBang);
+      }
+    }
+
+    if (CSSPropertyTable::ParseDeclaration(token.m_Value, value, bImportant, out_declarations, inout_strings).Failed())
+    {
+      ++uiErrors;
+      if (in_pDiagnostics != nullptr && CSSPropertyTable::IsKnownProperty(token.m_Value))
+      {
+        const size_t uiFirst = value.find_first_not_of(" \t\r\n\f");
+        const size_t uiLast = value.find_last_not_of(" \t\r\n\f");
+        in_pDiagnostics->Report(CSSDiagnostic::InvalidValue, uiFirst == std::string_view::npos ? value : value.substr(uiFirst, uiLast - uiFirst + 1));
+      }
+      else if (in_pDiagnostics != nullptr)
+        in_pDiagnostics->Report(CSSDiagnostic::UnknownProperty, GetTokenText(tokens, i, in_source));
+    }
+
+    i = uiNext;
+  }
+  return uiErrors;
+}
+
+void CSSStyleSheet::Clear()
+{
+  m_Rules.Clear();
+  m_Selectors.Clear();
+  m_Declarations.Clear();
+  m_MediaBlocks.Clear();
+  m_KeyframesRules.Clear();
+  m_Keyframes.Clear();
+  m_Strings.Clear();
+  m_uiParseErrors = 0;
+}
+
+nsResult CSSStyleSheet::WriteBinary(nsStreamWriter& out_stream) const
+{
+  NS_PROFILE_SCOPE("CSSStyleSheet::WriteBinary");
+
+  // The string table has to be known before anything that references it is written.
+  AtomWriteTable atoms;
+  for (const CSSSelector& selector : m_Selectors)
+  {
+    for (const CSSSimpleSelector& simple : selector.m_Simple)
+    {
+      atoms.Add(simple.m_Atom);
+    }
+  }
+  for (const CSSDeclaration& declaration : m_Declarations)
+  {
+    atoms.Add(declaration.m_Name);
+    if (HasAtomData(declaration.m_Value.m_Unit))
+      atoms.Add(declaration.m_Value.m_uiData);
+  }
+  for (const KeyframesRule& rule : m_KeyframesRules)
+  {
+    atoms.Add(rule.m_Name);
+  }
+
+  nsStringDeduplicationWriteContext deduplication(out_stream);
+  nsChunkStreamWriter chunks(deduplication.Begin());
+  chunks.BeginStream(BinaryFormatVersion);
+
+  chunks.BeginChunk(AtomsChunkName, AtomsChunkVersion);
+  chunks << atoms.m_Atoms.GetCount();
+  for (core::Atom atom : atoms.m_Atoms)
+  {
+    chunks.WriteString(core::AtomTable::Get().GetString(atom)).AssertSuccess();
+  }
+  chunks.EndChunk();
+
+  chunks.BeginChunk(StringsChunkName, StringsChunkVersion);
+  chunks << m_Strings.GetCount();
+  for (nsUInt32 i = 0; i < m_Strings.GetCount(); ++i)
+  {
+    const std::string_view text = m_Strings.Get(i);
+    chunks.WriteString(nsStringView(text.data(), static_cast<nsUInt32>(text.size()))).AssertSuccess();
+  }
+  chunks.EndChunk();
+
+  chunks.BeginChunk(RulesChunkName, RulesChunkVersion);
+  chunks << m_uiParseErrors;
+  chunks << m_Rules.GetCount();
+  for (const Rule& rule : m_Rules)
+  {
+    chunks << rule.m_uiFirstSelector;
+    chunks << rule.m_uiSelectorCount;
+    chunks << rule.m_uiFirstDeclaration;
+    chunks << rule.m_uiDeclarationCount;
+    chunks << rule.m_uiMediaBlock;
+  }
+  chunks.EndChunk();
+
+  chunks.BeginChunk(MediaBlocksChunkName, MediaBlocksChunkVersion);
+  chunks << m_MediaBlocks.GetCount();
+  for (const MediaBlock& block : m_MediaBlocks)
+  {
+    chunks << block.m_uiParent;
+    block.m_Queries.Write(chunks);
+  }
+  chunks.EndChunk();
+
+  // Specificity, rule map key and ancestor hashes are derived from the simple selectors, they are recomputed on load.
+  chunks.BeginChunk(SelectorsChunkName, SelectorsChunkVersion);
+  chunks << m_Selectors.GetCount();
+  for (const CSSSelector& selector : m_Selectors)
+  {
+    chunks << static_cast<nsUInt8>(selector.m_PseudoElement);
+    chunks << selector.m_Compounds.GetCount();
+    for (const CSSCompoundSelector& compound : selector.m_Compounds)
+    {
+      chunks << compound.m_uiFirst;
+      chunks << compound.m_uiCount;
+      chunks << static_cast<nsUInt8>(compound.m_Combinator);
+    }
+
+    chunks << selector.m_Simple.GetCount();
+    for (const CSSSimpleSelector& simple : selector.m_Simple)
+    {
+      chunks << static_cast<nsUInt8>(simple.m_Type);
+      chunks << static_cast<nsUInt8>(simple.m_AttributeOp);
+      chunks << simple.m_bNegated;
+      chunks << simple.m_bCaseInsensitive;
+      chunks << atoms.Add(simple.m_Atom);
+      chunks << simple.m_uiStateMask;
+      chunks << simple.m_iNthA;
+      chunks << simple.m_iNthB;
+      chunks.WriteString(ToStringView(simple.m_sName)).AssertSuccess();
+      chunks.WriteString(ToStringView(simple.m_sValue)).AssertSuccess();
+    }
+  }
+  chunks.EndChunk();
+
+  chunks.BeginChunk(DeclarationsChunkName, DeclarationsChunkVersion);
+  chunks << GetPropertyTableHash();
+  chunks << m_Declarations.GetCount();
+  for (const CSSDeclaration& declaration : m_Declarations)
+  {
+    chunks << static_cast<nsUInt8>(declaration.m_Property);
+    chunks << static_cast<nsUInt8>(declaration.m_WideKeyword);
+    chunks << declaration.m_bImportant;
+    chunks << declaration.m_bHasVariables;
+    chunks << declaration.m_Value.m_fNumber;
+    chunks << (HasAtomData(declaration.m_Value.m_Unit) ? atoms.Add(declaration.m_Value.m_uiData) : declaration.m_Value.m_uiData);
+    chunks << static_cast<nsUInt32>(declaration.m_Value.m_Unit);
+    chunks << atoms.Add(declaration.m_Name);
+  }
+  chunks.EndChunk();
+
+  chunks.BeginChunk(KeyframesChunkName, KeyframesChunkVersion);
+  chunks << m_KeyframesRules.GetCount();
+  for (const KeyframesRule& rule : m_KeyframesRules)
+  {
+    chunks << atoms.Add(rule.m_Name);
+    chunks << rule.m_uiFirstKeyframe;
+    chunks << rule.m_uiKeyframeCount;
+  }
+  chunks << m_Keyframes.GetCount();
+  for (const Keyframe& keyframe : m_Keyframes)
+  {
+    chunks << keyframe.m_fOffset;
+    chunks << keyframe.m_uiFirstDeclaration;
+    chunks << keyframe.m_uiDeclarationCount;
+  }
+  chunks.EndChunk();
+
+  chunks.EndStream();
+  return deduplication.End();
+}
+
+nsResult CSSStyleSheet::ReadBinary(nsStreamReader& inout_stream)
+{
+  NS_PROFILE_SCOPE("CSSStyleSheet::ReadBinary");
+
+  Clear();
+
+  nsStringDeduplicationReadContext deduplication(inout_stream);
+  nsChunkStreamReader chunks(inout_stream);
+  chunks.SetEndChunkFileMode(nsChunkStreamReader::EndChunkFileMode::JustClose);
+
+  if (chunks.BeginStream() != BinaryFormatVersion)
+  {
+    nsLog::Warning("CSSStyleSheet: Precompiled sheet has a different format version, it has to be rebuilt.");
+    return NS_FAILURE;
+  }
+
+  AtomReadTable atoms;
+  ChunkDataReader data;
+  nsStringBuilder sTemp;
+  bool bHasAtoms = false;
+  bool bHasRules = false;
+  bool bHasSelectors = false;
+  bool bHasDeclarations = false;
+  bool bCorrupted = false;
+
+  while (chunks.GetCurrentChunk().m_bValid && !bCorrupted)
+  {
+    // A stream that ends within a chunk has no valid chunk header after it either.
+    if (data.Begin(chunks).Failed())
+    {
+      bCorrupted = true;
+      break;
+    }
+
+    const auto& chunk = chunks.GetCurrentChunk();
+    if (chunk.m_sChunkName == AtomsChunkName && chunk.m_uiChunkVersion == AtomsChunkVersion)
+    {
+      nsUInt32 uiAtomCount = 0;
+      data >> uiAtomCount;
+      bCorrupted |= !data.IsValidCount(uiAtomCount, StringBytes);
+      atoms.m_Atoms.SetCountUninitialized(bCorrupted ? 0 : uiAtomCount);
+      for (core::Atom& atom : atoms.m_Atoms)
+      {
+        data.ReadString(sTemp);
+        atom = core::MakeAtom(std::string_view(sTemp.GetData(), sTemp.GetElementCount()));
+      }
+      bHasAtoms = true;
+    }
+    else if (chunk.m_sChunkName == StringsChunkName && chunk.m_uiChunkVersion == StringsChunkVersion)
+    {
+      nsUInt32 uiStringCount = 0;
+      data >> uiStringCount;
+      bCorrupted |= !data.IsValidCount(uiStringCount, StringBytes);
+      for (nsUInt32 i = 0; i < uiStringCount && !bCorrupted && !data.HasFailed(); ++i)
+      {
+        data.ReadString(sTemp);
+        m_Strings.Add(std::string_view(sTemp.GetData(), sTemp.GetElementCount()));
+      }
+    }
+    else if (chunk.m_sChunkName == RulesChunkName && chunk.m_uiChunkVersion == RulesChunkVersion)
+    {
+      nsUInt32 uiRuleCount = 0;
+      data >> m_uiParseErrors;
+      data >> uiRuleCount;
+      bCorrupted |= !data.IsValidCount(uiRuleCount, RuleBytes);
+      m_Rules.SetCountUninitialized(bCorrupted ? 0 : uiRuleCount);
+      for (Rule& rule : m_Rules)
+      {
+        data >> rule.m_uiFirstSelector;
+        data >> rule.m_uiSelectorCount;
+        data >> rule.m_uiFirstDeclaration;
+        data >> rule.m_uiDeclarationCount;
+        data >> rule.m_uiMediaBlock;
+      }
+      bHasRules = true;
+    }
+    else if (chunk.m_sChunkName == MediaBlocksChunkName && chunk.m_uiChunkVersion == MediaBlocksChunkVersion)
+    {
+      nsUInt32 uiBlockCount = 0;
+      data >> uiBlockCount;
+      bCorrupted |= !data.IsValidCount(uiBlockCount, MediaBlockBytes);
+      m_MediaBlocks.SetCount(bCorrupted ? 0 : uiBlockCount);
+      for (nsUInt32 b = 0; b < m_MediaBlocks.GetCount() && !bCorrupted; ++b)
+      {
+        MediaBlock& block = m_MediaBlocks[b];
+        data >> block.m_uiParent;
+        bCorrupted |= block.m_uiParent != NoMediaBlock && block.m_uiParent >= b;
+        bCorrupted |= block.m_Queries.Read(data.GetStream()).Failed();
+      }
+    }
+    else if (chunk.m_sChunkName == SelectorsChunkName && chunk.m_uiChunkVersion == SelectorsChunkVersion && bHasAtoms)
+    {
+      nsUInt32 uiSelectorCount = 0;
+      data >> uiSelectorCount;
+      bCorrupted |= !data.IsValidCount(uiSelectorCount, SelectorBytes);
+      m_Selectors.SetCount(bCorrupted ? 0 : uiSelectorCount);
+      for (nsUInt32 s = 0; s < m_Selectors.GetCount() && !bCorrupted; ++s)
+      {
+        CSSSelector& selector = m_Selectors[s];
+
+        nsUInt8 uiPseudoElement = 0;
+        nsUInt32 uiCompoundCount = 0;
+        data >> uiPseudoElement;
+        data >> uiCompoundCount;
+        selector.m_PseudoElement = static_cast<CSSPseudoElement>(uiPseudoElement);
+        if (!data.IsValidCount(uiCompoundCount, CompoundBytes))
+        {
+          bCorrupted = true;
+          break;
+        }
+
+        selector.m_Compounds.SetCount(uiCompoundCount);
+        for (CSSCompoundSelector& compound : selector.m_Compounds)
+        {
+          nsUInt8 uiCombinator = 0;
+          data >> compound.m_uiFirst;
+          data >> compound.m_uiCount;
+          data >> uiCombinator;
+          compound.m_Combinator = static_cast<CSSCombinator>(uiCombinator);
+          bCorrupted |= uiCombinator > static_cast<nsUInt8>(CSSCombinator::SubsequentSibling);
+        }
+
+        nsUInt32 uiSimpleCount = 0;
+        data >> uiSimpleCount;
+        if (!data.IsValidCount(uiSimpleCount, SimpleSelectorBytes))
+        {
+          bCorrupted = true;
+          break;
+        }
+
+        selector.m_Simple.SetCount(uiSimpleCount);
+        for (CSSSimpleSelector& simple : selector.m_Simple)
+        {
+          nsUInt8 uiType = 0;
+          nsUInt8 uiAttributeOp = 0;
+          nsUInt32 uiAtom = 0;
+          data >> uiType;
+          data >> uiAttributeOp;
+          data >> simple.m_bNegated;
+          data >> simple.m_bCaseInsensitive;
+          data >> uiAtom;
+          data >> simple.m_uiStateMask;
+          data >> simple.m_iNthA;
+          data >> simple.m_iNthB;
+          data.ReadString(sTemp);
+          simple.m_sName.assign(sTemp.GetData(), sTemp.GetElementCount());
+          data.ReadString(sTemp);
+          simple.m_sValue.assign(sTemp.GetData(), sTemp.GetElementCount());
+
+          simple.m_Type = static_cast<CSSSimpleSelectorType>(uiType);
+          simple.m_AttributeOp = static_cast<CSSAttributeOperator>(uiAttributeOp);
+          bCorrupted |= uiType > static_cast<nsUInt8>(CSSSimpleSelectorType::OnlyOfType) || uiAttributeOp > static_cast<nsUInt8>(CSSAttributeOperator::Substring);
+          bCorrupted |= atoms.Get(uiAtom, simple.m_Atom).Failed();
+        }
+
+        for (const CSSCompoundSelector& compound : selector.m_Compounds)
+        {
+          bCorrupted |= nsUInt32(compound.m_uiFirst + compound.m_uiCount) > uiSimpleCount;
+        }
+        selector.Finalize();
+      }
+      bHasSelectors = true;
+    }
+    else if (chunk.m_sChunkName == DeclarationsChunkName && chunk.m_uiChunkVersion == DeclarationsChunkVersion && bHasAtoms)
+    {
+      nsUInt64 uiPropertyTableHash = 0;
+      nsUInt32 uiDeclarationCount = 0;
+      data >> uiPropertyTableHash;
+      if (!data.HasFailed() && uiPropertyTableHash != GetPropertyTableHash())
+      {
+        nsLog::Warning("CSSStyleSheet: Precompiled sheet was built for a different property table, it has to be rebuilt.");
+        Clear();
+        return NS_FAILURE;
+      }
+
+      data >> uiDeclarationCount;
+      bCorrupted |= !data.IsValidCount(uiDeclarationCount, DeclarationBytes);
+      m_Declarations.SetCount(bCorrupted ? 0 : uiDeclarationCount);
+      for (CSSDeclaration& declaration : m_Declarations)
+      {
+        nsUInt8 uiProperty = 0;
+        nsUInt8 uiWideKeyword = 0;
+        nsUInt32 uiUnit = 0;
+        nsUInt32 uiName = 0;
+        data >> uiProperty;
+        data >> uiWideKeyword;
+        data >> declaration.m_bImportant;
+        data >> declaration.m_bHasVariables;
+        data >> declaration.m_Value.m_fNumber;
+        data >> declaration.m_Value.m_uiData;
+        data >> uiUnit;
+        data >> uiName;
+
+        declaration.m_Property = static_cast<PropertyId>(uiProperty);
+        declaration.m_WideKeyword = static_cast<CSSWideKeyword>(uiWideKeyword);
+        declaration.m_Value.m_Unit = static_cast<core::Unit>(uiUnit);
+        bCorrupted |= uiProperty >= PropertyCount || uiWideKeyword > static_cast<nsUInt8>(CSSWideKeyword::Unset);
+        bCorrupted |= atoms.Get(uiName, declaration.m_Name).Failed();
+        if (HasAtomData(declaration.m_Value.m_Unit))
+          bCorrupted |= atoms.Get(declaration.m_Value.m_uiData, declaration.m_Value.m_uiData).Failed();
+      }
+      bHasDeclarations = true;
+    }
+    else if (chunk.m_sChunkName == KeyframesChunkName && chunk.m_uiChunkVersion == KeyframesChunkVersion && bHasAtoms)
+    {
+      nsUInt32 uiRuleCount = 0;
+      data >> uiRuleCount;
+      bCorrupted |= !data.IsValidCount(uiRuleCount, KeyframesRuleBytes);
+      m_KeyframesRules.SetCountUninitialized(bCorrupted ? 0 : uiRuleCount);
+      for (KeyframesRule& rule : m_KeyframesRules)
+      {
+        nsUInt32 uiName = 0;
+        data >> uiName;
+        data >> rule.m_uiFirstKeyframe;
+        data >> rule.m_uiKeyframeCount;
+        bCorrupted |= atoms.Get(uiName, rule.m_Name).Failed();
+      }
+
+      nsUInt32 uiKeyframeCount = 0;
+      data >> uiKeyframeCount;
+      bCorrupted |= !data.IsValidCount(uiKeyframeCount, KeyframeBytes);
+      m_Keyframes.SetCountUninitialized(bCorrupted ? 0 : uiKeyframeCount);
+      for (Keyframe& keyframe : m_Keyframes)
+      {
+        data >> keyframe.m_fOffset;
+        data >> keyframe.m_uiFirstDeclaration;
+        data >> keyframe.m_uiDeclarationCount;
+        bCorrupted |= !(keyframe.m_fOffset >= 0.0f && keyframe.m_fOffset <= 1.0f);
+      }
+    }
+
+    bCorrupted |= data.HasFailed();
+    chunks.NextChunk();
+  }
+  chunks.EndStream();
+
+  for (const Rule& rule : m_Rules)
+  {
+    bCorrupted |= nsUInt64(rule.m_uiFirstSelector) + rule.m_uiSelectorCount > m_Selectors.GetCount();
+    bCorrupted |= nsUInt64(rule.m_uiFirstDeclaration) + rule.m_uiDeclarationCount > m_Declarations.GetCount();
+    bCorrupted |= rule.m_uiMediaBlock != NoMediaBlock && rule.m_uiMediaBlock >= m_MediaBlocks.GetCount();
+  }
+  for (const KeyframesRule& rule : m_KeyframesRules)
+  {
+    bCorrupted |= nsUInt64(rule.m_uiFirstKeyframe) + rule.m_uiKeyframeCount > m_Keyframes.GetCount();
+  }
+  for (const Keyframe& keyframe : m_Keyframes)
+  {
+    bCorrupted |= nsUInt64(keyframe.m_uiFirstDeclaration) + keyframe.m_uiDeclarationCount > m_Declarations.GetCount();
+  }
+  for (const CSSDeclaration& declaration : m_Declarations)
+  {
+    bCorrupted |= declaration.m_Value.m_Unit == core::Unit::STRING && declaration.m_Value.m_uiData >= m_Strings.GetCount();
+  }
+
+  if (bCorrupted || !bHasRules || !bHasSelectors || !bHasDeclarations)
+  {
+    nsLog::Error("CSSStyleSheet: The precompiled sheet is corrupted.");
+    Clear();
+    return NS_FAILURE;
+  }
+  return NS_SUCCESS;
+}
+
+nsResult CSSStyleSheet::ReadBinaryFromMemory(const void* in_pData, nsUInt64 in_uiSize)
+{
+  nsRawMemoryStreamReader reader(in_pData, in_uiSize);
+  return ReadBinary(reader);
+}
+
+nsResult CSSStyleSheet::LoadBinaryMapped(nsStringView in_sAbsolutePath)
+{
+#if NS_ENABLED(NS_SUPPORTS_MEMORY_MAPPED_FILE)
+  nsMemoryMappedFile file;
+  NS_SUCCEED_OR_RETURN(file.Open(in_sAbsolutePath, nsMemoryMappedFile::Mode::ReadOnly));
+  return ReadBinaryFromMemory(file.GetReadPointer(), file.GetFileSize());
+#else
+  nsFileReader file;
+  NS_SUCCEED_OR_RETURN(file.Open(in_sAbsolutePath));
+  return ReadBinary(file);
+#endif
+}
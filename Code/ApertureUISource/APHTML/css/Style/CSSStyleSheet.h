@@ -0,0 +1,191 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/css/CSSErrorDB.h>
+#include <APHTML/css/Selector/CSSSelector.h>
+#include <APHTML/css/Style/CSSMediaQuery.h>
+#include <APHTML/css/Style/CSSStringTable.h>
+#include <APHTML/css/Style/CSSValue.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/IO/Stream.h>
+#include <string_view>
+
+namespace aperture::css
+{
+  /*
+   * @brief A parsed author stylesheet: style rules with compiled selectors and expanded longhand declarations.
+   *
+   * Rules, selectors and declarations live in three flat arrays, a rule only stores ranges into the other two.
+   * @keyframes rules are kept next to the style rules, their keyframes store ranges into the same declaration array.
+   * Style rules inside @media blocks are kept in the same array as well, they reference the block whose compiled media
+   * query list decides whether they apply (see StyleResolver::SetMediaEnvironment()). Other at-rules are skipped.
+   *
+   * Sheets can also be precompiled offline (see the StyleSheetCompiler tool) into a binary form that is loaded without
+   * tokenizing or parsing: selectors are stored compiled and declarations pre-parsed. Atoms are process specific, so the
+   * binary form has its own string table that is interned once on load and used to remap all atoms. The text of STRING
+   * values is not interned, it is stored and loaded as the CSSStringTable of the sheet.
+   *
+   * @note Selectors and media query lists are referenced by pointer once the sheet was handed to a StyleResolver, the sheet must not be
+   * modified or moved afterwards.
+   */
+  class NS_APERTURE_DLL CSSStyleSheet
+  {
+  public:
+    static constexpr nsUInt32 NoMediaBlock = 0xFFFFFFFF;
+
+    struct Rule
+    {
+      NS_DECLARE_POD_TYPE();
+
+      nsUInt32 m_uiFirstSelector;
+      nsUInt32 m_uiSelectorCount;
+      nsUInt32 m_uiFirstDeclaration;
+      nsUInt32 m_uiDeclarationCount;
+      /// @brief The innermost @media block the rule is in, NoMediaBlock if it always applies.
+      nsUInt32 m_uiMediaBlock;
+    };
+
+    /// @brief A @media block. Blocks nested in other blocks only apply if their parents do as well.
+    struct MediaBlock
+    {
+      CSSMediaQueryList m_Queries;
+      /// @brief The block this one is nested in, NoMediaBlock at the top level. Parents always come first.
+      nsUInt32 m_uiParent = NoMediaBlock;
+    };
+
+    /// @brief A keyframe of a @keyframes rule. Selectors with several offsets ("0%, 100%") add one keyframe per offset.
+    struct Keyframe
+    {
+      NS_DECLARE_POD_TYPE();
+
+      /// @brief The offset in [0, 1].
+      float m_fOffset;
+      nsUInt32 m_uiFirstDeclaration;
+      nsUInt32 m_uiDeclarationCount;
+    };
+
+    struct KeyframesRule
+    {
+      NS_DECLARE_POD_TYPE();
+
+      core::Atom m_Name;
+      /// @brief The keyframes are sorted by offset, keyframes with the same offset keep their source order.
+      nsUInt32 m_uiFirstKeyframe;
+      nsUInt32 m_uiKeyframeCount;
+    };
+
+    /// @brief Bumped whenever the binary layout changes or core::Unit values are renumbered. Changes to the property table
+    /// are detected on their own, sheets store a hash of the property names.
+    static constexpr nsUInt16 BinaryFormatVersion = 5;
+
+    /// @brief Parses the source and appends its rules. Invalid rules and declarations are dropped, as per spec.
+    /// @param in_sourceName Reported with the diagnostics of dropped rules and declarations, e.g. the file path.
+    void ParseFromString(std::string_view in_source, std::string_view in_sourceName = {});
+
+    /// @brief Parses a declaration list, as found in a rule block or a style attribute.
+    /// @param inout_strings Receives the text of STRING values, see CSSPropertyTable::ParseDeclaration().
+    /// @param in_pDiagnostics The text in_source is part of, diagnostics are only reported if it is given.
+    /// @return The number of invalid declarations that were dropped.
+    static nsUInt32 ParseDeclarationList(std::string_view in_source, nsDynamicArray<CSSDeclaration>& out_declarations, CSSStringTable& inout_strings,
+      const CSSDiagnosticSource* in_pDiagnostics = nullptr);
+
+    nsUInt32 GetRuleCount() const { return m_Rules.GetCount(); }
+    const Rule& GetRule(nsUInt32 in_uiIndex) const { return m_Rules[in_uiIndex]; }
+    const CSSSelector& GetSelector(nsUInt32 in_uiIndex) const { return m_Selectors[in_uiIndex]; }
+    nsArrayPtr<const CSSDeclaration> GetDeclarations(const Rule& in_rule) const
+    {
+      return m_Declarations.GetArrayPtr().GetSubArray(in_rule.m_uiFirstDeclaration, in_rule.m_uiDeclarationCount);
+    }
+
+    nsUInt32 GetMediaBlockCount() const { return m_MediaBlocks.GetCount(); }
+    const MediaBlock& GetMediaBlock(nsUInt32 in_uiIndex) const { return m_MediaBlocks[in_uiIndex]; }
+
+    nsUInt32 GetKeyframesRuleCount() const { return m_KeyframesRules.GetCount(); }
+    const KeyframesRule& GetKeyframesRule(nsUInt32 in_uiIndex) const { return m_KeyframesRules[in_uiIndex]; }
+    nsArrayPtr<const Keyframe> GetKeyframes(const KeyframesRule& in_rule) const
+    {
+      return m_Keyframes.GetArrayPtr().GetSubArray(in_rule.m_uiFirstKeyframe, in_rule.m_uiKeyframeCount);
+    }
+    nsArrayPtr<const CSSDeclaration> GetDeclarations(const Keyframe& in_keyframe) const
+    {
+      return m_Declarations.GetArrayPtr().GetSubArray(in_keyframe.m_uiFirstDeclaration, in_keyframe.m_uiDeclarationCount);
+    }
+
+    /// @brief The text of the STRING values of all declarations.
+    const CSSStringTable& GetStrings() const { return m_Strings; }
+    /// @brief The text of a STRING value of a declaration of this sheet, empty for other values.
+    std::string_view GetString(const CSSValue& in_value) const
+    {
+      return in_value.m_Unit == core::Unit::STRING ? m_Strings.Get(in_value.m_uiData) : std::string_view();
+    }
+
+    /// @brief Returns the @keyframes rule with the name, or null. The last rule wins if a name is defined more than once.
+    const KeyframesRule* FindKeyframesRule(core::Atom in_name) const;
+
+    /// @brief The number of rules and declarations that were dropped because they were invalid.
+    nsUInt32 GetParseErrorCount() const { return m_uiParseErrors; }
+
+    void Clear();
+
+    /// @brief Writes the sheet in the precompiled binary form.
+    nsResult WriteBinary(nsStreamWriter& out_stream) const;
+
+    /// @brief Replaces the sheet with a precompiled one.
+    /// @return Failure on a version mismatch or corrupted data, the caller should parse the source instead.
+    nsResult ReadBinary(nsStreamReader& inout_stream);
+
+    /// @brief Reads a precompiled sheet from a block of memory, e.g. a memory mapped file.
+    nsResult ReadBinaryFromMemory(const void* in_pData, nsUInt64 in_uiSize);
+
+    /// @brief Memory maps the given precompiled sheet and reads it.
+    nsResult LoadBinaryMapped(nsStringView in_sAbsolutePath);
+
+  private:
+    /// @brief Parses a list of rules, either the whole sheet or the block of a @media rule.
+    void ParseRuleList(std::string_view in_source, nsUInt32 in_uiMediaBlock, const CSSDiagnosticSource& in_diagnostics);
+    /// @brief Parses the prelude and block of a @keyframes rule.
+    void ParseKeyframes(std::string_view in_prelude, std::string_view in_block, const CSSDiagnosticSource& in_diagnostics);
+
+    nsDynamicArray<Rule> m_Rules;
+    nsDynamicArray<CSSSelector> m_Selectors;
+    nsDynamicArray<CSSDeclaration> m_Declarations;
+    nsDynamicArray<MediaBlock> m_MediaBlocks;
+    nsDynamicArray<KeyframesRule> m_KeyframesRules;
+    nsDynamicArray<Keyframe> m_Keyframes;
+    CSSStringTable m_Strings;
+    nsUInt32 m_uiParseErrors = 0;
+  };
+} // namespace aperture::css
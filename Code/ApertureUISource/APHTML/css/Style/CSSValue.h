@@ -0,0 +1,135 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/core/Atom.h>
+#include <APHTML/core/ID.h>
+#include <APHTML/core/NumericValue.h>
+
+namespace aperture::css
+{
+  /*
+   * @brief A specified or computed property value.
+   *
+   * The unit decides how the value is read:
+   *  - numeric units (PX, PERCENT, EM, NUMBER, ...): m_fNumber,
+   *  - KEYWORD: m_uiData is the atom of the keyword ("auto", "flex", ...),
+   *  - COLOUR: m_uiData is the color as RGBA8, red in the lowest byte,
+   *  - STRING: m_uiData is the index of the text in the CSSStringTable of whatever holds the value (the style sheet,
+   *    the computed style, ...). Values the engine doesn't parse yet (transforms, shadows, ...) are kept as their source text.
+   *
+   * @note Plain 12 byte POD, styles compare and hash their values as raw memory, plus the text of their STRING values.
+   */
+  struct CSSValue
+  {
+    NS_DECLARE_POD_TYPE();
+
+    float m_fNumber = 0.0f;
+    nsUInt32 m_uiData = 0;
+    core::Unit m_Unit = core::Unit::UNKNOWN;
+
+    static CSSValue MakeNumeric(float in_fNumber, core::Unit in_unit)
+    {
+      CSSValue value;
+      value.m_fNumber = in_fNumber;
+      value.m_Unit = in_unit;
+      return value;
+    }
+
+    static CSSValue MakeKeyword(core::Atom in_keyword)
+    {
+      CSSValue value;
+      value.m_uiData = in_keyword;
+      value.m_Unit = core::Unit::KEYWORD;
+      return value;
+    }
+
+    static CSSValue MakeColor(nsUInt32 in_uiRGBA)
+    {
+      CSSValue value;
+      value.m_uiData = in_uiRGBA;
+      value.m_Unit = core::Unit::COLOUR;
+      return value;
+    }
+
+    static CSSValue MakeString(nsUInt32 in_uiIndex)
+    {
+      CSSValue value;
+      value.m_uiData = in_uiIndex;
+      value.m_Unit = core::Unit::STRING;
+      return value;
+    }
+
+    bool IsKeyword(core::Atom in_keyword) const { return m_Unit == core::Unit::KEYWORD && m_uiData == in_keyword; }
+    bool IsNumeric() const { return core::Any(m_Unit & core::Unit::NUMERIC); }
+    core::NumericValue GetNumericValue() const { return core::NumericValue(m_fNumber, m_Unit); }
+
+    bool operator==(const CSSValue& other) const { return m_fNumber == other.m_fNumber && m_uiData == other.m_uiData && m_Unit == other.m_Unit; }
+    bool operator!=(const CSSValue& other) const { return !(*this == other); }
+  };
+  static_assert(sizeof(CSSValue) == 12, "CSSValue is hashed as raw memory and must not contain padding.");
+
+  /// @brief The CSS-wide keywords, valid for every property.
+  enum class CSSWideKeyword : nsUInt8
+  {
+    None,
+    Inherit,
+    Initial,
+    Unset
+  };
+
+  /*
+   * @brief A single longhand declaration of a rule or style attribute. Shorthands are expanded while parsing.
+   *
+   * Two kinds of declarations keep their value as source text (a STRING value in the string table of the sheet) until
+   * the style is computed:
+   *  - Custom properties: m_Property is Invalid and m_Name is the name, including the leading dashes.
+   *  - Declarations with var() references (m_bHasVariables): m_Name is the declared property or shorthand name, the
+   *    substituted text is parsed with it, and the longhand m_Property is taken from the result.
+   */
+  struct CSSDeclaration
+  {
+    NS_DECLARE_POD_TYPE();
+
+    PropertyId m_Property = PropertyId::Invalid;
+    CSSWideKeyword m_WideKeyword = CSSWideKeyword::None;
+    bool m_bImportant = false;
+    bool m_bHasVariables = false;
+    CSSValue m_Value;
+    core::Atom m_Name = core::InvalidAtom;
+
+    bool IsCustomProperty() const { return m_Property == PropertyId::Invalid && m_Name != core::InvalidAtom; }
+  };
+} // namespace aperture::css
@@ -0,0 +1,392 @@
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <APHTML/css/Style/ComputedStyle.h>
+
+using namespace aperture;
+using namespace aperture::css;
+
+namespace
+{
+  template <StyleGroup Group>
+  nsSharedPtr<ComputedStyleGroup<Group>> MakeInitialGroup()
+  {
+    static ComputedStyleGroup<Group> s_Group;
+    for (nsUInt32 i = 1; i < ComputedStyle::PropertyCount; ++i)
+    {
+      const StyleSlot& slot = s_StyleGroupLayout.m_Slots[i];
+      if (slot.m_Group != Group)
+        continue;
+
+      const CSSValue& initial = CSSPropertyTable::GetInitialValue(static_cast<PropertyId>(i));
+      s_Group.SetValue(slot.m_uiIndex, initial, initial.m_Unit == core::Unit::STRING ? CSSPropertyTable::GetInitialStrings().Get(initial.m_uiData) : std::string_view());
+    }
+
+    // The extra reference keeps the count above zero, so the static group is never handed to a allocator.
+    // The hash is computed up front, the initial groups are read by every resolving thread.
+    s_Group.AddRef();
+    s_Group.GetHash();
+    return nsSharedPtr<ComputedStyleGroup<Group>>(&s_Group, nullptr);
+  }
+} // namespace
+
+ComputedStyle::ComputedStyle()
+  : ComputedStyle(GetInitialStyle())
+{
+}
+
+ComputedStyle::ComputedStyle(NoGroupsTag) {}
+
+const ComputedStyle& ComputedStyle::GetInitialStyle()
+{
+  static const ComputedStyle s_InitialStyle = []() {
+    for (nsUInt32 i = 1; i < PropertyCount; ++i)
+    {
+      const PropertyId id = static_cast<PropertyId>(i);
+      NS_ASSERT_DEV(CSSPropertyTable::IsInherited(id) == (GetStyleGroup(id) == StyleGroup::Text), "Inherited properties must be stored in the text group.");
+    }
+
+    ComputedStyle style{NoGroupsTag()};
+    style.m_pBox = MakeInitialGroup<StyleGroup::Box>();
+    style.m_pFlex = MakeInitialGroup<StyleGroup::Flex>();
+    style.m_pVisual = MakeInitialGroup<StyleGroup::Visual>();
+    style.m_pText = MakeInitialGroup<StyleGroup::Text>();
+    return style;
+  }();
+  return s_InitialStyle;
+}
+
+void ComputedStyle::Set(PropertyId in_id, const CSSValue& in_value)
+{
+  NS_ASSERT_DEBUG(in_value.m_Unit != core::Unit::STRING, "STRING values index a string table, set them with SetString() or CopyValue().");
+  SetValue(in_id, in_value, {});
+}
+
+std::string_view ComputedStyle::GetString(PropertyId in_id) const
+{
+  const StyleSlot& slot = s_StyleGroupLayout.m_Slots[static_cast<nsUInt32>(in_id)];
+  const CSSValue& value = GetGroupValues(slot.m_Group)[slot.m_uiIndex];
+  return value.m_Unit == core::Unit::STRING ? GetGroupStrings(slot.m_Group).Get(value.m_uiData) : std::string_view();
+}
+
+void ComputedStyle::SetString(PropertyId in_id, std::string_view in_text)
+{
+  SetValue(in_id, CSSValue::MakeString(0), in_text);
+}
+
+void ComputedStyle::CopyValue(PropertyId in_id, const ComputedStyle& in_source)
+{
+  SetValue(in_id, in_source.Get(in_id), in_source.GetString(in_id));
+}
+
+bool ComputedStyle::HasSameValue(PropertyId in_id, const ComputedStyle& in_other) const
+{
+  const CSSValue& value = Get(in_id);
+  const CSSValue& otherValue = in_other.Get(in_id);
+  if (value.m_Unit == core::Unit::STRING && otherValue.m_Unit == core::Unit::STRING)
+    return GetString(in_id) == in_other.GetString(in_id);
+  return value == otherValue;
+}
+
+void ComputedStyle::SetValue(PropertyId in_id, const CSSValue& in_value, std::string_view in_text)
+{
+  const StyleSlot& slot = s_StyleGroupLayout.m_Slots[static_cast<nsUInt32>(in_id)];
+  const CSSValue& current = GetGroupValues(slot.m_Group)[slot.m_uiIndex];
+  if (in_value.m_Unit == core::Unit::STRING ? current.m_Unit == core::Unit::STRING && GetString(in_id) == in_text : current == in_value)
+    return;
+
+  switch (slot.m_Group)
+  {
+    case StyleGroup::Box:
+      GetWritableGroup(m_pBox).SetValue(slot.m_uiIndex, in_value, in_text);
+      break;
+    case StyleGroup::Flex:
+      GetWritableGroup(m_pFlex).SetValue(slot.m_uiIndex, in_value, in_text);
+      break;
+    case StyleGroup::Visual:
+      GetWritableGroup(m_pVisual).SetValue(slot.m_uiIndex, in_value, in_text);
+      break;
+    default:
+      GetWritableGroup(m_pText).SetValue(slot.m_uiIndex, in_value, in_text);
+      break;
+  }
+  m_uiHash = 0;
+}
+
+void ComputedStyle::InheritFrom(const ComputedStyle& in_parent)
+{
+  if (m_pText != in_parent.m_pText || m_pCustomProperties != in_parent.m_pCustomProperties)
+  {
+    m_pText = in_parent.m_pText;
+    m_pCustomProperties = in_parent.m_pCustomProperties;
+    m_uiHash = 0;
+  }
+}
+
+void ComputedStyle::SetCustomProperties(nsSharedPtr<const CSSCustomProperties> in_pProperties)
+{
+  // An empty set is stored as null, so "no custom properties" has a single representation.
+  if (in_pProperties != nullptr && in_pProperties->IsEmpty())
+    in_pProperties.Clear();
+
+  m_pCustomProperties = std::move(in_pProperties);
+  m_uiHash = 0;
+}
+
+const CSSValue* ComputedStyle::GetGroupValues(StyleGroup in_group) const
+{
+  switch (in_group)
+  {
+    case StyleGroup::Box:
+      return m_pBox->m_Values;
+    case StyleGroup::Flex:
+      return m_pFlex->m_Values;
+    case StyleGroup::Visual:
+      return m_pVisual->m_Values;
+    default:
+      return m_pText->m_Values;
+  }
+}
+
+const CSSStringTable& ComputedStyle::GetGroupStrings(StyleGroup in_group) const
+{
+  switch (in_group)
+  {
+    case StyleGroup::Box:
+      return m_pBox->m_Strings;
+    case StyleGroup::Flex:
+      return m_pFlex->m_Strings;
+    case StyleGroup::Visual:
+      return m_pVisual->m_Strings;
+    default:
+      return m_pText->m_Strings;
+  }
+}
+
+template <typename GroupType>
+GroupType& ComputedStyle::GetWritableGroup(nsSharedPtr<GroupType>& inout_pGroup)
+{
+  // Copy on write, a group that is referenced elsewhere (parent, cache, initial style) is never modified.
+  // Text passed on to SetValue() may point into the old group, which stays alive through its other references.
+  if (inout_pGroup->GetRefCount() > 1)
+    inout_pGroup = NS_DEFAULT_NEW(GroupType, *inout_pGroup);
+  return *inout_pGroup;
+}
+
+nsUInt64 ComputedStyle::GetHash() const
+{
+  nsUInt64 uiHash = m_uiHash;
+  if (uiHash == 0)
+  {
+    const nsUInt64 parts[] = {m_pBox->GetHash(), m_pFlex->GetHash(), m_pVisual->GetHash(), m_pText->GetHash(),
+      m_pCustomProperties != nullptr ? m_pCustomProperties->GetHash() : 0, m_uiVariableMask, m_uiExplicitlySet[0], m_uiExplicitlySet[1]};
+    uiHash = nsHashingUtils::xxHash64(parts, sizeof(parts));
+    if (uiHash == 0)
+      uiHash = 1;
+    m_uiHash = uiHash;
+  }
+  return uiHash;
+}
+
+bool ComputedStyle::IsEqual(const ComputedStyle& in_other) const
+{
+  if (this == &in_other || HasSameGroups(in_other))
+    return true;
+
+  const bool bSameCustomProperties = m_pCustomProperties == in_other.m_pCustomProperties ||
+                                     (m_pCustomProperties != nullptr && in_other.m_pCustomProperties != nullptr && m_pCustomProperties->IsEqual(*in_other.m_pCustomProperties));
+
+  return GetHash() == in_other.GetHash() && m_uiExplicitlySet[0] == in_other.m_uiExplicitlySet[0] &&
+         m_uiExplicitlySet[1] == in_other.m_uiExplicitlySet[1] && m_uiVariableMask == in_other.m_uiVariableMask && m_pBox->IsEqual(*in_other.m_pBox) &&
+         m_pFlex->IsEqual(*in_other.m_pFlex) && m_pVisual->IsEqual(*in_other.m_pVisual) && m_pText->IsEqual(*in_other.m_pText) && bSameCustomProperties;
+}
+
+bool ComputedStyle::HasSameGroups(const ComputedStyle& in_other) const
+{
+  return m_pBox == in_other.m_pBox && m_pFlex == in_other.m_pFlex && m_pVisual == in_other.m_pVisual && m_pText == in_other.m_pText &&
+         m_pCustomProperties == in_other.m_pCustomProperties && m_uiVariableMask == in_other.m_uiVariableMask && m_uiExplicitlySet[0] == in_other.m_uiExplicitlySet[0] && m_uiExplicitlySet[1] == in_other.m_uiExplicitlySet[1];
+}
+
+StyleCache::~StyleCache()
+{
+  Clear();
+}
+
+nsSharedPtr<const ComputedStyle> StyleCache::GetOrAdd(const ComputedStyle& in_style)
+{
+  // With interned groups, equal styles reference the very same groups and can be looked up by pointer.
+  ComputedStyle interned(in_style);
+  InternGroup(&Shard::m_BoxGroups, interned.m_pBox);
+  InternGroup(&Shard::m_FlexGroups, interned.m_pFlex);
+  InternGroup(&Shard::m_VisualGroups, interned.m_pVisual);
+  InternGroup(&Shard::m_TextGroups, interned.m_pText);
+  if (interned.m_pCustomProperties != nullptr)
+    InternGroup(&Shard::m_CustomProperties, interned.m_pCustomProperties);
+
+  const void* groups[] = {interned.m_pBox.Borrow(), interned.m_pFlex.Borrow(), interned.m_pVisual.Borrow(), interned.m_pText.Borrow(), interned.m_pCustomProperties.Borrow()};
+  const nsUInt64 uiSeed = interned.m_uiExplicitlySet[0] ^ interned.m_uiVariableMask ^ nsHashingUtils::xxHash64(&interned.m_uiExplicitlySet[1], sizeof(nsUInt64));
+  const nsUInt64 uiKey = nsHashingUtils::xxHash64(groups, sizeof(groups), uiSeed);
+
+  Shard& shard = GetShard(uiKey);
+  NS_LOCK(shard.m_Mutex);
+  ++shard.m_Stats.m_uiLookups;
+
+  auto& bucket = shard.m_Styles[uiKey];
+  for (const nsSharedPtr<const ComputedStyle>& pCached : bucket)
+  {
+    if (pCached->HasSameGroups(interned))
+    {
+      ++shard.m_Stats.m_uiHits;
+      return pCached;
+    }
+  }
+
+  nsSharedPtr<const ComputedStyle> pStyle = NS_DEFAULT_NEW(ComputedStyle, interned);
+  bucket.PushBack(pStyle);
+  ++shard.m_uiStyleCount;
+  return pStyle;
+}
+
+template <typename GroupType>
+void StyleCache::InternGroup(GroupTable<GroupType> Shard::*in_pTable, nsSharedPtr<GroupType>& inout_pGroup)
+{
+  const nsUInt64 uiHash = inout_pGroup->GetHash();
+  Shard& shard = GetShard(uiHash);
+  NS_LOCK(shard.m_Mutex);
+
+  GroupTable<GroupType>& table = shard.*in_pTable;
+  auto& bucket = table.m_Groups[uiHash];
+  for (const nsSharedPtr<GroupType>& pCached : bucket)
+  {
+    if (pCached->IsEqual(*inout_pGroup))
+    {
+      inout_pGroup = pCached;
+      return;
+    }
+  }
+
+  bucket.PushBack(inout_pGroup);
+  ++table.m_uiCount;
+}
+
+template <typename GroupType>
+void StyleCache::CollectGarbage(GroupTable<GroupType>& inout_table)
+{
+  for (auto it = inout_table.m_Groups.GetIterator(); it.IsValid();)
+  {
+    auto& bucket = it.Value();
+    for (nsUInt32 i = bucket.GetCount(); i-- > 0;)
+    {
+      if (bucket[i]->GetRefCount() == 1)
+      {
+        bucket.RemoveAtAndSwap(i);
+        --inout_table.m_uiCount;
+      }
+    }
+
+    if (bucket.IsEmpty())
+      it = inout_table.m_Groups.Remove(it);
+    else
+      ++it;
+  }
+}
+
+nsUInt32 StyleCache::CollectGarbage()
+{
+  nsUInt32 uiReleased = 0;
+  for (Shard& shard : m_Shards)
+  {
+    NS_LOCK(shard.m_Mutex);
+    for (auto it = shard.m_Styles.GetIterator(); it.IsValid();)
+    {
+      auto& bucket = it.Value();
+      for (nsUInt32 i = bucket.GetCount(); i-- > 0;)
+      {
+        if (bucket[i]->GetRefCount() == 1)
+        {
+          bucket.RemoveAtAndSwap(i);
+          --shard.m_uiStyleCount;
+          ++uiReleased;
+        }
+      }
+
+      if (bucket.IsEmpty())
+        it = shard.m_Styles.Remove(it);
+      else
+        ++it;
+    }
+  }
+
+  // Styles of all shards first, they hold the references to their groups.
+  for (Shard& shard : m_Shards)
+  {
+    NS_LOCK(shard.m_Mutex);
+    CollectGarbage(shard.m_BoxGroups);
+    CollectGarbage(shard.m_FlexGroups);
+    CollectGarbage(shard.m_VisualGroups);
+    CollectGarbage(shard.m_TextGroups);
+    CollectGarbage(shard.m_CustomProperties);
+  }
+  return uiReleased;
+}
+
+void StyleCache::Clear()
+{
+  for (Shard& shard : m_Shards)
+  {
+    NS_LOCK(shard.m_Mutex);
+    shard.m_Styles.Clear();
+    shard.m_uiStyleCount = 0;
+    shard.m_BoxGroups = GroupTable<BoxStyle>();
+    shard.m_FlexGroups = GroupTable<FlexStyle>();
+    shard.m_VisualGroups = GroupTable<VisualStyle>();
+    shard.m_TextGroups = GroupTable<TextStyle>();
+    shard.m_CustomProperties = GroupTable<const CSSCustomProperties>();
+  }
+}
+
+nsUInt32 StyleCache::GetStyleCount() const
+{
+  nsUInt32 uiCount = 0;
+  for (const Shard& shard : m_Shards)
+  {
+    NS_LOCK(shard.m_Mutex);
+    uiCount += shard.m_uiStyleCount;
+  }
+  return uiCount;
+}
+
+nsUInt32 StyleCache::GetGroupCount(StyleGroup in_group) const
+{
+  nsUInt32 uiCount = 0;
+  for (const Shard& shard : m_Shards)
+  {
+    NS_LOCK(shard.m_Mutex);
+    switch (in_group)
+    {
+      case StyleGroup::Box:
+        uiCount += shard.m_BoxGroups.m_uiCount;
+        break;
+      case StyleGroup::Flex:
+        uiCount += shard.m_FlexGroups.m_uiCount;
+        break;
+      case StyleGroup::Visual:
+        uiCount += shard.m_VisualGroups.m_uiCount;
+        break;
+      default:
+        uiCount += shard.m_TextGroups.m_uiCount;
+        break;
+    }
+  }
+  return uiCount;
+}
+
+StyleCache::Stats StyleCache::GetStats() const
+{
+  Stats stats;
+  for (const Shard& shard : m_Shards)
+  {
+    NS_LOCK(shard.m_Mutex);
+    stats.m_uiLookups += shard.m_Stats.m_uiLookups;
+    stats.m_uiHits += shard.m_Stats.m_uiHits;
+  }
+  return stats;
+}
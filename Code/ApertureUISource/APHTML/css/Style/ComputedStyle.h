@@ -0,0 +1,439 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/css/Style/CSSCustomProperties.h>
+#include <APHTML/css/Style/CSSStringTable.h>
+#include <APHTML/css/Style/CSSValue.h>
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Containers/HybridArray.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Types/RefCounted.h>
+#include <Foundation/Types/SharedPtr.h>
+
+namespace aperture::css
+{
+  class StyleCache;
+
+  /// @brief The groups the values of a ComputedStyle are stored in. Each group is shared on its own.
+  enum class StyleGroup : nsUInt8
+  {
+    Box,    ///< Box model, positioning and sizing.
+    Flex,   ///< Flex and grid container/item properties and gaps.
+    Visual, ///< Painting, transforms and everything else that is not inherited.
+    Text,   ///< All inherited properties. Children that do not change any of them share the group of their parent.
+    Count
+  };
+
+  /// @brief Returns the group a property is stored in.
+  /// @note Every inherited property must map to StyleGroup::Text, and no other (checked when the initial style is built).
+  constexpr StyleGroup GetStyleGroup(PropertyId in_id)
+  {
+    switch (in_id)
+    {
+      case PropertyId::MarginTop:
+      case PropertyId::MarginRight:
+      case PropertyId::MarginBottom:
+      case PropertyId::MarginLeft:
+      case PropertyId::PaddingTop:
+      case PropertyId::PaddingRight:
+      case PropertyId::PaddingBottom:
+      case PropertyId::PaddingLeft:
+      case PropertyId::BorderTopWidth:
+      case PropertyId::BorderRightWidth:
+      case PropertyId::BorderBottomWidth:
+      case PropertyId::BorderLeftWidth:
+      case PropertyId::Display:
+      case PropertyId::Position:
+      case PropertyId::Top:
+      case PropertyId::Right:
+      case PropertyId::Bottom:
+      case PropertyId::Left:
+      case PropertyId::Float:
+      case PropertyId::Clear:
+      case PropertyId::BoxSizing:
+      case PropertyId::ZIndex:
+      case PropertyId::Width:
+      case PropertyId::MinWidth:
+      case PropertyId::MaxWidth:
+      case PropertyId::Height:
+      case PropertyId::MinHeight:
+      case PropertyId::MaxHeight:
+      case PropertyId::VerticalAlign:
+      case PropertyId::OverflowX:
+      case PropertyId::OverflowY:
+      case PropertyId::Contain:
+      case PropertyId::Clip:
+      case PropertyId::ScrollbarMargin:
+      case PropertyId::OverscrollBehavior:
+        return StyleGroup::Box;
+
+      case PropertyId::RowGap:
+      case PropertyId::ColumnGap:
+      case PropertyId::AlignContent:
+      case PropertyId::AlignItems:
+      case PropertyId::AlignSelf:
+      case PropertyId::FlexBasis:
+      case PropertyId::FlexDirection:
+      case PropertyId::FlexGrow:
+      case PropertyId::FlexShrink:
+      case PropertyId::FlexWrap:
+      case PropertyId::JustifyContent:
+      case PropertyId::GridTemplateColumns:
+      case PropertyId::GridTemplateRows:
+      case PropertyId::GridAutoColumns:
+      case PropertyId::GridAutoRows:
+      case PropertyId::GridAutoFlow:
+      case PropertyId::GridColumnStart:
+      case PropertyId::GridColumnEnd:
+      case PropertyId::GridRowStart:
+      case PropertyId::GridRowEnd:
+        return StyleGroup::Flex;
+
+      case PropertyId::LineHeight:
+      case PropertyId::Visibility:
+      case PropertyId::Color:
+      case PropertyId::CaretColor:
+      case PropertyId::FontFamily:
+      case PropertyId::FontStyle:
+      case PropertyId::FontWeight:
+      case PropertyId::FontSize:
+      case PropertyId::LetterSpacing:
+      case PropertyId::TextAlign:
+      case PropertyId::TextTransform:
+      case PropertyId::WhiteSpace:
+      case PropertyId::WordBreak:
+      case PropertyId::Cursor:
+      case PropertyId::PointerEvents:
+      case PropertyId::Focus:
+      case PropertyId::FontEffect:
+      case PropertyId::Language:
+      case PropertyId::Direction:
+        return StyleGroup::Text;
+
+      default:
+        return StyleGroup::Visual;
+    }
+  }
+
+  /// @brief Where the value of a property lives: its group and the index inside the group.
+  struct StyleSlot
+  {
+    StyleGroup m_Group = StyleGroup::Visual;
+    nsUInt8 m_uiIndex = 0;
+  };
+
+  struct StyleGroupLayout
+  {
+    StyleSlot m_Slots[static_cast<nsUInt32>(PropertyId::NumDefinedIds)] = {};
+    nsUInt8 m_uiSizes[static_cast<nsUInt32>(StyleGroup::Count)] = {};
+  };
+
+  constexpr StyleGroupLayout MakeStyleGroupLayout()
+  {
+    StyleGroupLayout layout;
+    for (nsUInt32 i = 1; i < static_cast<nsUInt32>(PropertyId::NumDefinedIds); ++i)
+    {
+      const StyleGroup group = GetStyleGroup(static_cast<PropertyId>(i));
+      layout.m_Slots[i].m_Group = group;
+      layout.m_Slots[i].m_uiIndex = layout.m_uiSizes[static_cast<nsUInt32>(group)]++;
+    }
+    return layout;
+  }
+
+  /// @brief Maps every property to its slot, built at compile time.
+  inline constexpr StyleGroupLayout s_StyleGroupLayout = MakeStyleGroupLayout();
+
+  /*
+   * @brief The values of one StyleGroup.
+   *
+   * Groups are copy-on-write: a group that is referenced by more than one style is never modified, ComputedStyle::Set()
+   * copies it first. Groups handed out by the StyleCache are interned, every distinct group exists once.
+   *
+   * The text of STRING values lives in the group's own string table, which is kept in slot order. Two groups with the
+   * same values therefore also have the same indices, and compare and hash as raw memory plus their table.
+   */
+  template <StyleGroup Group>
+  class ComputedStyleGroup : public nsRefCounted
+  {
+  public:
+    static constexpr nsUInt32 ValueCount = s_StyleGroupLayout.m_uiSizes[static_cast<nsUInt32>(Group)];
+
+    nsUInt64 GetHash() const
+    {
+      nsUInt64 uiHash = m_uiHash;
+      if (uiHash == 0)
+      {
+        // CSSValue has no padding, so the values can be hashed as one block.
+        uiHash = nsHashingUtils::xxHash64(m_Values, sizeof(m_Values), m_Strings.GetHash());
+        if (uiHash == 0)
+          uiHash = 1;
+        m_uiHash = uiHash;
+      }
+      return uiHash;
+    }
+
+    bool IsEqual(const ComputedStyleGroup& in_other) const
+    {
+      return this == &in_other ||
+             (GetHash() == in_other.GetHash() && nsMemoryUtils::IsEqual(m_Values, in_other.m_Values, ValueCount) && m_Strings == in_other.m_Strings);
+    }
+
+    /// @brief The text of the STRING value in the slot.
+    std::string_view GetString(nsUInt32 in_uiIndex) const { return m_Strings.Get(m_Values[in_uiIndex].m_uiData); }
+
+    /// @brief Sets the value of a slot, in_text is the text of STRING values and may point into this group.
+    /// @note Only valid on groups that are not shared.
+    void SetValue(nsUInt32 in_uiIndex, const CSSValue& in_value, std::string_view in_text)
+    {
+      m_uiHash = 0;
+      const bool bString = in_value.m_Unit == core::Unit::STRING;
+      if (!bString && m_Values[in_uiIndex].m_Unit != core::Unit::STRING)
+      {
+        m_Values[in_uiIndex] = in_value;
+        return;
+      }
+
+      // Rebuilt in slot order, so the old text is dropped. Groups only hold a handful of STRING values.
+      CSSStringTable strings;
+      for (nsUInt32 i = 0; i < ValueCount; ++i)
+      {
+        if (i == in_uiIndex)
+          m_Values[i] = bString ? CSSValue::MakeString(strings.Add(in_text)) : in_value;
+        else if (m_Values[i].m_Unit == core::Unit::STRING)
+          m_Values[i].m_uiData = strings.Add(m_Strings.Get(m_Values[i].m_uiData));
+      }
+      m_Strings = std::move(strings);
+    }
+
+    CSSValue m_Values[ValueCount];
+    CSSStringTable m_Strings;
+    /// @brief Computed on first use. Interned groups are shared between threads, which may all compute it at once.
+    mutable nsAtomicInteger<nsUInt64> m_uiHash;
+  };
+
+  using BoxStyle = ComputedStyleGroup<StyleGroup::Box>;
+  using FlexStyle = ComputedStyleGroup<StyleGroup::Flex>;
+  using VisualStyle = ComputedStyleGroup<StyleGroup::Visual>;
+  using TextStyle = ComputedStyleGroup<StyleGroup::Text>;
+
+  /*
+   * @brief The computed values of all properties of a element.
+   *
+   * Computed styles are immutable once they were handed out by the StyleCache, and are shared by every element that
+   * ends up with the same values. Comparing two styles is a pointer comparison, as long as both came from the same cache.
+   *
+   * The values are split into groups (see StyleGroup) that are shared by pointer. A default constructed style references
+   * the groups of the initial style, InheritFrom() takes the inherited group of the parent. Building the style of a element
+   * therefore only copies the groups it actually changes.
+   *
+   * @note Build a style on the stack (or copy one), set its values, then call StyleCache::GetOrAdd().
+   */
+  class NS_APERTURE_DLL ComputedStyle : public nsRefCounted
+  {
+  public:
+    static constexpr nsUInt32 PropertyCount = static_cast<nsUInt32>(PropertyId::NumDefinedIds);
+
+    /// @brief Creates a style with the initial value of every property.
+    ComputedStyle();
+
+    /// @brief The style with the initial value of every property.
+    static const ComputedStyle& GetInitialStyle();
+
+    const CSSValue& Get(PropertyId in_id) const
+    {
+      const StyleSlot& slot = s_StyleGroupLayout.m_Slots[static_cast<nsUInt32>(in_id)];
+      return GetGroupValues(slot.m_Group)[slot.m_uiIndex];
+    }
+
+    /// @brief Only valid until the style was added to a cache. Copies the group of the property if it is shared.
+    /// STRING values are set with SetString().
+    void Set(PropertyId in_id, const CSSValue& in_value);
+
+    /// @brief The text of a STRING value, empty for other values.
+    std::string_view GetString(PropertyId in_id) const;
+
+    /// @brief Sets a STRING value, the style keeps its own copy of the text. See Set().
+    void SetString(PropertyId in_id, std::string_view in_text);
+
+    /// @brief Takes over the value of the property from another style, including the text of a STRING value. See Set().
+    void CopyValue(PropertyId in_id, const ComputedStyle& in_source);
+
+    /// @brief Whether the property has the same value in both styles. STRING values are compared by their text.
+    bool HasSameValue(PropertyId in_id, const ComputedStyle& in_other) const;
+
+    /// @brief Shares the inherited group and the custom properties of the parent. Call before setting any inherited value.
+    void InheritFrom(const ComputedStyle& in_parent);
+
+    /// @brief The custom properties of the element, null if it has none.
+    const CSSCustomProperties* GetCustomProperties() const { return m_pCustomProperties.Borrow(); }
+    const nsSharedPtr<const CSSCustomProperties>& GetCustomPropertiesRef() const { return m_pCustomProperties; }
+    void SetCustomProperties(nsSharedPtr<const CSSCustomProperties> in_pProperties);
+
+    /// @brief CSSCustomProperties::GetNameBit() of every custom property the values of this style depend on: the ones
+    /// referenced by var() and the ones the element declares itself. Elements whose mask doesn't contain a changed
+    /// name only have to take over the new custom properties of their parent when those change.
+    nsUInt64 GetVariableMask() const { return m_uiVariableMask; }
+    void AddToVariableMask(nsUInt64 in_uiBits)
+    {
+      m_uiVariableMask |= in_uiBits;
+      m_uiHash = 0;
+    }
+
+    /// @brief Returns true if a declaration for the property took part in the cascade of the element.
+    bool IsExplicitlySet(PropertyId in_id) const
+    {
+      const nsUInt32 uiId = static_cast<nsUInt32>(in_id);
+      return (m_uiExplicitlySet[uiId >> 6] & (nsUInt64(1) << (uiId & 63))) != 0;
+    }
+    void MarkExplicitlySet(PropertyId in_id)
+    {
+      const nsUInt32 uiId = static_cast<nsUInt32>(in_id);
+      m_uiExplicitlySet[uiId >> 6] |= nsUInt64(1) << (uiId & 63);
+      m_uiHash = 0;
+    }
+
+    const BoxStyle& GetBox() const { return *m_pBox; }
+    const FlexStyle& GetFlex() const { return *m_pFlex; }
+    const VisualStyle& GetVisual() const { return *m_pVisual; }
+    const TextStyle& GetText() const { return *m_pText; }
+
+    nsUInt64 GetHash() const;
+    bool IsEqual(const ComputedStyle& in_other) const;
+
+  private:
+    friend class StyleCache;
+
+    struct NoGroupsTag
+    {
+    };
+    /// @brief Leaves all groups null, only used to build the initial style.
+    explicit ComputedStyle(NoGroupsTag);
+
+    const CSSValue* GetGroupValues(StyleGroup in_group) const;
+    const CSSStringTable& GetGroupStrings(StyleGroup in_group) const;
+
+    void SetValue(PropertyId in_id, const CSSValue& in_value, std::string_view in_text);
+
+    template <typename GroupType>
+    static GroupType& GetWritableGroup(nsSharedPtr<GroupType>& inout_pGroup);
+
+    /// @brief Returns true if both styles reference the same groups and have the same explicitly set properties.
+    bool HasSameGroups(const ComputedStyle& in_other) const;
+
+    nsSharedPtr<BoxStyle> m_pBox;
+    nsSharedPtr<FlexStyle> m_pFlex;
+    nsSharedPtr<VisualStyle> m_pVisual;
+    nsSharedPtr<TextStyle> m_pText;
+    nsSharedPtr<const CSSCustomProperties> m_pCustomProperties;
+    nsUInt64 m_uiVariableMask = 0;
+    /// @brief One bit per PropertyId, 128 bits cover custom ids as well.
+    nsUInt64 m_uiExplicitlySet[2] = {};
+    /// @brief Computed on first use, like the hash of the groups.
+    mutable nsAtomicInteger<nsUInt64> m_uiHash;
+  };
+  static_assert(static_cast<nsUInt32>(PropertyId::MaxNumIds) <= 128, "The explicitly set mask of ComputedStyle needs more bits.");
+
+  /*
+   * @brief Hash-consing cache of computed styles: every distinct set of values exists once.
+   *
+   * The groups of every added style are interned first, so styles are looked up by the identity of their groups.
+   *
+   * Styles and groups are spread over ShardCount shards by their hash, each with its own lock. Threads resolving
+   * different subtrees (see StyleResolver::ResolveStylesParallel()) rarely hit the same shard at the same time.
+   *
+   * @note Thread-safe.
+   */
+  class NS_APERTURE_DLL StyleCache
+  {
+  public:
+    static constexpr nsUInt32 ShardCount = 16;
+
+    StyleCache() = default;
+    ~StyleCache();
+
+    /// @brief Returns the cached style with the same values, or adds a copy of the given one.
+    nsSharedPtr<const ComputedStyle> GetOrAdd(const ComputedStyle& in_style);
+
+    /// @brief Drops styles and groups that are only referenced by the cache.
+    /// @return The number of styles that were released.
+    /// @note Must not run concurrently with style resolution.
+    nsUInt32 CollectGarbage();
+
+    void Clear();
+
+    nsUInt32 GetStyleCount() const;
+    nsUInt32 GetGroupCount(StyleGroup in_group) const;
+
+    struct Stats
+    {
+      nsUInt64 m_uiLookups = 0;
+      nsUInt64 m_uiHits = 0;
+    };
+    Stats GetStats() const;
+
+  private:
+    template <typename GroupType>
+    struct GroupTable
+    {
+      nsHashTable<nsUInt64, nsHybridArray<nsSharedPtr<GroupType>, 1>> m_Groups;
+      nsUInt32 m_uiCount = 0;
+    };
+
+    struct Shard
+    {
+      mutable nsMutex m_Mutex;
+      nsHashTable<nsUInt64, nsHybridArray<nsSharedPtr<const ComputedStyle>, 1>> m_Styles;
+      nsUInt32 m_uiStyleCount = 0;
+      GroupTable<BoxStyle> m_BoxGroups;
+      GroupTable<FlexStyle> m_FlexGroups;
+      GroupTable<VisualStyle> m_VisualGroups;
+      GroupTable<TextStyle> m_TextGroups;
+      GroupTable<const CSSCustomProperties> m_CustomProperties;
+      Stats m_Stats;
+    };
+
+    Shard& GetShard(nsUInt64 in_uiHash) { return m_Shards[(in_uiHash >> 32) % ShardCount]; }
+
+    template <typename GroupType>
+    void InternGroup(GroupTable<GroupType> Shard::*in_pTable, nsSharedPtr<GroupType>& inout_pGroup);
+    template <typename GroupType>
+    static void CollectGarbage(GroupTable<GroupType>& inout_table);
+
+    Shard m_Shards[ShardCount];
+  };
+} // namespace aperture::css
@@ -0,0 +1,107 @@
+#include <APHTML/css/Style/StyleInvalidator.h>
+
+using namespace aperture;
+using namespace aperture::css;
+
+StyleInvalidator::StyleInvalidator(const CSSInvalidationMap& in_map)
+  : m_Map(in_map)
+{
+}
+
+StyleInvalidator::~StyleInvalidator() = default;
+
+void StyleInvalidator::OnAttributeChanged(dom::DOMElement& in_element, const std::string& in_name, nsArrayPtr<const core::Atom> in_oldClasses, core::Atom in_oldId)
+{
+  ++m_Stats.m_uiChanges;
+
+  CSSInvalidationScope::StorageType uiScope = CSSInvalidationScope::None;
+  if (in_name == "style")
+  {
+    // Inline declarations only apply to the element itself.
+    uiScope |= CSSInvalidationScope::Self;
+  }
+  else if (in_name == "class")
+  {
+    // Only classes that were added or removed matter.
+    const auto& newClasses = in_element.getClassAtoms();
+    for (core::Atom oldClass : in_oldClasses)
+    {
+      if (!newClasses.Contains(oldClass))
+        uiScope |= GetClassScope(oldClass);
+    }
+    for (core::Atom newClass : newClasses)
+    {
+      if (!in_oldClasses.Contains(newClass))
+        uiScope |= GetClassScope(newClass);
+    }
+  }
+  else if (in_name == "id" && in_oldId != in_element.getIdAtom())
+  {
+    for (core::Atom id : {in_oldId, in_element.getIdAtom()})
+    {
+      if (const CSSInvalidationMap::Dependency* pDependency = m_Map.FindId(id))
+        uiScope |= pDependency->m_uiScope;
+    }
+  }
+
+  // Attribute selectors can also test class, id and style. The name is lowercase already, a name no selector uses was never interned.
+  if (const CSSInvalidationMap::Dependency* pDependency = m_Map.FindAttribute(core::AtomTable::Get().Find(in_name)))
+    uiScope |= pDependency->m_uiScope;
+
+  if (uiScope == CSSInvalidationScope::None)
+  {
+    ++m_Stats.m_uiIgnoredChanges;
+    return;
+  }
+  Invalidate(in_element, uiScope);
+}
+
+void StyleInvalidator::OnStateChanged(dom::DOMElement& in_element, nsUInt32 in_changedFlags)
+{
+  ++m_Stats.m_uiChanges;
+
+  const CSSInvalidationScope::StorageType uiScope = m_Map.GetStateScope(in_changedFlags);
+  if (uiScope == CSSInvalidationScope::None)
+  {
+    ++m_Stats.m_uiIgnoredChanges;
+    return;
+  }
+  Invalidate(in_element, uiScope);
+}
+
+void StyleInvalidator::Invalidate(dom::DOMElement& in_element, CSSInvalidationScope::StorageType in_uiScope)
+{
+  dom::StyleDirty::StorageType uiFlags = dom::StyleDirty::None;
+  if ((in_uiScope & CSSInvalidationScope::Self) != 0)
+    uiFlags |= dom::StyleDirty::Self;
+  if ((in_uiScope & CSSInvalidationScope::Descendants) != 0)
+    uiFlags |= dom::StyleDirty::Descendants;
+  if (uiFlags != dom::StyleDirty::None)
+    in_element.markStyleDirty(uiFlags);
+
+  if ((in_uiScope & CSSInvalidationScope::Siblings) != 0)
+  {
+    dom::DOMElement* pParent = in_element.getParentElementPtr();
+    if (pParent == nullptr)
+      return;
+
+    // Every later sibling, with its subtree.
+    bool bAfterElement = false;
+    for (const std::shared_ptr<dom::DOMNode>& pChild : pParent->getChildNodes())
+    {
+      if (pChild.get() == &in_element)
+      {
+        bAfterElement = true;
+        continue;
+      }
+      if (bAfterElement && pChild->getNodeType() == dom::DOMNodeType::ELEMENT_NODE)
+        static_cast<dom::DOMElement&>(*pChild).markStyleDirty(dom::StyleDirty::Subtree);
+    }
+  }
+}
+
+CSSInvalidationScope::StorageType StyleInvalidator::GetClassScope(core::Atom in_class) const
+{
+  const CSSInvalidationMap::Dependency* pDependency = m_Map.FindClass(in_class);
+  return pDependency != nullptr ? pDependency->m_uiScope : static_cast<CSSInvalidationScope::StorageType>(CSSInvalidationScope::None);
+}
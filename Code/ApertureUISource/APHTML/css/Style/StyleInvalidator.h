@@ -32,58 +32,47 @@ STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
 ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
 EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
-
 #pragma once
 
-#include <APHTML/APEngineCommonIncludes.h>
-#include <APHTML/layout/Core/LayoutCore.h>
-
-#include <vector>
-#include <yoga/Yoga.h>
+#include <APHTML/css/Selector/CSSInvalidationMap.h>
+#include <APHTML/dom/DOMElement.h>
 
-namespace aperture::layout
+namespace aperture::css
 {
-  class InlineBox
+  /*
+   * @brief Turns DOM changes into pending restyles, using the invalidation map of a StyleResolver.
+   *
+   * Set it as observer on the root element (DOMElement::setObserver()). Every class, id, attribute or state change is
+   * checked against the selectors, and the elements that can be affected are flagged with dom::StyleDirty.
+   * StyleResolver::UpdateStyles() then only recomputes the flagged elements.
+   *
+   * @note The invalidation map is referenced, it must stay alive as long as the invalidator is in use.
+   */
+  class NS_APERTURE_DLL StyleInvalidator : public dom::DOMElementObserver
   {
   public:
-    ~InlineBox();
-
-    InlineBox()
-      : width(0)
-      , height(0)
-      , baseline(0)
-      , verticalAlign(VerticalAlign::Baseline)
-      , verticalOffset(0)
-    {
-      yogaNode = YGNodeNew();
-      configureYogaNode();
-    }
-    void setSize(float width, float height); // Set box dimensions
-    void setBaseline(float baseline);        // Set baseline provided by an external module
-    void setVerticalAlign(VerticalAlign align, float length = 0.0f);
+    explicit StyleInvalidator(const CSSInvalidationMap& in_map);
+    ~StyleInvalidator();
 
-    VerticalAlign getVerticalAlign() const;
-    float getVerticalOffset() const;
+    virtual void OnAttributeChanged(dom::DOMElement& in_element, const std::string& in_name, nsArrayPtr<const core::Atom> in_oldClasses, core::Atom in_oldId) override;
+    virtual void OnStateChanged(dom::DOMElement& in_element, nsUInt32 in_changedFlags) override;
 
-    void addChild(std::shared_ptr<InlineBox> child);
-    void layout(float availableWidth); // Perform layout calculations
-    virtual void render();                     // Stub/TODO: Verification logic goes here!
+    /// @brief Flags the elements in the scope of a change on the element.
+    static void Invalidate(dom::DOMElement& in_element, CSSInvalidationScope::StorageType in_uiScope);
 
-    YGNodeRef getYogaNode(); // Access Yoga node for external use
+    struct Stats
+    {
+      nsUInt32 m_uiChanges = 0;
+      /// @brief Changes that did not require any restyle.
+      nsUInt32 m_uiIgnoredChanges = 0;
+    };
+    const Stats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = Stats(); }
 
   private:
-    float width;
-    float height;
-    float baseline; // Baseline from external module
-
-    VerticalAlign verticalAlign;
-    float verticalOffset; // Offset for length-based alignment
-
-    std::vector<std::shared_ptr<InlineBox>> children;
-    YGNodeRef yogaNode;
+    CSSInvalidationScope::StorageType GetClassScope(core::Atom in_class) const;
 
-    void configureYogaNode();
-    void handleOverflow(float availableWidth);
-    static float calculateBaseline(YGNodeConstRef node, float width, float height);
+    const CSSInvalidationMap& m_Map;
+    Stats m_Stats;
   };
-} // namespace aperture::layout
+} // namespace aperture::css
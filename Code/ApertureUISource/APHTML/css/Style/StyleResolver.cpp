@@ -0,0 +1,980 @@
+#include <APHTML/css/Function/CSSVarFunction.h>
+#include <APHTML/css/Selector/CSSAncestorFilter.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/dom/DOMFlatTree.h>
+#include <Foundation/Containers/StaticArray.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Threading/TaskSystem.h>
+
+using namespace aperture;
+using namespace aperture::css;
+
+namespace
+{
+  constexpr nsUInt32 PropertyCount = ComputedStyle::PropertyCount;
+
+  /// A declaration that won the cascade, and the string table of its sheet (or style attribute) for STRING values.
+  struct Winner
+  {
+    NS_DECLARE_POD_TYPE();
+
+    const CSSDeclaration* m_pDeclaration;
+    const CSSStringTable* m_pStrings;
+
+    std::string_view GetText() const { return m_pStrings->Get(m_pDeclaration->m_Value.m_uiData); }
+  };
+
+  using CustomDeclarations = nsHybridArray<Winner, 8>;
+
+  void ApplyDeclarations(nsArrayPtr<const CSSDeclaration> in_declarations, const CSSStringTable& in_strings, bool in_bImportant, Winner* inout_pWinners,
+    CustomDeclarations& inout_customWinners)
+  {
+    for (const CSSDeclaration& declaration : in_declarations)
+    {
+      if (declaration.m_bImportant != in_bImportant)
+        continue;
+
+      if (!declaration.IsCustomProperty())
+      {
+        inout_pWinners[static_cast<nsUInt32>(declaration.m_Property)] = {&declaration, &in_strings};
+        continue;
+      }
+
+      // Elements rarely declare more than a handful of custom properties, a linear search is fine.
+      bool bReplaced = false;
+      for (Winner& winner : inout_customWinners)
+      {
+        if (winner.m_pDeclaration->m_Name == declaration.m_Name)
+        {
+          winner = {&declaration, &in_strings};
+          bReplaced = true;
+          break;
+        }
+      }
+      if (!bReplaced)
+        inout_customWinners.PushBack({&declaration, &in_strings});
+    }
+  }
+
+  std::string_view GetAtomText(core::Atom in_atom)
+  {
+    const nsStringView text = core::AtomTable::Get().GetString(in_atom);
+    return std::string_view(text.GetStartPointer(), text.GetElementCount());
+  }
+
+  /*
+   * Computes the custom properties declared on one element. Declarations reference each other through var(), which
+   * forms a dependency graph: every declaration is substituted after the ones it references. Declarations that are
+   * part of a cycle get the guaranteed-invalid value, references to them fall back to their fallback.
+   */
+  class CustomPropertyGraph
+  {
+  public:
+    CustomPropertyGraph(nsArrayPtr<const Winner> in_declarations, const CSSCustomProperties* in_pParent, CSSCustomProperties& inout_properties)
+      : m_Declarations(in_declarations)
+      , m_pParent(in_pParent)
+      , m_Properties(inout_properties)
+    {
+      m_States.SetCount(in_declarations.GetCount());
+    }
+
+    /// @return CSSCustomProperties::GetNameBit() of every declared and referenced name.
+    nsUInt64 Resolve()
+    {
+      for (nsUInt32 i = 0; i < m_Declarations.GetCount(); ++i)
+      {
+        if (m_States[i].m_uiState == Unvisited)
+          Visit(i);
+      }
+      return m_uiNames;
+    }
+
+  private:
+    enum : nsUInt8
+    {
+      Unvisited,
+      Visiting,
+      Done
+    };
+
+    struct NodeState
+    {
+      NS_DECLARE_POD_TYPE();
+
+      nsUInt8 m_uiState;
+      bool m_bInCycle;
+    };
+
+    nsUInt32 Find(core::Atom in_name) const
+    {
+      for (nsUInt32 i = 0; i < m_Declarations.GetCount(); ++i)
+      {
+        if (m_Declarations[i].m_pDeclaration->m_Name == in_name)
+          return i;
+      }
+      return nsInvalidIndex;
+    }
+
+    void Visit(nsUInt32 in_uiIndex)
+    {
+      const CSSDeclaration& declaration = *m_Declarations[in_uiIndex].m_pDeclaration;
+      m_States[in_uiIndex].m_uiState = Visiting;
+      m_Path.PushBack(in_uiIndex);
+      m_uiNames |= CSSCustomProperties::GetNameBit(declaration.m_Name);
+
+      const std::string_view text = declaration.m_WideKeyword == CSSWideKeyword::None ? m_Declarations[in_uiIndex].GetText() : std::string_view();
+      if (declaration.m_WideKeyword == CSSWideKeyword::None && declaration.m_bHasVariables)
+      {
+        nsHybridArray<core::Atom, 4> references;
+        CSSVarFunction::CollectReferences(text, references);
+        for (core::Atom reference : references)
+        {
+          m_uiNames |= CSSCustomProperties::GetNameBit(reference);
+
+          const nsUInt32 uiTarget = Find(reference);
+          if (uiTarget == nsInvalidIndex)
+            continue;
+
+          if (m_States[uiTarget].m_uiState == Visiting)
+          {
+            // Everything on the path from the target up to here is part of the cycle.
+            for (nsUInt32 i = m_Path.GetCount(); i-- > 0;)
+            {
+              m_States[m_Path[i]].m_bInCycle = true;
+              if (m_Path[i] == uiTarget)
+                break;
+            }
+          }
+          else if (m_States[uiTarget].m_uiState == Unvisited)
+          {
+            Visit(uiTarget);
+          }
+        }
+      }
+
+      m_Path.PopBack();
+      m_States[in_uiIndex].m_uiState = Done;
+
+      // The text is copied into the set, nothing here is interned.
+      std::string_view value;
+      bool bValid = false;
+      switch (declaration.m_WideKeyword)
+      {
+        case CSSWideKeyword::Inherit:
+        case CSSWideKeyword::Unset:
+          bValid = m_pParent != nullptr && m_pParent->TryGet(declaration.m_Name, value);
+          break;
+        case CSSWideKeyword::Initial:
+          break;
+        default:
+          if (!declaration.m_bHasVariables)
+          {
+            value = text;
+            bValid = true;
+          }
+          else if (!m_States[in_uiIndex].m_bInCycle && CSSVarFunction(&m_Properties).Substitute(text, m_Substituted).Succeeded())
+          {
+            value = m_Substituted;
+            bValid = true;
+          }
+          break;
+      }
+
+      if (bValid)
+        m_Properties.Set(declaration.m_Name, value);
+      else
+        m_Properties.Remove(declaration.m_Name);
+    }
+
+    nsArrayPtr<const Winner> m_Declarations;
+    const CSSCustomProperties* m_pParent;
+    CSSCustomProperties& m_Properties;
+    nsHybridArray<NodeState, 8> m_States;
+    nsHybridArray<nsUInt32, 8> m_Path;
+    nsUInt64 m_uiNames = 0;
+    std::string m_Substituted;
+  };
+
+  /// Substitutes the var() references of a declaration, parses the result as the longhand in_id and sets it.
+  /// Values that can't be substituted or parsed are invalid at computed-value time and behave like unset.
+  void ApplyValueWithVariables(const Winner& in_winner, PropertyId in_id, ComputedStyle& inout_style, const ComputedStyle& in_parent, nsUInt64& inout_uiNames)
+  {
+    const CSSDeclaration& declaration = *in_winner.m_pDeclaration;
+    const std::string_view text = in_winner.GetText();
+
+    nsHybridArray<core::Atom, 4> references;
+    CSSVarFunction::CollectReferences(text, references);
+    for (core::Atom reference : references)
+    {
+      inout_uiNames |= CSSCustomProperties::GetNameBit(reference);
+    }
+
+    // The parsed text only lives until the style has its own copy.
+    std::string substituted;
+    nsHybridArray<CSSDeclaration, 4> parsed;
+    CSSStringTable strings;
+    if (CSSVarFunction(inout_style.GetCustomProperties()).Substitute(text, substituted).Succeeded() &&
+        CSSPropertyTable::ParseDeclaration(GetAtomText(declaration.m_Name), substituted, false, parsed, strings).Succeeded())
+    {
+      for (const CSSDeclaration& longhand : parsed)
+      {
+        if (longhand.m_Property != in_id || longhand.m_WideKeyword != CSSWideKeyword::None || longhand.m_bHasVariables)
+          continue;
+
+        if (longhand.m_Value.m_Unit == core::Unit::STRING)
+          inout_style.SetString(in_id, strings.Get(longhand.m_Value.m_uiData));
+        else
+          inout_style.Set(in_id, longhand.m_Value);
+        return;
+      }
+    }
+
+    inout_style.CopyValue(in_id, CSSPropertyTable::IsInherited(in_id) ? in_parent : ComputedStyle::GetInitialStyle());
+  }
+
+  bool AcceptsColor(PropertyId in_id)
+  {
+    return (CSSPropertyTable::GetInfo(in_id).m_uiKinds & CSSValueKind::Color) != 0;
+  }
+
+  /// @brief Properties with currentcolor as initial value, they follow the color even when they are not declared.
+  nsArrayPtr<const nsUInt8> GetCurrentColorProperties()
+  {
+    static const nsStaticArray<nsUInt8, 8> s_Properties = []() {
+      nsStaticArray<nsUInt8, 8> properties;
+      const core::Atom currentColor = CSSPropertyTable::GetKeywords().m_CurrentColor;
+      for (nsUInt32 i = 1; i < ComputedStyle::PropertyCount; ++i)
+      {
+        if (ComputedStyle::GetInitialStyle().Get(static_cast<PropertyId>(i)).IsKeyword(currentColor))
+          properties.PushBack(static_cast<nsUInt8>(i));
+      }
+      return properties;
+    }();
+    return s_Properties;
+  }
+
+  /// @brief Whether the style declares transitions or animations, which is what the StyleAnimator has to see.
+  bool HasAnimations(const ComputedStyle& in_style)
+  {
+    const ComputedStyle& initial = ComputedStyle::GetInitialStyle();
+    return !in_style.HasSameValue(PropertyId::Transition, initial) || !in_style.HasSameValue(PropertyId::Animation, initial);
+  }
+
+  /// Flags every element of the subtree that one of the rules matches.
+  void MarkMatchingElements(dom::DOMElement& in_element, const CSSRuleMap& in_rules, CSSAncestorFilter& inout_filter,
+    nsDynamicArray<CSSMatchedRule>& inout_matched, nsUInt32& inout_uiMarked)
+  {
+    inout_matched.Clear();
+    in_rules.CollectMatchingRules(in_element, &inout_filter, inout_matched);
+    if (!inout_matched.IsEmpty())
+    {
+      in_element.markStyleDirty(dom::StyleDirty::Self);
+      ++inout_uiMarked;
+    }
+
+    inout_filter.PushElement(in_element);
+    for (const std::shared_ptr<dom::DOMNode>& pChild : in_element.getChildNodes())
+    {
+      if (pChild != nullptr && pChild->getNodeType() == dom::DOMNodeType::ELEMENT_NODE)
+        MarkMatchingElements(static_cast<dom::DOMElement&>(*pChild), in_rules, inout_filter, inout_matched, inout_uiMarked);
+    }
+    inout_filter.PopElement();
+  }
+
+  constexpr nsUInt32 MatchCacheSize = 64;
+  /// @brief Parallel resolution never resolves more levels than this on the calling thread, even for narrow trees.
+  constexpr nsUInt32 MaxSerialLevels = 8;
+} // namespace
+
+struct StyleResolver::ResolveContext
+{
+  /// @brief A recently computed style, keyed by the rules that matched and the style of the parent.
+  /// Elements in different parents that are styled alike (e.g. the items of two equal panels) hit the same entry.
+  struct MatchCacheEntry
+  {
+    nsUInt64 m_uiKey = 0;
+    /// @brief Not referenced. Every parent style of a pass is kept alive by the StyleCache, and the cache is cleared per pass.
+    const ComputedStyle* m_pParentStyle = nullptr;
+    nsHybridArray<CSSMatchedRule, 8> m_Rules;
+    nsSharedPtr<const ComputedStyle> m_pStyle;
+  };
+
+  void BeginPass()
+  {
+    m_Filter.Clear();
+    m_bUseMatchCache = true;
+  }
+
+  void EndPass(Stats& inout_stats)
+  {
+    inout_stats.m_uiResolvedElements += m_Stats.m_uiResolvedElements;
+    inout_stats.m_uiSharedWithSibling += m_Stats.m_uiSharedWithSibling;
+    inout_stats.m_uiSharedWithCousin += m_Stats.m_uiSharedWithCousin;
+    inout_stats.m_uiInheritedVariableChanges += m_Stats.m_uiInheritedVariableChanges;
+    inout_stats.m_uiAnimatedElements += m_Stats.m_uiAnimatedElements;
+    inout_stats.m_uiMediaQueryInvalidations += m_Stats.m_uiMediaQueryInvalidations;
+    m_Stats = Stats();
+
+    m_bUseMatchCache = false;
+    for (MatchCacheEntry& entry : m_MatchCache)
+    {
+      entry.m_pParentStyle = nullptr;
+      entry.m_pStyle.Clear();
+    }
+  }
+
+  CSSAncestorFilter m_Filter;
+  nsDynamicArray<CSSMatchedRule> m_MatchedRules;
+  Stats m_Stats;
+  bool m_bUseMatchCache = false;
+  MatchCacheEntry m_MatchCache[MatchCacheSize];
+};
+
+struct StyleResolver::SharingCandidates
+{
+  NS_DECLARE_POD_TYPE();
+
+  const dom::DOMElement* m_pElements[SharingCandidateCount];
+  nsUInt32 m_uiCount;
+  /// @brief Once full, the oldest candidate is replaced.
+  nsUInt32 m_uiNext;
+};
+
+StyleResolver::StyleResolver(StyleCache& in_cache)
+  : m_Cache(in_cache)
+  , m_pContext(NS_DEFAULT_NEW(ResolveContext))
+{
+}
+
+StyleResolver::~StyleResolver() = default;
+
+void StyleResolver::AddStyleSheet(const CSSStyleSheet* in_pStyleSheet)
+{
+  if (in_pStyleSheet == nullptr)
+    return;
+
+  m_StyleSheets.PushBack(in_pStyleSheet);
+
+  // Media blocks of all sheets share one bitset, the blocks of this sheet start at uiFirstBlock.
+  const nsUInt32 uiFirstBlock = m_MediaQueries.GetBlockCount();
+  for (nsUInt32 b = 0; b < in_pStyleSheet->GetMediaBlockCount(); ++b)
+  {
+    const CSSStyleSheet::MediaBlock& block = in_pStyleSheet->GetMediaBlock(b);
+    m_MediaQueries.AddBlock(&block.m_Queries, block.m_uiParent != CSSStyleSheet::NoMediaBlock ? uiFirstBlock + block.m_uiParent : CSSMediaQueryCache::NoParent);
+  }
+  if (in_pStyleSheet->GetMediaBlockCount() != 0)
+    m_MediaResults = m_MediaQueries.Evaluate(m_MediaEnvironment);
+
+  for (nsUInt32 uiRule = 0; uiRule < in_pStyleSheet->GetRuleCount(); ++uiRule)
+  {
+    const CSSStyleSheet::Rule& rule = in_pStyleSheet->GetRule(uiRule);
+    const nsUInt32 uiRuleRef = m_Rules.GetCount();
+    m_Rules.PushBack({in_pStyleSheet, uiRule, rule.m_uiMediaBlock != CSSStyleSheet::NoMediaBlock ? uiFirstBlock + rule.m_uiMediaBlock : CSSMediaQueryCache::NoParent});
+
+    for (nsUInt32 s = 0; s < rule.m_uiSelectorCount; ++s)
+    {
+      const CSSSelector& selector = in_pStyleSheet->GetSelector(rule.m_uiFirstSelector + s);
+      m_bHasPositionalRules |= selector.DependsOnSiblings();
+      // The rule index doubles as source order, rules of later stylesheets come later.
+      m_RuleMap.AddSelector(&selector, uiRuleRef, uiRuleRef);
+      m_InvalidationMap.AddSelector(selector, uiRuleRef);
+    }
+  }
+}
+
+void StyleResolver::ClearStyleSheets()
+{
+  m_RuleMap.Clear();
+  m_InvalidationMap.Clear();
+  m_Rules.Clear();
+  m_StyleSheets.Clear();
+  m_MediaQueries.Clear();
+  m_MediaResults.Clear();
+  m_MediaChangedRules.Clear();
+  m_bHasPositionalRules = false;
+}
+
+void StyleResolver::SetMediaEnvironment(const MediaEnvironment& in_environment)
+{
+  if (in_environment == m_MediaEnvironment)
+    return;
+
+  m_MediaEnvironment = in_environment;
+  if (m_MediaQueries.GetBlockCount() == 0)
+    return;
+
+  // Only rules of blocks that flipped can match differently now, everything else keeps its style.
+  const nsDynamicBitfield& results = m_MediaQueries.Evaluate(in_environment);
+  for (nsUInt32 uiRuleRef = 0; uiRuleRef < m_Rules.GetCount(); ++uiRuleRef)
+  {
+    const nsUInt32 uiBlock = m_Rules[uiRuleRef].m_uiMediaBlock;
+    if (uiBlock != CSSMediaQueryCache::NoParent && results.IsBitSet(uiBlock) != m_MediaResults.IsBitSet(uiBlock))
+      m_MediaChangedRules.PushBack(uiRuleRef);
+  }
+  m_MediaResults = results;
+}
+
+const CSSStyleSheet* StyleResolver::FindKeyframesStyleSheet(core::Atom in_name) const
+{
+  for (nsUInt32 i = m_StyleSheets.GetCount(); i-- > 0;)
+  {
+    if (m_StyleSheets[i]->FindKeyframesRule(in_name) != nullptr)
+      return m_StyleSheets[i];
+  }
+  return nullptr;
+}
+
+void StyleResolver::ResolveStyles(dom::DOMElement& in_root)
+{
+  NS_PROFILE_SCOPE("StyleResolver::ResolveStyles");
+
+  ResolveContext& context = *m_pContext;
+  context.BeginPass();
+  PushAncestors(in_root, context.m_Filter);
+  ResolveRoot(in_root, context);
+  ResolveChildren(in_root, context, true);
+  context.EndPass(m_Stats);
+}
+
+void StyleResolver::ResolveStylesParallel(dom::DOMElement& in_root, nsUInt32 in_uiMaxThreads)
+{
+  const nsUInt32 uiThreads = in_uiMaxThreads != 0 ? in_uiMaxThreads : nsTaskSystem::GetWorkerThreadCount(nsWorkerThreadType::ShortTasks);
+  if (uiThreads <= 1)
+  {
+    ResolveStyles(in_root);
+    return;
+  }
+
+  NS_PROFILE_SCOPE("StyleResolver::ResolveStylesParallel");
+
+  ResolveContext& context = *m_pContext;
+  context.BeginPass();
+  PushAncestors(in_root, context.m_Filter);
+  ResolveRoot(in_root, context);
+
+  // Resolve the top of the tree level by level, until there are enough subtrees to keep every thread busy.
+  // The subtrees only read their ancestors, so they can be resolved in any order.
+  nsDynamicArray<dom::DOMElement*> subtrees;
+  nsDynamicArray<dom::DOMElement*> nextLevel;
+  subtrees.PushBack(&in_root);
+  for (nsUInt32 uiLevel = 0; uiLevel < MaxSerialLevels && !subtrees.IsEmpty() && subtrees.GetCount() < uiThreads * SubtreesPerThread; ++uiLevel)
+  {
+    nextLevel.Clear();
+    for (dom::DOMElement* pParent : subtrees)
+    {
+      context.m_Filter.Clear();
+      PushAncestors(*pParent, context.m_Filter);
+      ResolveChildren(*pParent, context, false);
+
+      for (const std::shared_ptr<dom::DOMNode>& pChild : pParent->getChildNodes())
+      {
+        if (pChild != nullptr && pChild->getNodeType() == dom::DOMNodeType::ELEMENT_NODE)
+          nextLevel.PushBack(static_cast<dom::DOMElement*>(pChild.get()));
+      }
+    }
+    subtrees.Swap(nextLevel);
+  }
+  context.EndPass(m_Stats);
+
+  while (m_WorkerContexts.GetCount() < uiThreads)
+  {
+    m_WorkerContexts.PushBack(NS_DEFAULT_NEW(ResolveContext));
+  }
+
+  // One task per thread, each pulls subtrees until none are left. Subtrees differ a lot in size, a static split would leave threads idle.
+  nsAtomicInteger32 iNextSubtree;
+  nsParallelForParams params;
+  params.m_uiBinSize = 1;
+  params.m_uiMaxTasksPerThread = uiThreads;
+
+  nsTaskSystem::ParallelForIndexed(
+    0, uiThreads, [&](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex) {
+      for (nsUInt32 uiSlot = uiStartIndex; uiSlot < uiEndIndex; ++uiSlot)
+      {
+        ResolveContext& worker = *m_WorkerContexts[uiSlot];
+        worker.BeginPass();
+        for (nsUInt32 i = static_cast<nsUInt32>(iNextSubtree.PostIncrement()); i < subtrees.GetCount(); i = static_cast<nsUInt32>(iNextSubtree.PostIncrement()))
+        {
+          dom::DOMElement& subtree = *subtrees[i];
+          worker.m_Filter.Clear();
+          PushAncestors(subtree, worker.m_Filter);
+          ResolveChildren(subtree, worker, true);
+        }
+      }
+    },
+    "StyleResolver::ResolveSubtrees", nsTaskNesting::Never, params);
+
+  for (nsUInt32 i = 0; i < uiThreads; ++i)
+  {
+    m_WorkerContexts[i]->EndPass(m_Stats);
+  }
+}
+
+void StyleResolver::ResolveRoot(dom::DOMElement& in_root, ResolveContext& inout_context)
+{
+  const dom::DOMElement* pParent = in_root.getParentElementPtr();
+  const ComputedStyle* pParentStyle = pParent != nullptr ? pParent->getComputedStyle() : nullptr;
+  if (pParent == nullptr)
+    m_fRootFontSize = 16.0f;
+
+  AssignStyle(in_root, ComputeStyle(in_root, pParentStyle, &inout_context.m_Filter, inout_context));
+  in_root.clearStyleDirtyFlags();
+  ++inout_context.m_Stats.m_uiResolvedElements;
+
+  if (pParent == nullptr)
+    m_fRootFontSize = in_root.getComputedStyle()->Get(PropertyId::FontSize).m_fNumber;
+}
+
+void StyleResolver::ResolveChildren(dom::DOMElement& in_parent, ResolveContext& inout_context, bool in_bRecursive)
+{
+  CSSAncestorFilter& filter = inout_context.m_Filter;
+  filter.PushElement(in_parent);
+
+  const ComputedStyle* pParentStyle = in_parent.getComputedStyle();
+  SharingCandidates candidates = {};
+
+  for (const std::shared_ptr<dom::DOMNode>& pChild : in_parent.getChildNodes())
+  {
+    if (pChild == nullptr || pChild->getNodeType() != dom::DOMNodeType::ELEMENT_NODE)
+      continue;
+
+    dom::DOMElement& child = static_cast<dom::DOMElement&>(*pChild);
+    ResolveChild(child, pParentStyle, candidates, inout_context);
+
+    if (in_bRecursive)
+      ResolveChildren(child, inout_context, true);
+  }
+
+  filter.PopElement();
+}
+
+void StyleResolver::ResolveChild(dom::DOMElement& in_child, const ComputedStyle* in_pParentStyle, SharingCandidates& inout_candidates, ResolveContext& inout_context)
+{
+  in_child.clearStyleDirtyFlags();
+  ++inout_context.m_Stats.m_uiResolvedElements;
+
+  const dom::DOMElement* pShareWith = nullptr;
+  if (!m_bHasPositionalRules)
+  {
+    for (nsUInt32 i = 0; i < inout_candidates.m_uiCount; ++i)
+    {
+      if (CanShareStyle(in_child, *inout_candidates.m_pElements[i]))
+      {
+        pShareWith = inout_candidates.m_pElements[i];
+        break;
+      }
+    }
+  }
+
+  if (pShareWith != nullptr)
+  {
+    AssignStyle(in_child, pShareWith->getComputedStyleRef());
+    ++inout_context.m_Stats.m_uiSharedWithSibling;
+    return;
+  }
+
+  AssignStyle(in_child, ComputeStyle(in_child, in_pParentStyle, &inout_context.m_Filter, inout_context));
+
+  // Keep the most recent distinct siblings as candidates.
+  if (inout_candidates.m_uiCount < SharingCandidateCount)
+    inout_candidates.m_pElements[inout_candidates.m_uiCount++] = &in_child;
+  else
+    inout_candidates.m_pElements[inout_candidates.m_uiNext++ % SharingCandidateCount] = &in_child;
+}
+
+void StyleResolver::ResolveStyles(dom::DOMFlatTree& inout_tree)
+{
+  NS_PROFILE_SCOPE("StyleResolver::ResolveStyles");
+
+  using NodeIndex = dom::DOMFlatTree::NodeIndex;
+
+  // The elements whose subtree the walk is in, innermost last. Each one is in the ancestor filter.
+  struct OpenParent
+  {
+    NS_DECLARE_POD_TYPE();
+
+    NodeIndex m_uiIndex;
+    const ComputedStyle* m_pStyle;
+    SharingCandidates m_Candidates;
+  };
+  nsHybridArray<OpenParent, 32> parents;
+
+  ResolveContext& context = *m_pContext;
+  context.BeginPass();
+
+  // Nodes are in pre-order, every parent is resolved before its children.
+  const NodeIndex uiCount = inout_tree.GetNodeCount();
+  for (NodeIndex i = 0; i < uiCount; ++i)
+  {
+    while (!parents.IsEmpty() && inout_tree.GetSubtreeEnd(parents.PeekBack().m_uiIndex) <= i)
+    {
+      context.m_Filter.PopElement();
+      parents.PopBack();
+    }
+
+    // Like the DOM walk, nothing below a node that isn't a element is resolved.
+    if (inout_tree.GetNodeType(i) != dom::DOMNodeType::ELEMENT_NODE)
+    {
+      i = inout_tree.GetSubtreeEnd(i) - 1;
+      continue;
+    }
+
+    dom::DOMElement& element = static_cast<dom::DOMElement&>(*inout_tree.GetNode(i));
+    if (parents.IsEmpty())
+    {
+      // The ancestors of a root are outside of the flat tree.
+      context.m_Filter.Clear();
+      PushAncestors(element, context.m_Filter);
+      ResolveRoot(element, context);
+    }
+    else
+    {
+      OpenParent& parent = parents.PeekBack();
+      ResolveChild(element, parent.m_pStyle, parent.m_Candidates, context);
+    }
+
+    if (inout_tree.GetFirstChild(i) != dom::DOMFlatTree::InvalidIndex)
+    {
+      context.m_Filter.PushElement(element);
+      OpenParent& parent = parents.ExpandAndGetRef();
+      parent.m_uiIndex = i;
+      parent.m_pStyle = element.getComputedStyle();
+      parent.m_Candidates = {};
+    }
+  }
+  context.EndPass(m_Stats);
+
+  constexpr nsUInt32 uiStyleFlags = dom::DOMFlatTree::Flags::StyleDirty | dom::DOMFlatTree::Flags::DescendantStyleDirty;
+  for (nsUInt32& uiFlags : inout_tree.GetFlagArray())
+  {
+    uiFlags &= ~uiStyleFlags;
+  }
+}
+
+void StyleResolver::UpdateStyles(dom::DOMElement& in_root)
+{
+  if (!m_MediaChangedRules.IsEmpty())
+    InvalidateMediaRules(in_root);
+
+  if (in_root.getStyleDirtyFlags() == dom::StyleDirty::None)
+    return;
+
+  NS_PROFILE_SCOPE("StyleResolver::UpdateStyles");
+
+  ResolveContext& context = *m_pContext;
+  context.BeginPass();
+  PushAncestors(in_root, context.m_Filter);
+  UpdateElement(in_root, context, false, false, VariableChange());
+  context.EndPass(m_Stats);
+}
+
+void StyleResolver::UpdateElement(
+  dom::DOMElement& in_element, ResolveContext& inout_context, bool in_bForce, bool in_bParentChanged, const VariableChange& in_parentVariables)
+{
+  const dom::StyleDirty::StorageType uiFlags = in_element.getStyleDirtyFlags();
+  in_element.clearStyleDirtyFlags();
+
+  const dom::DOMElement* pParent = in_element.getParentElementPtr();
+  nsSharedPtr<const ComputedStyle> pOldStyle = in_element.getComputedStyleRef();
+  const bool bUsesChangedVariables = pOldStyle != nullptr && (pOldStyle->GetVariableMask() & in_parentVariables.m_uiNames) != 0;
+
+  // Elements that declare custom properties of their own can't simply take over the ones of the parent.
+  // Neither can animated ones, the style they hold has animated values in it.
+  const bool bAnimated = m_pAnimator != nullptr && pOldStyle != nullptr && HasAnimations(*pOldStyle);
+  const bool bTakeOverVariables = pOldStyle != nullptr && in_parentVariables.m_uiNames != 0 &&
+                                  pOldStyle->GetCustomProperties() == in_parentVariables.m_pOldProperties && !bAnimated;
+
+  bool bInheritedChanged = false;
+  VariableChange variables;
+  if (in_bForce || in_bParentChanged || (uiFlags & dom::StyleDirty::Self) != 0 || pOldStyle == nullptr || bUsesChangedVariables ||
+      (in_parentVariables.m_uiNames != 0 && !bTakeOverVariables))
+  {
+    if (pParent == nullptr)
+      m_fRootFontSize = 16.0f;
+
+    AssignStyle(in_element, ComputeStyle(in_element, pParent != nullptr ? pParent->getComputedStyle() : nullptr, &inout_context.m_Filter, inout_context));
+    ++inout_context.m_Stats.m_uiResolvedElements;
+
+    const ComputedStyle* pNewStyle = in_element.getComputedStyle();
+    if (pParent == nullptr)
+      m_fRootFontSize = pNewStyle->Get(PropertyId::FontSize).m_fNumber;
+
+    // All inherited values live in the interned text group, comparing the group pointers is enough.
+    bInheritedChanged = pOldStyle == nullptr || &pOldStyle->GetText() != &pNewStyle->GetText();
+    if (pOldStyle != nullptr)
+    {
+      variables.m_uiNames = CSSCustomProperties::GetChangedNames(pOldStyle->GetCustomProperties(), pNewStyle->GetCustomProperties());
+      variables.m_pOldProperties = pOldStyle->GetCustomProperties();
+    }
+  }
+  else if ((uiFlags & dom::StyleDirty::Animation) != 0 && bAnimated)
+  {
+    // Only the animated values moved on, the cascade result is the same as before.
+    in_element.setComputedStyle(m_pAnimator->ApplyAnimatedValues(in_element));
+    ++inout_context.m_Stats.m_uiAnimatedElements;
+    bInheritedChanged = &pOldStyle->GetText() != &in_element.getComputedStyle()->GetText();
+  }
+  else if (in_parentVariables.m_uiNames != 0)
+  {
+    // None of the values depend on the changed custom properties, only the inherited set has to be replaced.
+    ComputedStyle updated(*pOldStyle);
+    updated.SetCustomProperties(pParent->getComputedStyle()->GetCustomPropertiesRef());
+    in_element.setComputedStyle(m_Cache.GetOrAdd(updated));
+    ++inout_context.m_Stats.m_uiInheritedVariableChanges;
+
+    variables = in_parentVariables;
+    variables.m_pOldProperties = pOldStyle->GetCustomProperties();
+  }
+
+  const bool bForceChildren = in_bForce || (uiFlags & dom::StyleDirty::Descendants) != 0;
+  if (!bForceChildren && !bInheritedChanged && variables.m_uiNames == 0 && (uiFlags & dom::StyleDirty::ChildNeedsStyle) == 0)
+    return;
+
+  inout_context.m_Filter.PushElement(in_element);
+  for (const std::shared_ptr<dom::DOMNode>& pChild : in_element.getChildNodes())
+  {
+    if (pChild != nullptr && pChild->getNodeType() == dom::DOMNodeType::ELEMENT_NODE)
+    {
+      dom::DOMElement& child = static_cast<dom::DOMElement&>(*pChild);
+      if (bForceChildren || bInheritedChanged || variables.m_uiNames != 0 || child.getStyleDirtyFlags() != dom::StyleDirty::None)
+        UpdateElement(child, inout_context, bForceChildren, bInheritedChanged, variables);
+    }
+  }
+  inout_context.m_Filter.PopElement();
+}
+
+void StyleResolver::InvalidateMediaRules(dom::DOMElement& in_root)
+{
+  NS_PROFILE_SCOPE("StyleResolver::InvalidateMediaRules");
+
+  // A rule map of just the flipped rules. Most elements are rejected by the bucket lookup or the ancestor filter.
+  CSSRuleMap changedRules;
+  for (nsUInt32 uiRuleRef : m_MediaChangedRules)
+  {
+    const RuleRef& ref = m_Rules[uiRuleRef];
+    const CSSStyleSheet::Rule& rule = ref.m_pStyleSheet->GetRule(ref.m_uiRule);
+    for (nsUInt32 s = 0; s < rule.m_uiSelectorCount; ++s)
+    {
+      changedRules.AddSelector(&ref.m_pStyleSheet->GetSelector(rule.m_uiFirstSelector + s), uiRuleRef, uiRuleRef);
+    }
+  }
+  m_MediaChangedRules.Clear();
+
+  CSSAncestorFilter filter;
+  PushAncestors(in_root, filter);
+  nsDynamicArray<CSSMatchedRule> matched;
+  MarkMatchingElements(in_root, changedRules, filter, matched, m_Stats.m_uiMediaQueryInvalidations);
+}
+
+void StyleResolver::PushAncestors(const dom::DOMElement& in_element, CSSAncestorFilter& inout_filter)
+{
+  // The filter has to contain every ancestor of the element, pushed from the top.
+  nsHybridArray<const dom::DOMElement*, 32> ancestors;
+  for (const dom::DOMElement* pAncestor = in_element.getParentElementPtr(); pAncestor != nullptr; pAncestor = pAncestor->getParentElementPtr())
+  {
+    ancestors.PushBack(pAncestor);
+  }
+  for (nsUInt32 i = ancestors.GetCount(); i-- > 0;)
+  {
+    inout_filter.PushElement(*ancestors[i]);
+  }
+}
+
+void StyleResolver::AssignStyle(dom::DOMElement& in_element, nsSharedPtr<const ComputedStyle> in_pStyle)
+{
+  if (m_pAnimator != nullptr)
+  {
+    const ComputedStyle* pOldStyle = in_element.getComputedStyle();
+    if (HasAnimations(*in_pStyle) || (pOldStyle != nullptr && HasAnimations(*pOldStyle)))
+      in_pStyle = m_pAnimator->OnStyleResolved(in_element, pOldStyle, std::move(in_pStyle));
+  }
+  in_element.setComputedStyle(std::move(in_pStyle));
+}
+
+bool StyleResolver::CanShareStyle(const dom::DOMElement& in_element, const dom::DOMElement& in_candidate) const
+{
+  // Both share the parent, so ancestor dependent selectors match the same. Cheap checks first.
+  if (in_candidate.getComputedStyle() == nullptr || in_element.getTagAtom() != in_candidate.getTagAtom() ||
+      in_element.getIdAtom() != in_candidate.getIdAtom() || in_element.getStateFlags() != in_candidate.getStateFlags() ||
+      in_element.getClassAtoms().GetCount() != in_candidate.getClassAtoms().GetCount())
+  {
+    return false;
+  }
+
+  // The style of a animated candidate has its animated values in it, they belong to the candidate alone.
+  if (m_pAnimator != nullptr && HasAnimations(*in_candidate.getComputedStyle()))
+    return false;
+
+  // Equal attributes also cover the classes and the inline style.
+  return in_element.getAttributes() == in_candidate.getAttributes();
+}
+
+nsSharedPtr<const ComputedStyle> StyleResolver::ComputeStyle(const dom::DOMElement& in_element, const ComputedStyle* in_pParentStyle, const CSSAncestorFilter* in_pAncestorFilter)
+{
+  return ComputeStyle(in_element, in_pParentStyle, in_pAncestorFilter, *m_pContext);
+}
+
+nsSharedPtr<const ComputedStyle> StyleResolver::ComputeStyle(
+  const dom::DOMElement& in_element, const ComputedStyle* in_pParentStyle, const CSSAncestorFilter* in_pAncestorFilter, ResolveContext& inout_context)
+{
+  const ComputedStyle& initial = ComputedStyle::GetInitialStyle();
+  const ComputedStyle& parent = in_pParentStyle != nullptr ? *in_pParentStyle : initial;
+
+  nsDynamicArray<CSSMatchedRule>& matchedRules = inout_context.m_MatchedRules;
+  matchedRules.Clear();
+  m_RuleMap.CollectMatchingRules(in_element, in_pAncestorFilter, matchedRules);
+
+  // Rules of media blocks that don't apply right now are still in the rule map, skip them.
+  if (m_MediaQueries.GetBlockCount() != 0)
+  {
+    nsUInt32 uiKept = 0;
+    for (nsUInt32 i = 0; i < matchedRules.GetCount(); ++i)
+    {
+      const nsUInt32 uiBlock = m_Rules[matchedRules[i].m_uiRuleIndex].m_uiMediaBlock;
+      if (uiBlock == CSSMediaQueryCache::NoParent || m_MediaResults.IsBitSet(uiBlock))
+        matchedRules[uiKept++] = matchedRules[i];
+    }
+    matchedRules.SetCount(uiKept);
+  }
+
+  const auto& attributes = in_element.getAttributes();
+  auto styleAttribute = attributes.find("style");
+
+  // Without inline declarations the result only depends on the matched rules and the parent style.
+  // The root is left out, its font size is what rem values are resolved against.
+  ResolveContext::MatchCacheEntry* pCacheEntry = nullptr;
+  if (inout_context.m_bUseMatchCache && in_pParentStyle != nullptr && styleAttribute == attributes.end())
+  {
+    const nsUInt64 uiKey = nsHashingUtils::xxHash64(matchedRules.GetData(), matchedRules.GetCount() * sizeof(CSSMatchedRule), reinterpret_cast<nsUInt64>(in_pParentStyle));
+    pCacheEntry = &inout_context.m_MatchCache[uiKey % MatchCacheSize];
+
+    if (pCacheEntry->m_uiKey == uiKey && pCacheEntry->m_pParentStyle == in_pParentStyle && pCacheEntry->m_pStyle != nullptr &&
+        pCacheEntry->m_Rules.GetArrayPtr() == matchedRules.GetArrayPtr())
+    {
+      ++inout_context.m_Stats.m_uiSharedWithCousin;
+      return pCacheEntry->m_pStyle;
+    }
+
+    pCacheEntry->m_uiKey = uiKey;
+    pCacheEntry->m_pParentStyle = in_pParentStyle;
+    pCacheEntry->m_Rules = matchedRules;
+  }
+
+  nsHybridArray<CSSDeclaration, 8> inlineDeclarations;
+  CSSStringTable inlineStrings;
+  if (styleAttribute != attributes.end())
+  {
+    nsDynamicArray<CSSDeclaration> parsed;
+    CSSStyleSheet::ParseDeclarationList(styleAttribute->second, parsed, inlineStrings);
+    inlineDeclarations.PushBackRange(parsed);
+  }
+
+  // Cascade: author normal < inline normal < author important < inline important. Matched rules are in ascending cascade order.
+  Winner winners[PropertyCount] = {};
+  CustomDeclarations customWinners;
+  for (const CSSMatchedRule& matched : matchedRules)
+  {
+    const RuleRef& ref = m_Rules[matched.m_uiRuleIndex];
+    ApplyDeclarations(ref.m_pStyleSheet->GetDeclarations(ref.m_pStyleSheet->GetRule(ref.m_uiRule)), ref.m_pStyleSheet->GetStrings(), false, winners, customWinners);
+  }
+  ApplyDeclarations(inlineDeclarations, inlineStrings, false, winners, customWinners);
+  for (const CSSMatchedRule& matched : matchedRules)
+  {
+    const RuleRef& ref = m_Rules[matched.m_uiRuleIndex];
+    ApplyDeclarations(ref.m_pStyleSheet->GetDeclarations(ref.m_pStyleSheet->GetRule(ref.m_uiRule)), ref.m_pStyleSheet->GetStrings(), true, winners, customWinners);
+  }
+  ApplyDeclarations(inlineDeclarations, inlineStrings, true, winners, customWinners);
+
+  // Specified values. Undeclared properties keep the initial groups, or the inherited group of the parent.
+  ComputedStyle style;
+  style.InheritFrom(parent);
+
+  // Custom properties first, the other declarations may reference them.
+  nsUInt64 uiVariableNames = 0;
+  if (!customWinners.IsEmpty())
+  {
+    nsSharedPtr<CSSCustomProperties> pProperties =
+      parent.GetCustomProperties() != nullptr ? NS_DEFAULT_NEW(CSSCustomProperties, *parent.GetCustomProperties()) : NS_DEFAULT_NEW(CSSCustomProperties);
+    uiVariableNames |= CustomPropertyGraph(customWinners, parent.GetCustomProperties(), *pProperties).Resolve();
+    style.SetCustomProperties(pProperties);
+  }
+
+  nsHybridArray<nsUInt8, 32> declared;
+  for (nsUInt32 i = 1; i < PropertyCount; ++i)
+  {
+    const CSSDeclaration* pDeclaration = winners[i].m_pDeclaration;
+    if (pDeclaration == nullptr)
+      continue;
+
+    const PropertyId id = static_cast<PropertyId>(i);
+    declared.PushBack(static_cast<nsUInt8>(i));
+    style.MarkExplicitlySet(id);
+
+    switch (pDeclaration->m_WideKeyword)
+    {
+      case CSSWideKeyword::Inherit:
+        style.CopyValue(id, parent);
+        break;
+      case CSSWideKeyword::Initial:
+        style.CopyValue(id, initial);
+        break;
+      case CSSWideKeyword::Unset:
+        style.CopyValue(id, CSSPropertyTable::IsInherited(id) ? parent : initial);
+        break;
+      default:
+        if (pDeclaration->m_bHasVariables)
+          ApplyValueWithVariables(winners[i], id, style, parent, uiVariableNames);
+        else if (pDeclaration->m_Value.m_Unit == core::Unit::STRING)
+          style.SetString(id, winners[i].GetText());
+        else
+          style.Set(id, pDeclaration->m_Value);
+        break;
+    }
+  }
+  style.AddToVariableMask(uiVariableNames);
+
+  // Computed values: font relative lengths become px, currentcolor becomes the color.
+  // Inherited values are already computed, so only declared values and initial currentcolor values need a look.
+  const float fParentFontSize = parent.Get(PropertyId::FontSize).m_fNumber;
+  CSSValue fontSize = style.Get(PropertyId::FontSize);
+  if (fontSize.m_Unit == core::Unit::EM)
+    fontSize = CSSValue::MakeNumeric(fontSize.m_fNumber * fParentFontSize, core::Unit::PX);
+  else if (fontSize.m_Unit == core::Unit::PERCENT)
+    fontSize = CSSValue::MakeNumeric(fontSize.m_fNumber * 0.01f * fParentFontSize, core::Unit::PX);
+  else if (fontSize.m_Unit == core::Unit::REM)
+    fontSize = CSSValue::MakeNumeric(fontSize.m_fNumber * m_fRootFontSize, core::Unit::PX);
+  else if (fontSize.m_Unit == core::Unit::KEYWORD)
+    fontSize = CSSValue::MakeNumeric(fParentFontSize, core::Unit::PX);
+  style.Set(PropertyId::FontSize, fontSize);
+
+  for (nsUInt8 uiId : GetCurrentColorProperties())
+  {
+    if (!style.IsExplicitlySet(static_cast<PropertyId>(uiId)))
+      declared.PushBack(uiId);
+  }
+
+  const core::Atom currentColor = CSSPropertyTable::GetKeywords().m_CurrentColor;
+  const CSSValue color = style.Get(PropertyId::Color);
+  for (nsUInt8 uiId : declared)
+  {
+    const PropertyId id = static_cast<PropertyId>(uiId);
+    const CSSValue& value = style.Get(id);
+    if (id == PropertyId::FontSize)
+      continue;
+
+    if (value.m_Unit == core::Unit::EM)
+      style.Set(id, CSSValue::MakeNumeric(value.m_fNumber * fontSize.m_fNumber, core::Unit::PX));
+    else if (value.m_Unit == core::Unit::REM)
+      style.Set(id, CSSValue::MakeNumeric(value.m_fNumber * m_fRootFontSize, core::Unit::PX));
+    else if (value.IsKeyword(currentColor) && AcceptsColor(id))
+      style.Set(id, color);
+  }
+
+  nsSharedPtr<const ComputedStyle> pStyle = m_Cache.GetOrAdd(style);
+  if (pCacheEntry != nullptr)
+    pCacheEntry->m_pStyle = pStyle;
+  return pStyle;
+}
@@ -0,0 +1,244 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/css/Selector/CSSInvalidationMap.h>
+#include <APHTML/css/Selector/CSSRuleMap.h>
+#include <APHTML/css/Style/CSSMediaQuery.h>
+#include <APHTML/css/Style/ComputedStyle.h>
+#include <Foundation/Types/UniquePtr.h>
+
+namespace aperture::dom
+{
+  class DOMElement;
+  class DOMFlatTree;
+} // namespace aperture::dom
+
+namespace aperture::css
+{
+  class CSSAncestorFilter;
+  class CSSStyleSheet;
+
+  /*
+   * @brief Applies transitions and animations to the styles the StyleResolver computes, see animation::AnimationManager.
+   *
+   * The resolver only calls it for elements whose new or previous style declares a transition or animation, all other
+   * elements don't pay for it.
+   *
+   * @note Called from the worker threads of StyleResolver::ResolveStylesParallel() as well, implementations must be thread safe.
+   */
+  class NS_APERTURE_DLL StyleAnimator
+  {
+  public:
+    virtual ~StyleAnimator() = default;
+
+    /// @brief Called with every newly computed style of a element, before it is assigned.
+    /// @param in_pOldStyle The style the element had so far (including animated values), null the first time.
+    /// @return The style to assign, in_pNewStyle with the animated values applied.
+    virtual nsSharedPtr<const ComputedStyle> OnStyleResolved(
+      dom::DOMElement& in_element, const ComputedStyle* in_pOldStyle, nsSharedPtr<const ComputedStyle> in_pNewStyle) = 0;
+
+    /// @brief Called instead of the cascade for elements that only have dom::StyleDirty::Animation set.
+    /// @return The last computed style of the element with the current animated values applied.
+    virtual nsSharedPtr<const ComputedStyle> ApplyAnimatedValues(dom::DOMElement& in_element) = 0;
+  };
+
+  /*
+   * @brief Computes the styles of DOM subtrees: selector matching, cascade, inheritance and computed values.
+   *
+   * Two levels of sharing keep the number of distinct ComputedStyles low:
+   *  - Siblings that have the same tag, attributes and state take the style of a previous sibling without matching
+   *    any rule. Lists of identical items (e.g. hundreds of inventory slots) resolve one style and share it.
+   *  - Every other result goes through the StyleCache, so equal styles reached by different rules are still one object.
+   *
+   * Sibling sharing is turned off when a stylesheet contains selectors that depend on the position in the sibling list
+   * (sibling combinators, :nth-child(), :empty, ...), as siblings with equal attributes can match differently then.
+   *
+   * ResolveStylesParallel() resolves the top of the tree on the calling thread, then hands the subtrees below to the
+   * nsTaskSystem. Every task uses its own ancestor filter and caches, only the StyleCache is shared.
+   *
+   * Rules inside @media blocks stay in the rule map, matched rules of blocks that don't apply in the current
+   * MediaEnvironment are skipped. The block results are a bitset from the CSSMediaQueryCache, so a viewport change
+   * only evaluates the compiled query lists (or not even that, for a cached environment) and invalidates the elements
+   * matched by rules whose block flipped.
+   *
+   * With a StyleAnimator set, styles of elements with transitions or animations go through it before they are assigned,
+   * and elements flagged with dom::StyleDirty::Animation only get their animated values refreshed.
+   *
+   * @note Stylesheets are referenced, they must stay alive and unchanged while they are part of the resolver.
+   */
+  class NS_APERTURE_DLL StyleResolver
+  {
+  public:
+    /// @brief The amount of previous siblings that are checked for a shareable style.
+    static constexpr nsUInt32 SharingCandidateCount = 8;
+    /// @brief Parallel resolution splits the tree until there are this many subtrees per thread.
+    static constexpr nsUInt32 SubtreesPerThread = 8;
+
+    explicit StyleResolver(StyleCache& in_cache);
+    ~StyleResolver();
+
+    /// @brief Adds a stylesheet, later stylesheets win over earlier ones in the cascade.
+    void AddStyleSheet(const CSSStyleSheet* in_pStyleSheet);
+    void ClearStyleSheets();
+
+    /// @brief Computes and assigns the styles of the element and all of its descendants.
+    /// @note The parent of the element (if any) must already have a style.
+    void ResolveStyles(dom::DOMElement& in_root);
+
+    /// @brief Same as ResolveStyles(), with the subtrees below the top levels resolved on up to in_uiMaxThreads threads.
+    /// @param in_uiMaxThreads 0 uses every short task worker of the nsTaskSystem, 1 resolves serially.
+    /// @note The DOM must not be modified while this runs. The results are identical to ResolveStyles().
+    void ResolveStylesParallel(dom::DOMElement& in_root, nsUInt32 in_uiMaxThreads = 0);
+
+    /// @brief Same as ResolveStyles() for every element root of the flat tree, walking its arrays in tree order instead of the
+    /// child vectors of the DOM. Clears the style flags of the flat tree.
+    /// @note The flat tree must match the current DOM structure. The results are identical to ResolveStyles().
+    void ResolveStyles(dom::DOMFlatTree& inout_tree);
+
+    /// @brief Recomputes the styles of the elements below the root that were flagged with dom::StyleDirty.
+    /// Children are recomputed as well when the inherited values of their parent changed. When custom properties change,
+    /// only the elements that use them are recomputed, the others just take over the new custom properties.
+    void UpdateStyles(dom::DOMElement& in_root);
+
+    /// @brief Sets the viewport state @media rules are evaluated against, e.g. on resize or when the DPI or theme changes.
+    /// Nothing is reparsed and no element is restyled right away. The next UpdateStyles() flags the elements that are
+    /// matched by rules whose media block started or stopped applying, and only restyles those.
+    void SetMediaEnvironment(const MediaEnvironment& in_environment);
+    const MediaEnvironment& GetMediaEnvironment() const { return m_MediaEnvironment; }
+    const CSSMediaQueryCache& GetMediaQueryCache() const { return m_MediaQueries; }
+
+    /// @brief Sets the animator styles of animated elements go through, may be null. It must outlive the resolver or be unset.
+    void SetStyleAnimator(StyleAnimator* in_pAnimator) { m_pAnimator = in_pAnimator; }
+    StyleAnimator* GetStyleAnimator() const { return m_pAnimator; }
+
+    /// @brief Returns the last stylesheet that defines @keyframes with the name, null if none does.
+    const CSSStyleSheet* FindKeyframesStyleSheet(core::Atom in_name) const;
+
+    StyleCache& GetStyleCache() const { return m_Cache; }
+    /// @brief The font size of the root element in px, valid after the root was resolved.
+    float GetRootFontSize() const { return m_fRootFontSize; }
+
+    /// @brief The dependencies of the selectors of all stylesheets, used by StyleInvalidator.
+    const CSSInvalidationMap& GetInvalidationMap() const { return m_InvalidationMap; }
+
+    /// @brief Computes the style of a single element, without sibling sharing.
+    /// @param in_pParentStyle Style values are inherited from, the initial style is used if null.
+    /// @param in_pAncestorFilter Ancestors of the element, may be null.
+    nsSharedPtr<const ComputedStyle> ComputeStyle(const dom::DOMElement& in_element, const ComputedStyle* in_pParentStyle, const CSSAncestorFilter* in_pAncestorFilter);
+
+    struct Stats
+    {
+      nsUInt32 m_uiResolvedElements = 0;
+      nsUInt32 m_uiSharedWithSibling = 0;
+      /// @brief Elements that reused the style of a cousin with the same matched rules and parent style.
+      nsUInt32 m_uiSharedWithCousin = 0;
+      /// @brief Elements that only took over changed custom properties of their parent, without being resolved.
+      nsUInt32 m_uiInheritedVariableChanges = 0;
+      /// @brief Elements that only got their animated values refreshed, without being resolved.
+      nsUInt32 m_uiAnimatedElements = 0;
+      /// @brief Elements flagged by UpdateStyles() because a rule matching them was in a media block that flipped.
+      nsUInt32 m_uiMediaQueryInvalidations = 0;
+    };
+    const Stats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = Stats(); }
+
+    bool IsSiblingSharingEnabled() const { return !m_bHasPositionalRules; }
+
+  private:
+    /// @brief Everything a single traversal modifies, one per thread. Defined in the .cpp.
+    struct ResolveContext;
+    /// @brief The most recent distinct children of a parent, checked for a shareable style. Defined in the .cpp.
+    struct SharingCandidates;
+
+    /// @brief Custom properties of a element that changed during UpdateStyles().
+    struct VariableChange
+    {
+      /// @brief CSSCustomProperties::GetNameBit() of the changed names.
+      nsUInt64 m_uiNames = 0;
+      /// @brief The custom properties before the change.
+      const CSSCustomProperties* m_pOldProperties = nullptr;
+    };
+
+    struct RuleRef
+    {
+      NS_DECLARE_POD_TYPE();
+
+      const CSSStyleSheet* m_pStyleSheet;
+      nsUInt32 m_uiRule;
+      /// @brief The bit of the media block in m_MediaQueries, CSSMediaQueryCache::NoParent if the rule always applies.
+      nsUInt32 m_uiMediaBlock;
+    };
+
+    void ResolveRoot(dom::DOMElement& in_root, ResolveContext& inout_context);
+    /// @param in_bRecursive Resolve the whole subtree, otherwise only the children themselves.
+    void ResolveChildren(dom::DOMElement& in_parent, ResolveContext& inout_context, bool in_bRecursive);
+    /// @brief Resolves a child of a resolved parent, taking the style of a candidate sibling where possible.
+    void ResolveChild(dom::DOMElement& in_child, const ComputedStyle* in_pParentStyle, SharingCandidates& inout_candidates, ResolveContext& inout_context);
+    /// @param in_bForce Restyle the element and its subtree regardless of the flags.
+    /// @param in_bParentChanged The inherited values of the parent changed, restyle the element.
+    /// @param in_parentVariables The custom properties of the parent that changed in this update.
+    void UpdateElement(dom::DOMElement& in_element, ResolveContext& inout_context, bool in_bForce, bool in_bParentChanged, const VariableChange& in_parentVariables);
+    nsSharedPtr<const ComputedStyle> ComputeStyle(
+      const dom::DOMElement& in_element, const ComputedStyle* in_pParentStyle, const CSSAncestorFilter* in_pAncestorFilter, ResolveContext& inout_context);
+    /// @brief Flags the elements below the root that match a rule of m_MediaChangedRules.
+    void InvalidateMediaRules(dom::DOMElement& in_root);
+    static void PushAncestors(const dom::DOMElement& in_element, CSSAncestorFilter& inout_filter);
+    /// @brief Assigns a newly computed style, through the StyleAnimator if the element is animated.
+    void AssignStyle(dom::DOMElement& in_element, nsSharedPtr<const ComputedStyle> in_pStyle);
+    bool CanShareStyle(const dom::DOMElement& in_element, const dom::DOMElement& in_candidate) const;
+
+  private:
+    StyleCache& m_Cache;
+    CSSRuleMap m_RuleMap;
+    CSSInvalidationMap m_InvalidationMap;
+    nsDynamicArray<RuleRef> m_Rules;
+    nsDynamicArray<const CSSStyleSheet*> m_StyleSheets;
+    bool m_bHasPositionalRules = false;
+    CSSMediaQueryCache m_MediaQueries;
+    MediaEnvironment m_MediaEnvironment;
+    /// @brief Which media blocks apply in m_MediaEnvironment.
+    nsDynamicBitfield m_MediaResults;
+    /// @brief Rules whose media block flipped since the last UpdateStyles().
+    nsDynamicArray<nsUInt32> m_MediaChangedRules;
+    StyleAnimator* m_pAnimator = nullptr;
+    /// @brief The font size of the root element in px, used to resolve rem units.
+    float m_fRootFontSize = 16.0f;
+    Stats m_Stats;
+    /// @brief Used by the calling thread, the workers of a parallel resolve get their own.
+    nsUniquePtr<ResolveContext> m_pContext;
+    nsDynamicArray<nsUniquePtr<ResolveContext>> m_WorkerContexts;
+  };
+} // namespace aperture::css
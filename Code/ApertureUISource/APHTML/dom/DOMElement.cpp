@@ -5,9 +5,34 @@
 
 using namespace aperture::dom;
 
+namespace
+{
+  // Attribute names are ASCII case-insensitive. They are stored lowercase, like the attribute names of selectors.
+  bool HasUppercase(const std::string& name)
+  {
+    for (char c : name)
+    {
+      if (c >= 'A' && c <= 'Z')
+        return true;
+    }
+    return false;
+  }
+
+  std::string ToLowercase(std::string name)
+  {
+    for (char& c : name)
+    {
+      if (c >= 'A' && c <= 'Z')
+        c = static_cast<char>(c + ('a' - 'A'));
+    }
+    return name;
+  }
+} // namespace
+
 DOMElement::DOMElement(const std::string& tagName)
   : DOMNode(DOMNodeType::ELEMENT_NODE, tagName)
   , m_tagName(tagName)
+  , m_tagAtom(core::AtomTable::Get().InternLowercase(tagName))
 {
 }
 
@@ -18,24 +43,124 @@ const std::string& DOMElement::getTagName() const
 
 std::string DOMElement::getAttribute(const std::string& name) const
 {
+  if (HasUppercase(name))
+    return getAttribute(ToLowercase(name));
+
   auto it = m_attributes.find(name);
   return it != m_attributes.end() ? it->second : "";
 }
 
 void DOMElement::setAttribute(const std::string& name, const std::string& value)
 {
+  if (HasUppercase(name))
+  {
+    setAttribute(ToLowercase(name), value);
+    return;
+  }
+
+  auto it = m_attributes.find(name);
+  if (it != m_attributes.end() && it->second == value)
+    return;
+
+  const nsHybridArray<core::Atom, 4> oldClasses = name == "class" ? m_classAtoms : nsHybridArray<core::Atom, 4>();
+  const core::Atom oldId = m_idAtom;
+
   m_attributes[name] = value;
+  updateAtomsForAttribute(name, &value);
+
+  if (DOMElementObserver* pObserver = findObserver())
+    pObserver->OnAttributeChanged(*this, name, oldClasses, oldId);
 }
 
 void DOMElement::removeAttribute(const std::string& name)
 {
-  m_attributes.erase(name);
+  if (HasUppercase(name))
+  {
+    removeAttribute(ToLowercase(name));
+    return;
+  }
+
+  if (m_attributes.erase(name) == 0)
+    return;
+
+  const nsHybridArray<core::Atom, 4> oldClasses = name == "class" ? m_classAtoms : nsHybridArray<core::Atom, 4>();
+  const core::Atom oldId = m_idAtom;
+
+  updateAtomsForAttribute(name, nullptr);
+
+  if (DOMElementObserver* pObserver = findObserver())
+    pObserver->OnAttributeChanged(*this, name, oldClasses, oldId);
+}
+
+void DOMElement::setStateFlags(nsUInt32 in_flags, bool in_enable)
+{
+  const nsUInt32 uiOldFlags = m_stateFlags;
+  m_stateFlags = in_enable ? (m_stateFlags | in_flags) : (m_stateFlags & ~in_flags);
+
+  if (m_stateFlags != uiOldFlags)
+  {
+    if (DOMElementObserver* pObserver = findObserver())
+      pObserver->OnStateChanged(*this, m_stateFlags ^ uiOldFlags);
+  }
+}
+
+void DOMElement::markStyleDirty(StyleDirty::StorageType in_flags)
+{
+  m_styleDirtyFlags |= in_flags;
+
+  // Stop at the first ancestor that already knows, everything above it does as well.
+  for (DOMElement* pAncestor = m_pParentElement; pAncestor != nullptr && (pAncestor->m_styleDirtyFlags & StyleDirty::ChildNeedsStyle) == 0;
+       pAncestor = pAncestor->m_pParentElement)
+  {
+    pAncestor->m_styleDirtyFlags |= StyleDirty::ChildNeedsStyle;
+  }
+}
+
+DOMElementObserver* DOMElement::findObserver() const
+{
+  for (const DOMElement* pElement = this; pElement != nullptr; pElement = pElement->m_pParentElement)
+  {
+    if (pElement->m_pObserver != nullptr)
+      return pElement->m_pObserver;
+  }
+  return nullptr;
+}
+
+void DOMElement::updateAtomsForAttribute(const std::string& name, const std::string* value)
+{
+  if (name == "id")
+  {
+    m_idAtom = value != nullptr ? core::MakeAtom(*value) : core::InvalidAtom;
+  }
+  else if (name == "class")
+  {
+    m_classAtoms.Clear();
+    if (value == nullptr)
+      return;
+
+    // The class attribute is a whitespace separated list.
+    size_t uiStart = 0;
+    while (uiStart < value->size())
+    {
+      const size_t uiEnd = value->find_first_of(" \t\r\n\f", uiStart);
+      const size_t uiLength = (uiEnd == std::string::npos ? value->size() : uiEnd) - uiStart;
+      if (uiLength > 0)
+      {
+        const core::Atom atom = core::MakeAtom(std::string_view(value->data() + uiStart, uiLength));
+        if (!m_classAtoms.Contains(atom))
+          m_classAtoms.PushBack(atom);
+      }
+      if (uiEnd == std::string::npos)
+        break;
+      uiStart = uiEnd + 1;
+    }
+  }
 }
 
 std::vector<std::shared_ptr<DOMElement>> DOMElement::getElementsByTagName(const std::string& tagName) const
 {
   std::vector<std::shared_ptr<DOMElement>> elements;
-  for (const auto& child : m_children)
+  for (const auto& child : m_childNodes)
   {
     if (auto element = std::dynamic_pointer_cast<DOMElement>(child))
     {
@@ -54,20 +179,28 @@ void DOMElement::appendChild(const std::shared_ptr<DOMNode>& child)
 {
   if (child)
   {
-    m_children.push_back(child);
+    // Children are kept in DOMNode::m_childNodes, so node traversal (getChildNodes(), siblings, getIndex()) sees them.
+    m_childNodes.push_back(child);
+    child->m_parentNode = shared_from_this();
     if (auto element = std::dynamic_pointer_cast<DOMElement>(child))
     {
       element->m_parent = shared_from_this();
+      element->m_pParentElement = this;
     }
   }
 }
 
 void DOMElement::removeChild(const std::shared_ptr<DOMNode>& child)
 {
-  m_children.erase(std::remove(m_children.begin(), m_children.end(), child), m_children.end());
+  m_childNodes.erase(std::remove(m_childNodes.begin(), m_childNodes.end(), child), m_childNodes.end());
+  if (child)
+  {
+    child->m_parentNode.reset();
+  }
   if (auto element = std::dynamic_pointer_cast<DOMElement>(child))
   {
     element->m_parent.reset();
+    element->m_pParentElement = nullptr;
   }
 }
 
@@ -33,6 +33,8 @@ ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
 EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #pragma once
+#include <APHTML/core/Atom.h>
+#include <APHTML/css/Style/ComputedStyle.h>
 #include <APHTML/dom/DOMAttribute.h>
 #include <APHTML/dom/DOMNode.h>
 #include <Foundation/Containers/DynamicArray.h>
@@ -50,6 +52,71 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace aperture::dom
 {
+  /// @brief Dynamic element states, matched by the state pseudo-classes (:hover, :checked, ...).
+  struct ElementState
+  {
+    using StorageType = nsUInt32;
+
+    enum Enum : StorageType
+    {
+      None = 0,
+      Hover = NS_BIT(0),
+      Active = NS_BIT(1),
+      Focus = NS_BIT(2),
+      Checked = NS_BIT(3),
+      Disabled = NS_BIT(4),
+      Visited = NS_BIT(5),
+      Link = NS_BIT(6),
+      Target = NS_BIT(7),
+      Default = NS_BIT(8),
+      Indeterminate = NS_BIT(9),
+      Invalid = NS_BIT(10),
+      ReadOnly = NS_BIT(11),
+      Required = NS_BIT(12),
+      InRange = NS_BIT(13),
+      OutOfRange = NS_BIT(14),
+      PlaceholderShown = NS_BIT(15),
+    };
+  };
+
+  /// @brief Pending style work of a element, see DOMElement::markStyleDirty().
+  struct StyleDirty
+  {
+    using StorageType = nsUInt8;
+
+    enum Enum : StorageType
+    {
+      None = 0,
+      Self = NS_BIT(0),            ///< The style of the element has to be recomputed.
+      Descendants = NS_BIT(1),     ///< The styles of all descendants have to be recomputed.
+      ChildNeedsStyle = NS_BIT(2), ///< Some descendant is dirty, the update has to walk through this element.
+      Animation = NS_BIT(3),       ///< Only the animated values changed, see css::StyleAnimator::ApplyAnimatedValues().
+      Subtree = Self | Descendants,
+    };
+  };
+
+  class DOMElement;
+
+  /*
+   * @brief Receives the changes of elements that can affect selector matching.
+   *
+   * A observer is set on a element with DOMElement::setObserver() and receives the changes of the whole subtree,
+   * unless a element further down has its own observer. Used by css::StyleInvalidator.
+   */
+  class NS_APERTURE_DLL DOMElementObserver
+  {
+  public:
+    virtual ~DOMElementObserver() = default;
+
+    /// @brief Called after a attribute was added, changed or removed.
+    /// @param in_oldClasses The class atoms before the change, only filled if the class attribute changed.
+    /// @param in_oldId The id atom before the change.
+    virtual void OnAttributeChanged(DOMElement& in_element, const std::string& in_name, nsArrayPtr<const core::Atom> in_oldClasses, core::Atom in_oldId) = 0;
+
+    /// @brief Called after ElementState flags were set or cleared.
+    virtual void OnStateChanged(DOMElement& in_element, nsUInt32 in_changedFlags) = 0;
+  };
+
   /**
    * @brief The DOMElement class represents an element node in the Document Object Model (DOM).
    *
@@ -76,7 +143,7 @@ namespace aperture::dom
     /**
      * @brief Retrieves the value of an attribute by name.
      *
-     * @param name The name of the attribute.
+     * @param name The name of the attribute, matched case-insensitively.
      * @return The value of the attribute, or an empty string if the attribute does not exist.
      */
     std::string getAttribute(const std::string& name) const;
@@ -84,7 +151,7 @@ namespace aperture::dom
     /**
      * @brief Sets an attribute on the element.
      *
-     * @param name The name of the attribute.
+     * @param name The name of the attribute, stored lowercase.
      * @param value The value to set for the attribute.
      */
     void setAttribute(const std::string& name, const std::string& value);
@@ -92,7 +159,7 @@ namespace aperture::dom
     /**
      * @brief Removes an attribute from the element.
      *
-     * @param name The name of the attribute to remove.
+     * @param name The name of the attribute to remove, matched case-insensitively.
      */
     void removeAttribute(const std::string& name);
 
@@ -139,10 +206,60 @@ namespace aperture::dom
      */
     int getIndex() const;
 
+    /**
+     * @brief Gets all attributes of the element.
+     *
+     * @return A constant reference to the attribute map of the element, keyed by the lowercase names.
+     */
+    const std::unordered_map<std::string, std::string>& getAttributes() const { return m_attributes; }
+
+    /**
+     * @brief Gets the parent element without taking a reference. Used by hot paths like selector matching.
+     */
+    DOMElement* getParentElementPtr() const { return m_pParentElement; }
+
+    /// @brief The interned, lowercase tag name.
+    core::Atom getTagAtom() const { return m_tagAtom; }
+    /// @brief The interned id attribute, or core::InvalidAtom.
+    core::Atom getIdAtom() const { return m_idAtom; }
+    /// @brief The interned entries of the class attribute.
+    const nsHybridArray<core::Atom, 4>& getClassAtoms() const { return m_classAtoms; }
+    bool hasClass(core::Atom in_class) const { return m_classAtoms.Contains(in_class); }
+
+    /// @brief The ElementState flags of the element.
+    nsUInt32 getStateFlags() const { return m_stateFlags; }
+    void setStateFlags(nsUInt32 in_flags, bool in_enable);
+
+    /// @brief The computed style of the element, or null if it wasn't styled yet. Set by css::StyleResolver.
+    const css::ComputedStyle* getComputedStyle() const { return m_computedStyle; }
+    const nsSharedPtr<const css::ComputedStyle>& getComputedStyleRef() const { return m_computedStyle; }
+    void setComputedStyle(nsSharedPtr<const css::ComputedStyle> in_style) { m_computedStyle = std::move(in_style); }
+
+    /// @brief Flags the element for the next css::StyleResolver::UpdateStyles(), ancestors get StyleDirty::ChildNeedsStyle.
+    void markStyleDirty(StyleDirty::StorageType in_flags);
+    StyleDirty::StorageType getStyleDirtyFlags() const { return m_styleDirtyFlags; }
+    void clearStyleDirtyFlags() { m_styleDirtyFlags = StyleDirty::None; }
+
+    /// @brief Sets the observer of this element and its subtree, may be null.
+    void setObserver(DOMElementObserver* in_pObserver) { m_pObserver = in_pObserver; }
+    /// @brief Returns the observer of the closest element (starting at this one) that has one.
+    DOMElementObserver* findObserver() const;
+
+  private:
+    /// @brief Keeps the cached id and class atoms in sync with the attributes.
+    void updateAtomsForAttribute(const std::string& name, const std::string* value);
+
   private:
     std::string m_tagName;                                     ///< The tag name of the element.
     std::unordered_map<std::string, std::string> m_attributes; ///< The attributes of the element.
-    std::vector<std::shared_ptr<DOMNode>> m_children;          ///< The child nodes of the element.
     std::weak_ptr<DOMElement> m_parent;                        ///< The parent element.
+    DOMElement* m_pParentElement = nullptr;                    ///< Same as m_parent, without the reference counting.
+    core::Atom m_tagAtom = core::InvalidAtom;                  ///< Interned lowercase tag name.
+    core::Atom m_idAtom = core::InvalidAtom;                   ///< Interned id attribute.
+    nsHybridArray<core::Atom, 4> m_classAtoms;                 ///< Interned class list.
+    nsUInt32 m_stateFlags = ElementState::None;                ///< ElementState flags.
+    nsSharedPtr<const css::ComputedStyle> m_computedStyle;     ///< Shared with every element that has the same computed values.
+    DOMElementObserver* m_pObserver = nullptr;                 ///< Receives attribute and state changes of the subtree.
+    StyleDirty::StorageType m_styleDirtyFlags = StyleDirty::None; ///< Pending style work.
   };
 } // namespace aperture::dom
@@ -0,0 +1,108 @@
+#include <APHTML/dom/DOMFlatTree.h>
+#include <Foundation/Profiling/Profiling.h>
+
+using namespace aperture::dom;
+
+void DOMFlatTree::Build(const std::vector<std::shared_ptr<DOMNode>>& in_roots, nsUInt32 in_uiInitialFlags)
+{
+  NS_PROFILE_SCOPE("DOMFlatTree::Build");
+
+  Clear();
+
+  struct StackEntry
+  {
+    NS_DECLARE_POD_TYPE();
+
+    DOMNode* m_pNode;
+    NodeIndex m_uiParent;
+  };
+
+  nsHybridArray<StackEntry, 64> stack;
+  for (auto it = in_roots.rbegin(); it != in_roots.rend(); ++it)
+  {
+    if (*it != nullptr)
+      stack.PushBack({it->get(), InvalidIndex});
+  }
+
+  // Last child seen per parent, to link the next sibling. Indexed like the other arrays.
+  nsDynamicArray<NodeIndex> lastChild;
+  NodeIndex uiLastRoot = InvalidIndex;
+
+  while (!stack.IsEmpty())
+  {
+    const StackEntry entry = stack.PeekBack();
+    stack.PopBack();
+
+    const NodeIndex uiIndex = m_Parent.GetCount();
+    m_Parent.PushBack(entry.m_uiParent);
+    m_FirstChild.PushBack(InvalidIndex);
+    m_NextSibling.PushBack(InvalidIndex);
+    m_SubtreeEnd.PushBack(uiIndex + 1);
+    m_Depth.PushBack(entry.m_uiParent != InvalidIndex ? static_cast<nsUInt16>(m_Depth[entry.m_uiParent] + 1) : 0);
+    m_NodeType.PushBack(static_cast<nsUInt8>(entry.m_pNode->getNodeType()));
+    m_Flags.PushBack(in_uiInitialFlags);
+    m_Nodes.PushBack(entry.m_pNode);
+    m_NodeToIndex.Insert(entry.m_pNode, uiIndex);
+    lastChild.PushBack(InvalidIndex);
+
+    NodeIndex& uiPrevious = entry.m_uiParent != InvalidIndex ? lastChild[entry.m_uiParent] : uiLastRoot;
+    if (uiPrevious != InvalidIndex)
+      m_NextSibling[uiPrevious] = uiIndex;
+    else if (entry.m_uiParent != InvalidIndex)
+      m_FirstChild[entry.m_uiParent] = uiIndex;
+    uiPrevious = uiIndex;
+
+    const auto& children = entry.m_pNode->getChildNodes();
+    for (auto it = children.rbegin(); it != children.rend(); ++it)
+    {
+      if (*it != nullptr)
+        stack.PushBack({it->get(), uiIndex});
+    }
+  }
+
+  // Pre-order: a subtree ends where the subtree of its last child ends. Walking backwards visits children before parents.
+  for (NodeIndex i = m_Parent.GetCount(); i-- > 0;)
+  {
+    const NodeIndex uiParent = m_Parent[i];
+    if (uiParent != InvalidIndex)
+      m_SubtreeEnd[uiParent] = nsMath::Max(m_SubtreeEnd[uiParent], m_SubtreeEnd[i]);
+  }
+}
+
+void DOMFlatTree::Clear()
+{
+  m_Parent.Clear();
+  m_FirstChild.Clear();
+  m_NextSibling.Clear();
+  m_SubtreeEnd.Clear();
+  m_Depth.Clear();
+  m_NodeType.Clear();
+  m_Flags.Clear();
+  m_Nodes.Clear();
+  m_NodeToIndex.Clear();
+}
+
+void DOMFlatTree::AddFlagsToSubtree(NodeIndex in_index, nsUInt32 in_uiFlags)
+{
+  const NodeIndex uiEnd = m_SubtreeEnd[in_index];
+  for (NodeIndex i = in_index; i < uiEnd; ++i)
+  {
+    m_Flags[i] |= in_uiFlags;
+  }
+}
+
+void DOMFlatTree::MarkStyleDirty(NodeIndex in_index)
+{
+  m_Flags[in_index] |= Flags::StyleDirty;
+  for (NodeIndex i = m_Parent[in_index]; i != InvalidIndex && (m_Flags[i] & Flags::DescendantStyleDirty) == 0; i = m_Parent[i])
+  {
+    m_Flags[i] |= Flags::DescendantStyleDirty;
+  }
+}
+
+DOMFlatTree::NodeIndex DOMFlatTree::FindIndex(const DOMNode* in_pNode) const
+{
+  NodeIndex uiIndex = InvalidIndex;
+  m_NodeToIndex.TryGetValue(in_pNode, uiIndex);
+  return uiIndex;
+}
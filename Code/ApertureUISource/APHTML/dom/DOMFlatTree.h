@@ -0,0 +1,137 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/dom/DOMNode.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <memory>
+#include <vector>
+/// NOTE: The DLL/PCH Header should always be included last.
+#include <APHTML/APEngineDLL.h>
+
+namespace aperture::dom
+{
+  /**
+   * @brief A structure-of-arrays copy of the DOM structure, for passes that walk the whole tree (style, layout, paint).
+   *
+   * DOMNode carries reflection, virtual functions, std::string names and shared_ptr child vectors, so a tree walk over it
+   * touches several cache lines per node. DOMFlatTree keeps only what a traversal needs in tightly packed arrays:
+   * parent / first child / next sibling indices, the node type byte and a flag word per node. The rich DOMNode objects
+   * are only referenced through a side table (GetNode()).
+   *
+   * Nodes are stored in pre-order, so the subtree of a node is the contiguous range [i, GetSubtreeEnd(i)) and a full
+   * walk is a linear loop over the arrays.
+   *
+   * @note The flat tree does not own the nodes. It must be rebuilt (Build()) after the DOM structure changed.
+   */
+  class NS_APERTURE_DLL DOMFlatTree
+  {
+  public:
+    using NodeIndex = nsUInt32;
+    static constexpr NodeIndex InvalidIndex = 0xFFFFFFFFu;
+
+    /// @brief Per node flags, used by passes to mark work.
+    struct Flags
+    {
+      using StorageType = nsUInt32;
+
+      enum Enum : StorageType
+      {
+        None = 0,
+        StyleDirty = NS_BIT(0),
+        LayoutDirty = NS_BIT(1),
+        PaintDirty = NS_BIT(2),
+        /// @brief Set if any node in the subtree (excluding the node itself) has StyleDirty.
+        DescendantStyleDirty = NS_BIT(3),
+        Hidden = NS_BIT(4),
+
+        Default = None
+      };
+    };
+
+    DOMFlatTree() = default;
+    ~DOMFlatTree() = default;
+
+    /// @brief Rebuilds the arrays from the given roots. All nodes start with the given flags.
+    void Build(const std::vector<std::shared_ptr<DOMNode>>& in_roots, nsUInt32 in_uiInitialFlags = Flags::None);
+    void Clear();
+
+    nsUInt32 GetNodeCount() const { return m_Parent.GetCount(); }
+
+    NodeIndex GetParent(NodeIndex in_index) const { return m_Parent[in_index]; }
+    NodeIndex GetFirstChild(NodeIndex in_index) const { return m_FirstChild[in_index]; }
+    NodeIndex GetNextSibling(NodeIndex in_index) const { return m_NextSibling[in_index]; }
+    /// @brief One past the last node of the subtree of in_index.
+    NodeIndex GetSubtreeEnd(NodeIndex in_index) const { return m_SubtreeEnd[in_index]; }
+    nsUInt16 GetDepth(NodeIndex in_index) const { return m_Depth[in_index]; }
+    DOMNodeType GetNodeType(NodeIndex in_index) const { return static_cast<DOMNodeType>(m_NodeType[in_index]); }
+
+    nsUInt32 GetFlags(NodeIndex in_index) const { return m_Flags[in_index]; }
+    bool HasFlags(NodeIndex in_index, nsUInt32 in_uiFlags) const { return (m_Flags[in_index] & in_uiFlags) == in_uiFlags; }
+    void AddFlags(NodeIndex in_index, nsUInt32 in_uiFlags) { m_Flags[in_index] |= in_uiFlags; }
+    void RemoveFlags(NodeIndex in_index, nsUInt32 in_uiFlags) { m_Flags[in_index] &= ~in_uiFlags; }
+
+    /// @brief Adds the flags to every node in the subtree, including the node itself.
+    void AddFlagsToSubtree(NodeIndex in_index, nsUInt32 in_uiFlags);
+
+    /// @brief Marks a node style dirty, and flags its ancestors so a style pass can skip clean subtrees.
+    void MarkStyleDirty(NodeIndex in_index);
+
+    /// @brief The rich node object for a index (side table).
+    DOMNode* GetNode(NodeIndex in_index) const { return m_Nodes[in_index]; }
+
+    /// @brief Returns the index of a node, or InvalidIndex if it isn't part of the flat tree.
+    NodeIndex FindIndex(const DOMNode* in_pNode) const;
+
+    /// @brief Direct array access for passes that iterate linearly.
+    nsArrayPtr<const NodeIndex> GetParents() const { return m_Parent; }
+    nsArrayPtr<const nsUInt8> GetNodeTypes() const { return m_NodeType; }
+    nsArrayPtr<nsUInt32> GetFlagArray() { return m_Flags; }
+
+  private:
+    nsDynamicArray<NodeIndex> m_Parent;
+    nsDynamicArray<NodeIndex> m_FirstChild;
+    nsDynamicArray<NodeIndex> m_NextSibling;
+    nsDynamicArray<NodeIndex> m_SubtreeEnd;
+    nsDynamicArray<nsUInt16> m_Depth;
+    nsDynamicArray<nsUInt8> m_NodeType;
+    nsDynamicArray<nsUInt32> m_Flags;
+
+    /// @brief Side table, only touched when a pass needs the full node.
+    nsDynamicArray<DOMNode*> m_Nodes;
+    nsHashTable<const DOMNode*, NodeIndex> m_NodeToIndex;
+  };
+} // namespace aperture::dom
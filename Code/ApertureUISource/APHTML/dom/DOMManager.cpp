@@ -1,5 +1,6 @@
 #include <APHTML/dom/DOMAttribute.h>
 #include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/LayoutTree.h>
 
 #include "DOMManager.h"
 
@@ -21,7 +22,7 @@ bool aperture::dom::DOMManager::operator<(const DOMManager& rhs) const
   return DOMElementArray.GetCount() < rhs.DOMElementArray.GetCount() && m_iterationele < rhs.m_iterationele;
 }
 
-void aperture::dom::DOMManager::SerializeDOMCollection()
+nsResult aperture::dom::DOMManager::SerializeDOMCollection(nsStreamWriter& out_stream, nsArrayPtr<const nsRectFloat> in_layoutBoxes)
 {
   std::vector<std::shared_ptr<aperture::dom::DOMElement>> sharedAcollection;
   sharedAcollection.reserve(DOMElementArray.GetCount());
@@ -32,6 +33,56 @@ void aperture::dom::DOMManager::SerializeDOMCollection()
   }
 
   collection.buildTree(sharedAcollection);
+
+  const auto& rootElements = collection.getRootElements();
+  std::vector<std::shared_ptr<aperture::dom::DOMNode>> roots(rootElements.begin(), rootElements.end());
+  return aperture::dom::DOMSnapshot::Write(out_stream, roots, in_layoutBoxes);
+}
+
+nsResult aperture::dom::DOMManager::RestoreDOMCollection(nsStringView in_sAbsolutePath)
+{
+  aperture::dom::DOMSnapshot snapshot;
+  return LoadDOMCollection(in_sAbsolutePath, snapshot);
+}
+
+nsResult aperture::dom::DOMManager::RestoreDOMCollection(nsStringView in_sAbsolutePath, layout::LayoutTree& inout_layout, float in_fWidth, float in_fHeight)
+{
+  aperture::dom::DOMSnapshot snapshot;
+  NS_SUCCEED_OR_RETURN(LoadDOMCollection(in_sAbsolutePath, snapshot));
+
+  const auto& rootElements = collection.getRootElements();
+  if (rootElements.empty())
+  {
+    inout_layout.Clear();
+    return NS_SUCCESS;
+  }
+
+  inout_layout.Build(*rootElements[0]);
+
+  // The stored boxes are those of every tree in the snapshot, the layout tree only has the first one.
+  if (snapshot.GetRootCount() == 1 && !snapshot.GetLayoutBoxes().IsEmpty())
+  {
+    inout_layout.RestoreLayout(snapshot.GetLayoutBoxes(), in_fWidth, in_fHeight).IgnoreResult();
+  }
+  return NS_SUCCESS;
+}
+
+nsResult aperture::dom::DOMManager::LoadDOMCollection(nsStringView in_sAbsolutePath, DOMSnapshot& out_snapshot)
+{
+  NS_SUCCEED_OR_RETURN(out_snapshot.LoadMapped(in_sAbsolutePath));
+
+  std::vector<std::shared_ptr<aperture::dom::DOMElement>> rootElements;
+  for (const auto& root : out_snapshot.Instantiate(&m_StyleCache))
+  {
+    if (auto element = std::dynamic_pointer_cast<aperture::dom::DOMElement>(root))
+    {
+      rootElements.push_back(element);
+    }
+  }
+
+  collection = aperture::dom::DOMCollection();
+  collection.buildTree(rootElements);
+  return NS_SUCCESS;
 }
 
 aperture::dom::DOMManager::DOMManager()
@@ -42,7 +93,9 @@ aperture::dom::DOMManager::DOMManager()
 aperture::dom::DOMManager::~DOMManager()
 {
   DOMElementArray.Clear();
-  delete GlobalDOMManager;
+  // The global only points at the manager, it doesn't own it.
+  if (GlobalDOMManager == this)
+    GlobalDOMManager = nullptr;
 }
 
 void aperture::dom::DOMManager::SetCurrentActedUponElement(const aperture::dom::DOMElement& in_element)
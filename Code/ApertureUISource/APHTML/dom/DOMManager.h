@@ -41,10 +41,17 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <Foundation/Containers/Map.h>
 #include <Foundation/Reflection/Reflection.h>
 #include <Foundation/Types/UniquePtr.h>
+#include <APHTML/css/Style/ComputedStyle.h>
 #include <APHTML/dom/DOMCollection.h>
+#include <APHTML/dom/DOMSnapshot.h>
 /// NOTE: The DLL/PCH Header should always be included last.
 #include <APHTML/APEngineDLL.h>
 
+namespace aperture::layout
+{
+  class LayoutTree;
+} // namespace aperture::layout
+
 namespace aperture::dom
 {
   class DOMElement;
@@ -67,14 +74,46 @@ namespace aperture::dom
     DOMElement CreateElement(const nsString& in_tagname);
     DOMElement GetCurrentActedUponElement() const;
     bool operator<(const DOMManager& rhs) const;
+
+    /**
+     * @brief Builds the DOMCollection and writes it as a DOMSnapshot, so the view can be restored later without re-parsing it.
+     *
+     * @param out_stream The stream the snapshot is written to.
+     * @param in_layoutBoxes Optional, the final layout box of every node in pre-order (see layout::LayoutTree::GetNodeBoxes()).
+     */
+    nsResult SerializeDOMCollection(nsStreamWriter& out_stream, nsArrayPtr<const nsRectFloat> in_layoutBoxes = {});
+
+    /**
+     * @brief Replaces the DOMCollection with the trees stored in a snapshot file. The file is memory mapped.
+     *
+     * The stored computed styles are added to GetStyleCache() and set on the elements, they don't have to be resolved again.
+     *
+     * @return NS_FAILURE if the snapshot is missing, corrupted or from a different version. The caller should rebuild the view in that case.
+     */
+    nsResult RestoreDOMCollection(nsStringView in_sAbsolutePath);
+
+    /**
+     * @brief Like RestoreDOMCollection(), and builds the layout tree from the first restored root.
+     *
+     * If the snapshot holds a single tree and its layout boxes, the tree takes them over (see layout::LayoutTree::RestoreLayout())
+     * and the next Calculate() with the same available size does nothing. Otherwise the tree has to be calculated as usual.
+     *
+     * @param inout_layout The tree to build, it keeps a pointer to the root, which is owned by the DOMCollection.
+     * @param in_fWidth, in_fHeight The available size the view is laid out with, the stored boxes are only valid for the size they were laid out with.
+     */
+    nsResult RestoreDOMCollection(nsStringView in_sAbsolutePath, layout::LayoutTree& inout_layout, float in_fWidth, float in_fHeight);
+
+    const DOMCollection& GetDOMCollection() const { return collection; }
+
+    /// @brief The cache the computed styles of restored elements are shared through, style resolution of the view should use it as well.
+    css::StyleCache& GetStyleCache() { return m_StyleCache; }
+
   private:
-    // TODO: No Need, Caching the DOM is dumb since its volatile....
-    /// <summary>
-    /// Serializes & Caches DOMCollection(s), along with the files. this should be the "database" of all constructed layouts.
-    /// </summary>
-    void SerializeDOMCollection();
 
     void SetCurrentActedUponElement(const aperture::dom::DOMElement& in_element);
+
+    /// @brief Instantiates the snapshot into the DOMCollection, the snapshot stays loaded for the caller.
+    nsResult LoadDOMCollection(nsStringView in_sAbsolutePath, DOMSnapshot& out_snapshot);
     
     /**
      * @brief An array of DOMElement objects. The collection of all DOM elements. we use this to grab the current acted upon element.
@@ -85,6 +124,7 @@ namespace aperture::dom
     nsDynamicArray<DOMElement> DOMElementArray;
     std::vector<aperture::dom::DOMElement> acollection;
     DOMCollection collection;
+    css::StyleCache m_StyleCache;
     int m_iterationele = 0;
   };
 } // namespace aperture::dom
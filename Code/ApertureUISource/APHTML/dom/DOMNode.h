@@ -73,6 +73,7 @@ namespace aperture::dom
   class NS_APERTURE_DLL DOMNode : public nsReflectedClass
   {
     NS_ALLOW_PRIVATE_PROPERTIES(aperture::dom::DOMNode);
+    friend class DOMElement;
 
   public:
     // Constructors and Destructor
@@ -0,0 +1,587 @@
+#include <APHTML/css/Style/ComputedStyle.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/dom/DOMSnapshot.h>
+#include <Foundation/IO/FileSystem/FileReader.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <string_view>
+
+using namespace aperture;
+using namespace aperture::dom;
+
+namespace
+{
+  constexpr char SnapshotMagic[4] = {'A', 'P', 'D', 'S'};
+  /// Snapshots are a cache of a single view, anything larger than this is corrupted.
+  constexpr nsUInt64 MaxSnapshotSize = nsUInt64(1) << 30;
+
+  enum SectionIndex
+  {
+    NodesSection,
+    AttributesSection,
+    StylesSection,
+    StyleValuesSection,
+    CustomPropertiesSection,
+    LayoutBoxesSection,
+    StringsSection,
+    SectionCount
+  };
+
+  constexpr nsUInt64 SectionElementSizes[SectionCount] = {
+    sizeof(DOMSnapshot::Node),
+    sizeof(DOMSnapshot::NameValue),
+    sizeof(DOMSnapshot::Style),
+    sizeof(DOMSnapshot::StyleValue),
+    sizeof(DOMSnapshot::NameValue),
+    sizeof(nsRectFloat),
+    sizeof(char),
+  };
+
+  struct Section
+  {
+    /// Relative to the start of the snapshot, aligned to 8 bytes.
+    nsUInt64 m_uiOffset;
+    nsUInt32 m_uiCount;
+    nsUInt32 m_uiReserved;
+  };
+
+  struct SnapshotHeader
+  {
+    char m_Magic[4];
+    nsUInt16 m_uiVersion;
+    nsUInt16 m_uiReserved;
+    nsUInt32 m_uiRootCount;
+    nsUInt32 m_uiReserved2;
+    nsUInt64 m_uiTotalSize;
+    Section m_Sections[SectionCount];
+  };
+
+  nsUInt64 AlignSectionOffset(nsUInt64 in_uiOffset)
+  {
+    return (in_uiOffset + 7) & ~nsUInt64(7);
+  }
+
+  std::string_view ToStdView(nsStringView in_string)
+  {
+    return std::string_view(in_string.GetStartPointer(), in_string.GetElementCount());
+  }
+
+  /// Computed values are keywords, strings, colors or a number with a single numeric unit.
+  bool IsValidUnit(nsUInt32 in_uiUnit)
+  {
+    const nsUInt32 uiNumeric = static_cast<nsUInt32>(core::Unit::NUMERIC);
+    if (in_uiUnit == static_cast<nsUInt32>(core::Unit::UNKNOWN) || in_uiUnit == static_cast<nsUInt32>(core::Unit::KEYWORD) ||
+        in_uiUnit == static_cast<nsUInt32>(core::Unit::STRING) || in_uiUnit == static_cast<nsUInt32>(core::Unit::COLOUR))
+      return true;
+    return (in_uiUnit & ~uiNumeric) == 0 && nsMath::IsPowerOf2(in_uiUnit);
+  }
+
+  std::string ToStdString(nsStringView in_string)
+  {
+    return std::string(in_string.GetStartPointer(), in_string.GetElementCount());
+  }
+
+  /// Collects the nodes of all trees in pre-order.
+  void CollectPreOrder(const std::vector<std::shared_ptr<DOMNode>>& in_roots, nsDynamicArray<const DOMNode*>& out_nodes)
+  {
+    nsHybridArray<const DOMNode*, 64> stack;
+    for (auto it = in_roots.rbegin(); it != in_roots.rend(); ++it)
+    {
+      if (*it != nullptr)
+        stack.PushBack(it->get());
+    }
+
+    while (!stack.IsEmpty())
+    {
+      const DOMNode* pNode = stack.PeekBack();
+      stack.PopBack();
+      out_nodes.PushBack(pNode);
+
+      const auto& children = pNode->getChildNodes();
+      for (auto it = children.rbegin(); it != children.rend(); ++it)
+      {
+        stack.PushBack(it->get());
+      }
+    }
+  }
+
+  /// Gathers the records of a snapshot before they are written.
+  class SnapshotBuilder
+  {
+  public:
+    DOMSnapshot::StringRef AddString(std::string_view in_string)
+    {
+      const nsStringView key(in_string.data(), static_cast<nsUInt32>(in_string.size()));
+      DOMSnapshot::StringRef ref;
+      if (m_StringRefs.TryGetValue(key, ref))
+        return ref;
+
+      ref.m_uiOffset = m_Strings.GetCount();
+      ref.m_uiLength = static_cast<nsUInt32>(in_string.size());
+      m_Strings.PushBackRange(nsArrayPtr<const char>(in_string.data(), static_cast<nsUInt32>(in_string.size())));
+      m_StringRefs.Insert(key, ref);
+      return ref;
+    }
+
+    nsUInt32 AddStyle(const css::ComputedStyle& in_style)
+    {
+      nsUInt32 uiIndex = 0;
+      if (m_StyleIndices.TryGetValue(&in_style, uiIndex))
+        return uiIndex;
+
+      const css::ComputedStyle& initial = css::ComputedStyle::GetInitialStyle();
+      const core::AtomTable& atoms = core::AtomTable::Get();
+
+      DOMSnapshot::Style& style = m_Styles.ExpandAndGetRef();
+      nsMemoryUtils::ZeroFill(&style, 1);
+      style.m_uiFirstValue = m_StyleValues.GetCount();
+      for (nsUInt32 i = 1; i < css::ComputedStyle::PropertyCount; ++i)
+      {
+        const PropertyId id = static_cast<PropertyId>(i);
+        if (in_style.HasSameValue(id, initial))
+          continue;
+
+        const css::CSSValue& value = in_style.Get(id);
+        DOMSnapshot::StyleValue& stored = m_StyleValues.ExpandAndGetRef();
+        nsMemoryUtils::ZeroFill(&stored, 1);
+        stored.m_uiProperty = i;
+        stored.m_uiUnit = static_cast<nsUInt32>(value.m_Unit);
+        stored.m_fNumber = value.m_fNumber;
+        if (value.m_Unit == core::Unit::KEYWORD)
+          stored.m_Text = AddString(ToStdView(atoms.GetString(value.m_uiData)));
+        else if (value.m_Unit == core::Unit::STRING)
+          stored.m_Text = AddString(in_style.GetString(id));
+        else
+          stored.m_uiData = value.m_uiData;
+      }
+      style.m_uiValueCount = m_StyleValues.GetCount() - style.m_uiFirstValue;
+
+      for (nsUInt32 i = 0; i < static_cast<nsUInt32>(PropertyId::MaxNumIds); ++i)
+      {
+        if (in_style.IsExplicitlySet(static_cast<PropertyId>(i)))
+          style.m_uiExplicitlySet[i >> 6] |= nsUInt64(1) << (i & 63);
+      }
+      style.m_uiHasVariables = in_style.GetVariableMask() != 0 ? 1 : 0;
+
+      style.m_uiFirstCustomProperty = m_CustomProperties.GetCount();
+      if (const css::CSSCustomProperties* pProperties = in_style.GetCustomProperties())
+      {
+        for (const css::CSSCustomProperties::Entry& entry : pProperties->GetEntries())
+        {
+          DOMSnapshot::NameValue& stored = m_CustomProperties.ExpandAndGetRef();
+          stored.m_Name = AddString(ToStdView(atoms.GetString(entry.m_Name)));
+          stored.m_Value = AddString(pProperties->GetValue(entry));
+        }
+      }
+      style.m_uiCustomPropertyCount = m_CustomProperties.GetCount() - style.m_uiFirstCustomProperty;
+
+      uiIndex = m_Styles.GetCount() - 1;
+      m_StyleIndices.Insert(&in_style, uiIndex);
+      return uiIndex;
+    }
+
+    nsDynamicArray<DOMSnapshot::Node> m_Nodes;
+    nsDynamicArray<DOMSnapshot::NameValue> m_Attributes;
+    nsDynamicArray<DOMSnapshot::Style> m_Styles;
+    nsDynamicArray<DOMSnapshot::StyleValue> m_StyleValues;
+    nsDynamicArray<DOMSnapshot::NameValue> m_CustomProperties;
+    nsDynamicArray<char> m_Strings;
+
+  private:
+    /// The views point into the DOM, the atom table and the computed styles, all of them outlive the builder.
+    nsHashTable<nsStringView, DOMSnapshot::StringRef> m_StringRefs;
+    nsHashTable<const css::ComputedStyle*, nsUInt32> m_StyleIndices;
+  };
+
+  nsResult WriteSection(nsStreamWriter& out_stream, nsUInt64& inout_uiPosition, const Section& in_section, const void* in_pData, nsUInt64 in_uiElementSize)
+  {
+    static const nsUInt8 s_Padding[8] = {};
+    NS_SUCCEED_OR_RETURN(out_stream.WriteBytes(s_Padding, in_section.m_uiOffset - inout_uiPosition));
+    NS_SUCCEED_OR_RETURN(out_stream.WriteBytes(in_pData, in_section.m_uiCount * in_uiElementSize));
+    inout_uiPosition = in_section.m_uiOffset + in_section.m_uiCount * in_uiElementSize;
+    return NS_SUCCESS;
+  }
+} // namespace
+
+nsResult DOMSnapshot::Write(nsStreamWriter& out_stream, const std::vector<std::shared_ptr<DOMNode>>& in_roots, nsArrayPtr<const nsRectFloat> in_layoutBoxes)
+{
+  NS_PROFILE_SCOPE("DOMSnapshot::Write");
+
+  nsDynamicArray<const DOMNode*> nodes;
+  CollectPreOrder(in_roots, nodes);
+
+  if (!in_layoutBoxes.IsEmpty() && in_layoutBoxes.GetCount() != nodes.GetCount())
+  {
+    nsLog::Error("DOMSnapshot: Got {0} layout boxes for {1} nodes.", in_layoutBoxes.GetCount(), nodes.GetCount());
+    return NS_FAILURE;
+  }
+
+  SnapshotBuilder builder;
+  builder.m_Nodes.SetCountUninitialized(nodes.GetCount());
+  for (nsUInt32 i = 0; i < nodes.GetCount(); ++i)
+  {
+    const DOMNode* pNode = nodes[i];
+    Node& node = builder.m_Nodes[i];
+    nsMemoryUtils::ZeroFill(&node, 1);
+    node.m_uiType = static_cast<nsUInt32>(pNode->getNodeType());
+    node.m_uiChildCount = static_cast<nsUInt32>(pNode->getChildNodes().size());
+    node.m_uiStyle = InvalidIndex;
+    node.m_Name = builder.AddString(pNode->getNodeName());
+    node.m_Value = builder.AddString(pNode->getNodeValue());
+    node.m_uiFirstAttribute = builder.m_Attributes.GetCount();
+
+    const DOMElement* pElement = pNode->getNodeType() == DOMNodeType::ELEMENT_NODE ? dynamic_cast<const DOMElement*>(pNode) : nullptr;
+    if (pElement != nullptr)
+    {
+      for (const auto& attribute : pElement->getAttributes())
+      {
+        NameValue& stored = builder.m_Attributes.ExpandAndGetRef();
+        stored.m_Name = builder.AddString(attribute.first);
+        stored.m_Value = builder.AddString(attribute.second);
+      }
+
+      if (pElement->getComputedStyle() != nullptr)
+        node.m_uiStyle = builder.AddStyle(*pElement->getComputedStyle());
+    }
+    node.m_uiAttributeCount = builder.m_Attributes.GetCount() - node.m_uiFirstAttribute;
+  }
+
+  SnapshotHeader header;
+  nsMemoryUtils::ZeroFill(&header, 1);
+  nsMemoryUtils::Copy(header.m_Magic, SnapshotMagic, 4);
+  header.m_uiVersion = FormatVersion;
+  for (const auto& root : in_roots)
+  {
+    header.m_uiRootCount += root != nullptr ? 1 : 0;
+  }
+
+  const nsUInt64 uiCounts[SectionCount] = {
+    builder.m_Nodes.GetCount(),
+    builder.m_Attributes.GetCount(),
+    builder.m_Styles.GetCount(),
+    builder.m_StyleValues.GetCount(),
+    builder.m_CustomProperties.GetCount(),
+    in_layoutBoxes.GetCount(),
+    builder.m_Strings.GetCount(),
+  };
+
+  nsUInt64 uiOffset = sizeof(SnapshotHeader);
+  for (nsUInt32 i = 0; i < SectionCount; ++i)
+  {
+    header.m_Sections[i].m_uiOffset = AlignSectionOffset(uiOffset);
+    header.m_Sections[i].m_uiCount = static_cast<nsUInt32>(uiCounts[i]);
+    uiOffset = header.m_Sections[i].m_uiOffset + uiCounts[i] * SectionElementSizes[i];
+  }
+  header.m_uiTotalSize = uiOffset;
+
+  if (header.m_uiTotalSize > MaxSnapshotSize)
+  {
+    nsLog::Error("DOMSnapshot: The snapshot would be {0} bytes, which is more than the maximum.", header.m_uiTotalSize);
+    return NS_FAILURE;
+  }
+
+  NS_SUCCEED_OR_RETURN(out_stream.WriteBytes(&header, sizeof(SnapshotHeader)));
+  nsUInt64 uiPosition = sizeof(SnapshotHeader);
+  NS_SUCCEED_OR_RETURN(WriteSection(out_stream, uiPosition, header.m_Sections[NodesSection], builder.m_Nodes.GetData(), sizeof(Node)));
+  NS_SUCCEED_OR_RETURN(WriteSection(out_stream, uiPosition, header.m_Sections[AttributesSection], builder.m_Attributes.GetData(), sizeof(NameValue)));
+  NS_SUCCEED_OR_RETURN(WriteSection(out_stream, uiPosition, header.m_Sections[StylesSection], builder.m_Styles.GetData(), sizeof(Style)));
+  NS_SUCCEED_OR_RETURN(WriteSection(out_stream, uiPosition, header.m_Sections[StyleValuesSection], builder.m_StyleValues.GetData(), sizeof(StyleValue)));
+  NS_SUCCEED_OR_RETURN(WriteSection(out_stream, uiPosition, header.m_Sections[CustomPropertiesSection], builder.m_CustomProperties.GetData(), sizeof(NameValue)));
+  NS_SUCCEED_OR_RETURN(WriteSection(out_stream, uiPosition, header.m_Sections[LayoutBoxesSection], in_layoutBoxes.GetPtr(), sizeof(nsRectFloat)));
+  NS_SUCCEED_OR_RETURN(WriteSection(out_stream, uiPosition, header.m_Sections[StringsSection], builder.m_Strings.GetData(), sizeof(char)));
+  return NS_SUCCESS;
+}
+
+nsResult DOMSnapshot::Read(nsStreamReader& inout_stream)
+{
+  NS_PROFILE_SCOPE("DOMSnapshot::Read");
+
+  Clear();
+
+  SnapshotHeader header;
+  if (inout_stream.ReadBytes(&header, sizeof(SnapshotHeader)) != sizeof(SnapshotHeader))
+  {
+    nsLog::Error("DOMSnapshot: The snapshot is truncated.");
+    return NS_FAILURE;
+  }
+
+  if (header.m_uiTotalSize < sizeof(SnapshotHeader) || header.m_uiTotalSize > MaxSnapshotSize)
+  {
+    nsLog::Error("DOMSnapshot: The snapshot is corrupted.");
+    return NS_FAILURE;
+  }
+
+  // One buffer for the whole snapshot, the records are used in place just like a mapped file.
+  m_Buffer.SetCountUninitialized(static_cast<nsUInt32>((header.m_uiTotalSize + 7) / 8));
+  nsMemoryUtils::Copy(reinterpret_cast<nsUInt8*>(m_Buffer.GetData()), reinterpret_cast<const nsUInt8*>(&header), sizeof(SnapshotHeader));
+
+  const nsUInt64 uiRemaining = header.m_uiTotalSize - sizeof(SnapshotHeader);
+  if (inout_stream.ReadBytes(reinterpret_cast<nsUInt8*>(m_Buffer.GetData()) + sizeof(SnapshotHeader), uiRemaining) != uiRemaining)
+  {
+    nsLog::Error("DOMSnapshot: The snapshot is truncated.");
+    Clear();
+    return NS_FAILURE;
+  }
+
+  return Parse(m_Buffer.GetData(), header.m_uiTotalSize);
+}
+
+nsResult DOMSnapshot::ReadFromMemory(const void* in_pData, nsUInt64 in_uiSize)
+{
+  Clear();
+  return Parse(in_pData, in_uiSize);
+}
+
+nsResult DOMSnapshot::LoadMapped(nsStringView in_sAbsolutePath)
+{
+  Clear();
+
+#if NS_ENABLED(NS_SUPPORTS_MEMORY_MAPPED_FILE)
+  NS_SUCCEED_OR_RETURN(m_MappedFile.Open(in_sAbsolutePath, nsMemoryMappedFile::Mode::ReadOnly));
+  return Parse(m_MappedFile.GetReadPointer(), m_MappedFile.GetFileSize());
+#else
+  nsFileReader file;
+  NS_SUCCEED_OR_RETURN(file.Open(in_sAbsolutePath));
+  return Read(file);
+#endif
+}
+
+nsResult DOMSnapshot::Parse(const void* in_pData, nsUInt64 in_uiSize)
+{
+  NS_PROFILE_SCOPE("DOMSnapshot::Parse");
+
+  const nsUInt8* pData = static_cast<const nsUInt8*>(in_pData);
+  if (pData == nullptr || in_uiSize < sizeof(SnapshotHeader) || (reinterpret_cast<std::uintptr_t>(pData) & 7) != 0)
+  {
+    nsLog::Error("DOMSnapshot: The snapshot is truncated or misaligned.");
+    Clear();
+    return NS_FAILURE;
+  }
+
+  SnapshotHeader header;
+  nsMemoryUtils::Copy(reinterpret_cast<nsUInt8*>(&header), pData, sizeof(SnapshotHeader));
+  if (!nsMemoryUtils::IsEqual(header.m_Magic, SnapshotMagic, 4) || header.m_uiVersion != FormatVersion)
+  {
+    nsLog::Warning("DOMSnapshot: Snapshot has a different format version, it has to be rebuilt.");
+    Clear();
+    return NS_FAILURE;
+  }
+
+  auto Fail = [&]() {
+    nsLog::Error("DOMSnapshot: The snapshot is corrupted.");
+    Clear();
+    return NS_FAILURE;
+  };
+
+  if (header.m_uiTotalSize > in_uiSize || header.m_uiTotalSize > MaxSnapshotSize)
+    return Fail();
+
+  for (nsUInt32 i = 0; i < SectionCount; ++i)
+  {
+    const Section& section = header.m_Sections[i];
+    const nsUInt64 uiBytes = section.m_uiCount * SectionElementSizes[i];
+    if (section.m_uiOffset < sizeof(SnapshotHeader) || (section.m_uiOffset & 7) != 0 || section.m_uiOffset > header.m_uiTotalSize ||
+        uiBytes > header.m_uiTotalSize - section.m_uiOffset)
+      return Fail();
+  }
+
+  auto GetSection = [&](SectionIndex in_index, auto* in_pType) {
+    using Type = std::remove_pointer_t<decltype(in_pType)>;
+    const Section& section = header.m_Sections[in_index];
+    return nsArrayPtr<const Type>(reinterpret_cast<const Type*>(pData + section.m_uiOffset), section.m_uiCount);
+  };
+
+  m_Nodes = GetSection(NodesSection, static_cast<Node*>(nullptr));
+  m_Attributes = GetSection(AttributesSection, static_cast<NameValue*>(nullptr));
+  m_Styles = GetSection(StylesSection, static_cast<Style*>(nullptr));
+  m_StyleValues = GetSection(StyleValuesSection, static_cast<StyleValue*>(nullptr));
+  m_CustomProperties = GetSection(CustomPropertiesSection, static_cast<NameValue*>(nullptr));
+  m_LayoutBoxes = GetSection(LayoutBoxesSection, static_cast<nsRectFloat*>(nullptr));
+  m_Strings = GetSection(StringsSection, static_cast<char*>(nullptr));
+  m_uiRootCount = header.m_uiRootCount;
+
+  // Every index is checked here, so nothing else has to.
+  const nsUInt64 uiStringBytes = m_Strings.GetCount();
+  auto IsValidString = [&](const StringRef& in_string) {
+    return in_string.m_uiOffset <= uiStringBytes && in_string.m_uiLength <= uiStringBytes - in_string.m_uiOffset;
+  };
+  auto IsValidRange = [](nsUInt32 in_uiFirst, nsUInt32 in_uiCount, nsUInt32 in_uiTotal) {
+    return nsUInt64(in_uiFirst) + in_uiCount <= in_uiTotal;
+  };
+
+  nsUInt64 uiTotalChildren = 0;
+  for (const Node& node : m_Nodes)
+  {
+    if (node.m_uiType < static_cast<nsUInt32>(DOMNodeType::ELEMENT_NODE) || node.m_uiType > static_cast<nsUInt32>(DOMNodeType::DOCUMENT_FRAGMENT_NODE))
+      return Fail();
+    if (!IsValidString(node.m_Name) || !IsValidString(node.m_Value) || !IsValidRange(node.m_uiFirstAttribute, node.m_uiAttributeCount, m_Attributes.GetCount()))
+      return Fail();
+    if (node.m_uiStyle != InvalidIndex && node.m_uiStyle >= m_Styles.GetCount())
+      return Fail();
+    uiTotalChildren += node.m_uiChildCount;
+  }
+
+  // Every node but the roots is the child of exactly one other node.
+  if (uiTotalChildren + m_uiRootCount != m_Nodes.GetCount())
+    return Fail();
+
+  for (const NameValue& attribute : m_Attributes)
+  {
+    if (!IsValidString(attribute.m_Name) || !IsValidString(attribute.m_Value))
+      return Fail();
+  }
+
+  for (const NameValue& property : m_CustomProperties)
+  {
+    if (!IsValidString(property.m_Name) || !IsValidString(property.m_Value))
+      return Fail();
+  }
+
+  for (const Style& style : m_Styles)
+  {
+    if (!IsValidRange(style.m_uiFirstValue, style.m_uiValueCount, m_StyleValues.GetCount()) ||
+        !IsValidRange(style.m_uiFirstCustomProperty, style.m_uiCustomPropertyCount, m_CustomProperties.GetCount()))
+      return Fail();
+  }
+
+  for (const StyleValue& value : m_StyleValues)
+  {
+    if (value.m_uiProperty == 0 || value.m_uiProperty >= css::ComputedStyle::PropertyCount || !IsValidUnit(value.m_uiUnit) || !IsValidString(value.m_Text))
+      return Fail();
+  }
+
+  if (!m_LayoutBoxes.IsEmpty() && m_LayoutBoxes.GetCount() != m_Nodes.GetCount())
+    return Fail();
+
+  return NS_SUCCESS;
+}
+
+std::vector<std::shared_ptr<DOMNode>> DOMSnapshot::Instantiate(css::StyleCache* in_pStyleCache) const
+{
+  NS_PROFILE_SCOPE("DOMSnapshot::Instantiate");
+
+  struct OpenParent
+  {
+    std::shared_ptr<DOMNode> m_pNode;
+    nsUInt32 m_uiRemainingChildren = 0;
+  };
+
+  // Styles are built the first time a element uses them, the cache shares them with other elements again.
+  nsDynamicArray<nsSharedPtr<const css::ComputedStyle>> styles;
+  styles.SetCount(in_pStyleCache != nullptr ? m_Styles.GetCount() : 0);
+  auto GetStyle = [&](nsUInt32 in_uiStyle) -> const nsSharedPtr<const css::ComputedStyle>& {
+    if (styles[in_uiStyle] == nullptr)
+    {
+      const Style& stored = m_Styles[in_uiStyle];
+      css::ComputedStyle style;
+      for (const StyleValue& value : m_StyleValues.GetSubArray(stored.m_uiFirstValue, stored.m_uiValueCount))
+      {
+        const PropertyId id = static_cast<PropertyId>(value.m_uiProperty);
+        const core::Unit unit = static_cast<core::Unit>(value.m_uiUnit);
+        if (unit == core::Unit::STRING)
+        {
+          // Only keywords are interned, the text is copied into the style.
+          style.SetString(id, ToStdView(GetString(value.m_Text)));
+          continue;
+        }
+
+        css::CSSValue computed;
+        if (unit == core::Unit::KEYWORD)
+          computed = css::CSSValue::MakeKeyword(core::MakeAtom(ToStdView(GetString(value.m_Text))));
+        else if (unit == core::Unit::COLOUR)
+          computed = css::CSSValue::MakeColor(value.m_uiData);
+        else
+          computed = css::CSSValue::MakeNumeric(value.m_fNumber, unit);
+        style.Set(id, computed);
+      }
+
+      for (nsUInt32 i = 0; i < static_cast<nsUInt32>(PropertyId::MaxNumIds); ++i)
+      {
+        if ((stored.m_uiExplicitlySet[i >> 6] & (nsUInt64(1) << (i & 63))) != 0)
+          style.MarkExplicitlySet(static_cast<PropertyId>(i));
+      }
+
+      if (stored.m_uiCustomPropertyCount > 0)
+      {
+        nsSharedPtr<css::CSSCustomProperties> pProperties = NS_DEFAULT_NEW(css::CSSCustomProperties);
+        for (const NameValue& property : m_CustomProperties.GetSubArray(stored.m_uiFirstCustomProperty, stored.m_uiCustomPropertyCount))
+        {
+          pProperties->Set(core::MakeAtom(ToStdView(GetString(property.m_Name))), ToStdView(GetString(property.m_Value)));
+        }
+        style.SetCustomProperties(pProperties);
+      }
+
+      // The name bits of the mask are derived from atoms, which differ between runs. Depending on every name is safe.
+      if (stored.m_uiHasVariables != 0)
+        style.AddToVariableMask(~nsUInt64(0));
+
+      styles[in_uiStyle] = in_pStyleCache->GetOrAdd(style);
+    }
+    return styles[in_uiStyle];
+  };
+
+  std::vector<std::shared_ptr<DOMNode>> roots;
+  roots.reserve(m_uiRootCount);
+  nsHybridArray<OpenParent, 64> parents;
+
+  for (const Node& node : m_Nodes)
+  {
+    std::shared_ptr<DOMNode> pNode;
+    if (node.GetType() == DOMNodeType::ELEMENT_NODE)
+    {
+      auto pElement = std::make_shared<DOMElement>(ToStdString(GetString(node.m_Name)));
+      for (const NameValue& attribute : m_Attributes.GetSubArray(node.m_uiFirstAttribute, node.m_uiAttributeCount))
+      {
+        pElement->setAttribute(ToStdString(GetString(attribute.m_Name)), ToStdString(GetString(attribute.m_Value)));
+      }
+      if (in_pStyleCache != nullptr && node.m_uiStyle != InvalidIndex)
+      {
+        pElement->setComputedStyle(GetStyle(node.m_uiStyle));
+      }
+      pNode = pElement;
+    }
+    else
+    {
+      pNode = std::make_shared<DOMNode>(node.GetType(), ToStdString(GetString(node.m_Name)));
+    }
+    pNode->setNodeValue(ToStdString(GetString(node.m_Value)));
+
+    while (!parents.IsEmpty() && parents.PeekBack().m_uiRemainingChildren == 0)
+    {
+      parents.PopBack();
+    }
+
+    if (parents.IsEmpty())
+    {
+      roots.push_back(pNode);
+    }
+    else
+    {
+      OpenParent& parent = parents.PeekBack();
+      if (parent.m_pNode->getNodeType() == DOMNodeType::ELEMENT_NODE)
+        static_cast<DOMElement*>(parent.m_pNode.get())->appendChild(pNode);
+      else
+        parent.m_pNode->appendChild(pNode);
+      --parent.m_uiRemainingChildren;
+    }
+
+    if (node.m_uiChildCount > 0)
+    {
+      parents.PushBack({pNode, node.m_uiChildCount});
+    }
+  }
+  return roots;
+}
+
+void DOMSnapshot::Clear()
+{
+  m_Nodes = {};
+  m_Attributes = {};
+  m_Styles = {};
+  m_StyleValues = {};
+  m_CustomProperties = {};
+  m_LayoutBoxes = {};
+  m_Strings = {};
+  m_uiRootCount = 0;
+  m_Buffer.Clear();
+  m_MappedFile.Close();
+}
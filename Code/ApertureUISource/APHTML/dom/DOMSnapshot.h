@@ -0,0 +1,209 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/dom/DOMNode.h>
+#include <Foundation/IO/MemoryMappedFile.h>
+#include <Foundation/IO/Stream.h>
+#include <Foundation/Math/Rect.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <memory>
+#include <vector>
+/// NOTE: The DLL/PCH Header should always be included last.
+#include <APHTML/APEngineDLL.h>
+
+namespace aperture::css
+{
+  class StyleCache;
+} // namespace aperture::css
+
+namespace aperture::dom
+{
+  class DOMElement;
+
+  /**
+   * @brief A compact binary snapshot of a fully built DOM, its computed styles and optionally its layout, used to restore views without re-parsing them.
+   *
+   * The snapshot is a header followed by flat arrays of fixed size records (nodes in pre-order, attributes, styles, style values,
+   * custom properties, layout boxes) and one blob with every string. Strings are deduplicated while writing, so tag names,
+   * attribute names and class lists that repeat all over a document are only stored once, and records refer to them by offset.
+   *
+   * Loading is zero-copy: the records and strings are used right where they are in memory. ReadFromMemory() and LoadMapped()
+   * don't copy anything, Read() copies the stream into one buffer. Every offset and count is validated before it is used.
+   *
+   * Computed styles are stored once per distinct style, as the values that differ from the initial style. Instantiate() adds
+   * them to a StyleCache, which shares them between elements again.
+   *
+   * @note Snapshots are a cache. They are only valid for the same engine version and platform, and a version mismatch makes
+   * the load fail, so the caller rebuilds the view.
+   */
+  class NS_APERTURE_DLL DOMSnapshot
+  {
+  public:
+    /// @brief Bumped whenever the layout of any record changes.
+    static constexpr nsUInt16 FormatVersion = 2;
+    static constexpr nsUInt32 InvalidIndex = 0xFFFFFFFFu;
+
+    /// @brief A string in the string blob of the snapshot, see GetString().
+    struct StringRef
+    {
+      NS_DECLARE_POD_TYPE();
+
+      nsUInt32 m_uiOffset;
+      nsUInt32 m_uiLength;
+    };
+
+    /// @brief A node as it is stored in the snapshot, in pre-order.
+    struct Node
+    {
+      NS_DECLARE_POD_TYPE();
+
+      DOMNodeType GetType() const { return static_cast<DOMNodeType>(m_uiType); }
+
+      nsUInt32 m_uiType;
+      nsUInt32 m_uiChildCount;
+      /// @brief Index of the first attribute in GetAttributes() (elements only).
+      nsUInt32 m_uiFirstAttribute;
+      nsUInt32 m_uiAttributeCount;
+      /// @brief Index of the computed style in GetStyles(), InvalidIndex if the node has none.
+      nsUInt32 m_uiStyle;
+      StringRef m_Name;
+      StringRef m_Value;
+    };
+
+    /// @brief A name and a value, used for attributes and custom properties.
+    struct NameValue
+    {
+      NS_DECLARE_POD_TYPE();
+
+      StringRef m_Name;
+      StringRef m_Value;
+    };
+
+    /// @brief A distinct computed style.
+    struct Style
+    {
+      NS_DECLARE_POD_TYPE();
+
+      /// @brief See css::ComputedStyle::IsExplicitlySet().
+      nsUInt64 m_uiExplicitlySet[2];
+      /// @brief The values that differ from the initial style, in GetStyleValues().
+      nsUInt32 m_uiFirstValue;
+      nsUInt32 m_uiValueCount;
+      /// @brief The custom properties of the style, in GetCustomProperties().
+      nsUInt32 m_uiFirstCustomProperty;
+      nsUInt32 m_uiCustomPropertyCount;
+      /// @brief Whether the style depends on any custom property, see css::ComputedStyle::GetVariableMask().
+      nsUInt32 m_uiHasVariables;
+      nsUInt32 m_uiReserved;
+    };
+
+    /// @brief A computed value. Keywords and strings are stored as text, the atoms of the engine that wrote it are meaningless.
+    struct StyleValue
+    {
+      NS_DECLARE_POD_TYPE();
+
+      nsUInt32 m_uiProperty;
+      nsUInt32 m_uiUnit;
+      float m_fNumber;
+      /// @brief The color of COLOUR values.
+      nsUInt32 m_uiData;
+      /// @brief The text of KEYWORD and STRING values.
+      StringRef m_Text;
+    };
+
+    DOMSnapshot() = default;
+    ~DOMSnapshot() = default;
+
+    DOMSnapshot(const DOMSnapshot&) = delete;
+    DOMSnapshot& operator=(const DOMSnapshot&) = delete;
+
+    /**
+     * @brief Writes a snapshot of the given root nodes and their subtrees, including the computed styles of the elements.
+     *
+     * @param out_stream The stream to write to.
+     * @param in_roots The roots of the trees to store.
+     * @param in_layoutBoxes Optional, the final border box of every node in pre-order. Must be empty or match the node count.
+     */
+    static nsResult Write(nsStreamWriter& out_stream, const std::vector<std::shared_ptr<DOMNode>>& in_roots, nsArrayPtr<const nsRectFloat> in_layoutBoxes = {});
+
+    /// @brief Reads a snapshot from a stream into a buffer owned by the snapshot.
+    nsResult Read(nsStreamReader& inout_stream);
+
+    /// @brief Uses a snapshot in a block of memory without copying it. The memory has to stay valid (and unchanged) until the snapshot is cleared.
+    /// @note The memory has to be aligned to 8 bytes.
+    nsResult ReadFromMemory(const void* in_pData, nsUInt64 in_uiSize);
+
+    /// @brief Memory maps the given file and uses the snapshot in it without copying it. The file stays mapped until the snapshot is cleared.
+    nsResult LoadMapped(nsStringView in_sAbsolutePath);
+
+    /// @brief Creates the live DOM from the snapshot.
+    /// @param in_pStyleCache The cache the computed styles are added to. Without one the elements have no computed style.
+    /// @return The root nodes, in the order they were written.
+    std::vector<std::shared_ptr<DOMNode>> Instantiate(css::StyleCache* in_pStyleCache = nullptr) const;
+
+    void Clear();
+
+    nsArrayPtr<const Node> GetNodes() const { return m_Nodes; }
+    nsArrayPtr<const NameValue> GetAttributes() const { return m_Attributes; }
+    nsArrayPtr<const Style> GetStyles() const { return m_Styles; }
+    nsArrayPtr<const StyleValue> GetStyleValues() const { return m_StyleValues; }
+    nsArrayPtr<const NameValue> GetCustomProperties() const { return m_CustomProperties; }
+    nsUInt32 GetRootCount() const { return m_uiRootCount; }
+    /// @brief The stored layout boxes in pre-order, or empty if none were written.
+    nsArrayPtr<const nsRectFloat> GetLayoutBoxes() const { return m_LayoutBoxes; }
+
+    /// @brief The string a record refers to. Points into the snapshot, valid until it is cleared.
+    nsStringView GetString(const StringRef& in_string) const { return nsStringView(m_Strings.GetPtr() + in_string.m_uiOffset, in_string.m_uiLength); }
+
+  private:
+    /// @brief Validates the snapshot in the memory and points the record arrays into it.
+    nsResult Parse(const void* in_pData, nsUInt64 in_uiSize);
+
+    nsArrayPtr<const Node> m_Nodes;
+    nsArrayPtr<const NameValue> m_Attributes;
+    nsArrayPtr<const Style> m_Styles;
+    nsArrayPtr<const StyleValue> m_StyleValues;
+    nsArrayPtr<const NameValue> m_CustomProperties;
+    nsArrayPtr<const nsRectFloat> m_LayoutBoxes;
+    nsArrayPtr<const char> m_Strings;
+    nsUInt32 m_uiRootCount = 0;
+
+    /// @brief The memory of snapshots that were read from a stream.
+    nsDynamicArray<nsUInt64> m_Buffer;
+    nsMemoryMappedFile m_MappedFile;
+  };
+} // namespace aperture::dom
@@ -32,45 +32,41 @@ STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
 ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
 EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
-
 #pragma once
 
-#include <APHTML/APEngineCommonIncludes.h>
-#include <APHTML/layout/Core/LayoutCore.h>
-#include <vector>
+#include <APHTML/dom/events/DOMEvent.h>
+#include <Foundation/Time/Time.h>
 
-namespace aperture::layout
+namespace aperture::dom
 {
   /*
-   * @brief Represents a node in the layout tree.
-   * This is the most basic building block of the layout system.
-   * It is designed to be inherited from and extended to support more complex layout systems, e.g. Flexbox has its LayoutNode, Grid Has its LayoutNode, etc.
+   * @brief DOMAnimationEvent is a internal DOM representation of the end of a CSS animation or transition.
+   *
+   * Used for animationend (see https://www.w3.org/TR/css-animations-1/#interface-animationevent) and transitionend
+   * (see https://www.w3.org/TR/css-transitions-1/#interface-transitionevent). Both bubble and can't be cancelled.
    */
-  class NS_APERTURE_DLL LayoutNode
+  class NS_APERTURE_DLL DOMAnimationEvent : public DOMEvent
   {
   public:
-    LayoutNode(const Style& style)
-      : style_(style)
+    explicit DOMAnimationEvent(EventId in_eventid, std::string in_animationName, std::string in_propertyName, nsTime in_elapsedTime)
+      : DOMEvent(in_eventid, true, false)
+      , animationName_(std::move(in_animationName))
+      , propertyName_(std::move(in_propertyName))
+      , elapsedTime_(in_elapsedTime)
     {
     }
-    LayoutNode() = default;
-    virtual void addChild(std::shared_ptr<LayoutNode> child);
-
-    virtual void calculateLayout(const Size& availableSpace);
-
-    virtual void calculateLayout(float width, float height);
 
-  protected:
-    virtual void calculateRowLayout(const Size& availableSpace);
+    // Accessors
+    /// @brief The animation-name of the animation, empty for transitions.
+    const std::string& animationName() const { return animationName_; }
+    /// @brief The transitioned property, empty for animations.
+    const std::string& propertyName() const { return propertyName_; }
+    /// @brief The time the animation or transition ran, without the delay.
+    nsTime elapsedTime() const { return elapsedTime_; }
 
-    virtual void calculateColumnLayout(const Size& availableSpace);
-
-    virtual void positionChildren();
-    
-  public:
-    Style style_;
-    std::vector<std::shared_ptr<LayoutNode>> children_;
-    Size size_;
-    Position position_;
+  private:
+    std::string animationName_;
+    std::string propertyName_;
+    nsTime elapsedTime_;
   };
-} // namespace aperture::layout
+} // namespace aperture::dom
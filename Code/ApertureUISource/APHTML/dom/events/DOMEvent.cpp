@@ -0,0 +1,526 @@
+#include <APHTML/dom/events/DOMEvent.h>
+#include <APHTML/dom/events/DOMEventQueue.h>
+#include <APHTML/dom/events/DOMInputQueue.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Threading/Mutex.h>
+
+using namespace aperture;
+using namespace aperture::dom;
+
+namespace
+{
+  // NOTE: Must stay in the same order as aperture::EventId.
+  constexpr const char* s_BuiltinEventNames[] = {
+    "",
+    "mousedown",
+    "mousescroll",
+    "mouseover",
+    "mouseout",
+    "focus",
+    "blur",
+    "keydown",
+    "keyup",
+    "textinput",
+    "mouseup",
+    "click",
+    "dblclick",
+    "load",
+    "unload",
+    "show",
+    "hide",
+    "mousemove",
+    "dragmove",
+    "drag",
+    "dragstart",
+    "dragover",
+    "dragdrop",
+    "dragout",
+    "dragend",
+    "handledrag",
+    "resize",
+    "scroll",
+    "animationend",
+    "transitionend",
+    "change",
+    "submit",
+    "tabchange",
+  };
+  static_assert(NS_ARRAY_SIZE(s_BuiltinEventNames) == static_cast<size_t>(EventId::NumDefinedIds), "Event name table is out of sync with EventId.");
+
+  struct CustomEventRegistry
+  {
+    nsMutex m_Mutex;
+    nsHashTable<nsString, nsUInt16> m_NameToId;
+    nsDynamicArray<nsString> m_IdToName;
+  };
+
+  CustomEventRegistry& GetCustomEventRegistry()
+  {
+    static CustomEventRegistry s_Registry;
+    return s_Registry;
+  }
+
+  /// A dispatch running on this thread, nested dispatches (a listener dispatching another event) are chained through m_pOuter.
+  /// Listeners may destroy targets the dispatch still has to visit. Their destructor clears them from every active dispatch,
+  /// so the remaining steps skip them instead of calling into freed memory.
+  struct ActiveDispatch
+  {
+    ActiveDispatch(nsArrayPtr<DOMEventTarget*> in_path, DOMEventTarget* in_pTarget);
+    ~ActiveDispatch();
+
+    ActiveDispatch(const ActiveDispatch&) = delete;
+    ActiveDispatch& operator=(const ActiveDispatch&) = delete;
+
+    void Forget(const DOMEventTarget* in_pTarget);
+
+    nsArrayPtr<DOMEventTarget*> m_Path;
+    DOMEventTarget* m_pTarget = nullptr;
+    /// The target whose listeners are being invoked, null once a listener destroyed it.
+    DOMEventTarget* m_pInvoking = nullptr;
+    ActiveDispatch* m_pOuter = nullptr;
+  };
+
+  thread_local ActiveDispatch* s_pActiveDispatch = nullptr;
+
+  ActiveDispatch::ActiveDispatch(nsArrayPtr<DOMEventTarget*> in_path, DOMEventTarget* in_pTarget)
+    : m_Path(in_path)
+    , m_pTarget(in_pTarget)
+    , m_pOuter(s_pActiveDispatch)
+  {
+    s_pActiveDispatch = this;
+  }
+
+  ActiveDispatch::~ActiveDispatch()
+  {
+    s_pActiveDispatch = m_pOuter;
+  }
+
+  void ActiveDispatch::Forget(const DOMEventTarget* in_pTarget)
+  {
+    for (DOMEventTarget*& pTarget : m_Path)
+    {
+      if (pTarget == in_pTarget)
+        pTarget = nullptr;
+    }
+    if (m_pTarget == in_pTarget)
+      m_pTarget = nullptr;
+    if (m_pInvoking == in_pTarget)
+      m_pInvoking = nullptr;
+  }
+} // namespace
+
+EventId aperture::dom::GetEventIdFromName(const char* in_eventname)
+{
+  if (in_eventname == nullptr || in_eventname[0] == '\0')
+    return EventId::Invalid;
+
+  for (nsUInt16 i = 1; i < static_cast<nsUInt16>(EventId::NumDefinedIds); ++i)
+  {
+    if (nsStringUtils::IsEqual(s_BuiltinEventNames[i], in_eventname))
+      return static_cast<EventId>(i);
+  }
+
+  CustomEventRegistry& registry = GetCustomEventRegistry();
+  NS_LOCK(registry.m_Mutex);
+
+  nsUInt16 uiExistingId = 0;
+  if (registry.m_NameToId.TryGetValue(in_eventname, uiExistingId))
+    return static_cast<EventId>(uiExistingId);
+
+  const nsUInt32 uiCustomIndex = registry.m_IdToName.GetCount();
+  if (static_cast<nsUInt32>(EventId::FirstCustomId) + uiCustomIndex >= static_cast<nsUInt32>(EventId::MaxNumIds))
+  {
+    nsLog::Error("DOMEvent: Ran out of custom event ids, can't register '{0}'.", in_eventname);
+    return EventId::Invalid;
+  }
+
+  const nsUInt16 uiId = static_cast<nsUInt16>(static_cast<nsUInt16>(EventId::FirstCustomId) + uiCustomIndex);
+  registry.m_IdToName.PushBack(in_eventname);
+  registry.m_NameToId.Insert(in_eventname, uiId);
+  return static_cast<EventId>(uiId);
+}
+
+const char* aperture::dom::GetEventNameFromId(EventId in_eventid)
+{
+  const nsUInt16 uiId = static_cast<nsUInt16>(in_eventid);
+  if (uiId < static_cast<nsUInt16>(EventId::NumDefinedIds))
+    return s_BuiltinEventNames[uiId];
+
+  CustomEventRegistry& registry = GetCustomEventRegistry();
+  NS_LOCK(registry.m_Mutex);
+  const nsUInt32 uiCustomIndex = uiId - static_cast<nsUInt16>(EventId::FirstCustomId);
+  // The registry never shrinks, so the returned pointer stays valid.
+  return uiCustomIndex < registry.m_IdToName.GetCount() ? registry.m_IdToName[uiCustomIndex].GetData() : "";
+}
+
+DOMEventTarget::~DOMEventTarget()
+{
+  DOMInputQueue::GetGlobalInputQueue().CancelInputForTarget(this);
+  DOMEventQueue::GetScriptThreadQueue().CancelEventsForTarget(this);
+
+  for (ActiveDispatch* pDispatch = s_pActiveDispatch; pDispatch != nullptr; pDispatch = pDispatch->m_pOuter)
+  {
+    pDispatch->Forget(this);
+  }
+
+  unlinkFromParent();
+  while (m_pFirstChild != nullptr)
+  {
+    m_pFirstChild->unlinkFromParent();
+  }
+}
+
+void DOMEventTarget::setParent(DOMEventTarget* in_parent)
+{
+  if (parent == in_parent)
+    return;
+
+  unlinkFromParent();
+  if (in_parent == nullptr)
+    return;
+
+  parent = in_parent;
+  m_pPrevSibling = parent->m_pLastChild;
+  if (m_pPrevSibling != nullptr)
+    m_pPrevSibling->m_pNextSibling = this;
+  else
+    parent->m_pFirstChild = this;
+  parent->m_pLastChild = this;
+
+  if (m_subtreeListenerMask != 0)
+  {
+    parent->propagateSubtreeMask(m_subtreeListenerMask);
+  }
+}
+
+DOMEventTarget::ListenerHandle DOMEventTarget::addEventListener(EventId type, EventListener listener, bool useCapture, bool once)
+{
+  if (type == EventId::Invalid || !listener)
+    return 0;
+
+  // Insert after all existing entries of the same id, so listeners of one type keep their registration order.
+  nsUInt32 uiIndex = lowerBound(type);
+  while (uiIndex < m_listeners.GetCount() && m_listeners[uiIndex].m_id == type)
+    ++uiIndex;
+
+  ListenerEntry entry;
+  entry.m_id = type;
+  entry.m_handle = m_nextHandle++;
+  entry.m_bCapture = useCapture;
+  entry.m_bOnce = once;
+  entry.m_callback = std::move(listener);
+  m_listeners.InsertAt(uiIndex, std::move(entry));
+
+  const nsUInt64 uiBit = GetEventIdMaskBit(type);
+  m_localListenerMask |= uiBit;
+  propagateSubtreeMask(uiBit);
+  return m_listeners[uiIndex].m_handle;
+}
+
+void DOMEventTarget::removeEventListener(ListenerHandle handle)
+{
+  for (nsUInt32 i = 0; i < m_listeners.GetCount(); ++i)
+  {
+    if (m_listeners[i].m_handle == handle && !m_listeners[i].m_bRemoved)
+    {
+      m_listeners[i].m_bRemoved = true;
+      m_bHasPendingRemovals = true;
+      break;
+    }
+  }
+  compactListeners();
+}
+
+void DOMEventTarget::removeAllEventListeners(EventId type)
+{
+  for (nsUInt32 i = lowerBound(type); i < m_listeners.GetCount() && m_listeners[i].m_id == type; ++i)
+  {
+    m_listeners[i].m_bRemoved = true;
+    m_bHasPendingRemovals = true;
+  }
+  compactListeners();
+}
+
+bool DOMEventTarget::hasEventListener(EventId type) const
+{
+  if ((m_localListenerMask & GetEventIdMaskBit(type)) == 0)
+    return false;
+
+  for (nsUInt32 i = lowerBound(type); i < m_listeners.GetCount() && m_listeners[i].m_id == type; ++i)
+  {
+    if (!m_listeners[i].m_bRemoved)
+      return true;
+  }
+  return false;
+}
+
+bool DOMEventTarget::dispatchEvent(DOMEvent& event)
+{
+  NS_PROFILE_SCOPE("DOMEventTarget::dispatchEvent");
+
+  event.target_ = this;
+  event.propagationStopped_ = false;
+  event.immediatePropagationStopped_ = false;
+
+  // Build the propagation path once, from the target up to the root. Targets without a listener for this event are skipped entirely.
+  const nsUInt64 uiBit = GetEventIdMaskBit(event.id());
+  nsHybridArray<DOMEventTarget*, InlinePathCapacity> path;
+  for (DOMEventTarget* pAncestor = parent; pAncestor != nullptr; pAncestor = pAncestor->parent)
+  {
+    if ((pAncestor->m_localListenerMask & uiBit) != 0)
+    {
+      path.PushBack(pAncestor);
+    }
+  }
+
+  // As in the W3C spec, the path stays fixed even if a listener moves targets around. Destroyed targets are cleared from it
+  // (see ActiveDispatch), this target included, so every step checks for null first.
+  ActiveDispatch dispatch(path.GetArrayPtr(), this);
+
+  // Capture phase, root to target.
+  event.setEventPhase(DOMEvent::Phase::CAPTURING_PHASE);
+  for (nsUInt32 i = path.GetCount(); i-- > 0 && !event.isPropagationStopped();)
+  {
+    if (path[i] != nullptr)
+    {
+      path[i]->invokeListeners(event, true);
+    }
+  }
+
+  // Target phase. Capture listeners of the target run before its non-capture listeners.
+  if (!event.isPropagationStopped() && dispatch.m_pTarget != nullptr && (m_localListenerMask & uiBit) != 0)
+  {
+    event.setEventPhase(DOMEvent::Phase::AT_TARGET);
+    invokeListeners(event, true);
+    if (!event.isPropagationStopped() && dispatch.m_pTarget != nullptr)
+    {
+      invokeListeners(event, false);
+    }
+  }
+
+  // Bubble phase, target to root.
+  if (event.bubbles())
+  {
+    event.setEventPhase(DOMEvent::Phase::BUBBLING_PHASE);
+    for (nsUInt32 i = 0; i < path.GetCount() && !event.isPropagationStopped(); ++i)
+    {
+      if (path[i] != nullptr)
+      {
+        path[i]->invokeListeners(event, false);
+      }
+    }
+  }
+
+  event.setEventPhase(DOMEvent::Phase::NONE);
+  event.currentTarget_ = nullptr;
+  return !event.isDefaultPrevented();
+}
+
+nsUInt32 DOMEventTarget::dispatchEventToSubtree(DOMEvent& event)
+{
+  NS_PROFILE_SCOPE("DOMEventTarget::dispatchEventToSubtree");
+
+  event.propagationStopped_ = false;
+  event.immediatePropagationStopped_ = false;
+
+  // Collect the targets in tree order first, the subtree masks lead straight to the targets that have a listener.
+  const nsUInt64 uiBit = GetEventIdMaskBit(event.id());
+  const auto skipToListener = [uiBit](DOMEventTarget* pTarget) {
+    while (pTarget != nullptr && (pTarget->m_subtreeListenerMask & uiBit) == 0)
+      pTarget = pTarget->m_pNextSibling;
+    return pTarget;
+  };
+
+  nsUInt32 uiVisited = 0;
+  nsHybridArray<DOMEventTarget*, InlinePathCapacity> targets;
+  DOMEventTarget* pTarget = (m_subtreeListenerMask & uiBit) != 0 ? this : nullptr;
+  while (pTarget != nullptr)
+  {
+    ++uiVisited;
+    if ((pTarget->m_localListenerMask & uiBit) != 0)
+    {
+      targets.PushBack(pTarget);
+    }
+
+    DOMEventTarget* pNext = skipToListener(pTarget->m_pFirstChild);
+    for (DOMEventTarget* pUp = pTarget; pNext == nullptr && pUp != this; pUp = pUp->parent)
+    {
+      pNext = skipToListener(pUp->m_pNextSibling);
+    }
+    pTarget = pNext;
+  }
+
+  // Listeners may destroy targets that are still to come, those are cleared from the list (see ActiveDispatch).
+  ActiveDispatch dispatch(targets.GetArrayPtr(), nullptr);
+
+  event.setEventPhase(DOMEvent::Phase::AT_TARGET);
+  for (nsUInt32 i = 0; i < targets.GetCount() && !event.isPropagationStopped(); ++i)
+  {
+    if (targets[i] == nullptr)
+      continue;
+
+    event.target_ = targets[i];
+    targets[i]->invokeListeners(event, true);
+    if (!event.isPropagationStopped() && targets[i] != nullptr)
+    {
+      targets[i]->invokeListeners(event, false);
+    }
+  }
+
+  event.setEventPhase(DOMEvent::Phase::NONE);
+  event.currentTarget_ = nullptr;
+  return uiVisited;
+}
+
+void DOMEventTarget::dispatchEventAsync(std::shared_ptr<DOMEvent> event)
+{
+  DOMEventQueue::GetScriptThreadQueue().Enqueue(this, std::move(event));
+}
+
+void DOMEventTarget::invokeListeners(DOMEvent& event, bool captureListeners)
+{
+  const EventId id = event.id();
+  nsUInt32 i = lowerBound(id);
+  if (i >= m_listeners.GetCount() || m_listeners[i].m_id != id)
+    return;
+
+  ActiveDispatch* pDispatch = s_pActiveDispatch;
+  NS_ASSERT_DEBUG(pDispatch != nullptr, "Listeners are only invoked from within a dispatch.");
+  pDispatch->m_pInvoking = this;
+
+  event.currentTarget_ = this;
+  ++m_dispatchDepth;
+
+  // Listeners added while dispatching are not invoked for this event, as in the W3C spec.
+  // Entries of one id are kept in handle order, so everything at or above this handle was added during the dispatch.
+  const ListenerHandle uiHandleLimit = m_nextHandle;
+
+  while (i < m_listeners.GetCount() && m_listeners[i].m_id == id && m_listeners[i].m_handle < uiHandleLimit)
+  {
+    ListenerEntry& entry = m_listeners[i];
+    if (entry.m_bRemoved || entry.m_bCapture != captureListeners)
+    {
+      ++i;
+      continue;
+    }
+
+    if (entry.m_bOnce)
+    {
+      entry.m_bRemoved = true;
+      m_bHasPendingRemovals = true;
+    }
+
+    // Copy the callback, a listener may add listeners to this target and reallocate the array.
+    const ListenerHandle uiInvokedHandle = entry.m_handle;
+    EventListener callback = entry.m_callback;
+    callback(event);
+
+    // The listener destroyed this target, none of its members may be touched anymore.
+    if (pDispatch->m_pInvoking == nullptr)
+    {
+      event.currentTarget_ = nullptr;
+      return;
+    }
+
+    if (event.isImmediatePropagationStopped())
+      break;
+
+    // Re-locate the position after the invoked listener, entries of other ids may have been inserted in front of it.
+    i = lowerBound(id);
+    while (i < m_listeners.GetCount() && m_listeners[i].m_id == id && m_listeners[i].m_handle <= uiInvokedHandle)
+      ++i;
+  }
+
+  pDispatch->m_pInvoking = nullptr;
+  --m_dispatchDepth;
+  compactListeners();
+}
+
+nsUInt32 DOMEventTarget::lowerBound(EventId type) const
+{
+  nsUInt32 uiLow = 0;
+  nsUInt32 uiHigh = m_listeners.GetCount();
+  while (uiLow < uiHigh)
+  {
+    const nsUInt32 uiMid = (uiLow + uiHigh) / 2;
+    if (m_listeners[uiMid].m_id < type)
+      uiLow = uiMid + 1;
+    else
+      uiHigh = uiMid;
+  }
+  return uiLow;
+}
+
+void DOMEventTarget::compactListeners()
+{
+  if (!m_bHasPendingRemovals || m_dispatchDepth > 0)
+    return;
+
+  for (nsUInt32 i = m_listeners.GetCount(); i-- > 0;)
+  {
+    if (m_listeners[i].m_bRemoved)
+    {
+      m_listeners.RemoveAtAndCopy(i);
+    }
+  }
+  m_bHasPendingRemovals = false;
+  recomputeLocalMask();
+  refreshSubtreeMask();
+}
+
+void DOMEventTarget::recomputeLocalMask()
+{
+  m_localListenerMask = 0;
+  for (const ListenerEntry& entry : m_listeners)
+  {
+    m_localListenerMask |= GetEventIdMaskBit(entry.m_id);
+  }
+}
+
+void DOMEventTarget::propagateSubtreeMask(nsUInt64 bits)
+{
+  for (DOMEventTarget* pTarget = this; pTarget != nullptr && (pTarget->m_subtreeListenerMask & bits) != bits; pTarget = pTarget->parent)
+  {
+    pTarget->m_subtreeListenerMask |= bits;
+  }
+}
+
+void DOMEventTarget::refreshSubtreeMask()
+{
+  for (DOMEventTarget* pTarget = this; pTarget != nullptr; pTarget = pTarget->parent)
+  {
+    nsUInt64 uiMask = pTarget->m_localListenerMask;
+    for (const DOMEventTarget* pChild = pTarget->m_pFirstChild; pChild != nullptr; pChild = pChild->m_pNextSibling)
+    {
+      uiMask |= pChild->m_subtreeListenerMask;
+    }
+
+    // Unchanged bits can't change anything further up.
+    if (uiMask == pTarget->m_subtreeListenerMask)
+      break;
+    pTarget->m_subtreeListenerMask = uiMask;
+  }
+}
+
+void DOMEventTarget::unlinkFromParent()
+{
+  if (parent == nullptr)
+    return;
+
+  if (m_pPrevSibling != nullptr)
+    m_pPrevSibling->m_pNextSibling = m_pNextSibling;
+  else
+    parent->m_pFirstChild = m_pNextSibling;
+
+  if (m_pNextSibling != nullptr)
+    m_pNextSibling->m_pPrevSibling = m_pPrevSibling;
+  else
+    parent->m_pLastChild = m_pPrevSibling;
+
+  DOMEventTarget* pOldParent = parent;
+  parent = nullptr;
+  m_pPrevSibling = nullptr;
+  m_pNextSibling = nullptr;
+  pOldParent->refreshSubtreeMask();
+}
@@ -36,10 +36,29 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <APHTML/APEngineCommonIncludes.h>
 #include <APHTML/Interfaces/Internal/APCBuffer.h>
-
+#include <APHTML/core/ID.h>
+#include <Foundation/Containers/HybridArray.h>
+#include <memory>
+#include <string>
 
 namespace aperture::dom
 {
+  class DOMEventTarget;
+
+  /// @brief Maps a W3C/Aperture event name (e.g. "click", "mousemove") to its EventId.
+  /// @note Names that are not part of the built-in set are registered as custom ids (starting at EventId::FirstCustomId) on first use.
+  NS_APERTURE_DLL EventId GetEventIdFromName(const char* in_eventname);
+
+  /// @brief Returns the name of a EventId. Custom ids return the name they were registered with.
+  NS_APERTURE_DLL const char* GetEventNameFromId(EventId in_eventid);
+
+  /// @brief Returns the bit used for the given event id in the listener masks of a DOMEventTarget.
+  /// @note Built-in ids map to distinct bits, custom ids may share a bit. A set bit only means "there may be a listener".
+  NS_ALWAYS_INLINE nsUInt64 GetEventIdMaskBit(EventId in_eventid)
+  {
+    return nsUInt64(1) << (static_cast<nsUInt16>(in_eventid) & 63);
+  }
+
   /*
    * @brief DOMEvent is a internal DOM representation of a Nodes Events.
    *
@@ -48,12 +67,12 @@ namespace aperture::dom
    * {
    * DOMEventTarget button;
 
-    button.addEventListener("click", [](DOMEvent& event) {
-        nsLog::Info("Button clicked! Event type: {0}"event.type());
+    button.addEventListener(EventId::Click, [](DOMEvent& event) {
+        nsLog::Info("Button clicked! Event type: {0}", event.type());
         event.preventDefault();
     });
 
-    DOMEvent clickEvent("click", true, true);
+    DOMEvent clickEvent(EventId::Click, true, true);
     button.dispatchEvent(clickEvent);
 
     if (clickEvent.isDefaultPrevented()) {
@@ -65,7 +84,7 @@ namespace aperture::dom
     {
     public:
     CustomEvent(const std::string& type, void* data = nullptr)
-        : DOMEvent(type), customData(data) {}
+        : DOMEvent(type.c_str()), customData(data) {}
 
     void* getCustomData() const { return customData; }
     void setCustomData(void* data) { customData = data; }
@@ -80,6 +99,7 @@ namespace aperture::dom
   class NS_APERTURE_DLL DOMEvent : public nsReflectedClass
   {
     NS_ALLOW_PRIVATE_PROPERTIES(aperture::dom::DOMEvent);
+    friend class DOMEventTarget;
 
   public:
     enum class Phase
@@ -92,23 +112,39 @@ namespace aperture::dom
 
     explicit DOMEvent(const char* in_eventname, bool bubbles = false, bool cancelable = false)
       : type_(in_eventname)
+      , id_(GetEventIdFromName(in_eventname))
       , bubbles_(bubbles)
       , cancelable_(cancelable)
-      , defaultPrevented_(false)
-      , propagationStopped_(false)
-      , eventPhase_(Phase::NONE)
     {
     }
 
+    explicit DOMEvent(EventId in_eventid, bool bubbles = false, bool cancelable = false)
+      : type_(GetEventNameFromId(in_eventid))
+      , id_(in_eventid)
+      , bubbles_(bubbles)
+      , cancelable_(cancelable)
+    {
+    }
+
+    virtual ~DOMEvent() = default;
+
     // Accessors
-    std::string type() const { return type_; }
+    const std::string& type() const { return type_; }
+    EventId id() const { return id_; }
     bool bubbles() const { return bubbles_; }
     bool cancelable() const { return cancelable_; }
     bool isDefaultPrevented() const { return defaultPrevented_; }
     Phase eventPhase() const { return eventPhase_; }
+    DOMEventTarget* target() const { return target_; }
+    DOMEventTarget* currentTarget() const { return currentTarget_; }
 
     // Methods
     void stopPropagation() { propagationStopped_ = true; }
+    void stopImmediatePropagation()
+    {
+      propagationStopped_ = true;
+      immediatePropagationStopped_ = true;
+    }
     void preventDefault()
     {
       if (cancelable_)
@@ -117,17 +153,22 @@ namespace aperture::dom
       }
     }
     bool isPropagationStopped() const { return propagationStopped_; }
+    bool isImmediatePropagationStopped() const { return immediatePropagationStopped_; }
 
     // For internal use during event dispatch
     void setEventPhase(Phase phase) { eventPhase_ = phase; }
 
   private:
     std::string type_;
-    bool bubbles_;
-    bool cancelable_;
-    bool defaultPrevented_;
-    bool propagationStopped_;
-    Phase eventPhase_;
+    EventId id_ = EventId::Invalid;
+    bool bubbles_ = false;
+    bool cancelable_ = false;
+    bool defaultPrevented_ = false;
+    bool propagationStopped_ = false;
+    bool immediatePropagationStopped_ = false;
+    Phase eventPhase_ = Phase::NONE;
+    DOMEventTarget* target_ = nullptr;
+    DOMEventTarget* currentTarget_ = nullptr;
   };
 
   /*
@@ -142,76 +183,121 @@ namespace aperture::dom
 
     child.setParent(&root);
 
-    root.addEventListener("click", [](DOMEvent& event) {
+    root.addEventListener(EventId::Click, [](DOMEvent& event) {
         nsLog::Info(""Root listener invoked.");
     });
 
-    child.addEventListener("click", [](DOMEvent& event) {
+    child.addEventListener(EventId::Click, [](DOMEvent& event) {
         nsLog::Info("Child listener invoked.");
         event.stopPropagation(); // Stop bubbling
     });
 
-    DOMEvent clickEvent("click");
-    child.dispatchEventAsync(clickEvent); // Asynchronously dispatch the event
+    child.dispatchEventAsync(std::make_shared<DOMEvent>(EventId::Click, true)); // Queued to the script thread.
 
     CustomEvent customEvent("custom", new std::string("Custom data"));
     root.dispatchEvent(customEvent);
 
-   * @note Events are naturally async as well.
+   * @note Dispatch follows the W3C capture -> target -> bubble order. The propagation path is built once per dispatch,
+   * and only contains targets that actually have a listener for the event (see GetLocalListenerMask()).
+   * Targets a listener destroys during the dispatch are skipped by the remaining steps.
+   * @note dispatchEventToSubtree() delivers an event to every target below this one, subtrees without a listener for it
+   * (see GetSubtreeListenerMask()) are skipped without being visited.
+   * @note Listeners are stored in one flat array per target, sorted by EventId, instead of a map of strings.
    */
   class NS_APERTURE_DLL DOMEventTarget
   {
   public:
     using EventListener = std::function<void(DOMEvent&)>;
+    /// @brief Handle returned by addEventListener, used to remove the listener again.
+    using ListenerHandle = nsUInt32;
+
+    /// @brief The amount of targets that can be on the propagation path before it spills to the heap.
+    static constexpr nsUInt32 InlinePathCapacity = 32;
+
+    DOMEventTarget() = default;
+    virtual ~DOMEventTarget();
+
+    DOMEventTarget(const DOMEventTarget&) = delete;
+    DOMEventTarget& operator=(const DOMEventTarget&) = delete;
 
-    void setParent(DOMEventTarget* parent) { this->parent = parent; }
+    /// @brief Sets the parent target, the target is appended to its children. The subtree listener masks of the old and
+    /// the new parent are updated.
+    void setParent(DOMEventTarget* parent);
     DOMEventTarget* getParent() const { return parent; }
+    DOMEventTarget* getFirstChild() const { return m_pFirstChild; }
+    DOMEventTarget* getNextSibling() const { return m_pNextSibling; }
 
-    void addEventListener(const std::string& type, EventListener listener)
+    ListenerHandle addEventListener(EventId type, EventListener listener, bool useCapture = false, bool once = false);
+    ListenerHandle addEventListener(const std::string& type, EventListener listener, bool useCapture = false, bool once = false)
     {
-      listeners_[type].push_back(listener);
+      return addEventListener(GetEventIdFromName(type.c_str()), std::move(listener), useCapture, once);
     }
 
-    void dispatchEvent(DOMEvent& event)
-    {
-      event.setEventPhase(DOMEvent::Phase::AT_TARGET);
+    /// @brief Removes a listener added with addEventListener. Safe to call from within a listener during dispatch.
+    void removeEventListener(ListenerHandle handle);
 
-      if (parent)
-      {
-        parent->dispatchEvent(event); // Propagate to parent (bubbling phase)
-      }
+    /// @brief Removes every listener of a type. Safe to call from within a listener during dispatch.
+    void removeAllEventListeners(EventId type);
 
-      for (auto& listener : listeners)
-      {
-        if (!event.isPropagationStopped())
-        {
-          listener(event); // Invoke listeners
-        }
-      }
+    /// @brief Returns true if this target has at least one listener for the type.
+    bool hasEventListener(EventId type) const;
 
-      auto& handlers = listeners_[event.type()];
-      for (auto& handler : handlers)
-      {
-        if (!event.isPropagationStopped())
-        {
-          handler(event);
-        }
-      }
-    }
+    /// @brief Returns true if this target or any target below it may have a listener for the type.
+    /// @note Custom ids may share a bit with another id, see GetEventIdMaskBit().
+    bool hasEventListenerInSubtree(EventId type) const { return (m_subtreeListenerMask & GetEventIdMaskBit(type)) != 0; }
 
-    void DOMEventTarget::dispatchEventAsync(DOMEvent& event)
+    nsUInt64 GetLocalListenerMask() const { return m_localListenerMask; }
+    nsUInt64 GetSubtreeListenerMask() const { return m_subtreeListenerMask; }
+
+    /// @brief Synchronously dispatches the event through the capture, target and bubble phases.
+    /// @return False if the event was cancelable and a listener called preventDefault().
+    bool dispatchEvent(DOMEvent& event);
+
+    /// @brief Dispatches the event to this target and every target below it in tree order, at target phase only.
+    /// Subtrees without a listener for the event are skipped. stopPropagation() ends the dispatch.
+    /// @return The number of targets that were visited.
+    /// @note The targets are collected before any listener runs, targets added during the dispatch don't receive the event.
+    nsUInt32 dispatchEventToSubtree(DOMEvent& event);
+
+    /// @brief Queues the event to be dispatched on the script thread (see DOMEventQueue).
+    /// @note The queue takes shared ownership of the event, so it stays alive until it was dispatched.
+    void dispatchEventAsync(std::shared_ptr<DOMEvent> event);
+
+  private:
+    struct ListenerEntry
     {
-      // TODO: Replace this with a proper nsTask...
-        std::thread([this, &event]()
-        {
-          dispatchEvent(event); // Delegate to synchronous dispatch
-        })
-        .detach();
-    }
+      EventId m_id = EventId::Invalid;
+      ListenerHandle m_handle = 0;
+      bool m_bCapture = false;
+      bool m_bOnce = false;
+      bool m_bRemoved = false;
+      EventListener m_callback;
+    };
+
+    /// @brief Invokes the listeners of this target that fit the current phase of the event.
+    void invokeListeners(DOMEvent& event, bool captureListeners);
+    /// @brief Returns the first index in m_listeners that has a id >= type.
+    nsUInt32 lowerBound(EventId type) const;
+    /// @brief Drops entries flagged as removed, once no dispatch is running on this target.
+    void compactListeners();
+    void recomputeLocalMask();
+    /// @brief ORs the given bits into the subtree mask of this target and all of its ancestors.
+    void propagateSubtreeMask(nsUInt64 bits);
+    /// @brief Recomputes the subtree mask of this target and its ancestors after listeners or children were removed.
+    void refreshSubtreeMask();
+    void unlinkFromParent();
 
   private:
     DOMEventTarget* parent = nullptr;
-    std::vector<std::function<void(DOMEvent&)>> listeners;
-    std::unordered_map<std::string, std::vector<EventListener>> listeners_;
+    DOMEventTarget* m_pFirstChild = nullptr;
+    DOMEventTarget* m_pLastChild = nullptr;
+    DOMEventTarget* m_pPrevSibling = nullptr;
+    DOMEventTarget* m_pNextSibling = nullptr;
+    nsDynamicArray<ListenerEntry> m_listeners;
+    nsUInt64 m_localListenerMask = 0;
+    nsUInt64 m_subtreeListenerMask = 0;
+    ListenerHandle m_nextHandle = 1;
+    nsUInt32 m_dispatchDepth = 0;
+    bool m_bHasPendingRemovals = false;
   };
 } // namespace aperture::dom
@@ -0,0 +1,136 @@
+#include <APHTML/dom/events/DOMEventQueue.h>
+#include <Foundation/Profiling/Profiling.h>
+
+using namespace aperture::dom;
+
+DOMEventQueue& DOMEventQueue::GetScriptThreadQueue()
+{
+  static DOMEventQueue s_ScriptThreadQueue;
+  return s_ScriptThreadQueue;
+}
+
+void DOMEventQueue::Enqueue(DOMEventTarget* in_pTarget, std::shared_ptr<DOMEvent> in_pEvent)
+{
+  if (in_pTarget == nullptr || in_pEvent == nullptr)
+    return;
+
+  NS_LOCK(m_Mutex);
+  QueuedEvent& queued = m_Pending.ExpandAndGetRef();
+  queued.m_pTarget = in_pTarget;
+  queued.m_pEvent = std::move(in_pEvent);
+}
+
+void DOMEventQueue::EnqueueBatch(nsDynamicArray<BatchedEvent>& inout_events)
+{
+  if (inout_events.IsEmpty())
+    return;
+
+  NS_LOCK(m_Mutex);
+  m_Pending.ExpandAndGetRef().m_Batch.Swap(inout_events);
+  inout_events.Clear();
+}
+
+void DOMEventQueue::SetBatchDispatcher(BatchDispatcher in_dispatcher)
+{
+  NS_LOCK(m_Mutex);
+  m_BatchDispatcher = std::move(in_dispatcher);
+}
+
+void DOMEventQueue::DispatchBatch(nsArrayPtr<BatchedEvent> in_batch)
+{
+  for (BatchedEvent& batched : in_batch)
+  {
+    if (!batched.m_bCancelled && batched.m_pTarget != nullptr && batched.m_pEvent != nullptr)
+    {
+      batched.m_pTarget->dispatchEvent(*batched.m_pEvent);
+    }
+  }
+}
+
+void DOMEventQueue::CancelEventsForTarget(const DOMEventTarget* in_pTarget)
+{
+  NS_LOCK(m_Mutex);
+  for (nsUInt32 i = m_Pending.GetCount(); i-- > 0;)
+  {
+    QueuedEvent& queued = m_Pending[i];
+    for (nsUInt32 j = queued.m_Batch.GetCount(); j-- > 0;)
+    {
+      if (queued.m_Batch[j].m_pTarget == in_pTarget)
+        queued.m_Batch.RemoveAtAndCopy(j);
+    }
+
+    if (queued.m_pTarget == in_pTarget || (queued.m_pTarget == nullptr && queued.m_Batch.IsEmpty()))
+    {
+      m_Pending.RemoveAtAndCopy(i);
+    }
+  }
+
+  // Entries that are currently being flushed are cleared or flagged instead of removed, the flush loop and batch dispatchers skip them.
+  for (QueuedEvent& queued : m_Flushing)
+  {
+    if (queued.m_pTarget == in_pTarget)
+    {
+      queued.m_pTarget = nullptr;
+      queued.m_pEvent.reset();
+    }
+    for (BatchedEvent& batched : queued.m_Batch)
+    {
+      // The dispatcher reads batch entries without the lock, only the flag is written.
+      if (batched.m_pTarget == in_pTarget)
+      {
+        batched.m_bCancelled = true;
+      }
+    }
+  }
+}
+
+nsUInt32 DOMEventQueue::Flush()
+{
+  NS_PROFILE_SCOPE("DOMEventQueue::Flush");
+  BatchDispatcher dispatcher;
+  {
+    NS_LOCK(m_Mutex);
+    if (m_Pending.IsEmpty())
+      return 0;
+    m_Flushing.Swap(m_Pending);
+    dispatcher = m_BatchDispatcher;
+  }
+
+  // m_Flushing isn't resized until the end, entries stay in place so CancelEventsForTarget() can clear them while they run.
+  const nsUInt32 uiCount = m_Flushing.GetCount();
+  for (nsUInt32 i = 0; i < uiCount; ++i)
+  {
+    QueuedEvent& queued = m_Flushing[i];
+    if (!queued.m_Batch.IsEmpty())
+    {
+      if (dispatcher)
+        dispatcher(queued.m_Batch.GetArrayPtr());
+      else
+        DispatchBatch(queued.m_Batch.GetArrayPtr());
+      continue;
+    }
+
+    DOMEventTarget* pTarget = nullptr;
+    std::shared_ptr<DOMEvent> pEvent;
+    {
+      NS_LOCK(m_Mutex);
+      pTarget = queued.m_pTarget;
+      pEvent = queued.m_pEvent;
+    }
+
+    if (pTarget != nullptr && pEvent != nullptr)
+    {
+      pTarget->dispatchEvent(*pEvent);
+    }
+  }
+
+  NS_LOCK(m_Mutex);
+  m_Flushing.Clear();
+  return uiCount;
+}
+
+nsUInt32 DOMEventQueue::GetQueuedCount() const
+{
+  NS_LOCK(m_Mutex);
+  return m_Pending.GetCount();
+}
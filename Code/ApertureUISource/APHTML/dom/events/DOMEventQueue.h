@@ -0,0 +1,116 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/dom/events/DOMEvent.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Mutex.h>
+
+namespace aperture::dom
+{
+  /*
+   * @brief A queue of events that are dispatched on the script thread.
+   *
+   * DOMEventTarget::dispatchEventAsync() pushes into the script thread queue instead of spawning a thread per event.
+   * The script thread drains the queue once per tick (see V8EEngineRuntime::ProcessAndTickEngine), so listeners that call into
+   * the isolate always run on the thread that owns it.
+   *
+   * A batch (e.g. the input of one frame, see DOMInputQueue) is one queue entry. With a BatchDispatcher set, the whole batch
+   * is handed over in one call, so the script runtime enters the isolate once per batch instead of once per event.
+   *
+   * @note Pushing is thread-safe. Flushing must only happen from one thread at a time.
+   */
+  class NS_APERTURE_DLL DOMEventQueue
+  {
+  public:
+    /// @brief One event of a batch.
+    struct BatchedEvent
+    {
+      DOMEventTarget* m_pTarget = nullptr;
+      std::shared_ptr<DOMEvent> m_pEvent;
+      /// @brief Set by CancelEventsForTarget() while the batch is dispatched. Target and event are left untouched, so the
+      /// dispatcher can read them without holding the queue lock.
+      nsAtomicBool m_bCancelled;
+    };
+
+    /// @brief Receives a whole batch in one call. It has to skip events with m_bCancelled set, their target was destroyed
+    /// by a listener of an earlier event of the batch.
+    using BatchDispatcher = std::function<void(nsArrayPtr<BatchedEvent>)>;
+
+    DOMEventQueue() = default;
+    ~DOMEventQueue() = default;
+
+    /// @brief The queue drained by the script thread.
+    static DOMEventQueue& GetScriptThreadQueue();
+
+    /// @brief Sets the function batches are handed to, without one their events are dispatched one by one.
+    void SetBatchDispatcher(BatchDispatcher in_dispatcher);
+
+    /// @brief Dispatches the events of a batch one by one, skipping cancelled ones.
+    static void DispatchBatch(nsArrayPtr<BatchedEvent> in_batch);
+
+    /// @brief Queues a event to be dispatched on the given target.
+    void Enqueue(DOMEventTarget* in_pTarget, std::shared_ptr<DOMEvent> in_pEvent);
+
+    /// @brief Moves a batch of events into the queue as a single entry, they are dispatched back to back and in order.
+    /// @note The events can still be cancelled per target.
+    void EnqueueBatch(nsDynamicArray<BatchedEvent>& inout_events);
+
+    /// @brief Drops all queued events for the given target. Called when a target is destroyed.
+    void CancelEventsForTarget(const DOMEventTarget* in_pTarget);
+
+    /// @brief Dispatches all queued events. Events queued while flushing are dispatched on the next flush.
+    /// @return The number of queue entries that were processed, a batch counts as one.
+    nsUInt32 Flush();
+
+    /// @brief The number of queue entries, a batch counts as one.
+    nsUInt32 GetQueuedCount() const;
+
+  private:
+    /// @brief A single event, or a batch if m_Batch isn't empty.
+    struct QueuedEvent
+    {
+      DOMEventTarget* m_pTarget = nullptr;
+      std::shared_ptr<DOMEvent> m_pEvent;
+      nsDynamicArray<BatchedEvent> m_Batch;
+    };
+
+    mutable nsMutex m_Mutex;
+    nsDynamicArray<QueuedEvent> m_Pending;
+    /// @brief Swapped with m_Pending on flush, so the lock is not held while listeners run.
+    nsDynamicArray<QueuedEvent> m_Flushing;
+    BatchDispatcher m_BatchDispatcher;
+  };
+} // namespace aperture::dom
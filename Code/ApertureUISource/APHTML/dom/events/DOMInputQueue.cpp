@@ -0,0 +1,214 @@
+#include <APHTML/dom/events/DOMEventQueue.h>
+#include <APHTML/dom/events/DOMInputQueue.h>
+#include <Foundation/Profiling/Profiling.h>
+
+using namespace aperture;
+using namespace aperture::dom;
+
+namespace
+{
+  /// Returns true if the target or one of its ancestors has a listener for the event, i.e. dispatching it would invoke anything.
+  bool HasListenerOnPath(const DOMEventTarget* in_pTarget, EventId in_eventid)
+  {
+    const nsUInt64 uiBit = GetEventIdMaskBit(in_eventid);
+    for (const DOMEventTarget* pTarget = in_pTarget; pTarget != nullptr; pTarget = pTarget->getParent())
+    {
+      if ((pTarget->GetLocalListenerMask() & uiBit) != 0)
+        return true;
+    }
+    return false;
+  }
+
+  /// Returns true for events that carry a pointer position, these are created as DOMMouseEvent.
+  bool IsPointerEvent(EventId in_eventid)
+  {
+    switch (in_eventid)
+    {
+      case EventId::MouseDown:
+      case EventId::MouseScroll:
+      case EventId::MouseOver:
+      case EventId::MouseOut:
+      case EventId::Mouseup:
+      case EventId::Click:
+      case EventId::Dblclick:
+      case EventId::Mousemove:
+      case EventId::Dragmove:
+      case EventId::Drag:
+      case EventId::Dragstart:
+      case EventId::Dragover:
+      case EventId::Dragdrop:
+      case EventId::Dragout:
+      case EventId::DragEnd:
+      case EventId::Handledrag:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /// Events that only concern their target, as in the DOM spec. Capture listeners of the ancestors still see them.
+  bool DoesEventBubble(EventId in_eventid)
+  {
+    switch (in_eventid)
+    {
+      case EventId::MouseOver:
+      case EventId::MouseOut:
+      case EventId::Focus:
+      case EventId::Blur:
+      case EventId::Load:
+      case EventId::Unload:
+      case EventId::Resize:
+      case EventId::Scroll:
+        return false;
+      default:
+        return true;
+    }
+  }
+
+  bool IsEventCancelable(EventId in_eventid)
+  {
+    switch (in_eventid)
+    {
+      case EventId::MouseDown:
+      case EventId::MouseScroll:
+      case EventId::Keydown:
+      case EventId::Keyup:
+      case EventId::Textinput:
+      case EventId::Mouseup:
+      case EventId::Click:
+      case EventId::Dblclick:
+      case EventId::Mousemove:
+      case EventId::Dragmove:
+      case EventId::Drag:
+      case EventId::Dragstart:
+      case EventId::Dragover:
+      case EventId::Dragdrop:
+      case EventId::Submit:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /// Adds the sample to a pending event. Only pointer events keep their samples, for the rest the event itself is all there is.
+  void AddSample(DOMEvent& inout_event, const DOMInputSample& in_sample)
+  {
+    if (IsPointerEvent(in_sample.m_id))
+    {
+      static_cast<DOMMouseEvent&>(inout_event).AddCoalescedSample(in_sample);
+    }
+  }
+} // namespace
+
+DOMInputQueue& DOMInputQueue::GetGlobalInputQueue()
+{
+  static DOMInputQueue s_GlobalInputQueue;
+  return s_GlobalInputQueue;
+}
+
+bool DOMInputQueue::IsCoalescableEvent(EventId in_eventid)
+{
+  switch (in_eventid)
+  {
+    case EventId::Mousemove:
+    case EventId::Dragmove:
+    case EventId::MouseScroll:
+    case EventId::Scroll:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void DOMInputQueue::PushSample(DOMEventTarget* in_pTarget, const DOMInputSample& in_sample)
+{
+  if (in_pTarget == nullptr || in_sample.m_id == EventId::Invalid)
+    return;
+
+  NS_LOCK(m_Mutex);
+  ++m_uiPendingSamples;
+
+  if (IsCoalescableEvent(in_sample.m_id))
+  {
+    // Only a handful of targets receive move/scroll input per frame, so a backwards scan is cheaper than a lookup table.
+    for (nsUInt32 i = m_Pending.GetCount(); i-- > m_uiCoalesceBarrier;)
+    {
+      PendingEvent& pending = m_Pending[i];
+      if (pending.m_pTarget == in_pTarget && pending.m_pEvent->id() == in_sample.m_id)
+      {
+        AddSample(*pending.m_pEvent, in_sample);
+        return;
+      }
+    }
+  }
+
+  PendingEvent& pending = m_Pending.ExpandAndGetRef();
+  pending.m_pTarget = in_pTarget;
+  const EventId eventid = in_sample.m_id;
+  if (IsPointerEvent(eventid))
+  {
+    pending.m_pEvent = std::make_shared<DOMMouseEvent>(eventid, DoesEventBubble(eventid), IsEventCancelable(eventid));
+  }
+  else
+  {
+    pending.m_pEvent = std::make_shared<DOMEvent>(eventid, DoesEventBubble(eventid), IsEventCancelable(eventid));
+  }
+  AddSample(*pending.m_pEvent, in_sample);
+
+  if (!IsCoalescableEvent(in_sample.m_id))
+  {
+    m_uiCoalesceBarrier = m_Pending.GetCount();
+  }
+}
+
+void DOMInputQueue::CancelInputForTarget(const DOMEventTarget* in_pTarget)
+{
+  NS_LOCK(m_Mutex);
+  for (nsUInt32 i = m_Pending.GetCount(); i-- > 0;)
+  {
+    if (m_Pending[i].m_pTarget == in_pTarget)
+    {
+      m_Pending.RemoveAtAndCopy(i);
+      if (m_uiCoalesceBarrier > i)
+      {
+        --m_uiCoalesceBarrier;
+      }
+    }
+  }
+}
+
+nsUInt32 DOMInputQueue::Flush(DOMEventQueue& in_eventQueue)
+{
+  NS_PROFILE_SCOPE("DOMInputQueue::Flush");
+
+  nsDynamicArray<PendingEvent> frameEvents;
+  {
+    NS_LOCK(m_Mutex);
+    frameEvents.Swap(m_Pending);
+    m_uiCoalesceBarrier = 0;
+    m_uiPendingSamples = 0;
+  }
+
+  nsDynamicArray<DOMEventQueue::BatchedEvent> batch;
+  batch.Reserve(frameEvents.GetCount());
+  for (PendingEvent& pending : frameEvents)
+  {
+    // Nobody on the propagation path listens, don't even queue it.
+    if (!HasListenerOnPath(pending.m_pTarget, pending.m_pEvent->id()))
+      continue;
+
+    DOMEventQueue::BatchedEvent& queued = batch.ExpandAndGetRef();
+    queued.m_pTarget = pending.m_pTarget;
+    queued.m_pEvent = std::move(pending.m_pEvent);
+  }
+
+  const nsUInt32 uiCount = batch.GetCount();
+  in_eventQueue.EnqueueBatch(batch);
+  return uiCount;
+}
+
+nsUInt32 DOMInputQueue::GetPendingSampleCount() const
+{
+  NS_LOCK(m_Mutex);
+  return m_uiPendingSamples;
+}
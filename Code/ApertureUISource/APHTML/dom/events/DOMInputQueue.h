@@ -0,0 +1,96 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/dom/events/DOMMouseEvent.h>
+#include <Foundation/Threading/Mutex.h>
+
+namespace aperture::dom
+{
+  class DOMEventQueue;
+
+  /*
+   * @brief Collects raw input from the host and turns it into DOM events once per frame.
+   *
+   * Mice and gamepads report at up to 1000 Hz, so pushing every sample as its own event would run hundreds of script listeners per frame.
+   * Samples of high frequency events (see IsCoalescableEvent()) are merged per target until the next Flush(), while every other
+   * event (mousedown, click, ...) stays a separate event and keeps its order relative to the coalesced ones.
+   * Pointer events are queued as DOMMouseEvent, every other id (keydown, scroll, ...) as a plain DOMEvent. Whether an event
+   * bubbles and can be cancelled depends on its type, e.g. scroll neither bubbles nor can be cancelled.
+   * Flush() hands the whole frame to the DOMEventQueue as a single batch, which reaches the script runtime in one call (see
+   * DOMEventQueue::SetBatchDispatcher()).
+   *
+   * @note PushSample() is thread-safe and may be called from the input thread. Flush() is called once per frame (see V8EEngineRuntime::ProcessAndTickEngine).
+   * @note Targets must stay alive until the frame was dispatched, or be removed with CancelInputForTarget().
+   */
+  class NS_APERTURE_DLL DOMInputQueue
+  {
+  public:
+    DOMInputQueue() = default;
+    ~DOMInputQueue() = default;
+
+    /// @brief The queue the host feeds its input into.
+    static DOMInputQueue& GetGlobalInputQueue();
+
+    /// @brief Returns true for events whose samples get merged into one event per frame.
+    static bool IsCoalescableEvent(EventId in_eventid);
+
+    /// @brief Queues a sample for the given target.
+    void PushSample(DOMEventTarget* in_pTarget, const DOMInputSample& in_sample);
+
+    /// @brief Drops all queued input for the given target.
+    void CancelInputForTarget(const DOMEventTarget* in_pTarget);
+
+    /// @brief Moves the events of this frame into the given event queue as one batch.
+    /// @return The number of events that were queued for dispatch.
+    nsUInt32 Flush(DOMEventQueue& in_eventQueue);
+
+    /// @brief Amount of raw samples pushed since the last flush. Useful to measure the coalescing ratio.
+    nsUInt32 GetPendingSampleCount() const;
+
+  private:
+    struct PendingEvent
+    {
+      DOMEventTarget* m_pTarget = nullptr;
+      std::shared_ptr<DOMEvent> m_pEvent;
+    };
+
+    mutable nsMutex m_Mutex;
+    nsDynamicArray<PendingEvent> m_Pending;
+    /// @brief Coalescing never merges across this index, so samples don't jump over a discrete event (e.g. a mousedown).
+    nsUInt32 m_uiCoalesceBarrier = 0;
+    nsUInt32 m_uiPendingSamples = 0;
+  };
+} // namespace aperture::dom
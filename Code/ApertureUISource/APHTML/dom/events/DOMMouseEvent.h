@@ -0,0 +1,99 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/dom/events/DOMEvent.h>
+#include <Foundation/Math/Vec2.h>
+#include <Foundation/Time/Time.h>
+
+namespace aperture::dom
+{
+  /// @brief A single raw pointer/scroll sample, as delivered by the host at device rate.
+  struct DOMInputSample
+  {
+    EventId m_id = EventId::Invalid;
+    /// @brief Pointer position in client coordinates.
+    nsVec2 m_vPosition = nsVec2::MakeZero();
+    /// @brief Movement or scroll delta of this sample.
+    nsVec2 m_vDelta = nsVec2::MakeZero();
+    /// @brief Bitmask of the pressed buttons (bit 0 = primary).
+    nsUInt32 m_uiButtons = 0;
+    nsTime m_Timestamp;
+  };
+
+  /*
+   * @brief DOMMouseEvent is a internal DOM representation of a mouse, drag or scroll event.
+   *
+   * High frequency events (mousemove, dragmove, mousescroll, scroll) are coalesced by the DOMInputQueue into one event per target and frame.
+   * The event itself carries the latest position and the accumulated delta, getCoalescedEvents() returns every raw sample it was built from.
+   * @see https://w3c.github.io/pointerevents/#dom-pointerevent-getcoalescedevents
+   */
+  class NS_APERTURE_DLL DOMMouseEvent : public DOMEvent
+  {
+  public:
+    explicit DOMMouseEvent(EventId in_eventid, bool bubbles = true, bool cancelable = true)
+      : DOMEvent(in_eventid, bubbles, cancelable)
+    {
+    }
+
+    // Accessors
+    float clientX() const { return position_.x; }
+    float clientY() const { return position_.y; }
+    float deltaX() const { return delta_.x; }
+    float deltaY() const { return delta_.y; }
+    nsUInt32 buttons() const { return buttons_; }
+    nsTime timeStamp() const { return timestamp_; }
+
+    /// @brief All samples that were merged into this event, oldest first.
+    const nsDynamicArray<DOMInputSample>& getCoalescedEvents() const { return coalescedSamples_; }
+
+    /// @brief Merges a sample into the event. Position, buttons and timestamp are taken from the sample, the delta is accumulated.
+    void AddCoalescedSample(const DOMInputSample& in_sample)
+    {
+      position_ = in_sample.m_vPosition;
+      delta_ += in_sample.m_vDelta;
+      buttons_ = in_sample.m_uiButtons;
+      timestamp_ = in_sample.m_Timestamp;
+      coalescedSamples_.PushBack(in_sample);
+    }
+
+  private:
+    nsVec2 position_ = nsVec2::MakeZero();
+    nsVec2 delta_ = nsVec2::MakeZero();
+    nsUInt32 buttons_ = 0;
+    nsTime timestamp_;
+    nsDynamicArray<DOMInputSample> coalescedSamples_;
+  };
+} // namespace aperture::dom
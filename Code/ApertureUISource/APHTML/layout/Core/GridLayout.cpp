@@ -0,0 +1,1027 @@
+#include <APHTML/layout/Core/GridLayout.h>
+#include <Foundation/Profiling/Profiling.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace aperture;
+using namespace aperture::layout;
+
+namespace
+{
+  constexpr float s_fInfinity = std::numeric_limits<float>::infinity();
+  constexpr float s_fIndefinite = std::numeric_limits<float>::quiet_NaN();
+
+  bool IsSameAvailable(float a, float b)
+  {
+    return a == b || (std::isnan(a) && std::isnan(b));
+  }
+
+  // Percentages of an indefinite size and fr minimums behave as auto.
+  GridTrackSizing GetMinSizing(const GridTrack& in_track, float in_fAvailable)
+  {
+    const GridTrackSizing sizing = in_track.m_Size.m_Min.m_Sizing;
+    if (in_track.m_bCollapsed)
+      return GridTrackSizing::Fixed;
+    if ((sizing == GridTrackSizing::Percent && std::isnan(in_fAvailable)) || sizing == GridTrackSizing::Flex || sizing == GridTrackSizing::FitContent)
+      return GridTrackSizing::Auto;
+    return sizing;
+  }
+
+  GridTrackSizing GetMaxSizing(const GridTrack& in_track, float in_fAvailable)
+  {
+    const GridTrackSizing sizing = in_track.m_Size.m_Max.m_Sizing;
+    if (in_track.m_bCollapsed)
+      return GridTrackSizing::Fixed;
+    if (sizing == GridTrackSizing::Percent && std::isnan(in_fAvailable))
+      return GridTrackSizing::Auto;
+    return sizing;
+  }
+
+  bool IsIntrinsic(GridTrackSizing in_sizing)
+  {
+    return in_sizing == GridTrackSizing::Auto || in_sizing == GridTrackSizing::MinContent || in_sizing == GridTrackSizing::MaxContent || in_sizing == GridTrackSizing::FitContent;
+  }
+
+  // The px size of a fixed or percentage breadth, negative if it has none.
+  float ResolveBreadth(const GridTrackBreadth& in_breadth, float in_fAvailable)
+  {
+    if (in_breadth.m_Sizing == GridTrackSizing::Fixed)
+      return in_breadth.m_fValue;
+    if (in_breadth.m_Sizing == GridTrackSizing::Percent && !std::isnan(in_fAvailable))
+      return in_fAvailable * in_breadth.m_fValue / 100.0f;
+    return -1.0f;
+  }
+
+  // Occupied cells of the grid during placement, in flow order: major is the axis that grows (rows for row flow).
+  class Occupancy
+  {
+  public:
+    void Reset(nsUInt32 in_uiMinorCount)
+    {
+      m_uiMinorCount = in_uiMinorCount;
+      m_uiMajorCount = 0;
+      m_Cells.Clear();
+      m_uiFirstFree = 0;
+    }
+
+    nsUInt32 GetMinorCount() const { return m_uiMinorCount; }
+    nsUInt32 GetMajorCount() const { return m_uiMajorCount; }
+
+    bool IsFree(nsUInt32 in_uiMajor, nsUInt32 in_uiMinor, nsUInt32 in_uiMajorSpan, nsUInt32 in_uiMinorSpan) const
+    {
+      const nsUInt32 uiMajorEnd = nsMath::Min(in_uiMajor + in_uiMajorSpan, m_uiMajorCount);
+      const nsUInt32 uiMinorEnd = nsMath::Min(in_uiMinor + in_uiMinorSpan, m_uiMinorCount);
+      for (nsUInt32 uiMajor = in_uiMajor; uiMajor < uiMajorEnd; ++uiMajor)
+      {
+        const nsUInt8* pRow = m_Cells.GetData() + uiMajor * m_uiMinorCount;
+        for (nsUInt32 uiMinor = in_uiMinor; uiMinor < uiMinorEnd; ++uiMinor)
+        {
+          if (pRow[uiMinor] != 0)
+            return false;
+        }
+      }
+      return true;
+    }
+
+    void Occupy(nsUInt32 in_uiMajor, nsUInt32 in_uiMinor, nsUInt32 in_uiMajorSpan, nsUInt32 in_uiMinorSpan)
+    {
+      Grow(in_uiMajor + in_uiMajorSpan, in_uiMinor + in_uiMinorSpan);
+      for (nsUInt32 uiMajor = in_uiMajor; uiMajor < in_uiMajor + in_uiMajorSpan; ++uiMajor)
+      {
+        nsUInt8* pRow = m_Cells.GetData() + uiMajor * m_uiMinorCount;
+        for (nsUInt32 uiMinor = in_uiMinor; uiMinor < in_uiMinor + in_uiMinorSpan; ++uiMinor)
+          pRow[uiMinor] = 1;
+      }
+
+      while (m_uiFirstFree < m_Cells.GetCount() && m_Cells[m_uiFirstFree] != 0)
+        ++m_uiFirstFree;
+    }
+
+    /// Every free area starts at or after the first free cell, dense packing searches from there.
+    void GetFirstFree(nsUInt32& out_uiMajor, nsUInt32& out_uiMinor) const
+    {
+      out_uiMajor = m_uiFirstFree / m_uiMinorCount;
+      out_uiMinor = m_uiFirstFree % m_uiMinorCount;
+    }
+
+  private:
+    void Grow(nsUInt32 in_uiMajorCount, nsUInt32 in_uiMinorCount)
+    {
+      if (in_uiMinorCount > m_uiMinorCount)
+      {
+        // Only items locked to a major line can add minor tracks, before any other item is placed.
+        nsDynamicArray<nsUInt8> cells;
+        cells.SetCount(m_uiMajorCount * in_uiMinorCount);
+        for (nsUInt32 uiMajor = 0; uiMajor < m_uiMajorCount; ++uiMajor)
+        {
+          for (nsUInt32 uiMinor = 0; uiMinor < m_uiMinorCount; ++uiMinor)
+            cells[uiMajor * in_uiMinorCount + uiMinor] = m_Cells[uiMajor * m_uiMinorCount + uiMinor];
+        }
+        m_Cells.Swap(cells);
+        m_uiMinorCount = in_uiMinorCount;
+        m_uiFirstFree = 0;
+      }
+
+      if (in_uiMajorCount > m_uiMajorCount)
+      {
+        m_uiMajorCount = in_uiMajorCount;
+        m_Cells.SetCount(m_uiMajorCount * m_uiMinorCount);
+      }
+    }
+
+    nsDynamicArray<nsUInt8> m_Cells;
+    nsUInt32 m_uiMinorCount = 1;
+    nsUInt32 m_uiMajorCount = 0;
+    nsUInt32 m_uiFirstFree = 0;
+  };
+
+  // The placement of an item in one axis, as 0-based line indices of the explicit grid.
+  struct AxisPlacement
+  {
+    nsInt32 m_iStart = 0;
+    nsUInt32 m_uiSpan = 1;
+    bool m_bAuto = true;
+  };
+
+  AxisPlacement ResolveLines(const GridLine& in_start, const GridLine& in_end, nsUInt32 in_uiExplicitTracks)
+  {
+    auto toIndex = [&](nsInt16 iLine) { return iLine > 0 ? static_cast<nsInt32>(iLine) - 1 : static_cast<nsInt32>(in_uiExplicitTracks) + 1 + iLine; };
+
+    AxisPlacement placement;
+    if (in_start.IsDefinite() && in_end.IsDefinite())
+    {
+      nsInt32 iStart = toIndex(in_start.m_iLine);
+      nsInt32 iEnd = toIndex(in_end.m_iLine);
+      if (iStart > iEnd)
+        nsMath::Swap(iStart, iEnd);
+      placement.m_iStart = iStart;
+      placement.m_uiSpan = static_cast<nsUInt32>(nsMath::Max(iEnd - iStart, 1));
+      placement.m_bAuto = false;
+    }
+    else if (in_start.IsDefinite())
+    {
+      placement.m_iStart = toIndex(in_start.m_iLine);
+      placement.m_uiSpan = nsMath::Max<nsUInt32>(in_end.m_uiSpan, 1);
+      placement.m_bAuto = false;
+    }
+    else if (in_end.IsDefinite())
+    {
+      placement.m_uiSpan = nsMath::Max<nsUInt32>(in_start.m_uiSpan, 1);
+      placement.m_iStart = toIndex(in_end.m_iLine) - static_cast<nsInt32>(placement.m_uiSpan);
+      placement.m_bAuto = false;
+    }
+    else
+    {
+      placement.m_uiSpan = nsMath::Max<nsUInt32>(in_start.m_uiSpan > 0 ? in_start.m_uiSpan : in_end.m_uiSpan, 1);
+    }
+    return placement;
+  }
+
+  // Sum of the sizes of the tracks in [uiStart, uiEnd) and the gaps between the ones that didn't collapse.
+  float GetSpannedSize(const nsDynamicArray<GridTrack>& in_tracks, nsUInt32 in_uiStart, nsUInt32 in_uiEnd, float in_fGap, bool in_bGrowthLimits)
+  {
+    float fSize = 0.0f;
+    nsUInt32 uiTracks = 0;
+    for (nsUInt32 i = in_uiStart; i < in_uiEnd; ++i)
+    {
+      const GridTrack& track = in_tracks[i];
+      fSize += in_bGrowthLimits && track.m_fGrowthLimit != s_fInfinity ? track.m_fGrowthLimit : track.m_fBaseSize;
+      uiTracks += track.m_bCollapsed ? 0 : 1;
+    }
+    return fSize + in_fGap * static_cast<float>(uiTracks > 0 ? uiTracks - 1 : 0);
+  }
+
+  // CSS Grid 1 12.7.1: the size of 1fr for the tracks in [uiStart, uiEnd) to fill the space.
+  float FindFrSize(const nsDynamicArray<GridTrack>& in_tracks, nsUInt32 in_uiStart, nsUInt32 in_uiEnd, float in_fSpace, float in_fGap, float in_fAvailable)
+  {
+    nsHybridArray<bool, 64> inflexible;
+    inflexible.SetCount(in_uiEnd - in_uiStart, false);
+
+    nsUInt32 uiTracks = 0;
+    for (nsUInt32 i = in_uiStart; i < in_uiEnd; ++i)
+      uiTracks += in_tracks[i].m_bCollapsed ? 0 : 1;
+    const float fLeftover = in_fSpace - in_fGap * static_cast<float>(uiTracks > 0 ? uiTracks - 1 : 0);
+
+    while (true)
+    {
+      float fSpace = fLeftover;
+      float fFlexSum = 0.0f;
+      for (nsUInt32 i = in_uiStart; i < in_uiEnd; ++i)
+      {
+        const GridTrack& track = in_tracks[i];
+        if (GetMaxSizing(track, in_fAvailable) == GridTrackSizing::Flex && !inflexible[i - in_uiStart])
+          fFlexSum += track.m_Size.m_Max.m_fValue;
+        else
+          fSpace -= track.m_fBaseSize;
+      }
+
+      const float fFrSize = nsMath::Max(fSpace, 0.0f) / nsMath::Max(fFlexSum, 1.0f);
+
+      bool bChanged = false;
+      for (nsUInt32 i = in_uiStart; i < in_uiEnd; ++i)
+      {
+        const GridTrack& track = in_tracks[i];
+        if (GetMaxSizing(track, in_fAvailable) == GridTrackSizing::Flex && !inflexible[i - in_uiStart] && fFrSize * track.m_Size.m_Max.m_fValue < track.m_fBaseSize)
+        {
+          inflexible[i - in_uiStart] = true;
+          bChanged = true;
+        }
+      }
+      if (!bChanged)
+        return fFrSize;
+    }
+  }
+
+  // Grows the sizes of the tracks equally (or by weight) by up to in_fSpace, each up to its cap. Returns the space left.
+  float GrowTracks(nsArrayPtr<const nsUInt32> in_tracks, nsArrayPtr<const float> in_sizes, nsArrayPtr<const float> in_caps, nsArrayPtr<const float> in_weights, nsArrayPtr<float> inout_increases, float in_fSpace)
+  {
+    float fSpace = in_fSpace;
+    while (fSpace > 0.001f)
+    {
+      float fWeights = 0.0f;
+      for (nsUInt32 i = 0; i < in_tracks.GetCount(); ++i)
+      {
+        if (in_sizes[i] + inout_increases[i] < in_caps[i])
+          fWeights += in_weights[i];
+      }
+      if (fWeights <= 0.0f)
+        break;
+
+      const float fShare = fSpace / fWeights;
+      for (nsUInt32 i = 0; i < in_tracks.GetCount(); ++i)
+      {
+        const float fRoom = in_caps[i] - in_sizes[i] - inout_increases[i];
+        if (fRoom <= 0.0f)
+          continue;
+
+        const float fGrowth = nsMath::Min(fShare * in_weights[i], fRoom);
+        inout_increases[i] += fGrowth;
+        fSpace -= fGrowth;
+      }
+    }
+    return nsMath::Max(fSpace, 0.0f);
+  }
+} // namespace
+
+GridTrackSize GridTrackSize::Make(GridTrackSizing in_sizing, float in_fValue)
+{
+  const GridTrackBreadth breadth = {in_sizing, in_fValue};
+  if (in_sizing == GridTrackSizing::Flex || in_sizing == GridTrackSizing::FitContent)
+    return {{GridTrackSizing::Auto, 0.0f}, breadth};
+  return {breadth, breadth};
+}
+
+bool GridAxisTemplate::operator==(const GridAxisTemplate& other) const
+{
+  return m_Tracks == other.m_Tracks && m_AutoRepeat == other.m_AutoRepeat && m_uiAutoRepeatIndex == other.m_uiAutoRepeatIndex && m_bAutoFit == other.m_bAutoFit &&
+         m_ImplicitTracks == other.m_ImplicitTracks && m_fGap == other.m_fGap && m_bGapPercent == other.m_bGapPercent;
+}
+
+bool GridTemplate::operator==(const GridTemplate& other) const
+{
+  return m_Columns == other.m_Columns && m_Rows == other.m_Rows && m_bColumnFlow == other.m_bColumnFlow && m_bDense == other.m_bDense &&
+         m_JustifyContent == other.m_JustifyContent && m_AlignContent == other.m_AlignContent;
+}
+
+bool GridLayout::SetTemplate(const GridTemplate& in_template)
+{
+  if (m_Template == in_template)
+    return false;
+
+  m_Template = in_template;
+  m_bPlacementDirty = true;
+  m_bLayoutDirty = true;
+  return true;
+}
+
+bool GridLayout::SetItems(nsArrayPtr<const GridPlacement> in_placements)
+{
+  if (m_Placements.GetArrayPtr() == in_placements)
+    return false;
+
+  const nsUInt32 uiPreviousCount = m_Placements.GetCount();
+  m_Placements = in_placements;
+  m_Areas.SetCountUninitialized(m_Placements.GetCount());
+  m_Contributions.SetCountUninitialized(m_Placements.GetCount());
+  for (nsUInt32 i = uiPreviousCount; i < m_Placements.GetCount(); ++i)
+    MarkItemDirty(i);
+
+  m_bPlacementDirty = true;
+  m_bLayoutDirty = true;
+  return true;
+}
+
+void GridLayout::MarkItemDirty(nsUInt32 in_uiItem)
+{
+  ItemContribution& contribution = m_Contributions[in_uiItem];
+  contribution.m_fMinWidth = 0.0f;
+  contribution.m_fMaxWidth = 0.0f;
+  contribution.m_fHeightForWidth = -1.0f;
+  contribution.m_fHeight = 0.0f;
+  contribution.m_bHasWidths = false;
+  m_bLayoutDirty = true;
+}
+
+bool GridLayout::NeedsLayout(float in_fWidth, float in_fHeight)
+{
+  if (!m_bPlacementDirty && !m_bLayoutDirty && IsSameAvailable(in_fWidth, m_fLayoutWidth) && IsSameAvailable(in_fHeight, m_fLayoutHeight))
+  {
+    ++m_Stats.m_uiCachedLayouts;
+    return false;
+  }
+  return true;
+}
+
+nsUInt32 GridLayout::GetAutoRepetitions(const GridAxisTemplate& in_axis, float in_fAvailable) const
+{
+  if (in_axis.m_AutoRepeat.IsEmpty())
+    return 0;
+  if (std::isnan(in_fAvailable))
+    return 1;
+
+  // CSS Grid 1 7.2.3.2: tracks count with their max sizing function if it is definite, their min sizing function otherwise.
+  auto getSize = [&](const GridTrackSize& size) {
+    const float fMax = ResolveBreadth(size.m_Max, in_fAvailable);
+    return fMax >= 0.0f ? fMax : nsMath::Max(ResolveBreadth(size.m_Min, in_fAvailable), 0.0f);
+  };
+
+  const float fGap = GetGap(in_axis, in_fAvailable);
+  float fOther = 0.0f;
+  for (const GridTrackSize& size : in_axis.m_Tracks)
+    fOther += getSize(size);
+  float fRepeat = 0.0f;
+  for (const GridTrackSize& size : in_axis.m_AutoRepeat)
+    fRepeat += getSize(size);
+
+  const float fRepeatWithGaps = fRepeat + fGap * static_cast<float>(in_axis.m_AutoRepeat.GetCount());
+  if (fRepeatWithGaps <= 0.0f)
+    return 1;
+
+  const float fOtherTracks = static_cast<float>(in_axis.m_Tracks.GetCount());
+  const float fRepetitions = std::floor((in_fAvailable - fOther - fGap * (fOtherTracks - 1.0f)) / fRepeatWithGaps);
+  return static_cast<nsUInt32>(nsMath::Clamp(fRepetitions, 1.0f, 10000.0f));
+}
+
+float GridLayout::GetGap(const GridAxisTemplate& in_axis, float in_fAvailable) const
+{
+  if (!in_axis.m_bGapPercent)
+    return in_axis.m_fGap;
+  return std::isnan(in_fAvailable) ? 0.0f : in_fAvailable * in_axis.m_fGap / 100.0f;
+}
+
+void GridLayout::InitAxis(const GridAxisTemplate& in_axis, nsUInt32 in_uiRepetitions, nsUInt32 in_uiLeadingImplicit, nsUInt32 in_uiCount, nsDynamicArray<GridTrack>& out_tracks) const
+{
+  const nsUInt32 uiRepeated = in_uiRepetitions * in_axis.m_AutoRepeat.GetCount();
+  const nsUInt32 uiExplicit = in_axis.m_Tracks.GetCount() + uiRepeated;
+  const nsUInt32 uiImplicitSizes = in_axis.m_ImplicitTracks.GetCount();
+
+  out_tracks.SetCountUninitialized(in_uiCount);
+  for (nsUInt32 i = 0; i < in_uiCount; ++i)
+  {
+    GridTrack& track = out_tracks[i];
+    track.m_bCollapsed = false;
+    track.m_Size = GridTrackSize::Make(GridTrackSizing::Auto);
+
+    if (i < in_uiLeadingImplicit)
+    {
+      // Implicit tracks before the explicit grid repeat the pattern backwards from its last size.
+      if (uiImplicitSizes > 0)
+        track.m_Size = in_axis.m_ImplicitTracks[uiImplicitSizes - 1 - (in_uiLeadingImplicit - 1 - i) % uiImplicitSizes];
+      continue;
+    }
+
+    const nsUInt32 uiTrack = i - in_uiLeadingImplicit;
+    if (uiTrack >= uiExplicit)
+    {
+      if (uiImplicitSizes > 0)
+        track.m_Size = in_axis.m_ImplicitTracks[(uiTrack - uiExplicit) % uiImplicitSizes];
+    }
+    else if (uiTrack < in_axis.m_uiAutoRepeatIndex)
+    {
+      track.m_Size = in_axis.m_Tracks[uiTrack];
+    }
+    else if (uiTrack < in_axis.m_uiAutoRepeatIndex + uiRepeated)
+    {
+      track.m_Size = in_axis.m_AutoRepeat[(uiTrack - in_axis.m_uiAutoRepeatIndex) % in_axis.m_AutoRepeat.GetCount()];
+      track.m_bCollapsed = in_axis.m_bAutoFit;
+    }
+    else
+    {
+      track.m_Size = in_axis.m_Tracks[uiTrack - uiRepeated];
+    }
+  }
+}
+
+void GridLayout::Place(float in_fWidth, float in_fHeight)
+{
+  const nsUInt32 uiColumnRepetitions = GetAutoRepetitions(m_Template.m_Columns, in_fWidth);
+  const nsUInt32 uiRowRepetitions = GetAutoRepetitions(m_Template.m_Rows, in_fHeight);
+  if (!m_bPlacementDirty && uiColumnRepetitions == m_uiColumnRepetitions && uiRowRepetitions == m_uiRowRepetitions)
+    return;
+
+  NS_PROFILE_SCOPE("GridLayout::Place");
+  ++m_Stats.m_uiPlacements;
+  m_bPlacementDirty = false;
+  m_bLayoutDirty = true;
+  m_uiColumnRepetitions = uiColumnRepetitions;
+  m_uiRowRepetitions = uiRowRepetitions;
+
+  // Placement runs in flow order: the minor axis is filled first, the major axis grows.
+  const bool bColumnFlow = m_Template.m_bColumnFlow;
+  const GridAxisTemplate& minorAxis = bColumnFlow ? m_Template.m_Rows : m_Template.m_Columns;
+  const GridAxisTemplate& majorAxis = bColumnFlow ? m_Template.m_Columns : m_Template.m_Rows;
+  const nsUInt32 uiExplicitMinor = minorAxis.m_Tracks.GetCount() + (bColumnFlow ? uiRowRepetitions : uiColumnRepetitions) * minorAxis.m_AutoRepeat.GetCount();
+  const nsUInt32 uiExplicitMajor = majorAxis.m_Tracks.GetCount() + (bColumnFlow ? uiColumnRepetitions : uiRowRepetitions) * majorAxis.m_AutoRepeat.GetCount();
+
+  const nsUInt32 uiItems = m_Placements.GetCount();
+  nsDynamicArray<AxisPlacement> minor;
+  nsDynamicArray<AxisPlacement> major;
+  minor.SetCount(uiItems);
+  major.SetCount(uiItems);
+
+  // Lines before the explicit grid add implicit tracks at the start.
+  nsInt32 iFirstMinor = 0;
+  nsInt32 iFirstMajor = 0;
+  for (nsUInt32 i = 0; i < uiItems; ++i)
+  {
+    const GridPlacement& placement = m_Placements[i];
+    minor[i] = bColumnFlow ? ResolveLines(placement.m_RowStart, placement.m_RowEnd, uiExplicitMinor) : ResolveLines(placement.m_ColumnStart, placement.m_ColumnEnd, uiExplicitMinor);
+    major[i] = bColumnFlow ? ResolveLines(placement.m_ColumnStart, placement.m_ColumnEnd, uiExplicitMajor) : ResolveLines(placement.m_RowStart, placement.m_RowEnd, uiExplicitMajor);
+    if (!minor[i].m_bAuto)
+      iFirstMinor = nsMath::Min(iFirstMinor, minor[i].m_iStart);
+    if (!major[i].m_bAuto)
+      iFirstMajor = nsMath::Min(iFirstMajor, major[i].m_iStart);
+  }
+  const nsUInt32 uiLeadingMinor = static_cast<nsUInt32>(-iFirstMinor);
+  const nsUInt32 uiLeadingMajor = static_cast<nsUInt32>(-iFirstMajor);
+
+  nsUInt32 uiMinorCount = uiLeadingMinor + uiExplicitMinor;
+  nsUInt32 uiMajorCount = uiLeadingMajor + uiExplicitMajor;
+  for (nsUInt32 i = 0; i < uiItems; ++i)
+  {
+    minor[i].m_iStart += static_cast<nsInt32>(uiLeadingMinor);
+    major[i].m_iStart += static_cast<nsInt32>(uiLeadingMajor);
+    uiMinorCount = nsMath::Max(uiMinorCount, minor[i].m_bAuto ? minor[i].m_uiSpan : static_cast<nsUInt32>(minor[i].m_iStart) + minor[i].m_uiSpan);
+  }
+
+  Occupancy occupancy;
+  occupancy.Reset(nsMath::Max(uiMinorCount, 1u));
+  auto place = [&](nsUInt32 i, nsUInt32 uiMajor, nsUInt32 uiMinor) {
+    major[i].m_iStart = static_cast<nsInt32>(uiMajor);
+    minor[i].m_iStart = static_cast<nsInt32>(uiMinor);
+    major[i].m_bAuto = false;
+    minor[i].m_bAuto = false;
+    occupancy.Occupy(uiMajor, uiMinor, major[i].m_uiSpan, minor[i].m_uiSpan);
+  };
+
+  // 1. Items with a definite position in both axes.
+  for (nsUInt32 i = 0; i < uiItems; ++i)
+  {
+    if (!major[i].m_bAuto && !minor[i].m_bAuto)
+      place(i, major[i].m_iStart, minor[i].m_iStart);
+  }
+
+  // 2. Items locked to a major line, sparse packing continues after the items placed on the same line before.
+  nsHybridArray<nsUInt32, 16> lineCursors;
+  for (nsUInt32 i = 0; i < uiItems; ++i)
+  {
+    if (major[i].m_bAuto || !minor[i].m_bAuto)
+      continue;
+
+    const nsUInt32 uiMajor = major[i].m_iStart;
+    if (lineCursors.GetCount() <= uiMajor)
+      lineCursors.SetCount(uiMajor + 1, 0);
+
+    nsUInt32 uiMinor = m_Template.m_bDense ? 0 : lineCursors[uiMajor];
+    while (!occupancy.IsFree(uiMajor, uiMinor, major[i].m_uiSpan, minor[i].m_uiSpan))
+      ++uiMinor;
+    place(i, uiMajor, uiMinor);
+    lineCursors[uiMajor] = uiMinor + minor[i].m_uiSpan;
+  }
+
+  // 3. and 4. The minor tracks are known now, the remaining items are placed with the auto-placement cursor.
+  const nsUInt32 uiMinorTracks = occupancy.GetMinorCount();
+  nsUInt32 uiCursorMajor = 0;
+  nsUInt32 uiCursorMinor = 0;
+  for (nsUInt32 i = 0; i < uiItems; ++i)
+  {
+    if (!major[i].m_bAuto)
+      continue;
+
+    const nsUInt32 uiMajorSpan = major[i].m_uiSpan;
+    const nsUInt32 uiMinorSpan = minor[i].m_uiSpan;
+
+    if (!minor[i].m_bAuto)
+    {
+      const nsUInt32 uiMinor = minor[i].m_iStart;
+      if (m_Template.m_bDense)
+        uiCursorMajor = 0;
+      else if (uiMinor < uiCursorMinor)
+        ++uiCursorMajor;
+
+      while (!occupancy.IsFree(uiCursorMajor, uiMinor, uiMajorSpan, uiMinorSpan))
+        ++uiCursorMajor;
+      uiCursorMinor = uiMinor;
+      place(i, uiCursorMajor, uiMinor);
+      continue;
+    }
+
+    if (m_Template.m_bDense)
+      occupancy.GetFirstFree(uiCursorMajor, uiCursorMinor);
+
+    while (true)
+    {
+      if (uiCursorMinor + uiMinorSpan > uiMinorTracks)
+      {
+        ++uiCursorMajor;
+        uiCursorMinor = 0;
+        continue;
+      }
+      if (occupancy.IsFree(uiCursorMajor, uiCursorMinor, uiMajorSpan, uiMinorSpan))
+        break;
+      ++uiCursorMinor;
+    }
+    place(i, uiCursorMajor, uiCursorMinor);
+    uiCursorMinor += uiMinorSpan;
+  }
+
+  uiMajorCount = nsMath::Max(uiMajorCount, occupancy.GetMajorCount());
+  uiMinorCount = nsMath::Max(uiMinorCount, occupancy.GetMinorCount());
+
+  for (nsUInt32 i = 0; i < uiItems; ++i)
+  {
+    GridArea& area = m_Areas[i];
+    const AxisPlacement& columns = bColumnFlow ? major[i] : minor[i];
+    const AxisPlacement& rows = bColumnFlow ? minor[i] : major[i];
+    area.m_uiColumnStart = columns.m_iStart;
+    area.m_uiColumnEnd = columns.m_iStart + columns.m_uiSpan;
+    area.m_uiRowStart = rows.m_iStart;
+    area.m_uiRowEnd = rows.m_iStart + rows.m_uiSpan;
+  }
+
+  InitAxis(m_Template.m_Columns, uiColumnRepetitions, bColumnFlow ? uiLeadingMajor : uiLeadingMinor, bColumnFlow ? uiMajorCount : uiMinorCount, m_Columns);
+  InitAxis(m_Template.m_Rows, uiRowRepetitions, bColumnFlow ? uiLeadingMinor : uiLeadingMajor, bColumnFlow ? uiMinorCount : uiMajorCount, m_Rows);
+
+  // auto-fit: repeated tracks that got an item don't collapse.
+  for (const GridArea& area : m_Areas)
+  {
+    for (nsUInt32 uiColumn = area.m_uiColumnStart; uiColumn < area.m_uiColumnEnd; ++uiColumn)
+      m_Columns[uiColumn].m_bCollapsed = false;
+    for (nsUInt32 uiRow = area.m_uiRowStart; uiRow < area.m_uiRowEnd; ++uiRow)
+      m_Rows[uiRow].m_bCollapsed = false;
+  }
+}
+
+bool GridLayout::NeedsItemWidths(nsUInt32 in_uiItem) const
+{
+  if (m_Contributions[in_uiItem].m_bHasWidths)
+    return false;
+
+  // Items that only span fixed columns don't contribute to their size.
+  const GridArea& area = m_Areas[in_uiItem];
+  for (nsUInt32 uiColumn = area.m_uiColumnStart; uiColumn < area.m_uiColumnEnd; ++uiColumn)
+  {
+    const GridTrack& track = m_Columns[uiColumn];
+    if (!track.m_bCollapsed && (track.m_Size.m_Min.m_Sizing != GridTrackSizing::Fixed || track.m_Size.m_Max.m_Sizing != GridTrackSizing::Fixed))
+      return true;
+  }
+  return false;
+}
+
+void GridLayout::SetItemWidths(nsUInt32 in_uiItem, float in_fMinContent, float in_fMaxContent)
+{
+  ItemContribution& contribution = m_Contributions[in_uiItem];
+  contribution.m_fMinWidth = in_fMinContent;
+  contribution.m_fMaxWidth = nsMath::Max(in_fMinContent, in_fMaxContent);
+  contribution.m_bHasWidths = true;
+}
+
+float GridLayout::GetItemAreaWidth(nsUInt32 in_uiItem) const
+{
+  const GridArea& area = m_Areas[in_uiItem];
+  const GridTrack& last = m_Columns[area.m_uiColumnEnd - 1];
+  return last.m_fOffset + last.m_fBaseSize - m_Columns[area.m_uiColumnStart].m_fOffset;
+}
+
+bool GridLayout::NeedsItemHeight(nsUInt32 in_uiItem) const
+{
+  if (m_Contributions[in_uiItem].m_fHeightForWidth == GetItemAreaWidth(in_uiItem))
+    return false;
+
+  const GridArea& area = m_Areas[in_uiItem];
+  for (nsUInt32 uiRow = area.m_uiRowStart; uiRow < area.m_uiRowEnd; ++uiRow)
+  {
+    const GridTrack& track = m_Rows[uiRow];
+    if (!track.m_bCollapsed && (track.m_Size.m_Min.m_Sizing != GridTrackSizing::Fixed || track.m_Size.m_Max.m_Sizing != GridTrackSizing::Fixed))
+      return true;
+  }
+  return false;
+}
+
+void GridLayout::SetItemHeight(nsUInt32 in_uiItem, float in_fHeight)
+{
+  ItemContribution& contribution = m_Contributions[in_uiItem];
+  contribution.m_fHeightForWidth = GetItemAreaWidth(in_uiItem);
+  contribution.m_fHeight = in_fHeight;
+}
+
+void GridLayout::SizeColumns(float in_fWidth)
+{
+  NS_PROFILE_SCOPE("GridLayout::SizeColumns");
+  m_fColumnGap = GetGap(m_Template.m_Columns, in_fWidth);
+  SizeTracks(m_Columns, true, in_fWidth, m_fColumnGap, std::isnan(in_fWidth) ? SizingMode::MaxContent : SizingMode::Definite);
+  PlaceTracks(m_Columns, m_fColumnGap, in_fWidth, m_Template.m_JustifyContent, m_ContentSize.width);
+  m_fLayoutWidth = in_fWidth;
+}
+
+void GridLayout::SizeRows(float in_fHeight)
+{
+  NS_PROFILE_SCOPE("GridLayout::SizeRows");
+  m_fRowGap = GetGap(m_Template.m_Rows, in_fHeight);
+  SizeTracks(m_Rows, false, in_fHeight, m_fRowGap, std::isnan(in_fHeight) ? SizingMode::MaxContent : SizingMode::Definite);
+  PlaceTracks(m_Rows, m_fRowGap, in_fHeight, m_Template.m_AlignContent, m_ContentSize.height);
+  m_fLayoutHeight = in_fHeight;
+  m_bLayoutDirty = false;
+}
+
+float GridLayout::GetMinContentWidth()
+{
+  m_ScratchTracks = m_Columns;
+  const float fGap = GetGap(m_Template.m_Columns, s_fIndefinite);
+  SizeTracks(m_ScratchTracks, true, s_fIndefinite, fGap, SizingMode::MinContent);
+  return GetSpannedSize(m_ScratchTracks, 0, m_ScratchTracks.GetCount(), fGap, false);
+}
+
+void GridLayout::SizeTracks(nsDynamicArray<GridTrack>& inout_tracks, bool in_bColumns, float in_fAvailable, float in_fGap, SizingMode in_mode)
+{
+  ++m_Stats.m_uiTrackSizings;
+  const nsUInt32 uiTracks = inout_tracks.GetCount();
+
+  // 12.4 Initialize the track sizes.
+  for (GridTrack& track : inout_tracks)
+  {
+    const float fMin = track.m_bCollapsed ? 0.0f : ResolveBreadth(track.m_Size.m_Min, in_fAvailable);
+    const float fMax = track.m_bCollapsed ? 0.0f : ResolveBreadth(track.m_Size.m_Max, in_fAvailable);
+    track.m_fBaseSize = nsMath::Max(fMin, 0.0f);
+    track.m_fGrowthLimit = fMax >= 0.0f ? nsMath::Max(fMax, track.m_fBaseSize) : s_fInfinity;
+    track.m_fPlannedIncrease = 0.0f;
+    track.m_bInfinitelyGrowable = false;
+  }
+
+  auto getStart = [&](nsUInt32 uiItem) { return in_bColumns ? m_Areas[uiItem].m_uiColumnStart : m_Areas[uiItem].m_uiRowStart; };
+  auto getEnd = [&](nsUInt32 uiItem) { return in_bColumns ? m_Areas[uiItem].m_uiColumnEnd : m_Areas[uiItem].m_uiRowEnd; };
+  auto getMinContribution = [&](nsUInt32 uiItem) { return in_bColumns ? m_Contributions[uiItem].m_fMinWidth : m_Contributions[uiItem].m_fHeight; };
+  auto getMaxContribution = [&](nsUInt32 uiItem) { return in_bColumns ? m_Contributions[uiItem].m_fMaxWidth : m_Contributions[uiItem].m_fHeight; };
+  auto crossesFlexTrack = [&](nsUInt32 uiItem) {
+    for (nsUInt32 i = getStart(uiItem); i < getEnd(uiItem); ++i)
+    {
+      if (GetMaxSizing(inout_tracks[i], in_fAvailable) == GridTrackSizing::Flex)
+        return true;
+    }
+    return false;
+  };
+
+  // Only items that span an intrinsic or flexible track take part, ordered by span: first the ones that don't cross a
+  // flexible track, then the ones that do.
+  m_SortedItems.Clear();
+  nsDynamicArray<nsUInt32> sortKeys;
+  for (nsUInt32 uiItem = 0; uiItem < m_Placements.GetCount(); ++uiItem)
+  {
+    bool bIntrinsic = false;
+    for (nsUInt32 i = getStart(uiItem); i < getEnd(uiItem) && !bIntrinsic; ++i)
+    {
+      const GridTrack& track = inout_tracks[i];
+      bIntrinsic = IsIntrinsic(GetMinSizing(track, in_fAvailable)) || GetMaxSizing(track, in_fAvailable) >= GridTrackSizing::Flex;
+    }
+    if (bIntrinsic)
+      m_SortedItems.PushBack(uiItem);
+  }
+  sortKeys.SetCountUninitialized(m_Placements.GetCount());
+  for (nsUInt32 uiItem : m_SortedItems)
+    sortKeys[uiItem] = (crossesFlexTrack(uiItem) ? 0x80000000u : 0u) | (getEnd(uiItem) - getStart(uiItem));
+  m_SortedItems.Sort([&](nsUInt32 a, nsUInt32 b) { return sortKeys[a] != sortKeys[b] ? sortKeys[a] < sortKeys[b] : a < b; });
+
+  // 12.5 Resolve intrinsic track sizes. Step 2: items that span a single track that isn't flexible.
+  nsHybridArray<float, 64> itemLimits;
+  itemLimits.SetCount(uiTracks, -1.0f);
+  nsUInt32 uiSorted = 0;
+  for (; uiSorted < m_SortedItems.GetCount() && sortKeys[m_SortedItems[uiSorted]] == 1; ++uiSorted)
+  {
+    const nsUInt32 uiItem = m_SortedItems[uiSorted];
+    GridTrack& track = inout_tracks[getStart(uiItem)];
+    const float fMinContribution = getMinContribution(uiItem);
+    const float fMaxContribution = getMaxContribution(uiItem);
+
+    switch (GetMinSizing(track, in_fAvailable))
+    {
+      case GridTrackSizing::Auto:
+        // Under a max-content constraint auto minimums take the max-content contribution.
+        track.m_fBaseSize = nsMath::Max(track.m_fBaseSize, in_mode == SizingMode::MaxContent ? fMaxContribution : fMinContribution);
+        break;
+      case GridTrackSizing::MinContent:
+        track.m_fBaseSize = nsMath::Max(track.m_fBaseSize, fMinContribution);
+        break;
+      case GridTrackSizing::MaxContent:
+        track.m_fBaseSize = nsMath::Max(track.m_fBaseSize, fMaxContribution);
+        break;
+      default:
+        break;
+    }
+
+    float& fItemLimit = itemLimits[getStart(uiItem)];
+    switch (GetMaxSizing(track, in_fAvailable))
+    {
+      case GridTrackSizing::MinContent:
+        fItemLimit = nsMath::Max(fItemLimit, fMinContribution);
+        break;
+      case GridTrackSizing::Auto:
+      case GridTrackSizing::MaxContent:
+        fItemLimit = nsMath::Max(fItemLimit, fMaxContribution);
+        break;
+      case GridTrackSizing::FitContent:
+        fItemLimit = nsMath::Max(fItemLimit, nsMath::Min(fMaxContribution, nsMath::Max(fMinContribution, track.m_Size.m_Max.m_fValue)));
+        break;
+      default:
+        break;
+    }
+  }
+  for (nsUInt32 i = 0; i < uiTracks; ++i)
+  {
+    GridTrack& track = inout_tracks[i];
+    if (itemLimits[i] >= 0.0f && track.m_fGrowthLimit == s_fInfinity)
+      track.m_fGrowthLimit = itemLimits[i];
+    track.m_fGrowthLimit = nsMath::Max(track.m_fGrowthLimit, track.m_fBaseSize);
+  }
+
+  // 12.5.1 Distribute the extra space of the contributions of a group of items over the matching tracks they span.
+  nsHybridArray<nsUInt32, 16> affected;
+  nsHybridArray<float, 16> sizes;
+  nsHybridArray<float, 16> caps;
+  nsHybridArray<float, 16> weights;
+  nsHybridArray<float, 16> increases;
+  auto distribute = [&](nsUInt32 uiFirst, nsUInt32 uiEnd, bool bMaxContribution, bool bGrowthLimits, bool bFlexTracks, auto isAffected) {
+    for (nsUInt32 uiSortedItem = uiFirst; uiSortedItem < uiEnd; ++uiSortedItem)
+    {
+      const nsUInt32 uiItem = m_SortedItems[uiSortedItem];
+      const nsUInt32 uiStart = getStart(uiItem);
+      const nsUInt32 uiItemEnd = getEnd(uiItem);
+      const float fContribution = bMaxContribution ? getMaxContribution(uiItem) : getMinContribution(uiItem);
+      const float fExtra = fContribution - GetSpannedSize(inout_tracks, uiStart, uiItemEnd, in_fGap, bGrowthLimits);
+      if (fExtra <= 0.0f)
+        continue;
+
+      affected.Clear();
+      sizes.Clear();
+      caps.Clear();
+      weights.Clear();
+      increases.Clear();
+      for (nsUInt32 i = uiStart; i < uiItemEnd; ++i)
+      {
+        const GridTrack& track = inout_tracks[i];
+        if (track.m_bCollapsed || !isAffected(track))
+          continue;
+
+        const bool bInfiniteLimit = track.m_fGrowthLimit == s_fInfinity;
+        affected.PushBack(i);
+        sizes.PushBack(bGrowthLimits && !bInfiniteLimit ? track.m_fGrowthLimit : track.m_fBaseSize);
+        if (bGrowthLimits)
+          caps.PushBack(track.m_bInfinitelyGrowable || bInfiniteLimit ? s_fInfinity : track.m_fGrowthLimit);
+        else
+          caps.PushBack(track.m_fGrowthLimit);
+        if (GetMaxSizing(track, in_fAvailable) == GridTrackSizing::FitContent)
+          caps.PeekBack() = nsMath::Min(caps.PeekBack(), nsMath::Max(track.m_Size.m_Max.m_fValue, sizes.PeekBack()));
+        weights.PushBack(bFlexTracks ? nsMath::Max(track.m_Size.m_Max.m_fValue, 0.0001f) : 1.0f);
+        increases.PushBack(0.0f);
+      }
+      if (affected.IsEmpty())
+        continue;
+
+      const float fLeft = GrowTracks(affected, sizes, caps, weights, increases, fExtra);
+      if (fLeft > 0.0f)
+      {
+        // Beyond the limits: tracks with an intrinsic maximum get the rest, all affected tracks if there are none.
+        nsUInt32 uiBeyond = 0;
+        for (nsUInt32 i : affected)
+        {
+          const GridTrackSizing maxSizing = GetMaxSizing(inout_tracks[i], in_fAvailable);
+          uiBeyond += maxSizing == GridTrackSizing::Auto || maxSizing == GridTrackSizing::MinContent || maxSizing == GridTrackSizing::MaxContent ? 1 : 0;
+        }
+        for (nsUInt32 a = 0; a < affected.GetCount(); ++a)
+        {
+          const GridTrackSizing maxSizing = GetMaxSizing(inout_tracks[affected[a]], in_fAvailable);
+          const bool bIntrinsicMax = maxSizing == GridTrackSizing::Auto || maxSizing == GridTrackSizing::MinContent || maxSizing == GridTrackSizing::MaxContent;
+          if (uiBeyond == 0 || bIntrinsicMax)
+            increases[a] += fLeft / static_cast<float>(uiBeyond > 0 ? uiBeyond : affected.GetCount());
+        }
+      }
+
+      for (nsUInt32 a = 0; a < affected.GetCount(); ++a)
+      {
+        GridTrack& track = inout_tracks[affected[a]];
+        track.m_fPlannedIncrease = nsMath::Max(track.m_fPlannedIncrease, increases[a]);
+      }
+    }
+
+    for (GridTrack& track : inout_tracks)
+    {
+      if (track.m_fPlannedIncrease <= 0.0f)
+        continue;
+
+      if (!bGrowthLimits)
+      {
+        track.m_fBaseSize += track.m_fPlannedIncrease;
+      }
+      else if (track.m_fGrowthLimit == s_fInfinity)
+      {
+        track.m_fGrowthLimit = track.m_fBaseSize + track.m_fPlannedIncrease;
+        track.m_bInfinitelyGrowable = true;
+      }
+      else
+      {
+        track.m_fGrowthLimit += track.m_fPlannedIncrease;
+      }
+      track.m_fPlannedIncrease = 0.0f;
+    }
+
+    for (GridTrack& track : inout_tracks)
+      track.m_fGrowthLimit = nsMath::Max(track.m_fGrowthLimit, track.m_fBaseSize);
+  };
+
+  // Step 3: items spanning more tracks, none of them flexible, one group per span.
+  while (uiSorted < m_SortedItems.GetCount() && (sortKeys[m_SortedItems[uiSorted]] & 0x80000000u) == 0)
+  {
+    const nsUInt32 uiKey = sortKeys[m_SortedItems[uiSorted]];
+    nsUInt32 uiGroupEnd = uiSorted;
+    while (uiGroupEnd < m_SortedItems.GetCount() && sortKeys[m_SortedItems[uiGroupEnd]] == uiKey)
+      ++uiGroupEnd;
+
+    const bool bMaxContentMode = in_mode == SizingMode::MaxContent;
+    distribute(uiSorted, uiGroupEnd, bMaxContentMode, false, false, [&](const GridTrack& track) { return IsIntrinsic(GetMinSizing(track, in_fAvailable)); });
+    distribute(uiSorted, uiGroupEnd, true, false, false, [&](const GridTrack& track) { return GetMinSizing(track, in_fAvailable) == GridTrackSizing::MaxContent; });
+    distribute(uiSorted, uiGroupEnd, false, true, false, [&](const GridTrack& track) { return IsIntrinsic(GetMaxSizing(track, in_fAvailable)); });
+    distribute(uiSorted, uiGroupEnd, true, true, false, [&](const GridTrack& track) {
+      const GridTrackSizing maxSizing = GetMaxSizing(track, in_fAvailable);
+      return maxSizing == GridTrackSizing::Auto || maxSizing == GridTrackSizing::MaxContent || maxSizing == GridTrackSizing::FitContent;
+    });
+
+    // Growth limits are only infinitely growable within a step.
+    for (GridTrack& track : inout_tracks)
+      track.m_bInfinitelyGrowable = false;
+    uiSorted = uiGroupEnd;
+  }
+
+  // Step 4: items crossing flexible tracks grow the flexible tracks, in proportion to their flex factors.
+  const nsUInt32 uiFirstFlexItem = uiSorted;
+  if (uiSorted < m_SortedItems.GetCount())
+  {
+    distribute(uiSorted, m_SortedItems.GetCount(), false, false, true, [&](const GridTrack& track) { return GetMaxSizing(track, in_fAvailable) == GridTrackSizing::Flex; });
+  }
+
+  // Step 5: growth limits that are still infinite take the base size.
+  for (GridTrack& track : inout_tracks)
+  {
+    if (track.m_fGrowthLimit == s_fInfinity)
+      track.m_fGrowthLimit = track.m_fBaseSize;
+  }
+
+  // 12.6 Maximize tracks.
+  if (in_mode == SizingMode::MaxContent)
+  {
+    for (GridTrack& track : inout_tracks)
+      track.m_fBaseSize = track.m_fGrowthLimit;
+  }
+  else if (in_mode == SizingMode::Definite)
+  {
+    const float fFree = in_fAvailable - GetSpannedSize(inout_tracks, 0, uiTracks, in_fGap, false);
+    if (fFree > 0.0f)
+    {
+      affected.Clear();
+      sizes.Clear();
+      caps.Clear();
+      weights.Clear();
+      increases.Clear();
+      for (nsUInt32 i = 0; i < uiTracks; ++i)
+      {
+        affected.PushBack(i);
+        sizes.PushBack(inout_tracks[i].m_fBaseSize);
+        caps.PushBack(inout_tracks[i].m_fGrowthLimit);
+        weights.PushBack(1.0f);
+        increases.PushBack(0.0f);
+      }
+      GrowTracks(affected, sizes, caps, weights, increases, fFree);
+      for (nsUInt32 i = 0; i < uiTracks; ++i)
+        inout_tracks[i].m_fBaseSize += increases[i];
+    }
+  }
+
+  // 12.7 Expand flexible tracks. Under a min-content constraint there is no free space for them.
+  bool bHasFlexTracks = false;
+  for (const GridTrack& track : inout_tracks)
+    bHasFlexTracks |= GetMaxSizing(track, in_fAvailable) == GridTrackSizing::Flex;
+
+  if (bHasFlexTracks && in_mode != SizingMode::MinContent)
+  {
+    float fFrSize = 0.0f;
+    if (in_mode == SizingMode::Definite)
+    {
+      fFrSize = FindFrSize(inout_tracks, 0, uiTracks, in_fAvailable, in_fGap, in_fAvailable);
+    }
+    else
+    {
+      for (const GridTrack& track : inout_tracks)
+      {
+        if (GetMaxSizing(track, in_fAvailable) == GridTrackSizing::Flex)
+          fFrSize = nsMath::Max(fFrSize, track.m_Size.m_Max.m_fValue > 1.0f ? track.m_fBaseSize / track.m_Size.m_Max.m_fValue : track.m_fBaseSize);
+      }
+      for (nsUInt32 s = uiFirstFlexItem; s < m_SortedItems.GetCount(); ++s)
+      {
+        const nsUInt32 uiItem = m_SortedItems[s];
+        fFrSize = nsMath::Max(fFrSize, FindFrSize(inout_tracks, getStart(uiItem), getEnd(uiItem), getMaxContribution(uiItem), in_fGap, in_fAvailable));
+      }
+    }
+
+    for (GridTrack& track : inout_tracks)
+    {
+      if (GetMaxSizing(track, in_fAvailable) == GridTrackSizing::Flex)
+        track.m_fBaseSize = nsMath::Max(track.m_fBaseSize, fFrSize * track.m_Size.m_Max.m_fValue);
+    }
+  }
+
+  // 12.8 Stretch auto tracks.
+  const GridContentAlign align = in_bColumns ? m_Template.m_JustifyContent : m_Template.m_AlignContent;
+  if (in_mode == SizingMode::Definite && align == GridContentAlign::Stretch)
+  {
+    const float fFree = in_fAvailable - GetSpannedSize(inout_tracks, 0, uiTracks, in_fGap, false);
+    nsUInt32 uiAutoTracks = 0;
+    for (const GridTrack& track : inout_tracks)
+      uiAutoTracks += GetMaxSizing(track, in_fAvailable) == GridTrackSizing::Auto ? 1 : 0;
+
+    if (fFree > 0.0f && uiAutoTracks > 0)
+    {
+      for (GridTrack& track : inout_tracks)
+      {
+        if (GetMaxSizing(track, in_fAvailable) == GridTrackSizing::Auto)
+          track.m_fBaseSize += fFree / static_cast<float>(uiAutoTracks);
+      }
+    }
+  }
+}
+
+void GridLayout::PlaceTracks(nsDynamicArray<GridTrack>& inout_tracks, float in_fGap, float in_fAvailable, GridContentAlign in_align, float& out_fSize) const
+{
+  out_fSize = GetSpannedSize(inout_tracks, 0, inout_tracks.GetCount(), in_fGap, false);
+
+  nsUInt32 uiTracks = 0;
+  for (const GridTrack& track : inout_tracks)
+    uiTracks += track.m_bCollapsed ? 0 : 1;
+
+  // 10.5 Aligning the grid: free space is distributed before, between and after the tracks.
+  const float fFree = std::isnan(in_fAvailable) ? 0.0f : in_fAvailable - out_fSize;
+  float fOffset = 0.0f;
+  float fBetween = 0.0f;
+  switch (in_align)
+  {
+    case GridContentAlign::Center:
+      fOffset = fFree * 0.5f;
+      break;
+    case GridContentAlign::End:
+      fOffset = fFree;
+      break;
+    case GridContentAlign::SpaceBetween:
+      fBetween = fFree > 0.0f && uiTracks > 1 ? fFree / static_cast<float>(uiTracks - 1) : 0.0f;
+      break;
+    case GridContentAlign::SpaceAround:
+      fBetween = fFree > 0.0f && uiTracks > 0 ? fFree / static_cast<float>(uiTracks) : 0.0f;
+      fOffset = fBetween * 0.5f;
+      break;
+    case GridContentAlign::SpaceEvenly:
+      fBetween = fFree > 0.0f ? fFree / static_cast<float>(uiTracks + 1) : 0.0f;
+      fOffset = fBetween;
+      break;
+    default:
+      break;
+  }
+
+  bool bFirst = true;
+  for (GridTrack& track : inout_tracks)
+  {
+    if (!track.m_bCollapsed)
+    {
+      if (!bFirst)
+        fOffset += in_fGap + fBetween;
+      bFirst = false;
+    }
+    track.m_fOffset = fOffset;
+    fOffset += track.m_fBaseSize;
+  }
+}
+
+nsRectFloat GridLayout::GetItemArea(nsUInt32 in_uiItem) const
+{
+  const GridArea& area = m_Areas[in_uiItem];
+  const GridTrack& lastRow = m_Rows[area.m_uiRowEnd - 1];
+  const float fX = m_Columns[area.m_uiColumnStart].m_fOffset;
+  const float fY = m_Rows[area.m_uiRowStart].m_fOffset;
+  return nsRectFloat(fX, fY, GetItemAreaWidth(in_uiItem), lastRow.m_fOffset + lastRow.m_fBaseSize - fY);
+}
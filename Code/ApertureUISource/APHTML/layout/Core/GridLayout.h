@@ -0,0 +1,315 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <APHTML/layout/Core/LayoutDefinitions.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HybridArray.h>
+#include <Foundation/Math/Rect.h>
+
+namespace aperture::layout
+{
+  enum class GridTrackSizing : nsUInt8
+  {
+    Fixed,      ///< px
+    Percent,    ///< Of the content box of the container, auto if it is indefinite.
+    Flex,       ///< fr, only valid as a maximum.
+    Auto,
+    MinContent,
+    MaxContent,
+    FitContent, ///< fit-content(px), only valid as a maximum.
+  };
+
+  struct GridTrackBreadth
+  {
+    NS_DECLARE_POD_TYPE();
+
+    GridTrackSizing m_Sizing;
+    /// @brief px, percent, fr or the limit of fit-content().
+    float m_fValue;
+
+    bool IsIntrinsic() const { return m_Sizing == GridTrackSizing::Auto || m_Sizing == GridTrackSizing::MinContent || m_Sizing == GridTrackSizing::MaxContent || m_Sizing == GridTrackSizing::FitContent; }
+    bool operator==(const GridTrackBreadth& other) const { return m_Sizing == other.m_Sizing && m_fValue == other.m_fValue; }
+  };
+
+  /// @brief minmax(min, max). A single breadth is minmax(breadth, breadth), except for "1fr" (minmax(auto, 1fr)) and fit-content() (minmax(auto, fit-content())).
+  struct GridTrackSize
+  {
+    NS_DECLARE_POD_TYPE();
+
+    GridTrackBreadth m_Min;
+    GridTrackBreadth m_Max;
+
+    static GridTrackSize Make(GridTrackSizing in_sizing, float in_fValue = 0.0f);
+    static GridTrackSize MakeMinMax(GridTrackBreadth in_min, GridTrackBreadth in_max) { return {in_min, in_max}; }
+
+    bool operator==(const GridTrackSize& other) const { return m_Min == other.m_Min && m_Max == other.m_Max; }
+  };
+
+  /// @brief The tracks of one axis: grid-template-columns/rows, grid-auto-columns/rows and the gap.
+  struct GridAxisTemplate
+  {
+    /// @brief The explicit tracks, without the tracks of an automatic repetition.
+    nsHybridArray<GridTrackSize, 8> m_Tracks;
+    /// @brief The tracks of repeat(auto-fill | auto-fit, ...), inserted before m_Tracks[m_uiAutoRepeatIndex]. Empty without one.
+    nsHybridArray<GridTrackSize, 2> m_AutoRepeat;
+    nsUInt32 m_uiAutoRepeatIndex = 0;
+    /// @brief auto-fit: repeated tracks without items collapse.
+    bool m_bAutoFit = false;
+    /// @brief The sizes of implicit tracks, repeated as needed.
+    nsHybridArray<GridTrackSize, 2> m_ImplicitTracks;
+    float m_fGap = 0.0f;
+    bool m_bGapPercent = false;
+
+    bool operator==(const GridAxisTemplate& other) const;
+  };
+
+  /// @brief Distribution of the free space of an axis, justify-content and align-content.
+  enum class GridContentAlign : nsUInt8
+  {
+    Start,
+    Center,
+    End,
+    SpaceBetween,
+    SpaceAround,
+    SpaceEvenly,
+    /// @brief Auto sized tracks are stretched (normal and stretch).
+    Stretch,
+  };
+
+  struct GridTemplate
+  {
+    GridAxisTemplate m_Columns;
+    GridAxisTemplate m_Rows;
+    /// @brief grid-auto-flow: column.
+    bool m_bColumnFlow = false;
+    bool m_bDense = false;
+    GridContentAlign m_JustifyContent = GridContentAlign::Stretch;
+    GridContentAlign m_AlignContent = GridContentAlign::Stretch;
+
+    bool operator==(const GridTemplate& other) const;
+  };
+
+  /// @brief A grid-*-start or grid-*-end value.
+  struct GridLine
+  {
+    NS_DECLARE_POD_TYPE();
+
+    /// @brief 1-based line, negative lines count from the end of the explicit grid. 0 is auto or a span.
+    nsInt16 m_iLine;
+    /// @brief "span n", 0 otherwise.
+    nsUInt16 m_uiSpan;
+
+    bool IsDefinite() const { return m_iLine != 0; }
+    bool operator==(const GridLine& other) const { return m_iLine == other.m_iLine && m_uiSpan == other.m_uiSpan; }
+  };
+
+  struct GridPlacement
+  {
+    NS_DECLARE_POD_TYPE();
+
+    GridLine m_ColumnStart;
+    GridLine m_ColumnEnd;
+    GridLine m_RowStart;
+    GridLine m_RowEnd;
+
+    bool operator==(const GridPlacement& other) const
+    {
+      return m_ColumnStart == other.m_ColumnStart && m_ColumnEnd == other.m_ColumnEnd && m_RowStart == other.m_RowStart && m_RowEnd == other.m_RowEnd;
+    }
+  };
+
+  /// @brief The resolved area of an item, 0-based track indices of the implicit grid, end exclusive.
+  struct GridArea
+  {
+    NS_DECLARE_POD_TYPE();
+
+    nsUInt32 m_uiColumnStart;
+    nsUInt32 m_uiColumnEnd;
+    nsUInt32 m_uiRowStart;
+    nsUInt32 m_uiRowEnd;
+  };
+
+  struct GridTrack
+  {
+    NS_DECLARE_POD_TYPE();
+
+    GridTrackSize m_Size;
+    /// @brief Relative to the content box of the container.
+    float m_fOffset;
+    float m_fBaseSize;
+    float m_fGrowthLimit;
+    /// @brief Increase of the current step of the intrinsic sizing, see CSS Grid 1 12.5.1.
+    float m_fPlannedIncrease;
+    bool m_bInfinitelyGrowable;
+    /// @brief Empty track of a auto-fit repetition.
+    bool m_bCollapsed;
+  };
+
+  /*
+   * @brief The grid formatting context of one grid container (CSS Grid Layout 1): item placement and track sizing.
+   *
+   * Items are placed as in 8.5, including dense packing and the implicit tracks before and after the explicit grid. The
+   * tracks are sized with the algorithm of 12: intrinsic sizes of items spanning one track, then of items spanning more
+   * tracks in increasing span order, maximizing, fr expansion and stretching of auto tracks, for minmax(), auto,
+   * min-content, max-content, fit-content() and fr tracks. Named lines and areas are not supported, neither is baseline
+   * alignment.
+   *
+   * The container only knows the items by index. The contributions of the items are set by the owner in between the
+   * steps of a layout, since the heights of the items depend on the widths of their columns:
+   *
+   *   if (grid.NeedsLayout(w, h)) {
+   *     grid.Place(w, h);
+   *     SetItemWidths() for every item with NeedsItemWidths();
+   *     grid.SizeColumns(w);
+   *     SetItemHeight() for every item with NeedsItemHeight(), laid out for GetItemAreaWidth();
+   *     grid.SizeRows(h); }
+   *
+   * Everything is kept on flat arrays and cached: the placement until the template or the placement of an item changes,
+   * the contributions of an item until it is marked dirty (its height until its area gets another width as well), and
+   * the tracks until anything changes or the grid is laid out for another available size. Laying out an unchanged grid
+   * again does nothing.
+   *
+   * Available sizes are the content box of the container, NaN (YGUndefined) for an indefinite size. All sizes of items are
+   * margin box sizes.
+   */
+  class NS_APERTURE_DLL GridLayout
+  {
+  public:
+    struct Stats
+    {
+      nsUInt32 m_uiPlacements = 0;
+      /// @brief Each axis counts once.
+      nsUInt32 m_uiTrackSizings = 0;
+      nsUInt32 m_uiCachedLayouts = 0;
+    };
+
+    /// @brief Returns true if the template changed.
+    bool SetTemplate(const GridTemplate& in_template);
+    const GridTemplate& GetTemplate() const { return m_Template; }
+
+    /// @brief The placement of every item, in order-modified document order. Returns true if anything changed.
+    bool SetItems(nsArrayPtr<const GridPlacement> in_placements);
+    nsUInt32 GetItemCount() const { return m_Placements.GetCount(); }
+
+    /// @brief The content of the item changed, its contributions have to be set again.
+    void MarkItemDirty(nsUInt32 in_uiItem);
+
+    /// @brief Returns false if the tracks and areas of the last layout are valid for the available size.
+    bool NeedsLayout(float in_fWidth, float in_fHeight);
+
+    /// @brief Resolves the number of automatic repetitions for the available size and places the items.
+    void Place(float in_fWidth, float in_fHeight);
+
+    bool NeedsItemWidths(nsUInt32 in_uiItem) const;
+    void SetItemWidths(nsUInt32 in_uiItem, float in_fMinContent, float in_fMaxContent);
+
+    void SizeColumns(float in_fWidth);
+
+    /// @brief The width of the columns the item spans, including the gaps between them.
+    float GetItemAreaWidth(nsUInt32 in_uiItem) const;
+    bool NeedsItemHeight(nsUInt32 in_uiItem) const;
+    void SetItemHeight(nsUInt32 in_uiItem, float in_fHeight);
+
+    void SizeRows(float in_fHeight);
+
+    /// @brief The min-content width of the grid, the sum of its columns sized under a min-content constraint.
+    /// Needs Place() and the widths of the items, leaves the tracks of the last layout alone.
+    float GetMinContentWidth();
+
+    /// @brief The size of all tracks and gaps, the content size of the container.
+    Size GetContentSize() const { return m_ContentSize; }
+    /// @brief The available size of the last layout.
+    Size GetAvailableSize() const { return {m_fLayoutWidth, m_fLayoutHeight}; }
+
+    nsArrayPtr<const GridTrack> GetColumns() const { return m_Columns; }
+    nsArrayPtr<const GridTrack> GetRows() const { return m_Rows; }
+    const GridArea& GetItemLines(nsUInt32 in_uiItem) const { return m_Areas[in_uiItem]; }
+    /// @brief The grid area of the item, relative to the content box of the container.
+    nsRectFloat GetItemArea(nsUInt32 in_uiItem) const;
+
+    const Stats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+  private:
+    enum class SizingMode : nsUInt8
+    {
+      Definite,
+      MinContent,
+      MaxContent,
+    };
+
+    struct ItemContribution
+    {
+      NS_DECLARE_POD_TYPE();
+
+      float m_fMinWidth;
+      float m_fMaxWidth;
+      /// @brief The width of the area the height was measured for, negative if it wasn't.
+      float m_fHeightForWidth;
+      float m_fHeight;
+      bool m_bHasWidths;
+    };
+
+    void InitAxis(const GridAxisTemplate& in_axis, nsUInt32 in_uiRepetitions, nsUInt32 in_uiLeadingImplicit, nsUInt32 in_uiCount, nsDynamicArray<GridTrack>& out_tracks) const;
+    nsUInt32 GetAutoRepetitions(const GridAxisTemplate& in_axis, float in_fAvailable) const;
+    void SizeTracks(nsDynamicArray<GridTrack>& inout_tracks, bool in_bColumns, float in_fAvailable, float in_fGap, SizingMode in_mode);
+    void PlaceTracks(nsDynamicArray<GridTrack>& inout_tracks, float in_fGap, float in_fAvailable, GridContentAlign in_align, float& out_fSize) const;
+    float GetGap(const GridAxisTemplate& in_axis, float in_fAvailable) const;
+
+    GridTemplate m_Template;
+    nsDynamicArray<GridPlacement> m_Placements;
+    nsDynamicArray<GridArea> m_Areas;
+    nsDynamicArray<ItemContribution> m_Contributions;
+
+    nsDynamicArray<GridTrack> m_Columns;
+    nsDynamicArray<GridTrack> m_Rows;
+    nsDynamicArray<GridTrack> m_ScratchTracks;
+    /// @brief Items by span, reused by every sizing.
+    nsDynamicArray<nsUInt32> m_SortedItems;
+    Size m_ContentSize;
+
+    nsUInt32 m_uiColumnRepetitions = 0;
+    nsUInt32 m_uiRowRepetitions = 0;
+    float m_fLayoutWidth = 0.0f;
+    float m_fLayoutHeight = 0.0f;
+    float m_fColumnGap = 0.0f;
+    float m_fRowGap = 0.0f;
+    bool m_bPlacementDirty = true;
+    bool m_bLayoutDirty = true;
+    Stats m_Stats;
+  };
+} // namespace aperture::layout
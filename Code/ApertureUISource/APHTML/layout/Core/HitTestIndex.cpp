@@ -0,0 +1,561 @@
+#include <APHTML/animation/AnimationValue.h>
+#include <APHTML/css/Style/ComputedStyle.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/HitTestIndex.h>
+#include <Foundation/Profiling/Profiling.h>
+
+using namespace aperture;
+using namespace aperture::layout;
+using css::ComputedStyle;
+
+namespace
+{
+  /// Boxes covering more cells than this are stored in the large entry list instead of the grid.
+  constexpr nsUInt64 MaxCellsPerEntry = 256;
+
+  struct HitTestKeywords
+  {
+    core::Atom m_Static = core::MakeAtom("static");
+    core::Atom m_Visible = core::MakeAtom("visible");
+    core::Atom m_Hidden = core::MakeAtom("hidden");
+    core::Atom m_None = core::MakeAtom("none");
+  };
+
+  const HitTestKeywords& GetKeywords()
+  {
+    static const HitTestKeywords s_Keywords;
+    return s_Keywords;
+  }
+
+  nsUInt16 BiasZIndex(float in_fZIndex)
+  {
+    return static_cast<nsUInt16>(nsMath::Clamp(static_cast<nsInt32>(nsMath::Floor(in_fZIndex)), -32768, 32767) + 32768);
+  }
+
+  nsRectFloat IntersectClip(const nsRectFloat& in_clip, const nsRectFloat& in_rect)
+  {
+    return in_clip.IsValid() ? nsRectFloat::MakeIntersection(in_clip, in_rect) : in_rect;
+  }
+
+  nsVec2 TransformPoint(const nsMat3& in_transform, nsVec2 in_vPoint)
+  {
+    const nsVec3 vResult = in_transform * nsVec3(in_vPoint.x, in_vPoint.y, 1.0f);
+    return nsVec2(vResult.x, vResult.y);
+  }
+
+  /// The screen bounds of a transformed rect are the AABB of its transformed corners.
+  nsRectFloat TransformBounds(const nsMat3& in_transform, const nsRectFloat& in_rect)
+  {
+    const nsVec2 vCorners[4] = {
+      TransformPoint(in_transform, in_rect.GetTopLeft()),
+      TransformPoint(in_transform, in_rect.GetTopRight()),
+      TransformPoint(in_transform, in_rect.GetBottomLeft()),
+      TransformPoint(in_transform, in_rect.GetBottomRight()),
+    };
+    nsVec2 vMin = vCorners[0];
+    nsVec2 vMax = vCorners[0];
+    for (const nsVec2& vCorner : vCorners)
+    {
+      vMin = vMin.CompMin(vCorner);
+      vMax = vMax.CompMax(vCorner);
+    }
+    return nsRectFloat(vMin.x, vMin.y, vMax.x - vMin.x, vMax.y - vMin.y);
+  }
+
+  float ResolveOrigin(const css::CSSValue& in_value, float in_fSize)
+  {
+    if (!in_value.IsNumeric())
+      return in_fSize * 0.5f;
+    return in_value.m_Unit == core::Unit::PERCENT ? in_fSize * in_value.m_fNumber * 0.01f : in_value.m_fNumber;
+  }
+
+  /// The transform of the element around its transform-origin, in the space of its parent. False if it has none.
+  bool GetElementTransform(const ComputedStyle& in_style, const nsRectFloat& in_rect, nsMat3& out_transform)
+  {
+    if (in_style.Get(PropertyId::Transform).m_Unit != core::Unit::STRING)
+      return false;
+
+    animation::TransformValue transform;
+    if (animation::TransformValue::Parse(in_style.GetString(PropertyId::Transform), transform).Failed() || transform.IsIdentity())
+      return false;
+
+    float m[6];
+    transform.GetMatrix(m);
+
+    // translate(origin) * matrix * translate(-origin)
+    const float fOriginX = in_rect.x + ResolveOrigin(in_style.Get(PropertyId::TransformOriginX), in_rect.width);
+    const float fOriginY = in_rect.y + ResolveOrigin(in_style.Get(PropertyId::TransformOriginY), in_rect.height);
+    const float fTranslateX = m[4] + fOriginX - (m[0] * fOriginX + m[2] * fOriginY);
+    const float fTranslateY = m[5] + fOriginY - (m[1] * fOriginX + m[3] * fOriginY);
+    out_transform = nsMat3::MakeFromValues(m[0], m[2], fTranslateX, m[1], m[3], fTranslateY, 0.0f, 0.0f, 1.0f);
+    return true;
+  }
+} // namespace
+
+HitTestIndex::HitTestIndex(float in_fCellSize)
+  : m_fCellSize(nsMath::Max(in_fCellSize, 1.0f))
+  , m_fInvCellSize(1.0f / nsMath::Max(in_fCellSize, 1.0f))
+{
+}
+
+nsUInt64 HitTestIndex::MakePaintOrderKey(nsUInt16 in_uiStackingContextOrder, float in_fZIndex, nsUInt32 in_uiTreeOrder)
+{
+  // Negative z-indices paint below the z-index 0 layer, so the value is biased into an unsigned range.
+  const nsInt32 iZIndex = nsMath::Clamp(static_cast<nsInt32>(nsMath::Floor(in_fZIndex)), -32768, 32767);
+  const nsUInt64 uiZLayer = static_cast<nsUInt64>(iZIndex + 32768);
+  return (static_cast<nsUInt64>(in_uiStackingContextOrder) << 48) | (uiZLayer << 32) | static_cast<nsUInt64>(in_uiTreeOrder);
+}
+
+float HitTestIndex::GetZIndex(const ComputedStyle& in_style)
+{
+  if (in_style.Get(PropertyId::Position).IsKeyword(GetKeywords().m_Static))
+    return 0.0f;
+
+  const css::CSSValue& zIndex = in_style.Get(PropertyId::ZIndex);
+  return zIndex.IsNumeric() ? zIndex.GetNumericValue().number : 0.0f;
+}
+
+HitTestIndex::Handle HitTestIndex::Insert(const dom::DOMElement* in_pElement, const HitTestBox& in_box)
+{
+  Handle handle;
+  if (!m_FreeList.IsEmpty())
+  {
+    handle = m_FreeList.PeekBack();
+    m_FreeList.PopBack();
+  }
+  else
+  {
+    handle = m_Entries.GetCount();
+    m_Entries.ExpandAndGetRef();
+  }
+
+  Entry& entry = m_Entries[handle];
+  entry = Entry();
+  entry.m_pElement = in_pElement;
+  entry.m_bAlive = true;
+  SetupEntry(entry, in_box);
+  Link(handle);
+  m_ElementToEntry[in_pElement] = handle;
+  return handle;
+}
+
+void HitTestIndex::Update(Handle in_handle, const HitTestBox& in_box)
+{
+  NS_ASSERT_DEV(in_handle < m_Entries.GetCount() && m_Entries[in_handle].m_bAlive, "HitTestIndex: Invalid handle {0}.", in_handle);
+
+  Entry& entry = m_Entries[in_handle];
+  const CellRange oldRange = GetCellRange(entry);
+  const bool bWasLarge = entry.m_bLarge;
+  const nsUInt64 uiOldPaintOrder = entry.m_uiPaintOrder;
+
+  Entry updated = entry;
+  SetupEntry(updated, in_box);
+
+  // Same cells and same order: the cell lists stay valid, only the geometry changes.
+  if (uiOldPaintOrder == updated.m_uiPaintOrder && oldRange == GetCellRange(updated) && bWasLarge == updated.m_bLarge)
+  {
+    entry = updated;
+    return;
+  }
+
+  Unlink(in_handle);
+  m_Entries[in_handle] = updated;
+  Link(in_handle);
+}
+
+void HitTestIndex::Remove(Handle in_handle)
+{
+  if (in_handle >= m_Entries.GetCount() || !m_Entries[in_handle].m_bAlive)
+    return;
+
+  Unlink(in_handle);
+  const Handle* pMapped = m_ElementToEntry.GetValue(m_Entries[in_handle].m_pElement);
+  if (pMapped != nullptr && *pMapped == in_handle)
+  {
+    m_ElementToEntry.Remove(m_Entries[in_handle].m_pElement);
+  }
+  m_Entries[in_handle] = Entry();
+  m_FreeList.PushBack(in_handle);
+}
+
+void HitTestIndex::Clear()
+{
+  m_Entries.Clear();
+  m_FreeList.Clear();
+  m_Cells.Clear();
+  m_LargeEntries.Clear();
+  m_ElementToEntry.Clear();
+  m_LayoutEntries.Clear();
+  m_ChangedBoxes.Clear();
+  m_pTree = nullptr;
+}
+
+void HitTestIndex::Update(const LayoutTree& in_tree)
+{
+  const nsUInt32 uiGeneration = in_tree.GetLayoutGeneration();
+  const bool bValid = m_pTree == &in_tree && m_LayoutEntries.GetCount() == in_tree.GetBoxCount();
+  if (bValid && uiGeneration == m_uiGeneration)
+    return;
+
+  NS_PROFILE_SCOPE("HitTestIndex::Update");
+
+  // The changed boxes are only the ones of the last pass.
+  if (!bValid || uiGeneration != m_uiGeneration + 1)
+  {
+    ++m_Stats.m_uiFullUpdates;
+    Clear();
+    m_LayoutEntries.SetCount(in_tree.GetBoxCount());
+    UpdateRange(in_tree, 0, in_tree.GetBoxCount());
+  }
+  else
+  {
+    // Children are positioned and clipped relative to their parent. Parents are handled before their children, changed
+    // boxes in a subtree that was updated completely are covered.
+    m_ChangedBoxes = in_tree.GetChangedBoxes();
+    m_ChangedBoxes.Sort();
+
+    LayoutIndex uiCoveredEnd = 0;
+    for (LayoutIndex uiIndex : m_ChangedBoxes)
+    {
+      if (uiIndex < uiCoveredEnd)
+        continue;
+
+      const nsRectFloat previous = m_LayoutEntries[uiIndex].m_Rect;
+      const nsMat3 previousTransform = m_LayoutEntries[uiIndex].m_LocalToScreen;
+      UpdateRange(in_tree, uiIndex, uiIndex + 1);
+
+      const LayoutEntry& updated = m_LayoutEntries[uiIndex];
+      if (updated.m_Rect.x != previous.x || updated.m_Rect.y != previous.y || (updated.m_bClipsChildren && updated.m_Rect != previous) ||
+          !updated.m_LocalToScreen.IsIdentical(previousTransform))
+      {
+        uiCoveredEnd = GetSubtreeEnd(in_tree, uiIndex);
+        UpdateRange(in_tree, uiIndex + 1, uiCoveredEnd);
+      }
+    }
+  }
+
+  m_pTree = &in_tree;
+  m_uiGeneration = uiGeneration;
+}
+
+HitTestIndex::Handle HitTestIndex::Find(const dom::DOMElement* in_pElement) const
+{
+  const Handle* pHandle = m_ElementToEntry.GetValue(in_pElement);
+  return pHandle != nullptr ? *pHandle : InvalidHandle;
+}
+
+const dom::DOMElement* HitTestIndex::HitTest(nsVec2 in_vPoint) const
+{
+  NS_PROFILE_SCOPE("HitTestIndex::HitTest");
+
+  const dom::DOMElement* pResult = nullptr;
+  VisitCandidates(in_vPoint, [&](const Entry& entry) {
+    if (!ContainsPoint(entry, in_vPoint))
+      return true;
+
+    pResult = entry.m_pElement;
+    return false;
+  });
+  return pResult;
+}
+
+void HitTestIndex::HitTestAll(nsVec2 in_vPoint, nsDynamicArray<const dom::DOMElement*>& out_elements) const
+{
+  NS_PROFILE_SCOPE("HitTestIndex::HitTestAll");
+
+  out_elements.Clear();
+  VisitCandidates(in_vPoint, [&](const Entry& entry) {
+    if (ContainsPoint(entry, in_vPoint))
+    {
+      out_elements.PushBack(entry.m_pElement);
+    }
+    return true;
+  });
+}
+
+bool HitTestIndex::IsPointWithinElement(const dom::DOMElement* in_pElement, nsVec2 in_vPoint) const
+{
+  const Handle handle = Find(in_pElement);
+  if (handle == InvalidHandle)
+    return false;
+
+  const Entry& entry = m_Entries[handle];
+  return entry.m_bHittable && ContainsPoint(entry, in_vPoint);
+}
+
+void HitTestIndex::UpdateRange(const LayoutTree& in_tree, LayoutIndex in_uiStart, LayoutIndex in_uiEnd)
+{
+  const HitTestKeywords& keywords = GetKeywords();
+
+  // Parents come before their children in pre-order, their state is known when the children are reached.
+  for (LayoutIndex i = in_uiStart; i < in_uiEnd; ++i)
+  {
+    const LayoutBox& box = in_tree.GetBox(i);
+    LayoutEntry& layoutEntry = m_LayoutEntries[i];
+    const Handle hPrevious = layoutEntry.m_hEntry;
+
+    layoutEntry = LayoutEntry();
+    layoutEntry.m_Rect = box.GetRect();
+    if (box.m_uiParent != InvalidLayoutIndex)
+    {
+      const LayoutEntry& parent = m_LayoutEntries[box.m_uiParent];
+      layoutEntry.m_Rect.x += parent.m_Rect.x;
+      layoutEntry.m_Rect.y += parent.m_Rect.y;
+      layoutEntry.m_LocalToScreen = parent.m_LocalToScreen;
+      layoutEntry.m_bTransformed = parent.m_bTransformed;
+      layoutEntry.m_ClipRect = parent.m_ChildClipRect;
+      layoutEntry.m_uiStackingContextOrder = parent.m_uiStackingContextOrder;
+      layoutEntry.m_fZIndex = parent.m_fZIndex;
+      layoutEntry.m_bInStackingContext = parent.m_bInStackingContext;
+    }
+    layoutEntry.m_ChildClipRect = layoutEntry.m_ClipRect;
+
+    // Text and anonymous boxes are hit as part of their element.
+    const dom::DOMElement* pElement = nullptr;
+    if (box.m_pNode != nullptr && box.m_pNode->getNodeType() == dom::DOMNodeType::ELEMENT_NODE)
+    {
+      pElement = static_cast<const dom::DOMElement*>(box.m_pNode);
+    }
+
+    bool bHittable = pElement != nullptr;
+    if (pElement != nullptr)
+    {
+      const ComputedStyle& style = box.m_pStyle != nullptr ? *box.m_pStyle : ComputedStyle::GetInitialStyle();
+
+      // Positioned elements with a z-index establish a stacking context.
+      const css::CSSValue& zIndex = style.Get(PropertyId::ZIndex);
+      if (zIndex.IsNumeric() && !style.Get(PropertyId::Position).IsKeyword(keywords.m_Static))
+      {
+        if (!layoutEntry.m_bInStackingContext)
+        {
+          layoutEntry.m_uiStackingContextOrder = BiasZIndex(zIndex.GetNumericValue().number);
+          layoutEntry.m_bInStackingContext = true;
+        }
+        else
+        {
+          layoutEntry.m_fZIndex = zIndex.GetNumericValue().number;
+        }
+      }
+
+      nsMat3 transform;
+      if (GetElementTransform(style, layoutEntry.m_Rect, transform))
+      {
+        layoutEntry.m_LocalToScreen = layoutEntry.m_LocalToScreen * transform;
+        layoutEntry.m_bTransformed = true;
+      }
+
+      if (!style.Get(PropertyId::OverflowX).IsKeyword(keywords.m_Visible) || !style.Get(PropertyId::OverflowY).IsKeyword(keywords.m_Visible))
+      {
+        const nsRectFloat screenRect = layoutEntry.m_bTransformed ? TransformBounds(layoutEntry.m_LocalToScreen, layoutEntry.m_Rect) : layoutEntry.m_Rect;
+        layoutEntry.m_ChildClipRect = IntersectClip(layoutEntry.m_ClipRect, screenRect);
+        layoutEntry.m_bClipsChildren = true;
+      }
+
+      bHittable = !style.Get(PropertyId::PointerEvents).IsKeyword(keywords.m_None) && !style.Get(PropertyId::Visibility).IsKeyword(keywords.m_Hidden);
+    }
+
+    if (!bHittable)
+    {
+      if (hPrevious != InvalidHandle)
+        Remove(hPrevious);
+      continue;
+    }
+
+    HitTestBox hitBox;
+    hitBox.m_LocalRect = layoutEntry.m_Rect;
+    hitBox.m_LocalToScreen = layoutEntry.m_LocalToScreen;
+    hitBox.m_ScreenClipRect = layoutEntry.m_ClipRect;
+    hitBox.m_uiPaintOrder = MakePaintOrderKey(layoutEntry.m_uiStackingContextOrder, layoutEntry.m_fZIndex, i);
+
+    if (hPrevious != InvalidHandle && m_Entries[hPrevious].m_pElement == pElement)
+    {
+      Update(hPrevious, hitBox);
+      layoutEntry.m_hEntry = hPrevious;
+    }
+    else
+    {
+      if (hPrevious != InvalidHandle)
+        Remove(hPrevious);
+      layoutEntry.m_hEntry = Insert(pElement, hitBox);
+    }
+  }
+  m_Stats.m_uiUpdatedBoxes += in_uiEnd - in_uiStart;
+}
+
+LayoutIndex HitTestIndex::GetSubtreeEnd(const LayoutTree& in_tree, LayoutIndex in_uiIndex)
+{
+  for (LayoutIndex uiIndex = in_uiIndex; uiIndex != InvalidLayoutIndex; uiIndex = in_tree.GetBox(uiIndex).m_uiParent)
+  {
+    const LayoutIndex uiNext = in_tree.GetBox(uiIndex).m_uiNextSibling;
+    if (uiNext != InvalidLayoutIndex)
+      return uiNext;
+  }
+  return in_tree.GetBoxCount();
+}
+
+void HitTestIndex::SetupEntry(Entry& inout_entry, const HitTestBox& in_box) const
+{
+  inout_entry.m_LocalRect = in_box.m_LocalRect;
+  inout_entry.m_ScreenClipRect = in_box.m_ScreenClipRect;
+  inout_entry.m_uiPaintOrder = in_box.m_uiPaintOrder;
+  inout_entry.m_bHasTransform = !in_box.m_LocalToScreen.IsIdentical(nsMat3::MakeIdentity());
+  inout_entry.m_ScreenToLocal = nsMat3::MakeIdentity();
+  inout_entry.m_bHittable = in_box.m_LocalRect.HasNonZeroArea();
+
+  nsRectFloat bounds = in_box.m_LocalRect;
+  if (inout_entry.m_bHasTransform)
+  {
+    inout_entry.m_ScreenToLocal = in_box.m_LocalToScreen;
+    if (inout_entry.m_ScreenToLocal.Invert().Failed())
+    {
+      inout_entry.m_bHittable = false;
+    }
+
+    bounds = TransformBounds(in_box.m_LocalToScreen, in_box.m_LocalRect);
+  }
+
+  if (in_box.m_ScreenClipRect.IsValid())
+  {
+    bounds = nsRectFloat::MakeIntersection(bounds, in_box.m_ScreenClipRect);
+    if (!bounds.HasNonZeroArea())
+    {
+      inout_entry.m_bHittable = false;
+    }
+  }
+
+  inout_entry.m_ScreenBounds = bounds;
+  inout_entry.m_bLarge = inout_entry.m_bHittable && GetCellRange(inout_entry).GetCellCount() > MaxCellsPerEntry;
+}
+
+HitTestIndex::CellRange HitTestIndex::GetCellRange(const Entry& in_entry) const
+{
+  CellRange range;
+  if (!in_entry.m_bHittable)
+    return range;
+
+  range.m_iMinX = ToCell(in_entry.m_ScreenBounds.Left());
+  range.m_iMinY = ToCell(in_entry.m_ScreenBounds.Top());
+  range.m_iMaxX = ToCell(in_entry.m_ScreenBounds.Right());
+  range.m_iMaxY = ToCell(in_entry.m_ScreenBounds.Bottom());
+  return range;
+}
+
+nsInt32 HitTestIndex::ToCell(float in_fCoordinate) const
+{
+  return static_cast<nsInt32>(nsMath::Floor(in_fCoordinate * m_fInvCellSize));
+}
+
+nsUInt64 HitTestIndex::MakeCellKey(nsInt32 in_iX, nsInt32 in_iY)
+{
+  return (static_cast<nsUInt64>(static_cast<nsUInt32>(in_iX)) << 32) | static_cast<nsUInt64>(static_cast<nsUInt32>(in_iY));
+}
+
+void HitTestIndex::Link(Handle in_handle)
+{
+  const Entry& entry = m_Entries[in_handle];
+  if (!entry.m_bHittable)
+    return;
+
+  if (entry.m_bLarge)
+  {
+    InsertSorted(m_LargeEntries, in_handle);
+    return;
+  }
+
+  const CellRange range = GetCellRange(entry);
+  for (nsInt32 y = range.m_iMinY; y <= range.m_iMaxY; ++y)
+  {
+    for (nsInt32 x = range.m_iMinX; x <= range.m_iMaxX; ++x)
+    {
+      InsertSorted(m_Cells[MakeCellKey(x, y)], in_handle);
+    }
+  }
+}
+
+void HitTestIndex::Unlink(Handle in_handle)
+{
+  const Entry& entry = m_Entries[in_handle];
+  if (!entry.m_bHittable)
+    return;
+
+  if (entry.m_bLarge)
+  {
+    m_LargeEntries.RemoveAndCopy(in_handle);
+    return;
+  }
+
+  const CellRange range = GetCellRange(entry);
+  for (nsInt32 y = range.m_iMinY; y <= range.m_iMaxY; ++y)
+  {
+    for (nsInt32 x = range.m_iMinX; x <= range.m_iMaxX; ++x)
+    {
+      const nsUInt64 uiKey = MakeCellKey(x, y);
+      nsDynamicArray<Handle>* pCell = nullptr;
+      if (m_Cells.TryGetValue(uiKey, pCell))
+      {
+        pCell->RemoveAndCopy(in_handle);
+        if (pCell->IsEmpty())
+        {
+          m_Cells.Remove(uiKey);
+        }
+      }
+    }
+  }
+}
+
+void HitTestIndex::InsertSorted(nsDynamicArray<Handle>& inout_list, Handle in_handle) const
+{
+  // Descending paint order, binary search for the first entry that is painted below the new one.
+  const nsUInt64 uiPaintOrder = m_Entries[in_handle].m_uiPaintOrder;
+  nsUInt32 uiLow = 0;
+  nsUInt32 uiHigh = inout_list.GetCount();
+  while (uiLow < uiHigh)
+  {
+    const nsUInt32 uiMid = (uiLow + uiHigh) / 2;
+    if (m_Entries[inout_list[uiMid]].m_uiPaintOrder >= uiPaintOrder)
+      uiLow = uiMid + 1;
+    else
+      uiHigh = uiMid;
+  }
+  inout_list.InsertAt(uiLow, in_handle);
+}
+
+bool HitTestIndex::ContainsPoint(const Entry& in_entry, nsVec2 in_vPoint) const
+{
+  if (in_entry.m_ScreenClipRect.IsValid() && !in_entry.m_ScreenClipRect.Contains(in_vPoint))
+    return false;
+
+  if (!in_entry.m_bHasTransform)
+    return in_entry.m_LocalRect.Contains(in_vPoint);
+
+  return in_entry.m_LocalRect.Contains(TransformPoint(in_entry.m_ScreenToLocal, in_vPoint));
+}
+
+template <typename Visitor>
+void HitTestIndex::VisitCandidates(nsVec2 in_vPoint, Visitor in_visitor) const
+{
+  static const nsDynamicArray<Handle> s_EmptyCell;
+
+  const nsDynamicArray<Handle>* pCell = m_Cells.GetValue(MakeCellKey(ToCell(in_vPoint.x), ToCell(in_vPoint.y)));
+  const nsDynamicArray<Handle>& cell = pCell != nullptr ? *pCell : s_EmptyCell;
+
+  // Both lists are sorted by descending paint order, merge them so candidates are visited topmost first.
+  nsUInt32 uiCell = 0;
+  nsUInt32 uiLarge = 0;
+  while (uiCell < cell.GetCount() || uiLarge < m_LargeEntries.GetCount())
+  {
+    Handle handle;
+    if (uiLarge >= m_LargeEntries.GetCount() ||
+        (uiCell < cell.GetCount() && m_Entries[cell[uiCell]].m_uiPaintOrder >= m_Entries[m_LargeEntries[uiLarge]].m_uiPaintOrder))
+    {
+      handle = cell[uiCell++];
+    }
+    else
+    {
+      handle = m_LargeEntries[uiLarge++];
+    }
+
+    if (!in_visitor(m_Entries[handle]))
+      return;
+  }
+}
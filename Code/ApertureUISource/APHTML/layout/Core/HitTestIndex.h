@@ -0,0 +1,221 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Math/Mat3.h>
+#include <Foundation/Math/Rect.h>
+
+namespace aperture::layout
+{
+  /// @brief Describes the final, hit-testable geometry of one element after layout.
+  struct HitTestBox
+  {
+    /// @brief The border box of the element in its local space (i.e. before its transform is applied).
+    nsRectFloat m_LocalRect = nsRectFloat::MakeZero();
+    /// @brief Local to screen 2D affine transform, in homogeneous form. Identity if the element (and its ancestors) are not transformed.
+    nsMat3 m_LocalToScreen = nsMat3::MakeIdentity();
+    /// @brief The accumulated clip area of all ancestors in screen space. Points outside of it never hit the element.
+    nsRectFloat m_ScreenClipRect = nsRectFloat::MakeInvalid();
+    /// @brief Paint order of the element, higher is painted on top. See MakePaintOrderKey().
+    nsUInt64 m_uiPaintOrder = 0;
+  };
+
+  /*
+   * @brief Spatial acceleration structure for hover and click resolution over the final layout boxes.
+   *
+   * Boxes are bucketed into a uniform grid of screen space cells. Every cell keeps its entries sorted by paint order, so a query
+   * only visits the entries of one cell, topmost first, and stops at the first one that contains the point.
+   * Boxes that would cover a huge amount of cells (e.g. full screen backgrounds) are kept in a separate sorted list that is merged into every query.
+   *
+   * Transforms are respected by testing the point against the local rect, after mapping it through the inverse transform.
+   * Elements whose transform is not invertible can't be hit, the same as Element::Project() failing for them.
+   *
+   * Update(const LayoutTree&) keeps the index in sync with a LayoutTree: every element box gets a entry, and after a
+   * Calculate() only the boxes it changed (see LayoutTree::GetChangedBoxes()) and the subtrees of the ones that moved or
+   * clip their overflow are updated. The paint order comes from the z-index of positioned elements. The outermost
+   * stacking context and the one the element is in are ordered exactly, deeper nesting falls back to tree order.
+   * Overflow other than visible clips the descendants to the border box, elements with pointer-events: none or
+   * visibility: hidden can't be hit. The transform of a element (around its transform-origin) applies to it and its
+   * descendants. A transformed element that clips its overflow clips to the screen bounds of its transformed border box.
+   *
+   * @note Entries are updated incrementally: after layout only the boxes that changed should be passed to Update().
+   * A z-index or transform change that doesn't affect layout isn't reported by the tree, Clear() the index to pick it up.
+   * @note Not thread-safe. It is owned and queried by the thread that runs layout and input resolution.
+   */
+  class NS_APERTURE_DLL HitTestIndex
+  {
+  public:
+    using Handle = nsUInt32;
+    static constexpr Handle InvalidHandle = 0xFFFFFFFFu;
+
+    struct Stats
+    {
+      /// @brief Updates from a LayoutTree that rebuilt every entry.
+      nsUInt32 m_uiFullUpdates = 0;
+      /// @brief Boxes of a LayoutTree whose entries were updated.
+      nsUInt32 m_uiUpdatedBoxes = 0;
+    };
+
+    explicit HitTestIndex(float in_fCellSize = 64.0f);
+    ~HitTestIndex() = default;
+
+    /// @brief Builds the paint order key from the stacking context order, the z-index inside of it, and the tree order inside of the z-index layer.
+    /// @param[in] in_uiStackingContextOrder The paint order of the stacking context the element belongs to (0 = root).
+    /// @param[in] in_fZIndex The z-index of the element (see Element::GetZIndex()).
+    /// @param[in] in_uiTreeOrder The pre-order index of the element in the DOM.
+    static nsUInt64 MakePaintOrderKey(nsUInt16 in_uiStackingContextOrder, float in_fZIndex, nsUInt32 in_uiTreeOrder);
+
+    /// @brief The z-index of a element as a number, 0 if it is auto or the element isn't positioned (see Element::GetZIndex()).
+    static float GetZIndex(const css::ComputedStyle& in_style);
+
+    /// @brief Adds a element to the index.
+    Handle Insert(const dom::DOMElement* in_pElement, const HitTestBox& in_box);
+
+    /// @brief Updates the geometry of a element. Cheap if the box stays in the same cells and keeps its paint order.
+    void Update(Handle in_handle, const HitTestBox& in_box);
+
+    void Remove(Handle in_handle);
+    void Clear();
+
+    /// @brief Updates the entries of the element boxes the tree laid out since the last update. The tree has to be calculated.
+    /// @note The index is owned by the tree from then on, don't mix it with Insert() and Remove().
+    void Update(const LayoutTree& in_tree);
+
+    /// @brief The entry of a element, InvalidHandle if it has none.
+    Handle Find(const dom::DOMElement* in_pElement) const;
+
+    /// @brief Returns the topmost element at the given screen position, or nullptr.
+    const dom::DOMElement* HitTest(nsVec2 in_vPoint) const;
+
+    /// @brief Returns all elements at the given screen position, topmost first.
+    void HitTestAll(nsVec2 in_vPoint, nsDynamicArray<const dom::DOMElement*>& out_elements) const;
+
+    /// @brief Whether the point lies within the border box of the element, after its transform and clip areas are applied.
+    /// Unlike HitTest() it doesn't matter whether the element is covered by another one, the same as Element::IsPointWithinElement().
+    bool IsPointWithinElement(const dom::DOMElement* in_pElement, nsVec2 in_vPoint) const;
+
+    nsUInt32 GetCount() const { return m_Entries.GetCount() - m_FreeList.GetCount(); }
+
+    const Stats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+  private:
+    struct Entry
+    {
+      const dom::DOMElement* m_pElement = nullptr;
+      nsRectFloat m_LocalRect = nsRectFloat::MakeZero();
+      nsMat3 m_ScreenToLocal = nsMat3::MakeIdentity();
+      nsRectFloat m_ScreenClipRect = nsRectFloat::MakeInvalid();
+      /// @brief Screen space bounds of the transformed box, clipped. Used to decide which cells the entry is stored in.
+      nsRectFloat m_ScreenBounds = nsRectFloat::MakeInvalid();
+      nsUInt64 m_uiPaintOrder = 0;
+      bool m_bHasTransform = false;
+      bool m_bHittable = false;
+      bool m_bLarge = false;
+      bool m_bAlive = false;
+    };
+
+    struct CellRange
+    {
+      nsInt32 m_iMinX = 0;
+      nsInt32 m_iMinY = 0;
+      nsInt32 m_iMaxX = -1;
+      nsInt32 m_iMaxY = -1;
+
+      bool IsEmpty() const { return m_iMaxX < m_iMinX || m_iMaxY < m_iMinY; }
+      nsUInt64 GetCellCount() const { return IsEmpty() ? 0 : nsUInt64(m_iMaxX - m_iMinX + 1) * nsUInt64(m_iMaxY - m_iMinY + 1); }
+      bool operator==(const CellRange& rhs) const { return m_iMinX == rhs.m_iMinX && m_iMinY == rhs.m_iMinY && m_iMaxX == rhs.m_iMaxX && m_iMaxY == rhs.m_iMaxY; }
+    };
+
+    /// @brief The state of a box of the tree given to Update(), which its children are derived from.
+    struct LayoutEntry
+    {
+      Handle m_hEntry = InvalidHandle;
+      nsRectFloat m_Rect = nsRectFloat::MakeZero();
+      /// @brief The transforms of the box and its ancestors, children start from it.
+      nsMat3 m_LocalToScreen = nsMat3::MakeIdentity();
+      /// @brief The clip area of the box, invalid if it isn't clipped.
+      nsRectFloat m_ClipRect = nsRectFloat::MakeInvalid();
+      /// @brief The clip area of the children, the border box of the box if it clips its overflow.
+      nsRectFloat m_ChildClipRect = nsRectFloat::MakeInvalid();
+      /// @brief The biased z-index of the outermost stacking context the box is in.
+      nsUInt16 m_uiStackingContextOrder = 0x8000;
+      /// @brief The z-index inside of it.
+      float m_fZIndex = 0.0f;
+      bool m_bInStackingContext = false;
+      bool m_bClipsChildren = false;
+      bool m_bTransformed = false;
+    };
+
+    /// @brief Updates the entries of the boxes in [in_uiStart, in_uiEnd), their parents have to be up to date.
+    void UpdateRange(const LayoutTree& in_tree, LayoutIndex in_uiStart, LayoutIndex in_uiEnd);
+    static LayoutIndex GetSubtreeEnd(const LayoutTree& in_tree, LayoutIndex in_uiIndex);
+
+    void SetupEntry(Entry& inout_entry, const HitTestBox& in_box) const;
+    CellRange GetCellRange(const Entry& in_entry) const;
+    nsInt32 ToCell(float in_fCoordinate) const;
+    static nsUInt64 MakeCellKey(nsInt32 in_iX, nsInt32 in_iY);
+
+    void Link(Handle in_handle);
+    void Unlink(Handle in_handle);
+    void InsertSorted(nsDynamicArray<Handle>& inout_list, Handle in_handle) const;
+    bool ContainsPoint(const Entry& in_entry, nsVec2 in_vPoint) const;
+
+    /// @brief Visits the candidates of the cell at the point topmost first, until the visitor returns false.
+    template <typename Visitor>
+    void VisitCandidates(nsVec2 in_vPoint, Visitor in_visitor) const;
+
+  private:
+    float m_fCellSize;
+    float m_fInvCellSize;
+    nsDynamicArray<Entry> m_Entries;
+    nsDynamicArray<Handle> m_FreeList;
+    /// @brief Per cell entry lists, sorted by descending paint order.
+    nsHashTable<nsUInt64, nsDynamicArray<Handle>> m_Cells;
+    /// @brief Entries covering more than MaxCellsPerEntry cells, sorted by descending paint order.
+    nsDynamicArray<Handle> m_LargeEntries;
+    nsHashTable<const dom::DOMElement*, Handle> m_ElementToEntry;
+
+    /// @brief One per box of the tree given to Update(), indexed like its boxes.
+    nsDynamicArray<LayoutEntry> m_LayoutEntries;
+    nsDynamicArray<LayoutIndex> m_ChangedBoxes;
+    const LayoutTree* m_pTree = nullptr;
+    nsUInt32 m_uiGeneration = 0;
+    Stats m_Stats;
+  };
+} // namespace aperture::layout
@@ -1,2 +0,0 @@
-#include <APHTML/Layout/Core/InlineContainer.h>
-
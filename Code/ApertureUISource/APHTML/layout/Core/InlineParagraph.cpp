@@ -0,0 +1,691 @@
+#include <APHTML/layout/Core/InlineParagraph.h>
+#include <APHTML/layout/Core/TextMeasureCache.h>
+#include <Foundation/Profiling/Profiling.h>
+
+#include <unicode/ubidi.h>
+#include <unicode/ubrk.h>
+#include <unicode/utext.h>
+#include <unicode/utf16.h>
+#include <unicode/utf8.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace aperture;
+using namespace aperture::layout;
+
+namespace
+{
+  constexpr nsUInt32 s_uiNone = 0xFFFFFFFFu;
+  constexpr float s_fInfinity = std::numeric_limits<float>::infinity();
+
+  // Opening ICU objects loads their rules, they are kept per thread and reused for every paragraph.
+  class IcuObjects
+  {
+  public:
+    ~IcuObjects()
+    {
+      if (m_pLineBreaker != nullptr)
+        ubrk_close(m_pLineBreaker);
+      if (m_pBidi != nullptr)
+        ubidi_close(m_pBidi);
+    }
+
+    UBreakIterator* GetLineBreaker()
+    {
+      if (m_pLineBreaker == nullptr && !m_bLineBreakerFailed)
+      {
+        UErrorCode status = U_ZERO_ERROR;
+        m_pLineBreaker = ubrk_open(UBRK_LINE, "", nullptr, 0, &status);
+        if (U_FAILURE(status))
+        {
+          nsLog::SeriousWarning("Failed to open the ICU line break iterator, lines only break after spaces and newlines!");
+          m_pLineBreaker = nullptr;
+          m_bLineBreakerFailed = true;
+        }
+      }
+      return m_pLineBreaker;
+    }
+
+    UBiDi* GetBidi()
+    {
+      if (m_pBidi == nullptr)
+        m_pBidi = ubidi_open();
+      return m_pBidi;
+    }
+
+  private:
+    UBreakIterator* m_pLineBreaker = nullptr;
+    UBiDi* m_pBidi = nullptr;
+    bool m_bLineBreakerFailed = false;
+  };
+
+  IcuObjects& GetIcuObjects()
+  {
+    thread_local IcuObjects s_Objects;
+    return s_Objects;
+  }
+
+  bool IsSpace(char c)
+  {
+    return c == ' ' || c == '\t';
+  }
+
+  bool IsNewline(char c)
+  {
+    return c == '\n' || c == '\r';
+  }
+
+  // A superset test: the lead bytes of U+0580 - U+08FF (Hebrew, Arabic, Syriac, Thaana, NKo, ...), the right to left bidi
+  // controls, the presentation forms and the right to left blocks of the SMP. False positives only cost a bidi pass.
+  bool MayContainRightToLeft(std::string_view in_text)
+  {
+    const nsUInt8* pText = reinterpret_cast<const nsUInt8*>(in_text.data());
+    const size_t uiLength = in_text.size();
+    for (size_t i = 0; i < uiLength; ++i)
+    {
+      const nsUInt8 c = pText[i];
+      if (c < 0xD6)
+        continue;
+      if (c <= 0xDF)
+        return true;
+
+      const nsUInt8 c1 = i + 1 < uiLength ? pText[i + 1] : 0;
+      const nsUInt8 c2 = i + 2 < uiLength ? pText[i + 2] : 0;
+      if (c == 0xE0 && c1 >= 0xA0 && c1 <= 0xA3)
+        return true;
+      if (c == 0xE2 && ((c1 == 0x80 && (c2 == 0x8F || c2 == 0xAB || c2 == 0xAE)) || (c1 == 0x81 && c2 == 0xA7)))
+        return true;
+      if (c == 0xEF && c1 >= 0xAC && c1 <= 0xBB)
+        return true;
+      if (c == 0xF0 && ((c1 == 0x90 && c2 >= 0xA0) || c1 == 0x9E))
+        return true;
+    }
+    return false;
+  }
+
+  // The owner is not part of the layout, items that only differ in it don't need new segments.
+  bool IsSameItemStyle(const InlineItem& a, const InlineItem& b)
+  {
+    return a.m_uiStart == b.m_uiStart && a.m_uiFontKey == b.m_uiFontKey && a.m_fLineHeight == b.m_fLineHeight && a.m_fBaselineOffset == b.m_fBaselineOffset &&
+           a.m_VerticalAlign == b.m_VerticalAlign;
+  }
+
+  bool IsSameParagraphStyle(const InlineParagraphStyle& a, const InlineParagraphStyle& b)
+  {
+    return a.m_uiFontKey == b.m_uiFontKey && a.m_fLineHeight == b.m_fLineHeight && a.m_Align == b.m_Align && a.m_bWrap == b.m_bWrap && a.m_bRightToLeft == b.m_bRightToLeft;
+  }
+
+  float GetLineHeight(float in_fLineHeight, const FontMetrics& in_metrics)
+  {
+    return in_fLineHeight >= 0.0f ? in_fLineHeight : in_metrics.m_fAscent + in_metrics.m_fDescent;
+  }
+
+  // How far the baseline of a item is below the baseline of the strut. Top and bottom aligned items are placed by the line.
+  float GetBaselineShift(const InlineItem& in_item, const FontMetrics& in_metrics, const FontMetrics& in_strut)
+  {
+    switch (in_item.m_VerticalAlign)
+    {
+      case VerticalAlign::Sub:
+        return (in_strut.m_fAscent + in_strut.m_fDescent) * 0.2f;
+      case VerticalAlign::Super:
+        return -(in_strut.m_fAscent + in_strut.m_fDescent) * 0.33f;
+      case VerticalAlign::TextTop:
+        return in_metrics.m_fAscent - in_strut.m_fAscent;
+      case VerticalAlign::TextBottom:
+        return in_strut.m_fDescent - in_metrics.m_fDescent;
+      case VerticalAlign::Middle:
+        return (in_metrics.m_fAscent - in_metrics.m_fDescent - in_strut.m_fXHeight) * 0.5f;
+      case VerticalAlign::Length:
+        return -in_item.m_fBaselineOffset;
+      default:
+        return 0.0f;
+    }
+  }
+
+  float NormalizeWidth(float in_fWidth)
+  {
+    return std::isnan(in_fWidth) ? s_fInfinity : in_fWidth;
+  }
+} // namespace
+
+bool InlineParagraph::SetContent(std::string_view in_text, nsArrayPtr<const InlineItem> in_items, const InlineParagraphStyle& in_style)
+{
+  NS_ASSERT_DEV(in_text.empty() || (!in_items.IsEmpty() && in_items[0].m_uiStart == 0 && in_items[in_items.GetCount() - 1].m_uiEnd == in_text.size()),
+    "The items have to cover the text of the paragraph.");
+
+  // The first byte whose layout may differ.
+  const size_t uiCommon = nsMath::Min(in_text.size(), m_Text.size());
+  nsUInt32 uiChanged = 0;
+  while (uiChanged < uiCommon && in_text[uiChanged] == m_Text[uiChanged])
+    ++uiChanged;
+
+  if (!IsSameParagraphStyle(in_style, m_Style))
+    uiChanged = 0;
+
+  const nsUInt32 uiCommonItems = nsMath::Min(in_items.GetCount(), m_Items.GetCount());
+  nsUInt32 uiItem = 0;
+  for (; uiItem < uiCommonItems && uiChanged > in_items[uiItem].m_uiStart; ++uiItem)
+  {
+    if (!IsSameItemStyle(in_items[uiItem], m_Items[uiItem]))
+    {
+      uiChanged = in_items[uiItem].m_uiStart;
+      break;
+    }
+    if (in_items[uiItem].m_uiEnd != m_Items[uiItem].m_uiEnd)
+    {
+      uiChanged = nsMath::Min(uiChanged, nsMath::Min(in_items[uiItem].m_uiEnd, m_Items[uiItem].m_uiEnd));
+      break;
+    }
+  }
+  if (uiItem == uiCommonItems && in_items.GetCount() != m_Items.GetCount())
+  {
+    const nsUInt32 uiFirstExtra = in_items.GetCount() > uiCommonItems ? in_items[uiCommonItems].m_uiStart : m_Items[uiCommonItems].m_uiStart;
+    uiChanged = nsMath::Min(uiChanged, uiFirstExtra);
+  }
+
+  m_Items = in_items;
+  m_Style = in_style;
+  if (uiChanged == in_text.size() && in_text.size() == m_Text.size())
+    return false;
+
+  m_Text.assign(in_text);
+  m_uiDirtyOffset = nsMath::Min(m_uiDirtyOffset, uiChanged);
+  m_bLinesComplete = false;
+  for (MeasuredSize& measured : m_Measured)
+    measured.m_fMaxWidth = -1.0f;
+  return true;
+}
+
+void InlineParagraph::MarkDirty()
+{
+  m_uiDirtyOffset = 0;
+  m_Lines.Clear();
+  m_LineRanges.Clear();
+  m_Fragments.Clear();
+  m_fLinesWidth = -1.0f;
+  m_bLinesComplete = false;
+  for (MeasuredSize& measured : m_Measured)
+    measured.m_fMaxWidth = -1.0f;
+}
+
+Size InlineParagraph::Measure(TextMeasureCache& in_cache, float in_fMaxWidth)
+{
+  const float fMaxWidth = NormalizeWidth(in_fMaxWidth);
+  UpdateSegments(in_cache);
+
+  // The lines are usually built for the width the box is measured with again.
+  if (fMaxWidth == m_fLinesWidth || m_fLinesWidth < 0.0f)
+  {
+    Layout(in_cache, fMaxWidth);
+    return m_LinesSize;
+  }
+
+  for (const MeasuredSize& measured : m_Measured)
+  {
+    if (measured.m_fMaxWidth == fMaxWidth)
+      return measured.m_Size;
+  }
+
+  MeasuredSize& measured = m_Measured[m_uiNextMeasured];
+  m_uiNextMeasured = (m_uiNextMeasured + 1) % NS_ARRAY_SIZE(m_Measured);
+  measured.m_fMaxWidth = fMaxWidth;
+  measured.m_Size = BuildLines(in_cache, fMaxWidth, false);
+  return measured.m_Size;
+}
+
+void InlineParagraph::Layout(TextMeasureCache& in_cache, float in_fWidth)
+{
+  const float fWidth = NormalizeWidth(in_fWidth);
+  UpdateSegments(in_cache);
+
+  if (fWidth != m_fLinesWidth)
+  {
+    m_Lines.Clear();
+    m_LineRanges.Clear();
+    m_Fragments.Clear();
+    m_fLinesWidth = fWidth;
+    m_bLinesComplete = false;
+  }
+
+  if (!m_bLinesComplete)
+    m_LinesSize = BuildLines(in_cache, fWidth, true);
+}
+
+void InlineParagraph::UpdateSegments(TextMeasureCache& in_cache)
+{
+  if (m_uiDirtyOffset == s_uiNone)
+    return;
+
+  NS_PROFILE_SCOPE("InlineParagraph::UpdateSegments");
+
+  // Bidi levels depend on the whole paragraph. Otherwise the segments are kept up to the second break opportunity
+  // before the change, UAX #14 looks at a few characters after a opportunity to decide on it.
+  const bool bBidi = m_Style.m_bRightToLeft || MayContainRightToLeft(m_Text);
+  nsUInt32 uiKeep = 0;
+  if (!bBidi && m_BidiLevels.IsEmpty())
+  {
+    nsUInt32 uiBoundaries = 0;
+    for (uiKeep = m_Segments.GetCount(); uiKeep > 0; --uiKeep)
+    {
+      const Segment& segment = m_Segments[uiKeep - 1];
+      if (segment.m_uiEnd < m_uiDirtyOffset && segment.m_bBoundary && ++uiBoundaries == 2)
+        break;
+    }
+  }
+  m_Segments.SetCount(uiKeep);
+  m_uiDirtyOffset = s_uiNone;
+
+  // Lines that never looked at a replaced segment stay.
+  nsUInt32 uiValidLines = m_Lines.GetCount();
+  while (uiValidLines > 0 && m_LineRanges[uiValidLines - 1].m_uiLastExamined >= uiKeep)
+    --uiValidLines;
+  m_Lines.SetCount(uiValidLines);
+  m_LineRanges.SetCount(uiValidLines);
+  m_Fragments.SetCount(uiValidLines > 0 ? m_Lines[uiValidLines - 1].m_uiFirstFragment + m_Lines[uiValidLines - 1].m_uiFragmentCount : 0);
+  m_bLinesComplete = false;
+
+  if (bBidi)
+    ComputeBidiLevels();
+  else
+    m_BidiLevels.Clear();
+
+  const nsUInt32 uiLength = static_cast<nsUInt32>(m_Text.size());
+  const nsUInt32 uiStart = m_Segments.IsEmpty() ? 0 : m_Segments.PeekBack().m_uiEnd;
+  if (uiStart >= uiLength || m_Items.IsEmpty())
+    return;
+
+  nsUInt32 uiItem = 0;
+  while (m_Items[uiItem].m_uiEnd <= uiStart && uiItem + 1 < m_Items.GetCount())
+    ++uiItem;
+
+  if (UBreakIterator* pBreaker = GetIcuObjects().GetLineBreaker())
+  {
+    UErrorCode status = U_ZERO_ERROR;
+    UText text = UTEXT_INITIALIZER;
+    utext_openUTF8(&text, m_Text.data(), static_cast<int64_t>(uiLength), &status);
+    ubrk_setUText(pBreaker, &text, &status);
+
+    if (U_SUCCESS(status))
+    {
+      nsUInt32 uiPosition = uiStart;
+      for (int32_t iBreak = ubrk_following(pBreaker, static_cast<int32_t>(uiStart)); iBreak != UBRK_DONE; iBreak = ubrk_next(pBreaker))
+      {
+        const int32_t iRuleStatus = ubrk_getRuleStatus(pBreaker);
+        const bool bForced = iRuleStatus >= UBRK_LINE_HARD && iRuleStatus < UBRK_LINE_HARD_LIMIT;
+        AddSegments(in_cache, uiPosition, static_cast<nsUInt32>(iBreak), bForced, uiItem);
+        uiPosition = static_cast<nsUInt32>(iBreak);
+      }
+      utext_close(&text);
+      return;
+    }
+    utext_close(&text);
+  }
+
+  // Without ICU lines break after spaces, and always after newlines.
+  nsUInt32 uiPosition = uiStart;
+  for (nsUInt32 i = uiStart; i < uiLength; ++i)
+  {
+    const bool bNewline = m_Text[i] == '\n';
+    const bool bAfterSpaces = IsSpace(m_Text[i]) && (i + 1 == uiLength || !IsSpace(m_Text[i + 1]));
+    if (bNewline || bAfterSpaces || i + 1 == uiLength)
+    {
+      AddSegments(in_cache, uiPosition, i + 1, bNewline, uiItem);
+      uiPosition = i + 1;
+    }
+  }
+}
+
+void InlineParagraph::ComputeBidiLevels()
+{
+  const nsUInt32 uiLength = static_cast<nsUInt32>(m_Text.size());
+  const UBiDiLevel baseLevel = m_Style.m_bRightToLeft ? 1 : 0;
+
+  m_BidiLevels.SetCountUninitialized(uiLength);
+  for (nsUInt8& uiLevel : m_BidiLevels)
+    uiLevel = baseLevel;
+
+  // ICU works on UTF-16, remember where each code unit came from to map the levels back to bytes.
+  nsDynamicArray<nsUInt16> utf16;
+  nsDynamicArray<nsUInt32> offsets;
+  utf16.Reserve(uiLength);
+  offsets.Reserve(uiLength);
+  for (int32_t i = 0; i < static_cast<int32_t>(uiLength);)
+  {
+    const nsUInt32 uiOffset = static_cast<nsUInt32>(i);
+    UChar32 c = 0;
+    U8_NEXT(m_Text.data(), i, static_cast<int32_t>(uiLength), c);
+    if (c < 0)
+      c = 0xFFFD;
+
+    if (U_IS_BMP(c))
+    {
+      utf16.PushBack(static_cast<nsUInt16>(c));
+      offsets.PushBack(uiOffset);
+    }
+    else
+    {
+      utf16.PushBack(U16_LEAD(c));
+      utf16.PushBack(U16_TRAIL(c));
+      offsets.PushBack(uiOffset);
+      offsets.PushBack(uiOffset);
+    }
+  }
+
+  UBiDi* pBidi = GetIcuObjects().GetBidi();
+  if (pBidi == nullptr || utf16.IsEmpty())
+    return;
+
+  UErrorCode status = U_ZERO_ERROR;
+  ubidi_setPara(pBidi, reinterpret_cast<const UChar*>(utf16.GetData()), static_cast<int32_t>(utf16.GetCount()), baseLevel, nullptr, &status);
+  const UBiDiLevel* pLevels = U_SUCCESS(status) ? ubidi_getLevels(pBidi, &status) : nullptr;
+  if (pLevels == nullptr || U_FAILURE(status))
+    return;
+
+  for (nsUInt32 i = 0; i < utf16.GetCount(); ++i)
+  {
+    const nsUInt32 uiEnd = i + 1 < offsets.GetCount() ? offsets[i + 1] : uiLength;
+    for (nsUInt32 uiByte = offsets[i]; uiByte < uiEnd; ++uiByte)
+      m_BidiLevels[uiByte] = pLevels[i];
+  }
+}
+
+void InlineParagraph::AddSegments(TextMeasureCache& in_cache, nsUInt32 in_uiStart, nsUInt32 in_uiEnd, bool in_bForcedBreak, nsUInt32& inout_uiItem)
+{
+  const std::string_view text(m_Text);
+
+  for (nsUInt32 uiStart = in_uiStart; uiStart < in_uiEnd;)
+  {
+    while (m_Items[inout_uiItem].m_uiEnd <= uiStart && inout_uiItem + 1 < m_Items.GetCount())
+      ++inout_uiItem;
+    const InlineItem& item = m_Items[inout_uiItem];
+
+    nsUInt32 uiEnd = nsMath::Min(in_uiEnd, nsMath::Max(item.m_uiEnd, uiStart + 1));
+    nsUInt8 uiLevel = 0;
+    if (!m_BidiLevels.IsEmpty())
+    {
+      uiLevel = m_BidiLevels[uiStart];
+      for (nsUInt32 i = uiStart + 1; i < uiEnd; ++i)
+      {
+        if (m_BidiLevels[i] != uiLevel)
+        {
+          uiEnd = i;
+          break;
+        }
+      }
+    }
+
+    // Trailing whitespace hangs at the end of a line, so it's measured on its own. It's almost always a single, cached space.
+    nsUInt32 uiContentEnd = uiEnd;
+    while (uiContentEnd > uiStart && (IsSpace(text[uiContentEnd - 1]) || IsNewline(text[uiContentEnd - 1])))
+      --uiContentEnd;
+
+    const float fContentWidth = uiContentEnd > uiStart ? in_cache.Measure(text.substr(uiStart, uiContentEnd - uiStart), item.m_uiFontKey, s_fInfinity).width : 0.0f;
+
+    float fTrailingWidth = 0.0f;
+    if (uiContentEnd < uiEnd)
+    {
+      // Newlines have no width.
+      std::string_view trailing = text.substr(uiContentEnd, uiEnd - uiContentEnd);
+      std::string spaces;
+      for (char c : trailing)
+      {
+        if (IsSpace(c))
+          spaces.push_back(c);
+      }
+      if (spaces.size() == trailing.size())
+        fTrailingWidth = in_cache.Measure(trailing, item.m_uiFontKey, s_fInfinity).width;
+      else if (!spaces.empty())
+        fTrailingWidth = in_cache.Measure(spaces, item.m_uiFontKey, s_fInfinity).width;
+    }
+
+    const bool bLast = uiEnd == in_uiEnd;
+
+    Segment& segment = m_Segments.ExpandAndGetRef();
+    segment.m_uiStart = uiStart;
+    segment.m_uiEnd = uiEnd;
+    segment.m_uiItem = inout_uiItem;
+    segment.m_fWidth = fContentWidth + fTrailingWidth;
+    segment.m_fTrailingWidth = fTrailingWidth;
+    segment.m_uiBidiLevel = uiLevel;
+    segment.m_bBoundary = bLast;
+    segment.m_bBreakAfter = bLast && (m_Style.m_bWrap || in_bForcedBreak);
+    segment.m_bForcedBreak = bLast && in_bForcedBreak;
+    ++m_Stats.m_uiSegments;
+
+    uiStart = uiEnd;
+  }
+}
+
+nsUInt32 InlineParagraph::FindLineEnd(nsUInt32 in_uiFirst, float in_fMaxWidth, nsUInt32& out_uiLastExamined) const
+{
+  const nsUInt32 uiCount = m_Segments.GetCount();
+
+  // Greedy: the line ends at the last opportunity before the first segment that doesn't fit. Without any opportunity the
+  // segment is put on the line anyway and overflows, as with overflow-wrap: normal.
+  float fX = 0.0f;
+  nsUInt32 uiBreak = s_uiNone;
+  for (nsUInt32 i = in_uiFirst; i < uiCount; ++i)
+  {
+    const Segment& segment = m_Segments[i];
+    if (uiBreak != s_uiNone && fX + segment.m_fWidth - segment.m_fTrailingWidth > in_fMaxWidth)
+    {
+      out_uiLastExamined = i;
+      return uiBreak;
+    }
+
+    fX += segment.m_fWidth;
+    if (segment.m_bBreakAfter)
+    {
+      uiBreak = i + 1;
+      if (segment.m_bForcedBreak)
+      {
+        out_uiLastExamined = i;
+        return uiBreak;
+      }
+    }
+  }
+
+  out_uiLastExamined = uiCount;
+  return uiCount;
+}
+
+InlineParagraph::LineExtent InlineParagraph::MeasureLine(TextMeasureCache& in_cache, nsUInt32 in_uiFirst, nsUInt32 in_uiEnd) const
+{
+  const FontMetrics strut = in_cache.GetFontMetrics(m_Style.m_uiFontKey);
+  const float fStrutHalfLeading = (GetLineHeight(m_Style.m_fLineHeight, strut) - strut.m_fAscent - strut.m_fDescent) * 0.5f;
+
+  LineExtent extent;
+  extent.m_fTop = -strut.m_fAscent - fStrutHalfLeading;
+  extent.m_fBottom = strut.m_fDescent + fStrutHalfLeading;
+
+  float fTopAligned = 0.0f;
+  float fBottomAligned = 0.0f;
+  nsUInt32 uiItem = s_uiNone;
+  for (nsUInt32 i = in_uiFirst; i < in_uiEnd; ++i)
+  {
+    const Segment& segment = m_Segments[i];
+    extent.m_fWidth += segment.m_fWidth;
+    if (segment.m_uiItem == uiItem)
+      continue;
+
+    uiItem = segment.m_uiItem;
+    const InlineItem& item = m_Items[uiItem];
+    const FontMetrics metrics = in_cache.GetFontMetrics(item.m_uiFontKey);
+    const float fLineHeight = GetLineHeight(item.m_fLineHeight, metrics);
+
+    if (item.m_VerticalAlign == VerticalAlign::Top)
+    {
+      fTopAligned = nsMath::Max(fTopAligned, fLineHeight);
+      continue;
+    }
+    if (item.m_VerticalAlign == VerticalAlign::Bottom)
+    {
+      fBottomAligned = nsMath::Max(fBottomAligned, fLineHeight);
+      continue;
+    }
+
+    const float fHalfLeading = (fLineHeight - metrics.m_fAscent - metrics.m_fDescent) * 0.5f;
+    const float fShift = GetBaselineShift(item, metrics, strut);
+    extent.m_fTop = nsMath::Min(extent.m_fTop, fShift - metrics.m_fAscent - fHalfLeading);
+    extent.m_fBottom = nsMath::Max(extent.m_fBottom, fShift + metrics.m_fDescent + fHalfLeading);
+  }
+
+  if (in_uiEnd > in_uiFirst)
+    extent.m_fWidth -= m_Segments[in_uiEnd - 1].m_fTrailingWidth;
+
+  // Top and bottom aligned items are placed against the line box, they only make it higher if they don't fit.
+  extent.m_fBottom = nsMath::Max(extent.m_fBottom, extent.m_fTop + fTopAligned);
+  extent.m_fTop = nsMath::Min(extent.m_fTop, extent.m_fBottom - fBottomAligned);
+  return extent;
+}
+
+Size InlineParagraph::BuildLines(TextMeasureCache& in_cache, float in_fMaxWidth, bool in_bStore)
+{
+  NS_PROFILE_SCOPE("InlineParagraph::BuildLines");
+
+  nsUInt32 uiFirst = 0;
+  float fY = 0.0f;
+  if (in_bStore && !m_Lines.IsEmpty())
+  {
+    uiFirst = m_LineRanges.PeekBack().m_uiEndSegment;
+    fY = m_Lines.PeekBack().m_fY + m_Lines.PeekBack().m_fHeight;
+  }
+
+  Size size;
+  while (uiFirst < m_Segments.GetCount())
+  {
+    nsUInt32 uiLastExamined = 0;
+    const nsUInt32 uiEnd = FindLineEnd(uiFirst, in_fMaxWidth, uiLastExamined);
+
+    if (in_bStore)
+    {
+      PlaceLine(in_cache, uiFirst, uiEnd, fY, in_fMaxWidth);
+      fY += m_Lines.PeekBack().m_fHeight;
+
+      LineRange& range = m_LineRanges.ExpandAndGetRef();
+      range.m_uiFirstSegment = uiFirst;
+      range.m_uiEndSegment = uiEnd;
+      range.m_uiLastExamined = uiLastExamined;
+    }
+    else
+    {
+      const LineExtent extent = MeasureLine(in_cache, uiFirst, uiEnd);
+      fY += extent.m_fBottom - extent.m_fTop;
+      size.width = nsMath::Max(size.width, extent.m_fWidth);
+    }
+    uiFirst = uiEnd;
+  }
+
+  if (in_bStore)
+  {
+    for (const InlineLine& line : m_Lines)
+      size.width = nsMath::Max(size.width, line.m_fWidth);
+    m_bLinesComplete = true;
+  }
+  size.height = fY;
+  return size;
+}
+
+void InlineParagraph::PlaceLine(TextMeasureCache& in_cache, nsUInt32 in_uiFirst, nsUInt32 in_uiEnd, float in_fY, float in_fMaxWidth)
+{
+  const LineExtent extent = MeasureLine(in_cache, in_uiFirst, in_uiEnd);
+
+  InlineLine& line = m_Lines.ExpandAndGetRef();
+  line.m_uiFirstFragment = m_Fragments.GetCount();
+  line.m_fY = in_fY;
+  line.m_fHeight = extent.m_fBottom - extent.m_fTop;
+  line.m_fBaseline = in_fY - extent.m_fTop;
+  line.m_fWidth = extent.m_fWidth;
+
+  // Fragments in logical order, consecutive segments of the same item and level are merged.
+  for (nsUInt32 i = in_uiFirst; i < in_uiEnd; ++i)
+  {
+    const Segment& segment = m_Segments[i];
+    if (m_Fragments.GetCount() > line.m_uiFirstFragment && m_Fragments.PeekBack().m_uiItem == segment.m_uiItem && m_Fragments.PeekBack().m_uiBidiLevel == segment.m_uiBidiLevel)
+    {
+      m_Fragments.PeekBack().m_uiEnd = segment.m_uiEnd;
+      m_Fragments.PeekBack().m_fWidth += segment.m_fWidth;
+      continue;
+    }
+
+    InlineFragment& fragment = m_Fragments.ExpandAndGetRef();
+    fragment.m_uiItem = segment.m_uiItem;
+    fragment.m_uiStart = segment.m_uiStart;
+    fragment.m_uiEnd = segment.m_uiEnd;
+    fragment.m_fX = 0.0f;
+    fragment.m_fWidth = segment.m_fWidth;
+    fragment.m_uiBidiLevel = segment.m_uiBidiLevel;
+  }
+  if (in_uiEnd > in_uiFirst)
+    m_Fragments.PeekBack().m_fWidth -= m_Segments[in_uiEnd - 1].m_fTrailingWidth;
+  line.m_uiFragmentCount = m_Fragments.GetCount() - line.m_uiFirstFragment;
+
+  nsArrayPtr<InlineFragment> fragments = m_Fragments.GetArrayPtr().GetSubArray(line.m_uiFirstFragment, line.m_uiFragmentCount);
+
+  const FontMetrics strut = in_cache.GetFontMetrics(m_Style.m_uiFontKey);
+  for (InlineFragment& fragment : fragments)
+  {
+    const InlineItem& item = m_Items[fragment.m_uiItem];
+    const FontMetrics metrics = in_cache.GetFontMetrics(item.m_uiFontKey);
+    const float fHalfLeading = (GetLineHeight(item.m_fLineHeight, metrics) - metrics.m_fAscent - metrics.m_fDescent) * 0.5f;
+
+    if (item.m_VerticalAlign == VerticalAlign::Top)
+      fragment.m_fY = line.m_fY + fHalfLeading;
+    else if (item.m_VerticalAlign == VerticalAlign::Bottom)
+      fragment.m_fY = line.m_fY + line.m_fHeight - fHalfLeading - metrics.m_fAscent - metrics.m_fDescent;
+    else
+      fragment.m_fY = line.m_fBaseline + GetBaselineShift(item, metrics, strut) - metrics.m_fAscent;
+
+    fragment.m_fHeight = metrics.m_fAscent + metrics.m_fDescent;
+    fragment.m_fBaseline = fragment.m_fY + metrics.m_fAscent;
+  }
+
+  // Visual order (UAX #9 L2).
+  if (!m_BidiLevels.IsEmpty() && fragments.GetCount() > 1)
+  {
+    nsHybridArray<UBiDiLevel, 16> levels;
+    nsHybridArray<int32_t, 16> visualToLogical;
+    nsHybridArray<InlineFragment, 16> logical;
+    levels.SetCount(fragments.GetCount());
+    visualToLogical.SetCount(fragments.GetCount());
+    logical = fragments;
+    for (nsUInt32 i = 0; i < fragments.GetCount(); ++i)
+      levels[i] = fragments[i].m_uiBidiLevel;
+
+    ubidi_reorderVisual(levels.GetData(), static_cast<int32_t>(levels.GetCount()), visualToLogical.GetData());
+    for (nsUInt32 i = 0; i < fragments.GetCount(); ++i)
+      fragments[i] = logical[visualToLogical[i]];
+  }
+
+  // Lines that overflow are start aligned. Justify isn't supported and is start aligned as well.
+  float fX = 0.0f;
+  const float fFreeSpace = in_fMaxWidth - extent.m_fWidth;
+  if (std::isfinite(in_fMaxWidth) && fFreeSpace > 0.0f)
+  {
+    switch (m_Style.m_Align)
+    {
+      case font::ETextAlignment::Left:
+        break;
+      case font::ETextAlignment::Right:
+        fX = fFreeSpace;
+        break;
+      case font::ETextAlignment::Center:
+        fX = fFreeSpace * 0.5f;
+        break;
+      case font::ETextAlignment::End:
+        fX = m_Style.m_bRightToLeft ? 0.0f : fFreeSpace;
+        break;
+      default:
+        fX = m_Style.m_bRightToLeft ? fFreeSpace : 0.0f;
+        break;
+    }
+  }
+
+  for (InlineFragment& fragment : fragments)
+  {
+    fragment.m_fX = fX;
+    fX += fragment.m_fWidth;
+  }
+  ++m_Stats.m_uiLines;
+}
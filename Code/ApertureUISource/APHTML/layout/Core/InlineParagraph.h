@@ -0,0 +1,243 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <APHTML/Font/TextAlignment.h>
+#include <APHTML/layout/Core/LayoutCore.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <string>
+#include <string_view>
+
+namespace aperture::layout
+{
+  class TextMeasureCache;
+
+  /// @brief A run of text with one style. The items of a paragraph cover its text in order, without gaps.
+  struct InlineItem
+  {
+    NS_DECLARE_POD_TYPE();
+
+    /// @brief Byte range in the UTF-8 text of the paragraph.
+    nsUInt32 m_uiStart;
+    nsUInt32 m_uiEnd;
+    nsUInt64 m_uiFontKey;
+    /// @brief Negative for line-height: normal.
+    float m_fLineHeight;
+    /// @brief How far the baseline is raised, for VerticalAlign::Length.
+    float m_fBaselineOffset;
+    VerticalAlign m_VerticalAlign;
+    /// @brief Not used by the paragraph, e.g. the box the text belongs to.
+    nsUInt32 m_uiOwner;
+  };
+
+  /// @brief The style of the box the inline content belongs to.
+  struct InlineParagraphStyle
+  {
+    /// @brief Every line is at least as high as the font and line height of the box (the strut of CSS 2 10.8.1).
+    nsUInt64 m_uiFontKey = 0;
+    float m_fLineHeight = -1.0f;
+    font::ETextAlignment m_Align = font::ETextAlignment::Start;
+    /// @brief False for white-space: nowrap and pre, only forced breaks end a line.
+    bool m_bWrap = true;
+    bool m_bRightToLeft = false;
+  };
+
+  /// @brief The part of one item on one line.
+  struct InlineFragment
+  {
+    NS_DECLARE_POD_TYPE();
+
+    nsUInt32 m_uiItem;
+    /// @brief Byte range in the text of the paragraph, in logical order. Right to left fragments are shaped right to left.
+    nsUInt32 m_uiStart;
+    nsUInt32 m_uiEnd;
+
+    /// @brief The content area of the fragment, relative to the content box of the paragraph.
+    float m_fX;
+    float m_fY;
+    float m_fWidth;
+    float m_fHeight;
+    float m_fBaseline;
+
+    /// @brief The resolved bidi level, odd levels are right to left.
+    nsUInt8 m_uiBidiLevel;
+  };
+
+  struct InlineLine
+  {
+    NS_DECLARE_POD_TYPE();
+
+    /// @brief The fragments of the line, in visual order from left to right.
+    nsUInt32 m_uiFirstFragment;
+    nsUInt32 m_uiFragmentCount;
+
+    float m_fY;
+    float m_fHeight;
+    float m_fBaseline;
+    /// @brief Without the whitespace that hangs at the end of the line.
+    float m_fWidth;
+  };
+
+  /*
+   * @brief Lays out the inline content of one block box: breaks it into lines and places the fragments of the lines.
+   *
+   * The text is split into segments at the line break opportunities of UAX #14, at item boundaries and, if the content
+   * has any right to left text, at changes of the bidi level (UAX #9). Both come from ICU. Every segment is measured once
+   * through the TextMeasureCache, so breaking lines is only adding up widths; shaping across segment boundaries (e.g.
+   * kerning between a word and the following space) is ignored.
+   *
+   * Lines are built greedily and vertically aligned as in CSS 2 10.8: every fragment is placed by its vertical-align
+   * relative to the baseline of the strut, top and bottom aligned fragments relative to the line box. Fragments are
+   * reordered per line with the bidi levels.
+   *
+   * Everything is kept until the content changes, and then only the part after the first change is done again: text
+   * appended to a log or chat panel is segmented and broken into lines from the last lines on, the lines before it are
+   * kept. Right to left content is segmented again as a whole, since its bidi levels depend on the whole paragraph.
+   *
+   * The lines are built for one width, the width the box had in its last layout. Measure() for other widths (e.g. the
+   * max-content size Yoga asks for in flex rows) doesn't touch them, its results are kept for a few widths instead.
+   *
+   * @note Not thread-safe. ICU objects are cached per thread, so different paragraphs can be laid out in parallel.
+   */
+  class NS_APERTURE_DLL InlineParagraph
+  {
+  public:
+    struct Stats
+    {
+      /// @brief Segments that were created and measured.
+      nsUInt32 m_uiSegments = 0;
+      /// @brief Lines that were built and placed, measuring other widths is not counted.
+      nsUInt32 m_uiLines = 0;
+    };
+
+    /// @brief Sets the content, returns false if neither text, items nor style changed.
+    bool SetContent(std::string_view in_text, nsArrayPtr<const InlineItem> in_items, const InlineParagraphStyle& in_style);
+
+    /// @brief Drops everything that was measured, e.g. when fonts were reloaded.
+    void MarkDirty();
+
+    /// @brief The size of the content wrapped at in_fMaxWidth (infinity or NaN to only break at forced breaks).
+    Size Measure(TextMeasureCache& in_cache, float in_fMaxWidth);
+
+    /// @brief Builds the lines for the width of the content box.
+    void Layout(TextMeasureCache& in_cache, float in_fWidth);
+
+    const std::string& GetText() const { return m_Text; }
+    nsArrayPtr<const InlineItem> GetItems() const { return m_Items; }
+
+    /// @brief The lines and fragments of the last Layout().
+    nsArrayPtr<const InlineLine> GetLines() const { return m_Lines; }
+    nsArrayPtr<const InlineFragment> GetFragments() const { return m_Fragments; }
+
+    const Stats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+  private:
+    struct Segment
+    {
+      NS_DECLARE_POD_TYPE();
+
+      nsUInt32 m_uiStart;
+      nsUInt32 m_uiEnd;
+      nsUInt32 m_uiItem;
+      /// @brief Including the trailing whitespace, which hangs if the line ends after the segment.
+      float m_fWidth;
+      float m_fTrailingWidth;
+      nsUInt8 m_uiBidiLevel;
+      /// @brief The segment ends at a break opportunity of UAX #14, lines may end after it if wrapping is allowed.
+      bool m_bBoundary;
+      bool m_bBreakAfter;
+      bool m_bForcedBreak;
+    };
+
+    /// @brief Which segments make up a line, to find the lines that are still valid when segments are replaced.
+    struct LineRange
+    {
+      NS_DECLARE_POD_TYPE();
+
+      nsUInt32 m_uiFirstSegment;
+      nsUInt32 m_uiEndSegment;
+      /// @brief The last segment that was looked at to end the line.
+      nsUInt32 m_uiLastExamined;
+    };
+
+    struct LineExtent
+    {
+      /// @brief Relative to the baseline.
+      float m_fTop = 0.0f;
+      float m_fBottom = 0.0f;
+      float m_fWidth = 0.0f;
+    };
+
+    struct MeasuredSize
+    {
+      float m_fMaxWidth = -1.0f;
+      Size m_Size;
+    };
+
+    void UpdateSegments(TextMeasureCache& in_cache);
+    void ComputeBidiLevels();
+    void AddSegments(TextMeasureCache& in_cache, nsUInt32 in_uiStart, nsUInt32 in_uiEnd, bool in_bForcedBreak, nsUInt32& inout_uiItem);
+
+    /// @brief Breaks the segments into lines. If in_bStore is false only the size is computed.
+    Size BuildLines(TextMeasureCache& in_cache, float in_fMaxWidth, bool in_bStore);
+    nsUInt32 FindLineEnd(nsUInt32 in_uiFirst, float in_fMaxWidth, nsUInt32& out_uiLastExamined) const;
+    LineExtent MeasureLine(TextMeasureCache& in_cache, nsUInt32 in_uiFirst, nsUInt32 in_uiEnd) const;
+    void PlaceLine(TextMeasureCache& in_cache, nsUInt32 in_uiFirst, nsUInt32 in_uiEnd, float in_fY, float in_fMaxWidth);
+
+    std::string m_Text;
+    nsDynamicArray<InlineItem> m_Items;
+    InlineParagraphStyle m_Style;
+
+    nsDynamicArray<Segment> m_Segments;
+    /// @brief Per byte, empty if the content is left to right only.
+    nsDynamicArray<nsUInt8> m_BidiLevels;
+    /// @brief Segments from this byte on are outdated, 0xFFFFFFFF if none are.
+    nsUInt32 m_uiDirtyOffset = 0;
+
+    nsDynamicArray<InlineLine> m_Lines;
+    nsDynamicArray<LineRange> m_LineRanges;
+    nsDynamicArray<InlineFragment> m_Fragments;
+    float m_fLinesWidth = -1.0f;
+    bool m_bLinesComplete = false;
+    Size m_LinesSize;
+
+    MeasuredSize m_Measured[2];
+    nsUInt32 m_uiNextMeasured = 0;
+
+    Stats m_Stats;
+  };
+} // namespace aperture::layout
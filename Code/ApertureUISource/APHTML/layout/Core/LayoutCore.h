@@ -38,7 +38,6 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <APHTML/APEngineCommonIncludes.h>
 #include <APHTML/layout/Core/LayoutDefinitions.h>
 #include <vector>
-#include <yoga/YGValue.h>
 
 namespace aperture::layout
 {
@@ -140,7 +139,7 @@ namespace aperture::layout
     // performing layout calculations.
     LAYOUT_BOX_BREAK = 0x200
   };
-  enum class VerticalAlign
+  enum class VerticalAlign : nsUInt8
   {
     Baseline,
     Sub,
@@ -148,24 +147,9 @@ namespace aperture::layout
     TextTop,
     TextBottom,
     Middle,
-    Length
-  };
-  struct LayoutConfig
-  {
-    Display display = Display::Flex;
-    FlexDirection flexDirection = FlexDirection::Row;
-    Align alignItems = Align::Stretch;
-    JustifyContent justifyContent = JustifyContent::Start;
-    PositionType positionType = PositionType::Relative;
-    float flexGrow = 0.0f;
-    float flexShrink = 1.0f;
-    float width = YGUndefined; // Undefined by default (Yoga-compatible)
-    float height = YGUndefined;
-
-    // Margins, paddings, etc.
-    float marginTop = 0.0f;
-    float marginBottom = 0.0f;
-    float marginLeft = 0.0f;
-    float marginRight = 0.0f;
+    Length,
+    /// @brief Aligned to the line box instead of the baseline of the parent.
+    Top,
+    Bottom
   };
 } // namespace aperture::layout
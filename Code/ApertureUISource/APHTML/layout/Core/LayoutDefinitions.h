@@ -37,32 +37,6 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace aperture::layout
 {
-  class LayoutNode;
-  class Style;
-
-  enum class Direction
-  {
-    Row,
-    Column
-  };
-  enum class JustifyContent
-  {
-    FlexStart,
-    Start,
-    Center,
-    End,
-    SpaceBetween,
-    SpaceAround,
-    SpaceEvenly
-  };
-  enum class AlignItems
-  {
-    Start,
-    Center,
-    End,
-    Stretch
-  };
-
   struct Size
   {
     float width = 0;
@@ -74,36 +48,4 @@ namespace aperture::layout
     float x = 0;
     float y = 0;
   };
-
-  class Style
-  {
-  public:
-    Direction direction = Direction::Row;
-    JustifyContent justifyContent = JustifyContent::Start;
-    AlignItems alignItems = AlignItems::Start;
-    float gap = 0;
-    Size padding{};
-    Size margin{};
-    float flexGrow = 0;
-    float flexShrink = 1;
-    float flexBasis = 0;
-
-    // Grid specific properties
-    int gridColumnStart = 0;
-    int gridColumnEnd = 0;
-    int gridRowStart = 0;
-    int gridRowEnd = 0;
-  };
-  enum class GridSizeType
-  {
-    Fixed,      // Absolute size (e.g., in px)
-    Fractional, // Fractional size (e.g., 1fr, 2fr)
-    Auto        // Automatically determined size
-  };
-
-  struct GridSize
-  {
-    GridSizeType type; // Type of the size
-    float value;       // Value for the size (ignored for Auto)
-  };
-} // namespace aperture::layout
+} // namespace aperture::layout
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <APHTML/layout/Core/LayoutFragmentCache.h>
+#include <Foundation/Algorithm/HashingUtils.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+using namespace aperture;
+using namespace aperture::layout;
+
+namespace
+{
+  // Yoga passes NaN for unconstrained axes, which doesn't compare equal to itself.
+  float NormalizeAvailable(float in_fSize)
+  {
+    return std::isnan(in_fSize) ? std::numeric_limits<float>::infinity() : in_fSize;
+  }
+} // namespace
+
+LayoutFragmentCache::LayoutFragmentCache(nsUInt32 in_uiGenerationSize, nsUInt32 in_uiMaxBoxes)
+  : m_uiGenerationSize(nsMath::Max(in_uiGenerationSize, 1u))
+  , m_uiMaxBoxes(in_uiMaxBoxes)
+{
+}
+
+nsUInt64 LayoutFragmentCache::MakeKey(const Entry& in_entry)
+{
+  nsUInt32 uiWidthBits = 0;
+  nsUInt32 uiHeightBits = 0;
+  memcpy(&uiWidthBits, &in_entry.m_fWidth, sizeof(float));
+  memcpy(&uiHeightBits, &in_entry.m_fHeight, sizeof(float));
+
+  const nsUInt64 parts[3] = {static_cast<nsUInt64>(reinterpret_cast<std::uintptr_t>(in_entry.m_pStyle)), in_entry.m_uiContentHash, (static_cast<nsUInt64>(uiWidthBits) << 32) | uiHeightBits};
+  return nsHashingUtils::xxHash64(parts, sizeof(parts));
+}
+
+const LayoutFragment* LayoutFragmentCache::Find(const css::ComputedStyle* in_pStyle, nsUInt64 in_uiContentHash, float in_fWidth, float in_fHeight)
+{
+  Entry key;
+  key.m_pStyle = in_pStyle;
+  key.m_uiContentHash = in_uiContentHash;
+  key.m_fWidth = NormalizeAvailable(in_fWidth);
+  key.m_fHeight = NormalizeAvailable(in_fHeight);
+  const nsUInt64 uiKey = MakeKey(key);
+
+  auto matches = [&](const Entry& other)
+  {
+    return other.m_pStyle == key.m_pStyle && other.m_uiContentHash == key.m_uiContentHash && other.m_fWidth == key.m_fWidth && other.m_fHeight == key.m_fHeight;
+  };
+
+  if (const Entry* pEntry = m_Current.GetValue(uiKey); pEntry != nullptr && matches(*pEntry))
+  {
+    ++m_Stats.m_uiHits;
+    return &pEntry->m_Fragment;
+  }
+
+  // Hits in the old generation are moved back, so fragments that are still in use survive.
+  Entry old;
+  if (m_Old.Remove(uiKey, &old) && matches(old))
+  {
+    ++m_Stats.m_uiHits;
+    Insert(in_pStyle, in_uiContentHash, in_fWidth, in_fHeight, std::move(old.m_Fragment));
+    return &m_Current.GetValue(uiKey)->m_Fragment;
+  }
+
+  ++m_Stats.m_uiMisses;
+  return nullptr;
+}
+
+void LayoutFragmentCache::Insert(const css::ComputedStyle* in_pStyle, nsUInt64 in_uiContentHash, float in_fWidth, float in_fHeight, LayoutFragment&& in_fragment)
+{
+  Entry entry;
+  entry.m_pStyle = in_pStyle;
+  entry.m_uiContentHash = in_uiContentHash;
+  entry.m_fWidth = NormalizeAvailable(in_fWidth);
+  entry.m_fHeight = NormalizeAvailable(in_fHeight);
+  entry.m_Fragment = std::move(in_fragment);
+
+  if (m_Current.GetCount() >= m_uiGenerationSize)
+  {
+    m_Old.Swap(m_Current);
+    m_Current.Clear();
+  }
+  m_Current.Insert(MakeKey(entry), std::move(entry));
+}
+
+void LayoutFragmentCache::Clear()
+{
+  m_Current.Clear();
+  m_Old.Clear();
+}
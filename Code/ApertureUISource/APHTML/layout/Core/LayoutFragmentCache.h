@@ -0,0 +1,129 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Math/Rect.h>
+
+namespace aperture::css
+{
+  class ComputedStyle;
+} // namespace aperture::css
+
+namespace aperture::layout
+{
+  /// @brief The geometry of one block-level box of a LayoutFragment.
+  struct LayoutFragmentBox
+  {
+    NS_DECLARE_POD_TYPE();
+
+    /// @brief The border box, relative to the border box of the parent. The one of the root includes its top and left margin.
+    nsRectFloat m_Rect;
+    /// @brief The content box, relative to the border box.
+    nsRectFloat m_ContentBox;
+  };
+
+  /// @brief The layout of a subtree: its block-level boxes in pre-order. Inline content is placed again from its paragraph.
+  struct LayoutFragment
+  {
+    nsDynamicArray<LayoutFragmentBox> m_Boxes;
+    float m_fMarginRight = 0.0f;
+    float m_fMarginBottom = 0.0f;
+  };
+
+  /*
+   * @brief Caches the layout of subtrees by (style of the root, content hash, available size).
+   *
+   * Pages repeat the same component (rows, buttons, cards) many times with the same styles and text. The first one that
+   * is laid out stores its boxes relative to its root, every identical one after it copies them instead of running Yoga.
+   * The content hash is computed by the LayoutTree over the structure, the style of every box and the text, so a hit
+   * reproduces the layout exactly unless two different subtrees collide in all 64 bits of it.
+   *
+   * Trees only use the cache for subtrees of at most in_uiMaxBoxes boxes, larger ones are unlikely to repeat and too
+   * expensive to hash and copy. Entries live in two generations like the ones of the TextMeasureCache.
+   *
+   * The cache can be shared by any number of trees that use the same TextMeasureCache.
+   *
+   * @note Not thread-safe. It is owned by the thread that runs layout.
+   */
+  class NS_APERTURE_DLL LayoutFragmentCache
+  {
+  public:
+    struct Stats
+    {
+      nsUInt32 m_uiHits = 0;
+      nsUInt32 m_uiMisses = 0;
+    };
+
+    LayoutFragmentCache(nsUInt32 in_uiGenerationSize = 1024, nsUInt32 in_uiMaxBoxes = 256);
+
+    /// @param in_fWidth, in_fHeight The available size, NaN for an unconstrained axis.
+    /// @return Null if there is no fragment for the key. Only valid until the next Insert().
+    const LayoutFragment* Find(const css::ComputedStyle* in_pStyle, nsUInt64 in_uiContentHash, float in_fWidth, float in_fHeight);
+    void Insert(const css::ComputedStyle* in_pStyle, nsUInt64 in_uiContentHash, float in_fWidth, float in_fHeight, LayoutFragment&& in_fragment);
+
+    /// @brief Subtrees with more boxes are not cached.
+    nsUInt32 GetMaxBoxCount() const { return m_uiMaxBoxes; }
+
+    /// @brief Has to be called when fonts are (re)loaded, together with TextMeasureCache::Clear().
+    void Clear();
+
+    nsUInt32 GetCount() const { return m_Current.GetCount() + m_Old.GetCount(); }
+    const Stats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+  private:
+    struct Entry
+    {
+      /// @brief The table key is a hash of these fields, which are compared on lookup as well. The content of the
+      /// subtree is only known by its 64 bit hash, subtrees with the same style, size and content hash share a fragment.
+      const css::ComputedStyle* m_pStyle = nullptr;
+      nsUInt64 m_uiContentHash = 0;
+      float m_fWidth = 0.0f;
+      float m_fHeight = 0.0f;
+      LayoutFragment m_Fragment;
+    };
+
+    static nsUInt64 MakeKey(const Entry& in_entry);
+
+    nsHashTable<nsUInt64, Entry> m_Current;
+    nsHashTable<nsUInt64, Entry> m_Old;
+    nsUInt32 m_uiGenerationSize = 0;
+    nsUInt32 m_uiMaxBoxes = 0;
+    Stats m_Stats;
+  };
+} // namespace aperture::layout
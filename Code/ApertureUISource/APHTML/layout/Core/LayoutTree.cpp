@@ -0,0 +1,2215 @@
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <APHTML/css/Style/ComputedStyle.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/LayoutFragmentCache.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+#include <APHTML/layout/Core/TextMeasureCache.h>
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Threading/TaskSystem.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+using namespace aperture;
+using namespace aperture::layout;
+using css::ComputedStyle;
+using css::CSSValue;
+using css::parser::CSSToken;
+using css::parser::CSSTokenType;
+
+namespace
+{
+  struct LayoutKeywords
+  {
+    core::Atom m_None = core::MakeAtom("none");
+    core::Atom m_Inline = core::MakeAtom("inline");
+    core::Atom m_Flex = core::MakeAtom("flex");
+    core::Atom m_InlineFlex = core::MakeAtom("inline-flex");
+    core::Atom m_Grid = core::MakeAtom("grid");
+    core::Atom m_InlineGrid = core::MakeAtom("inline-grid");
+
+    core::Atom m_Auto = core::MakeAtom("auto");
+    core::Atom m_Absolute = core::MakeAtom("absolute");
+    core::Atom m_Fixed = core::MakeAtom("fixed");
+    core::Atom m_BorderBox = core::MakeAtom("border-box");
+    core::Atom m_Hidden = core::MakeAtom("hidden");
+    core::Atom m_Clip = core::MakeAtom("clip");
+    core::Atom m_Scroll = core::MakeAtom("scroll");
+
+    core::Atom m_RowReverse = core::MakeAtom("row-reverse");
+    core::Atom m_Column = core::MakeAtom("column");
+    core::Atom m_ColumnReverse = core::MakeAtom("column-reverse");
+    core::Atom m_Wrap = core::MakeAtom("wrap");
+    core::Atom m_WrapReverse = core::MakeAtom("wrap-reverse");
+
+    core::Atom m_FlexStart = core::MakeAtom("flex-start");
+    core::Atom m_Start = core::MakeAtom("start");
+    core::Atom m_Left = core::MakeAtom("left");
+    core::Atom m_Center = core::MakeAtom("center");
+    core::Atom m_FlexEnd = core::MakeAtom("flex-end");
+    core::Atom m_End = core::MakeAtom("end");
+    core::Atom m_Right = core::MakeAtom("right");
+    core::Atom m_SpaceBetween = core::MakeAtom("space-between");
+    core::Atom m_SpaceAround = core::MakeAtom("space-around");
+    core::Atom m_SpaceEvenly = core::MakeAtom("space-evenly");
+    core::Atom m_Stretch = core::MakeAtom("stretch");
+    core::Atom m_Baseline = core::MakeAtom("baseline");
+
+    core::Atom m_Italic = core::MakeAtom("italic");
+    core::Atom m_Oblique = core::MakeAtom("oblique");
+    core::Atom m_Bold = core::MakeAtom("bold");
+    core::Atom m_Bolder = core::MakeAtom("bolder");
+    core::Atom m_Lighter = core::MakeAtom("lighter");
+    core::Atom m_Pre = core::MakeAtom("pre");
+    core::Atom m_PreWrap = core::MakeAtom("pre-wrap");
+    core::Atom m_BreakSpaces = core::MakeAtom("break-spaces");
+    core::Atom m_Nowrap = core::MakeAtom("nowrap");
+    core::Atom m_Normal = core::MakeAtom("normal");
+    core::Atom m_Rtl = core::MakeAtom("rtl");
+    core::Atom m_Justify = core::MakeAtom("justify");
+
+    core::Atom m_Sub = core::MakeAtom("sub");
+    core::Atom m_Super = core::MakeAtom("super");
+    core::Atom m_TextTop = core::MakeAtom("text-top");
+    core::Atom m_TextBottom = core::MakeAtom("text-bottom");
+    core::Atom m_Middle = core::MakeAtom("middle");
+    core::Atom m_Top = core::MakeAtom("top");
+    core::Atom m_Bottom = core::MakeAtom("bottom");
+  };
+
+  const LayoutKeywords& GetKeywords()
+  {
+    static const LayoutKeywords s_Keywords;
+    return s_Keywords;
+  }
+
+  const ComputedStyle* GetStyle(const dom::DOMElement& in_element)
+  {
+    const ComputedStyle* pStyle = in_element.getComputedStyle();
+    return pStyle != nullptr ? pStyle : &ComputedStyle::GetInitialStyle();
+  }
+
+  bool IsDisplayNone(const ComputedStyle& in_style)
+  {
+    return in_style.Get(PropertyId::Display).IsKeyword(GetKeywords().m_None);
+  }
+
+  LayoutBoxType GetContainerType(const ComputedStyle& in_style)
+  {
+    const LayoutKeywords& keywords = GetKeywords();
+    const CSSValue& display = in_style.Get(PropertyId::Display);
+    if (display.IsKeyword(keywords.m_Flex) || display.IsKeyword(keywords.m_InlineFlex))
+      return LayoutBoxType::Flex;
+    if (display.IsKeyword(keywords.m_Grid) || display.IsKeyword(keywords.m_InlineGrid))
+      return LayoutBoxType::Grid;
+    return LayoutBoxType::Block;
+  }
+
+  const dom::DOMElement* AsElement(const dom::DOMNode& in_node)
+  {
+    return in_node.getNodeType() == dom::DOMNodeType::ELEMENT_NODE ? static_cast<const dom::DOMElement*>(&in_node) : nullptr;
+  }
+
+  bool IsVirtualized(const dom::DOMElement& in_element)
+  {
+    return in_element.getAttributes().count("virtualize") != 0;
+  }
+
+  LayoutBoxType GetBlockBoxType(const dom::DOMElement& in_element, const ComputedStyle& in_style)
+  {
+    return IsVirtualized(in_element) ? LayoutBoxType::VirtualList : GetContainerType(in_style);
+  }
+
+  // Inline elements that contain blocks are laid out as blocks, instead of splitting them around the blocks as CSS 2 does.
+  // Atomic inlines (inline-block, inline-flex) and virtualized containers are laid out as blocks as well.
+  bool IsBlockLevel(const dom::DOMElement& in_element)
+  {
+    const ComputedStyle& style = *GetStyle(in_element);
+    if (!style.Get(PropertyId::Display).IsKeyword(GetKeywords().m_Inline) || IsVirtualized(in_element))
+      return true;
+
+    for (const std::shared_ptr<dom::DOMNode>& pChild : in_element.getChildNodes())
+    {
+      const dom::DOMElement* pElement = pChild != nullptr ? AsElement(*pChild) : nullptr;
+      if (pElement != nullptr && !IsDisplayNone(*GetStyle(*pElement)) && (!GetStyle(*pElement)->Get(PropertyId::Display).IsKeyword(GetKeywords().m_Inline) || IsVirtualized(*pElement)))
+        return true;
+    }
+    return false;
+  }
+
+  bool IsWhitespace(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+  }
+
+  bool IsWhitespaceOnly(std::string_view in_text)
+  {
+    for (char c : in_text)
+    {
+      if (!IsWhitespace(c))
+        return false;
+    }
+    return true;
+  }
+
+  void AppendText(std::string& inout_text, std::string_view in_text, bool in_bCollapse)
+  {
+    if (!in_bCollapse)
+    {
+      inout_text.append(in_text);
+      return;
+    }
+
+    // Runs of whitespace become a single space, leading whitespace of the content is dropped.
+    for (char c : in_text)
+    {
+      if (!IsWhitespace(c))
+        inout_text.push_back(c);
+      else if (!inout_text.empty() && inout_text.back() != ' ')
+        inout_text.push_back(' ');
+    }
+  }
+
+  bool ToPixels(const CSSValue& in_value, float& out_fPixels)
+  {
+    switch (in_value.m_Unit)
+    {
+      case core::Unit::PX:
+      case core::Unit::NUMBER:
+      case core::Unit::DP:
+        out_fPixels = in_value.m_fNumber;
+        return true;
+      case core::Unit::INCH:
+        out_fPixels = in_value.m_fNumber * 96.0f;
+        return true;
+      case core::Unit::CM:
+        out_fPixels = in_value.m_fNumber * 96.0f / 2.54f;
+        return true;
+      case core::Unit::MM:
+        out_fPixels = in_value.m_fNumber * 96.0f / 25.4f;
+        return true;
+      case core::Unit::PT:
+        out_fPixels = in_value.m_fNumber * 96.0f / 72.0f;
+        return true;
+      case core::Unit::PC:
+        out_fPixels = in_value.m_fNumber * 16.0f;
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  float ToPixelsOrZero(const CSSValue& in_value)
+  {
+    float fPixels = 0.0f;
+    return ToPixels(in_value, fPixels) ? fPixels : 0.0f;
+  }
+
+  bool IsPercent(const CSSValue& in_value)
+  {
+    return in_value.m_Unit == core::Unit::PERCENT;
+  }
+
+  nsUInt64 MakeFontKey(const ComputedStyle& in_style)
+  {
+    const LayoutKeywords& keywords = GetKeywords();
+
+    const CSSValue& weight = in_style.Get(PropertyId::FontWeight);
+    nsUInt16 uiWeight = 400;
+    if (weight.IsNumeric())
+      uiWeight = static_cast<nsUInt16>(weight.m_fNumber);
+    else if (weight.IsKeyword(keywords.m_Bold) || weight.IsKeyword(keywords.m_Bolder))
+      uiWeight = 700;
+    else if (weight.IsKeyword(keywords.m_Lighter))
+      uiWeight = 300;
+
+    const CSSValue& fontStyle = in_style.Get(PropertyId::FontStyle);
+    const bool bItalic = fontStyle.IsKeyword(keywords.m_Italic) || fontStyle.IsKeyword(keywords.m_Oblique);
+
+    return TextMeasureCache::MakeFontKey(in_style.GetString(PropertyId::FontFamily), in_style.Get(PropertyId::FontSize).m_fNumber, uiWeight, bItalic);
+  }
+
+  // Negative for normal.
+  float GetLineHeight(const ComputedStyle& in_style)
+  {
+    const CSSValue& lineHeight = in_style.Get(PropertyId::LineHeight);
+    const float fFontSize = in_style.Get(PropertyId::FontSize).m_fNumber;
+    if (lineHeight.m_Unit == core::Unit::NUMBER)
+      return lineHeight.m_fNumber * fFontSize;
+    if (lineHeight.m_Unit == core::Unit::PERCENT)
+      return lineHeight.m_fNumber * 0.01f * fFontSize;
+
+    float fPixels = 0.0f;
+    return ToPixels(lineHeight, fPixels) ? fPixels : -1.0f;
+  }
+
+  VerticalAlign ToVerticalAlign(const ComputedStyle& in_style, float& out_fBaselineOffset)
+  {
+    const LayoutKeywords& keywords = GetKeywords();
+    const CSSValue& value = in_style.Get(PropertyId::VerticalAlign);
+    out_fBaselineOffset = 0.0f;
+
+    if (value.IsKeyword(keywords.m_Sub))
+      return VerticalAlign::Sub;
+    if (value.IsKeyword(keywords.m_Super))
+      return VerticalAlign::Super;
+    if (value.IsKeyword(keywords.m_TextTop))
+      return VerticalAlign::TextTop;
+    if (value.IsKeyword(keywords.m_TextBottom))
+      return VerticalAlign::TextBottom;
+    if (value.IsKeyword(keywords.m_Middle))
+      return VerticalAlign::Middle;
+    if (value.IsKeyword(keywords.m_Top))
+      return VerticalAlign::Top;
+    if (value.IsKeyword(keywords.m_Bottom))
+      return VerticalAlign::Bottom;
+
+    // Percentages refer to the line height, normal is taken as 1.2em for them.
+    if (IsPercent(value))
+    {
+      const float fLineHeight = GetLineHeight(in_style);
+      out_fBaselineOffset = value.m_fNumber * 0.01f * (fLineHeight >= 0.0f ? fLineHeight : in_style.Get(PropertyId::FontSize).m_fNumber * 1.2f);
+      return VerticalAlign::Length;
+    }
+    if (ToPixels(value, out_fBaselineOffset))
+      return VerticalAlign::Length;
+    return VerticalAlign::Baseline;
+  }
+
+  font::ETextAlignment ToTextAlign(const CSSValue& in_value)
+  {
+    const LayoutKeywords& keywords = GetKeywords();
+    if (in_value.IsKeyword(keywords.m_Left))
+      return font::ETextAlignment::Left;
+    if (in_value.IsKeyword(keywords.m_Right))
+      return font::ETextAlignment::Right;
+    if (in_value.IsKeyword(keywords.m_Center))
+      return font::ETextAlignment::Center;
+    if (in_value.IsKeyword(keywords.m_End))
+      return font::ETextAlignment::End;
+    if (in_value.IsKeyword(keywords.m_Justify))
+      return font::ETextAlignment::Justify;
+    return font::ETextAlignment::Start;
+  }
+
+  YGAlign ToAlign(const CSSValue& in_value, YGAlign in_default)
+  {
+    const LayoutKeywords& keywords = GetKeywords();
+    if (in_value.IsKeyword(keywords.m_Center))
+      return YGAlignCenter;
+    if (in_value.IsKeyword(keywords.m_FlexEnd) || in_value.IsKeyword(keywords.m_End) || in_value.IsKeyword(keywords.m_Right))
+      return YGAlignFlexEnd;
+    if (in_value.IsKeyword(keywords.m_Stretch))
+      return YGAlignStretch;
+    if (in_value.IsKeyword(keywords.m_Baseline))
+      return YGAlignBaseline;
+    if (in_value.IsKeyword(keywords.m_SpaceBetween))
+      return YGAlignSpaceBetween;
+    if (in_value.IsKeyword(keywords.m_SpaceAround))
+      return YGAlignSpaceAround;
+    if (in_value.IsKeyword(keywords.m_SpaceEvenly))
+      return YGAlignSpaceEvenly;
+    if (in_value.IsKeyword(keywords.m_Auto))
+      return YGAlignAuto;
+    if (in_value.IsKeyword(keywords.m_FlexStart) || in_value.IsKeyword(keywords.m_Start) || in_value.IsKeyword(keywords.m_Left))
+      return YGAlignFlexStart;
+    // normal
+    return in_default;
+  }
+
+  YGJustify ToJustify(const CSSValue& in_value)
+  {
+    const LayoutKeywords& keywords = GetKeywords();
+    if (in_value.IsKeyword(keywords.m_Center))
+      return YGJustifyCenter;
+    if (in_value.IsKeyword(keywords.m_FlexEnd) || in_value.IsKeyword(keywords.m_End) || in_value.IsKeyword(keywords.m_Right))
+      return YGJustifyFlexEnd;
+    if (in_value.IsKeyword(keywords.m_SpaceBetween))
+      return YGJustifySpaceBetween;
+    if (in_value.IsKeyword(keywords.m_SpaceAround))
+      return YGJustifySpaceAround;
+    if (in_value.IsKeyword(keywords.m_SpaceEvenly))
+      return YGJustifySpaceEvenly;
+    return YGJustifyFlexStart;
+  }
+
+  YGOverflow ToOverflow(const CSSValue& in_value)
+  {
+    const LayoutKeywords& keywords = GetKeywords();
+    if (in_value.IsKeyword(keywords.m_Scroll) || in_value.IsKeyword(keywords.m_Auto))
+      return YGOverflowScroll;
+    if (in_value.IsKeyword(keywords.m_Hidden) || in_value.IsKeyword(keywords.m_Clip))
+      return YGOverflowHidden;
+    return YGOverflowVisible;
+  }
+
+  // Yoga sizes are border-box sizes. For content-box, the px parts of padding and border are added to definite px sizes.
+  template <typename PointSetter, typename PercentSetter, typename UndefinedSetter>
+  void ApplySize(const CSSValue& in_value, float in_fContentBoxExtra, PointSetter in_point, PercentSetter in_percent, UndefinedSetter in_undefined)
+  {
+    float fPixels = 0.0f;
+    if (ToPixels(in_value, fPixels))
+      in_point(fPixels + in_fContentBoxExtra);
+    else if (IsPercent(in_value))
+      in_percent(in_value.m_fNumber);
+    else
+      in_undefined();
+  }
+
+  bool IsSameConstraint(float a, float b)
+  {
+    return a == b || (std::isnan(a) && std::isnan(b));
+  }
+
+  float GetLayoutInset(YGNodeRef in_pNode, YGEdge in_edge)
+  {
+    return YGNodeLayoutGetPadding(in_pNode, in_edge) + YGNodeLayoutGetBorder(in_pNode, in_edge);
+  }
+
+  // Relative to the border box.
+  nsRectFloat GetContentBox(const LayoutBox& in_box)
+  {
+    const float fLeft = GetLayoutInset(in_box.m_pYogaNode, YGEdgeLeft);
+    const float fTop = GetLayoutInset(in_box.m_pYogaNode, YGEdgeTop);
+    return nsRectFloat(fLeft, fTop, in_box.m_fWidth - fLeft - GetLayoutInset(in_box.m_pYogaNode, YGEdgeRight), in_box.m_fHeight - fTop - GetLayoutInset(in_box.m_pYogaNode, YGEdgeBottom));
+  }
+
+  constexpr YGEdge s_Edges[4] = {YGEdgeTop, YGEdgeRight, YGEdgeBottom, YGEdgeLeft};
+
+  // The content box from the insets in the style, for boxes Yoga didn't lay out. Relative to the border box.
+  nsRectFloat GetStyleContentBox(const LayoutBox& in_box, float in_fContainingWidth)
+  {
+    const PropertyId paddings[4] = {PropertyId::PaddingTop, PropertyId::PaddingRight, PropertyId::PaddingBottom, PropertyId::PaddingLeft};
+    const PropertyId borders[4] = {PropertyId::BorderTopWidth, PropertyId::BorderRightWidth, PropertyId::BorderBottomWidth, PropertyId::BorderLeftWidth};
+
+    float fInsets[4];
+    for (nsUInt32 i = 0; i < 4; ++i)
+    {
+      const CSSValue& padding = in_box.m_pStyle->Get(paddings[i]);
+      const float fPadding = IsPercent(padding) ? padding.m_fNumber * 0.01f * in_fContainingWidth : ToPixelsOrZero(padding);
+      fInsets[i] = fPadding + ToPixelsOrZero(in_box.m_pStyle->Get(borders[i]));
+    }
+    return nsRectFloat(fInsets[3], fInsets[0], in_box.m_fWidth - fInsets[3] - fInsets[1], in_box.m_fHeight - fInsets[0] - fInsets[2]);
+  }
+
+  void CollectPreOrder(const dom::DOMNode& in_root, nsDynamicArray<const dom::DOMNode*>& out_nodes)
+  {
+    nsHybridArray<const dom::DOMNode*, 64> stack;
+    stack.PushBack(&in_root);
+    while (!stack.IsEmpty())
+    {
+      const dom::DOMNode* pNode = stack.PeekBack();
+      stack.PopBack();
+      out_nodes.PushBack(pNode);
+
+      const auto& children = pNode->getChildNodes();
+      for (auto it = children.rbegin(); it != children.rend(); ++it)
+        stack.PushBack(it->get());
+    }
+  }
+
+  bool IsOutOfFlow(const ComputedStyle& in_style)
+  {
+    const CSSValue& position = in_style.Get(PropertyId::Position);
+    return position.IsKeyword(GetKeywords().m_Absolute) || position.IsKeyword(GetKeywords().m_Fixed);
+  }
+
+  bool HasLayoutContainment(const ComputedStyle& in_style)
+  {
+    const std::string_view text = in_style.GetString(PropertyId::Contain);
+    size_t uiStart = 0;
+    for (size_t i = 0; i <= text.size(); ++i)
+    {
+      if (i < text.size() && !IsWhitespace(text[i]))
+        continue;
+
+      const std::string_view keyword = text.substr(uiStart, i - uiStart);
+      if (keyword == "layout" || keyword == "strict" || keyword == "content")
+        return true;
+      uiStart = i + 1;
+    }
+    return false;
+  }
+
+  // Nothing outside of the box depends on its content, nor does its content on anything outside of it but its size.
+  // Percentage paddings would refer to the width of the parent.
+  bool IsIndependentFormattingRoot(const ComputedStyle& in_style)
+  {
+    if (!IsOutOfFlow(in_style) && ToOverflow(in_style.Get(PropertyId::OverflowX)) == YGOverflowVisible &&
+        ToOverflow(in_style.Get(PropertyId::OverflowY)) == YGOverflowVisible && !HasLayoutContainment(in_style))
+      return false;
+
+    float fPixels = 0.0f;
+    if (!ToPixels(in_style.Get(PropertyId::Width), fPixels) || !ToPixels(in_style.Get(PropertyId::Height), fPixels))
+      return false;
+
+    const PropertyId paddings[4] = {PropertyId::PaddingTop, PropertyId::PaddingRight, PropertyId::PaddingBottom, PropertyId::PaddingLeft};
+    for (PropertyId padding : paddings)
+    {
+      if (IsPercent(in_style.Get(padding)))
+        return false;
+    }
+    return true;
+  }
+
+  // The grid properties are kept as raw text by the style system and parsed here. Named lines and grid-template-areas
+  // are not supported, line names in track lists are skipped.
+  class GridValueParser
+  {
+  public:
+    explicit GridValueParser(std::string_view in_text) { css::parser::CSSTokenizer::TokenizeAll(in_text, m_Tokens, true); }
+
+    // <track-list> | <auto-track-list>. none and invalid lists have no tracks.
+    void ParseTrackList(GridAxisTemplate& out_axis)
+    {
+      out_axis.m_Tracks.Clear();
+      out_axis.m_AutoRepeat.Clear();
+      out_axis.m_uiAutoRepeatIndex = 0;
+      out_axis.m_bAutoFit = false;
+
+      while (!IsAtEnd())
+      {
+        const CSSToken& token = Peek();
+        if (token.m_Type == CSSTokenType::OpenSquare)
+        {
+          SkipLineNames();
+          continue;
+        }
+
+        if (token.m_Type == CSSTokenType::Function && token.m_Value == "repeat")
+        {
+          ++m_uiPos;
+          if (!ParseRepeat(out_axis))
+            break;
+          continue;
+        }
+
+        GridTrackSize size;
+        if (!ParseTrackSize(size))
+          break;
+        out_axis.m_Tracks.PushBack(size);
+      }
+
+      if (!IsAtEnd())
+      {
+        out_axis.m_Tracks.Clear();
+        out_axis.m_AutoRepeat.Clear();
+        out_axis.m_uiAutoRepeatIndex = 0;
+      }
+    }
+
+    // <track-size>+ of grid-auto-columns and grid-auto-rows.
+    void ParseTrackSizes(nsHybridArray<GridTrackSize, 2>& out_sizes)
+    {
+      out_sizes.Clear();
+      GridTrackSize size;
+      while (!IsAtEnd() && ParseTrackSize(size))
+        out_sizes.PushBack(size);
+
+      if (!IsAtEnd() || out_sizes.IsEmpty())
+      {
+        out_sizes.Clear();
+        out_sizes.PushBack(GridTrackSize::Make(GridTrackSizing::Auto));
+      }
+    }
+
+    // auto | <integer> | span <integer>, named lines count as auto.
+    GridLine ParseLine()
+    {
+      GridLine line = {0, 0};
+      bool bSpan = false;
+      double fNumber = 0.0;
+      for (; !IsAtEnd(); ++m_uiPos)
+      {
+        const CSSToken& token = Peek();
+        if (token.m_Type == CSSTokenType::Ident && token.m_Value == "span")
+          bSpan = true;
+        else if (token.m_Type == CSSTokenType::Number && token.HasFlag(CSSToken::IsInteger))
+          fNumber = token.m_fNumber;
+        else
+          return line;
+      }
+
+      if (bSpan)
+        line.m_uiSpan = static_cast<nsUInt16>(nsMath::Clamp(fNumber, 1.0, 1000.0));
+      else
+        line.m_iLine = static_cast<nsInt16>(nsMath::Clamp(fNumber, -1000.0, 1000.0));
+      return line;
+    }
+
+  private:
+    const CSSToken& Peek() const { return m_Tokens[m_uiPos]; }
+    bool IsAtEnd() const { return m_uiPos >= m_Tokens.GetCount(); }
+
+    bool Consume(CSSTokenType in_type)
+    {
+      if (IsAtEnd() || Peek().m_Type != in_type)
+        return false;
+      ++m_uiPos;
+      return true;
+    }
+
+    void SkipLineNames()
+    {
+      while (!IsAtEnd() && Peek().m_Type != CSSTokenType::CloseSquare)
+        ++m_uiPos;
+      Consume(CSSTokenType::CloseSquare);
+    }
+
+    bool ParseBreadth(GridTrackBreadth& out_breadth)
+    {
+      if (IsAtEnd())
+        return false;
+
+      const CSSToken& token = m_Tokens[m_uiPos++];
+      out_breadth.m_fValue = 0.0f;
+      switch (token.m_Type)
+      {
+        case CSSTokenType::Ident:
+          if (token.m_Value == "auto")
+            out_breadth.m_Sizing = GridTrackSizing::Auto;
+          else if (token.m_Value == "min-content")
+            out_breadth.m_Sizing = GridTrackSizing::MinContent;
+          else if (token.m_Value == "max-content")
+            out_breadth.m_Sizing = GridTrackSizing::MaxContent;
+          else
+            return false;
+          return true;
+
+        case CSSTokenType::Percentage:
+          out_breadth.m_Sizing = GridTrackSizing::Percent;
+          out_breadth.m_fValue = static_cast<float>(token.m_fNumber);
+          return token.m_fNumber >= 0.0;
+
+        case CSSTokenType::Dimension:
+        case CSSTokenType::Number:
+        {
+          if (token.m_Unit == "fr")
+          {
+            out_breadth.m_Sizing = GridTrackSizing::Flex;
+            out_breadth.m_fValue = static_cast<float>(token.m_fNumber);
+            return token.m_fNumber >= 0.0;
+          }
+
+          // The unit follows the number in the source.
+          CSSValue value;
+          out_breadth.m_Sizing = GridTrackSizing::Fixed;
+          return css::CSSPropertyTable::ParseNumeric(std::string_view(token.m_Value.data(), token.m_Value.size() + token.m_Unit.size()), value).Succeeded() &&
+                 ToPixels(value, out_breadth.m_fValue) && out_breadth.m_fValue >= 0.0f;
+        }
+
+        default:
+          return false;
+      }
+    }
+
+    bool ParseTrackSize(GridTrackSize& out_size)
+    {
+      if (IsAtEnd())
+        return false;
+
+      const CSSToken& token = Peek();
+      if (token.m_Type == CSSTokenType::Function && token.m_Value == "minmax")
+      {
+        ++m_uiPos;
+        GridTrackBreadth min;
+        GridTrackBreadth max;
+        if (!ParseBreadth(min) || !Consume(CSSTokenType::Comma) || !ParseBreadth(max) || !Consume(CSSTokenType::CloseParen) || min.m_Sizing == GridTrackSizing::Flex)
+          return false;
+        out_size = GridTrackSize::MakeMinMax(min, max);
+        return true;
+      }
+
+      if (token.m_Type == CSSTokenType::Function && token.m_Value == "fit-content")
+      {
+        ++m_uiPos;
+        GridTrackBreadth limit;
+        if (!ParseBreadth(limit) || limit.m_Sizing != GridTrackSizing::Fixed || !Consume(CSSTokenType::CloseParen))
+          return false;
+        out_size = GridTrackSize::Make(GridTrackSizing::FitContent, limit.m_fValue);
+        return true;
+      }
+
+      GridTrackBreadth breadth;
+      if (!ParseBreadth(breadth))
+        return false;
+      out_size = GridTrackSize::Make(breadth.m_Sizing, breadth.m_fValue);
+      return true;
+    }
+
+    // repeat( <integer> | auto-fill | auto-fit , <track-size>+ ), after the function token.
+    bool ParseRepeat(GridAxisTemplate& inout_axis)
+    {
+      if (IsAtEnd())
+        return false;
+
+      const CSSToken& count = m_Tokens[m_uiPos++];
+      const bool bAuto = count.m_Type == CSSTokenType::Ident && (count.m_Value == "auto-fill" || count.m_Value == "auto-fit");
+      if ((!bAuto && (count.m_Type != CSSTokenType::Number || !count.HasFlag(CSSToken::IsInteger) || count.m_fNumber < 1.0)) || !Consume(CSSTokenType::Comma))
+        return false;
+
+      nsHybridArray<GridTrackSize, 8> sizes;
+      while (!Consume(CSSTokenType::CloseParen))
+      {
+        if (!IsAtEnd() && Peek().m_Type == CSSTokenType::OpenSquare)
+        {
+          SkipLineNames();
+          continue;
+        }
+
+        GridTrackSize size;
+        if (!ParseTrackSize(size))
+          return false;
+        sizes.PushBack(size);
+      }
+      if (sizes.IsEmpty())
+        return false;
+
+      if (bAuto)
+      {
+        // Only one automatic repetition is allowed.
+        if (!inout_axis.m_AutoRepeat.IsEmpty())
+          return false;
+        inout_axis.m_AutoRepeat = sizes.GetArrayPtr();
+        inout_axis.m_uiAutoRepeatIndex = inout_axis.m_Tracks.GetCount();
+        inout_axis.m_bAutoFit = count.m_Value == "auto-fit";
+        return true;
+      }
+
+      const nsUInt32 uiRepetitions = nsMath::Min(static_cast<nsUInt32>(count.m_fNumber), 10000u);
+      for (nsUInt32 i = 0; i < uiRepetitions; ++i)
+        inout_axis.m_Tracks.PushBackRange(sizes);
+      return true;
+    }
+
+    nsDynamicArray<CSSToken> m_Tokens;
+    nsUInt32 m_uiPos = 0;
+  };
+
+  GridContentAlign ToGridContentAlign(const CSSValue& in_value)
+  {
+    const LayoutKeywords& keywords = GetKeywords();
+    if (in_value.IsKeyword(keywords.m_Center))
+      return GridContentAlign::Center;
+    if (in_value.IsKeyword(keywords.m_FlexEnd) || in_value.IsKeyword(keywords.m_End) || in_value.IsKeyword(keywords.m_Right))
+      return GridContentAlign::End;
+    if (in_value.IsKeyword(keywords.m_SpaceBetween))
+      return GridContentAlign::SpaceBetween;
+    if (in_value.IsKeyword(keywords.m_SpaceAround))
+      return GridContentAlign::SpaceAround;
+    if (in_value.IsKeyword(keywords.m_SpaceEvenly))
+      return GridContentAlign::SpaceEvenly;
+    if (in_value.IsKeyword(keywords.m_Start) || in_value.IsKeyword(keywords.m_Left))
+      return GridContentAlign::Start;
+    // normal and stretch. flex-start is the initial value of justify-content, which has no meaning for grids.
+    return GridContentAlign::Stretch;
+  }
+
+  void GetGridAxisTemplate(const ComputedStyle& in_style, PropertyId in_template, PropertyId in_auto, PropertyId in_gap, GridAxisTemplate& out_axis)
+  {
+    GridValueParser(in_style.GetString(in_template)).ParseTrackList(out_axis);
+    GridValueParser(in_style.GetString(in_auto)).ParseTrackSizes(out_axis.m_ImplicitTracks);
+
+    const CSSValue& gap = in_style.Get(in_gap);
+    out_axis.m_bGapPercent = IsPercent(gap);
+    out_axis.m_fGap = out_axis.m_bGapPercent ? gap.m_fNumber : ToPixelsOrZero(gap);
+  }
+
+  void GetGridTemplate(const ComputedStyle& in_style, GridTemplate& out_template)
+  {
+    GetGridAxisTemplate(in_style, PropertyId::GridTemplateColumns, PropertyId::GridAutoColumns, PropertyId::ColumnGap, out_template.m_Columns);
+    GetGridAxisTemplate(in_style, PropertyId::GridTemplateRows, PropertyId::GridAutoRows, PropertyId::RowGap, out_template.m_Rows);
+
+    nsDynamicArray<CSSToken> flow;
+    css::parser::CSSTokenizer::TokenizeAll(in_style.GetString(PropertyId::GridAutoFlow), flow, true);
+    out_template.m_bColumnFlow = false;
+    out_template.m_bDense = false;
+    for (const CSSToken& token : flow)
+    {
+      out_template.m_bColumnFlow |= token.m_Value == "column";
+      out_template.m_bDense |= token.m_Value == "dense";
+    }
+
+    out_template.m_JustifyContent = ToGridContentAlign(in_style.Get(PropertyId::JustifyContent));
+    out_template.m_AlignContent = ToGridContentAlign(in_style.Get(PropertyId::AlignContent));
+  }
+
+  GridPlacement GetGridPlacement(const ComputedStyle& in_style)
+  {
+    GridPlacement placement;
+    placement.m_ColumnStart = GridValueParser(in_style.GetString(PropertyId::GridColumnStart)).ParseLine();
+    placement.m_ColumnEnd = GridValueParser(in_style.GetString(PropertyId::GridColumnEnd)).ParseLine();
+    placement.m_RowStart = GridValueParser(in_style.GetString(PropertyId::GridRowStart)).ParseLine();
+    placement.m_RowEnd = GridValueParser(in_style.GetString(PropertyId::GridRowEnd)).ParseLine();
+    return placement;
+  }
+} // namespace
+
+LayoutTree::LayoutTree()
+{
+  m_pConfig = YGConfigNew();
+  YGConfigSetContext(m_pConfig, this);
+  YGConfigSetPointScaleFactor(m_pConfig, 0.0f);
+}
+
+LayoutTree::~LayoutTree()
+{
+  Clear();
+  YGConfigFree(m_pConfig);
+}
+
+void LayoutTree::SetTextMeasureCache(TextMeasureCache* in_pCache)
+{
+  if (m_pTextCache == in_pCache)
+    return;
+
+  m_pTextCache = in_pCache;
+  m_bVirtualListsDirty = true;
+  m_bGridsDirty = true;
+  m_bContentDirty = true;
+  for (const LayoutBox& box : m_Boxes)
+  {
+    if (box.m_uiInlineContent != InvalidLayoutIndex)
+    {
+      m_InlineContent[box.m_uiInlineContent].MarkDirty();
+      YGNodeMarkDirty(box.m_pYogaNode);
+    }
+  }
+}
+
+void LayoutTree::SetFragmentCache(LayoutFragmentCache* in_pCache)
+{
+  m_pFragmentCache = in_pCache;
+  for (VirtualList& list : m_VirtualLists)
+    list.SetFragmentCache(in_pCache);
+}
+
+void LayoutTree::SetMaxThreads(nsUInt32 in_uiMaxThreads)
+{
+  // Whether roots are split off is decided when the boxes are built.
+  if ((m_uiMaxThreads == 1) != (in_uiMaxThreads == 1))
+    MarkStructureDirty();
+  m_uiMaxThreads = in_uiMaxThreads;
+}
+
+void LayoutTree::Build(dom::DOMElement& in_root)
+{
+  NS_PROFILE_SCOPE("LayoutTree::Build");
+
+  // Unchanged paragraphs don't have to be broken into lines again.
+  m_PreviousInlineContent.Swap(m_InlineContent);
+  for (LayoutIndex i = 0; i < m_Boxes.GetCount(); ++i)
+  {
+    if (m_Boxes[i].m_uiInlineContent != InvalidLayoutIndex)
+      m_PreviousInlineContentKeys.Insert(GetInlineContentKey(i), m_Boxes[i].m_uiInlineContent);
+  }
+
+  // Neither are the rows of virtualized containers measured again.
+  m_PreviousVirtualLists.Swap(m_VirtualLists);
+  for (LayoutIndex uiIndex : m_VirtualListBoxes)
+    m_PreviousVirtualListKeys.Insert(m_Boxes[uiIndex].m_pNode, m_Boxes[uiIndex].m_uiContainer);
+
+  Clear();
+  m_pRoot = &in_root;
+  ++m_Stats.m_uiBuilds;
+
+  const ComputedStyle* pStyle = GetStyle(in_root);
+  if (!IsDisplayNone(*pStyle))
+  {
+    LayoutIndex uiPrevious = InvalidLayoutIndex;
+    AddBlockBox(in_root, pStyle, InvalidLayoutIndex, uiPrevious);
+  }
+
+  m_PreviousInlineContent.Clear();
+  m_PreviousInlineContentKeys.Clear();
+  m_PreviousVirtualLists.Clear();
+  m_PreviousVirtualListKeys.Clear();
+}
+
+void LayoutTree::Clear()
+{
+  // The Yoga nodes of the children of grids are roots of their own, all others are part of the tree of the root.
+  for (LayoutIndex uiGrid : m_GridBoxes)
+  {
+    for (LayoutIndex uiChild = m_Boxes[uiGrid].m_uiFirstChild; uiChild != InvalidLayoutIndex; uiChild = m_Boxes[uiChild].m_uiNextSibling)
+      YGNodeFreeRecursive(m_Boxes[uiChild].m_pYogaNode);
+  }
+  if (!m_Boxes.IsEmpty())
+    YGNodeFreeRecursive(m_Boxes[0].m_pYogaNode);
+
+  // So are independent formatting roots, their configs are only freed once no node uses them anymore.
+  for (const ParallelRoot& root : m_ParallelRoots)
+    YGNodeFreeRecursive(m_Boxes[root.m_uiBox].m_pYogaNode);
+  for (const ParallelRoot& root : m_ParallelRoots)
+    YGConfigFree(root.m_pConfig);
+
+  m_Boxes.Clear();
+  m_InlineContent.Clear();
+  m_VirtualLists.Clear();
+  m_VirtualListBoxes.Clear();
+  m_Grids.Clear();
+  m_GridBoxes.Clear();
+  m_ParallelRoots.Clear();
+  m_ParallelRootKeys.Clear();
+  m_NodeToBox.Clear();
+  m_ChangedBoxes.Clear();
+  m_pRoot = nullptr;
+  m_bHasLayout = false;
+  m_bYogaLaidOut = false;
+  m_bStructureDirty = false;
+  m_bGridsDirty = false;
+}
+
+LayoutIndex LayoutTree::AddBox(const dom::DOMNode* in_pNode, const ComputedStyle* in_pStyle, LayoutBoxType in_type, LayoutIndex in_uiParent, LayoutIndex& inout_uiPrevious)
+{
+  const LayoutIndex uiIndex = m_Boxes.GetCount();
+
+  LayoutBox& box = m_Boxes.ExpandAndGetRef();
+  box.m_pNode = in_pNode;
+  box.m_pStyle = in_pStyle;
+  box.m_pYogaNode = nullptr;
+  box.m_uiParent = in_uiParent;
+  box.m_uiFirstChild = InvalidLayoutIndex;
+  box.m_uiNextSibling = InvalidLayoutIndex;
+  box.m_uiInlineContent = InvalidLayoutIndex;
+  box.m_uiContainer = InvalidLayoutIndex;
+  box.m_fX = 0.0f;
+  box.m_fY = 0.0f;
+  box.m_fWidth = 0.0f;
+  box.m_fHeight = 0.0f;
+  box.m_Type = in_type;
+  box.m_bParallelRoot = false;
+
+  if (inout_uiPrevious != InvalidLayoutIndex)
+    m_Boxes[inout_uiPrevious].m_uiNextSibling = uiIndex;
+  else if (in_uiParent != InvalidLayoutIndex)
+    m_Boxes[in_uiParent].m_uiFirstChild = uiIndex;
+  inout_uiPrevious = uiIndex;
+
+  if (in_pNode != nullptr)
+    m_NodeToBox.Insert(in_pNode, uiIndex);
+
+  if (in_type != LayoutBoxType::Inline && in_type != LayoutBoxType::Text)
+  {
+    // Nodes use the config of their tree, the measure functions find the tree through its context.
+    YGConfigConstRef pConfig = in_uiParent != InvalidLayoutIndex ? YGNodeGetConfig(m_Boxes[in_uiParent].m_pYogaNode) : m_pConfig;
+    YGNodeRef pStandIn = nullptr;
+    if (m_uiMaxThreads != 1 && IsParallelRoot(in_type, *in_pStyle, in_uiParent))
+    {
+      ParallelRoot& root = m_ParallelRoots.ExpandAndGetRef();
+      root.m_uiBox = uiIndex;
+      root.m_pStandIn = YGNodeNewWithConfig(pConfig);
+      root.m_pConfig = YGConfigNew();
+      YGConfigSetContext(root.m_pConfig, this);
+      YGConfigSetPointScaleFactor(root.m_pConfig, 0.0f);
+      m_ParallelRootKeys.Insert(uiIndex, m_ParallelRoots.GetCount() - 1);
+
+      pStandIn = root.m_pStandIn;
+      pConfig = root.m_pConfig;
+      box.m_bParallelRoot = true;
+    }
+
+    YGNodeRef pYogaNode = YGNodeNewWithConfig(pConfig);
+    YGNodeSetContext(pYogaNode, reinterpret_cast<void*>(static_cast<std::uintptr_t>(uiIndex)));
+    box.m_pYogaNode = pYogaNode;
+
+    // Grids lay out their children themselves.
+    if (in_uiParent != InvalidLayoutIndex && m_Boxes[in_uiParent].m_Type != LayoutBoxType::Grid)
+    {
+      YGNodeRef pParentNode = m_Boxes[in_uiParent].m_pYogaNode;
+      YGNodeInsertChild(pParentNode, pStandIn != nullptr ? pStandIn : pYogaNode, YGNodeGetChildCount(pParentNode));
+    }
+    ApplyStyle(uiIndex);
+  }
+  return uiIndex;
+}
+
+LayoutIndex LayoutTree::AddBlockBox(const dom::DOMElement& in_element, const ComputedStyle* in_pStyle, LayoutIndex in_uiParent, LayoutIndex& inout_uiPrevious)
+{
+  const LayoutIndex uiBox = AddBox(&in_element, in_pStyle, GetBlockBoxType(in_element, *in_pStyle), in_uiParent, inout_uiPrevious);
+  if (m_Boxes[uiBox].m_Type == LayoutBoxType::VirtualList)
+  {
+    BuildVirtualList(in_element, uiBox);
+    return uiBox;
+  }
+
+  BuildChildren(in_element, uiBox);
+  if (m_Boxes[uiBox].m_Type == LayoutBoxType::Grid)
+    BuildGrid(uiBox);
+  return uiBox;
+}
+
+void LayoutTree::BuildChildren(const dom::DOMElement& in_element, LayoutIndex in_uiBox)
+{
+  const std::vector<std::shared_ptr<dom::DOMNode>>& children = in_element.getChildNodes();
+  const ComputedStyle* pStyle = m_Boxes[in_uiBox].m_pStyle;
+
+  // The children of grids are blockified, every element is an item and runs of text are wrapped in anonymous items.
+  const bool bGrid = m_Boxes[in_uiBox].m_Type == LayoutBoxType::Grid;
+  bool bHasBlockChildren = bGrid;
+  for (const std::shared_ptr<dom::DOMNode>& pChild : children)
+  {
+    const dom::DOMElement* pElement = pChild != nullptr ? AsElement(*pChild) : nullptr;
+    if (pElement != nullptr && !IsDisplayNone(*GetStyle(*pElement)) && IsBlockLevel(*pElement))
+    {
+      bHasBlockChildren = true;
+      break;
+    }
+  }
+
+  LayoutIndex uiPrevious = InvalidLayoutIndex;
+  nsHybridArray<LayoutIndex, 8> inlineBoxes;
+
+  if (!bHasBlockChildren)
+  {
+    for (const std::shared_ptr<dom::DOMNode>& pChild : children)
+    {
+      if (pChild != nullptr)
+        BuildInlineContent(*pChild, pStyle, in_uiBox, uiPrevious);
+    }
+
+    if (m_Boxes[in_uiBox].m_uiFirstChild != InvalidLayoutIndex)
+      inlineBoxes.PushBack(in_uiBox);
+  }
+  else
+  {
+    LayoutIndex uiAnonymous = InvalidLayoutIndex;
+    LayoutIndex uiAnonymousPrevious = InvalidLayoutIndex;
+
+    for (const std::shared_ptr<dom::DOMNode>& pChild : children)
+    {
+      if (pChild == nullptr)
+        continue;
+
+      if (const dom::DOMElement* pElement = AsElement(*pChild))
+      {
+        const ComputedStyle* pChildStyle = GetStyle(*pElement);
+        if (IsDisplayNone(*pChildStyle))
+          continue;
+
+        if (bGrid || IsBlockLevel(*pElement))
+        {
+          uiAnonymous = InvalidLayoutIndex;
+          AddBlockBox(*pElement, pChildStyle, in_uiBox, uiPrevious);
+          continue;
+        }
+      }
+      else if (pChild->getNodeType() != dom::DOMNodeType::TEXT_NODE || (uiAnonymous == InvalidLayoutIndex && IsWhitespaceOnly(pChild->getNodeValue())))
+      {
+        // Whitespace between blocks doesn't generate boxes.
+        continue;
+      }
+
+      if (uiAnonymous == InvalidLayoutIndex)
+      {
+        uiAnonymous = AddBox(nullptr, pStyle, LayoutBoxType::Anonymous, in_uiBox, uiPrevious);
+        uiAnonymousPrevious = InvalidLayoutIndex;
+        inlineBoxes.PushBack(uiAnonymous);
+      }
+      BuildInlineContent(*pChild, pStyle, uiAnonymous, uiAnonymousPrevious);
+    }
+  }
+
+  // Boxes with inline content are Yoga leaves that measure their content.
+  for (LayoutIndex uiIndex : inlineBoxes)
+  {
+    m_Boxes[uiIndex].m_uiInlineContent = m_InlineContent.GetCount();
+
+    nsUInt32 uiPrevious = 0;
+    if (m_PreviousInlineContentKeys.Remove(GetInlineContentKey(uiIndex), &uiPrevious))
+      m_InlineContent.PushBack(std::move(m_PreviousInlineContent[uiPrevious]));
+    else
+      m_InlineContent.ExpandAndGetRef();
+
+    YGNodeSetMeasureFunc(m_Boxes[uiIndex].m_pYogaNode, &LayoutTree::MeasureInlineContent);
+    UpdateInlineContent(uiIndex);
+  }
+}
+
+void LayoutTree::BuildVirtualList(const dom::DOMElement& in_element, LayoutIndex in_uiBox)
+{
+  m_Boxes[in_uiBox].m_uiContainer = m_VirtualLists.GetCount();
+  m_VirtualListBoxes.PushBack(in_uiBox);
+
+  nsUInt32 uiPrevious = 0;
+  if (m_PreviousVirtualListKeys.Remove(&in_element, &uiPrevious))
+    m_VirtualLists.PushBack(std::move(m_PreviousVirtualLists[uiPrevious]));
+  else
+    m_VirtualLists.ExpandAndGetRef();
+
+  // The container is a Yoga leaf that is as high as its rows, measured or estimated.
+  VirtualList& list = m_VirtualLists.PeekBack();
+  list.SetFragmentCache(m_pFragmentCache);
+  list.SetEstimatedRowHeight(std::strtof(in_element.getAttribute("virtualize").c_str(), nullptr));
+  list.SetRows(in_element);
+  YGNodeSetMeasureFunc(m_Boxes[in_uiBox].m_pYogaNode, &LayoutTree::MeasureVirtualList);
+  m_bVirtualListsDirty = true;
+}
+
+void LayoutTree::BuildGrid(LayoutIndex in_uiBox)
+{
+  m_Boxes[in_uiBox].m_uiContainer = m_Grids.GetCount();
+  m_GridBoxes.PushBack(in_uiBox);
+
+  GridContainer& grid = m_Grids.ExpandAndGetRef();
+  for (LayoutIndex uiChild = m_Boxes[in_uiBox].m_uiFirstChild; uiChild != InvalidLayoutIndex; uiChild = m_Boxes[uiChild].m_uiNextSibling)
+  {
+    const LayoutBox& child = m_Boxes[uiChild];
+    if (child.m_Type == LayoutBoxType::Anonymous || !IsOutOfFlow(*child.m_pStyle))
+      grid.m_Items.PushBack(uiChild);
+  }
+  grid.m_LaidOutAreas.SetCount(grid.m_Items.GetCount(), nsRectFloat::MakeInvalid());
+
+  // The container is a Yoga leaf that is as large as its tracks.
+  YGNodeSetMeasureFunc(m_Boxes[in_uiBox].m_pYogaNode, &LayoutTree::MeasureGrid);
+  UpdateGridStyle(in_uiBox);
+}
+
+void LayoutTree::UpdateGridStyle(LayoutIndex in_uiIndex)
+{
+  const LayoutBox& box = m_Boxes[in_uiIndex];
+  GridContainer& grid = m_Grids[box.m_uiContainer];
+
+  GridTemplate gridTemplate;
+  GetGridTemplate(*box.m_pStyle, gridTemplate);
+
+  // Anonymous items have the style of the container, they are placed automatically.
+  nsHybridArray<GridPlacement, 16> placements;
+  for (LayoutIndex uiItem : grid.m_Items)
+  {
+    const LayoutBox& item = m_Boxes[uiItem];
+    placements.PushBack(item.m_Type == LayoutBoxType::Anonymous ? GridPlacement{} : GetGridPlacement(*item.m_pStyle));
+  }
+
+  const bool bTemplateChanged = grid.m_Layout.SetTemplate(gridTemplate);
+  const bool bItemsChanged = grid.m_Layout.SetItems(placements);
+  if (bTemplateChanged || bItemsChanged)
+    YGNodeMarkDirty(box.m_pYogaNode);
+}
+
+const dom::DOMNode* LayoutTree::GetInlineContentKey(LayoutIndex in_uiIndex) const
+{
+  const LayoutBox& box = m_Boxes[in_uiIndex];
+  return box.m_pNode != nullptr ? box.m_pNode : m_Boxes[box.m_uiFirstChild].m_pNode;
+}
+
+void LayoutTree::BuildInlineContent(const dom::DOMNode& in_node, const ComputedStyle* in_pStyle, LayoutIndex in_uiParent, LayoutIndex& inout_uiPrevious)
+{
+  if (in_node.getNodeType() == dom::DOMNodeType::TEXT_NODE)
+  {
+    AddBox(&in_node, in_pStyle, LayoutBoxType::Text, in_uiParent, inout_uiPrevious);
+    return;
+  }
+
+  const dom::DOMElement* pElement = AsElement(in_node);
+  if (pElement == nullptr)
+    return;
+
+  const ComputedStyle* pStyle = GetStyle(*pElement);
+  if (IsDisplayNone(*pStyle))
+    return;
+
+  const LayoutIndex uiBox = AddBox(pElement, pStyle, LayoutBoxType::Inline, in_uiParent, inout_uiPrevious);
+  LayoutIndex uiPrevious = InvalidLayoutIndex;
+  for (const std::shared_ptr<dom::DOMNode>& pChild : pElement->getChildNodes())
+  {
+    if (pChild != nullptr)
+      BuildInlineContent(*pChild, pStyle, uiBox, uiPrevious);
+  }
+}
+
+void LayoutTree::ApplyStyle(LayoutIndex in_uiIndex)
+{
+  const LayoutBox& box = m_Boxes[in_uiIndex];
+  YGNodeRef pNode = box.m_pYogaNode;
+  const ComputedStyle& style = *box.m_pStyle;
+  const LayoutKeywords& keywords = GetKeywords();
+
+  const bool bInFlexContainer = box.m_uiParent != InvalidLayoutIndex && m_Boxes[box.m_uiParent].m_Type == LayoutBoxType::Flex;
+
+  if (box.m_Type == LayoutBoxType::Anonymous)
+  {
+    // Only the font of the parent applies, the box takes the full width of the parent like any block.
+    YGNodeStyleSetFlexShrink(pNode, bInFlexContainer ? 1.0f : 0.0f);
+    return;
+  }
+
+  // The outer style places the box in its parent. The stand-in of an independent formatting root takes it, the root is
+  // laid out in the size the stand-in gets.
+  YGNodeRef pOuter = box.m_bParallelRoot ? GetStandIn(in_uiIndex) : pNode;
+
+  // Box model.
+  const PropertyId margins[4] = {PropertyId::MarginTop, PropertyId::MarginRight, PropertyId::MarginBottom, PropertyId::MarginLeft};
+  const PropertyId paddings[4] = {PropertyId::PaddingTop, PropertyId::PaddingRight, PropertyId::PaddingBottom, PropertyId::PaddingLeft};
+  const PropertyId borders[4] = {PropertyId::BorderTopWidth, PropertyId::BorderRightWidth, PropertyId::BorderBottomWidth, PropertyId::BorderLeftWidth};
+  const PropertyId insets[4] = {PropertyId::Top, PropertyId::Right, PropertyId::Bottom, PropertyId::Left};
+
+  float fPaddingAndBorder[4] = {};
+  for (nsUInt32 i = 0; i < 4; ++i)
+  {
+    const YGEdge edge = s_Edges[i];
+
+    const CSSValue& margin = style.Get(margins[i]);
+    float fPixels = 0.0f;
+    if (ToPixels(margin, fPixels))
+      YGNodeStyleSetMargin(pOuter, edge, fPixels);
+    else if (IsPercent(margin))
+      YGNodeStyleSetMarginPercent(pOuter, edge, margin.m_fNumber);
+    else if (margin.IsKeyword(keywords.m_Auto))
+      YGNodeStyleSetMarginAuto(pOuter, edge);
+    else
+      YGNodeStyleSetMargin(pOuter, edge, 0.0f);
+
+    // Both nodes need the insets, Yoga doesn't make a border box smaller than its padding and border.
+    const CSSValue& padding = style.Get(paddings[i]);
+    const float fBorder = ToPixelsOrZero(style.Get(borders[i]));
+    for (YGNodeRef pTarget : {pNode, pOuter})
+    {
+      if (IsPercent(padding))
+        YGNodeStyleSetPaddingPercent(pTarget, edge, padding.m_fNumber);
+      else
+        YGNodeStyleSetPadding(pTarget, edge, ToPixelsOrZero(padding));
+      YGNodeStyleSetBorder(pTarget, edge, fBorder);
+    }
+
+    fPaddingAndBorder[i] = ToPixelsOrZero(padding) + fBorder;
+
+    const CSSValue& inset = style.Get(insets[i]);
+    if (ToPixels(inset, fPixels))
+      YGNodeStyleSetPosition(pOuter, edge, fPixels);
+    else if (IsPercent(inset))
+      YGNodeStyleSetPositionPercent(pOuter, edge, inset.m_fNumber);
+    else
+      YGNodeStyleSetPosition(pOuter, edge, YGUndefined);
+  }
+
+  const bool bContentBox = !style.Get(PropertyId::BoxSizing).IsKeyword(keywords.m_BorderBox);
+  const float fExtraWidth = bContentBox ? fPaddingAndBorder[1] + fPaddingAndBorder[3] : 0.0f;
+  const float fExtraHeight = bContentBox ? fPaddingAndBorder[0] + fPaddingAndBorder[2] : 0.0f;
+
+  ApplySize(
+    style.Get(PropertyId::Width), fExtraWidth, [&](float v) { YGNodeStyleSetWidth(pOuter, v); }, [&](float v) { YGNodeStyleSetWidthPercent(pOuter, v); }, [&]() { YGNodeStyleSetWidthAuto(pOuter); });
+  ApplySize(
+    style.Get(PropertyId::Height), fExtraHeight, [&](float v) { YGNodeStyleSetHeight(pOuter, v); }, [&](float v) { YGNodeStyleSetHeightPercent(pOuter, v); }, [&]() { YGNodeStyleSetHeightAuto(pOuter); });
+  ApplySize(
+    style.Get(PropertyId::MinWidth), fExtraWidth, [&](float v) { YGNodeStyleSetMinWidth(pOuter, v); }, [&](float v) { YGNodeStyleSetMinWidthPercent(pOuter, v); }, [&]() { YGNodeStyleSetMinWidth(pOuter, YGUndefined); });
+  ApplySize(
+    style.Get(PropertyId::MinHeight), fExtraHeight, [&](float v) { YGNodeStyleSetMinHeight(pOuter, v); }, [&](float v) { YGNodeStyleSetMinHeightPercent(pOuter, v); }, [&]() { YGNodeStyleSetMinHeight(pOuter, YGUndefined); });
+  ApplySize(
+    style.Get(PropertyId::MaxWidth), fExtraWidth, [&](float v) { YGNodeStyleSetMaxWidth(pOuter, v); }, [&](float v) { YGNodeStyleSetMaxWidthPercent(pOuter, v); }, [&]() { YGNodeStyleSetMaxWidth(pOuter, YGUndefined); });
+  ApplySize(
+    style.Get(PropertyId::MaxHeight), fExtraHeight, [&](float v) { YGNodeStyleSetMaxHeight(pOuter, v); }, [&](float v) { YGNodeStyleSetMaxHeightPercent(pOuter, v); }, [&]() { YGNodeStyleSetMaxHeight(pOuter, YGUndefined); });
+
+  const CSSValue& position = style.Get(PropertyId::Position);
+  YGNodeStyleSetPositionType(pOuter, position.IsKeyword(keywords.m_Absolute) || position.IsKeyword(keywords.m_Fixed) ? YGPositionTypeAbsolute : YGPositionTypeRelative);
+
+  const YGOverflow overflowX = ToOverflow(style.Get(PropertyId::OverflowX));
+  const YGOverflow overflowY = ToOverflow(style.Get(PropertyId::OverflowY));
+  YGNodeStyleSetOverflow(pNode, overflowX > overflowY ? overflowX : overflowY);
+
+  // As a container.
+  if (box.m_Type == LayoutBoxType::Flex)
+  {
+    const CSSValue& direction = style.Get(PropertyId::FlexDirection);
+    YGFlexDirection flexDirection = YGFlexDirectionRow;
+    if (direction.IsKeyword(keywords.m_Column))
+      flexDirection = YGFlexDirectionColumn;
+    else if (direction.IsKeyword(keywords.m_ColumnReverse))
+      flexDirection = YGFlexDirectionColumnReverse;
+    else if (direction.IsKeyword(keywords.m_RowReverse))
+      flexDirection = YGFlexDirectionRowReverse;
+    YGNodeStyleSetFlexDirection(pNode, flexDirection);
+
+    const CSSValue& wrap = style.Get(PropertyId::FlexWrap);
+    YGNodeStyleSetFlexWrap(pNode, wrap.IsKeyword(keywords.m_Wrap) ? YGWrapWrap : (wrap.IsKeyword(keywords.m_WrapReverse) ? YGWrapWrapReverse : YGWrapNoWrap));
+
+    YGNodeStyleSetJustifyContent(pNode, ToJustify(style.Get(PropertyId::JustifyContent)));
+    YGNodeStyleSetAlignItems(pNode, ToAlign(style.Get(PropertyId::AlignItems), YGAlignStretch));
+    YGNodeStyleSetAlignContent(pNode, ToAlign(style.Get(PropertyId::AlignContent), YGAlignStretch));
+    YGNodeStyleSetGap(pNode, YGGutterRow, ToPixelsOrZero(style.Get(PropertyId::RowGap)));
+    YGNodeStyleSetGap(pNode, YGGutterColumn, ToPixelsOrZero(style.Get(PropertyId::ColumnGap)));
+  }
+  else
+  {
+    // Block flow: children are stacked and take the full width, unless they have a width themselves.
+    YGNodeStyleSetFlexDirection(pNode, YGFlexDirectionColumn);
+    YGNodeStyleSetFlexWrap(pNode, YGWrapNoWrap);
+    YGNodeStyleSetJustifyContent(pNode, YGJustifyFlexStart);
+    YGNodeStyleSetAlignItems(pNode, YGAlignStretch);
+    YGNodeStyleSetAlignContent(pNode, YGAlignFlexStart);
+    YGNodeStyleSetGap(pNode, YGGutterAll, 0.0f);
+  }
+
+  // As an item.
+  if (bInFlexContainer)
+  {
+    YGNodeStyleSetFlexGrow(pOuter, style.Get(PropertyId::FlexGrow).m_fNumber);
+    YGNodeStyleSetFlexShrink(pOuter, style.Get(PropertyId::FlexShrink).m_fNumber);
+
+    const CSSValue& basis = style.Get(PropertyId::FlexBasis);
+    float fPixels = 0.0f;
+    if (ToPixels(basis, fPixels))
+      YGNodeStyleSetFlexBasis(pOuter, fPixels);
+    else if (IsPercent(basis))
+      YGNodeStyleSetFlexBasisPercent(pOuter, basis.m_fNumber);
+    else
+      YGNodeStyleSetFlexBasisAuto(pOuter);
+
+    YGNodeStyleSetAlignSelf(pOuter, ToAlign(style.Get(PropertyId::AlignSelf), YGAlignAuto));
+  }
+  else
+  {
+    YGNodeStyleSetFlexGrow(pOuter, 0.0f);
+    YGNodeStyleSetFlexShrink(pOuter, 0.0f);
+    YGNodeStyleSetFlexBasisAuto(pOuter);
+    YGNodeStyleSetAlignSelf(pOuter, YGAlignAuto);
+  }
+}
+
+void LayoutTree::UpdateInlineContent(LayoutIndex in_uiIndex)
+{
+  const LayoutBox& box = m_Boxes[in_uiIndex];
+  InlineParagraph& paragraph = m_InlineContent[box.m_uiInlineContent];
+  const ComputedStyle& style = *box.m_pStyle;
+  const LayoutKeywords& keywords = GetKeywords();
+
+  const CSSValue& whiteSpace = style.Get(PropertyId::WhiteSpace);
+  const bool bPreserve = whiteSpace.IsKeyword(keywords.m_Pre) || whiteSpace.IsKeyword(keywords.m_PreWrap) || whiteSpace.IsKeyword(keywords.m_BreakSpaces);
+
+  InlineParagraphStyle paragraphStyle;
+  paragraphStyle.m_uiFontKey = MakeFontKey(style);
+  paragraphStyle.m_fLineHeight = GetLineHeight(style);
+  paragraphStyle.m_Align = ToTextAlign(style.Get(PropertyId::TextAlign));
+  paragraphStyle.m_bWrap = !whiteSpace.IsKeyword(keywords.m_Nowrap) && !whiteSpace.IsKeyword(keywords.m_Pre);
+  paragraphStyle.m_bRightToLeft = style.Get(PropertyId::Direction).IsKeyword(keywords.m_Rtl);
+
+  std::string text;
+  text.reserve(paragraph.GetText().size());
+  nsHybridArray<InlineItem, 16> items;
+
+  // The inline content is the subtree of the box, which is contiguous in pre-order. Every text node is one item.
+  for (LayoutIndex i = in_uiIndex + 1; i < m_Boxes.GetCount() && m_Boxes[i].m_Type >= LayoutBoxType::Inline; ++i)
+  {
+    const LayoutBox& textBox = m_Boxes[i];
+    if (textBox.m_Type != LayoutBoxType::Text)
+      continue;
+
+    const nsUInt32 uiStart = static_cast<nsUInt32>(text.size());
+    AppendText(text, textBox.m_pNode->getNodeValue(), !bPreserve);
+    if (text.size() == uiStart)
+      continue;
+
+    // Text is styled by its parent element. The nearest inline element that isn't baseline aligned shifts it.
+    float fBaselineOffset = 0.0f;
+    VerticalAlign verticalAlign = VerticalAlign::Baseline;
+    for (LayoutIndex uiParent = textBox.m_uiParent; m_Boxes[uiParent].m_Type == LayoutBoxType::Inline && verticalAlign == VerticalAlign::Baseline; uiParent = m_Boxes[uiParent].m_uiParent)
+      verticalAlign = ToVerticalAlign(*m_Boxes[uiParent].m_pStyle, fBaselineOffset);
+
+    InlineItem& item = items.ExpandAndGetRef();
+    item.m_uiStart = uiStart;
+    item.m_uiEnd = static_cast<nsUInt32>(text.size());
+    item.m_uiFontKey = MakeFontKey(*textBox.m_pStyle);
+    item.m_fLineHeight = GetLineHeight(*textBox.m_pStyle);
+    item.m_fBaselineOffset = fBaselineOffset;
+    item.m_VerticalAlign = verticalAlign;
+    item.m_uiOwner = i;
+  }
+
+  if (!bPreserve && !text.empty() && text.back() == ' ')
+  {
+    text.pop_back();
+    items.PeekBack().m_uiEnd = static_cast<nsUInt32>(text.size());
+    if (items.PeekBack().m_uiStart == items.PeekBack().m_uiEnd)
+      items.PopBack();
+  }
+
+  if (paragraph.SetContent(text, items, paragraphStyle))
+    YGNodeMarkDirty(box.m_pYogaNode);
+}
+
+void LayoutTree::Calculate(float in_fWidth, float in_fHeight)
+{
+  if (m_bStructureDirty && m_pRoot != nullptr)
+    Build(*m_pRoot);
+
+  if (m_Boxes.IsEmpty())
+    return;
+
+  SyncGrids();
+  const bool bContentDirty = m_bYogaLaidOut ? IsYogaDirty() : m_bContentDirty;
+  const bool bLayoutDirty = !m_bHasLayout || bContentDirty || !IsSameConstraint(in_fWidth, m_fLastWidth) || !IsSameConstraint(in_fHeight, m_fLastHeight);
+  if (!bLayoutDirty && !m_bVirtualListsDirty)
+  {
+    ++m_Stats.m_uiSkippedPasses;
+    return;
+  }
+
+  NS_PROFILE_SCOPE("LayoutTree::Calculate");
+  ++m_uiLayoutGeneration;
+  m_ChangedBoxes.Clear();
+  if (bLayoutDirty)
+    CalculateYoga(in_fWidth, in_fHeight);
+
+  // Rows are laid out once their container has a size. Measuring them changes the content height of the container, which
+  // is laid out once more. If that changes the size of the container, the next Calculate() updates the rows in view.
+  if ((bLayoutDirty || m_bVirtualListsDirty) && !m_VirtualLists.IsEmpty() && UpdateVirtualLists())
+  {
+    m_bGridsDirty = true;
+    CalculateYoga(in_fWidth, in_fHeight);
+    m_bVirtualListsDirty = true;
+  }
+
+  m_Stats.m_uiUpdatedBoxes += m_ChangedBoxes.GetCount();
+}
+
+void LayoutTree::CalculateYoga(float in_fWidth, float in_fHeight)
+{
+  SyncGrids();
+  m_fLastWidth = in_fWidth;
+  m_fLastHeight = in_fHeight;
+  m_bHasLayout = true;
+  m_bContentDirty = false;
+
+  // Until Yoga laid the tree out once, it would lay out all of it. An identical tree may have done that already.
+  const nsUInt64 uiFragmentHash = m_bYogaLaidOut ? 0 : GetFragmentHash();
+  if (uiFragmentHash != 0 && ApplyFragment(uiFragmentHash, in_fWidth, in_fHeight))
+    return;
+
+  YGNodeRef pRoot = m_Boxes[0].m_pYogaNode;
+  YGNodeCalculateLayout(pRoot, in_fWidth, in_fHeight, YGDirectionLTR);
+  nsHybridArray<nsUInt32, 16> laidOutRoots;
+  LayoutParallelRoots(laidOutRoots);
+  m_bYogaLaidOut = true;
+
+  ++m_Stats.m_uiPasses;
+  ReadBack(0);
+
+  // Roots whose parent tree didn't change aren't reached from the root.
+  for (nsUInt32 uiRoot : laidOutRoots)
+    ReadBack(m_ParallelRoots[uiRoot].m_uiBox);
+  m_fRootMarginRight = YGNodeLayoutGetMargin(pRoot, YGEdgeRight);
+  m_fRootMarginBottom = YGNodeLayoutGetMargin(pRoot, YGEdgeBottom);
+
+  if (uiFragmentHash != 0)
+    StoreFragment(uiFragmentHash, in_fWidth, in_fHeight);
+}
+
+void LayoutTree::GetNodeBoxes(nsDynamicArray<nsRectFloat>& out_boxes) const
+{
+  out_boxes.Clear();
+  if (m_pRoot == nullptr)
+    return;
+
+  nsDynamicArray<const dom::DOMNode*> nodes;
+  CollectPreOrder(*m_pRoot, nodes);
+  out_boxes.SetCountUninitialized(nodes.GetCount());
+  for (nsUInt32 i = 0; i < nodes.GetCount(); ++i)
+  {
+    const LayoutIndex uiBox = FindBox(nodes[i]);
+    out_boxes[i] = uiBox != InvalidLayoutIndex ? m_Boxes[uiBox].GetRect() : nsRectFloat::MakeZero();
+  }
+}
+
+nsResult LayoutTree::RestoreLayout(nsArrayPtr<const nsRectFloat> in_nodeBoxes, float in_fWidth, float in_fHeight)
+{
+  if (m_pRoot == nullptr || m_Boxes.IsEmpty() || m_bStructureDirty || !m_Grids.IsEmpty() || !m_VirtualLists.IsEmpty() || !m_ParallelRoots.IsEmpty())
+    return NS_FAILURE;
+
+  // Anonymous boxes have no node, so their geometry isn't part of the stored boxes.
+  for (const LayoutBox& box : m_Boxes)
+  {
+    if (box.m_Type == LayoutBoxType::Anonymous)
+      return NS_FAILURE;
+  }
+
+  nsDynamicArray<const dom::DOMNode*> nodes;
+  CollectPreOrder(*m_pRoot, nodes);
+  if (nodes.GetCount() != in_nodeBoxes.GetCount())
+    return NS_FAILURE;
+
+  NS_PROFILE_SCOPE("LayoutTree::RestoreLayout");
+  ++m_uiLayoutGeneration;
+  ++m_Stats.m_uiRestoredLayouts;
+  m_ChangedBoxes.Clear();
+
+  for (nsUInt32 i = 0; i < nodes.GetCount(); ++i)
+  {
+    const LayoutIndex uiBox = FindBox(nodes[i]);
+    if (uiBox == InvalidLayoutIndex || !m_Boxes[uiBox].HasYogaNode())
+      continue;
+
+    LayoutBox& box = m_Boxes[uiBox];
+    box.m_fX = in_nodeBoxes[i].x;
+    box.m_fY = in_nodeBoxes[i].y;
+    box.m_fWidth = in_nodeBoxes[i].width;
+    box.m_fHeight = in_nodeBoxes[i].height;
+    m_ChangedBoxes.PushBack(uiBox);
+  }
+
+  // Paragraphs are broken into lines for their content box, which places the inline boxes as ReadBack() would.
+  const float fAvailableWidth = YGFloatIsUndefined(in_fWidth) ? 0.0f : in_fWidth;
+  for (LayoutIndex i = 0; i < m_Boxes.GetCount(); ++i)
+  {
+    const LayoutBox& box = m_Boxes[i];
+    if (box.m_uiInlineContent == InvalidLayoutIndex)
+      continue;
+
+    const float fContainingWidth = box.m_uiParent != InvalidLayoutIndex ? m_Boxes[box.m_uiParent].m_fWidth : fAvailableWidth;
+    PlaceInlineContent(i, GetStyleContentBox(box, fContainingWidth));
+  }
+
+  const CSSValue& marginRight = m_Boxes[0].m_pStyle->Get(PropertyId::MarginRight);
+  const CSSValue& marginBottom = m_Boxes[0].m_pStyle->Get(PropertyId::MarginBottom);
+  m_fRootMarginRight = IsPercent(marginRight) ? marginRight.m_fNumber * 0.01f * fAvailableWidth : ToPixelsOrZero(marginRight);
+  m_fRootMarginBottom = IsPercent(marginBottom) ? marginBottom.m_fNumber * 0.01f * fAvailableWidth : ToPixelsOrZero(marginBottom);
+
+  // Yoga never saw this layout, its dirty flags don't tell whether the boxes are still valid, m_bContentDirty does.
+  m_fLastWidth = in_fWidth;
+  m_fLastHeight = in_fHeight;
+  m_bHasLayout = true;
+  m_bYogaLaidOut = false;
+  m_bContentDirty = false;
+  m_Stats.m_uiUpdatedBoxes += m_ChangedBoxes.GetCount();
+  return NS_SUCCESS;
+}
+
+bool LayoutTree::IsYogaDirty() const
+{
+  // The Yoga nodes of independent formatting roots don't dirty the stand-ins in the tree of the root.
+  if (YGNodeIsDirty(m_Boxes[0].m_pYogaNode))
+    return true;
+
+  for (const ParallelRoot& root : m_ParallelRoots)
+  {
+    if (YGNodeIsDirty(m_Boxes[root.m_uiBox].m_pYogaNode))
+      return true;
+  }
+  return false;
+}
+
+void LayoutTree::LayoutParallelRoots(nsDynamicArray<nsUInt32>& out_laidOut)
+{
+  out_laidOut.Clear();
+  for (nsUInt32 i = 0; i < m_ParallelRoots.GetCount(); ++i)
+  {
+    ParallelRoot& root = m_ParallelRoots[i];
+    const float fWidth = YGNodeLayoutGetWidth(root.m_pStandIn);
+    const float fHeight = YGNodeLayoutGetHeight(root.m_pStandIn);
+    if (!YGNodeIsDirty(m_Boxes[root.m_uiBox].m_pYogaNode) && fWidth == root.m_fWidth && fHeight == root.m_fHeight)
+      continue;
+
+    root.m_fWidth = fWidth;
+    root.m_fHeight = fHeight;
+    out_laidOut.PushBack(i);
+  }
+
+  if (out_laidOut.IsEmpty())
+    return;
+
+  NS_PROFILE_SCOPE("LayoutTree::LayoutParallelRoots");
+  m_Stats.m_uiParallelRoots += out_laidOut.GetCount();
+
+  // The roots share no Yoga nodes and no state of the tree, measuring text goes through the thread-safe TextMeasureCache.
+  auto layoutRoot = [this](const ParallelRoot& in_root) { YGNodeCalculateLayout(m_Boxes[in_root.m_uiBox].m_pYogaNode, in_root.m_fWidth, in_root.m_fHeight, YGDirectionLTR); };
+
+  const nsUInt32 uiThreads = nsMath::Min(m_uiMaxThreads != 0 ? m_uiMaxThreads : nsTaskSystem::GetWorkerThreadCount(nsWorkerThreadType::ShortTasks), out_laidOut.GetCount());
+  if (uiThreads <= 1)
+  {
+    for (nsUInt32 uiRoot : out_laidOut)
+      layoutRoot(m_ParallelRoots[uiRoot]);
+    return;
+  }
+
+  // One task per thread, each pulls roots until none are left. Roots differ a lot in size, a static split would leave threads idle.
+  nsAtomicInteger32 iNextRoot;
+  nsParallelForParams params;
+  params.m_uiBinSize = 1;
+  params.m_uiMaxTasksPerThread = uiThreads;
+
+  nsTaskSystem::ParallelForIndexed(
+    0, uiThreads, [&](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex) {
+      for (nsUInt32 uiSlot = uiStartIndex; uiSlot < uiEndIndex; ++uiSlot)
+      {
+        for (nsUInt32 i = static_cast<nsUInt32>(iNextRoot.PostIncrement()); i < out_laidOut.GetCount(); i = static_cast<nsUInt32>(iNextRoot.PostIncrement()))
+          layoutRoot(m_ParallelRoots[out_laidOut[i]]);
+      }
+    },
+    "LayoutTree::LayoutParallelRoots", nsTaskNesting::Never, params);
+}
+
+nsUInt64 LayoutTree::GetFragmentHash() const
+{
+  if (m_pFragmentCache == nullptr || m_Boxes.GetCount() > m_pFragmentCache->GetMaxBoxCount() || !m_ParallelRoots.IsEmpty())
+    return 0;
+
+  // The structure, the style of every box and the text. Styles are shared by every element with the same values, so
+  // the pointers identify them.
+  nsUInt64 uiHash = nsHashingUtils::xxHash64(&m_pTextCache, sizeof(m_pTextCache));
+  for (const LayoutBox& box : m_Boxes)
+  {
+    if (box.m_Type == LayoutBoxType::Grid || box.m_Type == LayoutBoxType::VirtualList)
+      return 0;
+
+    const std::string* pText = box.m_Type == LayoutBoxType::Text ? &box.m_pNode->getNodeValue() : nullptr;
+    const nsUInt64 parts[3] = {
+      static_cast<nsUInt64>(reinterpret_cast<std::uintptr_t>(box.m_pStyle)),
+      (static_cast<nsUInt64>(box.m_Type) << 32) | box.m_uiParent,
+      pText != nullptr ? nsHashingUtils::xxHash64(pText->data(), pText->size()) : 0,
+    };
+    uiHash = nsHashingUtils::xxHash64(parts, sizeof(parts), uiHash);
+  }
+  return uiHash != 0 ? uiHash : 1;
+}
+
+bool LayoutTree::ApplyFragment(nsUInt64 in_uiHash, float in_fWidth, float in_fHeight)
+{
+  const LayoutFragment* pFragment = m_pFragmentCache->Find(m_Boxes[0].m_pStyle, in_uiHash, in_fWidth, in_fHeight);
+  if (pFragment == nullptr)
+    return false;
+
+  NS_PROFILE_SCOPE("LayoutTree::ApplyFragment");
+  ++m_Stats.m_uiFragmentPasses;
+
+  // Same order as ReadBack(): a box, then its inline content.
+  nsUInt32 uiFragmentBox = 0;
+  for (LayoutIndex i = 0; i < m_Boxes.GetCount(); ++i)
+  {
+    LayoutBox& box = m_Boxes[i];
+    if (!box.HasYogaNode())
+      continue;
+
+    const LayoutFragmentBox& fragmentBox = pFragment->m_Boxes[uiFragmentBox++];
+    box.m_fX = fragmentBox.m_Rect.x;
+    box.m_fY = fragmentBox.m_Rect.y;
+    box.m_fWidth = fragmentBox.m_Rect.width;
+    box.m_fHeight = fragmentBox.m_Rect.height;
+    m_ChangedBoxes.PushBack(i);
+
+    if (box.m_uiInlineContent != InvalidLayoutIndex)
+      PlaceInlineContent(i, fragmentBox.m_ContentBox);
+  }
+  m_fRootMarginRight = pFragment->m_fMarginRight;
+  m_fRootMarginBottom = pFragment->m_fMarginBottom;
+  return true;
+}
+
+void LayoutTree::StoreFragment(nsUInt64 in_uiHash, float in_fWidth, float in_fHeight)
+{
+  LayoutFragment fragment;
+  for (const LayoutBox& box : m_Boxes)
+  {
+    if (!box.HasYogaNode())
+      continue;
+
+    LayoutFragmentBox& fragmentBox = fragment.m_Boxes.ExpandAndGetRef();
+    fragmentBox.m_Rect = box.GetRect();
+    fragmentBox.m_ContentBox = GetContentBox(box);
+  }
+  fragment.m_fMarginRight = m_fRootMarginRight;
+  fragment.m_fMarginBottom = m_fRootMarginBottom;
+  m_pFragmentCache->Insert(m_Boxes[0].m_pStyle, in_uiHash, in_fWidth, in_fHeight, std::move(fragment));
+}
+
+bool LayoutTree::UpdateVirtualLists()
+{
+  NS_PROFILE_SCOPE("LayoutTree::UpdateVirtualLists");
+  m_bVirtualListsDirty = false;
+
+  bool bChanged = false;
+  for (LayoutIndex uiIndex : m_VirtualListBoxes)
+  {
+    const LayoutBox& box = m_Boxes[uiIndex];
+    YGNodeRef pNode = box.m_pYogaNode;
+    const float fWidth = box.m_fWidth - GetLayoutInset(pNode, YGEdgeLeft) - GetLayoutInset(pNode, YGEdgeRight);
+
+    // Without overflow clipping all rows are in view.
+    float fViewportHeight = box.m_fHeight - GetLayoutInset(pNode, YGEdgeTop) - GetLayoutInset(pNode, YGEdgeBottom);
+    if (YGNodeStyleGetOverflow(pNode) == YGOverflowVisible)
+      fViewportHeight = std::numeric_limits<float>::infinity();
+
+    if (m_VirtualLists[box.m_uiContainer].Update(m_pTextCache, fWidth, fViewportHeight, m_fVirtualListOverscan))
+    {
+      YGNodeMarkDirty(pNode);
+      bChanged = true;
+    }
+  }
+  return bChanged;
+}
+
+void LayoutTree::SyncGrids()
+{
+  if (!m_bGridsDirty)
+    return;
+
+  // Post-order: a grid nested in an item marks the node of the item dirty before the grid of the item is checked.
+  m_bGridsDirty = false;
+  for (LayoutIndex uiIndex : m_GridBoxes)
+  {
+    const LayoutBox& box = m_Boxes[uiIndex];
+    GridContainer& grid = m_Grids[box.m_uiContainer];
+
+    bool bDirty = false;
+    nsUInt32 uiItem = 0;
+    for (LayoutIndex uiChild = box.m_uiFirstChild; uiChild != InvalidLayoutIndex; uiChild = m_Boxes[uiChild].m_uiNextSibling)
+    {
+      const bool bItem = uiItem < grid.m_Items.GetCount() && grid.m_Items[uiItem] == uiChild;
+      if (YGNodeIsDirty(m_Boxes[uiChild].m_pYogaNode))
+      {
+        bDirty = true;
+        if (bItem)
+        {
+          grid.m_Layout.MarkItemDirty(uiItem);
+          grid.m_LaidOutAreas[uiItem] = nsRectFloat::MakeInvalid();
+        }
+      }
+      uiItem += bItem ? 1 : 0;
+    }
+
+    if (bDirty)
+      YGNodeMarkDirty(box.m_pYogaNode);
+  }
+}
+
+void LayoutTree::LayoutGrid(LayoutIndex in_uiIndex, float in_fWidth, float in_fHeight)
+{
+  GridContainer& grid = m_Grids[m_Boxes[in_uiIndex].m_uiContainer];
+  GridLayout& layout = grid.m_Layout;
+  if (!layout.NeedsLayout(in_fWidth, in_fHeight))
+    return;
+
+  NS_PROFILE_SCOPE("LayoutTree::LayoutGrid");
+  layout.Place(in_fWidth, in_fHeight);
+
+  // Contributions are margin box sizes. The max-content width is the width the item has without constraint.
+  for (nsUInt32 i = 0; i < grid.m_Items.GetCount(); ++i)
+  {
+    if (!layout.NeedsItemWidths(i))
+      continue;
+
+    YGNodeRef pItem = m_Boxes[grid.m_Items[i]].m_pYogaNode;
+    YGNodeCalculateLayout(pItem, YGUndefined, YGUndefined, YGDirectionLTR);
+    const float fMaxContent = YGNodeLayoutGetWidth(pItem) + YGNodeLayoutGetMargin(pItem, YGEdgeLeft) + YGNodeLayoutGetMargin(pItem, YGEdgeRight);
+    layout.SetItemWidths(i, GetMinContentWidth(grid.m_Items[i]), fMaxContent);
+    grid.m_LaidOutAreas[i] = nsRectFloat::MakeInvalid();
+  }
+  layout.SizeColumns(in_fWidth);
+
+  for (nsUInt32 i = 0; i < grid.m_Items.GetCount(); ++i)
+  {
+    if (!layout.NeedsItemHeight(i))
+      continue;
+
+    YGNodeRef pItem = m_Boxes[grid.m_Items[i]].m_pYogaNode;
+    YGNodeCalculateLayout(pItem, layout.GetItemAreaWidth(i), YGUndefined, YGDirectionLTR);
+    layout.SetItemHeight(i, YGNodeLayoutGetHeight(pItem) + YGNodeLayoutGetMargin(pItem, YGEdgeTop) + YGNodeLayoutGetMargin(pItem, YGEdgeBottom));
+    grid.m_LaidOutAreas[i] = nsRectFloat::MakeInvalid();
+  }
+  layout.SizeRows(in_fHeight);
+}
+
+float LayoutTree::GetMinContentWidth(LayoutIndex in_uiIndex)
+{
+  const LayoutBox& box = m_Boxes[in_uiIndex];
+  const ComputedStyle& style = *box.m_pStyle;
+  const bool bAnonymous = box.m_Type == LayoutBoxType::Anonymous;
+
+  const float fMargins = bAnonymous ? 0.0f : ToPixelsOrZero(style.Get(PropertyId::MarginLeft)) + ToPixelsOrZero(style.Get(PropertyId::MarginRight));
+  const float fInsets = bAnonymous ? 0.0f
+                                   : ToPixelsOrZero(style.Get(PropertyId::PaddingLeft)) + ToPixelsOrZero(style.Get(PropertyId::PaddingRight)) +
+                                       ToPixelsOrZero(style.Get(PropertyId::BorderLeftWidth)) + ToPixelsOrZero(style.Get(PropertyId::BorderRightWidth));
+
+  float fWidth = 0.0f;
+  if (!bAnonymous && ToPixels(style.Get(PropertyId::Width), fWidth))
+    return fWidth + (style.Get(PropertyId::BoxSizing).IsKeyword(GetKeywords().m_BorderBox) ? 0.0f : fInsets) + fMargins;
+
+  float fContent = 0.0f;
+  if (box.m_uiInlineContent != InvalidLayoutIndex)
+  {
+    // Every soft wrap opportunity is taken.
+    if (m_pTextCache != nullptr)
+      fContent = m_InlineContent[box.m_uiInlineContent].Measure(*m_pTextCache, 0.0f).width;
+  }
+  else if (box.m_Type == LayoutBoxType::Grid)
+  {
+    LayoutGrid(in_uiIndex, YGUndefined, YGUndefined);
+    fContent = m_Grids[box.m_uiContainer].m_Layout.GetMinContentWidth();
+  }
+  else if (box.m_Type != LayoutBoxType::VirtualList)
+  {
+    // Rows have no width of their own. Items of flex rows are side by side, blocks are stacked.
+    const YGFlexDirection direction = YGNodeStyleGetFlexDirection(box.m_pYogaNode);
+    const bool bRow = box.m_Type == LayoutBoxType::Flex && (direction == YGFlexDirectionRow || direction == YGFlexDirectionRowReverse);
+    for (LayoutIndex uiChild = box.m_uiFirstChild; uiChild != InvalidLayoutIndex; uiChild = m_Boxes[uiChild].m_uiNextSibling)
+    {
+      if (YGNodeStyleGetPositionType(m_Boxes[uiChild].m_pYogaNode) == YGPositionTypeAbsolute)
+        continue;
+
+      const float fChild = GetMinContentWidth(uiChild);
+      fContent = bRow ? fContent + fChild : nsMath::Max(fContent, fChild);
+    }
+  }
+  return fContent + fInsets + fMargins;
+}
+
+void LayoutTree::ReadBack(LayoutIndex in_uiIndex)
+{
+  LayoutBox& box = m_Boxes[in_uiIndex];
+
+  // The stand-in of an independent formatting root has its position, the root its size and subtree.
+  if (box.m_bParallelRoot)
+  {
+    YGNodeRef pStandIn = GetStandIn(in_uiIndex);
+    if (YGNodeGetHasNewLayout(pStandIn))
+    {
+      YGNodeSetHasNewLayout(pStandIn, false);
+      const float fX = YGNodeLayoutGetLeft(pStandIn);
+      const float fY = YGNodeLayoutGetTop(pStandIn);
+      if (!YGNodeGetHasNewLayout(box.m_pYogaNode) && (fX != box.m_fX || fY != box.m_fY))
+        m_ChangedBoxes.PushBack(in_uiIndex);
+      box.m_fX = fX;
+      box.m_fY = fY;
+    }
+  }
+
+  // Yoga only flags the nodes it computed a layout for, the subtree of a node without a new layout is unchanged.
+  if (!YGNodeGetHasNewLayout(box.m_pYogaNode))
+    return;
+
+  YGNodeSetHasNewLayout(box.m_pYogaNode, false);
+  if (!box.m_bParallelRoot)
+  {
+    box.m_fX = YGNodeLayoutGetLeft(box.m_pYogaNode);
+    box.m_fY = YGNodeLayoutGetTop(box.m_pYogaNode);
+  }
+  box.m_fWidth = YGNodeLayoutGetWidth(box.m_pYogaNode);
+  box.m_fHeight = YGNodeLayoutGetHeight(box.m_pYogaNode);
+  m_ChangedBoxes.PushBack(in_uiIndex);
+
+  if (box.m_uiInlineContent != InvalidLayoutIndex)
+  {
+    PlaceInlineContent(in_uiIndex, GetContentBox(box));
+    return;
+  }
+
+  if (box.m_Type == LayoutBoxType::Grid)
+  {
+    PlaceGridItems(in_uiIndex);
+    return;
+  }
+
+  for (LayoutIndex uiChild = box.m_uiFirstChild; uiChild != InvalidLayoutIndex; uiChild = m_Boxes[uiChild].m_uiNextSibling)
+  {
+    ReadBack(uiChild);
+  }
+}
+
+void LayoutTree::PlaceInlineContent(LayoutIndex in_uiIndex, const nsRectFloat& in_contentBox)
+{
+  const LayoutBox& box = m_Boxes[in_uiIndex];
+  const float fLeft = in_contentBox.x;
+  const float fTop = in_contentBox.y;
+  const float fWidth = in_contentBox.width;
+
+  InlineParagraph& paragraph = m_InlineContent[box.m_uiInlineContent];
+  if (m_pTextCache != nullptr)
+    paragraph.Layout(*m_pTextCache, fWidth);
+
+  LayoutIndex uiEnd = in_uiIndex + 1;
+  while (uiEnd < m_Boxes.GetCount() && m_Boxes[uiEnd].m_Type >= LayoutBoxType::Inline)
+    ++uiEnd;
+
+  // The bounding boxes of the fragments, relative to the content box. Inline elements get the union of their content.
+  nsHybridArray<nsRectFloat, 16> rects;
+  rects.SetCount(uiEnd - in_uiIndex, nsRectFloat::MakeInvalid());
+  if (m_pTextCache != nullptr)
+  {
+    const nsArrayPtr<const InlineItem> items = paragraph.GetItems();
+    for (const InlineFragment& fragment : paragraph.GetFragments())
+    {
+      nsRectFloat& rect = rects[items[fragment.m_uiItem].m_uiOwner - in_uiIndex];
+      rect.ExpandToInclude(nsRectFloat(fragment.m_fX, fragment.m_fY, fragment.m_fWidth, fragment.m_fHeight));
+    }
+  }
+  for (LayoutIndex i = uiEnd - 1; i > in_uiIndex; --i)
+  {
+    const LayoutIndex uiParent = m_Boxes[i].m_uiParent;
+    if (uiParent != in_uiIndex && rects[i - in_uiIndex].IsValid())
+      rects[uiParent - in_uiIndex].ExpandToInclude(rects[i - in_uiIndex]);
+  }
+
+  for (LayoutIndex i = in_uiIndex + 1; i < uiEnd; ++i)
+  {
+    LayoutBox& inlineBox = m_Boxes[i];
+    const nsRectFloat& rect = rects[i - in_uiIndex];
+    const nsRectFloat& parentRect = rects[inlineBox.m_uiParent - in_uiIndex];
+    const bool bDirectChild = inlineBox.m_uiParent == in_uiIndex;
+
+    if (!rect.IsValid())
+    {
+      // Empty content, e.g. collapsed whitespace.
+      inlineBox.m_fX = bDirectChild ? fLeft : 0.0f;
+      inlineBox.m_fY = bDirectChild ? fTop : 0.0f;
+      inlineBox.m_fWidth = 0.0f;
+      inlineBox.m_fHeight = 0.0f;
+    }
+    else
+    {
+      inlineBox.m_fX = bDirectChild ? fLeft + rect.x : rect.x - parentRect.x;
+      inlineBox.m_fY = bDirectChild ? fTop + rect.y : rect.y - parentRect.y;
+      inlineBox.m_fWidth = rect.width;
+      inlineBox.m_fHeight = rect.height;
+    }
+    m_ChangedBoxes.PushBack(i);
+  }
+}
+
+void LayoutTree::PlaceGridItems(LayoutIndex in_uiIndex)
+{
+  const LayoutBox& box = m_Boxes[in_uiIndex];
+  YGNodeRef pNode = box.m_pYogaNode;
+  GridContainer& grid = m_Grids[box.m_uiContainer];
+  GridLayout& layout = grid.m_Layout;
+
+  const float fLeft = GetLayoutInset(pNode, YGEdgeLeft);
+  const float fTop = GetLayoutInset(pNode, YGEdgeTop);
+  float fWidth = box.m_fWidth - fLeft - GetLayoutInset(pNode, YGEdgeRight);
+  float fHeight = box.m_fHeight - fTop - GetLayoutInset(pNode, YGEdgeBottom);
+
+  // In the axes the container sized to its content, the layout Yoga measured it with is valid for the final size as well.
+  const Size available = layout.GetAvailableSize();
+  const Size content = layout.GetContentSize();
+  if (std::isnan(available.width) && nsMath::IsEqual(fWidth, content.width, 1.0f))
+    fWidth = available.width;
+  if (std::isnan(available.height) && nsMath::IsEqual(fHeight, content.height, 1.0f))
+    fHeight = available.height;
+  LayoutGrid(in_uiIndex, fWidth, fHeight);
+
+  const YGAlign alignItems = ToAlign(box.m_pStyle->Get(PropertyId::AlignItems), YGAlignStretch);
+  for (nsUInt32 i = 0; i < grid.m_Items.GetCount(); ++i)
+  {
+    const LayoutIndex uiItem = grid.m_Items[i];
+    YGNodeRef pItem = m_Boxes[uiItem].m_pYogaNode;
+    const nsRectFloat area = layout.GetItemArea(i);
+
+    YGAlign align = m_Boxes[uiItem].m_Type == LayoutBoxType::Anonymous ? YGAlignAuto : ToAlign(m_Boxes[uiItem].m_pStyle->Get(PropertyId::AlignSelf), YGAlignAuto);
+    if (align == YGAlignAuto)
+      align = alignItems;
+
+    // Items that are stretched fill the height of their area, the others are as high as their content.
+    if (YGNodeIsDirty(pItem) || grid.m_LaidOutAreas[i] != area)
+    {
+      YGNodeCalculateLayout(pItem, area.width, align == YGAlignStretch ? area.height : YGUndefined, YGDirectionLTR);
+      grid.m_LaidOutAreas[i] = area;
+    }
+
+    float fOffset = 0.0f;
+    if (align == YGAlignCenter || align == YGAlignFlexEnd)
+    {
+      const float fFree = area.height - YGNodeLayoutGetHeight(pItem) - YGNodeLayoutGetMargin(pItem, YGEdgeTop) - YGNodeLayoutGetMargin(pItem, YGEdgeBottom);
+      fOffset = align == YGAlignCenter ? fFree * 0.5f : fFree;
+    }
+
+    const bool bNewLayout = YGNodeGetHasNewLayout(pItem);
+    const float fPreviousX = m_Boxes[uiItem].m_fX;
+    const float fPreviousY = m_Boxes[uiItem].m_fY;
+    ReadBack(uiItem);
+
+    LayoutBox& item = m_Boxes[uiItem];
+    item.m_fX = fLeft + area.x + YGNodeLayoutGetLeft(pItem);
+    item.m_fY = fTop + area.y + YGNodeLayoutGetTop(pItem) + fOffset;
+    if (!bNewLayout && (item.m_fX != fPreviousX || item.m_fY != fPreviousY))
+      m_ChangedBoxes.PushBack(uiItem);
+  }
+
+  // Absolutely positioned children are placed in the padding box of the grid by their insets, not in grid areas.
+  const float fBorderLeft = YGNodeLayoutGetBorder(pNode, YGEdgeLeft);
+  const float fBorderTop = YGNodeLayoutGetBorder(pNode, YGEdgeTop);
+  nsUInt32 uiItem = 0;
+  for (LayoutIndex uiChild = box.m_uiFirstChild; uiChild != InvalidLayoutIndex; uiChild = m_Boxes[uiChild].m_uiNextSibling)
+  {
+    if (uiItem < grid.m_Items.GetCount() && grid.m_Items[uiItem] == uiChild)
+    {
+      ++uiItem;
+      continue;
+    }
+
+    YGNodeRef pChild = m_Boxes[uiChild].m_pYogaNode;
+    YGNodeCalculateLayout(pChild, box.m_fWidth - fBorderLeft - YGNodeLayoutGetBorder(pNode, YGEdgeRight), box.m_fHeight - fBorderTop - YGNodeLayoutGetBorder(pNode, YGEdgeBottom), YGDirectionLTR);
+    ReadBack(uiChild);
+    m_Boxes[uiChild].m_fX = fBorderLeft + YGNodeLayoutGetLeft(pChild);
+    m_Boxes[uiChild].m_fY = fBorderTop + YGNodeLayoutGetTop(pChild);
+  }
+}
+
+YGSize LayoutTree::MeasureInlineContent(YGNodeConstRef in_pNode, float in_fWidth, YGMeasureMode in_widthMode, float in_fHeight, YGMeasureMode in_heightMode)
+{
+  LayoutTree* pTree = static_cast<LayoutTree*>(YGConfigGetContext(YGNodeGetConfig(const_cast<YGNodeRef>(in_pNode))));
+  const LayoutIndex uiIndex = static_cast<LayoutIndex>(reinterpret_cast<std::uintptr_t>(YGNodeGetContext(in_pNode)));
+  InlineParagraph& paragraph = pTree->m_InlineContent[pTree->m_Boxes[uiIndex].m_uiInlineContent];
+
+  Size measured;
+  if (pTree->m_pTextCache != nullptr)
+    measured = paragraph.Measure(*pTree->m_pTextCache, in_widthMode == YGMeasureModeUndefined ? YGUndefined : in_fWidth);
+
+  YGSize result = {measured.width, measured.height};
+  if (in_widthMode == YGMeasureModeExactly)
+    result.width = in_fWidth;
+  else if (in_widthMode == YGMeasureModeAtMost)
+    result.width = nsMath::Min(result.width, in_fWidth);
+
+  if (in_heightMode == YGMeasureModeExactly)
+    result.height = in_fHeight;
+  else if (in_heightMode == YGMeasureModeAtMost)
+    result.height = nsMath::Min(result.height, in_fHeight);
+  return result;
+}
+
+YGSize LayoutTree::MeasureVirtualList(YGNodeConstRef in_pNode, float in_fWidth, YGMeasureMode in_widthMode, float in_fHeight, YGMeasureMode in_heightMode)
+{
+  LayoutTree* pTree = static_cast<LayoutTree*>(YGConfigGetContext(YGNodeGetConfig(const_cast<YGNodeRef>(in_pNode))));
+  const LayoutIndex uiIndex = static_cast<LayoutIndex>(reinterpret_cast<std::uintptr_t>(YGNodeGetContext(in_pNode)));
+  const VirtualList& list = pTree->m_VirtualLists[pTree->m_Boxes[uiIndex].m_uiContainer];
+
+  // Rows are laid out for the width of the container, so it has no width of its own.
+  YGSize result = {0.0f, list.GetContentHeight()};
+  if (in_widthMode != YGMeasureModeUndefined)
+    result.width = in_fWidth;
+
+  if (in_heightMode == YGMeasureModeExactly)
+    result.height = in_fHeight;
+  else if (in_heightMode == YGMeasureModeAtMost)
+    result.height = nsMath::Min(result.height, in_fHeight);
+  return result;
+}
+
+YGSize LayoutTree::MeasureGrid(YGNodeConstRef in_pNode, float in_fWidth, YGMeasureMode in_widthMode, float in_fHeight, YGMeasureMode in_heightMode)
+{
+  LayoutTree* pTree = static_cast<LayoutTree*>(YGConfigGetContext(YGNodeGetConfig(const_cast<YGNodeRef>(in_pNode))));
+  const LayoutIndex uiIndex = static_cast<LayoutIndex>(reinterpret_cast<std::uintptr_t>(YGNodeGetContext(in_pNode)));
+
+  // Block-level grids take the width they are offered. Only an exact height is definite, otherwise the rows size to their
+  // content and overflow the height they are offered, so the final layout is the one measured here.
+  pTree->LayoutGrid(uiIndex, in_widthMode == YGMeasureModeUndefined ? YGUndefined : in_fWidth, in_heightMode == YGMeasureModeExactly ? in_fHeight : YGUndefined);
+  const Size content = pTree->m_Grids[pTree->m_Boxes[uiIndex].m_uiContainer].m_Layout.GetContentSize();
+
+  YGSize result = {content.width, content.height};
+  if (in_widthMode != YGMeasureModeUndefined)
+    result.width = in_fWidth;
+  if (in_heightMode == YGMeasureModeExactly)
+    result.height = in_fHeight;
+  return result;
+}
+
+LayoutTree* LayoutTree::FindRowTree(const dom::DOMNode* in_pNode) const
+{
+  for (const VirtualList& list : m_VirtualLists)
+  {
+    if (LayoutTree* pTree = list.FindRowTree(in_pNode))
+      return pTree;
+  }
+  return nullptr;
+}
+
+void LayoutTree::UpdateStyle(const dom::DOMElement& in_element)
+{
+  const ComputedStyle* pStyle = GetStyle(in_element);
+  const LayoutIndex uiIndex = FindBox(&in_element);
+  if (uiIndex == InvalidLayoutIndex)
+  {
+    if (LayoutTree* pRowTree = FindRowTree(&in_element))
+    {
+      pRowTree->UpdateStyle(in_element);
+      m_bVirtualListsDirty = true;
+      return;
+    }
+
+    // Elements of rows that aren't laid out may end up here as well, a build keeps the measured rows.
+    if (!IsDisplayNone(*pStyle))
+      MarkStructureDirty();
+    return;
+  }
+
+  // Changes between display types and between block and inline level change the boxes of the parent, so do grid items
+  // that become absolutely positioned or the other way around.
+  LayoutBox& box = m_Boxes[uiIndex];
+  const bool bGridItem = box.m_uiParent != InvalidLayoutIndex && m_Boxes[box.m_uiParent].m_Type == LayoutBoxType::Grid;
+  const bool bBlockLevel = uiIndex == 0 || bGridItem || IsBlockLevel(in_element);
+  const LayoutBoxType type = bBlockLevel ? GetBlockBoxType(in_element, *pStyle) : LayoutBoxType::Inline;
+  const bool bParallelRoot = m_uiMaxThreads != 1 && IsParallelRoot(type, *pStyle, box.m_uiParent);
+  if (IsDisplayNone(*pStyle) || type != box.m_Type || bParallelRoot != box.m_bParallelRoot ||
+      (bGridItem && IsOutOfFlow(*pStyle) != (YGNodeStyleGetPositionType(box.m_pYogaNode) == YGPositionTypeAbsolute)))
+  {
+    MarkStructureDirty();
+    return;
+  }
+
+  box.m_pStyle = pStyle;
+  m_bContentDirty = true;
+  if (box.HasYogaNode())
+    ApplyStyle(uiIndex);
+
+  // The alignment of grid items is applied by their grid, which isn't dirtied by the Yoga nodes of its items.
+  if (box.m_Type == LayoutBoxType::Grid || bGridItem)
+  {
+    const LayoutIndex uiGrid = bGridItem ? box.m_uiParent : uiIndex;
+    GridContainer& grid = m_Grids[m_Boxes[uiGrid].m_uiContainer];
+    UpdateGridStyle(uiGrid);
+    for (nsUInt32 i = 0; i < grid.m_Items.GetCount(); ++i)
+    {
+      if (!bGridItem || grid.m_Items[i] == uiIndex)
+        grid.m_LaidOutAreas[i] = nsRectFloat::MakeInvalid();
+    }
+    YGNodeMarkDirty(m_Boxes[uiGrid].m_pYogaNode);
+  }
+  m_bGridsDirty = true;
+
+  // Text and anonymous children are styled by this element.
+  for (LayoutIndex uiChild = box.m_uiFirstChild; uiChild != InvalidLayoutIndex; uiChild = m_Boxes[uiChild].m_uiNextSibling)
+  {
+    LayoutBox& child = m_Boxes[uiChild];
+    if (child.m_Type == LayoutBoxType::Text || child.m_Type == LayoutBoxType::Anonymous)
+      child.m_pStyle = pStyle;
+    if (child.m_Type == LayoutBoxType::Anonymous)
+      UpdateInlineContent(uiChild);
+  }
+
+  // The font of the inline content is the one of the box it belongs to.
+  LayoutIndex uiContainer = uiIndex;
+  while (!m_Boxes[uiContainer].HasYogaNode())
+    uiContainer = m_Boxes[uiContainer].m_uiParent;
+  if (m_Boxes[uiContainer].m_uiInlineContent != InvalidLayoutIndex)
+    UpdateInlineContent(uiContainer);
+}
+
+void LayoutTree::UpdateText(const dom::DOMNode& in_textNode)
+{
+  LayoutIndex uiIndex = FindBox(&in_textNode);
+  if (uiIndex == InvalidLayoutIndex)
+  {
+    if (LayoutTree* pRowTree = FindRowTree(&in_textNode))
+    {
+      pRowTree->UpdateText(in_textNode);
+      m_bVirtualListsDirty = true;
+      return;
+    }
+
+    // Whitespace between blocks has no box, text that isn't whitespace needs one.
+    if (!IsWhitespaceOnly(in_textNode.getNodeValue()))
+      MarkStructureDirty();
+    return;
+  }
+
+  while (!m_Boxes[uiIndex].HasYogaNode())
+    uiIndex = m_Boxes[uiIndex].m_uiParent;
+  UpdateInlineContent(uiIndex);
+  m_bGridsDirty = true;
+  m_bContentDirty = true;
+}
+
+bool LayoutTree::IsParallelRoot(LayoutBoxType in_type, const ComputedStyle& in_style, LayoutIndex in_uiParent) const
+{
+  if (in_uiParent == InvalidLayoutIndex || in_type == LayoutBoxType::Anonymous || in_type >= LayoutBoxType::Inline || !IsIndependentFormattingRoot(in_style))
+    return false;
+
+  // Items are laid out by their grid while it is measured, and roots nested in a root are laid out with it.
+  for (LayoutIndex uiAncestor = in_uiParent; uiAncestor != InvalidLayoutIndex; uiAncestor = m_Boxes[uiAncestor].m_uiParent)
+  {
+    if (m_Boxes[uiAncestor].m_bParallelRoot || m_Boxes[uiAncestor].m_Type == LayoutBoxType::Grid)
+      return false;
+  }
+  return true;
+}
+
+YGNodeRef LayoutTree::GetStandIn(LayoutIndex in_uiIndex) const
+{
+  return m_ParallelRoots[*m_ParallelRootKeys.GetValue(in_uiIndex)].m_pStandIn;
+}
+
+LayoutIndex LayoutTree::FindBox(const dom::DOMNode* in_pNode) const
+{
+  const LayoutIndex* pIndex = m_NodeToBox.GetValue(in_pNode);
+  return pIndex != nullptr ? *pIndex : InvalidLayoutIndex;
+}
+
+Size LayoutTree::GetRootMarginBoxSize() const
+{
+  if (m_Boxes.IsEmpty())
+    return {0.0f, 0.0f};
+
+  const LayoutBox& root = m_Boxes[0];
+  return {root.m_fX + root.m_fWidth + m_fRootMarginRight, root.m_fY + root.m_fHeight + m_fRootMarginBottom};
+}
+
+nsRectFloat LayoutTree::GetAbsoluteRect(LayoutIndex in_uiIndex) const
+{
+  nsRectFloat rect = m_Boxes[in_uiIndex].GetRect();
+  for (LayoutIndex uiParent = m_Boxes[in_uiIndex].m_uiParent; uiParent != InvalidLayoutIndex; uiParent = m_Boxes[uiParent].m_uiParent)
+  {
+    rect.x += m_Boxes[uiParent].m_fX;
+    rect.y += m_Boxes[uiParent].m_fY;
+  }
+  return rect;
+}
+
+const std::string& LayoutTree::GetInlineText(LayoutIndex in_uiIndex) const
+{
+  static const std::string s_Empty;
+  const InlineParagraph* pParagraph = GetInlineParagraph(in_uiIndex);
+  return pParagraph != nullptr ? pParagraph->GetText() : s_Empty;
+}
+
+void LayoutTree::SetScrollOffset(const dom::DOMElement& in_element, float in_fOffset)
+{
+  const LayoutIndex uiIndex = FindBox(&in_element);
+  if (uiIndex == InvalidLayoutIndex)
+  {
+    if (LayoutTree* pRowTree = FindRowTree(&in_element))
+    {
+      pRowTree->SetScrollOffset(in_element, in_fOffset);
+      m_bVirtualListsDirty = true;
+    }
+    return;
+  }
+
+  const LayoutBox& box = m_Boxes[uiIndex];
+  if (box.m_Type != LayoutBoxType::VirtualList)
+    return;
+
+  VirtualList& list = m_VirtualLists[box.m_uiContainer];
+  if (list.GetScrollOffset() != in_fOffset)
+  {
+    list.SetScrollOffset(in_fOffset);
+    m_bVirtualListsDirty = true;
+  }
+}
+
+void LayoutTree::SetVirtualListOverscan(float in_fOverscan)
+{
+  if (m_fVirtualListOverscan != in_fOverscan)
+  {
+    m_fVirtualListOverscan = in_fOverscan;
+    m_bVirtualListsDirty = true;
+  }
+}
+
+const VirtualList* LayoutTree::GetVirtualList(LayoutIndex in_uiIndex) const
+{
+  const LayoutBox& box = m_Boxes[in_uiIndex];
+  return box.m_Type == LayoutBoxType::VirtualList ? &m_VirtualLists[box.m_uiContainer] : nullptr;
+}
+
+const GridLayout* LayoutTree::GetGrid(LayoutIndex in_uiIndex) const
+{
+  const LayoutBox& box = m_Boxes[in_uiIndex];
+  return box.m_Type == LayoutBoxType::Grid ? &m_Grids[box.m_uiContainer].m_Layout : nullptr;
+}
+
+const InlineParagraph* LayoutTree::GetInlineParagraph(LayoutIndex in_uiIndex) const
+{
+  const nsUInt32 uiContent = m_Boxes[in_uiIndex].m_uiInlineContent;
+  return uiContent != InvalidLayoutIndex ? &m_InlineContent[uiContent] : nullptr;
+}
@@ -0,0 +1,376 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <APHTML/layout/Core/GridLayout.h>
+#include <APHTML/layout/Core/InlineParagraph.h>
+#include <APHTML/layout/Core/VirtualList.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Math/Rect.h>
+#include <string>
+#include <yoga/Yoga.h>
+
+namespace aperture::dom
+{
+  class DOMNode;
+  class DOMElement;
+} // namespace aperture::dom
+
+namespace aperture::css
+{
+  class ComputedStyle;
+} // namespace aperture::css
+
+namespace aperture::layout
+{
+  class LayoutFragmentCache;
+  class TextMeasureCache;
+
+  using LayoutIndex = nsUInt32;
+  static constexpr LayoutIndex InvalidLayoutIndex = 0xFFFFFFFFu;
+
+  enum class LayoutBoxType : nsUInt8
+  {
+    Block,       ///< Block-level element, its children are stacked as a column.
+    Flex,        ///< display: flex and inline-flex.
+    Grid,        ///< display: grid and inline-grid, its children are items of a GridLayout.
+    VirtualList, ///< Element with the "virtualize" attribute, its children are rows of a VirtualList instead of boxes.
+    Anonymous,   ///< Wraps a run of inline content that has block-level siblings, as in CSS 2 9.2.1.1.
+
+    // Inline content, has to stay last: the inline content of a box is the range of boxes after it with one of these types.
+    Inline,      ///< Inline element, positioned by the box its inline content belongs to.
+    Text,        ///< Text node, positioned by the box its inline content belongs to.
+  };
+
+  /*
+   * @brief The record of one box of the LayoutTree.
+   *
+   * Block-level boxes own exactly one Yoga node, inline content has none. The children of a box are either all
+   * block-level (and are Yoga children) or all inline content, in which case the box is a Yoga leaf that lays out its
+   * inline content with a InlineParagraph. Mixed content is split into Anonymous boxes when the tree is built.
+   *
+   * The rect of a inline box is the bounding box of its fragments on all lines.
+   */
+  struct LayoutBox
+  {
+    NS_DECLARE_POD_TYPE();
+
+    /// @brief Null for anonymous boxes.
+    const dom::DOMNode* m_pNode;
+    /// @brief The style of the element. Text and anonymous boxes use the style of their parent element.
+    const css::ComputedStyle* m_pStyle;
+    /// @brief Null for inline content.
+    YGNodeRef m_pYogaNode;
+
+    LayoutIndex m_uiParent;
+    LayoutIndex m_uiFirstChild;
+    LayoutIndex m_uiNextSibling;
+    /// @brief Index of the InlineParagraph of the box if its children are inline content.
+    nsUInt32 m_uiInlineContent;
+    /// @brief Index of the VirtualList of VirtualList boxes, of the grid of Grid boxes.
+    nsUInt32 m_uiContainer;
+
+    /// @brief The border box, relative to the border box of the parent.
+    float m_fX;
+    float m_fY;
+    float m_fWidth;
+    float m_fHeight;
+
+    LayoutBoxType m_Type;
+    /// @brief The subtree of the box is laid out on its own, see LayoutTree::SetMaxThreads().
+    bool m_bParallelRoot;
+
+    bool HasYogaNode() const { return m_pYogaNode != nullptr; }
+    nsRectFloat GetRect() const { return nsRectFloat(m_fX, m_fY, m_fWidth, m_fHeight); }
+  };
+
+  /*
+   * @brief The layout tree of a document: one compact LayoutBox per box, built from the DOM and the computed styles.
+   *
+   * Boxes are stored in pre-order in a single array and linked by index, this is the only child representation. Yoga
+   * owns the geometry while laying out, the results are copied into the boxes afterwards.
+   *
+   * Geometry is in CSS px and isn't rounded to pixels, a SnappedLayout snaps it for the scale of a render target. One
+   * layout pass serves any number of render targets.
+   *
+   * Layout is incremental. Yoga's style setters only dirty a node if the value actually changed, so UpdateStyle() can
+   * apply the whole style of a element again. Inline content is only marked dirty if its text or style changed, and its
+   * paragraph then only breaks the changed part into lines again. Paragraphs are kept across builds for the boxes that
+   * still exist.
+   * Calculate() does nothing if no node is dirty and the available size is the same. Otherwise Yoga only visits the
+   * dirty subtrees, and only the boxes it reports a new layout for are read back (see GetChangedBoxes()).
+   *
+   * DOM structure changes and display changes that turn a box into another type need a new Build(), MarkStructureDirty()
+   * makes the next Calculate() do that.
+   *
+   * Elements with the "virtualize" attribute (its value optionally the estimated row height in px) are scroll containers
+   * whose children are not built into boxes. They are rows of a VirtualList, which lays out only the rows in view of the
+   * container, see SetScrollOffset() and GetVirtualList().
+   *
+   * Grid containers are Yoga leaves that lay out their children with a GridLayout. Every child element is a grid item
+   * (text runs are wrapped in anonymous items), whose Yoga node is the root of a tree of its own: it is measured for the
+   * contributions of the item and laid out in its grid area. Items that were not marked dirty keep their contributions.
+   *
+   * With a LayoutFragmentCache, a tree that Yoga would have to lay out completely (after a build) copies its boxes from
+   * a fragment of an identical tree instead, and stores its own layout for the next one. This is what makes rows of
+   * virtualized containers that repeat the same component cheap to bring into view. Trees with grids or virtualized
+   * containers are never cached, their state isn't part of a fragment.
+   *
+   * With more than one thread (see SetMaxThreads()), independent formatting roots are laid out concurrently: boxes that
+   * are absolutely positioned, clip their overflow or have layout containment, and whose size doesn't depend on their
+   * content (a px width and height). The Yoga node of such a root is detached into a tree of its own with its own
+   * YGConfig, a leaf with the same outer style takes its place in the parent. Once the parent tree is laid out, the roots
+   * that are dirty or got a new size are laid out on the nsTaskSystem, and all results are read back on the calling
+   * thread. Roots nested in a root or in a grid are laid out with it. Such trees are never cached either.
+   *
+   * @note Not thread-safe. It is owned by the thread that runs layout, Calculate() only uses other threads internally.
+   */
+  class NS_APERTURE_DLL LayoutTree
+  {
+  public:
+    struct Stats
+    {
+      nsUInt32 m_uiPasses = 0;
+      nsUInt32 m_uiSkippedPasses = 0;
+      nsUInt32 m_uiBuilds = 0;
+      /// @brief Boxes whose layout was read back from Yoga or copied from a fragment.
+      nsUInt32 m_uiUpdatedBoxes = 0;
+      /// @brief Passes that copied the layout from the LayoutFragmentCache instead of running Yoga.
+      nsUInt32 m_uiFragmentPasses = 0;
+      /// @brief Independent formatting roots laid out on their own, on any thread.
+      nsUInt32 m_uiParallelRoots = 0;
+      /// @brief Layouts taken over from stored boxes with RestoreLayout().
+      nsUInt32 m_uiRestoredLayouts = 0;
+    };
+
+    LayoutTree();
+    ~LayoutTree();
+
+    LayoutTree(const LayoutTree&) = delete;
+    LayoutTree& operator=(const LayoutTree&) = delete;
+
+    /// @brief Inline content is measured through the cache, without one it has no size. The cache has to outlive the tree.
+    void SetTextMeasureCache(TextMeasureCache* in_pCache);
+
+    /// @brief Layouts are looked up in and added to the cache, which is passed on to the rows of virtualized containers.
+    /// It has to outlive the tree, and must only be shared with trees that use the same TextMeasureCache.
+    void SetFragmentCache(LayoutFragmentCache* in_pCache);
+
+    /// @brief Lays out independent formatting roots on up to in_uiMaxThreads threads. 0 uses every short task worker of the
+    /// nsTaskSystem, 1 (the default) lays out the tree in a single Yoga pass. The results are identical. Takes effect at the next build.
+    void SetMaxThreads(nsUInt32 in_uiMaxThreads);
+
+    /// @brief Builds the boxes of the element and its subtree. Styles have to be resolved, elements without one get the initial style.
+    /// The root has to stay alive until the tree is cleared or built again.
+    void Build(dom::DOMElement& in_root);
+    void Clear();
+
+    /// @brief Lays out the tree, building it again first if the structure is dirty.
+    /// @param in_fWidth, in_fHeight The available size, YGUndefined for an unconstrained axis.
+    void Calculate(float in_fWidth, float in_fHeight = YGUndefined);
+
+    /// @brief The border box of every node of the subtree the tree was built from, in pre-order, relative to the box of
+    /// the parent (see LayoutBox). Nodes without a box get an empty rect. This is what DOMSnapshot stores as layout boxes.
+    void GetNodeBoxes(nsDynamicArray<nsRectFloat>& out_boxes) const;
+
+    /// @brief Takes over the boxes of a previous layout of an identical subtree (see GetNodeBoxes()) instead of laying it out.
+    /// The next Calculate() with the same available size does nothing, any change lays out the whole tree again.
+    /// Trees with anonymous boxes, grids, virtualized containers or independent formatting roots keep state besides the
+    /// boxes and can't be restored.
+    /// @param in_fWidth, in_fHeight The available size the boxes were laid out with.
+    /// @return NS_FAILURE if the tree can't be restored or the boxes don't match it, it has to be calculated then.
+    nsResult RestoreLayout(nsArrayPtr<const nsRectFloat> in_nodeBoxes, float in_fWidth, float in_fHeight = YGUndefined);
+
+    /// @brief Applies the current computed style of the element to its box.
+    void UpdateStyle(const dom::DOMElement& in_element);
+
+    /// @brief Has to be called after the value of a text node changed.
+    void UpdateText(const dom::DOMNode& in_textNode);
+
+    /// @brief Sets the vertical scroll offset of a virtualized container, the rows in view are laid out by the next Calculate().
+    void SetScrollOffset(const dom::DOMElement& in_element, float in_fOffset);
+
+    /// @brief How far beyond the viewport of virtualized containers rows are laid out, 200px by default.
+    void SetVirtualListOverscan(float in_fOverscan);
+
+    void MarkStructureDirty() { m_bStructureDirty = true; }
+    bool IsStructureDirty() const { return m_bStructureDirty; }
+
+    nsUInt32 GetBoxCount() const { return m_Boxes.GetCount(); }
+    const LayoutBox& GetBox(LayoutIndex in_uiIndex) const { return m_Boxes[in_uiIndex]; }
+    LayoutIndex GetRoot() const { return m_Boxes.IsEmpty() ? InvalidLayoutIndex : 0; }
+
+    /// @brief Returns the box of a element or text node, InvalidLayoutIndex if it has none (e.g. display: none).
+    LayoutIndex FindBox(const dom::DOMNode* in_pNode) const;
+
+    /// @brief The size of the margin box of the root, as laid out by the last Calculate().
+    Size GetRootMarginBoxSize() const;
+
+    /// @brief The border box of a box in the coordinate space of the root.
+    nsRectFloat GetAbsoluteRect(LayoutIndex in_uiIndex) const;
+
+    /// @brief The boxes whose geometry was updated by the last Calculate() that did any work, e.g. to update a HitTestIndex.
+    nsArrayPtr<const LayoutIndex> GetChangedBoxes() const { return m_ChangedBoxes; }
+
+    /// @brief Counts the Calculate() calls that did any work, the changed boxes are the ones of the last one.
+    nsUInt32 GetLayoutGeneration() const { return m_uiLayoutGeneration; }
+
+    /// @brief The text the inline content of a box is laid out with, after whitespace was collapsed.
+    const std::string& GetInlineText(LayoutIndex in_uiIndex) const;
+
+    /// @brief The lines and fragments of the inline content of a box, null if its children aren't inline content.
+    const InlineParagraph* GetInlineParagraph(LayoutIndex in_uiIndex) const;
+
+    /// @brief The rows of a virtualized container, null for other boxes.
+    const VirtualList* GetVirtualList(LayoutIndex in_uiIndex) const;
+
+    /// @brief The tracks and item areas of a grid container, null for other boxes.
+    const GridLayout* GetGrid(LayoutIndex in_uiIndex) const;
+
+    const Stats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+  private:
+    struct GridContainer
+    {
+      GridLayout m_Layout;
+      /// @brief The boxes of the items, in the order of the GridLayout. Absolutely positioned children are not items.
+      nsDynamicArray<LayoutIndex> m_Items;
+      /// @brief The area each item was last laid out in, so unchanged items aren't laid out again.
+      nsDynamicArray<nsRectFloat> m_LaidOutAreas;
+    };
+
+    struct ParallelRoot
+    {
+      LayoutIndex m_uiBox = InvalidLayoutIndex;
+      /// @brief Takes the place of the box in the Yoga tree of its parent, with the outer style of the box.
+      YGNodeRef m_pStandIn = nullptr;
+      YGConfigRef m_pConfig = nullptr;
+      /// @brief The size the root was last laid out with.
+      float m_fWidth = YGUndefined;
+      float m_fHeight = YGUndefined;
+    };
+
+    LayoutIndex AddBox(const dom::DOMNode* in_pNode, const css::ComputedStyle* in_pStyle, LayoutBoxType in_type, LayoutIndex in_uiParent, LayoutIndex& inout_uiPrevious);
+    LayoutIndex AddBlockBox(const dom::DOMElement& in_element, const css::ComputedStyle* in_pStyle, LayoutIndex in_uiParent, LayoutIndex& inout_uiPrevious);
+    void BuildChildren(const dom::DOMElement& in_element, LayoutIndex in_uiBox);
+    void BuildVirtualList(const dom::DOMElement& in_element, LayoutIndex in_uiBox);
+    void BuildGrid(LayoutIndex in_uiBox);
+    void BuildInlineContent(const dom::DOMNode& in_node, const css::ComputedStyle* in_pStyle, LayoutIndex in_uiParent, LayoutIndex& inout_uiPrevious);
+
+    /// @brief Whether a box of the type and style is laid out on its own, see SetMaxThreads().
+    bool IsParallelRoot(LayoutBoxType in_type, const css::ComputedStyle& in_style, LayoutIndex in_uiParent) const;
+    YGNodeRef GetStandIn(LayoutIndex in_uiIndex) const;
+
+    /// @brief The node a paragraph is kept by across builds: the node of the box, or for anonymous boxes the first node of their content.
+    const dom::DOMNode* GetInlineContentKey(LayoutIndex in_uiIndex) const;
+
+    void ApplyStyle(LayoutIndex in_uiIndex);
+    /// @brief Collects the text and items of the inline content of the box, marks its Yoga node dirty if they changed.
+    void UpdateInlineContent(LayoutIndex in_uiIndex);
+    /// @brief Takes over the template of the grid and the placements of its items from their styles.
+    void UpdateGridStyle(LayoutIndex in_uiIndex);
+    /// @brief The tree of the laid out row of a virtualized container that contains the node.
+    LayoutTree* FindRowTree(const dom::DOMNode* in_pNode) const;
+
+    void CalculateYoga(float in_fWidth, float in_fHeight);
+    /// @brief Hashes everything the layout of the tree depends on besides the available size, 0 if it can't be cached.
+    nsUInt64 GetFragmentHash() const;
+    /// @brief Copies the boxes from the fragment of an identical tree, returns false if the cache has none.
+    bool ApplyFragment(nsUInt64 in_uiHash, float in_fWidth, float in_fHeight);
+    void StoreFragment(nsUInt64 in_uiHash, float in_fWidth, float in_fHeight);
+    bool IsYogaDirty() const;
+    /// @brief Lays out the independent formatting roots that are dirty or got a new size, returns their indices.
+    void LayoutParallelRoots(nsDynamicArray<nsUInt32>& out_laidOut);
+    /// @brief Lays out the rows in view of the virtualized containers, returns true if the height of any of their content changed.
+    bool UpdateVirtualLists();
+    /// @brief Marks the grids with dirty items dirty, since the Yoga nodes of items are not part of the tree of their grid.
+    void SyncGrids();
+    /// @brief Sizes the tracks of a grid for its content box, measuring the items it needs contributions of.
+    void LayoutGrid(LayoutIndex in_uiIndex, float in_fWidth, float in_fHeight);
+    /// @brief The min-content width of the margin box of a block-level box, for the contributions of grid items.
+    float GetMinContentWidth(LayoutIndex in_uiIndex);
+    void ReadBack(LayoutIndex in_uiIndex);
+    /// @param in_contentBox The content box of the box, relative to its border box.
+    void PlaceInlineContent(LayoutIndex in_uiIndex, const nsRectFloat& in_contentBox);
+    void PlaceGridItems(LayoutIndex in_uiIndex);
+
+    static YGSize MeasureInlineContent(YGNodeConstRef in_pNode, float in_fWidth, YGMeasureMode in_widthMode, float in_fHeight, YGMeasureMode in_heightMode);
+    static YGSize MeasureVirtualList(YGNodeConstRef in_pNode, float in_fWidth, YGMeasureMode in_widthMode, float in_fHeight, YGMeasureMode in_heightMode);
+    static YGSize MeasureGrid(YGNodeConstRef in_pNode, float in_fWidth, YGMeasureMode in_widthMode, float in_fHeight, YGMeasureMode in_heightMode);
+
+    nsDynamicArray<LayoutBox> m_Boxes;
+    nsDynamicArray<InlineParagraph> m_InlineContent;
+    /// @brief The paragraphs of the previous build by the node of their box, only set while building.
+    nsDynamicArray<InlineParagraph> m_PreviousInlineContent;
+    nsHashTable<const dom::DOMNode*, nsUInt32> m_PreviousInlineContentKeys;
+    nsDynamicArray<VirtualList> m_VirtualLists;
+    nsDynamicArray<LayoutIndex> m_VirtualListBoxes;
+    /// @brief The lists of the previous build by the node of their box, so measured rows are kept. Only set while building.
+    nsDynamicArray<VirtualList> m_PreviousVirtualLists;
+    nsHashTable<const dom::DOMNode*, nsUInt32> m_PreviousVirtualListKeys;
+    nsDynamicArray<GridContainer> m_Grids;
+    /// @brief In post-order, grids nested in items come before the grid of the item.
+    nsDynamicArray<LayoutIndex> m_GridBoxes;
+    nsDynamicArray<ParallelRoot> m_ParallelRoots;
+    nsHashTable<LayoutIndex, nsUInt32> m_ParallelRootKeys;
+    nsHashTable<const dom::DOMNode*, LayoutIndex> m_NodeToBox;
+    nsDynamicArray<LayoutIndex> m_ChangedBoxes;
+
+    dom::DOMElement* m_pRoot = nullptr;
+    YGConfigRef m_pConfig = nullptr;
+    TextMeasureCache* m_pTextCache = nullptr;
+    LayoutFragmentCache* m_pFragmentCache = nullptr;
+
+    float m_fLastWidth = 0.0f;
+    float m_fLastHeight = 0.0f;
+    float m_fRootMarginRight = 0.0f;
+    float m_fRootMarginBottom = 0.0f;
+    float m_fVirtualListOverscan = 200.0f;
+    nsUInt32 m_uiMaxThreads = 1;
+    nsUInt32 m_uiLayoutGeneration = 0;
+    bool m_bVirtualListsDirty = false;
+    bool m_bGridsDirty = false;
+    bool m_bHasLayout = false;
+    /// @brief False until Yoga laid out the tree after a build. Until then its dirty flags don't tell whether the boxes,
+    /// copied from a fragment, are still valid, m_bContentDirty does.
+    bool m_bYogaLaidOut = false;
+    bool m_bContentDirty = false;
+    bool m_bStructureDirty = false;
+    Stats m_Stats;
+  };
+} // namespace aperture::layout
@@ -0,0 +1,118 @@
+#include <APHTML/layout/Core/SnappedLayout.h>
+#include <Foundation/Profiling/Profiling.h>
+
+using namespace aperture;
+using namespace aperture::layout;
+
+namespace
+{
+  // Halves always go the same way, so an edge shared by two boxes ends up on the same device pixel for both.
+  float SnapEdge(float in_fValue, float in_fScale)
+  {
+    return nsMath::Floor(in_fValue * in_fScale + 0.5f);
+  }
+} // namespace
+
+SnappedLayout::SnappedLayout(float in_fScale)
+  : m_fScale(in_fScale)
+{
+}
+
+void SnappedLayout::SetScale(float in_fScale)
+{
+  if (m_fScale != in_fScale)
+  {
+    m_fScale = in_fScale;
+    m_bValid = false;
+  }
+}
+
+void SnappedLayout::Update(const LayoutTree& in_tree)
+{
+  const nsUInt32 uiGeneration = in_tree.GetLayoutGeneration();
+  const bool bValid = m_bValid && m_pTree == &in_tree && m_Boxes.GetCount() == in_tree.GetBoxCount();
+  if (bValid && uiGeneration == m_uiGeneration)
+    return;
+
+  NS_PROFILE_SCOPE("SnappedLayout::Update");
+  ++m_Stats.m_uiUpdates;
+
+  // The changed boxes are only the ones of the last pass.
+  if (!bValid || uiGeneration != m_uiGeneration + 1)
+  {
+    ++m_Stats.m_uiFullUpdates;
+    m_Boxes.SetCountUninitialized(in_tree.GetBoxCount());
+    SnapRange(in_tree, 0, in_tree.GetBoxCount());
+  }
+  else
+  {
+    // Children are relative to the origin of their parent, a box that moved moves its whole subtree, one that only
+    // changed its size doesn't. Parents are handled before their children, changed boxes in a moved subtree are covered.
+    m_ChangedBoxes = in_tree.GetChangedBoxes();
+    m_ChangedBoxes.Sort();
+
+    LayoutIndex uiCoveredEnd = 0;
+    for (LayoutIndex uiIndex : m_ChangedBoxes)
+    {
+      if (uiIndex < uiCoveredEnd)
+        continue;
+
+      const nsRectFloat previous = m_Boxes[uiIndex].m_LayoutRect;
+      SnapRange(in_tree, uiIndex, uiIndex + 1);
+      if (m_Boxes[uiIndex].m_LayoutRect.x != previous.x || m_Boxes[uiIndex].m_LayoutRect.y != previous.y)
+      {
+        uiCoveredEnd = GetSubtreeEnd(in_tree, uiIndex);
+        SnapRange(in_tree, uiIndex + 1, uiCoveredEnd);
+      }
+    }
+  }
+
+  m_pTree = &in_tree;
+  m_uiGeneration = uiGeneration;
+  m_bValid = true;
+}
+
+void SnappedLayout::Clear()
+{
+  m_Boxes.Clear();
+  m_ChangedBoxes.Clear();
+  m_pTree = nullptr;
+  m_bValid = false;
+}
+
+nsRectFloat SnappedLayout::Snap(const nsRectFloat& in_rect) const
+{
+  const float fLeft = SnapEdge(in_rect.x, m_fScale);
+  const float fTop = SnapEdge(in_rect.y, m_fScale);
+  return nsRectFloat(fLeft, fTop, SnapEdge(in_rect.x + in_rect.width, m_fScale) - fLeft, SnapEdge(in_rect.y + in_rect.height, m_fScale) - fTop);
+}
+
+void SnappedLayout::SnapRange(const LayoutTree& in_tree, LayoutIndex in_uiStart, LayoutIndex in_uiEnd)
+{
+  // Parents come before their children in pre-order, their absolute position is known when the children are reached.
+  for (LayoutIndex i = in_uiStart; i < in_uiEnd; ++i)
+  {
+    const LayoutBox& box = in_tree.GetBox(i);
+    SnappedBox& snapped = m_Boxes[i];
+
+    snapped.m_LayoutRect = box.GetRect();
+    if (box.m_uiParent != InvalidLayoutIndex)
+    {
+      snapped.m_LayoutRect.x += m_Boxes[box.m_uiParent].m_LayoutRect.x;
+      snapped.m_LayoutRect.y += m_Boxes[box.m_uiParent].m_LayoutRect.y;
+    }
+    snapped.m_Rect = Snap(snapped.m_LayoutRect);
+  }
+  m_Stats.m_uiSnappedBoxes += in_uiEnd - in_uiStart;
+}
+
+LayoutIndex SnappedLayout::GetSubtreeEnd(const LayoutTree& in_tree, LayoutIndex in_uiIndex)
+{
+  for (LayoutIndex uiIndex = in_uiIndex; uiIndex != InvalidLayoutIndex; uiIndex = in_tree.GetBox(uiIndex).m_uiParent)
+  {
+    const LayoutIndex uiNext = in_tree.GetBox(uiIndex).m_uiNextSibling;
+    if (uiNext != InvalidLayoutIndex)
+      return uiNext;
+  }
+  return in_tree.GetBoxCount();
+}
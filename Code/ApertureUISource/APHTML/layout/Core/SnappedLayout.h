@@ -0,0 +1,115 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Math/Rect.h>
+
+namespace aperture::layout
+{
+  /*
+   * @brief The boxes of a LayoutTree snapped to the device pixel grid of one render target.
+   *
+   * Layout is computed in CSS px and isn't rounded, so its result doesn't depend on the scale it is rendered at. Each
+   * render target (the main view, a high resolution screenshot, a split-screen copy) keeps a SnappedLayout with its own
+   * scale and updates it after Calculate(), all of them share the one layout pass.
+   *
+   * The edges of a box are snapped, not its origin and size: boxes that touch in CSS px touch in device pixels as well,
+   * at the cost of sizes that differ by a device pixel. Only the subtrees of the boxes the last Calculate() changed are
+   * snapped again, and only boxes that moved snap their subtree again. A missed pass or a new scale snaps everything.
+   *
+   * Rows of virtualized containers are trees of their own, they are snapped with a SnappedLayout each.
+   *
+   * @note Not thread-safe. It is owned by the thread that runs layout.
+   */
+  class NS_APERTURE_DLL SnappedLayout
+  {
+  public:
+    struct Stats
+    {
+      nsUInt32 m_uiUpdates = 0;
+      /// @brief Updates that snapped every box.
+      nsUInt32 m_uiFullUpdates = 0;
+      nsUInt32 m_uiSnappedBoxes = 0;
+    };
+
+    /// @param in_fScale Device pixels per CSS px, see DPIUtils::calculateLayoutScale().
+    explicit SnappedLayout(float in_fScale = 1.0f);
+
+    void SetScale(float in_fScale);
+    float GetScale() const { return m_fScale; }
+
+    /// @brief Snaps the boxes the tree laid out since the last update. The tree has to be calculated.
+    void Update(const LayoutTree& in_tree);
+    void Clear();
+
+    /// @brief The border box of a box in device pixels, in the coordinate space of the root.
+    const nsRectFloat& GetRect(LayoutIndex in_uiIndex) const { return m_Boxes[in_uiIndex].m_Rect; }
+
+    /// @brief The border box of a box in CSS px, in the coordinate space of the root. Same as LayoutTree::GetAbsoluteRect().
+    const nsRectFloat& GetLayoutRect(LayoutIndex in_uiIndex) const { return m_Boxes[in_uiIndex].m_LayoutRect; }
+
+    /// @brief Snaps a rect in CSS px in the coordinate space of the root, e.g. a fragment of inline content.
+    nsRectFloat Snap(const nsRectFloat& in_rect) const;
+
+    nsUInt32 GetBoxCount() const { return m_Boxes.GetCount(); }
+    const Stats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+  private:
+    struct SnappedBox
+    {
+      NS_DECLARE_POD_TYPE();
+
+      nsRectFloat m_LayoutRect;
+      nsRectFloat m_Rect;
+    };
+
+    /// @brief Snaps the boxes in [in_uiStart, in_uiEnd), their parents have to be snapped already.
+    void SnapRange(const LayoutTree& in_tree, LayoutIndex in_uiStart, LayoutIndex in_uiEnd);
+    /// @brief The end of the subtree of a box, which is contiguous in pre-order.
+    static LayoutIndex GetSubtreeEnd(const LayoutTree& in_tree, LayoutIndex in_uiIndex);
+
+    nsDynamicArray<SnappedBox> m_Boxes;
+    nsDynamicArray<LayoutIndex> m_ChangedBoxes;
+    const LayoutTree* m_pTree = nullptr;
+    nsUInt32 m_uiGeneration = 0;
+    float m_fScale = 1.0f;
+    bool m_bValid = false;
+    Stats m_Stats;
+  };
+} // namespace aperture::layout
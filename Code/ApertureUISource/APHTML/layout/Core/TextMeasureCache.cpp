@@ -0,0 +1,147 @@
+#include <APHTML/layout/Core/TextMeasureCache.h>
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/Profiling/Profiling.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace aperture;
+using namespace aperture::layout;
+
+FontMetrics TextMeasurer::GetFontMetrics(nsUInt64 in_uiFontKey)
+{
+  const float fHeight = MeasureText(" ", in_uiFontKey, std::numeric_limits<float>::infinity()).height;
+
+  FontMetrics metrics;
+  metrics.m_fAscent = fHeight * 0.8f;
+  metrics.m_fDescent = fHeight * 0.2f;
+  metrics.m_fXHeight = metrics.m_fAscent * 0.5f;
+  return metrics;
+}
+
+TextMeasureCache::TextMeasureCache(TextMeasurer* in_pMeasurer, nsUInt32 in_uiGenerationSize)
+  : m_pMeasurer(in_pMeasurer)
+  , m_uiGenerationSize(nsMath::Max(in_uiGenerationSize, 1u))
+{
+  NS_ASSERT_DEV(m_pMeasurer != nullptr, "A TextMeasureCache needs a TextMeasurer.");
+}
+
+nsUInt64 TextMeasureCache::MakeFontKey(std::string_view in_family, float in_fSize, nsUInt16 in_uiWeight, bool in_bItalic)
+{
+  nsUInt32 uiSizeBits = 0;
+  memcpy(&uiSizeBits, &in_fSize, sizeof(float));
+
+  const nsUInt64 uiFamily = in_family.empty() ? 0 : nsHashingUtils::xxHash32(in_family.data(), in_family.size());
+  const nsUInt64 uiStyle = (static_cast<nsUInt64>(in_uiWeight) << 1) | (in_bItalic ? 1u : 0u);
+  return (uiFamily << 32 | uiSizeBits) ^ (uiStyle << 47);
+}
+
+Size TextMeasureCache::Measure(std::string_view in_text, nsUInt64 in_uiFontKey, float in_fMaxWidth)
+{
+  // Yoga passes NaN for unconstrained axes, all of them have to end up as the same key.
+  const float fMaxWidth = std::isnan(in_fMaxWidth) ? std::numeric_limits<float>::infinity() : in_fMaxWidth;
+
+  Entry entry;
+  entry.m_uiTextHash = nsHashingUtils::xxHash64(in_text.data(), in_text.size());
+  entry.m_uiFontKey = in_uiFontKey;
+  entry.m_fMaxWidth = fMaxWidth;
+  entry.m_uiTextLength = static_cast<nsUInt32>(in_text.size());
+
+  nsUInt32 uiWidthBits = 0;
+  memcpy(&uiWidthBits, &fMaxWidth, sizeof(float));
+
+  const nsUInt64 parts[3] = {entry.m_uiTextHash, in_uiFontKey, (static_cast<nsUInt64>(entry.m_uiTextLength) << 32) | uiWidthBits};
+  const nsUInt64 uiKey = nsHashingUtils::xxHash64(parts, sizeof(parts));
+
+  auto matches = [&](const Entry& other)
+  {
+    return other.m_uiTextHash == entry.m_uiTextHash && other.m_uiFontKey == entry.m_uiFontKey && other.m_fMaxWidth == entry.m_fMaxWidth &&
+           other.m_uiTextLength == entry.m_uiTextLength;
+  };
+
+  {
+    NS_LOCK(m_Mutex);
+    if (const Entry* pEntry = m_Current.GetValue(uiKey); pEntry != nullptr && matches(*pEntry))
+    {
+      ++m_Stats.m_uiHits;
+      return pEntry->m_Size;
+    }
+
+    Entry old;
+    if (m_Old.Remove(uiKey, &old) && matches(old))
+    {
+      ++m_Stats.m_uiHits;
+      entry.m_Size = old.m_Size;
+      Insert(uiKey, entry);
+      return entry.m_Size;
+    }
+    ++m_Stats.m_uiMisses;
+  }
+
+  {
+    NS_PROFILE_SCOPE("MeasureText");
+    NS_LOCK(m_MeasurerMutex);
+    entry.m_Size = m_pMeasurer->MeasureText(in_text, in_uiFontKey, fMaxWidth);
+  }
+
+  NS_LOCK(m_Mutex);
+  Insert(uiKey, entry);
+  return entry.m_Size;
+}
+
+void TextMeasureCache::Insert(nsUInt64 in_uiKey, const Entry& in_entry)
+{
+  if (m_Current.GetCount() >= m_uiGenerationSize)
+  {
+    m_Old.Swap(m_Current);
+    m_Current.Clear();
+  }
+  m_Current.Insert(in_uiKey, in_entry);
+}
+
+FontMetrics TextMeasureCache::GetFontMetrics(nsUInt64 in_uiFontKey)
+{
+  {
+    NS_LOCK(m_Mutex);
+    if (const FontMetrics* pMetrics = m_Metrics.GetValue(in_uiFontKey))
+      return *pMetrics;
+  }
+
+  // Like Measure(), the backend is called without holding the lock of the lookups. Threads that miss the same font at
+  // once all ask for it and insert the same metrics.
+  FontMetrics metrics;
+  {
+    NS_LOCK(m_MeasurerMutex);
+    metrics = m_pMeasurer->GetFontMetrics(in_uiFontKey);
+  }
+
+  NS_LOCK(m_Mutex);
+  m_Metrics.Insert(in_uiFontKey, metrics);
+  return metrics;
+}
+
+void TextMeasureCache::Clear()
+{
+  NS_LOCK(m_Mutex);
+  m_Current.Clear();
+  m_Old.Clear();
+  m_Metrics.Clear();
+}
+
+nsUInt32 TextMeasureCache::GetCount() const
+{
+  NS_LOCK(m_Mutex);
+  return m_Current.GetCount() + m_Old.GetCount();
+}
+
+TextMeasureCache::Stats TextMeasureCache::GetStats() const
+{
+  NS_LOCK(m_Mutex);
+  return m_Stats;
+}
+
+void TextMeasureCache::ResetStats()
+{
+  NS_LOCK(m_Mutex);
+  m_Stats = {};
+}
@@ -0,0 +1,136 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <APHTML/layout/Core/LayoutDefinitions.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Threading/Mutex.h>
+#include <string_view>
+
+namespace aperture::layout
+{
+  /// @brief Vertical metrics of a font, in px. Ascent and descent are both positive.
+  struct FontMetrics
+  {
+    float m_fAscent = 0.0f;
+    float m_fDescent = 0.0f;
+    float m_fXHeight = 0.0f;
+  };
+
+  /// @brief Shapes a run of text, implemented by the font backend.
+  class NS_APERTURE_DLL TextMeasurer
+  {
+  public:
+    virtual ~TextMeasurer() = default;
+
+    /// @param in_fMaxWidth The width the text has to wrap at, infinity if it must not wrap.
+    virtual Size MeasureText(std::string_view in_text, nsUInt64 in_uiFontKey, float in_fMaxWidth) = 0;
+
+    /// @brief The default splits the height of a space 4:1 into ascent and descent, backends should return the real metrics.
+    virtual FontMetrics GetFontMetrics(nsUInt64 in_uiFontKey);
+  };
+
+  /*
+   * @brief Caches text measurements by (text, font, width constraint).
+   *
+   * Yoga calls the measure function of a text leaf with several constraints per layout pass, and again whenever a sibling
+   * changes. Shaping is by far the most expensive part of that, so every result is kept here and a relayout of unchanged
+   * text never reaches the TextMeasurer.
+   *
+   * The text is hashed instead of interned, since labels of games change every frame (timers, scores) and atoms are never
+   * released. Entries live in two generations: once the current one holds in_uiGenerationSize entries it becomes the old
+   * one and the previous old one is dropped. Hits in the old generation are moved back, so text that is still on screen
+   * survives and the cache stays bounded without tracking any usage per entry.
+   *
+   * @note Thread-safe, subtrees laid out in parallel share the cache. Calls into the TextMeasurer are serialized, a thread
+   * that shapes a new text doesn't block the lookups of the others.
+   */
+  class NS_APERTURE_DLL TextMeasureCache
+  {
+  public:
+    struct Stats
+    {
+      nsUInt32 m_uiHits = 0;
+      nsUInt32 m_uiMisses = 0;
+    };
+
+    TextMeasureCache(TextMeasurer* in_pMeasurer, nsUInt32 in_uiGenerationSize = 4096);
+
+    /// @brief Combines the properties that affect shaping into the font key passed to Measure().
+    /// @param in_family The raw font-family text, it is hashed into the key and doesn't have to outlive the call.
+    static nsUInt64 MakeFontKey(std::string_view in_family, float in_fSize, nsUInt16 in_uiWeight, bool in_bItalic);
+
+    /// @param in_fMaxWidth The width the text has to wrap at, infinity (or NaN, as passed by Yoga) if it must not wrap.
+    Size Measure(std::string_view in_text, nsUInt64 in_uiFontKey, float in_fMaxWidth);
+
+    /// @brief Metrics are kept for every font key that was asked for, there are only a few of them.
+    FontMetrics GetFontMetrics(nsUInt64 in_uiFontKey);
+
+    /// @brief Has to be called when fonts are (re)loaded, all results are dropped.
+    void Clear();
+
+    nsUInt32 GetCount() const;
+    /// @brief Returns a copy, other threads may be measuring at the same time.
+    Stats GetStats() const;
+    void ResetStats();
+
+  private:
+    struct Entry
+    {
+      NS_DECLARE_POD_TYPE();
+
+      /// @brief The table key is a hash of these fields, which are compared on lookup as well. The text itself is not
+      /// kept, only its 64 bit hash and length, so two texts only collide if both of those match.
+      nsUInt64 m_uiTextHash;
+      nsUInt64 m_uiFontKey;
+      float m_fMaxWidth;
+      nsUInt32 m_uiTextLength;
+      Size m_Size;
+    };
+
+    /// @brief Has to be called with m_Mutex locked.
+    void Insert(nsUInt64 in_uiKey, const Entry& in_entry);
+
+    TextMeasurer* m_pMeasurer = nullptr;
+    nsUInt32 m_uiGenerationSize = 0;
+    nsHashTable<nsUInt64, Entry> m_Current;
+    nsHashTable<nsUInt64, Entry> m_Old;
+    nsHashTable<nsUInt64, FontMetrics> m_Metrics;
+    Stats m_Stats;
+    mutable nsMutex m_Mutex;
+    nsMutex m_MeasurerMutex;
+  };
+} // namespace aperture::layout
@@ -0,0 +1,310 @@
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <APHTML/css/Style/ComputedStyle.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+#include <APHTML/layout/Core/VirtualList.h>
+#include <Foundation/Profiling/Profiling.h>
+
+using namespace aperture;
+using namespace aperture::layout;
+
+namespace
+{
+  bool IsDisplayNone(const dom::DOMElement& in_element)
+  {
+    const css::ComputedStyle* pStyle = in_element.getComputedStyle();
+    return pStyle != nullptr && pStyle->Get(PropertyId::Display).IsKeyword(css::CSSPropertyTable::GetKeywords().m_None);
+  }
+
+  // Rows are stacked in block flow, the height of a row is the height of its margin box.
+  float GetRowHeight(const LayoutTree& in_tree)
+  {
+    return in_tree.GetRootMarginBoxSize().height;
+  }
+} // namespace
+
+VirtualList::VirtualList() = default;
+VirtualList::~VirtualList() = default;
+VirtualList::VirtualList(VirtualList&& other) noexcept = default;
+VirtualList& VirtualList::operator=(VirtualList&& other) noexcept = default;
+
+void VirtualList::SetRows(const dom::DOMElement& in_container)
+{
+  NS_PROFILE_SCOPE("VirtualList::SetRows");
+
+  nsDynamicArray<dom::DOMElement*> rows;
+  rows.Reserve(static_cast<nsUInt32>(in_container.getChildNodes().size()));
+  for (const std::shared_ptr<dom::DOMNode>& pChild : in_container.getChildNodes())
+  {
+    if (pChild == nullptr || pChild->getNodeType() != dom::DOMNodeType::ELEMENT_NODE)
+      continue;
+
+    dom::DOMElement* pElement = static_cast<dom::DOMElement*>(pChild.get());
+    if (!IsDisplayNone(*pElement))
+      rows.PushBack(pElement);
+  }
+
+  // Appending rows, the common case for logs and leaderboards, keeps all measurements.
+  nsDynamicArray<float> heights;
+  heights.SetCountUninitialized(rows.GetCount());
+  m_fMeasuredHeight = 0.0;
+  m_uiMeasuredRows = 0;
+  for (nsUInt32 i = 0; i < rows.GetCount(); ++i)
+  {
+    heights[i] = i < m_Rows.GetCount() && m_Rows[i] == rows[i] ? m_Heights[i] : -1.0f;
+    if (heights[i] >= 0.0f)
+    {
+      m_fMeasuredHeight += heights[i];
+      ++m_uiMeasuredRows;
+    }
+  }
+
+  m_Rows.Swap(rows);
+  m_Heights.Swap(heights);
+  RebuildHeightSums();
+
+  // Rows that are still at the same index keep their tree, its content may have changed though.
+  for (nsUInt32 i = m_Slots.GetCount(); i-- > 0;)
+  {
+    Slot& slot = m_Slots[i];
+    if (slot.m_uiRow < m_Rows.GetCount() && m_Rows[slot.m_uiRow] == rows[slot.m_uiRow])
+    {
+      slot.m_pTree->MarkStructureDirty();
+      continue;
+    }
+
+    m_FreeTrees.PushBack(std::move(slot.m_pTree));
+    m_Slots.RemoveAtAndSwap(i);
+  }
+}
+
+void VirtualList::SetFragmentCache(LayoutFragmentCache* in_pCache)
+{
+  m_pFragmentCache = in_pCache;
+  for (Slot& slot : m_Slots)
+    slot.m_pTree->SetFragmentCache(in_pCache);
+}
+
+bool VirtualList::Update(TextMeasureCache* in_pTextCache, float in_fWidth, float in_fViewportHeight, float in_fOverscan)
+{
+  NS_PROFILE_SCOPE("VirtualList::Update");
+
+  const float fContentHeight = GetContentHeight();
+
+  if (in_pTextCache != m_pTextCache || in_fWidth != m_fWidth)
+  {
+    m_pTextCache = in_pTextCache;
+    m_fWidth = in_fWidth;
+    ResetHeights();
+    for (Slot& slot : m_Slots)
+      slot.m_pTree->SetTextMeasureCache(in_pTextCache);
+  }
+
+  m_VisibleRows.Clear();
+  const nsUInt32 uiCount = m_Rows.GetCount();
+  if (uiCount == 0)
+  {
+    ReleaseRows(0, 0);
+    return GetContentHeight() != fContentHeight;
+  }
+
+  const nsUInt32 uiAnchor = FindRow(m_fScrollOffset);
+  const float fAnchorOffset = m_fScrollOffset - GetRowOffset(uiAnchor);
+
+  // The estimates only place the first row of the window, the window then ends with the actual heights of its rows.
+  const float fTop = m_fScrollOffset - in_fOverscan;
+  const float fBottom = m_fScrollOffset + in_fViewportHeight + in_fOverscan;
+  const nsUInt32 uiFirst = FindRow(fTop);
+  ReleaseRows(uiFirst, FindRow(fBottom) + 1);
+
+  nsHybridArray<const LayoutTree*, 64> trees;
+  nsUInt32 uiEnd = uiFirst;
+  while (uiEnd < uiCount && (uiEnd == uiFirst || GetRowOffset(uiEnd) < fBottom))
+  {
+    LayoutTree& tree = AcquireRow(uiEnd);
+    tree.Calculate(in_fWidth, YGUndefined);
+    SetRowHeight(uiEnd, GetRowHeight(tree));
+    trees.PushBack(&tree);
+    ++uiEnd;
+  }
+  ReleaseRows(uiFirst, uiEnd);
+
+  // Scroll anchoring: rows measured above the viewport don't move the content in view.
+  if (m_fScrollOffset > 0.0f)
+    m_fScrollOffset = nsMath::Max(0.0f, GetRowOffset(uiAnchor) + fAnchorOffset);
+
+  float fY = GetRowOffset(uiFirst);
+  for (nsUInt32 uiRow = uiFirst; uiRow < uiEnd; ++uiRow)
+  {
+    VirtualRow& row = m_VisibleRows.ExpandAndGetRef();
+    row.m_uiRow = uiRow;
+    row.m_fY = fY;
+    row.m_fHeight = m_Heights[uiRow];
+    row.m_pTree = trees[uiRow - uiFirst];
+    fY += row.m_fHeight;
+  }
+
+  return GetContentHeight() != fContentHeight;
+}
+
+float VirtualList::GetContentHeight() const
+{
+  return static_cast<float>(m_fMeasuredHeight + static_cast<double>(m_Rows.GetCount() - m_uiMeasuredRows) * GetEstimatedRowHeight());
+}
+
+float VirtualList::GetRowOffset(nsUInt32 in_uiRow) const
+{
+  double fHeight = 0.0;
+  nsUInt32 uiMeasured = 0;
+  for (nsUInt32 i = nsMath::Min(in_uiRow, m_Rows.GetCount()); i > 0; i -= i & (~i + 1))
+  {
+    fHeight += m_HeightSums[i];
+    uiMeasured += m_MeasuredCounts[i];
+  }
+  return static_cast<float>(fHeight + static_cast<double>(in_uiRow - uiMeasured) * GetEstimatedRowHeight());
+}
+
+nsUInt32 VirtualList::FindRow(float in_fOffset) const
+{
+  const nsUInt32 uiCount = m_Rows.GetCount();
+  if (uiCount == 0)
+    return 0;
+
+  // Descends the Fenwick trees to the longest prefix of rows that ends at or before the offset.
+  const double fEstimate = GetEstimatedRowHeight();
+  nsUInt32 uiRows = 0;
+  double fHeight = 0.0;
+  nsUInt32 uiMeasured = 0;
+  for (nsUInt32 uiStep = nsMath::PowerOfTwo_Floor(uiCount); uiStep > 0; uiStep >>= 1)
+  {
+    const nsUInt32 uiNext = uiRows + uiStep;
+    if (uiNext > uiCount)
+      continue;
+
+    const double fNextHeight = fHeight + m_HeightSums[uiNext];
+    const nsUInt32 uiNextMeasured = uiMeasured + m_MeasuredCounts[uiNext];
+    if (fNextHeight + static_cast<double>(uiNext - uiNextMeasured) * fEstimate <= in_fOffset)
+    {
+      uiRows = uiNext;
+      fHeight = fNextHeight;
+      uiMeasured = uiNextMeasured;
+    }
+  }
+  return nsMath::Min(uiRows, uiCount - 1);
+}
+
+LayoutTree* VirtualList::FindRowTree(const dom::DOMNode* in_pNode) const
+{
+  for (const Slot& slot : m_Slots)
+  {
+    if (slot.m_pTree->FindBox(in_pNode) != InvalidLayoutIndex)
+      return slot.m_pTree.get();
+  }
+  return nullptr;
+}
+
+float VirtualList::GetEstimatedRowHeight() const
+{
+  return m_uiMeasuredRows > 0 ? static_cast<float>(m_fMeasuredHeight / m_uiMeasuredRows) : m_fEstimatedRowHeight;
+}
+
+void VirtualList::SetRowHeight(nsUInt32 in_uiRow, float in_fHeight)
+{
+  const float fPrevious = m_Heights[in_uiRow];
+  if (fPrevious == in_fHeight)
+    return;
+
+  const double fDelta = fPrevious >= 0.0f ? in_fHeight - fPrevious : in_fHeight;
+  const nsUInt32 uiMeasured = fPrevious >= 0.0f ? 0 : 1;
+  m_Heights[in_uiRow] = in_fHeight;
+  m_fMeasuredHeight += fDelta;
+  m_uiMeasuredRows += uiMeasured;
+
+  const nsUInt32 uiCount = m_Rows.GetCount();
+  for (nsUInt32 i = in_uiRow + 1; i <= uiCount; i += i & (~i + 1))
+  {
+    m_HeightSums[i] += fDelta;
+    m_MeasuredCounts[i] += uiMeasured;
+  }
+}
+
+void VirtualList::ResetHeights()
+{
+  // The average stays the estimate, so the content height doesn't collapse until the rows are measured again.
+  m_fEstimatedRowHeight = GetEstimatedRowHeight();
+  m_fMeasuredHeight = 0.0;
+  m_uiMeasuredRows = 0;
+  for (float& fHeight : m_Heights)
+    fHeight = -1.0f;
+  RebuildHeightSums();
+}
+
+void VirtualList::RebuildHeightSums()
+{
+  const nsUInt32 uiCount = m_Rows.GetCount();
+  m_HeightSums.SetCountUninitialized(uiCount + 1);
+  m_MeasuredCounts.SetCountUninitialized(uiCount + 1);
+  for (nsUInt32 i = 0; i <= uiCount; ++i)
+  {
+    m_HeightSums[i] = 0.0;
+    m_MeasuredCounts[i] = 0;
+  }
+
+  // Linear construction: every node adds its sum to its parent.
+  for (nsUInt32 i = 1; i <= uiCount; ++i)
+  {
+    if (m_Heights[i - 1] >= 0.0f)
+    {
+      m_HeightSums[i] += m_Heights[i - 1];
+      m_MeasuredCounts[i] += 1;
+    }
+
+    const nsUInt32 uiParent = i + (i & (~i + 1));
+    if (uiParent <= uiCount)
+    {
+      m_HeightSums[uiParent] += m_HeightSums[i];
+      m_MeasuredCounts[uiParent] += m_MeasuredCounts[i];
+    }
+  }
+}
+
+LayoutTree& VirtualList::AcquireRow(nsUInt32 in_uiRow)
+{
+  for (const Slot& slot : m_Slots)
+  {
+    if (slot.m_uiRow == in_uiRow)
+      return *slot.m_pTree;
+  }
+
+  Slot& slot = m_Slots.ExpandAndGetRef();
+  slot.m_uiRow = in_uiRow;
+  if (!m_FreeTrees.IsEmpty())
+  {
+    slot.m_pTree = std::move(m_FreeTrees.PeekBack());
+    m_FreeTrees.PopBack();
+    ++m_Stats.m_uiRecycledRows;
+  }
+  else
+  {
+    slot.m_pTree = std::make_unique<LayoutTree>();
+  }
+
+  slot.m_pTree->SetTextMeasureCache(m_pTextCache);
+  slot.m_pTree->SetFragmentCache(m_pFragmentCache);
+  slot.m_pTree->Build(*m_Rows[in_uiRow]);
+  ++m_Stats.m_uiMaterializedRows;
+  return *slot.m_pTree;
+}
+
+void VirtualList::ReleaseRows(nsUInt32 in_uiFirst, nsUInt32 in_uiEnd)
+{
+  for (nsUInt32 i = m_Slots.GetCount(); i-- > 0;)
+  {
+    const nsUInt32 uiRow = m_Slots[i].m_uiRow;
+    if (uiRow >= in_uiFirst && uiRow < in_uiEnd)
+      continue;
+
+    m_FreeTrees.PushBack(std::move(m_Slots[i].m_pTree));
+    m_Slots.RemoveAtAndSwap(i);
+  }
+}
@@ -0,0 +1,168 @@
+/*
+This code is part of Aperture UI - A HTML/CSS/JS UI Middleware
+
+Copyright (c) 2020-2024 WD Studios L.L.C. and/or its licensors. All
+rights reserved in all media.
+
+The coded instructions, statements, computer programs, and/or related
+material (collectively the "Data") in these files contain confidential
+and unpublished information proprietary WD Studios and/or its
+licensors, which is protected by United States of America federal
+copyright law and by international treaties.
+
+This software or source code is supplied under the terms of a license
+agreement and nondisclosure agreement with WD Studios L.L.C. and may
+not be copied, disclosed, or exploited except in accordance with the
+terms of that agreement. The Data may not be disclosed or distributed to
+third parties, in whole or in part, without the prior written consent of
+WD Studios L.L.C..
+
+WD STUDIOS MAKES NO REPRESENTATION ABOUT THE SUITABILITY OF THIS
+SOURCE CODE FOR ANY PURPOSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER, ITS AFFILIATES,
+PARENT COMPANIES, LICENSORS, SUPPLIERS, OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OR PERFORMANCE OF THIS SOFTWARE OR SOURCE CODE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <APHTML/APEngineCommonIncludes.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <memory>
+
+namespace aperture::dom
+{
+  class DOMNode;
+  class DOMElement;
+} // namespace aperture::dom
+
+namespace aperture::layout
+{
+  class LayoutFragmentCache;
+  class LayoutTree;
+  class TextMeasureCache;
+
+  /// @brief A row of a VirtualList that is laid out.
+  struct VirtualRow
+  {
+    NS_DECLARE_POD_TYPE();
+
+    /// @brief Index of the row in the list.
+    nsUInt32 m_uiRow;
+    /// @brief Top of the row's margin box, relative to the content box of the list without scrolling.
+    float m_fY;
+    float m_fHeight;
+    /// @brief The boxes of the row, relative to its margin box. Only valid until the next update of the list.
+    const LayoutTree* m_pTree;
+  };
+
+  /*
+   * @brief The rows of a virtualized scroll container (an element with the "virtualize" attribute).
+   *
+   * Each child element of the container is a row, stacked in block flow. Only the rows that intersect the viewport of
+   * the container plus an overscan margin are laid out, each in a LayoutTree of its own; trees of rows that leave the
+   * window are recycled for the rows that enter it. Rows that were never laid out count with an estimated height, the
+   * average of the measured rows (or the value of the attribute in px until a row was measured).
+   *
+   * Heights are kept in Fenwick trees, so the offset of a row, the row at an offset and the content height are
+   * O(log n), and an update costs O(visible rows * log n) regardless of the length of the list.
+   *
+   * When rows above the viewport are measured, the scroll offset is adjusted so the first row in view doesn't move.
+   * GetScrollOffset() returns the adjusted offset, the owner of the scroll position should take it over.
+   *
+   * @note Rows are laid out for the width of the list only. Changing the width or the text measure cache forgets all
+   * measured heights.
+   */
+  class NS_APERTURE_DLL VirtualList
+  {
+  public:
+    struct Stats
+    {
+      /// @brief Rows whose boxes were built because they came into view.
+      nsUInt32 m_uiMaterializedRows = 0;
+      /// @brief Of those, rows that reused the tree of a row that went out of view.
+      nsUInt32 m_uiRecycledRows = 0;
+    };
+
+    VirtualList();
+    ~VirtualList();
+    VirtualList(VirtualList&& other) noexcept;
+    VirtualList& operator=(VirtualList&& other) noexcept;
+
+    /// @brief Takes the child elements of the container as rows. Rows that are at the same index as before keep their measured height.
+    void SetRows(const dom::DOMElement& in_container);
+
+    /// @brief The height of rows until any row was measured.
+    void SetEstimatedRowHeight(float in_fHeight) { m_fEstimatedRowHeight = in_fHeight; }
+
+    /// @brief Rows that repeat the same component copy their layout from the cache, see LayoutTree::SetFragmentCache().
+    void SetFragmentCache(LayoutFragmentCache* in_pCache);
+
+    void SetScrollOffset(float in_fOffset) { m_fScrollOffset = nsMath::Max(0.0f, in_fOffset); }
+    float GetScrollOffset() const { return m_fScrollOffset; }
+
+    /// @brief Lays out the rows in view.
+    /// @param in_fWidth, in_fViewportHeight The content box of the container.
+    /// @return True if the content height changed.
+    bool Update(TextMeasureCache* in_pTextCache, float in_fWidth, float in_fViewportHeight, float in_fOverscan);
+
+    nsUInt32 GetRowCount() const { return m_Rows.GetCount(); }
+    float GetContentHeight() const;
+    float GetRowOffset(nsUInt32 in_uiRow) const;
+    /// @brief The row that contains the offset, the last row for offsets past the end.
+    nsUInt32 FindRow(float in_fOffset) const;
+
+    /// @brief The rows that were laid out by the last Update(), in order.
+    nsArrayPtr<const VirtualRow> GetVisibleRows() const { return m_VisibleRows; }
+
+    /// @brief The tree of the laid out row that contains the node, null if the node isn't in a laid out row.
+    LayoutTree* FindRowTree(const dom::DOMNode* in_pNode) const;
+
+    const Stats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+  private:
+    struct Slot
+    {
+      nsUInt32 m_uiRow;
+      std::unique_ptr<LayoutTree> m_pTree;
+    };
+
+    float GetEstimatedRowHeight() const;
+    void SetRowHeight(nsUInt32 in_uiRow, float in_fHeight);
+    void ResetHeights();
+    void RebuildHeightSums();
+
+    LayoutTree& AcquireRow(nsUInt32 in_uiRow);
+    /// @brief Recycles the trees of the rows outside of [in_uiFirst, in_uiEnd).
+    void ReleaseRows(nsUInt32 in_uiFirst, nsUInt32 in_uiEnd);
+
+    nsDynamicArray<dom::DOMElement*> m_Rows;
+    /// @brief Per row, negative if it wasn't measured.
+    nsDynamicArray<float> m_Heights;
+    /// @brief Fenwick trees over the measured heights and the number of measured rows, 1-based.
+    nsDynamicArray<double> m_HeightSums;
+    nsDynamicArray<nsUInt32> m_MeasuredCounts;
+    double m_fMeasuredHeight = 0.0;
+    nsUInt32 m_uiMeasuredRows = 0;
+    float m_fEstimatedRowHeight = 0.0f;
+
+    nsDynamicArray<Slot> m_Slots;
+    nsDynamicArray<std::unique_ptr<LayoutTree>> m_FreeTrees;
+    nsDynamicArray<VirtualRow> m_VisibleRows;
+
+    TextMeasureCache* m_pTextCache = nullptr;
+    LayoutFragmentCache* m_pFragmentCache = nullptr;
+    float m_fWidth = -1.0f;
+    float m_fScrollOffset = 0.0f;
+    Stats m_Stats;
+  };
+} // namespace aperture::layout
@@ -89,5 +89,15 @@ public:
     double diagonalPixels = std::sqrt(pixelWidth * pixelWidth + pixelHeight * pixelHeight);
     return diagonalPixels / screenDiagonal;
   }
+
+  /**
+   * @brief Calculates the scale from CSS pixels, which layout is computed in, to the device pixels of a screen.
+   * @param dpi The DPI of the screen, e.g. from calculateDPI().
+   * @return The device pixels per CSS pixel to snap a layout::SnappedLayout with, 1 at 96 DPI.
+   */
+  static float calculateLayoutScale(double dpi)
+  {
+    return static_cast<float>(dpi / 96.0);
+  }
 };
 }
\ No newline at end of file
@@ -0,0 +1,358 @@
+#include <APHTML/core/CSSController.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <Foundation/Application/Application.h>
+#include <Foundation/IO/FileSystem/DataDirTypeFolder.h>
+#include <Foundation/IO/FileSystem/FileSystem.h>
+#include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Logging/ConsoleWriter.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Logging/VisualStudioWriter.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Time/Stopwatch.h>
+#include <Foundation/Utilities/CommandLineOptions.h>
+
+/* StyleSheetCompiler command line options:
+
+-out <path>
+    Path to a file or folder.
+
+    For a single input file, -out is the compiled file. The file will be overwritten, if it already exists.
+    For multiple inputs or folders, -out is the folder the compiled files are written to, keeping the folder structure.
+
+    If no -out is specified, every compiled file is written next to its source.
+
+-verify
+    Loads every compiled file again and checks that it matches the parsed source.
+
+Description:
+    Compiles CSS files into precompiled binary stylesheets, see aperture::css::CSSStyleSheet::LoadBinaryMapped().
+    Inputs can be files or folders, folders are searched recursively for *.css files.
+    Compiled files get the extension ".cssb".
+
+Examples:
+    StyleSheetCompiler.exe "C:/Game/UI/hud.css"
+      Compiles "C:/Game/UI/hud.css" into "C:/Game/UI/hud.cssb"
+
+    StyleSheetCompiler.exe "C:/Game/UI" -out "C:/Game/Build/UI"
+      Compiles all CSS files in "C:/Game/UI" into "C:/Game/Build/UI"
+*/
+
+nsCommandLineOptionPath opt_Out("_StyleSheetCompiler", "-out", "\
+Path to a file or folder.\n\
+\n\
+For a single input file, -out is the compiled file. The file will be overwritten, if it already exists.\n\
+For multiple inputs or folders, -out is the folder the compiled files are written to, keeping the folder structure.\n\
+\n\
+If no -out is specified, every compiled file is written next to its source.\n\
+",
+  "");
+
+nsCommandLineOptionBool opt_Verify("_StyleSheetCompiler", "-verify", "Loads every compiled file again and checks that it matches the parsed source.", false);
+
+nsCommandLineOptionDoc opt_Desc("_StyleSheetCompiler", "Description:", "", "\
+Compiles CSS files into precompiled binary stylesheets, see aperture::css::CSSStyleSheet::LoadBinaryMapped().\n\
+Inputs can be files or folders, folders are searched recursively for *.css files.\n\
+Compiled files get the extension \".cssb\".\n\
+",
+  "");
+
+nsCommandLineOptionDoc opt_Examples("_StyleSheetCompiler", "Examples:", "", "\
+StyleSheetCompiler.exe \"C:/Game/UI/hud.css\"\n\
+  Compiles \"C:/Game/UI/hud.css\" into \"C:/Game/UI/hud.cssb\"\n\
+\n\
+StyleSheetCompiler.exe \"C:/Game/UI\" -out \"C:/Game/Build/UI\"\n\
+  Compiles all CSS files in \"C:/Game/UI\" into \"C:/Game/Build/UI\"\n\
+",
+  "");
+
+class nsStyleSheetCompiler : public nsApplication
+{
+public:
+  using SUPER = nsApplication;
+
+  struct Job
+  {
+    nsString m_sInput;
+    nsString m_sOutput;
+  };
+
+  nsDynamicArray<Job> m_Jobs;
+  bool m_bVerify = false;
+
+  nsStyleSheetCompiler()
+    : nsApplication("StyleSheetCompiler")
+  {
+  }
+
+  /// Adds a job for the file, sRelativePath is where it goes inside the output folder.
+  void AddJob(nsStringView sInput, nsStringView sOutputFolder, nsStringView sRelativePath)
+  {
+    nsStringBuilder sOutput;
+    if (sOutputFolder.IsEmpty())
+    {
+      sOutput = sInput;
+    }
+    else
+    {
+      sOutput = sOutputFolder;
+      sOutput.AppendPath(sRelativePath);
+    }
+    sOutput.ChangeFileExtension("cssb");
+
+    Job& job = m_Jobs.ExpandAndGetRef();
+    job.m_sInput = sInput;
+    job.m_sOutput = sOutput;
+  }
+
+  nsResult ParseArguments()
+  {
+    if (GetArgumentCount() <= 1)
+    {
+      nsLog::Error("No arguments given");
+      return NS_FAILURE;
+    }
+
+    nsStringBuilder sOut = opt_Out.GetOptionValue(nsCommandLineOption::LogMode::Always);
+    m_bVerify = opt_Verify.GetOptionValue(nsCommandLineOption::LogMode::Always);
+
+    nsDynamicArray<nsString> inputs;
+    for (nsUInt32 a = 1; a < GetArgumentCount(); ++a)
+    {
+      const nsStringView sArg = GetArgument(a);
+      if (sArg.IsEqual_NoCase("-out"))
+      {
+        ++a;
+        continue;
+      }
+      if (sArg.StartsWith("-"))
+        continue;
+
+      inputs.PushBack(nsOSFile::MakePathAbsoluteWithCWD(sArg));
+    }
+
+    if (inputs.IsEmpty())
+    {
+      nsLog::Error("No input files or folders given");
+      return NS_FAILURE;
+    }
+
+    if (!sOut.IsEmpty())
+      sOut = nsOSFile::MakePathAbsoluteWithCWD(sOut);
+
+    // A single file compiles to exactly the given output, everything else treats -out as a folder.
+    if (inputs.GetCount() == 1 && nsOSFile::ExistsFile(inputs[0]) && !sOut.IsEmpty())
+    {
+      Job& job = m_Jobs.ExpandAndGetRef();
+      job.m_sInput = inputs[0];
+      job.m_sOutput = sOut;
+      return NS_SUCCESS;
+    }
+
+    nsStringBuilder sFile;
+    for (const nsString& input : inputs)
+    {
+      if (nsOSFile::ExistsFile(input))
+      {
+        AddJob(input, sOut, nsPathUtils::GetFileNameAndExtension(input));
+        continue;
+      }
+
+      if (!nsOSFile::ExistsDirectory(input))
+      {
+        nsLog::Error("Input is neither a file nor a folder: '{}'", input);
+        return NS_FAILURE;
+      }
+
+      nsFileSystemIterator it;
+      for (it.StartSearch(input, nsFileSystemIteratorFlags::ReportFilesRecursive); it.IsValid(); it.Next())
+      {
+        sFile = it.GetCurrentPath();
+        sFile.AppendPath(it.GetStats().m_sName);
+        if (!sFile.GetFileExtension().IsEqual_NoCase("css"))
+          continue;
+
+        nsStringBuilder sRelative = sFile;
+        sRelative.MakeRelativeTo(input).IgnoreResult();
+        AddJob(sFile, sOut, sRelative);
+      }
+    }
+
+    if (m_Jobs.IsEmpty())
+    {
+      nsLog::Error("No CSS files found in the inputs");
+      return NS_FAILURE;
+    }
+
+    return NS_SUCCESS;
+  }
+
+  virtual void AfterCoreSystemsStartup() override
+  {
+    // Add the empty data directory to access files via absolute paths
+    nsFileSystem::AddDataDirectory("", "App", ":", nsDataDirUsage::AllowWrites).IgnoreResult();
+
+    nsGlobalLog::AddLogWriter(nsLogWriter::Console::LogMessageHandler);
+    nsGlobalLog::AddLogWriter(nsLogWriter::VisualStudio::LogMessageHandler);
+  }
+
+  virtual void BeforeCoreSystemsShutdown() override
+  {
+    // prevent further output during shutdown
+    nsGlobalLog::RemoveLogWriter(nsLogWriter::Console::LogMessageHandler);
+    nsGlobalLog::RemoveLogWriter(nsLogWriter::VisualStudio::LogMessageHandler);
+
+    SUPER::BeforeCoreSystemsShutdown();
+  }
+
+  /// Checks that the compiled file loads back into the same rules and declarations.
+  nsResult Verify(const aperture::css::CSSStyleSheet& sheet, nsStringView sCompiled)
+  {
+    aperture::css::CSSStyleSheet loaded;
+    NS_SUCCEED_OR_RETURN(loaded.LoadBinaryMapped(sCompiled));
+
+    if (loaded.GetRuleCount() != sheet.GetRuleCount())
+      return NS_FAILURE;
+
+    for (nsUInt32 r = 0; r < sheet.GetRuleCount(); ++r)
+    {
+      const auto& rule = sheet.GetRule(r);
+      const auto& loadedRule = loaded.GetRule(r);
+      if (rule.m_uiSelectorCount != loadedRule.m_uiSelectorCount || rule.m_uiMediaBlock != loadedRule.m_uiMediaBlock ||
+          sheet.GetDeclarations(rule) != loaded.GetDeclarations(loadedRule))
+        return NS_FAILURE;
+
+      for (nsUInt32 s = 0; s < rule.m_uiSelectorCount; ++s)
+      {
+        const auto& selector = sheet.GetSelector(rule.m_uiFirstSelector + s);
+        const auto& loadedSelector = loaded.GetSelector(loadedRule.m_uiFirstSelector + s);
+        if (selector.GetSpecificity() != loadedSelector.GetSpecificity() || selector.GetKeyAtom() != loadedSelector.GetKeyAtom() ||
+            selector.GetCompoundCount() != loadedSelector.GetCompoundCount())
+          return NS_FAILURE;
+      }
+    }
+
+    if (loaded.GetMediaBlockCount() != sheet.GetMediaBlockCount())
+      return NS_FAILURE;
+
+    for (nsUInt32 b = 0; b < sheet.GetMediaBlockCount(); ++b)
+    {
+      const auto& block = sheet.GetMediaBlock(b);
+      const auto& loadedBlock = loaded.GetMediaBlock(b);
+      if (block.m_uiParent != loadedBlock.m_uiParent || block.m_Queries != loadedBlock.m_Queries)
+        return NS_FAILURE;
+    }
+
+    if (loaded.GetKeyframesRuleCount() != sheet.GetKeyframesRuleCount())
+      return NS_FAILURE;
+
+    for (nsUInt32 r = 0; r < sheet.GetKeyframesRuleCount(); ++r)
+    {
+      const auto& rule = sheet.GetKeyframesRule(r);
+      const auto& loadedRule = loaded.GetKeyframesRule(r);
+      if (rule.m_Name != loadedRule.m_Name || rule.m_uiKeyframeCount != loadedRule.m_uiKeyframeCount)
+        return NS_FAILURE;
+
+      for (nsUInt32 k = 0; k < rule.m_uiKeyframeCount; ++k)
+      {
+        const auto& keyframe = sheet.GetKeyframes(rule)[k];
+        const auto& loadedKeyframe = loaded.GetKeyframes(loadedRule)[k];
+        if (keyframe.m_fOffset != loadedKeyframe.m_fOffset || sheet.GetDeclarations(keyframe) != loaded.GetDeclarations(loadedKeyframe))
+          return NS_FAILURE;
+      }
+    }
+    return NS_SUCCESS;
+  }
+
+  nsResult Compile(const Job& job)
+  {
+    nsOSFile source;
+    if (source.Open(job.m_sInput, nsFileOpenMode::Read).Failed())
+    {
+      nsLog::Error("Failed to open '{}'", job.m_sInput);
+      return NS_FAILURE;
+    }
+
+    nsDynamicArray<nsUInt8> content;
+    source.ReadAll(content);
+    source.Close();
+
+    const std::string_view text(reinterpret_cast<const char*>(content.GetData()), content.GetCount());
+    aperture::css::CSSErrorDatabase& diagnostics = aperture::CSSController::GetErrorDatabase();
+    diagnostics.SetMode(aperture::css::CSSErrorDatabase::Mode::Record);
+    diagnostics.ClearErrors();
+
+    aperture::css::CSSStyleSheet sheet;
+    sheet.ParseFromString(text, std::string_view(job.m_sInput.GetData(), job.m_sInput.GetElementCount()));
+    if (sheet.GetParseErrorCount() > 0)
+    {
+      nsLog::Warning("'{}': {} invalid rules or declarations were dropped", job.m_sInput, sheet.GetParseErrorCount());
+    }
+
+    nsStringBuilder sMessage;
+    for (nsUInt32 i = 0; i < diagnostics.GetRecordedCount(); ++i)
+    {
+      aperture::css::CSSErrorDatabase::FormatDiagnostic(diagnostics.GetRecorded(i), sMessage, text);
+      nsLog::Dev("{}", sMessage);
+    }
+
+    nsFileWriter file;
+    if (file.Open(job.m_sOutput).Failed())
+    {
+      nsLog::Error("Failed to open '{}' for writing", job.m_sOutput);
+      return NS_FAILURE;
+    }
+    NS_SUCCEED_OR_RETURN(sheet.WriteBinary(file));
+    file.Close();
+
+    if (m_bVerify && Verify(sheet, job.m_sOutput).Failed())
+    {
+      nsLog::Error("'{}' doesn't match its source after loading", job.m_sOutput);
+      return NS_FAILURE;
+    }
+
+    nsLog::Info("{} -> {} ({} rules)", job.m_sInput, job.m_sOutput, sheet.GetRuleCount());
+    return NS_SUCCESS;
+  }
+
+  virtual void Run() override
+  {
+    {
+      nsStringBuilder cmdHelp;
+      if (nsCommandLineOption::LogAvailableOptionsToBuffer(cmdHelp, nsCommandLineOption::LogAvailableModes::IfHelpRequested, "_StyleSheetCompiler"))
+      {
+        nsLog::Print(cmdHelp);
+        RequestApplicationQuit();
+        return;
+      }
+    }
+
+    nsStopwatch sw;
+
+    if (ParseArguments().Failed())
+    {
+      SetReturnCode(1);
+      RequestApplicationQuit();
+      return;
+    }
+
+    nsUInt32 uiFailed = 0;
+    for (const Job& job : m_Jobs)
+    {
+      if (Compile(job).Failed())
+        ++uiFailed;
+    }
+
+    if (uiFailed > 0)
+    {
+      nsLog::Error("{} of {} stylesheets failed to compile", uiFailed, m_Jobs.GetCount());
+      SetReturnCode(2);
+    }
+
+    nsLog::Success("Finished compiling {} stylesheets in {}", m_Jobs.GetCount() - uiFailed, sw.GetRunningTotal());
+    RequestApplicationQuit();
+  }
+};
+
+NS_APPLICATION_ENTRY_POINT(nsStyleSheetCompiler);
@@ -0,0 +1,6 @@
+#include <ApertureHTMLPerfTest/ApertureHTMLPerfTestPCH.h>
+
+#include <TestFramework/Framework/TestFramework.h>
+#include <TestFramework/Utilities/TestSetup.h>
+
+NS_TESTFRAMEWORK_ENTRY_POINT("ApertureHTMLPerfTest", "Aperture HTML (aphtml) Performance Tests")
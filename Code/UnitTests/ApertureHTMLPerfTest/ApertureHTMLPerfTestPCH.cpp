@@ -0,0 +1 @@
+#include <ApertureHTMLPerfTest/ApertureHTMLPerfTestPCH.h>
@@ -0,0 +1,7 @@
+#include <TestFramework/Framework/TestFramework.h>
+
+#include <Foundation/Basics.h>
+#include <Foundation/Basics/Assert.h>
+#include <Foundation/Types/Types.h>
+
+#include <Foundation/Math/Declarations.h>
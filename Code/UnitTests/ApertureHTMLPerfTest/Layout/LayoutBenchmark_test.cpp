@@ -0,0 +1,390 @@
+#include <ApertureHTMLPerfTest/ApertureHTMLPerfTestPCH.h>
+
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+#include <APHTML/layout/Core/TextMeasureCache.h>
+#include <Foundation/IO/JSONWriter.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Memory/MemoryTracker.h>
+#include <Foundation/Time/Stopwatch.h>
+#include <Foundation/Utilities/CommandLineOptions.h>
+
+#include <ApertureHTMLTestUtils/DOMTestUtils.h>
+#include <ApertureHTMLTestUtils/MonospaceMeasurer.h>
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+  using aperture::css::CSSStyleSheet;
+  using aperture::css::StyleCache;
+  using aperture::css::StyleResolver;
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMNode;
+  using aperture::layout::LayoutTree;
+  using aperture::layout::TextMeasureCache;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+  using aperture::test::MonospaceMeasurer;
+
+  nsCommandLineOptionPath opt_PerfJson("_ApertureHTMLPerfTest", "-perfjson", "JSON file the layout benchmark results are written to.", "");
+
+  enum constants
+  {
+#if NS_ENABLED(NS_COMPILE_FOR_DEBUG)
+    COLD_PASSES = 3,
+    WARM_PASSES = 3,
+    INCREMENTAL_PASSES = 20,
+#else
+    COLD_PASSES = 20,
+    WARM_PASSES = 20,
+    INCREMENTAL_PASSES = 200,
+#endif
+  };
+
+  constexpr float s_fViewportWidth = 1200.0f;
+
+  // Deterministic text of varying length, so lines break at different places.
+  std::string MakeWords(nsUInt32 uiWords, nsUInt32 uiSeed)
+  {
+    static const char* s_szWords[] = {"layout", "box", "a", "paragraph", "of", "flexible", "text", "in", "the", "grid", "wraps"};
+    std::string text;
+    for (nsUInt32 i = 0; i < uiWords; ++i)
+    {
+      if (i > 0)
+        text += ' ';
+      text += s_szWords[(uiSeed + i * 7) % NS_ARRAY_SIZE(s_szWords)];
+    }
+    return text;
+  }
+
+  struct Document
+  {
+    const char* m_szName = nullptr;
+    std::shared_ptr<DOMElement> m_pRoot;
+    /// The text that is edited between the incremental passes.
+    DOMNode* m_pEditedText = nullptr;
+  };
+
+  // Chains of nested blocks with a line of text on every level. The deepest text of the last chain is edited, which
+  // resizes every level above it.
+  Document BuildDeepNesting()
+  {
+    Document document{"deep_nesting", MakeElement("div", "page")};
+    for (nsUInt32 uiChain = 0; uiChain < 8; ++uiChain)
+    {
+      std::shared_ptr<DOMElement> parent = document.m_pRoot;
+      for (nsUInt32 uiDepth = 0; uiDepth < 96; ++uiDepth)
+      {
+        auto level = MakeElement("div", "level");
+        auto label = MakeElement("div", "label");
+        auto text = MakeText(MakeWords(3, uiChain + uiDepth));
+        document.m_pEditedText = text.get();
+
+        label->appendChild(text);
+        level->appendChild(label);
+        parent->appendChild(level);
+        parent = level;
+      }
+    }
+    return document;
+  }
+
+  // Wrapping flex rows of growing cells. A cell in the middle row is edited, the rows below it move.
+  Document BuildWideFlexRows()
+  {
+    Document document{"wide_flex_rows", MakeElement("div", "page")};
+    for (nsUInt32 uiRow = 0; uiRow < 48; ++uiRow)
+    {
+      auto row = MakeElement("div", "row");
+      for (nsUInt32 uiCell = 0; uiCell < 32; ++uiCell)
+      {
+        auto cell = MakeElement("div", "cell");
+        auto text = MakeText(MakeWords(1 + (uiRow + uiCell) % 3, uiRow * 32 + uiCell));
+        if (uiRow == 24 && uiCell == 0)
+          document.m_pEditedText = text.get();
+
+        cell->appendChild(text);
+        row->appendChild(cell);
+      }
+      document.m_pRoot->appendChild(row);
+    }
+    return document;
+  }
+
+  // Grids of flexible tracks with spanning items. An item of the first grid is edited, the grids below it move.
+  Document BuildGrids()
+  {
+    Document document{"grids", MakeElement("div", "page")};
+    for (nsUInt32 uiGrid = 0; uiGrid < 24; ++uiGrid)
+    {
+      auto grid = MakeElement("div", "grid");
+      for (nsUInt32 uiItem = 0; uiItem < 60; ++uiItem)
+      {
+        auto item = MakeElement("div", uiItem % 7 == 0 ? "item wide" : "item");
+        auto text = MakeText(MakeWords(2 + uiItem % 5, uiGrid * 60 + uiItem));
+        if (uiGrid == 0 && uiItem == 0)
+          document.m_pEditedText = text.get();
+
+        item->appendChild(text);
+        grid->appendChild(item);
+      }
+      document.m_pRoot->appendChild(grid);
+    }
+    return document;
+  }
+
+  // Long paragraphs of wrapping text with inline elements. A paragraph in the middle is edited.
+  Document BuildLongText()
+  {
+    Document document{"long_text", MakeElement("div", "page")};
+    for (nsUInt32 uiParagraph = 0; uiParagraph < 240; ++uiParagraph)
+    {
+      auto paragraph = MakeElement("p", "paragraph");
+      auto text = MakeText(MakeWords(40 + uiParagraph % 40, uiParagraph));
+      auto emphasis = MakeElement("span", "em");
+      emphasis->appendChild(MakeText(MakeWords(4, uiParagraph * 3)));
+      if (uiParagraph == 120)
+        document.m_pEditedText = text.get();
+
+      paragraph->appendChild(text);
+      paragraph->appendChild(emphasis);
+      paragraph->appendChild(MakeText(MakeWords(20, uiParagraph * 5)));
+      document.m_pRoot->appendChild(paragraph);
+    }
+    return document;
+  }
+
+  constexpr const char* s_szCorpusSheet = R"(
+    .page { width: 1200px; }
+    .level { padding: 1px; }
+    .row { display: flex; flex-wrap: wrap; }
+    .cell { flex-grow: 1; padding: 2px; }
+    .grid { display: grid; grid-template-columns: repeat(6, 1fr); column-gap: 4px; row-gap: 4px; margin-bottom: 8px; }
+    .wide { grid-column: span 2; }
+    .item { padding: 2px; }
+    .paragraph { margin-bottom: 8px; }
+    .em { display: inline; }
+  )";
+
+  nsUInt64 GetAllocationCount()
+  {
+    return nsFoundation::GetDefaultAllocator()->GetStats().m_uiNumAllocations;
+  }
+
+  struct Measurement
+  {
+    void Add(nsTime duration, nsUInt64 uiAllocations, nsUInt32 uiUpdatedNodes)
+    {
+      m_Durations.PushBack(duration);
+      m_uiAllocations += uiAllocations;
+      m_uiUpdatedNodes += uiUpdatedNodes;
+    }
+
+    // The median is robust against the odd pass that got descheduled.
+    nsTime GetMedian() const
+    {
+      nsDynamicArray<nsTime> sorted = m_Durations;
+      sorted.Sort();
+      return sorted[sorted.GetCount() / 2];
+    }
+
+    nsDynamicArray<nsTime> m_Durations;
+    nsUInt64 m_uiAllocations = 0;
+    nsUInt64 m_uiUpdatedNodes = 0;
+  };
+
+  struct DocumentResult
+  {
+    const char* m_szName = nullptr;
+    nsUInt32 m_uiNodes = 0;
+    Measurement m_Cold;
+    Measurement m_Warm;
+    Measurement m_Incremental;
+  };
+
+  template <typename Pass>
+  void Measure(LayoutTree& inout_tree, Measurement& inout_measurement, Pass pass)
+  {
+    inout_tree.ResetStats();
+    const nsUInt64 uiAllocations = GetAllocationCount();
+
+    nsStopwatch timer;
+    pass();
+    const nsTime duration = timer.GetRunningTotal();
+
+    inout_measurement.Add(duration, GetAllocationCount() - uiAllocations, inout_tree.GetStats().m_uiUpdatedBoxes);
+  }
+
+  bool IsSameLayout(const LayoutTree& a, const LayoutTree& b)
+  {
+    if (a.GetBoxCount() != b.GetBoxCount())
+      return false;
+
+    for (nsUInt32 i = 0; i < a.GetBoxCount(); ++i)
+    {
+      const nsRectFloat rectA = a.GetAbsoluteRect(i);
+      const nsRectFloat rectB = b.GetAbsoluteRect(i);
+      if (!nsMath::IsEqual(rectA.x, rectB.x, 0.01f) || !nsMath::IsEqual(rectA.y, rectB.y, 0.01f) ||
+          !nsMath::IsEqual(rectA.width, rectB.width, 0.01f) || !nsMath::IsEqual(rectA.height, rectB.height, 0.01f))
+        return false;
+    }
+    return true;
+  }
+
+  // Cold passes build the tree and measure all text, warm passes build the tree with the text measured already,
+  // incremental passes only lay out again after one text changed.
+  DocumentResult RunDocument(Document& inout_document, MonospaceMeasurer& in_measurer)
+  {
+    DocumentResult result;
+    result.m_szName = inout_document.m_szName;
+
+    for (nsUInt32 i = 0; i < COLD_PASSES; ++i)
+    {
+      TextMeasureCache coldCache(&in_measurer);
+      LayoutTree tree;
+      tree.SetTextMeasureCache(&coldCache);
+      Measure(tree, result.m_Cold, [&]() {
+        tree.Build(*inout_document.m_pRoot);
+        tree.Calculate(s_fViewportWidth);
+      });
+      result.m_uiNodes = tree.GetBoxCount();
+    }
+
+    // Fills the cache for the warm passes, and is the tree the incremental passes edit.
+    TextMeasureCache warmCache(&in_measurer);
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&warmCache);
+    tree.Build(*inout_document.m_pRoot);
+    tree.Calculate(s_fViewportWidth);
+
+    for (nsUInt32 i = 0; i < WARM_PASSES; ++i)
+    {
+      LayoutTree warmTree;
+      warmTree.SetTextMeasureCache(&warmCache);
+      Measure(warmTree, result.m_Warm, [&]() {
+        warmTree.Build(*inout_document.m_pRoot);
+        warmTree.Calculate(s_fViewportWidth);
+      });
+    }
+
+    DOMNode& text = *inout_document.m_pEditedText;
+    const std::string original = text.getNodeValue();
+    const std::string edited = original + " and a few more words that wrap to the next line";
+    for (nsUInt32 i = 0; i < INCREMENTAL_PASSES; ++i)
+    {
+      text.setNodeValue(i % 2 == 0 ? edited : original);
+      Measure(tree, result.m_Incremental, [&]() {
+        tree.UpdateText(text);
+        tree.Calculate(s_fViewportWidth);
+      });
+    }
+
+    // Incremental layout has to end up where a layout from scratch does.
+    LayoutTree expected;
+    expected.SetTextMeasureCache(&warmCache);
+    expected.Build(*inout_document.m_pRoot);
+    expected.Calculate(s_fViewportWidth);
+    NS_TEST_BOOL_MSG(IsSameLayout(tree, expected), "Incremental layout of '%s' differs from a full layout", result.m_szName);
+
+    text.setNodeValue(original);
+    return result;
+  }
+
+  double GetNanosecondsPerNode(const Measurement& in_measurement, nsUInt32 in_uiNodes)
+  {
+    return in_measurement.GetMedian().GetNanoseconds() / nsMath::Max(in_uiNodes, 1u);
+  }
+
+  void WriteMeasurement(nsJSONWriter& inout_json, nsStringView sName, const Measurement& in_measurement, nsUInt32 in_uiNodes)
+  {
+    const double fPasses = static_cast<double>(in_measurement.m_Durations.GetCount());
+
+    inout_json.BeginObject(sName);
+    inout_json.AddVariableUInt32("passes", in_measurement.m_Durations.GetCount());
+    inout_json.AddVariableDouble("ns_per_node", GetNanosecondsPerNode(in_measurement, in_uiNodes));
+    inout_json.AddVariableDouble("median_ms", in_measurement.GetMedian().GetMilliseconds());
+    inout_json.AddVariableDouble("allocations_per_pass", in_measurement.m_uiAllocations / fPasses);
+    inout_json.AddVariableDouble("updated_nodes_per_pass", in_measurement.m_uiUpdatedNodes / fPasses);
+    inout_json.EndObject();
+  }
+
+  // Allocations are the ones of the default allocator, they are only counted in builds that track allocations. Yoga
+  // allocates from the CRT and isn't included.
+  nsResult WriteJson(nsStringView sFile, const nsDynamicArray<DocumentResult>& in_results)
+  {
+    nsContiguousMemoryStreamStorage storage;
+    nsMemoryStreamWriter writer(&storage);
+
+    nsStandardJSONWriter json;
+    json.SetOutputStream(&writer);
+    json.BeginObject();
+    json.AddVariableString("benchmark", "layout");
+    json.AddVariableBool("debug", NS_ENABLED(NS_COMPILE_FOR_DEBUG));
+    json.AddVariableBool("allocation_tracking", NS_ALLOC_TRACKING_DEFAULT != nsAllocatorTrackingMode::Nothing);
+    json.AddVariableFloat("viewport_width", s_fViewportWidth);
+
+    json.BeginArray("documents");
+    for (const DocumentResult& result : in_results)
+    {
+      json.BeginObject();
+      json.AddVariableString("name", result.m_szName);
+      json.AddVariableUInt32("nodes", result.m_uiNodes);
+      WriteMeasurement(json, "cold", result.m_Cold, result.m_uiNodes);
+      WriteMeasurement(json, "warm", result.m_Warm, result.m_uiNodes);
+      WriteMeasurement(json, "incremental", result.m_Incremental, result.m_uiNodes);
+      json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+
+    nsOSFile file;
+    NS_SUCCEED_OR_RETURN(file.Open(sFile, nsFileOpenMode::Write));
+    return file.Write(storage.GetData(), storage.GetStorageSize64());
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST_GROUP(Layout);
+
+NS_CREATE_SIMPLE_TEST(Layout, LayoutBenchmark)
+{
+  CSSStyleSheet sheet;
+  sheet.ParseFromString(s_szCorpusSheet);
+
+  StyleCache styleCache;
+  StyleResolver resolver(styleCache);
+  resolver.AddStyleSheet(&sheet);
+
+  MonospaceMeasurer measurer;
+
+  Document corpus[] = {BuildDeepNesting(), BuildWideFlexRows(), BuildGrids(), BuildLongText()};
+
+  nsDynamicArray<DocumentResult> results;
+  for (Document& document : corpus)
+  {
+    NS_TEST_BLOCK(nsTestBlock::Enabled, document.m_szName)
+    {
+      resolver.ResolveStyles(*document.m_pRoot);
+
+      DocumentResult& result = results.ExpandAndGetRef();
+      result = RunDocument(document, measurer);
+      NS_TEST_BOOL(result.m_uiNodes > 1000);
+      NS_TEST_BOOL(result.m_Incremental.m_uiUpdatedNodes / INCREMENTAL_PASSES < result.m_uiNodes);
+
+      nsLog::Info("Layout of '{0}' with {1} nodes: cold {2} ns/node, warm {3} ns/node, incremental {4} ns/node", result.m_szName,
+        result.m_uiNodes, nsArgF(GetNanosecondsPerNode(result.m_Cold, result.m_uiNodes), 1),
+        nsArgF(GetNanosecondsPerNode(result.m_Warm, result.m_uiNodes), 1),
+        nsArgF(GetNanosecondsPerNode(result.m_Incremental, result.m_uiNodes), 1));
+    }
+  }
+
+  const nsString sJsonFile = opt_PerfJson.GetOptionValue(nsCommandLineOption::LogMode::AlwaysIfSpecified);
+  if (!sJsonFile.IsEmpty())
+  {
+    NS_TEST_BOOL_MSG(WriteJson(sJsonFile, results).Succeeded(), "Failed to write the layout benchmark results to '%s'", sJsonFile.GetData());
+  }
+}
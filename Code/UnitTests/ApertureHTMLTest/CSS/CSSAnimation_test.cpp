@@ -0,0 +1,399 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/animation/AnimationManager.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/dom/events/DOMAnimationEvent.h>
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+namespace
+{
+  using aperture::EventId;
+  using aperture::PropertyId;
+  using aperture::animation::AnimationDesc;
+  using aperture::animation::AnimationDirection;
+  using aperture::animation::AnimationFillMode;
+  using aperture::animation::AnimationManager;
+  using aperture::animation::AnimationTrackList;
+  using aperture::animation::CompositorTimeline;
+  using aperture::animation::EasingTable;
+  using aperture::animation::StepPosition;
+  using aperture::animation::TimingFunction;
+  using aperture::animation::TransformValue;
+  using aperture::animation::TransitionDesc;
+  using aperture::core::MakeAtom;
+  using aperture::core::Unit;
+  using aperture::css::CSSPropertyTable;
+  using aperture::css::CSSStyleSheet;
+  using aperture::css::CSSValue;
+  using aperture::css::StyleCache;
+  using aperture::css::StyleResolver;
+  using aperture::dom::DOMElement;
+  using aperture::dom::StyleDirty;
+  using aperture::test::MakeElement;
+
+  nsUInt32 Color(const char* szColor)
+  {
+    nsUInt32 uiColor = 0;
+    CSSPropertyTable::ParseColor(szColor, uiColor).IgnoreResult();
+    return uiColor;
+  }
+
+  float GetNumber(const DOMElement& element, PropertyId id)
+  {
+    return element.getComputedStyle()->Get(id).m_fNumber;
+  }
+
+  constexpr const char* s_szAnimationSheet = R"(
+    .box { width: 10px; color: #000000; transition: width 1s linear, color 1s linear; }
+    .box.wide { width: 110px; color: #ffffff; }
+    @keyframes fade {
+      from { opacity: 0; transform: translate(0px, 0px); }
+      to { opacity: 1; transform: translate(100px, 0px); }
+    }
+    @keyframes grow { from { width: 0px; } 50% { width: 2em; } to { width: 40px; } }
+    .fade { animation: fade 2s linear; }
+    .grow { font-size: 10px; animation: grow 1s linear forwards; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(CSS, Animation)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Parsing")
+  {
+    TimingFunction function;
+    NS_TEST_BOOL(aperture::animation::ParseTimingFunction("ease", function).Succeeded() && function == TimingFunction());
+    NS_TEST_BOOL(aperture::animation::ParseTimingFunction("linear", function).Succeeded() && function == TimingFunction::MakeLinear());
+    NS_TEST_BOOL(aperture::animation::ParseTimingFunction("steps(4, jump-start)", function).Succeeded() &&
+                 function == TimingFunction::MakeSteps(4, StepPosition::JumpStart));
+    NS_TEST_BOOL(aperture::animation::ParseTimingFunction("cubic-bezier(0.2, 0, 0, 1)", function).Succeeded() &&
+                 function == TimingFunction::MakeCubicBezier(0.2f, 0.0f, 0.0f, 1.0f));
+    NS_TEST_BOOL(aperture::animation::ParseTimingFunction("cubic-bezier(2, 0, 0, 1)", function).Failed());
+    NS_TEST_BOOL(aperture::animation::ParseTimingFunction("steps(0)", function).Failed());
+
+    nsDynamicArray<TransitionDesc> transitions;
+    NS_TEST_BOOL(aperture::animation::ParseTransitionList("width 1s linear, opacity 200ms ease-in 0.5s, nonsense 1s", transitions).Succeeded());
+    NS_TEST_INT(transitions.GetCount(), 2);
+    NS_TEST_BOOL(transitions[0].m_Property == PropertyId::Width && transitions[0].m_TimingFunction == TimingFunction::MakeLinear());
+    NS_TEST_FLOAT(transitions[0].m_Duration.GetSeconds(), 1.0, 0.0);
+    NS_TEST_BOOL(transitions[1].m_Property == PropertyId::Opacity);
+    NS_TEST_FLOAT(transitions[1].m_Duration.GetSeconds(), 0.2, 0.00001);
+    NS_TEST_FLOAT(transitions[1].m_Delay.GetSeconds(), 0.5, 0.0);
+
+    NS_TEST_BOOL(aperture::animation::ParseTransitionList("all 1s", transitions).Succeeded());
+    NS_TEST_BOOL(transitions.GetCount() == 1 && transitions[0].m_bAllProperties);
+    NS_TEST_BOOL(aperture::animation::ParseTransitionList("none", transitions).Succeeded() && transitions.IsEmpty());
+
+    nsDynamicArray<AnimationDesc> animations;
+    NS_TEST_BOOL(aperture::animation::ParseAnimationList("spin 2s infinite alternate both paused, none", animations).Succeeded());
+    NS_TEST_INT(animations.GetCount(), 2);
+    NS_TEST_BOOL(animations[0].m_Name == MakeAtom("spin") && animations[0].m_bPaused);
+    NS_TEST_BOOL(!nsMath::IsFinite(animations[0].m_fIterationCount));
+    NS_TEST_BOOL(animations[0].m_Direction == AnimationDirection::Alternate && animations[0].m_FillMode == AnimationFillMode::Both);
+    NS_TEST_INT(animations[1].m_Name, aperture::core::InvalidAtom);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Easing")
+  {
+    EasingTable table;
+    const nsUInt16 uiLinear = table.Add(TimingFunction::MakeLinear());
+    const nsUInt16 uiEase = table.Add(TimingFunction());
+    const nsUInt16 uiSteps = table.Add(TimingFunction::MakeSteps(4, StepPosition::JumpEnd));
+    const nsUInt16 uiStepsStart = table.Add(TimingFunction::MakeSteps(4, StepPosition::JumpStart));
+    NS_TEST_INT(uiLinear, 0);
+    NS_TEST_INT(table.Add(TimingFunction()), uiEase);
+
+    NS_TEST_FLOAT(table.Evaluate(uiLinear, 0.3f), 0.3f, 0.0001f);
+    NS_TEST_FLOAT(table.Evaluate(uiEase, 0.0f), 0.0f, 0.0001f);
+    NS_TEST_FLOAT(table.Evaluate(uiEase, 0.5f), 0.8024f, 0.002f);
+    NS_TEST_FLOAT(table.Evaluate(uiEase, 1.0f), 1.0f, 0.0001f);
+
+    // Steps are exact, at the jumps as well.
+    NS_TEST_FLOAT(table.Evaluate(uiSteps, 0.3f), 0.25f, 0.0f);
+    NS_TEST_FLOAT(table.Evaluate(uiSteps, 0.5f), 0.5f, 0.0f);
+    NS_TEST_FLOAT(table.Evaluate(uiSteps, 1.0f), 1.0f, 0.0f);
+    NS_TEST_FLOAT(table.Evaluate(uiStepsStart, 0.0f), 0.25f, 0.0f);
+    NS_TEST_FLOAT(table.Evaluate(uiStepsStart, 0.3f), 0.5f, 0.0f);
+
+    nsHybridArray<nsUInt16, 16> functions;
+    nsHybridArray<float, 16> progress;
+    for (nsUInt32 i = 0; i < 16; ++i)
+    {
+      functions.PushBack(static_cast<nsUInt16>(i % table.GetCount()));
+      progress.PushBack(i / 15.0f);
+    }
+    nsHybridArray<float, 16> values;
+    values.SetCount(16);
+    table.EvaluateBatch(functions, progress, values);
+    for (nsUInt32 i = 0; i < 16; ++i)
+    {
+      NS_TEST_FLOAT(values[i], table.Evaluate(functions[i], progress[i]), 0.0f);
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Transforms")
+  {
+    TransformValue transform;
+    NS_TEST_BOOL(TransformValue::Parse("translate(10px, 4px) rotate(90deg)", transform).Succeeded());
+    float matrix[6];
+    transform.GetMatrix(matrix);
+    NS_TEST_FLOAT(matrix[0], 0.0f, 0.0001f);
+    NS_TEST_FLOAT(matrix[1], 1.0f, 0.0001f);
+    NS_TEST_FLOAT(matrix[2], -1.0f, 0.0001f);
+    NS_TEST_FLOAT(matrix[3], 0.0f, 0.0001f);
+    NS_TEST_FLOAT(matrix[4], 10.0f, 0.0001f);
+    NS_TEST_FLOAT(matrix[5], 4.0f, 0.0001f);
+
+    // Decomposing and composing again gives back the same matrix, skews included.
+    const float skewed[6] = {1.0f, 0.5f, 0.3f, 2.0f, -5.0f, 7.0f};
+    TransformValue::FromMatrix(skewed).GetMatrix(matrix);
+    for (nsUInt32 i = 0; i < 6; ++i)
+    {
+      NS_TEST_FLOAT(matrix[i], skewed[i], 0.0001f);
+    }
+
+    NS_TEST_BOOL(TransformValue::Parse("none", transform).Succeeded() && transform.IsIdentity());
+    NS_TEST_BOOL(TransformValue::Parse("translate(10%)", transform).Failed());
+    NS_TEST_BOOL(TransformValue::Parse("rotate(90)", transform).Failed());
+
+    TransformValue from;
+    TransformValue to;
+    TransformValue::Parse("rotate(0deg) scale(1)", from).AssertSuccess();
+    TransformValue::Parse("rotate(90deg) scale(3)", to).AssertSuccess();
+    const TransformValue half = TransformValue::Interpolate(from, to, 0.5f);
+    NS_TEST_FLOAT(half.m_fRotation, nsMath::Pi<float>() * 0.25f, 0.0001f);
+    NS_TEST_FLOAT(half.m_fScaleX, 2.0f, 0.0001f);
+    NS_TEST_FLOAT(half.m_fScaleY, 2.0f, 0.0001f);
+
+    // Interpolation takes the shorter way around.
+    TransformValue::Parse("rotate(350deg)", from).AssertSuccess();
+    TransformValue::Parse("rotate(10deg)", to).AssertSuccess();
+    TransformValue::Interpolate(from, to, 0.5f).GetMatrix(matrix);
+    NS_TEST_FLOAT(matrix[0], 1.0f, 0.0001f);
+    NS_TEST_FLOAT(matrix[1], 0.0f, 0.0001f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Keyframes rules")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(R"(
+      @keyframes pulse { to { opacity: 1; } 0%, 50% { opacity: 0.5; width: 10px; } }
+      @keyframes pulse { from { opacity: 0; } }
+      @keyframes broken { 150% { opacity: 0; } }
+      .after { width: 1px; }
+    )");
+    NS_TEST_INT(sheet.GetRuleCount(), 1);
+    NS_TEST_INT(sheet.GetKeyframesRuleCount(), 3);
+
+    // The last rule of a name wins.
+    const CSSStyleSheet::KeyframesRule* pRule = sheet.FindKeyframesRule(MakeAtom("pulse"));
+    NS_TEST_BOOL(pRule == &sheet.GetKeyframesRule(1));
+    NS_TEST_BOOL(sheet.FindKeyframesRule(MakeAtom("missing")) == nullptr);
+
+    // Sorted by offset, one keyframe per offset of the selector.
+    const CSSStyleSheet::KeyframesRule& first = sheet.GetKeyframesRule(0);
+    NS_TEST_INT(first.m_uiKeyframeCount, 3);
+    NS_TEST_FLOAT(sheet.GetKeyframes(first)[0].m_fOffset, 0.0f, 0.0f);
+    NS_TEST_FLOAT(sheet.GetKeyframes(first)[1].m_fOffset, 0.5f, 0.0f);
+    NS_TEST_FLOAT(sheet.GetKeyframes(first)[2].m_fOffset, 1.0f, 0.0f);
+    NS_TEST_INT(sheet.GetDeclarations(sheet.GetKeyframes(first)[0]).GetCount(), 2);
+    NS_TEST_INT(sheet.GetDeclarations(sheet.GetKeyframes(first)[2]).GetCount(), 1);
+
+    // Invalid keyframe selectors drop the keyframe, not the rule.
+    NS_TEST_INT(sheet.GetKeyframesRule(2).m_uiKeyframeCount, 0);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Transitions")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szAnimationSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+    AnimationManager manager(resolver);
+
+    auto root = MakeElement("div");
+    auto box = MakeElement("div", "box");
+    root->appendChild(box);
+
+    manager.Tick(nsTime::MakeZero());
+    resolver.ResolveStyles(*root);
+    NS_TEST_FLOAT(GetNumber(*box, PropertyId::Width), 10.0f, 0.0f);
+    NS_TEST_INT(manager.GetMainThreadTrackCount(), 0);
+
+    box->setAttribute("class", "box wide");
+    box->markStyleDirty(StyleDirty::Self);
+    resolver.UpdateStyles(*root);
+    NS_TEST_INT(manager.GetMainThreadTrackCount(), 2);
+    NS_TEST_INT(manager.GetAnimatedElementCount(), 1);
+    NS_TEST_FLOAT(GetNumber(*box, PropertyId::Width), 10.0f, 0.0f);
+
+    // Ticks only refresh the animated values, without running the cascade.
+    manager.Tick(nsTime::MakeFromSeconds(0.5));
+    resolver.ResetStats();
+    resolver.UpdateStyles(*root);
+    NS_TEST_INT(resolver.GetStats().m_uiAnimatedElements, 1);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 0);
+    NS_TEST_FLOAT(GetNumber(*box, PropertyId::Width), 60.0f, 0.001f);
+    const nsUInt32 uiHalfColor = box->getComputedStyle()->Get(PropertyId::Color).m_uiData;
+    NS_TEST_BOOL(uiHalfColor != Color("black") && uiHalfColor != Color("white"));
+
+    // Reversing midway starts from the displayed value.
+    box->setAttribute("class", "box");
+    box->markStyleDirty(StyleDirty::Self);
+    resolver.UpdateStyles(*root);
+    NS_TEST_INT(manager.GetMainThreadTrackCount(), 2);
+    manager.Tick(nsTime::MakeFromSeconds(1.0));
+    resolver.UpdateStyles(*root);
+    NS_TEST_FLOAT(GetNumber(*box, PropertyId::Width), 35.0f, 0.001f);
+
+    manager.Tick(nsTime::MakeFromSeconds(1.5));
+    resolver.UpdateStyles(*root);
+    NS_TEST_FLOAT(GetNumber(*box, PropertyId::Width), 10.0f, 0.0f);
+    NS_TEST_INT(box->getComputedStyle()->Get(PropertyId::Color).m_uiData, Color("black"));
+    NS_TEST_INT(manager.GetMainThreadTrackCount(), 0);
+    NS_TEST_INT(manager.GetAnimatedElementCount(), 0);
+
+    nsDynamicArray<AnimationManager::FinishedEvent> events;
+    manager.TakeFinishedEvents(events);
+    NS_TEST_INT(events.GetCount(), 2);
+    for (const AnimationManager::FinishedEvent& event : events)
+    {
+      NS_TEST_BOOL(event.m_pTarget.lock() == box);
+      NS_TEST_BOOL(event.m_pEvent->id() == EventId::TransitionEnd && event.m_pEvent->animationName().empty());
+    }
+    NS_TEST_BOOL(events[0].m_pEvent->propertyName() == "width" || events[1].m_pEvent->propertyName() == "width");
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Composited animation")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szAnimationSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+    AnimationManager manager(resolver);
+
+    auto root = MakeElement("div");
+    auto fade = MakeElement("div", "fade");
+    root->appendChild(fade);
+
+    manager.Tick(nsTime::MakeZero());
+    resolver.ResolveStyles(*root);
+    manager.CommitToCompositor();
+    NS_TEST_INT(manager.GetCompositedTrackCount(), 2);
+    NS_TEST_INT(manager.GetMainThreadTrackCount(), 0);
+
+    const CompositorTimeline& timeline = manager.GetCompositorTimeline();
+    NS_TEST_BOOL(timeline.HasTracks());
+
+    nsDynamicArray<CompositorTimeline::LayerValues> layers;
+    AnimationTrackList::Samples scratch;
+    timeline.Sample(nsTime::MakeFromSeconds(1.0), layers, scratch);
+    NS_TEST_INT(layers.GetCount(), 1);
+    NS_TEST_BOOL(layers[0].m_pElement == fade.get() && layers[0].m_bHasOpacity && layers[0].m_bHasTransform);
+    NS_TEST_FLOAT(layers[0].m_fOpacity, 0.5f, 0.0001f);
+    NS_TEST_FLOAT(layers[0].m_Transform[4], 50.0f, 0.0001f);
+    NS_TEST_FLOAT(layers[0].m_Transform[5], 0.0f, 0.0001f);
+
+    // The main thread doesn't see composited values, ticks don't dirty the element.
+    NS_TEST_FLOAT(GetNumber(*fade, PropertyId::Opacity), 1.0f, 0.0f);
+    manager.Tick(nsTime::MakeFromSeconds(1.0));
+    NS_TEST_INT(fade->getStyleDirtyFlags(), 0);
+
+    manager.Tick(nsTime::MakeFromSeconds(2.0));
+    NS_TEST_INT(manager.GetCompositedTrackCount(), 0);
+    NS_TEST_BOOL(!timeline.HasTracks());
+
+    nsDynamicArray<AnimationManager::FinishedEvent> events;
+    manager.TakeFinishedEvents(events);
+    NS_TEST_INT(events.GetCount(), 1);
+    NS_TEST_BOOL(events[0].m_pEvent->id() == EventId::AnimationEnd && events[0].m_pEvent->animationName() == "fade");
+    NS_TEST_FLOAT(events[0].m_pEvent->elapsedTime().GetSeconds(), 2.0, 0.0);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Main thread animation with fill")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szAnimationSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+    AnimationManager manager(resolver);
+
+    auto root = MakeElement("div");
+    auto grow = MakeElement("div", "grow");
+    root->appendChild(grow);
+
+    manager.Tick(nsTime::MakeZero());
+    resolver.ResolveStyles(*root);
+    NS_TEST_INT(manager.GetMainThreadTrackCount(), 1);
+    NS_TEST_FLOAT(GetNumber(*grow, PropertyId::Width), 0.0f, 0.0f);
+
+    // 2em is computed against the font size of the element.
+    manager.Tick(nsTime::MakeFromSeconds(0.25));
+    resolver.UpdateStyles(*root);
+    NS_TEST_FLOAT(GetNumber(*grow, PropertyId::Width), 10.0f, 0.001f);
+    manager.Tick(nsTime::MakeFromSeconds(0.75));
+    resolver.UpdateStyles(*root);
+    NS_TEST_FLOAT(GetNumber(*grow, PropertyId::Width), 30.0f, 0.001f);
+
+    // Filling forwards holds the last value without a track.
+    manager.Tick(nsTime::MakeFromSeconds(1.5));
+    resolver.UpdateStyles(*root);
+    NS_TEST_FLOAT(GetNumber(*grow, PropertyId::Width), 40.0f, 0.0f);
+    NS_TEST_INT(manager.GetMainThreadTrackCount(), 0);
+    NS_TEST_INT(manager.GetAnimatedElementCount(), 1);
+
+    // Removing the animation drops the held value.
+    grow->setAttribute("class", "");
+    grow->markStyleDirty(StyleDirty::Self);
+    resolver.UpdateStyles(*root);
+    NS_TEST_BOOL(grow->getComputedStyle()->Get(PropertyId::Width) == CSSPropertyTable::GetInitialValue(PropertyId::Width));
+    NS_TEST_INT(manager.GetAnimatedElementCount(), 0);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark sampling 10k tracks")
+  {
+    AnimationTrackList tracks;
+    AnimationTrackList::Keyframe keyframes[3];
+    keyframes[0] = {0.0f, CSSValue::MakeNumeric(0.0f, Unit::PX)};
+    keyframes[1] = {0.3f, CSSValue::MakeNumeric(50.0f, Unit::PX)};
+    keyframes[2] = {1.0f, CSSValue::MakeNumeric(100.0f, Unit::PX)};
+
+    AnimationTrackList::TrackDesc desc;
+    desc.m_Property = PropertyId::Width;
+    desc.m_Duration = nsTime::MakeFromSeconds(2.0);
+    desc.m_fIterationCount = nsMath::Infinity<float>();
+    desc.m_Direction = AnimationDirection::Alternate;
+    for (nsUInt32 i = 0; i < 10000; ++i)
+    {
+      desc.m_pOwner = reinterpret_cast<const void*>(static_cast<size_t>(i + 1));
+      desc.m_fStartTime = (i % 100) * 0.01;
+      desc.m_TimingFunction = (i % 2) == 0 ? TimingFunction() : TimingFunction::MakeCubicBezier(0.2f, 0.0f, 0.0f, 1.0f);
+      tracks.AddTrack(desc, nsArrayPtr<const AnimationTrackList::Keyframe>(keyframes));
+    }
+
+    AnimationTrackList::Samples samples;
+    tracks.Sample(0.0, samples);
+
+    nsStopwatch timer;
+    for (nsUInt32 i = 0; i < 100; ++i)
+    {
+      tracks.Sample(1.0 + i / 60.0, samples);
+    }
+    const nsTime tSample = timer.GetRunningTotal();
+
+    NS_TEST_INT(samples.m_Values.GetCount(), 10000);
+    nsLog::Info("Sampling {0} tracks: {1} ms per frame", tracks.GetTrackCount(), nsArgF(tSample.GetMilliseconds() / 100.0, 4));
+  }
+}
@@ -0,0 +1,233 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/dom/DOMElement.h>
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+namespace
+{
+  using aperture::PropertyId;
+  using aperture::css::CSSStyleSheet;
+  using aperture::css::StyleCache;
+  using aperture::css::StyleResolver;
+  using aperture::dom::DOMElement;
+  using aperture::test::MakeElement;
+
+  void Compile(const CSSStyleSheet& sheet, nsContiguousMemoryStreamStorage& out_storage)
+  {
+    nsMemoryStreamWriter writer(&out_storage);
+    sheet.WriteBinary(writer).AssertSuccess();
+  }
+
+  // uiCount rules in the shape of a typical game UI sheet.
+  std::string BuildLargeSheet(nsUInt32 uiCount)
+  {
+    std::string source;
+    char szRule[512];
+    for (nsUInt32 i = 0; i < uiCount; ++i)
+    {
+      snprintf(szRule, sizeof(szRule),
+        ".panel-%u > .row:nth-child(2n+1) .item-%u:not(.disabled), #slot-%u[data-rarity=\"epic\"]:hover {\n"
+        "  margin: 2px 4px; padding: 0.5em; border: 1px solid #%06x; color: rgba(255, 200, 0, 0.8);\n"
+        "  display: flex; flex-direction: column; width: %u%%; --accent: #123456; background-color: var(--accent, red) !important;\n"
+        "}\n",
+        i % 40, i, i, (i * 2654435761u) & 0xffffff, i % 100);
+      source += szRule;
+    }
+    return source;
+  }
+
+  constexpr const char* s_szSheet = R"(
+    .app { --accent: orange; font-size: 14px; color: #ddd; }
+    .panel, .dialog > header { padding: 4px 8px; border: 1px solid #333; }
+    ul li:nth-child(odd):not(.hidden) { background-color: #1a1a1a; }
+    a[href^="https"] { color: var(--accent) !important; }
+    #main .item:hover::before { width: 50%; }
+    .item + .item, .item ~ .divider { margin-left: 2px; }
+    @media (min-width: 100px) { .app { opacity: 0.5; } }
+    @keyframes pulse { from, 50% { opacity: 0.2; } to { opacity: 1; transform: scale(2); } }
+    .broken { width: ; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(CSS, BinaryStyleSheet)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Round trip")
+  {
+    CSSStyleSheet source;
+    source.ParseFromString(s_szSheet);
+
+    nsContiguousMemoryStreamStorage storage;
+    Compile(source, storage);
+
+    CSSStyleSheet loaded;
+    NS_TEST_BOOL(loaded.ReadBinaryFromMemory(storage.GetData(), storage.GetStorageSize64()).Succeeded());
+    NS_TEST_INT(loaded.GetRuleCount(), source.GetRuleCount());
+    NS_TEST_INT(loaded.GetParseErrorCount(), source.GetParseErrorCount());
+
+    for (nsUInt32 r = 0; r < source.GetRuleCount(); ++r)
+    {
+      const CSSStyleSheet::Rule& rule = source.GetRule(r);
+      const CSSStyleSheet::Rule& loadedRule = loaded.GetRule(r);
+      NS_TEST_INT(loadedRule.m_uiSelectorCount, rule.m_uiSelectorCount);
+      NS_TEST_INT(loadedRule.m_uiMediaBlock, rule.m_uiMediaBlock);
+
+      // Atoms are remapped through the string table, within one process they come out identical.
+      NS_TEST_BOOL(loaded.GetDeclarations(loadedRule) == source.GetDeclarations(rule));
+
+      for (nsUInt32 s = 0; s < rule.m_uiSelectorCount; ++s)
+      {
+        const auto& selector = source.GetSelector(rule.m_uiFirstSelector + s);
+        const auto& loadedSelector = loaded.GetSelector(loadedRule.m_uiFirstSelector + s);
+        NS_TEST_INT(loadedSelector.GetSpecificity(), selector.GetSpecificity());
+        NS_TEST_INT(loadedSelector.GetKeyAtom(), selector.GetKeyAtom());
+        NS_TEST_BOOL(loadedSelector.GetPseudoElement() == selector.GetPseudoElement());
+        NS_TEST_BOOL(nsMemoryUtils::IsEqual(loadedSelector.GetAncestorHashes(), selector.GetAncestorHashes(), aperture::css::CSSSelector::MaxAncestorHashes));
+      }
+    }
+
+    NS_TEST_INT(loaded.GetMediaBlockCount(), 1);
+    NS_TEST_BOOL(loaded.GetMediaBlock(0).m_Queries == source.GetMediaBlock(0).m_Queries);
+
+    NS_TEST_INT(loaded.GetKeyframesRuleCount(), 1);
+    const CSSStyleSheet::KeyframesRule* pKeyframes = loaded.FindKeyframesRule(aperture::core::MakeAtom("pulse"));
+    NS_TEST_BOOL(pKeyframes != nullptr && pKeyframes->m_uiKeyframeCount == 3);
+    if (pKeyframes != nullptr)
+    {
+      const CSSStyleSheet::KeyframesRule& sourceKeyframes = *source.FindKeyframesRule(aperture::core::MakeAtom("pulse"));
+      for (nsUInt32 k = 0; k < pKeyframes->m_uiKeyframeCount; ++k)
+      {
+        const CSSStyleSheet::Keyframe& keyframe = loaded.GetKeyframes(*pKeyframes)[k];
+        NS_TEST_FLOAT(keyframe.m_fOffset, source.GetKeyframes(sourceKeyframes)[k].m_fOffset, 0.0f);
+        NS_TEST_BOOL(loaded.GetDeclarations(keyframe) == source.GetDeclarations(source.GetKeyframes(sourceKeyframes)[k]));
+      }
+    }
+
+    // Both sheets resolve to the very same shared styles.
+    StyleCache cache;
+    StyleResolver fromSource(cache);
+    fromSource.AddStyleSheet(&source);
+    StyleResolver fromBinary(cache);
+    fromBinary.AddStyleSheet(&loaded);
+
+    auto app = MakeElement("div", "app");
+    auto list = MakeElement("ul");
+    auto link = MakeElement("a");
+    link->setAttribute("href", "https://example.com");
+    app->appendChild(list);
+    app->appendChild(link);
+    for (nsUInt32 i = 0; i < 4; ++i)
+    {
+      list->appendChild(MakeElement("li", i == 2 ? "hidden" : nullptr));
+    }
+
+    fromSource.ResolveStyles(*app);
+    const aperture::css::ComputedStyle* pExpectedItem = static_cast<DOMElement&>(*list->getChildNodes()[0]).getComputedStyle();
+    const aperture::css::ComputedStyle* pExpectedLink = link->getComputedStyle();
+
+    fromBinary.ResolveStyles(*app);
+    NS_TEST_BOOL(static_cast<DOMElement&>(*list->getChildNodes()[0]).getComputedStyle() == pExpectedItem);
+    NS_TEST_BOOL(link->getComputedStyle() == pExpectedLink);
+    NS_TEST_BOOL(link->getComputedStyle()->Get(PropertyId::Color).m_Unit == aperture::core::Unit::COLOUR);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Loading replaces the sheet")
+  {
+    CSSStyleSheet source;
+    source.ParseFromString(s_szSheet);
+
+    nsContiguousMemoryStreamStorage storage;
+    Compile(source, storage);
+
+    CSSStyleSheet loaded;
+    loaded.ParseFromString(".old { width: 1px; } .older { height: 1px; }");
+    NS_TEST_BOOL(loaded.ReadBinaryFromMemory(storage.GetData(), storage.GetStorageSize64()).Succeeded());
+    NS_TEST_INT(loaded.GetRuleCount(), source.GetRuleCount());
+    NS_TEST_BOOL(loaded.GetDeclarations(loaded.GetRule(0)) == source.GetDeclarations(source.GetRule(0)));
+
+    // An empty sheet round trips as well.
+    CSSStyleSheet empty;
+    nsContiguousMemoryStreamStorage emptyStorage;
+    Compile(empty, emptyStorage);
+    NS_TEST_BOOL(loaded.ReadBinaryFromMemory(emptyStorage.GetData(), emptyStorage.GetStorageSize64()).Succeeded());
+    NS_TEST_INT(loaded.GetRuleCount(), 0);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupted sheets are rejected")
+  {
+    CSSStyleSheet source;
+    source.ParseFromString(s_szSheet);
+    NS_TEST_BOOL(source.GetParseErrorCount() > 0);
+
+    nsContiguousMemoryStreamStorage storage;
+    Compile(source, storage);
+    const nsUInt32 uiSize = static_cast<nsUInt32>(storage.GetStorageSize64());
+    nsDynamicArray<nsUInt8> copy;
+    copy.SetCountUninitialized(uiSize);
+    nsMemoryUtils::Copy(copy.GetData(), storage.GetData(), uiSize);
+
+    // The rules chunk starts with the parse error count, followed by the rule count.
+    const nsUInt32 rulesHeader[2] = {source.GetParseErrorCount(), source.GetRuleCount()};
+    nsUInt32 uiRuleCountOffset = nsInvalidIndex;
+    for (nsUInt32 i = 0; i + sizeof(rulesHeader) <= uiSize && uiRuleCountOffset == nsInvalidIndex; ++i)
+    {
+      if (nsMemoryUtils::RawByteCompare(copy.GetData() + i, rulesHeader, sizeof(rulesHeader)) == 0)
+        uiRuleCountOffset = i + sizeof(nsUInt32);
+    }
+    NS_TEST_BOOL(uiRuleCountOffset != nsInvalidIndex);
+
+    if (uiRuleCountOffset != nsInvalidIndex)
+    {
+      CSSStyleSheet loaded;
+      auto SetRuleCount = [&](nsUInt32 uiCount) { nsMemoryUtils::RawByteCopy(copy.GetData() + uiRuleCountOffset, &uiCount, sizeof(uiCount)); };
+
+      // Counts are checked before anything is allocated for them.
+      SetRuleCount(0xFFFFFFF0u);
+      NS_TEST_BOOL(loaded.ReadBinaryFromMemory(copy.GetData(), uiSize).Failed());
+      NS_TEST_INT(loaded.GetRuleCount(), 0);
+
+      // One rule more than the chunk has the bytes for.
+      SetRuleCount(source.GetRuleCount() + 1);
+      NS_TEST_BOOL(loaded.ReadBinaryFromMemory(copy.GetData(), uiSize).Failed());
+
+      SetRuleCount(source.GetRuleCount());
+      NS_TEST_BOOL(loaded.ReadBinaryFromMemory(copy.GetData(), uiSize).Succeeded());
+      NS_TEST_INT(loaded.GetRuleCount(), source.GetRuleCount());
+
+      // The stream ends in the middle of the rules.
+      NS_TEST_BOOL(loaded.ReadBinaryFromMemory(copy.GetData(), uiRuleCountOffset + 12).Failed());
+      NS_TEST_INT(loaded.GetRuleCount(), 0);
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark load of 2000 rules")
+  {
+    const std::string source = BuildLargeSheet(2000);
+
+    nsStopwatch timer;
+    CSSStyleSheet parsed;
+    parsed.ParseFromString(source);
+    const nsTime tParse = timer.GetRunningTotal();
+    NS_TEST_INT(parsed.GetRuleCount(), 2000);
+    NS_TEST_INT(parsed.GetParseErrorCount(), 0);
+
+    nsContiguousMemoryStreamStorage storage;
+    Compile(parsed, storage);
+
+    timer.StopAndReset();
+    timer.Resume();
+    CSSStyleSheet loaded;
+    NS_TEST_BOOL(loaded.ReadBinaryFromMemory(storage.GetData(), storage.GetStorageSize64()).Succeeded());
+    const nsTime tLoad = timer.GetRunningTotal();
+    NS_TEST_INT(loaded.GetRuleCount(), 2000);
+
+    nsLog::Info("Stylesheet with 2000 rules ({0} KB source, {1} KB compiled): {2} ms parse, {3} ms load", source.size() / 1024, storage.GetStorageSize64() / 1024,
+      nsArgF(tParse.GetMilliseconds(), 2), nsArgF(tLoad.GetMilliseconds(), 2));
+  }
+}
@@ -0,0 +1,263 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/dom/DOMElement.h>
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+namespace
+{
+  using aperture::PropertyId;
+  using aperture::core::Unit;
+  using aperture::css::ComputedStyle;
+  using aperture::css::CSSPropertyTable;
+  using aperture::css::CSSStyleSheet;
+  using aperture::css::StyleCache;
+  using aperture::css::StyleResolver;
+  using aperture::dom::DOMElement;
+  using aperture::test::MakeElement;
+
+  nsUInt32 Color(const char* szColor)
+  {
+    nsUInt32 uiColor = 0;
+    CSSPropertyTable::ParseColor(szColor, uiColor).IgnoreResult();
+    return uiColor;
+  }
+
+  constexpr const char* s_szInventorySheet = R"(
+    .inventory { font-size: 20px; color: #eee; }
+    .slot { width: 64px; height: 64px; margin: 2px; background-color: #222; border: 1px solid #444; }
+    .slot.selected { border-color: orange; }
+    .slot img { width: 100%; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(CSS, ComputedStyle)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Cascade and inheritance")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(R"(
+      body { color: red; font-size: 10px; }
+      .box { margin: 1px 2px 3px; padding: 1em; display: block !important; }
+      #main.box { margin-left: 7px; }
+      div { display: inline; color: inherit; }
+      .rem { width: 2rem; border-top-color: currentcolor; }
+      @media screen { .box { opacity: 0.5; } }
+    )");
+    NS_TEST_INT(sheet.GetRuleCount(), 6);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto body = MakeElement("body");
+    auto box = MakeElement("div", "box rem", "color: blue; font-size: 200%");
+    box->setAttribute("id", "main");
+    auto span = MakeElement("span");
+    body->appendChild(box);
+    box->appendChild(span);
+
+    resolver.ResolveStyles(*body);
+
+    const ComputedStyle* pBody = body->getComputedStyle();
+    const ComputedStyle* pBox = box->getComputedStyle();
+    const ComputedStyle* pSpan = span->getComputedStyle();
+    NS_TEST_BOOL(pBody != nullptr && pBox != nullptr && pSpan != nullptr);
+
+    NS_TEST_INT(pBody->Get(PropertyId::Color).m_uiData, Color("red"));
+    NS_TEST_FLOAT(pBody->Get(PropertyId::FontSize).m_fNumber, 10.0f, 0.0f);
+
+    // Shorthand expansion with the id rule winning for one side.
+    NS_TEST_FLOAT(pBox->Get(PropertyId::MarginTop).m_fNumber, 1.0f, 0.0f);
+    NS_TEST_FLOAT(pBox->Get(PropertyId::MarginRight).m_fNumber, 2.0f, 0.0f);
+    NS_TEST_FLOAT(pBox->Get(PropertyId::MarginBottom).m_fNumber, 3.0f, 0.0f);
+    NS_TEST_FLOAT(pBox->Get(PropertyId::MarginLeft).m_fNumber, 7.0f, 0.0f);
+
+    // !important beats the later, less specific tag rule. The inline style beats color: inherit.
+    NS_TEST_BOOL(pBox->Get(PropertyId::Display).IsKeyword(aperture::core::MakeAtom("block")));
+    NS_TEST_INT(pBox->Get(PropertyId::Color).m_uiData, Color("blue"));
+
+    // Font relative units resolve to px.
+    NS_TEST_FLOAT(pBox->Get(PropertyId::FontSize).m_fNumber, 20.0f, 0.0f);
+    NS_TEST_BOOL(pBox->Get(PropertyId::PaddingTop).m_Unit == Unit::PX);
+    NS_TEST_FLOAT(pBox->Get(PropertyId::PaddingTop).m_fNumber, 20.0f, 0.0f);
+    NS_TEST_FLOAT(pBox->Get(PropertyId::Width).m_fNumber, 20.0f, 0.0f);
+    NS_TEST_INT(pBox->Get(PropertyId::BorderTopColor).m_uiData, Color("blue"));
+
+    // Rules inside @media apply while their query matches, screen always does.
+    NS_TEST_FLOAT(pBox->Get(PropertyId::Opacity).m_fNumber, 0.5f, 0.0f);
+
+    // Inherited properties pass down, others take the initial value.
+    NS_TEST_INT(pSpan->Get(PropertyId::Color).m_uiData, Color("blue"));
+    NS_TEST_FLOAT(pSpan->Get(PropertyId::FontSize).m_fNumber, 20.0f, 0.0f);
+    NS_TEST_BOOL(pSpan->Get(PropertyId::Display) == ComputedStyle::GetInitialStyle().Get(PropertyId::Display));
+    NS_TEST_FLOAT(pSpan->Get(PropertyId::MarginLeft).m_fNumber, 0.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Style cache")
+  {
+    StyleCache cache;
+
+    ComputedStyle style;
+    style.Set(PropertyId::Width, aperture::css::CSSValue::MakeNumeric(10.0f, Unit::PX));
+    auto pFirst = cache.GetOrAdd(style);
+    auto pSecond = cache.GetOrAdd(style);
+    NS_TEST_BOOL(pFirst == pSecond);
+    NS_TEST_INT(cache.GetStyleCount(), 1);
+
+    style.Set(PropertyId::Width, aperture::css::CSSValue::MakeNumeric(11.0f, Unit::PX));
+    auto pThird = cache.GetOrAdd(style);
+    NS_TEST_BOOL(pThird != pFirst);
+    NS_TEST_INT(cache.GetStyleCount(), 2);
+
+    pThird = nullptr;
+    cache.CollectGarbage();
+    NS_TEST_INT(cache.GetStyleCount(), 1);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Grouped storage")
+  {
+    const ComputedStyle& initial = ComputedStyle::GetInitialStyle();
+    for (nsUInt32 i = 1; i < ComputedStyle::PropertyCount; ++i)
+    {
+      const PropertyId id = static_cast<PropertyId>(i);
+      NS_TEST_BOOL(CSSPropertyTable::IsInherited(id) == (aperture::css::GetStyleGroup(id) == aperture::css::StyleGroup::Text));
+      const aperture::css::CSSValue& value = CSSPropertyTable::GetInitialValue(id);
+      if (value.m_Unit == Unit::STRING)
+        NS_TEST_BOOL(initial.GetString(id) == CSSPropertyTable::GetInitialStrings().Get(value.m_uiData));
+      else
+        NS_TEST_BOOL(initial.Get(id) == value);
+    }
+
+    // Setting a value copies only the group it lives in, the initial style is left alone.
+    ComputedStyle style;
+    style.Set(PropertyId::Width, aperture::css::CSSValue::MakeNumeric(10.0f, Unit::PX));
+    NS_TEST_BOOL(&style.GetBox() != &initial.GetBox());
+    NS_TEST_BOOL(&style.GetText() == &initial.GetText());
+    NS_TEST_BOOL(&style.GetVisual() == &initial.GetVisual());
+    NS_TEST_BOOL(initial.Get(PropertyId::Width) == CSSPropertyTable::GetInitialValue(PropertyId::Width));
+
+    ComputedStyle copy(style);
+    copy.Set(PropertyId::Width, aperture::css::CSSValue::MakeNumeric(20.0f, Unit::PX));
+    NS_TEST_FLOAT(style.Get(PropertyId::Width).m_fNumber, 10.0f, 0.0f);
+    NS_TEST_FLOAT(copy.Get(PropertyId::Width).m_fNumber, 20.0f, 0.0f);
+
+    // Children that do not declare inherited properties share the inherited group of their parent.
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(".panel { color: red; font-size: 12px; } .item { width: 10px; } .label { font-size: 2em; }");
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto panel = MakeElement("div", "panel");
+    auto item = MakeElement("div", "item");
+    auto label = MakeElement("span", "label");
+    panel->appendChild(item);
+    panel->appendChild(label);
+    resolver.ResolveStyles(*panel);
+
+    const ComputedStyle* pPanel = panel->getComputedStyle();
+    const ComputedStyle* pItem = item->getComputedStyle();
+    const ComputedStyle* pLabel = label->getComputedStyle();
+    NS_TEST_BOOL(&pItem->GetText() == &pPanel->GetText());
+    NS_TEST_BOOL(&pLabel->GetText() != &pPanel->GetText());
+    NS_TEST_FLOAT(pLabel->Get(PropertyId::FontSize).m_fNumber, 24.0f, 0.0f);
+    NS_TEST_INT(pLabel->Get(PropertyId::Color).m_uiData, Color("red"));
+
+    NS_TEST_BOOL(pItem->IsExplicitlySet(PropertyId::Width));
+    NS_TEST_BOOL(!pItem->IsExplicitlySet(PropertyId::Color));
+    NS_TEST_BOOL(pPanel->IsExplicitlySet(PropertyId::Color));
+
+    // The panel and the label differ in the box group from the item, but not from each other.
+    NS_TEST_BOOL(&pPanel->GetBox() == &pLabel->GetBox());
+    NS_TEST_INT(cache.GetGroupCount(aperture::css::StyleGroup::Box), 2);
+    NS_TEST_INT(cache.GetGroupCount(aperture::css::StyleGroup::Text), 2);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Sibling sharing")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szInventorySheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+    NS_TEST_BOOL(resolver.IsSiblingSharingEnabled());
+
+    auto inventory = MakeElement("div", "inventory");
+    for (nsUInt32 i = 0; i < 500; ++i)
+    {
+      auto slot = MakeElement("div", i == 42 ? "slot selected" : "slot");
+      slot->appendChild(MakeElement("img"));
+      inventory->appendChild(slot);
+    }
+
+    resolver.ResolveStyles(*inventory);
+
+    const auto& slots = inventory->getChildNodes();
+    const ComputedStyle* pSlotStyle = static_cast<const DOMElement&>(*slots[0]).getComputedStyle();
+    const ComputedStyle* pImgStyle = static_cast<const DOMElement&>(*slots[0]->getChildNodes()[0]).getComputedStyle();
+    for (nsUInt32 i = 0; i < 500; ++i)
+    {
+      const DOMElement& slot = static_cast<const DOMElement&>(*slots[i]);
+      if (i != 42)
+        NS_TEST_BOOL(slot.getComputedStyle() == pSlotStyle);
+      // Different parents with equal styles still end up with one object through the cache.
+      NS_TEST_BOOL(static_cast<const DOMElement&>(*slot.getChildNodes()[0]).getComputedStyle() == pImgStyle);
+    }
+
+    const ComputedStyle* pSelected = static_cast<const DOMElement&>(*slots[42]).getComputedStyle();
+    NS_TEST_BOOL(pSelected != pSlotStyle);
+    NS_TEST_INT(pSelected->Get(PropertyId::BorderTopColor).m_uiData, Color("orange"));
+    NS_TEST_FLOAT(pImgStyle->Get(PropertyId::FontSize).m_fNumber, 20.0f, 0.0f);
+
+    // The inventory, a slot, the selected slot and the image.
+    NS_TEST_INT(cache.GetStyleCount(), 4);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 1001);
+    NS_TEST_BOOL(resolver.GetStats().m_uiSharedWithSibling >= 497);
+
+    // Positional selectors turn sharing off, siblings can match differently.
+    CSSStyleSheet positional;
+    positional.ParseFromString(".slot:nth-child(2n) { width: 32px; }");
+    resolver.AddStyleSheet(&positional);
+    NS_TEST_BOOL(!resolver.IsSiblingSharingEnabled());
+    resolver.ResetStats();
+    resolver.ResolveStyles(*inventory);
+    NS_TEST_INT(resolver.GetStats().m_uiSharedWithSibling, 0);
+    NS_TEST_FLOAT(static_cast<const DOMElement&>(*slots[1]).getComputedStyle()->Get(PropertyId::Width).m_fNumber, 32.0f, 0.0f);
+    NS_TEST_FLOAT(static_cast<const DOMElement&>(*slots[2]).getComputedStyle()->Get(PropertyId::Width).m_fNumber, 64.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark 10k inventory slots")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szInventorySheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto inventory = MakeElement("div", "inventory");
+    for (nsUInt32 i = 0; i < 10000; ++i)
+    {
+      auto slot = MakeElement("div", "slot");
+      slot->appendChild(MakeElement("img"));
+      inventory->appendChild(slot);
+    }
+
+    nsStopwatch timer;
+    resolver.ResolveStyles(*inventory);
+    const nsTime tResolve = timer.GetRunningTotal();
+
+    nsLog::Info("Style resolve of {0} elements: {1} ms, {2} shared with a sibling, {3} distinct styles", resolver.GetStats().m_uiResolvedElements,
+      nsArgF(tResolve.GetMilliseconds(), 2), resolver.GetStats().m_uiSharedWithSibling, cache.GetStyleCount());
+    NS_TEST_INT(cache.GetStyleCount(), 3);
+  }
+}
@@ -0,0 +1,305 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/css/Function/CSSVarFunction.h>
+#include <APHTML/css/Style/CSSPropertyTable.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleInvalidator.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/dom/DOMElement.h>
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+namespace
+{
+  using aperture::PropertyId;
+  using aperture::core::MakeAtom;
+  using aperture::core::Unit;
+  using aperture::css::CSSCustomProperties;
+  using aperture::css::CSSPropertyTable;
+  using aperture::css::CSSStyleSheet;
+  using aperture::css::CSSVarFunction;
+  using aperture::css::CSSVarVariant;
+  using aperture::css::StyleCache;
+  using aperture::css::StyleInvalidator;
+  using aperture::css::StyleResolver;
+  using aperture::dom::DOMElement;
+  using aperture::test::GetChild;
+  using aperture::test::MakeElement;
+
+  nsUInt32 Color(const char* szColor)
+  {
+    nsUInt32 uiColor = 0;
+    CSSPropertyTable::ParseColor(szColor, uiColor).IgnoreResult();
+    return uiColor;
+  }
+
+  std::string Substitute(const CSSCustomProperties& properties, const char* szValue)
+  {
+    std::string result;
+    if (CSSVarFunction(&properties).Substitute(szValue, result).Failed())
+      return "<invalid>";
+    return result;
+  }
+
+  // A HUD with uiPanels panels, each with uiItems labels and uiItems icons.
+  std::shared_ptr<DOMElement> BuildThemedHud(nsUInt32 uiPanels, nsUInt32 uiItems)
+  {
+    auto hud = MakeElement("div", "hud", "--accent: red; --size: 10px");
+    for (nsUInt32 p = 0; p < uiPanels; ++p)
+    {
+      auto panel = MakeElement("div", "panel");
+      for (nsUInt32 i = 0; i < uiItems; ++i)
+      {
+        panel->appendChild(MakeElement("span", "label"));
+        panel->appendChild(MakeElement("img", "icon"));
+      }
+      hud->appendChild(panel);
+    }
+    return hud;
+  }
+
+  constexpr const char* s_szThemeSheet = R"(
+    .panel { padding: 2px; }
+    .label { color: var(--accent); }
+    .icon { width: var(--size); height: var(--size); }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(CSS, CustomProperties)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Substitution")
+  {
+    CSSCustomProperties properties;
+    properties.Set(MakeAtom("--gap"), "4px");
+    properties.Set(MakeAtom("--accent"), "#ff0000");
+    properties.Set(MakeAtom("--font"), "\"Arial\", sans-serif");
+    NS_TEST_INT(properties.GetEntries().GetCount(), 3);
+
+    NS_TEST_STRING(Substitute(properties, "var(--gap)").c_str(), "4px");
+    NS_TEST_STRING(Substitute(properties, "var(--gap) 2px VAR( --gap )").c_str(), "4px 2px 4px");
+    NS_TEST_STRING(Substitute(properties, "var(--missing, 1px 2px)").c_str(), " 1px 2px");
+    NS_TEST_STRING(Substitute(properties, "var(--missing, var(--other, var(--gap)))").c_str(), "  4px");
+    NS_TEST_STRING(Substitute(properties, "rgba(0, 0, 0, 0.5) var(--font)").c_str(), "rgba(0, 0, 0, 0.5) \"Arial\", sans-serif");
+    NS_TEST_STRING(Substitute(properties, "var(--missing)").c_str(), "<invalid>");
+    NS_TEST_STRING(Substitute(properties, "var(gap)").c_str(), "<invalid>");
+
+    nsHybridArray<aperture::core::Atom, 4> references;
+    CSSVarFunction::CollectReferences("var(--a, var(--b)) calc(var(--c) * 2)", references);
+    NS_TEST_INT(references.GetCount(), 3);
+    NS_TEST_BOOL(references[0] == MakeAtom("--a") && references[1] == MakeAtom("--b") && references[2] == MakeAtom("--c"));
+    NS_TEST_BOOL(CSSVarFunction::ContainsVariables("1px Var(--x)"));
+    NS_TEST_BOOL(!CSSVarFunction::ContainsVariables("calc(1px + 2px)"));
+
+    CSSVarVariant variant;
+    CSSVarFunction function(&properties);
+    NS_TEST_BOOL(function.EvaluateVariable("--gap", variant).Succeeded());
+    NS_TEST_BOOL(variant.m_type == CSSVarVariant::UniqueType::Number && variant.m_unit == Unit::PX);
+    NS_TEST_FLOAT(variant.m_internalvariant.Get<float>(), 4.0f, 0.0f);
+    NS_TEST_BOOL(function.EvaluateVariable("--accent", variant).Succeeded());
+    NS_TEST_BOOL(variant.m_type == CSSVarVariant::UniqueType::Color && variant.m_internalvariant.Get<nsUInt32>() == Color("red"));
+    NS_TEST_BOOL(function.EvaluateVariable("--font", variant).Succeeded() && variant.m_type == CSSVarVariant::UniqueType::Raw);
+    NS_TEST_BOOL(function.EvaluateVariable("--missing", variant).Failed());
+
+    properties.Remove(MakeAtom("--gap"));
+    NS_TEST_STRING(Substitute(properties, "var(--gap, 0)").c_str(), " 0");
+
+    // Replacing values many times doesn't keep the old text around forever.
+    for (nsUInt32 i = 0; i < 100; ++i)
+    {
+      properties.Set(MakeAtom("--accent"), std::to_string(i));
+    }
+    NS_TEST_BOOL(properties.Get(MakeAtom("--accent")) == "99");
+    NS_TEST_INT(properties.GetEntries().GetCount(), 2);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Cascade and inheritance")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(R"(
+      .app { --accent: red; --gap: 4px; --pad: var(--gap); }
+      .box { color: var(--accent); margin: var(--pad) 2px; }
+      .override { --accent: blue !important; }
+      .box.override { --accent: green; }
+      .missing { width: var(--nope, 7px); height: var(--nope); color: var(--nope); }
+    )");
+    NS_TEST_INT(sheet.GetParseErrorCount(), 0);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto app = MakeElement("div", "app", "--gap: 6px");
+    auto box = MakeElement("div", "box");
+    auto overridden = MakeElement("div", "box override");
+    auto missing = MakeElement("div", "missing");
+    auto plain = MakeElement("span");
+    app->appendChild(box);
+    app->appendChild(overridden);
+    app->appendChild(missing);
+    box->appendChild(plain);
+    resolver.ResolveStyles(*app);
+
+    // Inline wins over the sheet, and --pad is substituted after --gap.
+    const CSSCustomProperties* pAppProperties = app->getComputedStyle()->GetCustomProperties();
+    NS_TEST_BOOL(pAppProperties != nullptr && pAppProperties->Get(MakeAtom("--pad")) == "6px");
+
+    NS_TEST_INT(box->getComputedStyle()->Get(PropertyId::Color).m_uiData, Color("red"));
+    NS_TEST_FLOAT(box->getComputedStyle()->Get(PropertyId::MarginTop).m_fNumber, 6.0f, 0.0f);
+    NS_TEST_FLOAT(box->getComputedStyle()->Get(PropertyId::MarginRight).m_fNumber, 2.0f, 0.0f);
+
+    // Elements that don't declare custom properties share the set of their parent.
+    NS_TEST_BOOL(box->getComputedStyle()->GetCustomProperties() == pAppProperties);
+    NS_TEST_BOOL(plain->getComputedStyle()->GetCustomProperties() == pAppProperties);
+    NS_TEST_INT(plain->getComputedStyle()->GetVariableMask(), 0);
+
+    NS_TEST_INT(overridden->getComputedStyle()->Get(PropertyId::Color).m_uiData, Color("blue"));
+
+    // Invalid at computed-value time: the fallback, or unset.
+    NS_TEST_FLOAT(missing->getComputedStyle()->Get(PropertyId::Width).m_fNumber, 7.0f, 0.0f);
+    NS_TEST_BOOL(missing->getComputedStyle()->Get(PropertyId::Height) == CSSPropertyTable::GetInitialValue(PropertyId::Height));
+    NS_TEST_BOOL(missing->getComputedStyle()->Get(PropertyId::Color) == app->getComputedStyle()->Get(PropertyId::Color));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Cycles")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(R"(
+      .outer { --a: 1px; --d: 3px; }
+      .cycle { --a: var(--b); --b: var(--c); --c: var(--a); --e: var(--a, 5px); --self: var(--self); width: var(--e); height: var(--d); min-width: var(--a, 8px); }
+    )");
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto outer = MakeElement("div", "outer");
+    auto cycle = MakeElement("div", "cycle");
+    outer->appendChild(cycle);
+    resolver.ResolveStyles(*outer);
+
+    // Members of a cycle are guaranteed-invalid, even if the parent has a value.
+    const CSSCustomProperties* pProperties = cycle->getComputedStyle()->GetCustomProperties();
+    NS_TEST_BOOL(pProperties != nullptr);
+    std::string_view value;
+    NS_TEST_BOOL(!pProperties->TryGet(MakeAtom("--a"), value));
+    NS_TEST_BOOL(!pProperties->TryGet(MakeAtom("--b"), value));
+    NS_TEST_BOOL(!pProperties->TryGet(MakeAtom("--c"), value));
+    NS_TEST_BOOL(!pProperties->TryGet(MakeAtom("--self"), value));
+    NS_TEST_BOOL(pProperties->Get(MakeAtom("--d")) == "3px");
+
+    // Properties that only reference a cycle use their fallback.
+    NS_TEST_FLOAT(cycle->getComputedStyle()->Get(PropertyId::Width).m_fNumber, 5.0f, 0.0f);
+    NS_TEST_FLOAT(cycle->getComputedStyle()->Get(PropertyId::Height).m_fNumber, 3.0f, 0.0f);
+    NS_TEST_FLOAT(cycle->getComputedStyle()->Get(PropertyId::MinWidth).m_fNumber, 8.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Theme change")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szThemeSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto hud = BuildThemedHud(10, 5);
+    resolver.ResolveStyles(*hud);
+
+    StyleInvalidator invalidator(resolver.GetInvalidationMap());
+    hud->setObserver(&invalidator);
+
+    DOMElement& panel = GetChild(*hud, 3);
+    NS_TEST_INT(GetChild(panel, 0).getComputedStyle()->Get(PropertyId::Color).m_uiData, Color("red"));
+
+    // Only the labels use --accent. Panels and icons just take over the new custom properties.
+    hud->setAttribute("style", "--accent: blue; --size: 10px");
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+
+    const bool bNamesCollide = CSSCustomProperties::GetNameBit(MakeAtom("--accent")) == CSSCustomProperties::GetNameBit(MakeAtom("--size"));
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, bNamesCollide ? 101 : 51);
+    NS_TEST_INT(resolver.GetStats().m_uiInheritedVariableChanges, bNamesCollide ? 10 : 60);
+    NS_TEST_INT(GetChild(panel, 0).getComputedStyle()->Get(PropertyId::Color).m_uiData, Color("blue"));
+
+    const CSSCustomProperties* pIconProperties = GetChild(panel, 1).getComputedStyle()->GetCustomProperties();
+    NS_TEST_BOOL(pIconProperties == hud->getComputedStyle()->GetCustomProperties());
+    NS_TEST_BOOL(pIconProperties->Get(MakeAtom("--accent")) == "blue");
+
+    hud->setAttribute("style", "--accent: blue; --size: 12px");
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_FLOAT(GetChild(panel, 1).getComputedStyle()->Get(PropertyId::Width).m_fNumber, 12.0f, 0.0f);
+    NS_TEST_FLOAT(GetChild(panel, 1).getComputedStyle()->Get(PropertyId::Height).m_fNumber, 12.0f, 0.0f);
+
+    hud->setObserver(nullptr);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Values are not interned")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(R"(
+      .box { --shadow: 0 0 4px black; grid-column: 2 / 4; contain: layout paint; width: var(--w, 3px); }
+    )");
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto app = MakeElement("div");
+    auto box = MakeElement("div", "box");
+    app->appendChild(box);
+    resolver.ResolveStyles(*app);
+
+    auto Apply = [&](nsUInt32 i) {
+      const std::string size = std::to_string(100 + i) + "px";
+      app->setAttribute("style", "--w: " + size + "; --label: item-" + std::to_string(i));
+      box->setAttribute("style", "grid-row: " + std::to_string(i + 1) + " / span 2; --extra: var(--w) " + size);
+      resolver.ResolveStyles(*app);
+      NS_TEST_FLOAT(box->getComputedStyle()->Get(PropertyId::Width).m_fNumber, 100.0f + i, 0.0f);
+    };
+
+    // The first pass interns the custom property names. After that, raw values, var() values and their substitutions
+    // live in the sheet and the styles, new values don't add atoms.
+    Apply(0);
+    const nsUInt32 uiAtoms = aperture::core::AtomTable::Get().GetCount();
+    for (nsUInt32 i = 1; i < 50; ++i)
+    {
+      Apply(i);
+    }
+    NS_TEST_INT(aperture::core::AtomTable::Get().GetCount(), uiAtoms);
+
+    NS_TEST_BOOL(box->getComputedStyle()->GetString(PropertyId::GridRowStart) == "50");
+    NS_TEST_BOOL(box->getComputedStyle()->GetCustomProperties()->Get(MakeAtom("--extra")) == "149px 149px");
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark theme change on a 10k element HUD")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szThemeSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto hud = BuildThemedHud(500, 10);
+    resolver.ResolveStyles(*hud);
+
+    StyleInvalidator invalidator(resolver.GetInvalidationMap());
+    hud->setObserver(&invalidator);
+
+    nsStopwatch timer;
+    for (nsUInt32 i = 0; i < 100; ++i)
+    {
+      hud->setAttribute("style", (i % 2) == 0 ? "--accent: blue; --size: 10px" : "--accent: red; --size: 10px");
+      resolver.UpdateStyles(*hud);
+    }
+    const nsTime tUpdate = timer.GetRunningTotal();
+
+    nsLog::Info("Theme change on {0} elements: {1} ms per change, {2} elements resolved", 1 + 500 * 21, nsArgF(tUpdate.GetMilliseconds() / 100.0, 4),
+      resolver.GetStats().m_uiResolvedElements);
+    hud->setObserver(nullptr);
+  }
+}
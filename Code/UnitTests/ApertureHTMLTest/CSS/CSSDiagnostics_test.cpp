@@ -0,0 +1,162 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/core/CSSController.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+
+namespace
+{
+  using aperture::CSSController;
+  using aperture::css::CSSDiagnostic;
+  using aperture::css::CSSErrorDatabase;
+  using aperture::css::CSSStyleSheet;
+
+  // uiCount rules full of properties of other browsers, as found in sheets exported from web tooling.
+  std::string BuildVendorPrefixedSheet(nsUInt32 uiCount)
+  {
+    std::string source;
+    char szRule[512];
+    for (nsUInt32 i = 0; i < uiCount; ++i)
+    {
+      snprintf(szRule, sizeof(szRule),
+        ".item-%u {\n"
+        "  -webkit-user-select: none; -moz-user-select: none; -ms-user-select: none;\n"
+        "  -webkit-font-smoothing: antialiased; -webkit-tap-highlight-color: transparent;\n"
+        "  width: %upx; color: #ddd;\n"
+        "}\n",
+        i, i % 100);
+      source += szRule;
+    }
+    return source;
+  }
+
+  constexpr const char* s_szBrokenSheet = ".a { width: 10px; }\n"
+                                          ".b { -webkit-box-flex: 1; width: blue; }\n"
+                                          ".c:unknown-pseudo { color: red; }\n"
+                                          "@font-face { font-family: Game; }\n"
+                                          "@media (min-width: blue) { .d { width: 1px; } }\n";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(CSS, Diagnostics)
+{
+  CSSErrorDatabase& database = CSSController::GetErrorDatabase();
+  const CSSErrorDatabase::Mode previousMode = database.GetMode();
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Count mode")
+  {
+    database.SetMode(CSSErrorDatabase::Mode::Count);
+    database.ClearErrors();
+
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szBrokenSheet, "broken.css");
+    NS_TEST_INT(database.GetCount(CSSDiagnostic::UnknownProperty), 1);
+    NS_TEST_INT(database.GetCount(CSSDiagnostic::InvalidValue), 1);
+    NS_TEST_INT(database.GetCount(CSSDiagnostic::InvalidSelector), 1);
+    NS_TEST_INT(database.GetCount(CSSDiagnostic::UnsupportedAtRule), 1);
+    NS_TEST_INT(database.GetCount(CSSDiagnostic::InvalidMediaQuery), 1);
+    NS_TEST_INT(database.GetTotalCount(), 5);
+
+    // Nothing is recorded.
+    NS_TEST_INT(database.GetRecordedCount(), 0);
+
+    database.SetMode(CSSErrorDatabase::Mode::Disabled);
+    sheet.ParseFromString(s_szBrokenSheet, "broken.css");
+    NS_TEST_INT(database.GetTotalCount(), 5);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Record mode")
+  {
+    database.SetMode(CSSErrorDatabase::Mode::Record);
+    database.ClearErrors();
+
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szBrokenSheet, "broken.css");
+    NS_TEST_INT(database.GetRecordedCount(), 5);
+
+    const CSSErrorDatabase::Diagnostic unknown = database.GetRecorded(0);
+    NS_TEST_BOOL(unknown.m_Id == CSSDiagnostic::UnknownProperty);
+    NS_TEST_BOOL(unknown.GetArgument() == "-webkit-box-flex");
+    NS_TEST_BOOL(unknown.GetSource() == "broken.css");
+
+    // Messages are only formatted on request, the source text turns the offset into a line and column.
+    nsStringBuilder sMessage;
+    CSSErrorDatabase::FormatDiagnostic(unknown, sMessage, s_szBrokenSheet);
+    NS_TEST_STRING(sMessage, "Semantic Error: Unknown property '-webkit-box-flex' in broken.css at line 2, column 6");
+
+    CSSErrorDatabase::FormatDiagnostic(database.GetRecorded(1), sMessage);
+    NS_TEST_STRING(sMessage, "Semantic Error: Invalid value 'blue' in broken.css at offset 53");
+
+    NS_TEST_BOOL(database.GetRecorded(2).m_Id == CSSDiagnostic::InvalidSelector);
+    NS_TEST_BOOL(database.GetRecorded(3).m_Id == CSSDiagnostic::UnsupportedAtRule);
+    NS_TEST_BOOL(database.GetRecorded(4).m_Id == CSSDiagnostic::InvalidMediaQuery);
+
+    // Inline styles only report if asked to.
+    nsDynamicArray<aperture::css::CSSDeclaration> declarations;
+    aperture::css::CSSStringTable strings;
+    NS_TEST_INT(CSSStyleSheet::ParseDeclarationList("-moz-appearance: none", declarations, strings), 1);
+    NS_TEST_INT(database.GetRecordedCount(), 5);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Ring buffer")
+  {
+    database.SetMode(CSSErrorDatabase::Mode::Record);
+    database.ClearErrors();
+
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(BuildVendorPrefixedSheet(100));
+    NS_TEST_INT(database.GetCount(CSSDiagnostic::UnknownProperty), 500);
+    NS_TEST_INT(database.GetRecordedCount(), CSSErrorDatabase::RingSize);
+    NS_TEST_INT(database.GetDroppedCount(), 500 - CSSErrorDatabase::RingSize);
+
+    // The newest diagnostics are kept.
+    const CSSErrorDatabase::Diagnostic last = database.GetRecorded(CSSErrorDatabase::RingSize - 1);
+    NS_TEST_BOOL(last.GetArgument() == "-webkit-tap-highlight-color");
+    NS_TEST_BOOL(last.GetSource().empty());
+
+    // Long text is cut to the size of a entry, the end of the source name is kept.
+    const std::string argument = "--" + std::string(200, 'a');
+    const std::string source = std::string(200, 'd') + "/theme.css";
+    database.Report(CSSDiagnostic::UnknownProperty, argument, source, 7);
+    const CSSErrorDatabase::Diagnostic truncated = database.GetRecorded(CSSErrorDatabase::RingSize - 1);
+    NS_TEST_BOOL(truncated.IsArgumentTruncated() && truncated.IsSourceTruncated());
+    NS_TEST_INT(truncated.GetArgument().size(), CSSErrorDatabase::Diagnostic::MaxArgumentLength);
+    NS_TEST_BOOL(truncated.GetSource().substr(truncated.GetSource().size() - 10) == "/theme.css");
+
+    nsStringBuilder sMessage;
+    CSSErrorDatabase::FormatDiagnostic(truncated, sMessage);
+    NS_TEST_BOOL(sMessage.FindSubString("aaa...' in ...ddd") != nullptr);
+
+    database.ClearErrors();
+    NS_TEST_INT(database.GetRecordedCount(), 0);
+    NS_TEST_INT(database.GetTotalCount(), 0);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark vendor prefixed sheet")
+  {
+    const std::string source = BuildVendorPrefixedSheet(5000);
+
+    nsTime times[3];
+    const CSSErrorDatabase::Mode modes[3] = {CSSErrorDatabase::Mode::Disabled, CSSErrorDatabase::Mode::Count, CSSErrorDatabase::Mode::Record};
+    for (nsUInt32 m = 0; m < 3; ++m)
+    {
+      database.SetMode(modes[m]);
+      database.ClearErrors();
+
+      CSSStyleSheet sheet;
+      nsStopwatch timer;
+      sheet.ParseFromString(source);
+      times[m] = timer.GetRunningTotal();
+      NS_TEST_INT(sheet.GetParseErrorCount(), 5000 * 5);
+    }
+    NS_TEST_INT(database.GetCount(CSSDiagnostic::UnknownProperty), 5000 * 5);
+
+    nsLog::Info("Parsing 25k unknown declarations: {0} ms disabled, {1} ms counted, {2} ms recorded", nsArgF(times[0].GetMilliseconds(), 2),
+      nsArgF(times[1].GetMilliseconds(), 2), nsArgF(times[2].GetMilliseconds(), 2));
+  }
+
+  database.ClearErrors();
+  database.SetMode(previousMode);
+}
@@ -0,0 +1,232 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/css/Selector/CSSSelectorParser.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleInvalidator.h>
+#include <APHTML/css/Style/StyleResolver.h>
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+namespace
+{
+  using aperture::PropertyId;
+  using aperture::core::MakeAtom;
+  using aperture::css::CSSInvalidationMap;
+  using aperture::css::CSSInvalidationScope;
+  using aperture::css::CSSSelector;
+  using aperture::css::CSSSelectorParser;
+  using aperture::css::CSSStyleSheet;
+  using aperture::css::StyleCache;
+  using aperture::css::StyleInvalidator;
+  using aperture::css::StyleResolver;
+  using aperture::dom::DOMElement;
+  using aperture::dom::ElementState;
+  using aperture::dom::StyleDirty;
+  using aperture::test::GetChild;
+  using aperture::test::MakeElement;
+
+  nsUInt8 GetClassScope(const CSSInvalidationMap& map, const char* szClass)
+  {
+    const CSSInvalidationMap::Dependency* pDependency = map.FindClass(MakeAtom(szClass));
+    return pDependency != nullptr ? pDependency->m_uiScope : CSSInvalidationScope::None;
+  }
+
+  // A HUD with uiPanels panels of uiItems items each.
+  std::shared_ptr<DOMElement> BuildHud(nsUInt32 uiPanels, nsUInt32 uiItems)
+  {
+    auto hud = MakeElement("div", "hud");
+    for (nsUInt32 p = 0; p < uiPanels; ++p)
+    {
+      auto panel = MakeElement("div", "panel");
+      for (nsUInt32 i = 0; i < uiItems; ++i)
+      {
+        panel->appendChild(MakeElement("span", "item"));
+      }
+      hud->appendChild(panel);
+    }
+    return hud;
+  }
+
+  constexpr const char* s_szHudSheet = R"(
+    .item { width: 10px; }
+    .item.active { width: 20px; }
+    .panel:hover .item { color: red; }
+    .hidden { display: none; }
+    [data-warning] { color: orange; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(CSS, Invalidation)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Dependency scopes")
+  {
+    nsDynamicArray<CSSSelector> selectors;
+    NS_TEST_BOOL(CSSSelectorParser::ParseSelectorList(".a, .b .c, .d ~ .e, .f > .g + .h, li:hover, .menu:focus .item, [data-x], #main .i", selectors).Succeeded());
+
+    CSSInvalidationMap map;
+    for (nsUInt32 i = 0; i < selectors.GetCount(); ++i)
+    {
+      map.AddSelector(selectors[i], i);
+    }
+
+    NS_TEST_INT(GetClassScope(map, "a"), CSSInvalidationScope::Self);
+    NS_TEST_INT(GetClassScope(map, "b"), CSSInvalidationScope::Descendants);
+    NS_TEST_INT(GetClassScope(map, "c"), CSSInvalidationScope::Self);
+    NS_TEST_INT(GetClassScope(map, "d"), CSSInvalidationScope::Siblings);
+    NS_TEST_INT(GetClassScope(map, "f"), CSSInvalidationScope::Descendants);
+    NS_TEST_INT(GetClassScope(map, "g"), CSSInvalidationScope::Siblings);
+    NS_TEST_INT(GetClassScope(map, "unused"), CSSInvalidationScope::None);
+    NS_TEST_INT(GetClassScope(map, "item"), CSSInvalidationScope::Self);
+
+    NS_TEST_INT(map.GetStateScope(ElementState::Hover), CSSInvalidationScope::Self);
+    NS_TEST_INT(map.GetStateScope(ElementState::Focus), CSSInvalidationScope::Descendants);
+    NS_TEST_INT(map.GetStateScope(ElementState::Hover | ElementState::Focus), CSSInvalidationScope::Self | CSSInvalidationScope::Descendants);
+    NS_TEST_INT(map.GetStateScope(ElementState::Checked), CSSInvalidationScope::None);
+
+    NS_TEST_BOOL(map.FindAttribute(MakeAtom("data-x")) != nullptr);
+    NS_TEST_BOOL(map.FindId(MakeAtom("main")) != nullptr && map.FindId(MakeAtom("main"))->m_uiScope == CSSInvalidationScope::Descendants);
+
+    const CSSInvalidationMap::Dependency* pItem = map.FindClass(MakeAtom("item"));
+    NS_TEST_BOOL(pItem != nullptr && pItem->m_Rules.GetCount() == 1 && pItem->m_Rules[0] == 5);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Incremental restyle")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szHudSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto hud = BuildHud(100, 10);
+    resolver.ResolveStyles(*hud);
+
+    StyleInvalidator invalidator(resolver.GetInvalidationMap());
+    hud->setObserver(&invalidator);
+
+    DOMElement& panel = GetChild(*hud, 50);
+    DOMElement& item = GetChild(panel, 3);
+
+    // A class only used by the subject restyles the element alone.
+    item.setAttribute("class", "item active");
+    NS_TEST_BOOL((item.getStyleDirtyFlags() & StyleDirty::Self) != 0);
+    NS_TEST_BOOL((hud->getStyleDirtyFlags() & StyleDirty::ChildNeedsStyle) != 0);
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 1);
+    NS_TEST_FLOAT(item.getComputedStyle()->Get(PropertyId::Width).m_fNumber, 20.0f, 0.0f);
+    NS_TEST_INT(hud->getStyleDirtyFlags(), StyleDirty::None);
+
+    // Hovering the panel restyles its items, not the panel or the rest of the HUD.
+    panel.setStateFlags(ElementState::Hover, true);
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 10);
+    NS_TEST_BOOL(item.getComputedStyle()->Get(PropertyId::Color) == GetChild(panel, 0).getComputedStyle()->Get(PropertyId::Color));
+    NS_TEST_BOOL(GetChild(panel, 0).getComputedStyle()->Get(PropertyId::Color) != GetChild(GetChild(*hud, 0), 0).getComputedStyle()->Get(PropertyId::Color));
+
+    panel.setStateFlags(ElementState::Hover, false);
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 10);
+    NS_TEST_BOOL(GetChild(panel, 0).getComputedStyle() == GetChild(GetChild(*hud, 0), 0).getComputedStyle());
+
+    // Changes no selector cares about don't schedule anything.
+    invalidator.ResetStats();
+    item.setAttribute("class", "item active tooltip");
+    item.setAttribute("title", "Sword");
+    panel.setStateFlags(ElementState::Checked, true);
+    NS_TEST_INT(invalidator.GetStats().m_uiChanges, 3);
+    NS_TEST_INT(invalidator.GetStats().m_uiIgnoredChanges, 3);
+    NS_TEST_INT(hud->getStyleDirtyFlags(), StyleDirty::None);
+
+    // Attribute selectors and inline styles.
+    item.setAttribute("data-warning", "");
+    NS_TEST_BOOL((item.getStyleDirtyFlags() & StyleDirty::Self) != 0);
+    item.setAttribute("style", "height: 5px");
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 1);
+    NS_TEST_FLOAT(item.getComputedStyle()->Get(PropertyId::Height).m_fNumber, 5.0f, 0.0f);
+
+    // Inherited changes reach the children even though only the parent was flagged.
+    panel.setAttribute("style", "color: blue");
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 11);
+    NS_TEST_BOOL(GetChild(panel, 0).getComputedStyle()->Get(PropertyId::Color) == panel.getComputedStyle()->Get(PropertyId::Color));
+
+    hud->setObserver(nullptr);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Sibling scope")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(".marker ~ .item { width: 5px; }");
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto list = MakeElement("ul");
+    for (nsUInt32 i = 0; i < 10; ++i)
+    {
+      list->appendChild(MakeElement("li", "item"));
+    }
+    resolver.ResolveStyles(*list);
+
+    StyleInvalidator invalidator(resolver.GetInvalidationMap());
+    list->setObserver(&invalidator);
+
+    GetChild(*list, 6).setAttribute("class", "item marker");
+    resolver.ResetStats();
+    resolver.UpdateStyles(*list);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 3);
+    NS_TEST_FLOAT(GetChild(*list, 7).getComputedStyle()->Get(PropertyId::Width).m_fNumber, 5.0f, 0.0f);
+    NS_TEST_FLOAT(GetChild(*list, 9).getComputedStyle()->Get(PropertyId::Width).m_fNumber, 5.0f, 0.0f);
+    NS_TEST_BOOL(GetChild(*list, 5).getComputedStyle()->Get(PropertyId::Width) != GetChild(*list, 7).getComputedStyle()->Get(PropertyId::Width));
+
+    list->setObserver(nullptr);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark hover on a 10k element HUD")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szHudSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto hud = BuildHud(500, 20);
+    resolver.ResolveStyles(*hud);
+
+    StyleInvalidator invalidator(resolver.GetInvalidationMap());
+    hud->setObserver(&invalidator);
+
+    nsStopwatch timer;
+    resolver.ResolveStyles(*hud);
+    const nsTime tFull = timer.GetRunningTotal();
+
+    resolver.ResetStats();
+    timer.StopAndReset();
+    timer.Resume();
+    for (nsUInt32 p = 0; p < 100; ++p)
+    {
+      DOMElement& panel = GetChild(*hud, p);
+      panel.setStateFlags(ElementState::Hover, true);
+      resolver.UpdateStyles(*hud);
+      panel.setStateFlags(ElementState::Hover, false);
+      resolver.UpdateStyles(*hud);
+    }
+    const nsTime tIncremental = timer.GetRunningTotal();
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 100 * 2 * 20);
+
+    nsLog::Info("Restyle of 10k elements: {0} ms full, {1} ms per hover change", nsArgF(tFull.GetMilliseconds(), 2), nsArgF(tIncremental.GetMilliseconds() / 200.0, 4));
+    hud->setObserver(nullptr);
+  }
+}
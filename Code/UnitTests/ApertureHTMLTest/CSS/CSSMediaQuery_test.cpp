@@ -0,0 +1,259 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/css/Style/CSSMediaQuery.h>
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/dom/DOMElement.h>
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+namespace
+{
+  using aperture::PropertyId;
+  using aperture::css::CSSMediaQueryCache;
+  using aperture::css::CSSMediaQueryList;
+  using aperture::css::CSSStyleSheet;
+  using aperture::css::MediaEnvironment;
+  using aperture::css::MediaTheme;
+  using aperture::css::StyleCache;
+  using aperture::css::StyleResolver;
+  using aperture::dom::DOMElement;
+  using aperture::test::GetChild;
+  using aperture::test::MakeElement;
+
+  MediaEnvironment MakeEnvironment(float fWidth, float fHeight, float fResolution = 1.0f, MediaTheme theme = MediaTheme::Light)
+  {
+    MediaEnvironment environment;
+    environment.m_fWidth = fWidth;
+    environment.m_fHeight = fHeight;
+    environment.m_fResolution = fResolution;
+    environment.m_Theme = theme;
+    return environment;
+  }
+
+  bool Matches(const char* szQuery, const MediaEnvironment& environment)
+  {
+    CSSMediaQueryList list;
+    list.Parse(szQuery);
+    return list.Evaluate(environment);
+  }
+
+  // A HUD with uiPanels panels of uiItems items each, every tenth panel is a minimap.
+  std::shared_ptr<DOMElement> BuildHud(nsUInt32 uiPanels, nsUInt32 uiItems)
+  {
+    auto hud = MakeElement("div", "hud");
+    for (nsUInt32 p = 0; p < uiPanels; ++p)
+    {
+      auto panel = MakeElement("div", p % 10 == 0 ? "panel minimap" : "panel");
+      for (nsUInt32 i = 0; i < uiItems; ++i)
+      {
+        panel->appendChild(MakeElement("span", "item"));
+      }
+      hud->appendChild(panel);
+    }
+    return hud;
+  }
+
+  constexpr const char* s_szHudSheet = R"(
+    .item { width: 10px; }
+    .minimap { width: 200px; }
+    @media (max-width: 1280px) {
+      .minimap { width: 100px; }
+      @media (orientation: portrait) { .minimap { display: none; } }
+    }
+    @media (min-resolution: 2dppx) { .item { border-top-width: 2px; } }
+    @media (prefers-color-scheme: dark) { .hud { color: white; } }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(CSS, MediaQuery)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Evaluate")
+  {
+    const MediaEnvironment desktop = MakeEnvironment(1920, 1080);
+    const MediaEnvironment phone = MakeEnvironment(400, 800, 3.0f, MediaTheme::Dark);
+
+    NS_TEST_BOOL(Matches("", desktop));
+    NS_TEST_BOOL(Matches("all", desktop));
+    NS_TEST_BOOL(Matches("screen", phone));
+    NS_TEST_BOOL(!Matches("print", desktop));
+    NS_TEST_BOOL(Matches("not print", desktop));
+
+    NS_TEST_BOOL(Matches("(min-width: 1024px)", desktop));
+    NS_TEST_BOOL(!Matches("(min-width: 1024px)", phone));
+    NS_TEST_BOOL(Matches("(max-width: 25em)", phone));
+    NS_TEST_BOOL(Matches("(width: 1920px)", desktop));
+    NS_TEST_BOOL(Matches("only screen and (min-height: 600px) and (max-height: 1200px)", desktop));
+    NS_TEST_BOOL(!Matches("not screen and (min-height: 600px)", desktop));
+
+    NS_TEST_BOOL(Matches("(orientation: landscape)", desktop));
+    NS_TEST_BOOL(Matches("(orientation: portrait)", phone));
+    NS_TEST_BOOL(Matches("(min-aspect-ratio: 16/9)", desktop));
+    NS_TEST_BOOL(!Matches("(min-aspect-ratio: 16/9)", phone));
+
+    NS_TEST_BOOL(Matches("(min-resolution: 2dppx)", phone));
+    NS_TEST_BOOL(Matches("(min-resolution: 192dpi)", phone));
+    NS_TEST_BOOL(!Matches("(min-resolution: 2x)", desktop));
+
+    NS_TEST_BOOL(Matches("(prefers-color-scheme: dark)", phone));
+    NS_TEST_BOOL(!Matches("(prefers-color-scheme: dark)", desktop));
+
+    // Any query of a list may match.
+    NS_TEST_BOOL(Matches("print, (max-width: 500px)", phone));
+    NS_TEST_BOOL(!Matches("print, (max-width: 500px)", desktop));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Invalid queries")
+  {
+    CSSMediaQueryList list;
+    NS_TEST_INT(list.Parse("(min-width: 100px), (min-width: blue), (frobnicate), (min-orientation: portrait)"), 3);
+    NS_TEST_INT(list.GetQueryCount(), 4);
+
+    // The valid query of the list is kept.
+    NS_TEST_BOOL(list.Evaluate(MakeEnvironment(200, 100)));
+    NS_TEST_BOOL(!list.Evaluate(MakeEnvironment(50, 100)));
+
+    NS_TEST_INT(list.Parse("(min-width 100px)"), 1);
+    NS_TEST_BOOL(!list.Evaluate(MakeEnvironment(200, 100)));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Serialization")
+  {
+    CSSMediaQueryList list;
+    list.Parse("not screen and (max-width: 800px), (prefers-color-scheme: dark) and (min-resolution: 1.5dppx)");
+
+    nsContiguousMemoryStreamStorage storage;
+    nsMemoryStreamWriter writer(&storage);
+    list.Write(writer);
+
+    CSSMediaQueryList loaded;
+    nsMemoryStreamReader reader(&storage);
+    NS_TEST_BOOL(loaded.Read(reader).Succeeded());
+    NS_TEST_BOOL(loaded == list);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Cache")
+  {
+    CSSMediaQueryList outer;
+    CSSMediaQueryList inner;
+    outer.Parse("(max-width: 1280px)");
+    inner.Parse("(orientation: portrait)");
+
+    CSSMediaQueryCache cache;
+    const nsUInt32 uiOuter = cache.AddBlock(&outer, CSSMediaQueryCache::NoParent);
+    const nsUInt32 uiInner = cache.AddBlock(&inner, uiOuter);
+
+    // A nested block only applies if its parent does.
+    const MediaEnvironment tall = MakeEnvironment(1000, 2000);
+    const MediaEnvironment wideTall = MakeEnvironment(1600, 2000);
+    NS_TEST_BOOL(cache.Evaluate(tall).IsBitSet(uiOuter) && cache.Evaluate(tall).IsBitSet(uiInner));
+    NS_TEST_BOOL(!cache.Evaluate(wideTall).IsBitSet(uiOuter) && !cache.Evaluate(wideTall).IsBitSet(uiInner));
+    NS_TEST_INT(cache.GetEvaluationCount(), 2);
+
+    // Switching back to a recent environment takes its bits from the cache.
+    for (nsUInt32 i = 0; i < 10; ++i)
+    {
+      cache.Evaluate(i % 2 == 0 ? tall : wideTall);
+    }
+    NS_TEST_INT(cache.GetEvaluationCount(), 2);
+
+    // The least recently used environment is evicted.
+    for (nsUInt32 i = 0; i < CSSMediaQueryCache::CacheSize; ++i)
+    {
+      cache.Evaluate(MakeEnvironment(100.0f + i, 100));
+    }
+    NS_TEST_INT(cache.GetEvaluationCount(), 2 + CSSMediaQueryCache::CacheSize);
+    cache.Evaluate(tall);
+    NS_TEST_INT(cache.GetEvaluationCount(), 3 + CSSMediaQueryCache::CacheSize);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Viewport change")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szHudSheet);
+    NS_TEST_INT(sheet.GetMediaBlockCount(), 4);
+    NS_TEST_INT(sheet.GetMediaBlock(1).m_uiParent, 0);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto hud = BuildHud(100, 10);
+    resolver.ResolveStyles(*hud);
+    DOMElement& minimap = GetChild(*hud, 0);
+    NS_TEST_FLOAT(minimap.getComputedStyle()->Get(PropertyId::Width).m_fNumber, 200.0f, 0.0f);
+
+    // Only the minimaps match rules of the block that flipped.
+    resolver.SetMediaEnvironment(MakeEnvironment(1280, 720));
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_INT(resolver.GetStats().m_uiMediaQueryInvalidations, 10);
+    NS_TEST_FLOAT(minimap.getComputedStyle()->Get(PropertyId::Width).m_fNumber, 100.0f, 0.0f);
+    NS_TEST_BOOL(minimap.getComputedStyle()->Get(PropertyId::Display) == GetChild(*hud, 1).getComputedStyle()->Get(PropertyId::Display));
+
+    // The nested block needs its parent to match as well.
+    resolver.SetMediaEnvironment(MakeEnvironment(1600, 2000));
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_INT(resolver.GetStats().m_uiMediaQueryInvalidations, 10);
+    NS_TEST_FLOAT(minimap.getComputedStyle()->Get(PropertyId::Width).m_fNumber, 200.0f, 0.0f);
+    NS_TEST_BOOL(minimap.getComputedStyle()->Get(PropertyId::Display) == GetChild(*hud, 1).getComputedStyle()->Get(PropertyId::Display));
+
+    resolver.SetMediaEnvironment(MakeEnvironment(1000, 2000));
+    resolver.UpdateStyles(*hud);
+    NS_TEST_BOOL(minimap.getComputedStyle()->Get(PropertyId::Display) != GetChild(*hud, 1).getComputedStyle()->Get(PropertyId::Display));
+
+    // Changes no query depends on don't restyle anything.
+    resolver.SetMediaEnvironment(MakeEnvironment(1000, 1900));
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_INT(resolver.GetStats().m_uiMediaQueryInvalidations, 0);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 0);
+
+    // DPI and theme.
+    resolver.SetMediaEnvironment(MakeEnvironment(1000, 1900, 2.0f, MediaTheme::Dark));
+    resolver.ResetStats();
+    resolver.UpdateStyles(*hud);
+    NS_TEST_INT(resolver.GetStats().m_uiMediaQueryInvalidations, 1 + 100 * 10);
+    NS_TEST_FLOAT(GetChild(minimap, 0).getComputedStyle()->Get(PropertyId::BorderTopWidth).m_fNumber, 2.0f, 0.0f);
+    NS_TEST_BOOL(hud->getComputedStyle()->Get(PropertyId::Color) == GetChild(GetChild(*hud, 1), 0).getComputedStyle()->Get(PropertyId::Color));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark resize of a 10k element HUD")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szHudSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto hud = BuildHud(500, 20);
+    resolver.ResolveStyles(*hud);
+
+    nsStopwatch timer;
+    resolver.ResolveStyles(*hud);
+    const nsTime tFull = timer.GetRunningTotal();
+
+    // Toggling between windowed and fullscreen, the bitsets of both come from the cache after the first switch.
+    resolver.ResetStats();
+    timer.StopAndReset();
+    timer.Resume();
+    for (nsUInt32 i = 0; i < 100; ++i)
+    {
+      resolver.SetMediaEnvironment(MakeEnvironment(1280, 720));
+      resolver.UpdateStyles(*hud);
+      resolver.SetMediaEnvironment(MakeEnvironment(1920, 1080));
+      resolver.UpdateStyles(*hud);
+    }
+    const nsTime tResize = timer.GetRunningTotal();
+    NS_TEST_INT(resolver.GetStats().m_uiMediaQueryInvalidations, 100 * 2 * 50);
+    NS_TEST_INT(resolver.GetMediaQueryCache().GetEvaluationCount(), 2);
+
+    nsLog::Info("Restyle of 10k elements: {0} ms full, {1} ms per viewport change", nsArgF(tFull.GetMilliseconds(), 2), nsArgF(tResize.GetMilliseconds() / 200.0, 4));
+  }
+}
@@ -0,0 +1,258 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Threading/TaskSystem.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/dom/DOMFlatTree.h>
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+namespace
+{
+  using aperture::PropertyId;
+  using aperture::css::ComputedStyle;
+  using aperture::css::CSSStyleSheet;
+  using aperture::css::StyleCache;
+  using aperture::css::StyleResolver;
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMFlatTree;
+  using aperture::dom::DOMNode;
+  using aperture::dom::DOMNodeType;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+
+  // uiPanels panels with 25 rows of 19 cells each, 501 elements per panel.
+  std::shared_ptr<DOMElement> BuildDocument(nsUInt32 uiPanels)
+  {
+    const char* panelClasses[] = {"panel", "panel dark", "panel wide", "panel dark wide"};
+
+    auto app = MakeElement("div", "app");
+    for (nsUInt32 p = 0; p < uiPanels; ++p)
+    {
+      auto panel = MakeElement("div", panelClasses[p % 4]);
+      for (nsUInt32 r = 0; r < 25; ++r)
+      {
+        auto row = MakeElement("div", (r % 2) == 0 ? "row" : "row odd");
+        for (nsUInt32 c = 0; c < 19; ++c)
+        {
+          auto cell = MakeElement("span", c == 0 ? "label" : ((c % 7) == 0 ? "value warn" : "value"));
+          if ((p + r + c) % 13 == 0)
+            cell->setAttribute("style", "width: 3em");
+          row->appendChild(cell);
+        }
+        panel->appendChild(row);
+      }
+      app->appendChild(panel);
+    }
+    return app;
+  }
+
+  void CollectStyles(const DOMElement& element, nsDynamicArray<const ComputedStyle*>& out_styles)
+  {
+    out_styles.PushBack(element.getComputedStyle());
+    for (const std::shared_ptr<aperture::dom::DOMNode>& pChild : element.getChildNodes())
+    {
+      if (pChild != nullptr && pChild->getNodeType() == DOMNodeType::ELEMENT_NODE)
+        CollectStyles(static_cast<const DOMElement&>(*pChild), out_styles);
+    }
+  }
+
+  constexpr const char* s_szDocumentSheet = R"(
+    .app { font-size: 14px; color: #ddd; }
+    .panel { padding: 4px; margin: 2px; border: 1px solid #333; }
+    .panel.dark { background-color: #111; color: #bbb; }
+    .wide { width: 50%; }
+    .row { display: flex; height: 1.5em; }
+    .row.odd { background-color: #1a1a1a; }
+    .dark .row.odd { background-color: #0a0a0a; }
+    .label { font-weight: bold; width: 8rem; }
+    .value { flex-grow: 1; }
+    .wide .value { min-width: 2em; }
+    .warn { color: orange; }
+    .dark .warn { color: red; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(CSS, ParallelStyle)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Parallel matches serial")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szDocumentSheet);
+
+    StyleCache cache;
+    StyleResolver serial(cache);
+    serial.AddStyleSheet(&sheet);
+    StyleResolver parallel(cache);
+    parallel.AddStyleSheet(&sheet);
+
+    auto document = BuildDocument(40);
+    serial.ResolveStyles(*document);
+
+    nsDynamicArray<const ComputedStyle*> expected;
+    CollectStyles(*document, expected);
+
+    // Both resolvers share the cache, so equal results are the very same style objects.
+    for (nsUInt32 uiThreads : {2u, 4u, 7u})
+    {
+      parallel.ResetStats();
+      parallel.ResolveStylesParallel(*document, uiThreads);
+      NS_TEST_INT(parallel.GetStats().m_uiResolvedElements, expected.GetCount());
+
+      nsDynamicArray<const ComputedStyle*> actual;
+      CollectStyles(*document, actual);
+      NS_TEST_BOOL(actual == expected);
+    }
+
+    const DOMElement& row = static_cast<const DOMElement&>(*document->getChildNodes()[1]->getChildNodes()[1]);
+    const DOMElement& warn = static_cast<const DOMElement&>(*row.getChildNodes()[7]);
+    NS_TEST_FLOAT(row.getComputedStyle()->Get(PropertyId::Height).m_fNumber, 21.0f, 0.001f);
+    NS_TEST_BOOL(warn.getComputedStyle()->Get(PropertyId::Color) != static_cast<const DOMElement&>(*row.getChildNodes()[1]).getComputedStyle()->Get(PropertyId::Color));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Cousin sharing")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szDocumentSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    // Cells of different rows can't share with a sibling, but match the same rules under the same parent style.
+    auto document = BuildDocument(4);
+    resolver.ResolveStyles(*document);
+    NS_TEST_BOOL(resolver.GetStats().m_uiSharedWithCousin > 0);
+
+    const DOMElement& panel = static_cast<const DOMElement&>(*document->getChildNodes()[0]);
+    const DOMElement& row2 = static_cast<const DOMElement&>(*panel.getChildNodes()[2]);
+    const DOMElement& row4 = static_cast<const DOMElement&>(*panel.getChildNodes()[4]);
+    NS_TEST_BOOL(row2.getComputedStyle() == row4.getComputedStyle());
+    NS_TEST_BOOL(static_cast<const DOMElement&>(*row2.getChildNodes()[2]).getComputedStyle() == static_cast<const DOMElement&>(*row4.getChildNodes()[2]).getComputedStyle());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark scaling on 50k elements")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szDocumentSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto document = BuildDocument(100);
+
+    // Warm up the cache, every run after this only hits.
+    resolver.ResolveStyles(*document);
+
+    const nsUInt32 uiMaxThreads = nsMath::Max(1u, nsTaskSystem::GetWorkerThreadCount(nsWorkerThreadType::ShortTasks));
+    nsTime tSingle;
+    for (nsUInt32 uiThreads = 1;; uiThreads = nsMath::Min(uiThreads * 2, uiMaxThreads))
+    {
+      resolver.ResetStats();
+
+      nsStopwatch timer;
+      resolver.ResolveStylesParallel(*document, uiThreads);
+      const nsTime tResolve = timer.GetRunningTotal();
+      NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, 50101);
+
+      if (uiThreads == 1)
+        tSingle = tResolve;
+
+      nsLog::Info("Style resolve of 50k elements on {0} threads: {1} ms, {2}x", uiThreads, nsArgF(tResolve.GetMilliseconds(), 2),
+        nsArgF(tSingle.GetSeconds() / nsMath::Max(tResolve.GetSeconds(), 0.000001), 2));
+
+      if (uiThreads == uiMaxThreads)
+        break;
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Flat tree matches the DOM walk")
+  {
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szDocumentSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto document = BuildDocument(8);
+    auto text = MakeText("Label");
+    document->getChildNodes()[0]->getChildNodes()[0]->getChildNodes()[0]->appendChild(text);
+
+    resolver.ResolveStyles(*document);
+    nsDynamicArray<const ComputedStyle*> expected;
+    CollectStyles(*document, expected);
+
+    // Equal styles are the same object in the cache, a second document of the same structure gets the same pointers.
+    auto other = BuildDocument(8);
+    DOMFlatTree tree;
+    tree.Build({other}, DOMFlatTree::Flags::StyleDirty);
+    tree.MarkStyleDirty(tree.GetNodeCount() - 1);
+
+    resolver.ResetStats();
+    resolver.ResolveStyles(tree);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, tree.GetNodeCount());
+    NS_TEST_BOOL(!tree.HasFlags(0, DOMFlatTree::Flags::StyleDirty));
+    NS_TEST_BOOL(!tree.HasFlags(0, DOMFlatTree::Flags::DescendantStyleDirty));
+
+    nsDynamicArray<const ComputedStyle*> actual;
+    CollectStyles(*other, actual);
+    NS_TEST_BOOL(actual == expected);
+
+    // Text nodes are part of the flat tree, but aren't resolved.
+    tree.Build({document});
+    resolver.ResetStats();
+    resolver.ResolveStyles(tree);
+    NS_TEST_INT(tree.GetNodeCount(), expected.GetCount() + 1);
+    NS_TEST_INT(resolver.GetStats().m_uiResolvedElements, expected.GetCount());
+
+    actual.Clear();
+    CollectStyles(*document, actual);
+    NS_TEST_BOOL(actual == expected);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark DOM walk against flat tree")
+  {
+    constexpr nsUInt32 uiIterations = 10;
+
+    CSSStyleSheet sheet;
+    sheet.ParseFromString(s_szDocumentSheet);
+
+    StyleCache cache;
+    StyleResolver resolver(cache);
+    resolver.AddStyleSheet(&sheet);
+
+    auto document = BuildDocument(100);
+    resolver.ResolveStyles(*document);
+
+    nsStopwatch timer;
+    DOMFlatTree tree;
+    tree.Build({document});
+    const nsTime tBuild = timer.GetRunningTotal();
+
+    // Both walks do the same work on a warm cache, only the traversal differs.
+    timer.StopAndReset();
+    timer.Resume();
+    for (nsUInt32 i = 0; i < uiIterations; ++i)
+    {
+      resolver.ResolveStyles(*document);
+    }
+    const nsTime tPointerTree = timer.GetRunningTotal();
+
+    timer.StopAndReset();
+    timer.Resume();
+    for (nsUInt32 i = 0; i < uiIterations; ++i)
+    {
+      resolver.ResolveStyles(tree);
+    }
+    const nsTime tFlatTree = timer.GetRunningTotal();
+
+    nsLog::Info("Style resolve of 50k elements x{0}: shared_ptr tree {1} ms, flat tree {2} ms (built in {3} ms)", uiIterations,
+      nsArgF(tPointerTree.GetMilliseconds(), 2), nsArgF(tFlatTree.GetMilliseconds(), 2), nsArgF(tBuild.GetMilliseconds(), 2));
+  }
+}
@@ -0,0 +1,274 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/css/Selector/CSSAncestorFilter.h>
+#include <APHTML/css/Selector/CSSRuleMap.h>
+#include <APHTML/css/Selector/CSSSelectorParser.h>
+#include <APHTML/dom/DOMElement.h>
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+namespace
+{
+  using aperture::css::CSSAncestorFilter;
+  using aperture::css::CSSMatchedRule;
+  using aperture::css::CSSRuleMap;
+  using aperture::css::CSSSelector;
+  using aperture::css::CSSSelectorParser;
+  using aperture::dom::DOMElement;
+  using aperture::test::MakeElement;
+
+  bool Matches(const char* szSelector, const DOMElement& element)
+  {
+    CSSSelector selector;
+    if (CSSSelectorParser::ParseSelector(szSelector, selector).Failed())
+      return false;
+    return selector.Matches(element);
+  }
+
+  constexpr const char* s_szTags[] = {"div", "span", "p", "a", "li", "ul", "img", "button"};
+
+  // Builds a tree of uiCount elements, 6 children per element, with a few classes from a pool of 200 per element.
+  std::shared_ptr<DOMElement> BuildStyledTree(nsUInt32 uiCount)
+  {
+    auto root = MakeElement("div", "app");
+    root->setAttribute("id", "root");
+    std::vector<std::shared_ptr<DOMElement>> open = {root};
+    nsUInt32 uiCreated = 1;
+    for (size_t i = 0; i < open.size() && uiCreated < uiCount; ++i)
+    {
+      for (nsUInt32 c = 0; c < 6 && uiCreated < uiCount; ++c, ++uiCreated)
+      {
+        nsStringBuilder sClass;
+        sClass.SetFormat("c{0} c{1}", uiCreated % 200, (uiCreated * 7) % 200);
+        nsStringBuilder sId;
+        sId.SetFormat("e{0}", uiCreated);
+
+        auto child = MakeElement(s_szTags[uiCreated % NS_ARRAY_SIZE(s_szTags)], sClass.GetData());
+        child->setAttribute("id", sId.GetData());
+        open[i]->appendChild(child);
+        open.push_back(child);
+      }
+    }
+    return root;
+  }
+
+  void CollectRecursive(const DOMElement& element, const CSSRuleMap& rules, CSSAncestorFilter* pFilter, nsDynamicArray<CSSMatchedRule>& matched, nsUInt64& inout_uiTotal)
+  {
+    matched.Clear();
+    rules.CollectMatchingRules(element, pFilter, matched);
+    inout_uiTotal += matched.GetCount();
+
+    if (pFilter != nullptr)
+      pFilter->PushElement(element);
+    for (const auto& child : element.getChildNodes())
+    {
+      if (child->getNodeType() == aperture::dom::DOMNodeType::ELEMENT_NODE)
+        CollectRecursive(static_cast<const DOMElement&>(*child), rules, pFilter, matched, inout_uiTotal);
+    }
+    if (pFilter != nullptr)
+      pFilter->PopElement();
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(CSS, CSSSelector)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Parsing")
+  {
+    nsDynamicArray<CSSSelector> selectors;
+    NS_TEST_BOOL(CSSSelectorParser::ParseSelectorList("div.a > #b + span ~ p, .c [data-x^=\"y\" i]::before", selectors).Succeeded());
+    NS_TEST_INT(selectors.GetCount(), 2);
+
+    // Stored right to left, the subject comes first.
+    NS_TEST_INT(selectors[0].GetCompoundCount(), 4);
+    NS_TEST_BOOL(selectors[0].GetCompound(0).m_Combinator == aperture::css::CSSCombinator::SubsequentSibling);
+    NS_TEST_BOOL(selectors[0].GetCompound(1).m_Combinator == aperture::css::CSSCombinator::NextSibling);
+    NS_TEST_BOOL(selectors[0].GetCompound(2).m_Combinator == aperture::css::CSSCombinator::Child);
+    NS_TEST_BOOL(selectors[0].GetKeyType() == aperture::css::CSSSelectorKeyType::Tag);
+    NS_TEST_INT(selectors[0].GetSpecificity(), CSSSelector::MakeSpecificity(1, 1, 3));
+
+    NS_TEST_BOOL(selectors[1].GetPseudoElement() == aperture::css::CSSPseudoElement::Before);
+    NS_TEST_BOOL(selectors[1].GetKeyType() == aperture::css::CSSSelectorKeyType::Universal);
+    NS_TEST_BOOL(selectors[1].GetAncestorHashes()[0] == CSSAncestorFilter::GetClassHash(aperture::core::MakeAtom("c")));
+
+    // One invalid selector invalidates the whole list.
+    NS_TEST_BOOL(CSSSelectorParser::ParseSelectorList("div, :unknown-pseudo", selectors).Failed());
+    NS_TEST_BOOL(CSSSelectorParser::ParseSelectorList("div >", selectors).Failed());
+    NS_TEST_BOOL(CSSSelectorParser::ParseSelectorList("::before div", selectors).Failed());
+    NS_TEST_INT(selectors.GetCount(), 2);
+
+    nsInt32 iA = 0;
+    nsInt32 iB = 0;
+    NS_TEST_BOOL(CSSSelectorParser::ParseNth(" -n + 3 ", iA, iB).Succeeded());
+    NS_TEST_INT(iA, -1);
+    NS_TEST_INT(iB, 3);
+    NS_TEST_BOOL(CSSSelectorParser::ParseNth("odd", iA, iB).Succeeded());
+    NS_TEST_INT(iA, 2);
+    NS_TEST_INT(iB, 1);
+    NS_TEST_BOOL(CSSSelectorParser::ParseNth("2n1", iA, iB).Failed());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Matching")
+  {
+    auto root = MakeElement("ul", "menu");
+    auto first = MakeElement("li", "item first");
+    auto second = MakeElement("li", "item");
+    auto third = MakeElement("li", "item");
+    root->setAttribute("id", "list");
+    second->setAttribute("id", "current");
+    auto link = MakeElement("a");
+    root->appendChild(first);
+    root->appendChild(second);
+    root->appendChild(third);
+    second->appendChild(link);
+    link->setAttribute("href", "https://example.com/index.html");
+    link->setAttribute("lang", "en-US");
+
+    NS_TEST_BOOL(Matches("li", *first));
+    NS_TEST_BOOL(Matches("*", *first));
+    NS_TEST_BOOL(Matches(".menu > .item.first", *first));
+    NS_TEST_BOOL(!Matches(".menu > .item.first", *second));
+    NS_TEST_BOOL(Matches("ul .item a", *link));
+    NS_TEST_BOOL(!Matches("ul > a", *link));
+    NS_TEST_BOOL(Matches(".first + #current", *second));
+    NS_TEST_BOOL(Matches(".first ~ li", *third));
+    NS_TEST_BOOL(!Matches(".first + li", *third));
+    NS_TEST_BOOL(Matches("li:nth-child(2n+1)", *third));
+    NS_TEST_BOOL(!Matches("li:nth-child(odd)", *second));
+    NS_TEST_BOOL(Matches("li:last-child", *third));
+    NS_TEST_BOOL(Matches("li:first-of-type", *first));
+    NS_TEST_BOOL(Matches("a:only-child", *link));
+    NS_TEST_BOOL(Matches("ul:root", *root));
+    NS_TEST_BOOL(Matches("li:empty", *first));
+    NS_TEST_BOOL(!Matches("li:empty", *second));
+    NS_TEST_BOOL(Matches("li:not(.first)", *second));
+    NS_TEST_BOOL(!Matches("li:not(.first)", *first));
+    NS_TEST_BOOL(Matches("[href^='https'][href$=\".html\"][href*=example]", *link));
+    NS_TEST_BOOL(Matches("[HREF^=HTTPS i]", *link));
+    NS_TEST_BOOL(Matches("a:lang(en)", *link));
+    NS_TEST_BOOL(Matches("[class~=first]", *first));
+
+    // Attribute names are case-insensitive on both sides.
+    link->setAttribute("Data-Kind", "external");
+    NS_TEST_BOOL(Matches("[data-kind=external]", *link));
+    NS_TEST_BOOL(Matches("[DATA-KIND]", *link));
+    NS_TEST_STRING(link->getAttribute("DATA-kind").c_str(), "external");
+    link->removeAttribute("DATA-KIND");
+    NS_TEST_BOOL(!Matches("[data-kind]", *link));
+
+    NS_TEST_BOOL(!Matches("li:hover", *second));
+    NS_TEST_BOOL(Matches("li:enabled", *second));
+    second->setStateFlags(aperture::dom::ElementState::Hover | aperture::dom::ElementState::Disabled, true);
+    NS_TEST_BOOL(Matches("li:hover", *second));
+    NS_TEST_BOOL(Matches("li:not(:enabled)", *second));
+
+    // Attribute changes update the cached atoms used by matching.
+    third->setAttribute("class", "item last");
+    NS_TEST_BOOL(Matches(".last", *third));
+    third->removeAttribute("class");
+    NS_TEST_BOOL(!Matches(".item", *third));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Rule Map")
+  {
+    auto root = MakeElement("div", "panel");
+    auto button = MakeElement("button", "primary large");
+    button->setAttribute("id", "ok");
+    root->appendChild(button);
+
+    nsDynamicArray<CSSSelector> selectors;
+    NS_TEST_BOOL(CSSSelectorParser::ParseSelectorList("#ok, .panel .primary, button, .missing button, *, .primary::after", selectors).Succeeded());
+
+    CSSRuleMap rules;
+    for (nsUInt32 i = 0; i < selectors.GetCount(); ++i)
+    {
+      rules.AddSelector(&selectors[i], i, i);
+    }
+    NS_TEST_INT(rules.GetRuleCount(), 6);
+
+    CSSAncestorFilter filter;
+    filter.PushElement(*root);
+    nsDynamicArray<CSSMatchedRule> matched;
+    rules.CollectMatchingRules(*button, &filter, matched);
+
+    // Sorted by specificity: "*", "button", ".panel .primary", "#ok".
+    NS_TEST_INT(matched.GetCount(), 4);
+    if (matched.GetCount() == 4)
+    {
+      NS_TEST_INT(matched[0].m_uiRuleIndex, 4);
+      NS_TEST_INT(matched[1].m_uiRuleIndex, 2);
+      NS_TEST_INT(matched[2].m_uiRuleIndex, 1);
+      NS_TEST_INT(matched[3].m_uiRuleIndex, 0);
+    }
+
+    matched.Clear();
+    rules.CollectMatchingRules(*button, &filter, matched, aperture::css::CSSPseudoElement::After);
+    NS_TEST_INT(matched.GetCount(), 1);
+
+    filter.PopElement();
+    NS_TEST_INT(filter.GetDepth(), 0);
+    NS_TEST_BOOL(!filter.MayContain(CSSAncestorFilter::GetClassHash(aperture::core::MakeAtom("panel"))));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark 10k elements x 5k rules")
+  {
+    auto root = BuildStyledTree(10000);
+
+    // A mix of rules as found in UI stylesheets: plain keys, compounds, descendant chains that mostly fail, and ids.
+    nsStringBuilder sRules;
+    for (nsUInt32 i = 0; i < 5000; ++i)
+    {
+      if (!sRules.IsEmpty())
+        sRules.Append(",");
+
+      switch (i % 5)
+      {
+        case 0:
+          sRules.AppendFormat(".c{0}", i % 200);
+          break;
+        case 1:
+          sRules.AppendFormat("{0}.c{1}:hover", s_szTags[i % NS_ARRAY_SIZE(s_szTags)], i % 200);
+          break;
+        case 2:
+          sRules.AppendFormat(".x{0} .c{1}", i, i % 200);
+          break;
+        case 3:
+          sRules.AppendFormat("#e{0}", i * 2);
+          break;
+        case 4:
+          sRules.AppendFormat(".app > {0} .c{1}", s_szTags[i % NS_ARRAY_SIZE(s_szTags)], i % 200);
+          break;
+      }
+    }
+
+    nsDynamicArray<CSSSelector> selectors;
+    NS_TEST_BOOL(CSSSelectorParser::ParseSelectorList(sRules.GetData(), selectors).Succeeded());
+    NS_TEST_INT(selectors.GetCount(), 5000);
+
+    CSSRuleMap rules;
+    for (nsUInt32 i = 0; i < selectors.GetCount(); ++i)
+    {
+      rules.AddSelector(&selectors[i], i, i);
+    }
+
+    nsDynamicArray<CSSMatchedRule> matched;
+    nsUInt64 uiMatchedWithoutFilter = 0;
+    nsStopwatch timer;
+    CollectRecursive(*root, rules, nullptr, matched, uiMatchedWithoutFilter);
+    const nsTime tWithoutFilter = timer.GetRunningTotal();
+
+    CSSAncestorFilter filter;
+    nsUInt64 uiMatchedWithFilter = 0;
+    timer.StopAndReset();
+    timer.Resume();
+    CollectRecursive(*root, rules, &filter, matched, uiMatchedWithFilter);
+    const nsTime tWithFilter = timer.GetRunningTotal();
+
+    // The bloom filter must never reject a rule that matches.
+    NS_TEST_INT(uiMatchedWithFilter, uiMatchedWithoutFilter);
+    nsLog::Info("Selector matching 10k elements x 5k rules: {0} ms with ancestor filter, {1} ms without ({2} matches)",
+      nsArgF(tWithFilter.GetMilliseconds(), 2), nsArgF(tWithoutFilter.GetMilliseconds(), 2), uiMatchedWithFilter);
+  }
+}
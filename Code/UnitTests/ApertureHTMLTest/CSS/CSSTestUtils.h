@@ -0,0 +1,12 @@
+#pragma once
+
+#include <ApertureHTMLTestUtils/DOMTestUtils.h>
+
+namespace aperture::test
+{
+  /// The element child at the index, for trees built from MakeElement().
+  inline dom::DOMElement& GetChild(const dom::DOMElement& element, nsUInt32 uiIndex)
+  {
+    return static_cast<dom::DOMElement&>(*element.getChildNodes()[uiIndex]);
+  }
+} // namespace aperture::test
@@ -0,0 +1,137 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/css/Parser/CSSTokenizer.h>
+#include <boost/parser/parser.hpp>
+
+namespace
+{
+  using aperture::css::parser::CSSToken;
+  using aperture::css::parser::CSSTokenizer;
+  using aperture::css::parser::CSSTokenType;
+
+  // Roughly 1 KB of typical UI stylesheet, repeated to build the benchmark input.
+  constexpr const char* s_szStyleSheetChunk =
+    "/* menu */\n"
+    ".menu-item > a:hover, #main .button.primary[data-state=\"active\"] {\n"
+    "  color: #ff8800; background: url(images/button_bg.png) no-repeat;\n"
+    "  margin: 0 auto 12px -4.5em; padding: 2px 4px; width: calc(100% - 24px);\n"
+    "  font-family: \"Noto Sans\", sans-serif; transition: opacity 0.25s ease-in-out;\n"
+    "}\n"
+    "@media (min-width: 1280px) { .hud .health-bar { height: 1.5e1px; opacity: .75; } }\n"
+    "div.inventory span:nth-child(2n+1) { transform: translate(-50%, 10px) rotate(45deg); }\n"
+    ".tooltip::after { content: 'x'; border: 1px solid rgba(0, 0, 0, 0.5); z-index: 1000; }\n"
+    "--custom-color: var(--accent, #123); .dialog { display: flex; flex-direction: column; }\n";
+
+  nsUInt32 CountTokensBoostParser(const std::string& sSource)
+  {
+    namespace bp = boost::parser;
+
+    nsUInt32 uiCount = 0;
+    auto const count = [&uiCount](auto&) { ++uiCount; };
+
+    auto const ws = +bp::char_(" \t\r\n\f");
+    auto const comment = bp::lit("/*") >> *(bp::char_ - bp::lit("*/")) >> bp::lit("*/");
+    auto const name_char = bp::char_('a', 'z') | bp::char_('A', 'Z') | bp::char_('0', '9') | bp::char_("-_");
+    auto const ident = -bp::char_('-') >> (bp::char_('a', 'z') | bp::char_('A', 'Z') | bp::char_("_-")) >> *name_char;
+    auto const number = -bp::char_("+-") >> (+bp::digit >> -(bp::char_('.') >> +bp::digit) | bp::char_('.') >> +bp::digit) >>
+                        -(bp::char_("eE") >> -bp::char_("+-") >> +bp::digit);
+    auto const numeric = number >> -(bp::char_('%') | ident);
+    auto const string = bp::char_('"') >> *(bp::char_ - bp::char_('"')) >> bp::char_('"') |
+                        bp::char_('\'') >> *(bp::char_ - bp::char_('\'')) >> bp::char_('\'');
+    auto const hash = bp::char_('#') >> +name_char;
+    auto const at = bp::char_('@') >> ident;
+    auto const function = ident >> bp::char_('(');
+    auto const token = bp::omit[comment] | bp::raw[ws][count] | bp::raw[string][count] | bp::raw[numeric][count] | bp::raw[function][count] |
+                       bp::raw[ident][count] | bp::raw[hash][count] | bp::raw[at][count] | bp::raw[bp::char_][count];
+
+    bp::parse(sSource, *token);
+    return uiCount;
+  }
+
+  nsUInt32 CountTokens(std::string_view sSource)
+  {
+    CSSTokenizer tokenizer(sSource);
+    nsUInt32 uiCount = 0;
+    while (tokenizer.Next().m_Type != CSSTokenType::EndOfFile)
+      ++uiCount;
+    return uiCount;
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST_GROUP(CSS);
+
+NS_CREATE_SIMPLE_TEST(CSS, CSSTokenizer)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Tokens")
+  {
+    const std::string_view sSource = "#id.cls>a:hover{width:calc(100% - 2.5em);background:url( a.png )}@media -->\"str\\\"ing\"";
+    nsDynamicArray<CSSToken> tokens;
+    CSSTokenizer::TokenizeAll(sSource, tokens, true);
+
+    const CSSTokenType expected[] = {CSSTokenType::Hash, CSSTokenType::Delim, CSSTokenType::Ident, CSSTokenType::Delim, CSSTokenType::Ident,
+      CSSTokenType::Colon, CSSTokenType::Ident, CSSTokenType::OpenCurly, CSSTokenType::Ident, CSSTokenType::Colon, CSSTokenType::Function,
+      CSSTokenType::Percentage, CSSTokenType::Delim, CSSTokenType::Dimension, CSSTokenType::CloseParen, CSSTokenType::Semicolon,
+      CSSTokenType::Ident, CSSTokenType::Colon, CSSTokenType::Url, CSSTokenType::CloseCurly, CSSTokenType::AtKeyword, CSSTokenType::CDC,
+      CSSTokenType::String};
+
+    NS_TEST_INT(tokens.GetCount(), NS_ARRAY_SIZE(expected));
+    for (nsUInt32 i = 0; i < nsMath::Min<nsUInt32>(tokens.GetCount(), NS_ARRAY_SIZE(expected)); ++i)
+    {
+      NS_TEST_INT(static_cast<int>(tokens[i].m_Type), static_cast<int>(expected[i]));
+    }
+
+    NS_TEST_BOOL(tokens[0].m_Value == "id" && tokens[0].HasFlag(CSSToken::HashIsId));
+    NS_TEST_BOOL(tokens[10].m_Value == "calc");
+    NS_TEST_DOUBLE(tokens[11].m_fNumber, 100.0, 0.0);
+    NS_TEST_DOUBLE(tokens[13].m_fNumber, 2.5, 0.0);
+    NS_TEST_BOOL(tokens[13].m_Unit == "em" && !tokens[13].HasFlag(CSSToken::IsInteger));
+    NS_TEST_BOOL(tokens[18].m_Value == "a.png");
+    NS_TEST_BOOL(tokens[20].m_Value == "media");
+
+    // Tokens are views into the source, nothing was copied.
+    NS_TEST_BOOL(tokens[2].m_Value.data() == sSource.data() + 4);
+
+    nsStringBuilder sUnescaped;
+    NS_TEST_BOOL(tokens[22].HasFlag(CSSToken::HasEscapes));
+    CSSTokenizer::Unescape(tokens[22].m_Value, sUnescaped);
+    NS_TEST_STRING(sUnescaped, "str\"ing");
+
+    CSSTokenizer::Unescape("\\31 23\\e9", sUnescaped);
+    NS_TEST_STRING(sUnescaped, "123\xC3\xA9");
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Error Recovery")
+  {
+    nsDynamicArray<CSSToken> tokens;
+    CSSTokenizer::TokenizeAll("'unterminated\nurl(a b) /* open comment", tokens);
+    NS_TEST_INT(static_cast<int>(tokens[0].m_Type), static_cast<int>(CSSTokenType::BadString));
+    NS_TEST_INT(static_cast<int>(tokens[1].m_Type), static_cast<int>(CSSTokenType::Whitespace));
+    NS_TEST_INT(static_cast<int>(tokens[2].m_Type), static_cast<int>(CSSTokenType::BadUrl));
+    NS_TEST_INT(static_cast<int>(tokens.PeekBack().m_Type), static_cast<int>(CSSTokenType::Whitespace));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark vs Boost.Parser")
+  {
+    std::string sStyleSheet;
+    while (sStyleSheet.size() < 1024 * 1024)
+    {
+      sStyleSheet += s_szStyleSheetChunk;
+    }
+
+    nsStopwatch timer;
+    const nsUInt32 uiTokens = CountTokens(sStyleSheet);
+    const nsTime tTokenizer = timer.GetRunningTotal();
+
+    timer.StopAndReset();
+    timer.Resume();
+    const nsUInt32 uiBoostTokens = CountTokensBoostParser(sStyleSheet);
+    const nsTime tBoost = timer.GetRunningTotal();
+
+    NS_TEST_BOOL(uiTokens > 0 && uiBoostTokens > 0);
+    nsLog::Info("Tokenizing {0} KB: CSSTokenizer {1} ms ({2} tokens), Boost.Parser {3} ms ({4} tokens)", sStyleSheet.size() / 1024,
+      nsArgF(tTokenizer.GetMilliseconds(), 2), uiTokens, nsArgF(tBoost.GetMilliseconds(), 2), uiBoostTokens);
+  }
+}
@@ -0,0 +1,232 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <APHTML/dom/events/DOMEvent.h>
+#include <APHTML/dom/events/DOMEventQueue.h>
+
+#include <string>
+
+namespace
+{
+  using aperture::EventId;
+  using aperture::dom::DOMEvent;
+  using aperture::dom::DOMEventQueue;
+  using aperture::dom::DOMEventTarget;
+
+  // Appends the name and the phase of every invocation, e.g. "root:capture ".
+  DOMEventTarget::EventListener Record(std::string& inout_log, const char* szName)
+  {
+    return [&inout_log, szName](DOMEvent& event) {
+      static const char* s_szPhases[] = {"none", "capture", "target", "bubble"};
+      inout_log += szName;
+      inout_log += ':';
+      inout_log += s_szPhases[static_cast<int>(event.eventPhase())];
+      inout_log += ' ';
+    };
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(DOM, DOMEvent)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Capture, target and bubble order")
+  {
+    DOMEventTarget root, middle, leaf;
+    middle.setParent(&root);
+    leaf.setParent(&middle);
+
+    std::string log;
+    root.addEventListener(EventId::Click, Record(log, "root"));
+    root.addEventListener(EventId::Click, Record(log, "root"), true);
+    middle.addEventListener(EventId::Click, Record(log, "middle"), true);
+    middle.addEventListener(EventId::Click, Record(log, "middle"));
+    leaf.addEventListener(EventId::Click, Record(log, "leaf"));
+    leaf.addEventListener(EventId::Click, Record(log, "leaf-capture"), true);
+
+    DOMEvent click(EventId::Click, true, true);
+    NS_TEST_BOOL(leaf.dispatchEvent(click));
+    NS_TEST_STRING(log.c_str(), "root:capture middle:capture leaf-capture:target leaf:target middle:bubble root:bubble ");
+    NS_TEST_BOOL(click.eventPhase() == DOMEvent::Phase::NONE);
+    NS_TEST_BOOL(click.target() == &leaf);
+
+    // Without bubbling only the capture and target phases run.
+    log.clear();
+    DOMEvent focus(EventId::Click, false);
+    leaf.dispatchEvent(focus);
+    NS_TEST_STRING(log.c_str(), "root:capture middle:capture leaf-capture:target leaf:target ");
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Stopping, once and cancelling")
+  {
+    DOMEventTarget root, leaf;
+    leaf.setParent(&root);
+
+    std::string log;
+    root.addEventListener(EventId::Click, Record(log, "root"));
+    leaf.addEventListener(EventId::Click, [](DOMEvent& event) { event.stopPropagation(); });
+    leaf.addEventListener(EventId::Click, Record(log, "leaf"));
+
+    // stopPropagation() still runs the other listeners of the current target.
+    DOMEvent click(EventId::Click, true, true);
+    leaf.dispatchEvent(click);
+    NS_TEST_STRING(log.c_str(), "leaf:target ");
+
+    DOMEventTarget target;
+    target.addEventListener(EventId::Keydown, [](DOMEvent& event) {
+      event.preventDefault();
+      event.stopImmediatePropagation();
+    });
+    target.addEventListener(EventId::Keydown, Record(log, "after-stop"));
+    target.addEventListener(EventId::Keyup, Record(log, "once"), false, true);
+
+    log.clear();
+    DOMEvent keydown(EventId::Keydown, false, true);
+    NS_TEST_BOOL(!target.dispatchEvent(keydown));
+    NS_TEST_BOOL(log.empty());
+
+    DOMEvent keyup(EventId::Keyup);
+    target.dispatchEvent(keyup);
+    target.dispatchEvent(keyup);
+    NS_TEST_STRING(log.c_str(), "once:target ");
+    NS_TEST_BOOL(!target.hasEventListener(EventId::Keyup));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Listeners changed during dispatch")
+  {
+    DOMEventTarget target;
+    std::string log;
+
+    DOMEventTarget::ListenerHandle hSecond = 0;
+    target.addEventListener(EventId::Click, [&](DOMEvent&) {
+      log += "first ";
+      target.removeEventListener(hSecond);
+      target.addEventListener(EventId::Click, Record(log, "added"));
+    });
+    hSecond = target.addEventListener(EventId::Click, Record(log, "second"));
+
+    DOMEvent click(EventId::Click);
+    target.dispatchEvent(click);
+    NS_TEST_STRING(log.c_str(), "first ");
+
+    log.clear();
+    target.dispatchEvent(click);
+    NS_TEST_STRING(log.c_str(), "first added:target ");
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Targets destroyed during dispatch")
+  {
+    std::string log;
+    DOMEventTarget root;
+    auto pParent = std::make_unique<DOMEventTarget>();
+    auto pChild = std::make_unique<DOMEventTarget>();
+    pParent->setParent(&root);
+    pChild->setParent(pParent.get());
+
+    root.addEventListener(EventId::Click, Record(log, "root"));
+    pParent->addEventListener(EventId::Click, Record(log, "parent"));
+    pChild->addEventListener(EventId::Click, [&](DOMEvent&) {
+      log += "child ";
+      pParent.reset();
+    });
+
+    // The destroyed ancestor is skipped, the rest of the path still sees the event.
+    DOMEvent click(EventId::Click, true);
+    pChild->dispatchEvent(click);
+    NS_TEST_STRING(log.c_str(), "child root:bubble ");
+
+    // A target destroying itself ends its own listeners.
+    log.clear();
+    pChild->setParent(&root);
+    pChild->addEventListener(EventId::Focus, [&](DOMEvent&) {
+      log += "child ";
+      pChild.reset();
+    });
+    pChild->addEventListener(EventId::Focus, Record(log, "late"));
+    root.addEventListener(EventId::Focus, Record(log, "root"), true);
+
+    DOMEvent focus(EventId::Focus, true);
+    pChild->dispatchEvent(focus);
+    NS_TEST_STRING(log.c_str(), "root:capture child ");
+    NS_TEST_BOOL(root.getFirstChild() == nullptr);
+
+    // The same goes for targets of a subtree dispatch.
+    log.clear();
+    auto pFirst = std::make_unique<DOMEventTarget>();
+    auto pSecond = std::make_unique<DOMEventTarget>();
+    pFirst->setParent(&root);
+    pSecond->setParent(&root);
+    pFirst->addEventListener(EventId::Show, [&](DOMEvent&) {
+      log += "first ";
+      pSecond.reset();
+    });
+    pSecond->addEventListener(EventId::Show, Record(log, "second"));
+
+    DOMEvent show(EventId::Show);
+    NS_TEST_INT(root.dispatchEventToSubtree(show), 3);
+    NS_TEST_STRING(log.c_str(), "first ");
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Subtrees without listeners are skipped")
+  {
+    // A root with 4 branches of 16 leaves each, one leaf listens.
+    DOMEventTarget root;
+    DOMEventTarget branches[4];
+    DOMEventTarget leaves[4][16];
+    for (nsUInt32 b = 0; b < 4; ++b)
+    {
+      branches[b].setParent(&root);
+      for (nsUInt32 l = 0; l < 16; ++l)
+        leaves[b][l].setParent(&branches[b]);
+    }
+    NS_TEST_BOOL(root.getFirstChild() == &branches[0]);
+    NS_TEST_BOOL(branches[0].getNextSibling() == &branches[1]);
+
+    std::string log;
+    const DOMEventTarget::ListenerHandle hListener = leaves[2][5].addEventListener(EventId::Resize, Record(log, "leaf"));
+    branches[3].addEventListener(EventId::Resize, Record(log, "branch"));
+    NS_TEST_BOOL(root.hasEventListenerInSubtree(EventId::Resize));
+    NS_TEST_BOOL(!branches[0].hasEventListenerInSubtree(EventId::Resize));
+    NS_TEST_BOOL(!root.hasEventListenerInSubtree(EventId::Scroll));
+
+    // Only the root, the two branches and the leaf are visited, in tree order.
+    DOMEvent resize(EventId::Resize);
+    NS_TEST_INT(root.dispatchEventToSubtree(resize), 4);
+    NS_TEST_STRING(log.c_str(), "leaf:target branch:target ");
+
+    // Removing the listener clears the bits up to the root.
+    leaves[2][5].removeEventListener(hListener);
+    NS_TEST_BOOL(!branches[2].hasEventListenerInSubtree(EventId::Resize));
+    NS_TEST_INT(root.dispatchEventToSubtree(resize), 2);
+
+    // Moving a target moves its bits.
+    branches[3].setParent(&branches[0]);
+    NS_TEST_BOOL(branches[0].hasEventListenerInSubtree(EventId::Resize));
+    branches[3].setParent(nullptr);
+    NS_TEST_BOOL(!root.hasEventListenerInSubtree(EventId::Resize));
+    NS_TEST_INT(root.dispatchEventToSubtree(resize), 0);
+
+    DOMEvent scroll(EventId::Scroll);
+    NS_TEST_INT(root.dispatchEventToSubtree(scroll), 0);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Queued dispatch")
+  {
+    DOMEventQueue queue;
+    std::string log;
+    {
+      DOMEventTarget first, second;
+      first.addEventListener(EventId::Click, Record(log, "first"));
+      second.addEventListener(EventId::Click, Record(log, "second"));
+
+      queue.Enqueue(&second, std::make_shared<DOMEvent>(EventId::Click));
+      queue.Enqueue(&first, std::make_shared<DOMEvent>(EventId::Click));
+      NS_TEST_INT(queue.GetQueuedCount(), 2);
+      NS_TEST_BOOL(log.empty());
+
+      NS_TEST_INT(queue.Flush(), 2);
+      NS_TEST_STRING(log.c_str(), "second:target first:target ");
+
+      queue.Enqueue(&first, std::make_shared<DOMEvent>(EventId::Click));
+      queue.CancelEventsForTarget(&first);
+    }
+    NS_TEST_INT(queue.GetQueuedCount(), 0);
+  }
+}
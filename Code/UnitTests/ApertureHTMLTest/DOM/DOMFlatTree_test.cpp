@@ -0,0 +1,110 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/dom/DOMFlatTree.h>
+
+namespace
+{
+  // Builds a tree with the given fan-out until uiNodeCount elements exist, breadth first.
+  std::shared_ptr<aperture::dom::DOMElement> BuildTestTree(nsUInt32 uiNodeCount, nsUInt32 uiFanOut)
+  {
+    auto root = std::make_shared<aperture::dom::DOMElement>("div");
+    std::vector<std::shared_ptr<aperture::dom::DOMElement>> open = {root};
+    nsUInt32 uiCreated = 1;
+    for (size_t i = 0; i < open.size() && uiCreated < uiNodeCount; ++i)
+    {
+      for (nsUInt32 c = 0; c < uiFanOut && uiCreated < uiNodeCount; ++c, ++uiCreated)
+      {
+        auto child = std::make_shared<aperture::dom::DOMElement>((c & 1) ? "span" : "div");
+        open[i]->appendChild(child);
+        open.push_back(child);
+      }
+    }
+    return root;
+  }
+
+  nsUInt32 CountElementsRecursive(const aperture::dom::DOMNode& node)
+  {
+    nsUInt32 uiCount = node.getNodeType() == aperture::dom::DOMNodeType::ELEMENT_NODE ? 1 : 0;
+    for (const auto& child : node.getChildNodes())
+    {
+      uiCount += CountElementsRecursive(*child);
+    }
+    return uiCount;
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST_GROUP(DOM);
+
+NS_CREATE_SIMPLE_TEST(DOM, DOMFlatTree)
+{
+  using aperture::dom::DOMFlatTree;
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Structure")
+  {
+    auto root = BuildTestTree(10, 3);
+    DOMFlatTree tree;
+    tree.Build({root});
+
+    NS_TEST_INT(tree.GetNodeCount(), 10);
+    NS_TEST_INT(tree.GetParent(0), DOMFlatTree::InvalidIndex);
+    NS_TEST_INT(tree.GetSubtreeEnd(0), 10);
+    NS_TEST_BOOL(tree.GetNode(0) == root.get());
+    NS_TEST_INT(tree.FindIndex(root.get()), 0);
+
+    // Pre-order: the first child directly follows its parent, siblings are linked in DOM order.
+    NS_TEST_INT(tree.GetFirstChild(0), 1);
+    nsUInt32 uiChildren = 0;
+    for (DOMFlatTree::NodeIndex i = tree.GetFirstChild(0); i != DOMFlatTree::InvalidIndex; i = tree.GetNextSibling(i))
+    {
+      NS_TEST_INT(tree.GetParent(i), 0);
+      NS_TEST_INT(tree.GetDepth(i), 1);
+      NS_TEST_BOOL(tree.GetNode(i) == root->getChildNodes()[uiChildren].get());
+      ++uiChildren;
+    }
+    NS_TEST_INT(uiChildren, 3);
+
+    const DOMFlatTree::NodeIndex uiFirstChild = tree.GetFirstChild(0);
+    tree.MarkStyleDirty(tree.GetSubtreeEnd(uiFirstChild) - 1);
+    NS_TEST_BOOL(tree.HasFlags(0, DOMFlatTree::Flags::DescendantStyleDirty));
+    NS_TEST_BOOL(tree.HasFlags(uiFirstChild, DOMFlatTree::Flags::DescendantStyleDirty));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Traversal Benchmark")
+  {
+    constexpr nsUInt32 uiNodeCount = 100000;
+    constexpr nsUInt32 uiIterations = 20;
+
+    auto root = BuildTestTree(uiNodeCount, 8);
+    DOMFlatTree tree;
+    tree.Build({root});
+    NS_TEST_INT(tree.GetNodeCount(), uiNodeCount);
+
+    nsStopwatch timer;
+    nsUInt32 uiPointerCount = 0;
+    for (nsUInt32 i = 0; i < uiIterations; ++i)
+    {
+      uiPointerCount += CountElementsRecursive(*root);
+    }
+    const nsTime tPointerTree = timer.GetRunningTotal();
+
+    timer.StopAndReset();
+    timer.Resume();
+    nsUInt32 uiFlatCount = 0;
+    for (nsUInt32 i = 0; i < uiIterations; ++i)
+    {
+      for (nsUInt8 uiType : tree.GetNodeTypes())
+      {
+        uiFlatCount += uiType == static_cast<nsUInt8>(aperture::dom::DOMNodeType::ELEMENT_NODE) ? 1 : 0;
+      }
+    }
+    const nsTime tFlatTree = timer.GetRunningTotal();
+
+    NS_TEST_INT(uiPointerCount, uiFlatCount);
+    nsLog::Info("DOM traversal of {0} nodes x{1}: shared_ptr tree {2} ms, flat tree {3} ms", uiNodeCount, uiIterations,
+      nsArgF(tPointerTree.GetMilliseconds(), 2), nsArgF(tFlatTree.GetMilliseconds(), 2));
+  }
+}
@@ -0,0 +1,211 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <APHTML/dom/events/DOMEventQueue.h>
+#include <APHTML/dom/events/DOMInputQueue.h>
+
+#include <string>
+
+namespace
+{
+  using aperture::EventId;
+  using aperture::dom::DOMEvent;
+  using aperture::dom::DOMEventQueue;
+  using aperture::dom::DOMEventTarget;
+  using aperture::dom::DOMInputQueue;
+  using aperture::dom::DOMInputSample;
+  using aperture::dom::DOMMouseEvent;
+
+  DOMInputSample MakeSample(EventId id, float x, float y)
+  {
+    DOMInputSample sample;
+    sample.m_id = id;
+    sample.m_vPosition.Set(x, y);
+    sample.m_vDelta.Set(1.0f, 0.0f);
+    return sample;
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(DOM, DOMInputQueue)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Samples are coalesced per frame")
+  {
+    DOMEventTarget target;
+    nsUInt32 uiMoves = 0;
+    nsUInt32 uiSamples = 0;
+    float fDeltaX = 0.0f;
+    float fClientX = 0.0f;
+    target.addEventListener(EventId::Mousemove, [&](DOMEvent& event) {
+      const DOMMouseEvent& move = static_cast<const DOMMouseEvent&>(event);
+      ++uiMoves;
+      uiSamples += move.getCoalescedEvents().GetCount();
+      fDeltaX = move.deltaX();
+      fClientX = move.clientX();
+    });
+
+    DOMInputQueue input;
+    for (nsUInt32 i = 0; i < 1000; ++i)
+      input.PushSample(&target, MakeSample(EventId::Mousemove, static_cast<float>(i), 0.0f));
+    NS_TEST_INT(input.GetPendingSampleCount(), 1000);
+
+    DOMEventQueue queue;
+    NS_TEST_INT(input.Flush(queue), 1);
+    NS_TEST_INT(input.GetPendingSampleCount(), 0);
+    queue.Flush();
+
+    NS_TEST_INT(uiMoves, 1);
+    NS_TEST_INT(uiSamples, 1000);
+    NS_TEST_FLOAT(fDeltaX, 1000.0f, 0.0f);
+    NS_TEST_FLOAT(fClientX, 999.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Discrete events keep their order")
+  {
+    DOMEventTarget target;
+    std::string log;
+    target.addEventListener(EventId::Mousemove, [&](DOMEvent& event) { log += "move "; });
+    target.addEventListener(EventId::MouseDown, [&](DOMEvent& event) { log += "down "; });
+
+    DOMInputQueue input;
+    input.PushSample(&target, MakeSample(EventId::Mousemove, 1.0f, 1.0f));
+    input.PushSample(&target, MakeSample(EventId::Mousemove, 2.0f, 1.0f));
+    input.PushSample(&target, MakeSample(EventId::MouseDown, 2.0f, 1.0f));
+    input.PushSample(&target, MakeSample(EventId::Mousemove, 3.0f, 1.0f));
+
+    DOMEventQueue queue;
+    NS_TEST_INT(input.Flush(queue), 3);
+    queue.Flush();
+    NS_TEST_STRING(log.c_str(), "move down move ");
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "A frame reaches the dispatcher in one call")
+  {
+    DOMEventTarget root, first, second, silent;
+    first.setParent(&root);
+    second.setParent(&root);
+    silent.addEventListener(EventId::Click, [](DOMEvent&) {});
+
+    nsUInt32 uiDispatched = 0;
+    root.addEventListener(EventId::Mousemove, [&](DOMEvent&) { ++uiDispatched; });
+    // Scroll doesn't bubble, it is only seen on its target.
+    second.addEventListener(EventId::Scroll, [&](DOMEvent&) { ++uiDispatched; });
+
+    DOMInputQueue input;
+    input.PushSample(&first, MakeSample(EventId::Mousemove, 0.0f, 0.0f));
+    input.PushSample(&second, MakeSample(EventId::Mousemove, 0.0f, 0.0f));
+    input.PushSample(&second, MakeSample(EventId::Scroll, 0.0f, 0.0f));
+    // Nobody listens for moves on this path, it is dropped before queueing.
+    input.PushSample(&silent, MakeSample(EventId::Mousemove, 0.0f, 0.0f));
+
+    nsUInt32 uiCalls = 0;
+    nsUInt32 uiBatchSize = 0;
+    DOMEventQueue queue;
+    queue.SetBatchDispatcher([&](nsArrayPtr<DOMEventQueue::BatchedEvent> batch) {
+      ++uiCalls;
+      uiBatchSize += batch.GetCount();
+      DOMEventQueue::DispatchBatch(batch);
+    });
+
+    NS_TEST_INT(input.Flush(queue), 3);
+    NS_TEST_INT(queue.GetQueuedCount(), 1);
+    NS_TEST_INT(queue.Flush(), 1);
+    NS_TEST_INT(uiCalls, 1);
+    NS_TEST_INT(uiBatchSize, 3);
+    NS_TEST_INT(uiDispatched, 3);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Event types")
+  {
+    DOMEventTarget root, target;
+    target.setParent(&root);
+
+    std::string log;
+    root.addEventListener(EventId::Scroll, [&](DOMEvent&) { log += "root-scroll "; });
+    root.addEventListener(EventId::Keydown, [&](DOMEvent&) { log += "root-key "; });
+    target.addEventListener(EventId::Scroll, [&](DOMEvent& event) {
+      log += "scroll ";
+      NS_TEST_BOOL(!event.bubbles() && !event.cancelable());
+      NS_TEST_BOOL(dynamic_cast<DOMMouseEvent*>(&event) == nullptr);
+    });
+    target.addEventListener(EventId::Keydown, [&](DOMEvent& event) {
+      log += "key ";
+      NS_TEST_BOOL(event.bubbles() && event.cancelable());
+      NS_TEST_BOOL(dynamic_cast<DOMMouseEvent*>(&event) == nullptr);
+    });
+    target.addEventListener(EventId::MouseScroll, [&](DOMEvent& event) {
+      log += "wheel ";
+      const DOMMouseEvent* pWheel = dynamic_cast<DOMMouseEvent*>(&event);
+      NS_TEST_BOOL(pWheel != nullptr && pWheel->getCoalescedEvents().GetCount() == 2);
+    });
+
+    DOMInputQueue input;
+    input.PushSample(&target, MakeSample(EventId::Scroll, 0.0f, 0.0f));
+    input.PushSample(&target, MakeSample(EventId::Scroll, 0.0f, 0.0f));
+    input.PushSample(&target, MakeSample(EventId::MouseScroll, 0.0f, 0.0f));
+    input.PushSample(&target, MakeSample(EventId::MouseScroll, 0.0f, 0.0f));
+    input.PushSample(&target, MakeSample(EventId::Keydown, 0.0f, 0.0f));
+
+    DOMEventQueue queue;
+    NS_TEST_INT(input.Flush(queue), 3);
+    queue.Flush();
+    NS_TEST_STRING(log.c_str(), "scroll wheel key root-key ");
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Cancelled targets are skipped")
+  {
+    nsUInt32 uiDispatched = 0;
+    DOMEventTarget kept;
+    kept.addEventListener(EventId::Mousemove, [&](DOMEvent&) { ++uiDispatched; });
+
+    DOMInputQueue input;
+    DOMEventQueue queue;
+    {
+      DOMEventTarget destroyed;
+      destroyed.addEventListener(EventId::Mousemove, [&](DOMEvent&) { ++uiDispatched; });
+      input.PushSample(&destroyed, MakeSample(EventId::Mousemove, 0.0f, 0.0f));
+      input.PushSample(&kept, MakeSample(EventId::Mousemove, 0.0f, 0.0f));
+      input.Flush(queue);
+
+      // The global queues cancel automatically, these are local ones.
+      queue.CancelEventsForTarget(&destroyed);
+    }
+
+    queue.Flush();
+    NS_TEST_INT(uiDispatched, 1);
+
+    // A batch that loses all of its events is dropped.
+    {
+      DOMEventTarget destroyed;
+      destroyed.addEventListener(EventId::Mousemove, [&](DOMEvent&) { ++uiDispatched; });
+      input.PushSample(&destroyed, MakeSample(EventId::Mousemove, 0.0f, 0.0f));
+      input.Flush(queue);
+      queue.CancelEventsForTarget(&destroyed);
+    }
+    NS_TEST_INT(queue.GetQueuedCount(), 0);
+
+    // Cancelling while the batch runs only flags the entry, the dispatcher skips it.
+    DOMEventTarget later;
+    later.addEventListener(EventId::Mousemove, [&](DOMEvent&) { ++uiDispatched; });
+    kept.addEventListener(EventId::Click, [&](DOMEvent&) { queue.CancelEventsForTarget(&later); });
+
+    nsUInt32 uiCancelled = 0;
+    queue.SetBatchDispatcher([&](nsArrayPtr<DOMEventQueue::BatchedEvent> batch) {
+      DOMEventQueue::DispatchBatch(batch);
+      for (const DOMEventQueue::BatchedEvent& batched : batch)
+      {
+        if (batched.m_bCancelled)
+        {
+          ++uiCancelled;
+          NS_TEST_BOOL(batched.m_pTarget == &later);
+        }
+      }
+    });
+
+    uiDispatched = 0;
+    input.PushSample(&kept, MakeSample(EventId::Click, 0.0f, 0.0f));
+    input.PushSample(&later, MakeSample(EventId::Mousemove, 0.0f, 0.0f));
+    input.Flush(queue);
+    queue.Flush();
+    NS_TEST_INT(uiDispatched, 0);
+    NS_TEST_INT(uiCancelled, 1);
+  }
+}
@@ -0,0 +1,130 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/IO/OSFile.h>
+
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/dom/DOMManager.h>
+#include <APHTML/dom/DOMSnapshot.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+
+#include <ApertureHTMLTest/Layout/LayoutTestUtils.h>
+
+namespace
+{
+  using aperture::PropertyId;
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMManager;
+  using aperture::dom::DOMSnapshot;
+  using aperture::layout::LayoutTree;
+  using aperture::test::GetChild;
+  using aperture::test::HasSameLayout;
+  using aperture::test::LayoutTestSetup;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+
+  constexpr const char* s_szManagerSheet = R"(
+    .app { width: 300px; padding: 10px; }
+    .item { height: 20px; margin-top: 4px; padding-left: 5px; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(DOM, DOMManager)
+{
+  LayoutTestSetup setup(s_szManagerSheet);
+
+  auto app = MakeElement("div", "app");
+  for (nsUInt32 i = 0; i < 3; ++i)
+  {
+    auto item = MakeElement("div", "item");
+    item->appendChild(MakeText("Item"));
+    app->appendChild(item);
+  }
+  setup.m_Resolver.ResolveStyles(*app);
+
+  LayoutTree tree;
+  tree.SetTextMeasureCache(&setup.m_TextCache);
+  tree.Build(*app);
+  tree.Calculate(400.0f);
+
+  nsDynamicArray<nsRectFloat> boxes;
+  tree.GetNodeBoxes(boxes);
+  NS_TEST_INT(boxes.GetCount(), 7);
+
+  nsStringBuilder sPath = nsTestFramework::GetInstance()->GetAbsOutputPath();
+  sPath.AppendPath("DOMManagerSnapshot.apds");
+  {
+    nsContiguousMemoryStreamStorage storage;
+    nsMemoryStreamWriter writer(&storage);
+    NS_TEST_BOOL(DOMSnapshot::Write(writer, {app}, boxes).Succeeded());
+
+    nsOSFile file;
+    NS_TEST_BOOL(file.Open(sPath, nsFileOpenMode::Write).Succeeded());
+    NS_TEST_BOOL(file.Write(storage.GetData(), storage.GetStorageSize64()).Succeeded());
+    file.Close();
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Styles and layout are restored")
+  {
+    DOMManager manager;
+    LayoutTree restored;
+    restored.SetTextMeasureCache(&setup.m_TextCache);
+    NS_TEST_BOOL(manager.RestoreDOMCollection(sPath, restored, 400.0f, YGUndefined).Succeeded());
+
+    const auto& roots = manager.GetDOMCollection().getRootElements();
+    NS_TEST_BOOL(!roots.empty());
+
+    // The styles are shared through the cache of the manager.
+    const DOMElement& root = roots.empty() ? *app : *roots[0];
+    NS_TEST_BOOL(root.getComputedStyle() != nullptr);
+    NS_TEST_BOOL(root.getComputedStyle()->HasSameValue(PropertyId::Width, *app->getComputedStyle()));
+    NS_TEST_BOOL(GetChild(root, 0).getComputedStyle() == GetChild(root, 2).getComputedStyle());
+    NS_TEST_INT(manager.GetStyleCache().GetStyleCount(), 2);
+
+    // The stored boxes are taken over, the next pass has nothing to do.
+    NS_TEST_INT(restored.GetStats().m_uiRestoredLayouts, 1);
+    NS_TEST_BOOL(HasSameLayout(restored, tree));
+    NS_TEST_BOOL(restored.GetInlineText(restored.FindBox(&GetChild(root, 1))) == "Item");
+
+    restored.Calculate(400.0f);
+    NS_TEST_INT(restored.GetStats().m_uiPasses, 0);
+    NS_TEST_INT(restored.GetStats().m_uiSkippedPasses, 1);
+
+    // Another size lays it out as usual.
+    restored.Calculate(200.0f);
+    tree.Calculate(200.0f);
+    NS_TEST_INT(restored.GetStats().m_uiPasses, 1);
+    NS_TEST_BOOL(HasSameLayout(restored, tree));
+    tree.Calculate(400.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Boxes that don't match the tree are not restored")
+  {
+    auto other = MakeElement("div", "app");
+    other->appendChild(MakeElement("div", "item"));
+    setup.m_Resolver.ResolveStyles(*other);
+
+    LayoutTree otherTree;
+    otherTree.SetTextMeasureCache(&setup.m_TextCache);
+    otherTree.Build(*other);
+    NS_TEST_BOOL(otherTree.RestoreLayout(boxes, 400.0f).Failed());
+    NS_TEST_INT(otherTree.GetStats().m_uiRestoredLayouts, 0);
+
+    otherTree.Calculate(400.0f);
+    NS_TEST_INT(otherTree.GetStats().m_uiPasses, 1);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Without a layout tree")
+  {
+    DOMManager manager;
+    NS_TEST_BOOL(manager.RestoreDOMCollection(sPath).Succeeded());
+    const auto& roots = manager.GetDOMCollection().getRootElements();
+    NS_TEST_BOOL(!roots.empty() && roots[0]->getComputedStyle() != nullptr);
+
+    nsStringBuilder sMissing = sPath;
+    sMissing.ChangeFileName("Missing");
+    NS_TEST_BOOL(manager.RestoreDOMCollection(sMissing).Failed());
+  }
+
+  nsOSFile::DeleteFile(sPath).IgnoreResult();
+}
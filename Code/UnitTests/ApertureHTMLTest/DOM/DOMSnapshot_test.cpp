@@ -0,0 +1,231 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/IO/MemoryStream.h>
+
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/dom/DOMSnapshot.h>
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+namespace
+{
+  using aperture::PropertyId;
+  using aperture::css::ComputedStyle;
+  using aperture::css::CSSStyleSheet;
+  using aperture::css::StyleCache;
+  using aperture::css::StyleResolver;
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMNode;
+  using aperture::dom::DOMNodeType;
+  using aperture::dom::DOMSnapshot;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+
+  std::shared_ptr<DOMElement> BuildDocument()
+  {
+    auto app = MakeElement("div", "app");
+    auto title = MakeElement("h1");
+    title->setAttribute("id", "title");
+    title->appendChild(MakeText("Inventory"));
+    app->appendChild(title);
+
+    for (nsUInt32 i = 0; i < 8; ++i)
+    {
+      auto item = MakeElement("div", i % 2 == 0 ? "item" : "item odd");
+      item->setAttribute("data-slot", std::to_string(i));
+      item->appendChild(MakeText("Item"));
+      app->appendChild(item);
+    }
+    return app;
+  }
+
+  bool IsSameStyle(const ComputedStyle& a, const ComputedStyle& b)
+  {
+    for (nsUInt32 i = 1; i < ComputedStyle::PropertyCount; ++i)
+    {
+      const PropertyId id = static_cast<PropertyId>(i);
+      if (!a.HasSameValue(id, b) || a.IsExplicitlySet(id) != b.IsExplicitlySet(id))
+        return false;
+    }
+
+    const bool bHasProperties = a.GetCustomProperties() != nullptr;
+    if (bHasProperties != (b.GetCustomProperties() != nullptr))
+      return false;
+    return !bHasProperties || a.GetCustomProperties()->IsEqual(*b.GetCustomProperties());
+  }
+
+  bool IsSameTree(const DOMNode& a, const DOMNode& b)
+  {
+    if (a.getNodeType() != b.getNodeType() || a.getNodeName() != b.getNodeName() || a.getNodeValue() != b.getNodeValue() ||
+        a.getChildNodes().size() != b.getChildNodes().size())
+      return false;
+
+    if (a.getNodeType() == DOMNodeType::ELEMENT_NODE)
+    {
+      const DOMElement& elementA = static_cast<const DOMElement&>(a);
+      const DOMElement& elementB = static_cast<const DOMElement&>(b);
+      if (elementA.getAttributes() != elementB.getAttributes())
+        return false;
+
+      const bool bHasStyle = elementA.getComputedStyle() != nullptr;
+      if (bHasStyle != (elementB.getComputedStyle() != nullptr))
+        return false;
+      if (bHasStyle && !IsSameStyle(*elementA.getComputedStyle(), *elementB.getComputedStyle()))
+        return false;
+    }
+
+    for (size_t i = 0; i < a.getChildNodes().size(); ++i)
+    {
+      if (!IsSameTree(*a.getChildNodes()[i], *b.getChildNodes()[i]))
+        return false;
+    }
+    return true;
+  }
+
+  constexpr const char* s_szSnapshotSheet = R"(
+    .app { --accent: orange; display: flex; color: #ddd; }
+    .item { width: 50%; color: var(--accent); transform: scale(2); }
+    .odd { margin-left: 2px; }
+    #title { font-size: 20px; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(DOM, DOMSnapshot)
+{
+  CSSStyleSheet sheet;
+  sheet.ParseFromString(s_szSnapshotSheet);
+
+  StyleCache styleCache;
+  StyleResolver resolver(styleCache);
+  resolver.AddStyleSheet(&sheet);
+
+  auto document = BuildDocument();
+  resolver.ResolveStyles(*document);
+
+  nsContiguousMemoryStreamStorage storage;
+  {
+    nsMemoryStreamWriter writer(&storage);
+    NS_TEST_BOOL(DOMSnapshot::Write(writer, {document}).Succeeded());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Round trip")
+  {
+    DOMSnapshot snapshot;
+    nsMemoryStreamReader reader(&storage);
+    NS_TEST_BOOL(snapshot.Read(reader).Succeeded());
+    NS_TEST_INT(snapshot.GetRootCount(), 1);
+    NS_TEST_INT(snapshot.GetNodes().GetCount(), 19);
+    // app, title, and the two kinds of items.
+    NS_TEST_INT(snapshot.GetStyles().GetCount(), 4);
+
+    std::vector<std::shared_ptr<DOMNode>> roots = snapshot.Instantiate(&styleCache);
+    NS_TEST_INT(roots.size(), 1);
+    NS_TEST_BOOL(IsSameTree(*document, *roots[0]));
+
+    // Styles that don't depend on custom properties come back as the same cached style.
+    const DOMElement& title = static_cast<const DOMElement&>(*roots[0]->getChildNodes()[0]);
+    NS_TEST_BOOL(title.getComputedStyle() == static_cast<const DOMElement&>(*document->getChildNodes()[0]).getComputedStyle());
+
+    const DOMElement& first = static_cast<const DOMElement&>(*roots[0]->getChildNodes()[1]);
+    const DOMElement& third = static_cast<const DOMElement&>(*roots[0]->getChildNodes()[3]);
+    NS_TEST_BOOL(first.getComputedStyle() == third.getComputedStyle());
+    NS_TEST_BOOL(first.getComputedStyle()->GetVariableMask() != 0);
+
+    // Without a cache only the DOM is restored.
+    roots = snapshot.Instantiate();
+    NS_TEST_BOOL(static_cast<const DOMElement&>(*roots[0]).getComputedStyle() == nullptr);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Loading from memory doesn't copy")
+  {
+    DOMSnapshot snapshot;
+    NS_TEST_BOOL(snapshot.ReadFromMemory(storage.GetData(), storage.GetStorageSize64()).Succeeded());
+
+    const char* pBegin = reinterpret_cast<const char*>(storage.GetData());
+    const char* pEnd = pBegin + storage.GetStorageSize64();
+    const char* pName = snapshot.GetString(snapshot.GetNodes()[0].m_Name).GetStartPointer();
+    NS_TEST_BOOL(pName >= pBegin && pName < pEnd);
+    NS_TEST_BOOL(reinterpret_cast<const char*>(snapshot.GetNodes().GetPtr()) >= pBegin);
+    NS_TEST_BOOL(snapshot.GetString(snapshot.GetNodes()[0].m_Name) == "div");
+
+    std::vector<std::shared_ptr<DOMNode>> roots = snapshot.Instantiate(&styleCache);
+    NS_TEST_BOOL(IsSameTree(*document, *roots[0]));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Layout boxes")
+  {
+    nsDynamicArray<nsRectFloat> boxes;
+    for (nsUInt32 i = 0; i < 19; ++i)
+      boxes.PushBack(nsRectFloat(0.0f, 20.0f * i, 100.0f, 20.0f));
+
+    nsContiguousMemoryStreamStorage withBoxes;
+    nsMemoryStreamWriter writer(&withBoxes);
+    NS_TEST_BOOL(DOMSnapshot::Write(writer, {document}, boxes).Succeeded());
+    NS_TEST_BOOL(DOMSnapshot::Write(writer, {document}, boxes.GetArrayPtr().GetSubArray(0, 4)).Failed());
+
+    DOMSnapshot snapshot;
+    NS_TEST_BOOL(snapshot.ReadFromMemory(withBoxes.GetData(), withBoxes.GetStorageSize64()).Succeeded());
+    NS_TEST_INT(snapshot.GetLayoutBoxes().GetCount(), 19);
+    NS_TEST_BOOL(snapshot.GetLayoutBoxes()[18] == boxes[18]);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupted snapshots are rejected")
+  {
+    const nsUInt64 uiSize = storage.GetStorageSize64();
+    nsDynamicArray<nsUInt64> copy;
+    copy.SetCountUninitialized(static_cast<nsUInt32>((uiSize + 7) / 8));
+    nsUInt8* pCopy = reinterpret_cast<nsUInt8*>(copy.GetData());
+    nsMemoryUtils::Copy(pCopy, storage.GetData(), uiSize);
+
+    DOMSnapshot snapshot;
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize - 1).Failed());
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, 16).Failed());
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy + 1, uiSize - 1).Failed());
+
+    {
+      nsRawMemoryStreamReader reader(pCopy, uiSize / 2);
+      NS_TEST_BOOL(snapshot.Read(reader).Failed());
+      NS_TEST_INT(snapshot.GetNodes().GetCount(), 0);
+    }
+
+    // Find the records in the copy, then break them one at a time.
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Succeeded());
+    DOMSnapshot::Node* pNode = const_cast<DOMSnapshot::Node*>(snapshot.GetNodes().GetPtr());
+    const DOMSnapshot::Node original = *pNode;
+
+    pNode->m_uiChildCount = 0xFFFFFFF0u;
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Failed());
+    *pNode = original;
+
+    pNode->m_Name.m_uiOffset = 0xFFFFFFF0u;
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Failed());
+    *pNode = original;
+
+    pNode->m_uiFirstAttribute = 0xFFFFFFFFu;
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Failed());
+    *pNode = original;
+
+    pNode->m_uiStyle = 1000;
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Failed());
+    *pNode = original;
+
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Succeeded());
+    DOMSnapshot::StyleValue* pValue = const_cast<DOMSnapshot::StyleValue*>(snapshot.GetStyleValues().GetPtr());
+    const nsUInt32 uiUnit = pValue->m_uiUnit;
+
+    pValue->m_uiUnit = 0x80000000u;
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Failed());
+    pValue->m_uiUnit = static_cast<nsUInt32>(aperture::core::Unit::PX | aperture::core::Unit::EM);
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Failed());
+    pValue->m_uiUnit = uiUnit;
+
+    // The version is right after the magic.
+    pCopy[4] ^= 0xFF;
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Failed());
+    pCopy[4] ^= 0xFF;
+
+    NS_TEST_BOOL(snapshot.ReadFromMemory(pCopy, uiSize).Succeeded());
+  }
+}
@@ -0,0 +1,255 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/GridLayout.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+
+#include <ApertureHTMLTest/Layout/LayoutTestUtils.h>
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMNode;
+  using aperture::layout::GridArea;
+  using aperture::layout::GridLayout;
+  using aperture::layout::LayoutTree;
+  using aperture::test::LayoutTestSetup;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+
+  // A panel with a grid of the given class, one item per text.
+  std::shared_ptr<DOMElement> BuildGrid(const char* szClass, std::initializer_list<std::pair<const char*, const char*>> items, std::shared_ptr<DOMElement>& out_grid)
+  {
+    auto panel = MakeElement("div", "panel");
+    out_grid = MakeElement("div", szClass);
+    for (const auto& item : items)
+    {
+      auto element = MakeElement("div", item.first);
+      element->appendChild(MakeText(item.second));
+      out_grid->appendChild(element);
+    }
+    panel->appendChild(out_grid);
+    return panel;
+  }
+
+  bool IsArea(const GridArea& area, nsUInt32 uiColumnStart, nsUInt32 uiColumnEnd, nsUInt32 uiRowStart, nsUInt32 uiRowEnd)
+  {
+    return area.m_uiColumnStart == uiColumnStart && area.m_uiColumnEnd == uiColumnEnd && area.m_uiRowStart == uiRowStart && area.m_uiRowEnd == uiRowEnd;
+  }
+
+  constexpr const char* s_szGridSheet = R"(
+    .panel { width: 1000px; }
+    .fixed { display: grid; width: 400px; grid-template-columns: 100px 1fr 2fr; column-gap: 10px; row-gap: 5px; }
+    .intrinsic { display: grid; width: 600px; grid-template-columns: auto minmax(100px, 200px) fit-content(80px) 1fr; }
+    .flow { display: grid; grid-template-columns: repeat(3, 50px); grid-auto-rows: 20px; }
+    .dense { grid-auto-flow: row dense; }
+    .wide { grid-column: span 2; }
+    .full { grid-column: 1 / -1; }
+    .fill { display: grid; width: 350px; grid-template-columns: repeat(auto-fill, 100px); column-gap: 10px; }
+    .fit { display: grid; width: 350px; grid-template-columns: repeat(auto-fit, 100px); column-gap: 10px; }
+    .board { display: grid; grid-template-columns: repeat(100, auto); }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(Layout, GridLayout)
+{
+  LayoutTestSetup setup(s_szGridSheet);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Fixed and flexible tracks")
+  {
+    std::shared_ptr<DOMElement> grid;
+    auto panel = BuildGrid("fixed", {{"", "a"}, {"", "b"}, {"", "c"}, {"", "d"}}, grid);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    // 280px are left for 3fr.
+    const GridLayout* pGrid = tree.GetGrid(tree.FindBox(grid.get()));
+    NS_TEST_BOOL(pGrid != nullptr);
+    NS_TEST_INT(pGrid->GetColumns().GetCount(), 3);
+    NS_TEST_FLOAT(pGrid->GetColumns()[1].m_fBaseSize, 280.0f / 3.0f, 0.01f);
+    NS_TEST_FLOAT(pGrid->GetColumns()[2].m_fOffset, 110.0f + 10.0f + 280.0f / 3.0f, 0.01f);
+
+    // The fourth item starts an implicit row.
+    NS_TEST_INT(pGrid->GetRows().GetCount(), 2);
+    NS_TEST_FLOAT(pGrid->GetContentSize().height, 37.0f, 0.0f);
+    NS_TEST_FLOAT(tree.GetBox(tree.FindBox(grid.get())).m_fHeight, 37.0f, 0.0f);
+
+    const nsRectFloat item = tree.GetBox(tree.FindBox(grid->getChildNodes()[3].get())).GetRect();
+    NS_TEST_FLOAT(item.x, 0.0f, 0.0f);
+    NS_TEST_FLOAT(item.y, 21.0f, 0.0f);
+    NS_TEST_FLOAT(item.width, 100.0f, 0.0f);
+    NS_TEST_FLOAT(item.height, 16.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Intrinsic tracks")
+  {
+    std::shared_ptr<DOMElement> grid;
+    auto panel = BuildGrid("intrinsic", {{"", "abc"}, {"", "hello world"}, {"", "a long text"}, {"", "x"}}, grid);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    // auto fits its content, minmax() grows to its maximum, fit-content() is clamped and 1fr takes the rest.
+    const GridLayout* pGrid = tree.GetGrid(tree.FindBox(grid.get()));
+    NS_TEST_FLOAT(pGrid->GetColumns()[0].m_fBaseSize, 24.0f, 0.01f);
+    NS_TEST_FLOAT(pGrid->GetColumns()[1].m_fBaseSize, 200.0f, 0.01f);
+    NS_TEST_FLOAT(pGrid->GetColumns()[2].m_fBaseSize, 80.0f, 0.01f);
+    NS_TEST_FLOAT(pGrid->GetColumns()[3].m_fBaseSize, 296.0f, 0.01f);
+
+    // The text that was clamped wraps, its row is as high as two lines.
+    NS_TEST_FLOAT(pGrid->GetRows()[0].m_fBaseSize, 32.0f, 0.01f);
+    NS_TEST_FLOAT(tree.GetBox(tree.FindBox(grid->getChildNodes()[2].get())).m_fHeight, 32.0f, 0.0f);
+    NS_TEST_FLOAT(tree.GetBox(tree.FindBox(grid->getChildNodes()[3].get())).m_fX, 304.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Auto placement")
+  {
+    std::shared_ptr<DOMElement> grid;
+    auto panel = BuildGrid("flow", {{"wide", "a"}, {"wide", "b"}, {"", "c"}, {"full", "d"}}, grid);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    // Sparse: the cursor only moves forward, the hole after the first item stays empty.
+    const GridLayout* pGrid = tree.GetGrid(tree.FindBox(grid.get()));
+    NS_TEST_BOOL(IsArea(pGrid->GetItemLines(0), 0, 2, 0, 1));
+    NS_TEST_BOOL(IsArea(pGrid->GetItemLines(1), 0, 2, 1, 2));
+    NS_TEST_BOOL(IsArea(pGrid->GetItemLines(2), 2, 3, 1, 2));
+    NS_TEST_BOOL(IsArea(pGrid->GetItemLines(3), 0, 3, 2, 3));
+    NS_TEST_FLOAT(tree.GetBox(tree.FindBox(grid.get())).m_fHeight, 60.0f, 0.0f);
+
+    // Dense: the third item fills the hole.
+    grid->setAttribute("class", "flow dense");
+    setup.m_Resolver.ResolveStyles(*panel);
+    tree.UpdateStyle(*grid);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    NS_TEST_BOOL(IsArea(pGrid->GetItemLines(2), 2, 3, 0, 1));
+    NS_TEST_BOOL(IsArea(pGrid->GetItemLines(3), 0, 3, 2, 3));
+    const nsRectFloat item = tree.GetBox(tree.FindBox(grid->getChildNodes()[2].get())).GetRect();
+    NS_TEST_FLOAT(item.x, 100.0f, 0.0f);
+    NS_TEST_FLOAT(item.y, 0.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Automatic repetitions")
+  {
+    std::shared_ptr<DOMElement> grid;
+    auto panel = BuildGrid("fill", {{"", "a"}}, grid);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    // 3 tracks and their gaps fit into 350px.
+    const GridLayout* pGrid = tree.GetGrid(tree.FindBox(grid.get()));
+    NS_TEST_INT(pGrid->GetColumns().GetCount(), 3);
+    NS_TEST_FLOAT(pGrid->GetContentSize().width, 320.0f, 0.0f);
+
+    // auto-fit collapses the tracks without items.
+    grid->setAttribute("class", "fit");
+    setup.m_Resolver.ResolveStyles(*panel);
+    tree.UpdateStyle(*grid);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    NS_TEST_INT(pGrid->GetColumns().GetCount(), 3);
+    NS_TEST_BOOL(pGrid->GetColumns()[2].m_bCollapsed);
+    NS_TEST_FLOAT(pGrid->GetContentSize().width, 100.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Unchanged items keep their contributions")
+  {
+    std::shared_ptr<DOMElement> grid;
+    auto panel = BuildGrid("intrinsic", {{"", "abc"}, {"", "hello world"}, {"", "a long text"}, {"", "x"}}, grid);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    const GridLayout* pGrid = tree.GetGrid(tree.FindBox(grid.get()));
+    const_cast<GridLayout*>(pGrid)->ResetStats();
+    tree.ResetStats();
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_INT(tree.GetStats().m_uiSkippedPasses, 1);
+    NS_TEST_INT(pGrid->GetStats().m_uiTrackSizings, 0);
+
+    // The first column gets wider, the items aren't placed again.
+    DOMNode& text = *grid->getChildNodes()[0]->getChildNodes()[0];
+    text.setNodeValue("abcdef");
+    tree.UpdateText(text);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    NS_TEST_INT(pGrid->GetStats().m_uiPlacements, 0);
+    NS_TEST_FLOAT(pGrid->GetColumns()[0].m_fBaseSize, 48.0f, 0.01f);
+    NS_TEST_FLOAT(tree.GetBox(tree.FindBox(grid->getChildNodes()[1].get())).m_fX, 48.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark 100x100 items")
+  {
+    auto panel = MakeElement("div", "panel");
+    auto grid = MakeElement("div", "board");
+    for (nsUInt32 i = 0; i < 100 * 100; ++i)
+    {
+      auto item = MakeElement("div", "");
+      item->appendChild(MakeText(std::to_string(i % 1000)));
+      grid->appendChild(item);
+    }
+    panel->appendChild(grid);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+
+    nsStopwatch timer;
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+    const nsTime cold = timer.GetRunningTotal();
+
+    const GridLayout* pGrid = tree.GetGrid(tree.FindBox(grid.get()));
+    NS_TEST_INT(pGrid->GetColumns().GetCount(), 100);
+    NS_TEST_INT(pGrid->GetRows().GetCount(), 100);
+    const_cast<GridLayout*>(pGrid)->ResetStats();
+
+    timer.StopAndReset();
+    timer.Resume();
+    for (nsUInt32 i = 0; i < 100; ++i)
+      tree.Calculate(1920.0f, 1080.0f);
+    const nsTime cached = timer.GetRunningTotal();
+    NS_TEST_INT(pGrid->GetStats().m_uiTrackSizings, 0);
+
+    // One item changes per pass.
+    timer.StopAndReset();
+    timer.Resume();
+    for (nsUInt32 i = 0; i < 100; ++i)
+    {
+      DOMNode& text = *grid->getChildNodes()[i * 101]->getChildNodes()[0];
+      text.setNodeValue("changed");
+      tree.UpdateText(text);
+      tree.Calculate(1920.0f, 1080.0f);
+    }
+    const nsTime incremental = timer.GetRunningTotal();
+    NS_TEST_INT(pGrid->GetStats().m_uiPlacements, 0);
+
+    nsLog::Info("Grid of 100x100 items: {0} ms build and layout, {1} ms per unchanged pass, {2} ms per pass with one changed item", nsArgF(cold.GetMilliseconds(), 2),
+      nsArgF(cached.GetMilliseconds() / 100.0, 3), nsArgF(incremental.GetMilliseconds() / 100.0, 3));
+  }
+}
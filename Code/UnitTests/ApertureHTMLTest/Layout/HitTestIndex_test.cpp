@@ -0,0 +1,233 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/HitTestIndex.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+
+#include <ApertureHTMLTest/Layout/LayoutTestUtils.h>
+
+namespace
+{
+  using aperture::dom::DOMElement;
+  using aperture::layout::HitTestIndex;
+  using aperture::layout::LayoutTree;
+  using aperture::test::LayoutTestSetup;
+  using aperture::test::MakeElement;
+
+  bool IsSameHitTesting(const HitTestIndex& a, const HitTestIndex& b, float fWidth, float fHeight)
+  {
+    for (float y = 1.0f; y < fHeight; y += 7.0f)
+    {
+      for (float x = 1.0f; x < fWidth; x += 7.0f)
+      {
+        if (a.HitTest(nsVec2(x, y)) != b.HitTest(nsVec2(x, y)))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr const char* s_szHitTestSheet = R"(
+    .page { width: 400px; height: 400px; }
+    .card { position: absolute; left: 0px; top: 0px; width: 100px; height: 100px; }
+    .low { z-index: 1; }
+    .high { z-index: 5; }
+    .inner { position: absolute; left: 10px; top: 10px; width: 50px; height: 50px; z-index: 100; }
+    .clip { position: absolute; left: 200px; top: 0px; width: 40px; height: 40px; overflow: hidden; }
+    .content { width: 100px; height: 100px; }
+    .ghost { position: absolute; left: 300px; top: 0px; width: 50px; height: 50px; pointer-events: none; }
+    .list { width: 200px; }
+    .row { height: 20px; }
+    .tall { height: 60px; }
+    .moved { position: absolute; left: 0px; top: 200px; width: 50px; height: 50px; transform: translate(100px, 0px); }
+    .dot { width: 10px; height: 10px; }
+    .spun { position: absolute; left: 200px; top: 200px; width: 100px; height: 20px; transform: rotate(90deg); }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(Layout, HitTestIndex)
+{
+  LayoutTestSetup setup(s_szHitTestSheet);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Overlapping z-index")
+  {
+    // The inner card has the highest z-index, but it is inside of the stacking context of the low card.
+    auto page = MakeElement("div", "page");
+    auto high = MakeElement("div", "card high");
+    auto low = MakeElement("div", "card low");
+    auto inner = MakeElement("div", "inner");
+    low->appendChild(inner);
+    page->appendChild(high);
+    page->appendChild(low);
+    setup.m_Resolver.ResolveStyles(*page);
+
+    LayoutTree tree;
+    tree.Build(*page);
+    tree.Calculate(1000.0f);
+
+    HitTestIndex index;
+    index.Update(tree);
+    NS_TEST_INT(index.GetCount(), 4);
+
+    NS_TEST_BOOL(index.HitTest(nsVec2(20.0f, 20.0f)) == high.get());
+    NS_TEST_BOOL(index.HitTest(nsVec2(150.0f, 150.0f)) == page.get());
+    NS_TEST_BOOL(index.HitTest(nsVec2(500.0f, 20.0f)) == nullptr);
+
+    nsDynamicArray<const DOMElement*> elements;
+    index.HitTestAll(nsVec2(20.0f, 20.0f), elements);
+    NS_TEST_INT(elements.GetCount(), 4);
+    if (elements.GetCount() == 4)
+    {
+      NS_TEST_BOOL(elements[0] == high.get());
+      NS_TEST_BOOL(elements[1] == inner.get());
+      NS_TEST_BOOL(elements[2] == low.get());
+      NS_TEST_BOOL(elements[3] == page.get());
+    }
+
+    // Covered elements are still within their box.
+    NS_TEST_BOOL(index.IsPointWithinElement(inner.get(), nsVec2(20.0f, 20.0f)));
+    NS_TEST_BOOL(!index.IsPointWithinElement(inner.get(), nsVec2(5.0f, 5.0f)));
+    NS_TEST_FLOAT(HitTestIndex::GetZIndex(*low->getComputedStyle()), 1.0f, 0.0f);
+    NS_TEST_FLOAT(HitTestIndex::GetZIndex(*page->getComputedStyle()), 0.0f, 0.0f);
+
+    // Swapping the z-indices swaps the order, a new index picks up a change that doesn't affect layout.
+    high->setAttribute("class", "card low");
+    low->setAttribute("class", "card high");
+    setup.m_Resolver.ResolveStyles(*page);
+    tree.UpdateStyle(*high);
+    tree.UpdateStyle(*low);
+    tree.Calculate(1000.0f);
+    index.Clear();
+    index.Update(tree);
+    NS_TEST_BOOL(index.HitTest(nsVec2(20.0f, 20.0f)) == inner.get());
+    NS_TEST_BOOL(index.HitTest(nsVec2(5.0f, 5.0f)) == low.get());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Clip areas and pointer-events")
+  {
+    auto page = MakeElement("div", "page");
+    auto clip = MakeElement("div", "clip");
+    auto content = MakeElement("div", "content");
+    auto ghost = MakeElement("div", "ghost");
+    clip->appendChild(content);
+    page->appendChild(clip);
+    page->appendChild(ghost);
+    setup.m_Resolver.ResolveStyles(*page);
+
+    LayoutTree tree;
+    tree.Build(*page);
+    tree.Calculate(1000.0f);
+
+    HitTestIndex index;
+    index.Update(tree);
+
+    NS_TEST_BOOL(index.HitTest(nsVec2(220.0f, 20.0f)) == content.get());
+    NS_TEST_BOOL(index.HitTest(nsVec2(260.0f, 60.0f)) == page.get());
+    NS_TEST_BOOL(!index.IsPointWithinElement(content.get(), nsVec2(260.0f, 60.0f)));
+
+    // pointer-events: none elements are hit through.
+    NS_TEST_BOOL(index.HitTest(nsVec2(320.0f, 20.0f)) == page.get());
+    NS_TEST_BOOL(index.Find(ghost.get()) == HitTestIndex::InvalidHandle);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Transforms")
+  {
+    auto page = MakeElement("div", "page");
+    auto moved = MakeElement("div", "moved");
+    auto dot = MakeElement("div", "dot");
+    auto spun = MakeElement("div", "spun");
+    moved->appendChild(dot);
+    page->appendChild(moved);
+    page->appendChild(spun);
+    setup.m_Resolver.ResolveStyles(*page);
+
+    LayoutTree tree;
+    tree.Build(*page);
+    tree.Calculate(1000.0f);
+
+    HitTestIndex index;
+    index.Update(tree);
+
+    // The translation moves the box and its children.
+    NS_TEST_BOOL(index.HitTest(nsVec2(120.0f, 230.0f)) == moved.get());
+    NS_TEST_BOOL(index.HitTest(nsVec2(105.0f, 205.0f)) == dot.get());
+    NS_TEST_BOOL(index.HitTest(nsVec2(20.0f, 230.0f)) == page.get());
+    NS_TEST_BOOL(index.HitTest(nsVec2(5.0f, 205.0f)) == page.get());
+
+    // Rotated around its center, the box covers x 240-260 and y 160-260.
+    NS_TEST_BOOL(index.HitTest(nsVec2(250.0f, 170.0f)) == spun.get());
+    NS_TEST_BOOL(index.HitTest(nsVec2(250.0f, 255.0f)) == spun.get());
+    NS_TEST_BOOL(index.HitTest(nsVec2(210.0f, 210.0f)) == page.get());
+    NS_TEST_BOOL(index.IsPointWithinElement(spun.get(), nsVec2(250.0f, 170.0f)));
+    NS_TEST_BOOL(!index.IsPointWithinElement(spun.get(), nsVec2(290.0f, 210.0f)));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Only changed boxes are updated")
+  {
+    auto page = MakeElement("div", "list");
+    for (nsUInt32 i = 0; i < 50; ++i)
+      page->appendChild(MakeElement("div", "row"));
+    setup.m_Resolver.ResolveStyles(*page);
+
+    LayoutTree tree;
+    tree.Build(*page);
+    tree.Calculate(1000.0f);
+
+    HitTestIndex index;
+    index.Update(tree);
+    NS_TEST_INT(index.GetStats().m_uiFullUpdates, 1);
+    NS_TEST_INT(index.GetCount(), 51);
+
+    // Updating without a new pass does nothing.
+    index.ResetStats();
+    tree.Calculate(1000.0f);
+    index.Update(tree);
+    NS_TEST_INT(index.GetStats().m_uiUpdatedBoxes, 0);
+
+    // The last row grows, nothing before it moves.
+    DOMElement& last = *static_cast<DOMElement*>(page->getChildNodes()[49].get());
+    last.setAttribute("class", "row tall");
+    setup.m_Resolver.ResolveStyles(*page);
+    tree.UpdateStyle(last);
+    tree.Calculate(1000.0f);
+
+    index.ResetStats();
+    index.Update(tree);
+    NS_TEST_INT(index.GetStats().m_uiFullUpdates, 0);
+    NS_TEST_BOOL(index.GetStats().m_uiUpdatedBoxes < tree.GetBoxCount() / 2);
+    NS_TEST_BOOL(index.HitTest(nsVec2(10.0f, 1030.0f)) == &last);
+
+    HitTestIndex expected;
+    expected.Update(tree);
+    NS_TEST_BOOL(IsSameHitTesting(index, expected, 200.0f, 1100.0f));
+
+    // The first row grows, every row after it moves.
+    DOMElement& first = *static_cast<DOMElement*>(page->getChildNodes()[0].get());
+    first.setAttribute("class", "row tall");
+    setup.m_Resolver.ResolveStyles(*page);
+    tree.UpdateStyle(first);
+    tree.Calculate(1000.0f);
+
+    index.ResetStats();
+    index.Update(tree);
+    NS_TEST_INT(index.GetStats().m_uiFullUpdates, 0);
+    NS_TEST_BOOL(index.HitTest(nsVec2(10.0f, 50.0f)) == &first);
+    NS_TEST_BOOL(index.HitTest(nsVec2(10.0f, 70.0f)) == page->getChildNodes()[1].get());
+
+    expected.Update(tree);
+    NS_TEST_BOOL(IsSameHitTesting(index, expected, 200.0f, 1100.0f));
+
+    // A pass that wasn't picked up leaves the changed boxes of the next one incomplete.
+    first.setAttribute("class", "row");
+    setup.m_Resolver.ResolveStyles(*page);
+    tree.UpdateStyle(first);
+    tree.Calculate(1000.0f);
+    tree.Calculate(800.0f);
+
+    index.ResetStats();
+    index.Update(tree);
+    NS_TEST_INT(index.GetStats().m_uiFullUpdates, 1);
+    expected.Update(tree);
+    NS_TEST_BOOL(IsSameHitTesting(index, expected, 200.0f, 1100.0f));
+  }
+}
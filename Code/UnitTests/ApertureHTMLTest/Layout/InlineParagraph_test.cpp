@@ -0,0 +1,216 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <APHTML/layout/Core/InlineParagraph.h>
+#include <APHTML/layout/Core/TextMeasureCache.h>
+
+#include <limits>
+#include <string>
+
+namespace
+{
+  using aperture::layout::InlineFragment;
+  using aperture::layout::InlineItem;
+  using aperture::layout::InlineLine;
+  using aperture::layout::InlineParagraph;
+  using aperture::layout::InlineParagraphStyle;
+  using aperture::layout::Size;
+  using aperture::layout::TextMeasureCache;
+  using aperture::layout::TextMeasurer;
+  using aperture::layout::VerticalAlign;
+
+  constexpr float s_fInfinity = std::numeric_limits<float>::infinity();
+
+  // The font key is the font size: every byte is half of it wide, the text is as high as the font size.
+  // The default metrics then give an ascent of 0.8 and a descent of 0.2 times the font size.
+  class FontSizeMeasurer : public TextMeasurer
+  {
+  public:
+    Size MeasureText(std::string_view in_text, nsUInt64 in_uiFontKey, float in_fMaxWidth) override
+    {
+      ++m_uiCalls;
+      const float fSize = static_cast<float>(in_uiFontKey);
+      return {fSize * 0.5f * static_cast<float>(in_text.size()), fSize};
+    }
+
+    nsUInt32 m_uiCalls = 0;
+  };
+
+  InlineItem MakeItem(nsUInt32 uiStart, nsUInt32 uiEnd, nsUInt64 uiFontSize = 16, VerticalAlign verticalAlign = VerticalAlign::Baseline)
+  {
+    InlineItem item;
+    item.m_uiStart = uiStart;
+    item.m_uiEnd = uiEnd;
+    item.m_uiFontKey = uiFontSize;
+    item.m_fLineHeight = -1.0f;
+    item.m_fBaselineOffset = 0.0f;
+    item.m_VerticalAlign = verticalAlign;
+    item.m_uiOwner = 0;
+    return item;
+  }
+
+  InlineParagraphStyle MakeStyle(bool bWrap = true)
+  {
+    InlineParagraphStyle style;
+    style.m_uiFontKey = 16;
+    style.m_bWrap = bWrap;
+    return style;
+  }
+
+  std::string GetFragmentText(const InlineParagraph& paragraph, const InlineFragment& fragment)
+  {
+    return paragraph.GetText().substr(fragment.m_uiStart, fragment.m_uiEnd - fragment.m_uiStart);
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(Layout, InlineParagraph)
+{
+  FontSizeMeasurer measurer;
+  TextMeasureCache cache(&measurer);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Line breaking")
+  {
+    // 8px per byte.
+    const std::string text = "The quick brown fox jumps over";
+    const InlineItem items[] = {MakeItem(0, 30)};
+
+    InlineParagraph paragraph;
+    NS_TEST_BOOL(paragraph.SetContent(text, items, MakeStyle()));
+    NS_TEST_BOOL(!paragraph.SetContent(text, items, MakeStyle()));
+
+    // "jumps" ends exactly at 200px, its trailing space hangs.
+    const Size size = paragraph.Measure(cache, 200.0f);
+    NS_TEST_FLOAT(size.width, 200.0f, 0.0f);
+    NS_TEST_FLOAT(size.height, 32.0f, 0.0f);
+
+    paragraph.Layout(cache, 200.0f);
+    NS_TEST_INT(paragraph.GetLines().GetCount(), 2);
+    const InlineLine& second = paragraph.GetLines()[1];
+    NS_TEST_FLOAT(second.m_fY, 16.0f, 0.0f);
+    NS_TEST_FLOAT(second.m_fBaseline, 16.0f + 12.8f, 0.001f);
+    NS_TEST_STRING(GetFragmentText(paragraph, paragraph.GetFragments()[second.m_uiFirstFragment]).c_str(), "over");
+
+    // Other widths don't replace the lines.
+    NS_TEST_FLOAT(paragraph.Measure(cache, s_fInfinity).width, 240.0f, 0.0f);
+    NS_TEST_FLOAT(paragraph.Measure(cache, s_fInfinity).height, 16.0f, 0.0f);
+    NS_TEST_INT(paragraph.GetLines().GetCount(), 2);
+
+    // A word that doesn't fit anywhere overflows.
+    NS_TEST_FLOAT(paragraph.Measure(cache, 20.0f).width, 40.0f, 0.0f);
+    NS_TEST_FLOAT(paragraph.Measure(cache, 20.0f).height, 6 * 16.0f, 0.0f);
+
+    // Every word was measured once, plus the space and the metrics.
+    NS_TEST_INT(measurer.m_uiCalls, 6 + 1 + 1);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Forced breaks and nowrap")
+  {
+    const std::string text = "first line\nsecond";
+    const InlineItem items[] = {MakeItem(0, 17)};
+
+    InlineParagraph paragraph;
+    paragraph.SetContent(text, items, MakeStyle(false));
+    paragraph.Layout(cache, 40.0f);
+
+    NS_TEST_INT(paragraph.GetLines().GetCount(), 2);
+    NS_TEST_FLOAT(paragraph.GetLines()[0].m_fWidth, 80.0f, 0.0f);
+    NS_TEST_FLOAT(paragraph.GetLines()[1].m_fWidth, 48.0f, 0.0f);
+
+    paragraph.SetContent(text, items, MakeStyle(true));
+    paragraph.Layout(cache, 40.0f);
+    NS_TEST_INT(paragraph.GetLines().GetCount(), 3);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Vertical align")
+  {
+    const std::string text = "x2";
+    InlineParagraph paragraph;
+
+    // A bigger font on the baseline makes the line higher and moves the baseline down.
+    {
+      const InlineItem items[] = {MakeItem(0, 1), MakeItem(1, 2, 32)};
+      paragraph.SetContent(text, items, MakeStyle());
+      paragraph.Layout(cache, 200.0f);
+
+      const InlineLine& line = paragraph.GetLines()[0];
+      NS_TEST_FLOAT(line.m_fHeight, 32.0f, 0.001f);
+      NS_TEST_FLOAT(line.m_fBaseline, 25.6f, 0.001f);
+      NS_TEST_FLOAT(paragraph.GetFragments()[0].m_fY, 25.6f - 12.8f, 0.001f);
+      NS_TEST_FLOAT(paragraph.GetFragments()[1].m_fY, 0.0f, 0.001f);
+    }
+
+    // Superscript is raised above the baseline of the strut.
+    {
+      const InlineItem items[] = {MakeItem(0, 1), MakeItem(1, 2, 16, VerticalAlign::Super)};
+      paragraph.SetContent(text, items, MakeStyle());
+      paragraph.Layout(cache, 200.0f);
+
+      const nsArrayPtr<const InlineFragment> fragments = paragraph.GetFragments();
+      NS_TEST_BOOL(paragraph.GetLines()[0].m_fHeight > 16.0f);
+      NS_TEST_FLOAT(fragments[0].m_fBaseline - fragments[1].m_fBaseline, 16.0f * 0.33f, 0.001f);
+    }
+
+    // Top aligned content hangs down from the top of the line box instead of moving the baseline.
+    {
+      const InlineItem items[] = {MakeItem(0, 1), MakeItem(1, 2, 32, VerticalAlign::Top)};
+      paragraph.SetContent(text, items, MakeStyle());
+      paragraph.Layout(cache, 200.0f);
+
+      const InlineLine& line = paragraph.GetLines()[0];
+      NS_TEST_FLOAT(line.m_fHeight, 32.0f, 0.001f);
+      NS_TEST_FLOAT(line.m_fBaseline, 12.8f, 0.001f);
+      NS_TEST_FLOAT(paragraph.GetFragments()[1].m_fY, 0.0f, 0.001f);
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Bidi")
+  {
+    // Right to left paragraph: "abc" is embedded left to right and is visually left of the hebrew word.
+    const std::string text = "\xD7\x90\xD7\x91\xD7\x92 abc";
+    const InlineItem items[] = {MakeItem(0, 10)};
+    InlineParagraphStyle style = MakeStyle();
+    style.m_bRightToLeft = true;
+
+    InlineParagraph paragraph;
+    paragraph.SetContent(text, items, style);
+    paragraph.Layout(cache, 200.0f);
+
+    // Start aligned, which is right for right to left content.
+    const nsArrayPtr<const InlineFragment> fragments = paragraph.GetFragments();
+    NS_TEST_INT(fragments.GetCount(), 2);
+    NS_TEST_STRING(GetFragmentText(paragraph, fragments[0]).c_str(), "abc");
+    NS_TEST_INT(fragments[0].m_uiBidiLevel, 2);
+    NS_TEST_FLOAT(fragments[0].m_fX, 120.0f, 0.0f);
+    NS_TEST_INT(fragments[1].m_uiBidiLevel, 1);
+    NS_TEST_FLOAT(fragments[1].m_fX, 144.0f, 0.0f);
+    NS_TEST_FLOAT(fragments[1].m_fX + fragments[1].m_fWidth, 200.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Appending only lays out the end")
+  {
+    std::string text;
+    for (nsUInt32 i = 0; i < 1000; ++i)
+      text += "message " + std::to_string(i) + "\n";
+
+    InlineItem item = MakeItem(0, static_cast<nsUInt32>(text.size()));
+
+    InlineParagraph paragraph;
+    paragraph.SetContent(text, nsArrayPtr<const InlineItem>(&item, 1), MakeStyle());
+    paragraph.Layout(cache, 400.0f);
+    NS_TEST_INT(paragraph.GetLines().GetCount(), 1000);
+
+    const float fLastY = paragraph.GetLines()[998].m_fY;
+
+    text += "message 1000\n";
+    item.m_uiEnd = static_cast<nsUInt32>(text.size());
+    paragraph.ResetStats();
+    paragraph.SetContent(text, nsArrayPtr<const InlineItem>(&item, 1), MakeStyle());
+
+    NS_TEST_FLOAT(paragraph.Measure(cache, 400.0f).height, 1001 * 16.0f, 0.0f);
+    NS_TEST_INT(paragraph.GetLines().GetCount(), 1001);
+    NS_TEST_FLOAT(paragraph.GetLines()[998].m_fY, fLastY, 0.0f);
+
+    // The last line is segmented and built again, since the break after it may change, and the new one.
+    NS_TEST_INT(paragraph.GetStats().m_uiSegments, 4);
+    NS_TEST_INT(paragraph.GetStats().m_uiLines, 2);
+  }
+}
@@ -0,0 +1,198 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/LayoutFragmentCache.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+
+#include <ApertureHTMLTest/Layout/LayoutTestUtils.h>
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMNode;
+  using aperture::layout::LayoutFragmentCache;
+  using aperture::layout::LayoutTree;
+  using aperture::layout::VirtualList;
+  using aperture::test::HasSameLayout;
+  using aperture::test::LayoutTestSetup;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+
+  // A shop entry: the title takes the space the price leaves.
+  std::shared_ptr<DOMElement> MakeCard(const std::string& title, const std::string& price)
+  {
+    auto card = MakeElement("div", "card");
+    auto titleElement = MakeElement("div", "title");
+    titleElement->appendChild(MakeText(title));
+    auto priceElement = MakeElement("div", "price");
+    priceElement->appendChild(MakeText(price));
+    card->appendChild(titleElement);
+    card->appendChild(priceElement);
+    return card;
+  }
+
+  constexpr const char* s_szShopSheet = R"(
+    .panel { width: 400px; }
+    .list { height: 300px; overflow-y: auto; }
+    .card { display: flex; padding: 4px; margin-bottom: 6px; }
+    .title { flex-grow: 1; }
+    .price { width: 40px; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(Layout, LayoutFragmentCache)
+{
+  LayoutTestSetup setup(s_szShopSheet);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Identical trees share their layout")
+  {
+    LayoutFragmentCache fragmentCache;
+
+    auto first = MakeCard("Sword", "100");
+    auto second = MakeCard("Sword", "100");
+    setup.m_Resolver.ResolveStyles(*first);
+    setup.m_Resolver.ResolveStyles(*second);
+
+    LayoutTree firstTree;
+    firstTree.SetTextMeasureCache(&setup.m_TextCache);
+    firstTree.SetFragmentCache(&fragmentCache);
+    firstTree.Build(*first);
+    firstTree.Calculate(300.0f);
+    NS_TEST_INT(fragmentCache.GetStats().m_uiMisses, 1);
+    NS_TEST_INT(fragmentCache.GetCount(), 1);
+    NS_TEST_INT(firstTree.GetStats().m_uiPasses, 1);
+
+    LayoutTree secondTree;
+    secondTree.SetTextMeasureCache(&setup.m_TextCache);
+    secondTree.SetFragmentCache(&fragmentCache);
+    secondTree.Build(*second);
+    secondTree.Calculate(300.0f);
+    NS_TEST_INT(fragmentCache.GetStats().m_uiHits, 1);
+    NS_TEST_INT(secondTree.GetStats().m_uiPasses, 0);
+    NS_TEST_INT(secondTree.GetStats().m_uiFragmentPasses, 1);
+
+    // Inline content is placed as well.
+    NS_TEST_BOOL(HasSameLayout(firstTree, secondTree));
+    NS_TEST_FLOAT(secondTree.GetBox(secondTree.FindBox(second->getChildNodes()[0].get())).m_fWidth, 252.0f, 0.0f);
+    NS_TEST_FLOAT(secondTree.GetBox(secondTree.FindBox(second->getChildNodes()[0]->getChildNodes()[0].get())).m_fWidth, 40.0f, 0.0f);
+    NS_TEST_FLOAT(secondTree.GetRootMarginBoxSize().height, 30.0f, 0.0f);
+    NS_TEST_INT(secondTree.GetChangedBoxes().GetCount(), secondTree.GetBoxCount());
+
+    // Nothing changed.
+    secondTree.ResetStats();
+    secondTree.Calculate(300.0f);
+    NS_TEST_INT(secondTree.GetStats().m_uiSkippedPasses, 1);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Different content or size is laid out")
+  {
+    LayoutFragmentCache fragmentCache;
+
+    auto first = MakeCard("Sword", "100");
+    auto second = MakeCard("Shield", "100");
+    setup.m_Resolver.ResolveStyles(*first);
+    setup.m_Resolver.ResolveStyles(*second);
+
+    LayoutTree firstTree;
+    firstTree.SetTextMeasureCache(&setup.m_TextCache);
+    firstTree.SetFragmentCache(&fragmentCache);
+    firstTree.Build(*first);
+    firstTree.Calculate(300.0f);
+
+    LayoutTree secondTree;
+    secondTree.SetTextMeasureCache(&setup.m_TextCache);
+    secondTree.SetFragmentCache(&fragmentCache);
+    secondTree.Build(*second);
+    secondTree.Calculate(300.0f);
+    NS_TEST_INT(fragmentCache.GetStats().m_uiHits, 0);
+    NS_TEST_INT(secondTree.GetStats().m_uiPasses, 1);
+
+    firstTree.Build(*first);
+    firstTree.Calculate(200.0f);
+    NS_TEST_INT(fragmentCache.GetStats().m_uiHits, 0);
+    NS_TEST_FLOAT(firstTree.GetBox(firstTree.FindBox(first->getChildNodes()[0].get())).m_fWidth, 152.0f, 0.0f);
+
+    // The text changes after the layout was copied: Yoga lays the tree out.
+    auto third = MakeCard("Sword", "100");
+    setup.m_Resolver.ResolveStyles(*third);
+    LayoutTree thirdTree;
+    thirdTree.SetTextMeasureCache(&setup.m_TextCache);
+    thirdTree.SetFragmentCache(&fragmentCache);
+    thirdTree.Build(*third);
+    thirdTree.Calculate(200.0f);
+    NS_TEST_INT(thirdTree.GetStats().m_uiFragmentPasses, 1);
+
+    DOMNode& text = *third->getChildNodes()[0]->getChildNodes()[0];
+    text.setNodeValue("Axe");
+    thirdTree.UpdateText(text);
+    thirdTree.Calculate(200.0f);
+    NS_TEST_INT(thirdTree.GetStats().m_uiPasses, 1);
+    NS_TEST_FLOAT(thirdTree.GetRootMarginBoxSize().height, 30.0f, 0.0f);
+    NS_TEST_FLOAT(thirdTree.GetBox(thirdTree.FindBox(&text)).m_fWidth, 24.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Rows of a virtualized container")
+  {
+    LayoutFragmentCache fragmentCache;
+
+    auto panel = MakeElement("div", "panel");
+    auto list = MakeElement("div", "list");
+    list->setAttribute("virtualize", "");
+    for (nsUInt32 i = 0; i < 1000; ++i)
+      list->appendChild(MakeCard("Potion", "25"));
+    panel->appendChild(list);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.SetFragmentCache(&fragmentCache);
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    // Only the first row was laid out by Yoga.
+    const VirtualList* pList = tree.GetVirtualList(tree.FindBox(list.get()));
+    NS_TEST_INT(fragmentCache.GetStats().m_uiMisses, 1);
+    NS_TEST_INT(fragmentCache.GetStats().m_uiHits, pList->GetStats().m_uiMaterializedRows - 1);
+    NS_TEST_FLOAT(pList->GetVisibleRows()[5].m_fY, 150.0f, 0.0f);
+    NS_TEST_FLOAT(pList->GetVisibleRows()[5].m_fHeight, 30.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark scrolling identical rows")
+  {
+    auto panel = MakeElement("div", "panel");
+    auto list = MakeElement("div", "list");
+    list->setAttribute("virtualize", "");
+    for (nsUInt32 i = 0; i < 10000; ++i)
+      list->appendChild(MakeCard("Potion", "25"));
+    panel->appendChild(list);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    nsTime durations[2];
+    for (nsUInt32 uiCached = 0; uiCached < 2; ++uiCached)
+    {
+      LayoutFragmentCache fragmentCache;
+      LayoutTree tree;
+      tree.SetTextMeasureCache(&setup.m_TextCache);
+      tree.SetFragmentCache(uiCached ? &fragmentCache : nullptr);
+      tree.Build(*panel);
+      tree.Calculate(1920.0f, 1080.0f);
+
+      nsStopwatch timer;
+      for (nsUInt32 i = 1; i <= 1000; ++i)
+      {
+        tree.SetScrollOffset(*list, i * 75.0f);
+        tree.Calculate(1920.0f, 1080.0f);
+      }
+      durations[uiCached] = timer.GetRunningTotal();
+    }
+
+    nsLog::Info("Virtual list of 10000 identical rows: {0} ms per scroll step without fragment cache, {1} ms with", nsArgF(durations[0].GetMilliseconds() / 1000.0, 3),
+      nsArgF(durations[1].GetMilliseconds() / 1000.0, 3));
+  }
+}
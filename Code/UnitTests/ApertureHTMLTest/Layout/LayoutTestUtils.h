@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ApertureHTMLTest/CSS/CSSTestUtils.h>
+
+#include <APHTML/css/Style/CSSStyleSheet.h>
+#include <APHTML/css/Style/StyleResolver.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+#include <APHTML/layout/Core/TextMeasureCache.h>
+
+#include <ApertureHTMLTestUtils/MonospaceMeasurer.h>
+
+namespace aperture::test
+{
+  /// Resolves styles against one style sheet and measures text with a MonospaceMeasurer, the setup every layout test starts from.
+  struct LayoutTestSetup
+  {
+    explicit LayoutTestSetup(const char* szSheet)
+      : m_Resolver(m_StyleCache)
+      , m_TextCache(&m_Measurer)
+    {
+      m_Sheet.ParseFromString(szSheet);
+      m_Resolver.AddStyleSheet(&m_Sheet);
+    }
+
+    css::CSSStyleSheet m_Sheet;
+    css::StyleCache m_StyleCache;
+    css::StyleResolver m_Resolver;
+    MonospaceMeasurer m_Measurer;
+    layout::TextMeasureCache m_TextCache;
+  };
+
+  /// True if both trees have the same boxes at the same places.
+  inline bool HasSameLayout(const layout::LayoutTree& a, const layout::LayoutTree& b)
+  {
+    if (a.GetBoxCount() != b.GetBoxCount())
+      return false;
+
+    for (nsUInt32 i = 0; i < a.GetBoxCount(); ++i)
+    {
+      if (a.GetBox(i).GetRect() != b.GetBox(i).GetRect())
+        return false;
+    }
+    return a.GetRootMarginBoxSize().height == b.GetRootMarginBoxSize().height;
+  }
+} // namespace aperture::test
@@ -0,0 +1,216 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+
+#include <ApertureHTMLTest/Layout/LayoutTestUtils.h>
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMNode;
+  using aperture::layout::InvalidLayoutIndex;
+  using aperture::layout::LayoutBox;
+  using aperture::layout::LayoutBoxType;
+  using aperture::layout::LayoutIndex;
+  using aperture::layout::LayoutTree;
+  using aperture::test::LayoutTestSetup;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+
+  // A flex row of uiPanels panels with uiLabels labels each, as in a HUD.
+  std::shared_ptr<DOMElement> BuildHud(nsUInt32 uiPanels, nsUInt32 uiLabels)
+  {
+    auto hud = MakeElement("div", "hud");
+    for (nsUInt32 p = 0; p < uiPanels; ++p)
+    {
+      auto panel = MakeElement("div", "panel");
+      for (nsUInt32 i = 0; i < uiLabels; ++i)
+      {
+        auto label = MakeElement("div", "label");
+        label->appendChild(MakeText("Item " + std::to_string(i)));
+        panel->appendChild(label);
+      }
+      hud->appendChild(panel);
+    }
+    return hud;
+  }
+
+  constexpr const char* s_szHudSheet = R"(
+    .hud { display: flex; width: 800px; }
+    .panel { width: 200px; padding: 10px; }
+    .wide { width: 300px; }
+    .hidden { display: none; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST_GROUP(Layout);
+
+NS_CREATE_SIMPLE_TEST(Layout, LayoutTree)
+{
+  LayoutTestSetup setup(s_szHudSheet);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Build")
+  {
+    // <div class="hud"><div class="panel">Hello <span>World</span> <div>Line</div> <p class="hidden">Gone</p></div></div>
+    auto hud = MakeElement("div", "hud");
+    auto panel = MakeElement("div", "panel");
+    auto span = MakeElement("span");
+    auto line = MakeElement("div");
+    auto hidden = MakeElement("p", "hidden");
+    span->appendChild(MakeText("World"));
+    line->appendChild(MakeText("Line"));
+    hidden->appendChild(MakeText("Gone"));
+    panel->appendChild(MakeText("Hello "));
+    panel->appendChild(span);
+    panel->appendChild(MakeText("\n  "));
+    panel->appendChild(line);
+    panel->appendChild(MakeText("\n  "));
+    panel->appendChild(hidden);
+    hud->appendChild(panel);
+    setup.m_Resolver.ResolveStyles(*hud);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*hud);
+
+    // hud, panel, anonymous (Hello, span, World, whitespace), line, Line. The hidden element and the whitespace before it have no boxes.
+    NS_TEST_INT(tree.GetBoxCount(), 9);
+    NS_TEST_BOOL(tree.GetBox(0).m_Type == LayoutBoxType::Flex);
+    NS_TEST_BOOL(tree.GetBox(1).m_Type == LayoutBoxType::Block);
+    NS_TEST_BOOL(tree.GetBox(2).m_Type == LayoutBoxType::Anonymous);
+    NS_TEST_BOOL(tree.GetBox(tree.FindBox(span.get())).m_Type == LayoutBoxType::Inline);
+    NS_TEST_BOOL(tree.FindBox(hidden.get()) == InvalidLayoutIndex);
+
+    // Only boxes with block-level content own a Yoga node.
+    NS_TEST_BOOL(tree.GetBox(2).HasYogaNode());
+    NS_TEST_BOOL(!tree.GetBox(tree.FindBox(span.get())).HasYogaNode());
+    NS_TEST_STRING(tree.GetInlineText(2).c_str(), "Hello World");
+    NS_TEST_STRING(tree.GetInlineText(tree.FindBox(line.get())).c_str(), "Line");
+
+    NS_TEST_BOOL(sizeof(LayoutBox) <= 64);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Layout and incremental updates")
+  {
+    auto hud = MakeElement("div", "hud");
+    auto panel = MakeElement("div", "panel");
+    auto title = MakeElement("div");
+    auto text = MakeText("Hello World");
+    title->appendChild(text);
+    panel->appendChild(title);
+    hud->appendChild(panel);
+    setup.m_Resolver.ResolveStyles(*hud);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*hud);
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_INT(tree.GetStats().m_uiPasses, 1);
+
+    // The panel is content-box: 200px plus the padding.
+    const LayoutIndex uiPanel = tree.FindBox(panel.get());
+    const LayoutIndex uiTitle = tree.FindBox(title.get());
+    const LayoutIndex uiText = tree.FindBox(text.get());
+    NS_TEST_FLOAT(tree.GetBox(uiPanel).m_fWidth, 220.0f, 0.0f);
+    NS_TEST_FLOAT(tree.GetBox(uiTitle).m_fWidth, 200.0f, 0.0f);
+    NS_TEST_FLOAT(tree.GetBox(uiTitle).m_fHeight, 16.0f, 0.0f);
+    NS_TEST_FLOAT(tree.GetAbsoluteRect(uiText).x, 10.0f, 0.0f);
+    NS_TEST_FLOAT(tree.GetAbsoluteRect(uiText).y, 10.0f, 0.0f);
+
+    // Nothing changed.
+    tree.ResetStats();
+    tree.UpdateText(*text);
+    tree.UpdateStyle(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_INT(tree.GetStats().m_uiPasses, 0);
+    NS_TEST_INT(tree.GetStats().m_uiSkippedPasses, 1);
+
+    // 30 characters wrap onto two lines in 200px.
+    text->setNodeValue("The quick brown fox jumps over");
+    tree.UpdateText(*text);
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_INT(tree.GetStats().m_uiPasses, 1);
+    NS_TEST_FLOAT(tree.GetBox(uiTitle).m_fHeight, 32.0f, 0.0f);
+    NS_TEST_FLOAT(tree.GetBox(uiPanel).m_fHeight, 52.0f, 0.0f);
+
+    // Style changes only need the new styles applied.
+    panel->setAttribute("class", "panel wide");
+    setup.m_Resolver.ResolveStyles(*hud);
+    tree.UpdateStyle(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_INT(tree.GetStats().m_uiBuilds, 0);
+    NS_TEST_FLOAT(tree.GetBox(uiPanel).m_fWidth, 320.0f, 0.0f);
+    NS_TEST_FLOAT(tree.GetBox(uiTitle).m_fHeight, 16.0f, 0.0f);
+
+    // Hiding an element changes the structure.
+    title->setAttribute("class", "hidden");
+    setup.m_Resolver.ResolveStyles(*hud);
+    tree.UpdateStyle(*title);
+    NS_TEST_BOOL(tree.IsStructureDirty());
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_INT(tree.GetStats().m_uiBuilds, 1);
+    NS_TEST_BOOL(tree.FindBox(title.get()) == InvalidLayoutIndex);
+    NS_TEST_FLOAT(tree.GetBox(tree.FindBox(panel.get())).m_fHeight, 20.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Clean subtrees are skipped")
+  {
+    auto hud = BuildHud(2, 50);
+    setup.m_Resolver.ResolveStyles(*hud);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*hud);
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_INT(tree.GetChangedBoxes().GetCount(), tree.GetBoxCount());
+
+    // The second panel is not dirty and gets the same constraints, Yoga doesn't visit its labels.
+    const nsUInt32 uiCalls = setup.m_Measurer.m_uiCalls;
+    DOMNode& text = *hud->getChildNodes()[0]->getChildNodes()[10]->getChildNodes()[0];
+    text.setNodeValue("Player joined");
+    tree.UpdateText(text);
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_BOOL(setup.m_Measurer.m_uiCalls - uiCalls <= 2);
+    NS_TEST_BOOL(tree.GetChangedBoxes().GetCount() <= 1 + 1 + 100 + 1);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark single text change")
+  {
+    auto hud = BuildHud(10, 500);
+    setup.m_Resolver.ResolveStyles(*hud);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+
+    nsStopwatch timer;
+    tree.Build(*hud);
+    tree.Calculate(1920.0f, 1080.0f);
+    const nsTime full = timer.GetRunningTotal();
+
+    DOMNode& timerText = *hud->getChildNodes()[0]->getChildNodes()[0]->getChildNodes()[0];
+    const nsUInt32 uiCalls = setup.m_Measurer.m_uiCalls;
+
+    timer.StopAndReset();
+    timer.Resume();
+    for (nsUInt32 i = 0; i < 100; ++i)
+    {
+      timerText.setNodeValue("00:" + std::to_string(10 + i % 50));
+      tree.UpdateText(timerText);
+      tree.Calculate(1920.0f, 1080.0f);
+    }
+    const nsTime incremental = timer.GetRunningTotal();
+
+    // Only 50 distinct timer texts, the rest are cache hits.
+    NS_TEST_BOOL(setup.m_Measurer.m_uiCalls - uiCalls <= 100);
+
+    nsLog::Info("Layout of 5000 labels: {0} ms build and layout, {1} ms per single text change, {2} bytes per box", nsArgF(full.GetMilliseconds(), 2),
+      nsArgF(incremental.GetMilliseconds() / 100.0, 3), static_cast<nsUInt32>(sizeof(LayoutBox)));
+  }
+}
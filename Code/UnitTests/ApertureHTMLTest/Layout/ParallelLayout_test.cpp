@@ -0,0 +1,249 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+#include <APHTML/layout/Core/TextMeasureCache.h>
+
+#include <ApertureHTMLTest/Layout/LayoutTestUtils.h>
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMNode;
+  using aperture::layout::InvalidLayoutIndex;
+  using aperture::layout::LayoutIndex;
+  using aperture::layout::LayoutTree;
+  using aperture::layout::TextMeasureCache;
+  using aperture::test::HasSameLayout;
+  using aperture::test::LayoutTestSetup;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+
+  // Every fourth panel sizes to its content and isn't an independent formatting root, the inner boxes of the first of
+  // every four are nested in a root. The popup is one as well.
+  std::shared_ptr<DOMElement> BuildDocument(nsUInt32 uiPanels, nsUInt32 uiLines)
+  {
+    const char* panelClasses[] = {"panel", "panel contained", "panel", "panel fluid"};
+
+    auto page = MakeElement("div", "page");
+    for (nsUInt32 p = 0; p < uiPanels; ++p)
+    {
+      auto panel = MakeElement("div", panelClasses[p % 4]);
+      auto title = MakeElement("div", "title");
+      title->appendChild(MakeText("Panel " + std::to_string(p)));
+      panel->appendChild(title);
+
+      for (nsUInt32 i = 0; i < uiLines; ++i)
+      {
+        auto line = MakeElement("div", "line");
+        line->appendChild(MakeText("Item " + std::to_string(i) + " of panel " + std::to_string(p)));
+        panel->appendChild(line);
+      }
+
+      if (p % 4 == 0)
+      {
+        auto inner = MakeElement("div", "inner");
+        inner->appendChild(MakeText("Nested"));
+        panel->appendChild(inner);
+      }
+      page->appendChild(panel);
+    }
+
+    auto popup = MakeElement("div", "popup");
+    popup->appendChild(MakeText("Popup"));
+    page->appendChild(popup);
+    return page;
+  }
+
+  bool IsInSubtree(const LayoutTree& tree, LayoutIndex uiBox, LayoutIndex uiRoot)
+  {
+    for (; uiBox != InvalidLayoutIndex; uiBox = tree.GetBox(uiBox).m_uiParent)
+    {
+      if (uiBox == uiRoot)
+        return true;
+    }
+    return false;
+  }
+
+  constexpr const char* s_szPanelSheet = R"(
+    .page { display: flex; flex-wrap: wrap; width: 1000px; }
+    .panel { width: 180px; height: 120px; margin: 5px; padding: 4px; box-sizing: border-box; overflow: hidden; }
+    .contained { overflow: visible; contain: layout paint; }
+    .fluid { height: auto; }
+    .title { padding: 2px; }
+    .inner { width: 60px; height: 40px; overflow: hidden; }
+    .popup { position: absolute; left: 300px; top: 20px; width: 200px; height: 100px; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(Layout, ParallelLayout)
+{
+  LayoutTestSetup setup(s_szPanelSheet);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Parallel matches serial")
+  {
+    auto document = BuildDocument(12, 4);
+    setup.m_Resolver.ResolveStyles(*document);
+
+    LayoutTree serial;
+    serial.SetTextMeasureCache(&setup.m_TextCache);
+    serial.Build(*document);
+    serial.Calculate(1000.0f);
+    NS_TEST_INT(serial.GetStats().m_uiParallelRoots, 0);
+
+    for (nsUInt32 uiThreads : {2u, 4u, 0u})
+    {
+      LayoutTree parallel;
+      parallel.SetTextMeasureCache(&setup.m_TextCache);
+      parallel.SetMaxThreads(uiThreads);
+      parallel.Build(*document);
+      parallel.Calculate(1000.0f);
+
+      // 9 panels and the popup.
+      NS_TEST_INT(parallel.GetStats().m_uiParallelRoots, 10);
+      NS_TEST_BOOL(HasSameLayout(serial, parallel));
+    }
+
+    LayoutTree parallel;
+    parallel.SetTextMeasureCache(&setup.m_TextCache);
+    parallel.SetMaxThreads(4);
+    parallel.Build(*document);
+    const DOMNode& firstPanel = *document->getChildNodes()[0];
+    NS_TEST_BOOL(parallel.GetBox(parallel.FindBox(&firstPanel)).m_bParallelRoot);
+    NS_TEST_BOOL(parallel.GetBox(parallel.FindBox(document->getChildNodes()[1].get())).m_bParallelRoot);
+    NS_TEST_BOOL(!parallel.GetBox(parallel.FindBox(document->getChildNodes()[3].get())).m_bParallelRoot);
+    NS_TEST_BOOL(!parallel.GetBox(parallel.FindBox(firstPanel.getChildNodes()[5].get())).m_bParallelRoot);
+    NS_TEST_BOOL(parallel.GetBox(parallel.FindBox(document->getChildNodes()[12].get())).m_bParallelRoot);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Incremental changes")
+  {
+    auto document = BuildDocument(12, 4);
+    setup.m_Resolver.ResolveStyles(*document);
+
+    LayoutTree serial;
+    serial.SetTextMeasureCache(&setup.m_TextCache);
+    serial.Build(*document);
+    serial.Calculate(1000.0f);
+
+    LayoutTree parallel;
+    parallel.SetTextMeasureCache(&setup.m_TextCache);
+    parallel.SetMaxThreads(4);
+    parallel.Build(*document);
+    parallel.Calculate(1000.0f);
+
+    // A change inside of a root only lays out that root.
+    const LayoutIndex uiPanel = parallel.FindBox(document->getChildNodes()[1].get());
+    DOMNode& text = *document->getChildNodes()[1]->getChildNodes()[1]->getChildNodes()[0];
+    text.setNodeValue("An item that got a much longer name than before");
+    serial.UpdateText(text);
+    parallel.UpdateText(text);
+
+    parallel.ResetStats();
+    serial.Calculate(1000.0f);
+    parallel.Calculate(1000.0f);
+    NS_TEST_INT(parallel.GetStats().m_uiPasses, 1);
+    NS_TEST_INT(parallel.GetStats().m_uiParallelRoots, 1);
+    NS_TEST_BOOL(HasSameLayout(serial, parallel));
+    NS_TEST_BOOL(!parallel.GetChangedBoxes().IsEmpty());
+    for (LayoutIndex uiBox : parallel.GetChangedBoxes())
+      NS_TEST_BOOL(IsInSubtree(parallel, uiBox, uiPanel));
+
+    // The content of the panel that isn't a root grows, so the panels of the next row move without being laid out again.
+    const LayoutIndex uiMoved = parallel.FindBox(document->getChildNodes()[5].get());
+    const float fPreviousY = parallel.GetBox(uiMoved).m_fY;
+    DOMNode& fluidText = *document->getChildNodes()[3]->getChildNodes()[1]->getChildNodes()[0];
+    fluidText.setNodeValue("An item of the panel that sizes to its content, with a name that takes several lines");
+    serial.UpdateText(fluidText);
+    parallel.UpdateText(fluidText);
+
+    parallel.ResetStats();
+    serial.Calculate(1000.0f);
+    parallel.Calculate(1000.0f);
+    NS_TEST_INT(parallel.GetStats().m_uiParallelRoots, 0);
+    NS_TEST_BOOL(parallel.GetBox(uiMoved).m_fY > fPreviousY);
+    NS_TEST_BOOL(HasSameLayout(serial, parallel));
+
+    // A new available size only lays out the roots whose size changed, none here.
+    parallel.ResetStats();
+    serial.Calculate(1200.0f);
+    parallel.Calculate(1200.0f);
+    NS_TEST_INT(parallel.GetStats().m_uiParallelRoots, 0);
+    NS_TEST_BOOL(HasSameLayout(serial, parallel));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Style changes that make a box a root")
+  {
+    auto document = BuildDocument(8, 2);
+    setup.m_Resolver.ResolveStyles(*document);
+
+    LayoutTree serial;
+    serial.SetTextMeasureCache(&setup.m_TextCache);
+    serial.Build(*document);
+    serial.Calculate(1000.0f);
+
+    LayoutTree parallel;
+    parallel.SetTextMeasureCache(&setup.m_TextCache);
+    parallel.SetMaxThreads(4);
+    parallel.Build(*document);
+    parallel.Calculate(1000.0f);
+
+    DOMElement& panel = static_cast<DOMElement&>(*document->getChildNodes()[3]);
+    panel.setAttribute("class", "panel");
+    setup.m_Resolver.ResolveStyles(*document);
+    serial.UpdateStyle(panel);
+    parallel.UpdateStyle(panel);
+    NS_TEST_BOOL(!serial.IsStructureDirty());
+    NS_TEST_BOOL(parallel.IsStructureDirty());
+
+    parallel.ResetStats();
+    serial.Calculate(1000.0f);
+    parallel.Calculate(1000.0f);
+    NS_TEST_INT(parallel.GetStats().m_uiBuilds, 1);
+    NS_TEST_INT(parallel.GetStats().m_uiParallelRoots, 8);
+    NS_TEST_BOOL(HasSameLayout(serial, parallel));
+
+    // Turning it off builds the tree without roots.
+    parallel.SetMaxThreads(1);
+    NS_TEST_BOOL(parallel.IsStructureDirty());
+    parallel.ResetStats();
+    parallel.Calculate(1000.0f);
+    NS_TEST_INT(parallel.GetStats().m_uiParallelRoots, 0);
+    NS_TEST_BOOL(HasSameLayout(serial, parallel));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark 256 panels")
+  {
+    auto document = BuildDocument(256, 40);
+    setup.m_Resolver.ResolveStyles(*document);
+
+    // Cold caches for both, measuring text is part of the work that is split.
+    TextMeasureCache serialCache(&setup.m_Measurer);
+    TextMeasureCache parallelCache(&setup.m_Measurer);
+    TextMeasureCache* caches[2] = {&serialCache, &parallelCache};
+
+    nsTime durations[2];
+    LayoutTree trees[2];
+    for (nsUInt32 uiParallel = 0; uiParallel < 2; ++uiParallel)
+    {
+      LayoutTree& tree = trees[uiParallel];
+      tree.SetTextMeasureCache(caches[uiParallel]);
+      tree.SetMaxThreads(uiParallel ? 0 : 1);
+      tree.Build(*document);
+
+      nsStopwatch timer;
+      tree.Calculate(1920.0f);
+      durations[uiParallel] = timer.GetRunningTotal();
+    }
+    NS_TEST_BOOL(HasSameLayout(trees[0], trees[1]));
+
+    nsLog::Info("Layout of 256 panels with {0} boxes: {1} ms in one pass, {2} ms with the panels in parallel", trees[0].GetBoxCount(),
+      nsArgF(durations[0].GetMilliseconds(), 2), nsArgF(durations[1].GetMilliseconds(), 2));
+  }
+}
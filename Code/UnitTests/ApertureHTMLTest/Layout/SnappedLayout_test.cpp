@@ -0,0 +1,194 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+#include <APHTML/layout/Core/SnappedLayout.h>
+#include <APHTML/layout/Internal/DPIUtils.h>
+
+#include <ApertureHTMLTest/Layout/LayoutTestUtils.h>
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMNode;
+  using aperture::layout::DPIUtils;
+  using aperture::layout::LayoutIndex;
+  using aperture::layout::LayoutTree;
+  using aperture::layout::SnappedLayout;
+  using aperture::test::LayoutTestSetup;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+
+  // A row of three cells that share 100px, followed by sections of text.
+  std::shared_ptr<DOMElement> BuildDocument(nsUInt32 uiSections)
+  {
+    auto page = MakeElement("div", "page");
+    auto row = MakeElement("div", "row");
+    for (nsUInt32 i = 0; i < 3; ++i)
+      row->appendChild(MakeElement("div", "cell"));
+    page->appendChild(row);
+
+    for (nsUInt32 i = 0; i < uiSections; ++i)
+    {
+      auto section = MakeElement("div", "section");
+      section->appendChild(MakeText("Section " + std::to_string(i)));
+      page->appendChild(section);
+    }
+    return page;
+  }
+
+  bool IsSameSnapping(const SnappedLayout& a, const SnappedLayout& b)
+  {
+    if (a.GetBoxCount() != b.GetBoxCount())
+      return false;
+
+    for (nsUInt32 i = 0; i < a.GetBoxCount(); ++i)
+    {
+      if (a.GetRect(i) != b.GetRect(i))
+        return false;
+    }
+    return true;
+  }
+
+  constexpr const char* s_szSnapSheet = R"(
+    .page { width: 200px; padding: 0.3px; }
+    .row { display: flex; width: 100px; height: 10px; }
+    .cell { flex-grow: 1; }
+    .section { margin-top: 2.5px; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(Layout, SnappedLayout)
+{
+  LayoutTestSetup setup(s_szSnapSheet);
+
+  auto document = BuildDocument(4);
+  setup.m_Resolver.ResolveStyles(*document);
+  const DOMNode& row = *document->getChildNodes()[0];
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Layout isn't rounded")
+  {
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*document);
+    tree.Calculate(1000.0f);
+
+    for (const std::shared_ptr<DOMNode>& pCell : row.getChildNodes())
+      NS_TEST_FLOAT(tree.GetBox(tree.FindBox(pCell.get())).m_fWidth, 100.0f / 3.0f, 0.001f);
+    NS_TEST_FLOAT(tree.GetBox(tree.FindBox(document->getChildNodes()[1].get())).m_fY, 0.3f + 10.0f + 2.5f, 0.001f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Edges snap to the device pixel grid")
+  {
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*document);
+    tree.Calculate(1000.0f);
+
+    for (float fScale : {1.0f, 1.5f, 2.0f, 2.25f})
+    {
+      SnappedLayout snapped(fScale);
+      snapped.Update(tree);
+      NS_TEST_INT(snapped.GetBoxCount(), tree.GetBoxCount());
+
+      // The cells stay adjacent and fill the row, whatever their sizes are rounded to.
+      const nsRectFloat& rowRect = snapped.GetRect(tree.FindBox(&row));
+      float fRight = rowRect.x;
+      for (const std::shared_ptr<DOMNode>& pCell : row.getChildNodes())
+      {
+        const nsRectFloat& cell = snapped.GetRect(tree.FindBox(pCell.get()));
+        NS_TEST_FLOAT(cell.x, fRight, 0.0f);
+        NS_TEST_FLOAT(cell.x, std::floor(cell.x), 0.0f);
+        NS_TEST_FLOAT(cell.width, std::floor(cell.width), 0.0f);
+        fRight = cell.x + cell.width;
+      }
+      NS_TEST_FLOAT(fRight, rowRect.x + rowRect.width, 0.0f);
+      NS_TEST_FLOAT(rowRect.width, std::floor(100.0f * fScale + 0.5f), 0.0f);
+    }
+
+    SnappedLayout snapped;
+    snapped.Update(tree);
+    const nsRectFloat& first = snapped.GetRect(tree.FindBox(row.getChildNodes()[0].get()));
+    const nsRectFloat& second = snapped.GetRect(tree.FindBox(row.getChildNodes()[1].get()));
+    NS_TEST_FLOAT(first.width, 34.0f, 0.0f);
+    NS_TEST_FLOAT(second.width, 33.0f, 0.0f);
+    NS_TEST_FLOAT(snapped.GetLayoutRect(tree.FindBox(row.getChildNodes()[1].get())).x, 0.3f + 100.0f / 3.0f, 0.001f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Render targets share one layout")
+  {
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*document);
+    tree.Calculate(1000.0f);
+
+    SnappedLayout view(DPIUtils::calculateLayoutScale(96.0));
+    SnappedLayout screenshot(DPIUtils::calculateLayoutScale(192.0));
+    view.Update(tree);
+    screenshot.Update(tree);
+    NS_TEST_INT(tree.GetStats().m_uiPasses, 1);
+    NS_TEST_FLOAT(screenshot.GetScale(), 2.0f, 0.0f);
+
+    const LayoutIndex uiSection = tree.FindBox(document->getChildNodes()[2].get());
+    NS_TEST_BOOL(view.GetLayoutRect(uiSection) == screenshot.GetLayoutRect(uiSection));
+    NS_TEST_BOOL(view.GetLayoutRect(uiSection) == tree.GetAbsoluteRect(uiSection));
+    NS_TEST_FLOAT(screenshot.GetRect(uiSection).height, 2.0f * view.GetRect(uiSection).height, 0.0f);
+
+    // Updating without a new pass does nothing.
+    view.ResetStats();
+    tree.Calculate(1000.0f);
+    view.Update(tree);
+    NS_TEST_INT(view.GetStats().m_uiUpdates, 0);
+
+    // A new scale snaps everything again.
+    view.SetScale(1.25f);
+    view.Update(tree);
+    NS_TEST_INT(view.GetStats().m_uiFullUpdates, 1);
+    NS_TEST_FLOAT(view.GetRect(0).width, 251.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Only changed subtrees are snapped again")
+  {
+    auto changing = BuildDocument(20);
+    setup.m_Resolver.ResolveStyles(*changing);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*changing);
+    tree.Calculate(1000.0f);
+
+    SnappedLayout snapped(1.5f);
+    snapped.Update(tree);
+    NS_TEST_INT(snapped.GetStats().m_uiFullUpdates, 1);
+
+    // The last section grows, nothing before it moves.
+    DOMNode& text = *changing->getChildNodes()[20]->getChildNodes()[0];
+    text.setNodeValue("The last section got a text that is longer than the width of the page");
+    tree.UpdateText(text);
+    tree.Calculate(1000.0f);
+
+    snapped.ResetStats();
+    snapped.Update(tree);
+    NS_TEST_INT(snapped.GetStats().m_uiFullUpdates, 0);
+    NS_TEST_BOOL(snapped.GetStats().m_uiSnappedBoxes < tree.GetBoxCount() / 2);
+
+    SnappedLayout expected(1.5f);
+    expected.Update(tree);
+    NS_TEST_BOOL(IsSameSnapping(snapped, expected));
+
+    // A pass that wasn't snapped leaves the changed boxes of the next one incomplete.
+    text.setNodeValue("Short");
+    tree.UpdateText(text);
+    tree.Calculate(1000.0f);
+    tree.Calculate(800.0f);
+
+    snapped.ResetStats();
+    snapped.Update(tree);
+    NS_TEST_INT(snapped.GetStats().m_uiFullUpdates, 1);
+    expected.Update(tree);
+    NS_TEST_BOOL(IsSameSnapping(snapped, expected));
+  }
+}
@@ -0,0 +1,78 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <APHTML/layout/Core/TextMeasureCache.h>
+
+#include <ApertureHTMLTest/Layout/LayoutTestUtils.h>
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+  using aperture::layout::Size;
+  using aperture::layout::TextMeasureCache;
+  using aperture::test::MonospaceMeasurer;
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(Layout, TextMeasureCache)
+{
+  MonospaceMeasurer measurer;
+  const nsUInt64 uiFont = TextMeasureCache::MakeFontKey("Roboto", 16.0f, 400, false);
+  const nsUInt64 uiBold = TextMeasureCache::MakeFontKey("Roboto", 16.0f, 700, false);
+  NS_TEST_BOOL(uiFont != uiBold);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Keys")
+  {
+    TextMeasureCache cache(&measurer);
+
+    const Size size = cache.Measure("Health", uiFont, NAN);
+    NS_TEST_FLOAT(size.width, 48.0f, 0.0f);
+    NS_TEST_INT(measurer.m_uiCalls, 1);
+
+    // Unconstrained is the same constraint, no matter how it is passed.
+    cache.Measure("Health", uiFont, INFINITY);
+    NS_TEST_INT(measurer.m_uiCalls, 1);
+
+    // Every part of the key matters.
+    cache.Measure("Health", uiBold, NAN);
+    cache.Measure("Health", uiFont, 24.0f);
+    cache.Measure("Mana", uiFont, NAN);
+    NS_TEST_INT(measurer.m_uiCalls, 4);
+    NS_TEST_INT(cache.GetStats().m_uiHits, 1);
+    NS_TEST_INT(cache.GetStats().m_uiMisses, 4);
+
+    const Size wrapped = cache.Measure("Health", uiFont, 24.0f);
+    NS_TEST_FLOAT(wrapped.height, 32.0f, 0.0f);
+    NS_TEST_INT(measurer.m_uiCalls, 4);
+
+    cache.Clear();
+    cache.Measure("Health", uiFont, NAN);
+    NS_TEST_INT(measurer.m_uiCalls, 5);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Generations")
+  {
+    measurer.m_uiCalls = 0;
+    TextMeasureCache cache(&measurer, 4);
+
+    cache.Measure("Score", uiFont, NAN);
+    for (nsUInt32 i = 0; i < 6; ++i)
+    {
+      cache.Measure(std::to_string(i), uiFont, NAN);
+    }
+    NS_TEST_INT(measurer.m_uiCalls, 7);
+    NS_TEST_BOOL(cache.GetCount() <= 8);
+
+    // "Score" is in the old generation, using it moves it back instead of measuring it again.
+    cache.Measure("Score", uiFont, NAN);
+    NS_TEST_INT(measurer.m_uiCalls, 7);
+
+    // Entries that are not used again are dropped after two generations.
+    for (nsUInt32 i = 0; i < 8; ++i)
+    {
+      cache.Measure(std::to_string(100 + i), uiFont, NAN);
+    }
+    cache.Measure("0", uiFont, NAN);
+    NS_TEST_INT(measurer.m_uiCalls, 16);
+  }
+}
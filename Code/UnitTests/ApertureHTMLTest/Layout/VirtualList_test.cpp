@@ -0,0 +1,184 @@
+#include <ApertureHTMLTest/ApertureHTMLTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+#include <APHTML/dom/DOMElement.h>
+#include <APHTML/layout/Core/LayoutTree.h>
+#include <APHTML/layout/Core/VirtualList.h>
+
+#include <ApertureHTMLTest/Layout/LayoutTestUtils.h>
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+  using aperture::dom::DOMElement;
+  using aperture::dom::DOMNode;
+  using aperture::layout::InvalidLayoutIndex;
+  using aperture::layout::LayoutTree;
+  using aperture::layout::VirtualList;
+  using aperture::layout::VirtualRow;
+  using aperture::test::LayoutTestSetup;
+  using aperture::test::MakeElement;
+  using aperture::test::MakeText;
+
+  // A 300px high leaderboard with 20px rows in a 400px wide panel.
+  std::shared_ptr<DOMElement> BuildLeaderboard(nsUInt32 uiRows, std::shared_ptr<DOMElement>& out_list)
+  {
+    auto panel = MakeElement("div", "panel");
+    out_list = MakeElement("div", "list");
+    out_list->setAttribute("virtualize", "");
+    for (nsUInt32 i = 0; i < uiRows; ++i)
+    {
+      auto row = MakeElement("div", "row");
+      row->appendChild(MakeText("Player " + std::to_string(i)));
+      out_list->appendChild(row);
+    }
+    panel->appendChild(out_list);
+    return panel;
+  }
+
+  DOMNode& GetRowText(DOMElement& list, nsUInt32 uiRow)
+  {
+    return *list.getChildNodes()[uiRow]->getChildNodes()[0];
+  }
+
+  const VirtualRow* FindVisibleRow(const VirtualList& list, nsUInt32 uiRow)
+  {
+    for (const VirtualRow& row : list.GetVisibleRows())
+    {
+      if (row.m_uiRow == uiRow)
+        return &row;
+    }
+    return nullptr;
+  }
+
+  constexpr const char* s_szLeaderboardSheet = R"(
+    .panel { width: 400px; }
+    .list { height: 300px; overflow-y: auto; }
+    .row { padding: 2px; }
+  )";
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(Layout, VirtualList)
+{
+  LayoutTestSetup setup(s_szLeaderboardSheet);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Only rows in view are laid out")
+  {
+    std::shared_ptr<DOMElement> list;
+    auto panel = BuildLeaderboard(10000, list);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    // The rows have no boxes in the tree of the document.
+    NS_TEST_INT(tree.GetBoxCount(), 2);
+    NS_TEST_BOOL(tree.FindBox(list->getChildNodes()[0].get()) == InvalidLayoutIndex);
+
+    const VirtualList* pList = tree.GetVirtualList(tree.FindBox(list.get()));
+    NS_TEST_BOOL(pList != nullptr);
+    NS_TEST_INT(pList->GetRowCount(), 10000);
+    NS_TEST_FLOAT(tree.GetBox(tree.FindBox(list.get())).m_fHeight, 300.0f, 0.0f);
+
+    // 300px viewport and 200px overscan below it.
+    NS_TEST_INT(pList->GetVisibleRows().GetCount(), 25);
+    NS_TEST_INT(pList->GetStats().m_uiMaterializedRows, 25);
+    NS_TEST_FLOAT(pList->GetVisibleRows()[24].m_fY, 480.0f, 0.0f);
+    NS_TEST_FLOAT(pList->GetVisibleRows()[24].m_pTree->GetBox(0).m_fHeight, 20.0f, 0.0f);
+    NS_TEST_FLOAT(pList->GetContentHeight(), 200000.0f, 0.0f);
+
+    // Nothing changed.
+    tree.ResetStats();
+    tree.Calculate(1920.0f, 1080.0f);
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_INT(tree.GetStats().m_uiSkippedPasses, 1);
+
+    // Scrolling doesn't lay out the document, the trees of the rows that went out of view are reused.
+    tree.ResetStats();
+    const_cast<VirtualList*>(pList)->ResetStats();
+    tree.SetScrollOffset(*list, 100000.0f);
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_INT(tree.GetStats().m_uiPasses, 0);
+    NS_TEST_INT(pList->GetVisibleRows().GetCount(), 35);
+    NS_TEST_INT(pList->GetVisibleRows()[0].m_uiRow, 4990);
+    NS_TEST_FLOAT(pList->GetVisibleRows()[0].m_fY, 99800.0f, 0.0f);
+    NS_TEST_INT(pList->GetStats().m_uiMaterializedRows, 35);
+    NS_TEST_INT(pList->GetStats().m_uiRecycledRows, 25);
+
+    // A row above the viewport gets higher, the rows in view keep their position in the viewport.
+    DOMNode& text = GetRowText(*list, 4995);
+    text.setNodeValue(std::string(29, 'x') + " " + std::string(30, 'y'));
+    tree.UpdateText(text);
+    tree.Calculate(1920.0f, 1080.0f);
+    NS_TEST_FLOAT(FindVisibleRow(*pList, 4995)->m_fHeight, 36.0f, 0.0f);
+    NS_TEST_FLOAT(FindVisibleRow(*pList, 5000)->m_fY, pList->GetScrollOffset(), 0.0f);
+    NS_TEST_FLOAT(pList->GetScrollOffset(), pList->GetRowOffset(5000), 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Rows keep their height across builds")
+  {
+    std::shared_ptr<DOMElement> list;
+    auto panel = BuildLeaderboard(100, list);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+
+    // A row is appended below the viewport.
+    auto row = MakeElement("div", "row");
+    row->appendChild(MakeText("Newcomer"));
+    list->appendChild(row);
+    setup.m_Resolver.ResolveStyles(*panel);
+    tree.MarkStructureDirty();
+
+    const VirtualList* pList = tree.GetVirtualList(tree.FindBox(list.get()));
+    const_cast<VirtualList*>(pList)->ResetStats();
+    tree.Calculate(1920.0f, 1080.0f);
+
+    pList = tree.GetVirtualList(tree.FindBox(list.get()));
+    NS_TEST_INT(pList->GetRowCount(), 101);
+    NS_TEST_INT(pList->GetStats().m_uiMaterializedRows, 0);
+    NS_TEST_FLOAT(pList->GetContentHeight(), 101 * 20.0f, 0.0f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Benchmark scrolling")
+  {
+    std::shared_ptr<DOMElement> list;
+    auto panel = BuildLeaderboard(10000, list);
+    setup.m_Resolver.ResolveStyles(*panel);
+
+    LayoutTree tree;
+    tree.SetTextMeasureCache(&setup.m_TextCache);
+
+    nsStopwatch timer;
+    tree.Build(*panel);
+    tree.Calculate(1920.0f, 1080.0f);
+    const nsTime build = timer.GetRunningTotal();
+
+    const VirtualList* pList = tree.GetVirtualList(tree.FindBox(list.get()));
+    const_cast<VirtualList*>(pList)->ResetStats();
+
+    timer.StopAndReset();
+    timer.Resume();
+    for (nsUInt32 i = 1; i <= 1000; ++i)
+    {
+      tree.SetScrollOffset(*list, i * 50.0f);
+      tree.Calculate(1920.0f, 1080.0f);
+    }
+    const nsTime scrolling = timer.GetRunningTotal();
+
+    // 2.5 rows come into view per step.
+    NS_TEST_BOOL(pList->GetStats().m_uiMaterializedRows <= 1000 * 3 + 35);
+
+    nsLog::Info("Virtual list of 10000 rows: {0} ms build and layout, {1} ms per scroll step, {2} rows laid out per step", nsArgF(build.GetMilliseconds(), 2),
+      nsArgF(scrolling.GetMilliseconds() / 1000.0, 3), nsArgF(pList->GetStats().m_uiMaterializedRows / 1000.0, 1));
+  }
+}
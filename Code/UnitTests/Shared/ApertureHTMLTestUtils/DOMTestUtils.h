@@ -0,0 +1,28 @@
+#pragma once
+
+#include <APHTML/dom/DOMElement.h>
+
+#include <memory>
+#include <string>
+
+/// Builds the small DOM trees the unit and performance tests resolve.
+namespace aperture::test
+{
+  /// Attributes that are null are not set.
+  inline std::shared_ptr<dom::DOMElement> MakeElement(const char* szTag, const char* szClass = nullptr, const char* szStyle = nullptr)
+  {
+    auto element = std::make_shared<dom::DOMElement>(szTag);
+    if (szClass != nullptr)
+      element->setAttribute("class", szClass);
+    if (szStyle != nullptr)
+      element->setAttribute("style", szStyle);
+    return element;
+  }
+
+  inline std::shared_ptr<dom::DOMNode> MakeText(const std::string& text)
+  {
+    auto node = std::make_shared<dom::DOMNode>(dom::DOMNodeType::TEXT_NODE, "#text");
+    node->setNodeValue(text);
+    return node;
+  }
+} // namespace aperture::test
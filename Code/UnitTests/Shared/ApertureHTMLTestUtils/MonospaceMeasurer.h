@@ -0,0 +1,28 @@
+#pragma once
+
+#include <APHTML/layout/Core/TextMeasureCache.h>
+
+#include <cmath>
+
+namespace aperture::test
+{
+  /// Monospace font: 8px per character, 16px lines, wraps at the width constraint. Text costs the same on every machine,
+  /// so layout results and timings don't depend on a font backend.
+  class MonospaceMeasurer : public layout::TextMeasurer
+  {
+  public:
+    layout::Size MeasureText(std::string_view in_text, nsUInt64 in_uiFontKey, float in_fMaxWidth) override
+    {
+      ++m_uiCalls;
+      const float fWidth = 8.0f * static_cast<float>(in_text.size());
+      if (std::isinf(in_fMaxWidth) || fWidth <= in_fMaxWidth)
+        return {fWidth, 16.0f};
+
+      const float fCharsPerLine = nsMath::Max(1.0f, std::floor(in_fMaxWidth / 8.0f));
+      return {fCharsPerLine * 8.0f, 16.0f * std::ceil(static_cast<float>(in_text.size()) / fCharsPerLine)};
+    }
+
+    /// How often the measurer was reached, i.e. how often the TextMeasureCache missed.
+    nsUInt32 m_uiCalls = 0;
+  };
+} // namespace aperture::test